@@ -0,0 +1,740 @@
+// Copyright 2016 Adrien Descamps
+// Distributed under BSD 3-Clause License
+
+// Benchmark of the conversions
+//
+// Each conversion is called on random images of several sizes, color spaces, buffer alignments and thread numbers,
+// and each call is timed with a monotonic wall clock, so that the multi-threaded versions are measured correctly and
+// slow calls are visible. The minimum, median and 99th percentile of the call times are reported, with the pixel
+// rate and bandwidth (bytes read and written) of the median call, as a text table, csv or json.
+// With -check, the output of each implementation is also compared with the output of the standard c implementation
+// on the same input (unaligned pointers and strides larger than the width included), which is the safety net for
+// new kernels: the largest absolute difference is reported, and the program fails if it exceeds the tolerance.
+
+// for clock_gettime
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include "yuv_rgb.h"
+#include "yuv_rgb_test_util.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+// monotonic wall clock time, in seconds
+static double wall_time(void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER counter, frequency;
+	QueryPerformanceCounter(&counter);
+	QueryPerformanceFrequency(&frequency);
+	return (double)counter.QuadPart/(double)frequency.QuadPart;
+#else
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (double)t.tv_sec + 1e-9*(double)t.tv_nsec;
+#endif
+}
+
+typedef void (*yuv2rgb_ptr)(
+	uint32_t width, uint32_t height,
+	const uint8_t *y, const uint8_t *u, const uint8_t *v, uint32_t y_stride, uint32_t uv_stride,
+	uint8_t *rgb, uint32_t rgb_stride,
+	YCbCrType yuv_type);
+
+typedef void (*yuvsp2rgb_ptr)(
+	uint32_t width, uint32_t height,
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride,
+	uint8_t *rgb, uint32_t rgb_stride,
+	YCbCrType yuv_type);
+
+typedef void (*rgb2yuv_ptr)(
+	uint32_t width, uint32_t height,
+	const uint8_t *rgb, uint32_t rgb_stride,
+	uint8_t *y, uint8_t *u, uint8_t *v, uint32_t y_stride, uint32_t uv_stride,
+	YCbCrType yuv_type);
+
+typedef void (*yuv2rgb_mt_ptr)(yuv_rgb_pool *pool,
+	uint32_t width, uint32_t height,
+	const uint8_t *y, const uint8_t *u, const uint8_t *v, uint32_t y_stride, uint32_t uv_stride,
+	uint8_t *rgb, uint32_t rgb_stride,
+	YCbCrType yuv_type);
+
+typedef void (*yuvsp2rgb_mt_ptr)(yuv_rgb_pool *pool,
+	uint32_t width, uint32_t height,
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride,
+	uint8_t *rgb, uint32_t rgb_stride,
+	YCbCrType yuv_type);
+
+typedef void (*rgb2yuv_mt_ptr)(yuv_rgb_pool *pool,
+	uint32_t width, uint32_t height,
+	const uint8_t *rgb, uint32_t rgb_stride,
+	uint8_t *y, uint8_t *u, uint8_t *v, uint32_t y_stride, uint32_t uv_stride,
+	YCbCrType yuv_type);
+
+typedef enum
+{
+	ALIGNED_AND_UNALIGNED, // unaligned and dispatch versions, run on both buffers
+	ALIGNED_ONLY,          // aligned versions
+	MULTI_THREADED         // multi-threaded versions, run on both buffers for each thread number
+} CaseMode;
+
+// a conversion to benchmark, only one of the function pointers being set
+typedef struct
+{
+	const char *name;
+	const char *implementation;
+	uint32_t bpp;
+	CaseMode mode;
+	CaseCpu cpu;
+	yuv2rgb_ptr yuv2rgb;
+	yuvsp2rgb_ptr yuvsp2rgb;
+	rgb2yuv_ptr rgb2yuv;
+	yuv2rgb_mt_ptr yuv2rgb_mt;
+	yuvsp2rgb_mt_ptr yuvsp2rgb_mt;
+	rgb2yuv_mt_ptr rgb2yuv_mt;
+} BenchCase;
+
+#define YUV2RGB_CASE(NAME, BPP, SUFFIX, IMPLEMENTATION, MODE, CPU) \
+	{#NAME, IMPLEMENTATION, BPP, MODE, CPU, .yuv2rgb=NAME##SUFFIX},
+#define YUVSP2RGB_CASE(NAME, BPP, SUFFIX, IMPLEMENTATION, MODE, CPU) \
+	{#NAME, IMPLEMENTATION, BPP, MODE, CPU, .yuvsp2rgb=NAME##SUFFIX},
+#define RGB2YUV_CASE(NAME, BPP, SUFFIX, IMPLEMENTATION, MODE, CPU) \
+	{#NAME, IMPLEMENTATION, BPP, MODE, CPU, .rgb2yuv=NAME##SUFFIX},
+#define YUV2RGB_MT_CASE(NAME, BPP) {#NAME, "mt", BPP, MULTI_THREADED, CPU_ANY, .yuv2rgb_mt=NAME##_mt},
+#define YUVSP2RGB_MT_CASE(NAME, BPP) {#NAME, "mt", BPP, MULTI_THREADED, CPU_ANY, .yuvsp2rgb_mt=NAME##_mt},
+#define RGB2YUV_MT_CASE(NAME, BPP) {#NAME, "mt", BPP, MULTI_THREADED, CPU_ANY, .rgb2yuv_mt=NAME##_mt},
+
+// all implementations of a conversion, CASE(NAME, BPP, SUFFIX, IMPLEMENTATION, MODE, CPU) defining each of them
+#define STD_CASES(CASE, NAME, BPP) \
+	CASE(NAME, BPP, _std, "std", ALIGNED_AND_UNALIGNED, CPU_ANY)
+#ifdef _YUVRGB_SSE2_
+#define SSE_CASES(CASE, NAME, BPP) \
+	CASE(NAME, BPP, _sse, "sse", ALIGNED_ONLY, CPU_ANY) \
+	CASE(NAME, BPP, _sseu, "sseu", ALIGNED_AND_UNALIGNED, CPU_ANY)
+#else
+#define SSE_CASES(CASE, NAME, BPP)
+#endif
+#if USE_AVX2
+#define AVX2_CASES(CASE, NAME, BPP) \
+	CASE(NAME, BPP, _avx2, "avx2", ALIGNED_ONLY, CPU_AVX2) \
+	CASE(NAME, BPP, _avx2u, "avx2u", ALIGNED_AND_UNALIGNED, CPU_AVX2)
+#else
+#define AVX2_CASES(CASE, NAME, BPP)
+#endif
+#if USE_AVX512
+#define AVX512_CASES(CASE, NAME, BPP) \
+	CASE(NAME, BPP, _avx512, "avx512", ALIGNED_ONLY, CPU_AVX512) \
+	CASE(NAME, BPP, _avx512u, "avx512u", ALIGNED_AND_UNALIGNED, CPU_AVX512)
+#else
+#define AVX512_CASES(CASE, NAME, BPP)
+#endif
+#ifdef __aarch64__
+#define NEON_CASES(CASE, NAME, BPP) \
+	CASE(NAME, BPP, _neon, "neon", ALIGNED_AND_UNALIGNED, CPU_ANY)
+#else
+#define NEON_CASES(CASE, NAME, BPP)
+#endif
+#define AUTO_CASES(CASE, NAME, BPP) \
+	CASE(NAME, BPP, , "auto", ALIGNED_AND_UNALIGNED, CPU_ANY)
+
+static const BenchCase BENCH_CASES[] = {
+	STD_CASES(YUV2RGB_CASE, yuv420_rgb24, 3) SSE_CASES(YUV2RGB_CASE, yuv420_rgb24, 3)
+	AVX2_CASES(YUV2RGB_CASE, yuv420_rgb24, 3) AVX512_CASES(YUV2RGB_CASE, yuv420_rgb24, 3)
+	NEON_CASES(YUV2RGB_CASE, yuv420_rgb24, 3) AUTO_CASES(YUV2RGB_CASE, yuv420_rgb24, 3)
+	YUV2RGB_MT_CASE(yuv420_rgb24, 3)
+	STD_CASES(YUV2RGB_CASE, yuv420_rgb32, 4) SSE_CASES(YUV2RGB_CASE, yuv420_rgb32, 4)
+	NEON_CASES(YUV2RGB_CASE, yuv420_rgb32, 4) AUTO_CASES(YUV2RGB_CASE, yuv420_rgb32, 4)
+	STD_CASES(YUV2RGB_CASE, yuv420_rgb24_bilinear, 3) AUTO_CASES(YUV2RGB_CASE, yuv420_rgb24_bilinear, 3)
+	STD_CASES(YUVSP2RGB_CASE, nv12_rgb24, 3) SSE_CASES(YUVSP2RGB_CASE, nv12_rgb24, 3)
+	AVX2_CASES(YUVSP2RGB_CASE, nv12_rgb24, 3) AVX512_CASES(YUVSP2RGB_CASE, nv12_rgb24, 3)
+	NEON_CASES(YUVSP2RGB_CASE, nv12_rgb24, 3) AUTO_CASES(YUVSP2RGB_CASE, nv12_rgb24, 3)
+	YUVSP2RGB_MT_CASE(nv12_rgb24, 3)
+	STD_CASES(YUVSP2RGB_CASE, nv12_rgb32, 4) SSE_CASES(YUVSP2RGB_CASE, nv12_rgb32, 4)
+	NEON_CASES(YUVSP2RGB_CASE, nv12_rgb32, 4) AUTO_CASES(YUVSP2RGB_CASE, nv12_rgb32, 4)
+	STD_CASES(RGB2YUV_CASE, rgb24_yuv420, 3) SSE_CASES(RGB2YUV_CASE, rgb24_yuv420, 3)
+	AVX2_CASES(RGB2YUV_CASE, rgb24_yuv420, 3) NEON_CASES(RGB2YUV_CASE, rgb24_yuv420, 3)
+	AUTO_CASES(RGB2YUV_CASE, rgb24_yuv420, 3)
+	RGB2YUV_MT_CASE(rgb24_yuv420, 3)
+	STD_CASES(RGB2YUV_CASE, rgb32_yuv420, 4) SSE_CASES(RGB2YUV_CASE, rgb32_yuv420, 4)
+	AVX2_CASES(RGB2YUV_CASE, rgb32_yuv420, 4) NEON_CASES(RGB2YUV_CASE, rgb32_yuv420, 4)
+	AUTO_CASES(RGB2YUV_CASE, rgb32_yuv420, 4)
+	RGB2YUV_MT_CASE(rgb32_yuv420, 4)
+	STD_CASES(RGB2YUV_CASE, rgb24_yuv420_precise, 3) SSE_CASES(RGB2YUV_CASE, rgb24_yuv420_precise, 3)
+	NEON_CASES(RGB2YUV_CASE, rgb24_yuv420_precise, 3) AUTO_CASES(RGB2YUV_CASE, rgb24_yuv420_precise, 3)
+};
+
+#define BENCH_CASE_NUMBER (sizeof(BENCH_CASES)/sizeof(BENCH_CASES[0]))
+
+static const struct
+{
+	const char *name;
+	uint32_t width, height;
+} SIZES[] = {
+	{"qvga", 320, 240}, {"vga", 640, 480}, {"720p", 1280, 720}, {"1080p", 1920, 1080}, {"4k", 3840, 2160},
+	{"8k", 7680, 4320}
+};
+
+static const struct
+{
+	const char *name;
+	YCbCrType type;
+} TYPES[] = {
+	{"jpeg", YCBCR_JPEG}, {"601", YCBCR_601}, {"709", YCBCR_709}, {"709full", YCBCR_709_FULL}, {"2020", YCBCR_2020},
+	{"2020full", YCBCR_2020_FULL}
+};
+
+static const uint32_t CHECK_SIZES[][2] = {
+	{1, 1}, {2, 2}, {3, 5}, {15, 2}, {16, 3}, {17, 4}, {31, 7}, {32, 2}, {33, 3}, {63, 4}, {64, 5}, {65, 2},
+	{127, 3}, {128, 2}, {129, 6}, {191, 9}, {257, 5}, {320, 240}
+};
+
+#define ARRAY_SIZE(A) (sizeof(A)/sizeof((A)[0]))
+#define MAX_LIST 32
+
+// images of a given size, the aligned images having 64 bytes aligned pointers and strides, and the unaligned ones
+// starting one byte after in the same buffers, with the strides equal to the line sizes
+typedef struct
+{
+	uint8_t *buffers[4];
+	const uint8_t *y, *u, *v, *uv, *rgb;
+	uint8_t *out_y, *out_u, *out_v, *out_rgb;
+	uint32_t y_stride, uv_stride, uvsp_stride, rgb_stride;
+} Images;
+
+#define ALIGN64(V) (((V)+63)/64*64)
+#define ALIGN_PTR64(P) ((uint8_t *)(((uintptr_t)(P)+63)/64*64))
+
+// one buffer for the yuv420 input (y, u and v planes, followed by the nv12 uv plane), one for the rgb32 input,
+// and one for the outputs of any format (an rgb32 image, or y, u and v planes), plus one for the reference outputs
+// if check is set
+static int alloc_images(uint32_t width, uint32_t height, int check, Images *aligned, Images *unaligned)
+{
+	const uint32_t uv_width = (width+1)/2, uv_height = (height+1)/2;
+	const size_t y_size = ALIGN64(width)*(size_t)height, uv_size = ALIGN64(uv_width)*(size_t)uv_height,
+		uvsp_size = ALIGN64(2*uv_width)*(size_t)uv_height, rgb_size = ALIGN64(4*width)*(size_t)height,
+		yuv_size = y_size+2*uv_size+uvsp_size,
+		out_size = (yuv_size>rgb_size ? yuv_size : rgb_size)+64,
+		sizes[4] = {yuv_size+64, rgb_size+64, out_size, check ? out_size : 0};
+	int i;
+	size_t j;
+	uint32_t seed = 12345;
+
+	aligned->buffers[3] = NULL;
+	for(i=0; i<4 && sizes[i]; ++i)
+	{
+		aligned->buffers[i] = malloc(sizes[i]);
+		if(!aligned->buffers[i])
+		{
+			while(i--)
+				free(aligned->buffers[i]);
+			return -1;
+		}
+		// deterministic pseudo random values, so that the results do not depend on the content
+		for(j=0; j<sizes[i]; ++j)
+		{
+			seed = seed*1103515245u+12345u;
+			aligned->buffers[i][j] = (uint8_t)(seed>>16);
+		}
+	}
+
+	uint8_t *yuv = ALIGN_PTR64(aligned->buffers[0]), *rgb = ALIGN_PTR64(aligned->buffers[1]),
+		*out = ALIGN_PTR64(aligned->buffers[2]);
+	aligned->y_stride = ALIGN64(width);
+	aligned->uv_stride = ALIGN64(uv_width);
+	aligned->uvsp_stride = ALIGN64(2*uv_width);
+	aligned->rgb_stride = ALIGN64(4*width);
+	aligned->y = yuv;
+	aligned->u = yuv+y_size;
+	aligned->v = yuv+y_size+uv_size;
+	aligned->uv = yuv+y_size+2*uv_size;
+	aligned->rgb = rgb;
+	aligned->out_y = aligned->out_rgb = out;
+	aligned->out_u = out+y_size;
+	aligned->out_v = out+y_size+uv_size;
+
+	*unaligned = *aligned;
+	unaligned->y_stride = width;
+	unaligned->uv_stride = uv_width;
+	unaligned->uvsp_stride = 2*uv_width;
+	unaligned->rgb_stride = 0;
+	unaligned->y += 1;
+	unaligned->u += 1;
+	unaligned->v += 1;
+	unaligned->uv += 1;
+	unaligned->rgb += 1;
+	unaligned->out_y += 1;
+	unaligned->out_rgb += 1;
+	unaligned->out_u += 1;
+	unaligned->out_v += 1;
+	return 0;
+}
+
+static void free_images(Images *images)
+{
+	int i;
+	for(i=0; i<4; ++i)
+		free(images->buffers[i]);
+}
+
+// largest absolute difference between the lines of two images
+static int max_plane_difference(const uint8_t *a, const uint8_t *b, uint32_t line_size, uint32_t height,
+	uint32_t stride)
+{
+	int difference = 0;
+	uint32_t x, y;
+	for(y=0; y<height; ++y)
+		for(x=0; x<line_size; ++x)
+		{
+			const int d = abs((int)a[y*(size_t)stride+x]-(int)b[y*(size_t)stride+x]);
+			if(d>difference)
+				difference = d;
+		}
+	return difference;
+}
+
+static void run_case(const BenchCase *c, uint32_t width, uint32_t height, const Images *images, YCbCrType yuv_type,
+	yuv_rgb_pool *pool)
+{
+	// the rgb stride of the unaligned images depends on the number of bytes per pixel
+	const uint32_t rgb_stride = images->rgb_stride ? images->rgb_stride : c->bpp*width;
+	if(c->yuv2rgb)
+		c->yuv2rgb(width, height, images->y, images->u, images->v, images->y_stride, images->uv_stride,
+			images->out_rgb, rgb_stride, yuv_type);
+	else if(c->yuvsp2rgb)
+		c->yuvsp2rgb(width, height, images->y, images->uv, images->y_stride, images->uvsp_stride,
+			images->out_rgb, rgb_stride, yuv_type);
+	else if(c->rgb2yuv)
+		c->rgb2yuv(width, height, images->rgb, rgb_stride, images->out_y, images->out_u, images->out_v,
+			images->y_stride, images->uv_stride, yuv_type);
+	else if(c->yuv2rgb_mt)
+		c->yuv2rgb_mt(pool, width, height, images->y, images->u, images->v, images->y_stride, images->uv_stride,
+			images->out_rgb, rgb_stride, yuv_type);
+	else if(c->yuvsp2rgb_mt)
+		c->yuvsp2rgb_mt(pool, width, height, images->y, images->uv, images->y_stride, images->uvsp_stride,
+			images->out_rgb, rgb_stride, yuv_type);
+	else
+		c->rgb2yuv_mt(pool, width, height, images->rgb, rgb_stride, images->out_y, images->out_u, images->out_v,
+			images->y_stride, images->uv_stride, yuv_type);
+}
+
+static int is_rgb_output(const BenchCase *c)
+{
+	return c->yuv2rgb || c->yuvsp2rgb || c->yuv2rgb_mt || c->yuvsp2rgb_mt;
+}
+
+// convert the input with the standard c implementation reference into the reference buffer, at the same offsets
+// as the outputs, and return the largest absolute difference with the output of c
+static int check_case(const BenchCase *c, const BenchCase *reference, uint32_t width, uint32_t height,
+	const Images *images, YCbCrType yuv_type)
+{
+	const uint8_t *out = ALIGN_PTR64(images->buffers[2]);
+	uint8_t *ref_out = ALIGN_PTR64(images->buffers[3]);
+	Images ref = *images;
+	ref.out_y = ref_out+(images->out_y-out);
+	ref.out_u = ref_out+(images->out_u-out);
+	ref.out_v = ref_out+(images->out_v-out);
+	ref.out_rgb = ref_out+(images->out_rgb-out);
+	run_case(reference, width, height, &ref, yuv_type, NULL);
+
+	if(is_rgb_output(c))
+		return max_plane_difference(images->out_rgb, ref.out_rgb, c->bpp*width, height,
+			images->rgb_stride ? images->rgb_stride : c->bpp*width);
+
+	const int y = max_plane_difference(images->out_y, ref.out_y, width, height, images->y_stride),
+		u = max_plane_difference(images->out_u, ref.out_u, (width+1)/2, (height+1)/2, images->uv_stride),
+		v = max_plane_difference(images->out_v, ref.out_v, (width+1)/2, (height+1)/2, images->uv_stride);
+	return y>u ? (y>v ? y : v) : (u>v ? u : v);
+}
+
+typedef enum
+{
+	FORMAT_TEXT,
+	FORMAT_CSV,
+	FORMAT_JSON
+} OutputFormat;
+
+typedef struct
+{
+	double min, median, p99;
+	uint32_t iterations;
+} Timing;
+
+static int compare_double(const void *a, const void *b)
+{
+	const double x = *(const double *)a, y = *(const double *)b;
+	return (x>y) - (x<y);
+}
+
+// time calls until min_time seconds and min_iterations calls are reached (after one warm up call), or exactly
+// iterations calls if it is not 0
+#define MAX_ITERATIONS 10000
+static Timing time_case(const BenchCase *c, uint32_t width, uint32_t height, const Images *images,
+	YCbCrType yuv_type, yuv_rgb_pool *pool, double min_time, uint32_t iterations, double *times)
+{
+	const uint32_t min_iterations = 5;
+	Timing timing;
+	double total = 0.0;
+	uint32_t n = 0;
+
+	run_case(c, width, height, images, yuv_type, pool);
+	while(n<MAX_ITERATIONS && (iterations ? n<iterations : (total<min_time || n<min_iterations)))
+	{
+		const double t = wall_time();
+		run_case(c, width, height, images, yuv_type, pool);
+		times[n] = wall_time()-t;
+		total += times[n];
+		++n;
+	}
+
+	qsort(times, n, sizeof(double), compare_double);
+	timing.min = times[0];
+	timing.median = (n%2) ? times[n/2] : 0.5*(times[n/2-1]+times[n/2]);
+	// smallest time greater or equal to 99% of the calls
+	timing.p99 = times[(99*n+99)/100-1];
+	timing.iterations = n;
+	return timing;
+}
+
+// bytes read and written by a call
+static double case_bytes(const BenchCase *c, uint32_t width, uint32_t height)
+{
+	const double yuv = (double)width*height + 2.0*((width+1)/2)*((height+1)/2), rgb = (double)c->bpp*width*height;
+	return yuv+rgb;
+}
+
+static void print_header(FILE *out, OutputFormat format)
+{
+	if(format==FORMAT_TEXT)
+		fprintf(out, "%-24s %-8s %-10s %-9s %-9s %7s %10s %11s %10s %10s %8s %8s\n", "conversion", "impl", "size",
+			"type", "alignment", "threads", "min (us)", "median (us)", "p99 (us)", "Mpix/s", "GB/s", "max diff");
+	else if(format==FORMAT_CSV)
+		fprintf(out, "conversion,implementation,width,height,yuv_type,alignment,threads,iterations,"
+			"min_us,median_us,p99_us,mpix_per_s,gb_per_s,max_diff\n");
+	else
+		fprintf(out, "{\n\t\"results\": [");
+}
+
+static void print_result(FILE *out, OutputFormat format, int first, const BenchCase *c, uint32_t width,
+	uint32_t height, const char *type, const char *alignment, uint32_t threads, Timing t, int difference)
+{
+	const double mpix = (double)width*height/t.median*1e-6, gb = case_bytes(c, width, height)/t.median*1e-9;
+	if(format==FORMAT_TEXT)
+	{
+		char size[32];
+		snprintf(size, sizeof(size), "%ux%u", width, height);
+		fprintf(out, "%-24s %-8s %-10s %-9s %-9s %7u %10.1f %11.1f %10.1f %10.1f %8.2f %8d\n", c->name,
+			c->implementation, size, type, alignment, threads, 1e6*t.min, 1e6*t.median, 1e6*t.p99, mpix, gb,
+			difference);
+	}
+	else if(format==FORMAT_CSV)
+		fprintf(out, "%s,%s,%u,%u,%s,%s,%u,%u,%.3f,%.3f,%.3f,%.3f,%.4f,%d\n", c->name, c->implementation, width,
+			height, type, alignment, threads, t.iterations, 1e6*t.min, 1e6*t.median, 1e6*t.p99, mpix, gb, difference);
+	else
+		fprintf(out, "%s\n\t\t{\"conversion\": \"%s\", \"implementation\": \"%s\", \"width\": %u, \"height\": %u, "
+			"\"yuv_type\": \"%s\", \"alignment\": \"%s\", \"threads\": %u, \"iterations\": %u, \"min_us\": %.3f, "
+			"\"median_us\": %.3f, \"p99_us\": %.3f, \"mpix_per_s\": %.3f, \"gb_per_s\": %.4f, \"max_diff\": %d}",
+			first ? "" : ",", c->name, c->implementation, width, height, type, alignment, threads, t.iterations,
+			1e6*t.min, 1e6*t.median, 1e6*t.p99, mpix, gb, difference);
+	fflush(out);
+}
+
+static void print_footer(FILE *out, OutputFormat format)
+{
+	if(format==FORMAT_JSON)
+		fprintf(out, "\n\t]\n}\n");
+}
+
+static void usage(void)
+{
+	printf("Usage : bench_yuv_rgb [options]\n");
+	printf("  -format text|csv|json  output format (default text)\n");
+	printf("  -output <file>         write the results to file instead of the standard output\n");
+	printf("  -sizes <list>          comma separated sizes, among qvga, vga, 720p, 1080p, 4k and 8k or WIDTHxHEIGHT\n");
+	printf("                         (default all named sizes)\n");
+	printf("  -types <list>          comma separated color spaces, among jpeg, 601, 709, 709full, 2020 and 2020full,\n");
+	printf("                         or all (default 601)\n");
+	printf("  -threads <list>        comma separated thread numbers of the multi-threaded versions (default 1 and the\n");
+	printf("                         number of cores)\n");
+	printf("  -filter <text>         only run the conversions whose name or implementation contains text\n");
+	printf("  -time <seconds>        minimum time per case (default 0.2)\n");
+	printf("  -iterations <n>        exact number of timed calls per case, instead of -time (at most %d)\n",
+		MAX_ITERATIONS);
+	printf("  -check <tolerance>     compare each output with the standard c one, and fail if the largest absolute\n");
+	printf("                         difference exceeds tolerance (the default sizes are then odd and edge sizes)\n");
+	printf("The max diff column is -1 for the cases that are not checked.\n");
+}
+
+// split the comma separated list str in place, return the number of items or -1 if there are too many
+static int split_list(char *str, char **items)
+{
+	int n = 0;
+	char *item = strtok(str, ",");
+	while(item)
+	{
+		if(n==MAX_LIST)
+			return -1;
+		items[n++] = item;
+		item = strtok(NULL, ",");
+	}
+	return n;
+}
+
+int main(int argc, char **argv)
+{
+	OutputFormat format = FORMAT_TEXT;
+	const char *output = NULL, *filter = NULL;
+	double min_time = 0.2;
+	uint32_t iterations = 0;
+	int tolerance = -1;
+	uint32_t widths[MAX_LIST], heights[MAX_LIST], threads[MAX_LIST];
+	const char *type_names[MAX_LIST];
+	YCbCrType types[MAX_LIST];
+	int size_number = 0, type_number = 0, thread_number = 0;
+	int i, j;
+
+	for(i=1; i<argc; ++i)
+	{
+		char *items[MAX_LIST];
+		int n = 0;
+		if(i+1>=argc)
+		{
+			usage();
+			return 1;
+		}
+		if(strcmp(argv[i], "-format")==0)
+		{
+			++i;
+			if(strcmp(argv[i], "text")==0)
+				format = FORMAT_TEXT;
+			else if(strcmp(argv[i], "csv")==0)
+				format = FORMAT_CSV;
+			else if(strcmp(argv[i], "json")==0)
+				format = FORMAT_JSON;
+			else
+			{
+				printf("Invalid output format %s\n", argv[i]);
+				return 1;
+			}
+		}
+		else if(strcmp(argv[i], "-output")==0)
+			output = argv[++i];
+		else if(strcmp(argv[i], "-filter")==0)
+			filter = argv[++i];
+		else if(strcmp(argv[i], "-time")==0)
+			min_time = atof(argv[++i]);
+		else if(strcmp(argv[i], "-iterations")==0)
+			iterations = (uint32_t)strtoul(argv[++i], NULL, 10);
+		else if(strcmp(argv[i], "-check")==0)
+		{
+			tolerance = atoi(argv[++i]);
+			if(tolerance<0)
+			{
+				printf("Invalid tolerance %s\n", argv[i]);
+				return 1;
+			}
+		}
+		else if(strcmp(argv[i], "-sizes")==0 || strcmp(argv[i], "-types")==0 || strcmp(argv[i], "-threads")==0)
+		{
+			const char *option = argv[i++];
+			n = split_list(argv[i], items);
+			if(n<=0)
+			{
+				printf("Invalid list %s for %s\n", argv[i], option);
+				return 1;
+			}
+			// a repeated option replaces the previous list
+			if(option[1]=='s')
+				size_number = 0;
+			else if(option[2]=='y')
+				type_number = 0;
+			else
+				thread_number = 0;
+			for(j=0; j<n; ++j)
+			{
+				size_t k;
+				if(option[1]=='s')
+				{
+					// sizes
+					unsigned width, height;
+					char end;
+					for(k=0; k<ARRAY_SIZE(SIZES) && strcmp(items[j], SIZES[k].name)!=0; ++k) {}
+					if(k<ARRAY_SIZE(SIZES))
+					{
+						widths[size_number] = SIZES[k].width;
+						heights[size_number] = SIZES[k].height;
+					}
+					else if(sscanf(items[j], "%ux%u%c", &width, &height, &end)==2 && width>0 && height>0 &&
+						width<=65536 && height<=65536)
+					{
+						widths[size_number] = width;
+						heights[size_number] = height;
+					}
+					else
+					{
+						printf("Invalid size %s\n", items[j]);
+						return 1;
+					}
+					++size_number;
+				}
+				else if(option[2]=='y')
+				{
+					// types
+					if(strcmp(items[j], "all")==0)
+					{
+						for(k=0; k<ARRAY_SIZE(TYPES); ++k)
+						{
+							type_names[k] = TYPES[k].name;
+							types[k] = TYPES[k].type;
+						}
+						type_number = ARRAY_SIZE(TYPES);
+						break;
+					}
+					for(k=0; k<ARRAY_SIZE(TYPES) && strcmp(items[j], TYPES[k].name)!=0; ++k) {}
+					if(k==ARRAY_SIZE(TYPES))
+					{
+						printf("Invalid color space %s\n", items[j]);
+						return 1;
+					}
+					type_names[type_number] = TYPES[k].name;
+					types[type_number++] = TYPES[k].type;
+				}
+				else
+				{
+					// threads
+					const unsigned long t = strtoul(items[j], NULL, 10);
+					if(t<1 || t>1024)
+					{
+						printf("Invalid thread number %s\n", items[j]);
+						return 1;
+					}
+					threads[thread_number++] = (uint32_t)t;
+				}
+			}
+		}
+		else
+		{
+			usage();
+			return 1;
+		}
+	}
+
+	if(size_number==0 && tolerance>=0)
+	{
+		// sizes around the simd block sizes (16 to 128 pixels), odd sizes and a small image, to check the ends of
+		// the lines and the last line
+		for(i=0; i<(int)ARRAY_SIZE(CHECK_SIZES); ++i)
+		{
+			widths[i] = CHECK_SIZES[i][0];
+			heights[i] = CHECK_SIZES[i][1];
+		}
+		size_number = ARRAY_SIZE(CHECK_SIZES);
+	}
+	if(size_number==0)
+	{
+		for(i=0; i<(int)ARRAY_SIZE(SIZES); ++i)
+		{
+			widths[i] = SIZES[i].width;
+			heights[i] = SIZES[i].height;
+		}
+		size_number = ARRAY_SIZE(SIZES);
+	}
+	if(type_number==0)
+	{
+		type_names[0] = "601";
+		types[0] = YCBCR_601;
+		type_number = 1;
+	}
+	if(thread_number==0)
+	{
+		threads[thread_number++] = 1;
+		if(yuv_rgb_cpu_count()>1)
+			threads[thread_number++] = yuv_rgb_cpu_count();
+	}
+
+	// one pool per thread number, with the calling thread as the last one
+	yuv_rgb_pool *pools[MAX_LIST];
+	for(i=0; i<thread_number; ++i)
+	{
+		pools[i] = yuv_rgb_pool_create(threads[i]-1, NULL);
+		if(!pools[i])
+		{
+			printf("Error creating a pool of %u threads\n", threads[i]);
+			return 1;
+		}
+	}
+
+	FILE *out = output ? fopen(output, "w") : stdout;
+	double *times = malloc(MAX_ITERATIONS*sizeof(double));
+	if(!out || !times)
+	{
+		printf("Error opening the output file\n");
+		return 1;
+	}
+
+	int first = 1, failures = 0;
+	print_header(out, format);
+	for(i=0; i<size_number; ++i)
+	{
+		Images images[2];
+		const char *alignments[2] = {"aligned", "unaligned"};
+		if(alloc_images(widths[i], heights[i], tolerance>=0, &images[0], &images[1])!=0)
+		{
+			fprintf(stderr, "Error allocating %ux%u images, skipped\n", widths[i], heights[i]);
+			continue;
+		}
+		for(j=0; j<type_number; ++j)
+		{
+			size_t k;
+			for(k=0; k<BENCH_CASE_NUMBER; ++k)
+			{
+				const BenchCase *c = &BENCH_CASES[k], *reference = BENCH_CASES;
+				int a, t;
+				// the standard c implementation of the conversion
+				while(strcmp(reference->name, c->name)!=0 || strcmp(reference->implementation, "std")!=0)
+					++reference;
+				if(!cpu_supports(c->cpu) ||
+					(filter && !strstr(c->name, filter) && !strstr(c->implementation, filter)))
+					continue;
+				for(a=0; a<(c->mode==ALIGNED_ONLY ? 1 : 2); ++a)
+					for(t=0; t<(c->mode==MULTI_THREADED ? thread_number : 1); ++t)
+					{
+						const Timing timing = time_case(c, widths[i], heights[i], &images[a], types[j],
+							pools[t], min_time, iterations, times);
+						const int difference = tolerance<0 ? -1 :
+							check_case(c, reference, widths[i], heights[i], &images[a], types[j]);
+						print_result(out, format, first, c, widths[i], heights[i], type_names[j], alignments[a],
+							c->mode==MULTI_THREADED ? threads[t] : 1, timing, difference);
+						first = 0;
+						if(difference>tolerance)
+						{
+							fprintf(stderr, "%s %s differs from %s std by %d (%ux%u, %s, %s)\n", c->name,
+								c->implementation, c->name, difference, widths[i], heights[i], type_names[j],
+								alignments[a]);
+							failures++;
+						}
+					}
+			}
+		}
+		free_images(&images[0]);
+	}
+	print_footer(out, format);
+
+	free(times);
+	if(output)
+		fclose(out);
+	for(i=0; i<thread_number; ++i)
+		yuv_rgb_pool_destroy(pools[i]);
+	if(failures)
+		fprintf(stderr, "%d implementations differ from the standard c ones by more than %d\n", failures, tolerance);
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,1312 @@
+// Copyright 2016 Adrien Descamps
+// Distributed under BSD 3-Clause License
+
+// Conversion tests, run by ctest
+//
+// Each implementation of each conversion (sse, avx2, avx512, neon, their unaligned versions, the versions without
+// suffix, and the multi-threaded and batch versions) is compared byte by byte with the standard c implementation, on
+// images of odd and simd block boundary sizes, filled with random values, black, white or the extreme values of the
+// color spaces (below the luma minimum, above the maximum, ...), in all color spaces including custom ones, with
+// aligned pointers and strides and with unaligned pointers and padded strides. The bytes around the lines of the
+// outputs must not be modified. The rotated, rectangles, streaming, scaled and image conversions are compared with
+// the standard c conversion of the whole image.
+// The unaligned planes end exactly at the end of their last line, so that the accesses past the images are reported
+// when the test is built with -fsanitize=address.
+// When built with FUZZER defined (see USE_FUZZER in CMakeLists.txt), this is a libFuzzer target instead: the
+// conversion, the size, the color space, the alignment, the padding and offsets of the planes and the content of the
+// images are taken from the input, and the target aborts on any difference with the standard c implementation.
+
+#include "yuv_rgb.h"
+#include "yuv_rgb_test_util.h"
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARRAY_SIZE(A) (sizeof(A)/sizeof((A)[0]))
+#define ALIGN64(V) (((V)+63)/64*64)
+#define ALIGN_PTR64(P) ((uint8_t *)(((uintptr_t)(P)+63)/64*64))
+
+// value of the output bytes that must not be written, and size of the areas checked before and after aligned planes
+#define SENTINEL 0xA5
+#define GUARD 64
+
+typedef enum
+{
+	IMAGE_YUV420,    // y, u and v planes, the chroma planes having (width+1)/2 columns and (height+1)/2 lines
+	IMAGE_NV12,      // y plane and interleaved chroma plane (nv12 or nv21)
+	IMAGE_YUV422P,
+	IMAGE_NV16,
+	IMAGE_YUV444P,
+	IMAGE_NV24,
+	IMAGE_PACKED422, // yuyv or uyvy
+	IMAGE_YUVA420,   // yuv420 planes and alpha plane, which uses the y stride
+	IMAGE_PACKED,    // packed rgb
+	IMAGE_PLANAR     // r, g and b planes, sharing their stride
+} ImageType;
+
+// image format as seen by the tests: type, bytes per sample (per pixel for packed rgb), alignment of the planes and
+// strides required by the sample type, and number of significant bits of 16 bits samples (0 if all of them are)
+typedef struct
+{
+	ImageType type;
+	uint32_t size, align, bits;
+} Layout;
+
+static const Layout LAYOUT_YUV420 = {IMAGE_YUV420, 1, 1, 0}, LAYOUT_NV12 = {IMAGE_NV12, 1, 1, 0},
+	LAYOUT_YUV422P = {IMAGE_YUV422P, 1, 1, 0}, LAYOUT_NV16 = {IMAGE_NV16, 1, 1, 0},
+	LAYOUT_YUV444P = {IMAGE_YUV444P, 1, 1, 0}, LAYOUT_NV24 = {IMAGE_NV24, 1, 1, 0},
+	LAYOUT_PACKED422 = {IMAGE_PACKED422, 1, 1, 0}, LAYOUT_YUVA420 = {IMAGE_YUVA420, 1, 1, 0},
+	LAYOUT_YUV420_10 = {IMAGE_YUV420, 2, 2, 10}, LAYOUT_NV12_16 = {IMAGE_NV12, 2, 2, 0},
+	LAYOUT_RGB24 = {IMAGE_PACKED, 3, 1, 0}, LAYOUT_RGB32 = {IMAGE_PACKED, 4, 1, 0},
+	LAYOUT_RGB565 = {IMAGE_PACKED, 2, 2, 0}, LAYOUT_RGB48 = {IMAGE_PACKED, 6, 2, 0},
+	LAYOUT_X2RGB10 = {IMAGE_PACKED, 4, 4, 0}, LAYOUT_PLANAR_U8 = {IMAGE_PLANAR, 1, 1, 0},
+	LAYOUT_PLANAR_F32 = {IMAGE_PLANAR, 4, 4, 0}, LAYOUT_PLANAR_F16 = {IMAGE_PLANAR, 2, 2, 0};
+
+static uint32_t plane_number(const Layout *layout)
+{
+	switch(layout->type)
+	{
+		case IMAGE_NV12:
+		case IMAGE_NV16:
+		case IMAGE_NV24:
+			return 2;
+		case IMAGE_PACKED422:
+		case IMAGE_PACKED:
+			return 1;
+		case IMAGE_YUVA420:
+			return 4;
+		default:
+			return 3;
+	}
+}
+
+// size in bytes of the lines of a plane, number of lines, and index of its stride (0 for the y, alpha and rgb planes,
+// 1 for the chroma planes)
+static void plane_geometry(const Layout *layout, uint32_t plane, uint32_t width, uint32_t height,
+	uint32_t *line_size, uint32_t *lines, uint32_t *stride_index)
+{
+	const uint32_t uv_width = (width+1)/2, uv_height = (height+1)/2, size = layout->size;
+	*line_size = layout->type==IMAGE_PACKED422 ? 4*uv_width : size*width;
+	*lines = height;
+	*stride_index = 0;
+	if(plane==0 || plane==3 || layout->type==IMAGE_PLANAR)
+		return;
+
+	*stride_index = 1;
+	switch(layout->type)
+	{
+		case IMAGE_YUV420:
+		case IMAGE_YUVA420:
+			*line_size = size*uv_width;
+			*lines = uv_height;
+			break;
+		case IMAGE_NV12:
+			*line_size = 2*size*uv_width;
+			*lines = uv_height;
+			break;
+		case IMAGE_YUV422P:
+			*line_size = size*uv_width;
+			break;
+		case IMAGE_NV16:
+			*line_size = 2*size*uv_width;
+			break;
+		case IMAGE_NV24:
+			*line_size = 2*size*width;
+			break;
+		default:
+			break;
+	}
+}
+
+typedef struct
+{
+	const Layout *layout;
+	uint32_t width, height;
+	uint8_t *planes[4];
+	// stride of the y (or rgb) planes, and of the chroma planes
+	uint32_t strides[2];
+	// allocated block of each plane, and area that is checked for writes outside of the lines
+	uint8_t *memory[4], *begin[4], *end[4];
+} Image;
+
+// number of bytes of a plane, from the start of its first line to the end of its last line
+static size_t plane_span(const Image *image, uint32_t plane)
+{
+	uint32_t line_size, lines, index;
+	plane_geometry(image->layout, plane, image->width, image->height, &line_size, &lines, &index);
+	return (size_t)image->strides[index]*(lines-1)+line_size;
+}
+
+// allocate a width x height image, each plane in its own block filled with SENTINEL
+// aligned images have 64 bytes aligned planes and strides multiple of 64 (plus 64 if padding is odd), with GUARD
+// bytes before and after each plane; the strides of unaligned images are padding%8 samples larger than their lines,
+// and their planes start a few samples (depending on offset) after the start of their block, and end with it
+static void image_alloc(Image *image, const Layout *layout, uint32_t width, uint32_t height, int aligned,
+	uint32_t padding, uint32_t offset)
+{
+	uint32_t p, line_size, lines, index, max_line[2] = {0, 0};
+
+	memset(image, 0, sizeof(Image));
+	image->layout = layout;
+	image->width = width;
+	image->height = height;
+	for(p=0; p<plane_number(layout); ++p)
+	{
+		plane_geometry(layout, p, width, height, &line_size, &lines, &index);
+		if(line_size>max_line[index])
+			max_line[index] = line_size;
+	}
+	for(index=0; index<2; ++index)
+		image->strides[index] = aligned ? ALIGN64(max_line[index])+64*(padding%2) :
+			max_line[index]+layout->align*(padding%8);
+
+	for(p=0; p<plane_number(layout); ++p)
+	{
+		const size_t span = plane_span(image, p), shift = layout->align*(1+(offset+3*p)%15);
+		image->memory[p] = malloc(aligned ? span+2*GUARD+64 : span+shift);
+		if(!image->memory[p])
+		{
+			fprintf(stderr, "Failed to allocate a %ux%u image\n", width, height);
+			exit(EXIT_FAILURE);
+		}
+		if(aligned)
+		{
+			image->planes[p] = ALIGN_PTR64(image->memory[p]+GUARD);
+			image->begin[p] = image->planes[p]-GUARD;
+			image->end[p] = image->planes[p]+span+GUARD;
+		}
+		else
+		{
+			image->planes[p] = image->memory[p]+shift;
+			image->begin[p] = image->memory[p];
+			image->end[p] = image->planes[p]+span;
+		}
+		memset(image->begin[p], SENTINEL, (size_t)(image->end[p]-image->begin[p]));
+	}
+}
+
+static void image_free(Image *image)
+{
+	uint32_t p;
+	for(p=0; p<4; ++p)
+		free(image->memory[p]);
+	memset(image, 0, sizeof(Image));
+}
+
+typedef enum
+{
+	FILL_RANDOM,
+	FILL_BLACK,
+	FILL_WHITE,
+	// values at and around the limits of the ranges of the color spaces
+	FILL_EXTREME,
+	// bytes of the fuzzer input
+	FILL_DATA
+} Fill;
+
+#define FILL_NUMBER 4
+
+static const char *const FILL_NAMES[] = {"random", "black", "white", "extreme", "data"};
+static const uint8_t EXTREME_VALUES[] = {0, 1, 15, 16, 17, 127, 128, 129, 235, 236, 240, 241, 254, 255};
+
+// xorshift32, deterministic so that a failure can be reproduced
+static uint32_t random_state = 2463534242u;
+
+static uint32_t random_value(void)
+{
+	random_state ^= random_state<<13;
+	random_state ^= random_state>>17;
+	random_state ^= random_state<<5;
+	return random_state;
+}
+
+static const uint8_t *fill_data = NULL;
+static size_t fill_data_size = 0, fill_data_position = 0;
+
+static uint8_t fill_byte(Fill fill)
+{
+	switch(fill)
+	{
+		case FILL_BLACK:
+			return 0;
+		case FILL_WHITE:
+			return 255;
+		case FILL_EXTREME:
+			return EXTREME_VALUES[random_value()%ARRAY_SIZE(EXTREME_VALUES)];
+		case FILL_DATA:
+			if(fill_data_size>0)
+			{
+				if(fill_data_position>=fill_data_size)
+					fill_data_position = 0;
+				return fill_data[fill_data_position++];
+			}
+			return (uint8_t)(random_value()>>24);
+		default:
+			return (uint8_t)(random_value()>>24);
+	}
+}
+
+// fill an input image, including the bytes between its lines, the 16 bits samples being masked to their
+// significant bits
+static void image_fill(Image *image, Fill fill)
+{
+	uint32_t p;
+	size_t i;
+	for(p=0; p<plane_number(image->layout); ++p)
+	{
+		const size_t span = plane_span(image, p);
+		uint8_t *plane = image->planes[p];
+		for(i=0; i<span; ++i)
+			plane[i] = fill_byte(fill);
+		if(image->layout->bits)
+			for(i=0; i+1<span; i+=2)
+			{
+				uint16_t value;
+				memcpy(&value, plane+i, 2);
+				value &= (uint16_t)((1u<<image->layout->bits)-1);
+				memcpy(plane+i, &value, 2);
+			}
+	}
+}
+
+static uint32_t failure_number = 0;
+
+// only the first failures are printed
+#define MAX_REPORTS 50
+
+static void report(const char *format, ...)
+{
+	va_list arguments;
+	if(failure_number>=MAX_REPORTS)
+		return;
+	va_start(arguments, format);
+	vprintf(format, arguments);
+	va_end(arguments);
+}
+
+// compare the lines of image with those of expected (of the same layout and strides), and check that the other
+// bytes of the checked areas of its planes are still SENTINEL
+// return 0 if they match, or print the first difference and return 1
+static int image_compare(const Image *expected, const Image *image, const char *context)
+{
+	uint32_t p;
+	for(p=0; p<plane_number(image->layout); ++p)
+	{
+		uint32_t line_size, lines, index, line, x;
+		plane_geometry(image->layout, p, image->width, image->height, &line_size, &lines, &index);
+		const uint32_t stride = image->strides[index];
+		const uint8_t *e = expected->planes[p], *g = image->planes[p];
+		int difference = 0;
+		uint32_t first_line = 0, first_x = 0;
+		for(line=0; line<lines; ++line)
+			for(x=0; x<line_size; ++x)
+			{
+				const size_t i = line*(size_t)stride+x;
+				const int d = abs((int)e[i]-(int)g[i]);
+				if(d>0 && difference==0)
+				{
+					first_line = line;
+					first_x = x;
+				}
+				if(d>difference)
+					difference = d;
+			}
+		if(difference>0)
+		{
+			const size_t i = first_line*(size_t)stride+first_x;
+			report("%s: plane %u differs at line %u byte %u (expected %u, got %u, largest difference %d)\n",
+				context, p, first_line, first_x, e[i], g[i], difference);
+			return 1;
+		}
+
+		const uint8_t *q;
+		for(q=image->begin[p]; q<image->end[p]; ++q)
+		{
+			const ptrdiff_t position = q-image->planes[p];
+			if(position>=0 && (size_t)position%stride<line_size && (size_t)position/stride<lines)
+				continue;
+			if(*q!=SENTINEL)
+			{
+				report("%s: plane %u modified at byte %ld, outside of the lines\n", context, p, (long)position);
+				return 1;
+			}
+		}
+	}
+	return 0;
+}
+
+// conversion of the image src into the image dst, of the same size
+typedef void (*ConvertFunction)(const Image *src, const Image *dst, YCbCrType yuv_type);
+
+// pool of the multi-threaded and batch conversions
+static yuv_rgb_pool *test_pool = NULL;
+
+static const RGBNormalization TEST_NORMALIZATION = {{123.675f, 116.28f, 103.53f}, {0.017125f, 0.017507f, 0.017429f}};
+
+// calls of the conversions of each class with the planes and strides of s and d, EXTRA being empty or the additional
+// arguments of the rotated and rectangles conversions
+#define YUV420_RGB_CALL(F, EXTRA) F(s->width, s->height, s->planes[0], s->planes[1], s->planes[2], s->strides[0], \
+	s->strides[1], d->planes[0], d->strides[0], t EXTRA)
+#define NV12_RGB_CALL(F, EXTRA) F(s->width, s->height, s->planes[0], s->planes[1], s->strides[0], s->strides[1], \
+	d->planes[0], d->strides[0], t EXTRA)
+#define PACKED_RGB_CALL(F, EXTRA) F(s->width, s->height, s->planes[0], s->strides[0], d->planes[0], d->strides[0], \
+	t EXTRA)
+#define RGB_YUV420_CALL(F, EXTRA) F(s->width, s->height, s->planes[0], s->strides[0], d->planes[0], d->planes[1], \
+	d->planes[2], d->strides[0], d->strides[1], t EXTRA)
+#define RGB_NV12_CALL(F, EXTRA) F(s->width, s->height, s->planes[0], s->strides[0], d->planes[0], d->planes[1], \
+	d->strides[0], d->strides[1], t EXTRA)
+#define RGB_PACKED_CALL(F, EXTRA) F(s->width, s->height, s->planes[0], s->strides[0], d->planes[0], d->strides[0], \
+	t EXTRA)
+#define YUV420_PLANAR_CALL(F, EXTRA) F(s->width, s->height, s->planes[0], s->planes[1], s->planes[2], s->strides[0], \
+	s->strides[1], d->planes[0], d->planes[1], d->planes[2], d->strides[0], t EXTRA)
+#define NV12_PLANAR_CALL(F, EXTRA) F(s->width, s->height, s->planes[0], s->planes[1], s->strides[0], s->strides[1], \
+	d->planes[0], d->planes[1], d->planes[2], d->strides[0], t EXTRA)
+#define YUV420_PLANAR_FLOAT_CALL(F, TYPE, EXTRA) F(s->width, s->height, s->planes[0], s->planes[1], s->planes[2], \
+	s->strides[0], s->strides[1], (TYPE *)d->planes[0], (TYPE *)d->planes[1], (TYPE *)d->planes[2], d->strides[0], \
+	&TEST_NORMALIZATION, t EXTRA)
+#define NV12_PLANAR_FLOAT_CALL(F, TYPE, EXTRA) F(s->width, s->height, s->planes[0], s->planes[1], s->strides[0], \
+	s->strides[1], (TYPE *)d->planes[0], (TYPE *)d->planes[1], (TYPE *)d->planes[2], d->strides[0], \
+	&TEST_NORMALIZATION, t EXTRA)
+#define YUV420_PLANAR_F32_CALL(F, EXTRA) YUV420_PLANAR_FLOAT_CALL(F, float, EXTRA)
+#define NV12_PLANAR_F32_CALL(F, EXTRA) NV12_PLANAR_FLOAT_CALL(F, float, EXTRA)
+#define YUV420_PLANAR_F16_CALL(F, EXTRA) YUV420_PLANAR_FLOAT_CALL(F, uint16_t, EXTRA)
+#define NV12_PLANAR_F16_CALL(F, EXTRA) NV12_PLANAR_FLOAT_CALL(F, uint16_t, EXTRA)
+#define YUV16_RGB_CALL(F, EXTRA) F(s->width, s->height, (const uint16_t *)s->planes[0], \
+	(const uint16_t *)s->planes[1], (const uint16_t *)s->planes[2], s->strides[0], s->strides[1], d->planes[0], \
+	d->strides[0], t EXTRA)
+#define P016_RGB_CALL(F, EXTRA) F(s->width, s->height, (const uint16_t *)s->planes[0], \
+	(const uint16_t *)s->planes[1], s->strides[0], s->strides[1], d->planes[0], d->strides[0], t EXTRA)
+#define NV12_YUV420_CALL(F, EXTRA) F(s->width, s->height, s->planes[0], s->planes[1], s->strides[0], s->strides[1], \
+	d->planes[0], d->planes[1], d->planes[2], d->strides[0], d->strides[1] EXTRA)
+#define YUV420_NV12_CALL(F, EXTRA) F(s->width, s->height, s->planes[0], s->planes[1], s->planes[2], s->strides[0], \
+	s->strides[1], d->planes[0], d->planes[1], d->strides[0], d->strides[1] EXTRA)
+#define PACKED_YUV420_CALL(F, EXTRA) F(s->width, s->height, s->planes[0], s->strides[0], d->planes[0], d->planes[1], \
+	d->planes[2], d->strides[0], d->strides[1] EXTRA)
+#define PACKED_NV12_CALL(F, EXTRA) F(s->width, s->height, s->planes[0], s->strides[0], d->planes[0], d->planes[1], \
+	d->strides[0], d->strides[1] EXTRA)
+#define YUV420_PACKED_CALL(F, EXTRA) F(s->width, s->height, s->planes[0], s->planes[1], s->planes[2], s->strides[0], \
+	s->strides[1], d->planes[0], d->strides[0] EXTRA)
+#define NV12_PACKED_CALL(F, EXTRA) F(s->width, s->height, s->planes[0], s->planes[1], s->strides[0], s->strides[1], \
+	d->planes[0], d->strides[0] EXTRA)
+#define RGB_YUVA_CALL(F, EXTRA) F(s->width, s->height, s->planes[0], s->strides[0], d->planes[0], d->planes[1], \
+	d->planes[2], d->planes[3], d->strides[0], d->strides[1], 0, t EXTRA)
+#define RGB_YUVA_PREMULTIPLIED_CALL(F, EXTRA) F(s->width, s->height, s->planes[0], s->strides[0], d->planes[0], \
+	d->planes[1], d->planes[2], d->planes[3], d->strides[0], d->strides[1], 1, t EXTRA)
+#define RGB_YUVA_NO_ALPHA_CALL(F, EXTRA) F(s->width, s->height, s->planes[0], s->strides[0], d->planes[0], \
+	d->planes[1], d->planes[2], NULL, d->strides[0], d->strides[1], 1, t EXTRA)
+#define YUVA_RGB_CALL(F, EXTRA) F(s->width, s->height, s->planes[0], s->planes[1], s->planes[2], s->planes[3], \
+	s->strides[0], s->strides[1], d->planes[0], d->strides[0], t EXTRA)
+// the multi-threaded conversions are called as NAME_mt WITH_POOL(arguments), which adds the pool before the
+// arguments of the CALL macro of their class
+#define WITH_POOL(...) (test_pool, __VA_ARGS__)
+
+#define WRAPPER(CLASS, FUNCTION) \
+static void test_##CLASS##_##FUNCTION(const Image *s, const Image *d, YCbCrType t) \
+{ \
+	(void)t; \
+	CLASS##_CALL(FUNCTION, ); \
+}
+
+// all conversions tested against their standard c implementation, X(CLASS, NAME, SRC, DST, SET) defining each of
+// them, SET being the implementations that exist (see IMPLEMENTATIONS_ALL, ...)
+#define FORMAT_CONVERSIONS(X, FORMAT, LAYOUT) \
+	X(YUV420_RGB, yuv420_##FORMAT, YUV420, LAYOUT, ALL) \
+	X(NV12_RGB, nv12_##FORMAT, NV12, LAYOUT, ALL) \
+	X(NV12_RGB, nv21_##FORMAT, NV12, LAYOUT, ALL)
+#define YUV16_CONVERSIONS(X, FORMAT, LAYOUT) \
+	X(YUV16_RGB, yuv420p10_##FORMAT, YUV420_10, LAYOUT, ALL) \
+	X(P016_RGB, p010_##FORMAT, NV12_16, LAYOUT, ALL)
+#define LINES_CONVERSIONS(X, FORMAT, LAYOUT) \
+	X(YUV420_RGB, yuv422p_##FORMAT, YUV422P, LAYOUT, ALL) \
+	X(YUV420_RGB, yuv444p_##FORMAT, YUV444P, LAYOUT, ALL) \
+	X(NV12_RGB, nv16_##FORMAT, NV16, LAYOUT, ALL) \
+	X(NV12_RGB, nv24_##FORMAT, NV24, LAYOUT, ALL) \
+	X(PACKED_RGB, yuyv_##FORMAT, PACKED422, LAYOUT, ALL) \
+	X(PACKED_RGB, uyvy_##FORMAT, PACKED422, LAYOUT, ALL) \
+	X(RGB_YUV420, FORMAT##_yuv422p, LAYOUT, YUV422P, ALL) \
+	X(RGB_YUV420, FORMAT##_yuv444p, LAYOUT, YUV444P, ALL) \
+	X(RGB_NV12, FORMAT##_nv16, LAYOUT, NV16, ALL) \
+	X(RGB_NV12, FORMAT##_nv24, LAYOUT, NV24, ALL) \
+	X(RGB_PACKED, FORMAT##_yuyv, LAYOUT, PACKED422, ALL) \
+	X(RGB_PACKED, FORMAT##_uyvy, LAYOUT, PACKED422, ALL)
+#define CONVERSIONS(X) \
+	X(YUV420_RGB, yuv420_rgb24, YUV420, RGB24, AVX512) \
+	X(NV12_RGB, nv12_rgb24, NV12, RGB24, AVX512) \
+	X(NV12_RGB, nv21_rgb24, NV12, RGB24, AVX512) \
+	FORMAT_CONVERSIONS(X, rgb32, RGB32) \
+	FORMAT_CONVERSIONS(X, bgra, RGB32) \
+	FORMAT_CONVERSIONS(X, argb, RGB32) \
+	FORMAT_CONVERSIONS(X, bgr24, RGB24) \
+	FORMAT_CONVERSIONS(X, rgb565, RGB565) \
+	X(YUV420_RGB, yuv420_rgb24_bilinear, YUV420, RGB24, UNALIGNED) \
+	X(NV12_RGB, nv12_rgb24_bilinear, NV12, RGB24, UNALIGNED) \
+	X(NV12_RGB, nv21_rgb24_bilinear, NV12, RGB24, UNALIGNED) \
+	X(YUV420_PLANAR, yuv420_rgb_planar, YUV420, PLANAR_U8, ALL) \
+	X(NV12_PLANAR, nv12_rgb_planar, NV12, PLANAR_U8, ALL) \
+	X(NV12_PLANAR, nv21_rgb_planar, NV12, PLANAR_U8, ALL) \
+	X(YUV420_PLANAR_F32, yuv420_rgb_planar_f32, YUV420, PLANAR_F32, ALL) \
+	X(NV12_PLANAR_F32, nv12_rgb_planar_f32, NV12, PLANAR_F32, ALL) \
+	X(NV12_PLANAR_F32, nv21_rgb_planar_f32, NV12, PLANAR_F32, ALL) \
+	X(YUV420_PLANAR_F16, yuv420_rgb_planar_f16, YUV420, PLANAR_F16, ALL) \
+	X(NV12_PLANAR_F16, nv12_rgb_planar_f16, NV12, PLANAR_F16, ALL) \
+	X(NV12_PLANAR_F16, nv21_rgb_planar_f16, NV12, PLANAR_F16, ALL) \
+	YUV16_CONVERSIONS(X, rgb24, RGB24) \
+	YUV16_CONVERSIONS(X, rgb48, RGB48) \
+	YUV16_CONVERSIONS(X, x2rgb10, X2RGB10) \
+	LINES_CONVERSIONS(X, rgb24, RGB24) \
+	LINES_CONVERSIONS(X, rgb32, RGB32) \
+	X(NV12_YUV420, nv12_yuv420, NV12, YUV420, ALL) \
+	X(NV12_YUV420, nv21_yuv420, NV12, YUV420, ALL) \
+	X(YUV420_NV12, yuv420_nv12, YUV420, NV12, ALL) \
+	X(YUV420_NV12, yuv420_nv21, YUV420, NV12, ALL) \
+	X(PACKED_YUV420, yuyv_yuv420, PACKED422, YUV420, ALL) \
+	X(PACKED_YUV420, uyvy_yuv420, PACKED422, YUV420, ALL) \
+	X(PACKED_NV12, yuyv_nv12, PACKED422, NV12, ALL) \
+	X(PACKED_NV12, uyvy_nv12, PACKED422, NV12, ALL) \
+	X(YUV420_PACKED, yuv420_yuyv, YUV420, PACKED422, ALL) \
+	X(YUV420_PACKED, yuv420_uyvy, YUV420, PACKED422, ALL) \
+	X(NV12_PACKED, nv12_yuyv, NV12, PACKED422, ALL) \
+	X(NV12_PACKED, nv12_uyvy, NV12, PACKED422, ALL) \
+	X(RGB_YUV420, rgb24_yuv420, RGB24, YUV420, AVX2) \
+	X(RGB_YUV420, rgb32_yuv420, RGB32, YUV420, AVX2) \
+	X(RGB_YUV420, rgb24_yuv420_precise, RGB24, YUV420, ALL) \
+	X(RGB_YUV420, rgb32_yuv420_precise, RGB32, YUV420, ALL) \
+	X(RGB_YUVA, rgb32_yuva420, RGB32, YUVA420, ALL) \
+	X(RGB_YUVA_PREMULTIPLIED, rgb32_yuva420, RGB32, YUVA420, ALL) \
+	X(RGB_YUVA_NO_ALPHA, rgb32_yuva420, RGB32, YUV420, ALL) \
+	X(YUVA_RGB, yuva420_rgb32, YUVA420, RGB32, ALL) \
+	X(YUVA_RGB, yuva420_bgra_premultiplied, YUVA420, RGB32, ALL)
+
+// implementations of a conversion, Y(CLASS, NAME, SRC, DST, SUFFIX, IMPLEMENTATION, ALIGNED_ONLY, CPU) defining
+// each of them
+#ifdef _YUVRGB_SSE2_
+#define SSE_IMPLEMENTATIONS(Y, CLASS, NAME, SRC, DST) \
+	Y(CLASS, NAME, SRC, DST, _sse, "sse", 1, CPU_ANY) \
+	Y(CLASS, NAME, SRC, DST, _sseu, "sseu", 0, CPU_ANY)
+#define SSEU_IMPLEMENTATIONS(Y, CLASS, NAME, SRC, DST) \
+	Y(CLASS, NAME, SRC, DST, _sseu, "sseu", 0, CPU_ANY)
+#else
+#define SSE_IMPLEMENTATIONS(Y, CLASS, NAME, SRC, DST)
+#define SSEU_IMPLEMENTATIONS(Y, CLASS, NAME, SRC, DST)
+#endif
+#if USE_AVX2
+#define AVX2_IMPLEMENTATIONS(Y, CLASS, NAME, SRC, DST) \
+	Y(CLASS, NAME, SRC, DST, _avx2, "avx2", 1, CPU_AVX2) \
+	Y(CLASS, NAME, SRC, DST, _avx2u, "avx2u", 0, CPU_AVX2)
+#else
+#define AVX2_IMPLEMENTATIONS(Y, CLASS, NAME, SRC, DST)
+#endif
+#if USE_AVX512
+#define AVX512_IMPLEMENTATIONS(Y, CLASS, NAME, SRC, DST) \
+	Y(CLASS, NAME, SRC, DST, _avx512, "avx512", 1, CPU_AVX512) \
+	Y(CLASS, NAME, SRC, DST, _avx512u, "avx512u", 0, CPU_AVX512)
+#else
+#define AVX512_IMPLEMENTATIONS(Y, CLASS, NAME, SRC, DST)
+#endif
+#ifdef __aarch64__
+#define NEON_IMPLEMENTATIONS(Y, CLASS, NAME, SRC, DST) \
+	Y(CLASS, NAME, SRC, DST, _neon, "neon", 0, CPU_ANY)
+#else
+#define NEON_IMPLEMENTATIONS(Y, CLASS, NAME, SRC, DST)
+#endif
+
+#define IMPLEMENTATIONS_ALL(Y, CLASS, NAME, SRC, DST) \
+	Y(CLASS, NAME, SRC, DST, _std, "std", 0, CPU_ANY) \
+	SSE_IMPLEMENTATIONS(Y, CLASS, NAME, SRC, DST) \
+	NEON_IMPLEMENTATIONS(Y, CLASS, NAME, SRC, DST) \
+	Y(CLASS, NAME, SRC, DST, , "auto", 0, CPU_ANY)
+#define IMPLEMENTATIONS_AVX2(Y, CLASS, NAME, SRC, DST) \
+	IMPLEMENTATIONS_ALL(Y, CLASS, NAME, SRC, DST) \
+	AVX2_IMPLEMENTATIONS(Y, CLASS, NAME, SRC, DST)
+#define IMPLEMENTATIONS_AVX512(Y, CLASS, NAME, SRC, DST) \
+	IMPLEMENTATIONS_AVX2(Y, CLASS, NAME, SRC, DST) \
+	AVX512_IMPLEMENTATIONS(Y, CLASS, NAME, SRC, DST)
+// bilinear conversions, which only have unaligned simd implementations
+#define IMPLEMENTATIONS_UNALIGNED(Y, CLASS, NAME, SRC, DST) \
+	Y(CLASS, NAME, SRC, DST, _std, "std", 0, CPU_ANY) \
+	SSEU_IMPLEMENTATIONS(Y, CLASS, NAME, SRC, DST) \
+	NEON_IMPLEMENTATIONS(Y, CLASS, NAME, SRC, DST) \
+	Y(CLASS, NAME, SRC, DST, , "auto", 0, CPU_ANY)
+
+#define WRAPPER_IMPLEMENTATION(CLASS, NAME, SRC, DST, SUFFIX, IMPLEMENTATION, ALIGNED_ONLY, CPU) \
+	WRAPPER(CLASS, NAME##SUFFIX)
+#define WRAPPERS(CLASS, NAME, SRC, DST, SET) IMPLEMENTATIONS_##SET(WRAPPER_IMPLEMENTATION, CLASS, NAME, SRC, DST)
+
+// multi-threaded versions, Y(CLASS, NAME, SRC, DST) defining each of them (the bilinear conversions have none)
+#define MT_ALL(Y, CLASS, NAME, SRC, DST) Y(CLASS, NAME, SRC, DST)
+#define MT_AVX2 MT_ALL
+#define MT_AVX512 MT_ALL
+#define MT_UNALIGNED(Y, CLASS, NAME, SRC, DST)
+
+#define MT_WRAPPER(CLASS, NAME, SRC, DST) \
+static void test_##CLASS##_MT_##NAME##_mt(const Image *s, const Image *d, YCbCrType t) \
+{ \
+	(void)t; \
+	CLASS##_CALL(NAME##_mt WITH_POOL, ); \
+}
+#define MT_WRAPPERS(CLASS, NAME, SRC, DST, SET) MT_##SET(MT_WRAPPER, CLASS, NAME, SRC, DST)
+
+CONVERSIONS(WRAPPERS)
+CONVERSIONS(MT_WRAPPERS)
+
+// the batch conversions split the image in up to BATCH_FRAMES bands of pairs of lines converted as separate frames,
+// with the pool for odd heights and in the calling thread otherwise
+#define BATCH_FRAMES 8
+
+static uint32_t batch_band(uint32_t height)
+{
+	return 2*((height+2*BATCH_FRAMES-1)/(2*BATCH_FRAMES));
+}
+
+static void test_batch_yuv420_rgb24_batch(const Image *s, const Image *d, YCbCrType t)
+{
+	YUV2RGBFrame frames[BATCH_FRAMES];
+	const uint32_t band = batch_band(s->height);
+	uint32_t n = 0, line;
+	for(line=0; line<s->height; line+=band, ++n)
+	{
+		YUV2RGBFrame *frame = frames+n;
+		frame->width = s->width;
+		frame->height = s->height-line<band ? s->height-line : band;
+		frame->y = s->planes[0]+line*(size_t)s->strides[0];
+		frame->u = s->planes[1]+(line/2)*(size_t)s->strides[1];
+		frame->v = s->planes[2]+(line/2)*(size_t)s->strides[1];
+		frame->y_stride = s->strides[0];
+		frame->uv_stride = s->strides[1];
+		frame->rgb = d->planes[0]+line*(size_t)d->strides[0];
+		frame->rgb_stride = d->strides[0];
+		frame->yuv_type = t;
+	}
+	yuv420_rgb24_batch(s->height%2 ? test_pool : NULL, frames, n);
+}
+
+static void rgb_yuv420_batch(const Image *s, const Image *d, YCbCrType t,
+	void (*batch)(yuv_rgb_pool *, const RGB2YUVFrame *, uint32_t))
+{
+	RGB2YUVFrame frames[BATCH_FRAMES];
+	const uint32_t band = batch_band(s->height);
+	uint32_t n = 0, line;
+	for(line=0; line<s->height; line+=band, ++n)
+	{
+		RGB2YUVFrame *frame = frames+n;
+		frame->width = s->width;
+		frame->height = s->height-line<band ? s->height-line : band;
+		frame->rgb = s->planes[0]+line*(size_t)s->strides[0];
+		frame->rgb_stride = s->strides[0];
+		frame->y = d->planes[0]+line*(size_t)d->strides[0];
+		frame->u = d->planes[1]+(line/2)*(size_t)d->strides[1];
+		frame->v = d->planes[2]+(line/2)*(size_t)d->strides[1];
+		frame->y_stride = d->strides[0];
+		frame->uv_stride = d->strides[1];
+		frame->yuv_type = t;
+	}
+	batch(s->height%2 ? test_pool : NULL, frames, n);
+}
+
+static void test_batch_rgb24_yuv420_batch(const Image *s, const Image *d, YCbCrType t)
+{
+	rgb_yuv420_batch(s, d, t, rgb24_yuv420_batch);
+}
+
+static void test_batch_rgb32_yuv420_batch(const Image *s, const Image *d, YCbCrType t)
+{
+	rgb_yuv420_batch(s, d, t, rgb32_yuv420_batch);
+}
+
+// a conversion to test, compared with reference
+typedef struct
+{
+	const char *name;
+	const char *implementation;
+	const char *kind;
+	const Layout *src, *dst;
+	ConvertFunction reference, convert;
+	int aligned_only;
+	CaseCpu cpu;
+} Case;
+
+#define CASE_IMPLEMENTATION(CLASS, NAME, SRC, DST, SUFFIX, IMPLEMENTATION, ALIGNED_ONLY, CPU) \
+	{#NAME, IMPLEMENTATION, #CLASS, &LAYOUT_##SRC, &LAYOUT_##DST, test_##CLASS##_##NAME##_std, \
+		test_##CLASS##_##NAME##SUFFIX, ALIGNED_ONLY, CPU},
+#define CASES(CLASS, NAME, SRC, DST, SET) IMPLEMENTATIONS_##SET(CASE_IMPLEMENTATION, CLASS, NAME, SRC, DST)
+#define MT_CASE(CLASS, NAME, SRC, DST) \
+	{#NAME, "mt", #CLASS, &LAYOUT_##SRC, &LAYOUT_##DST, test_##CLASS##_##NAME##_std, \
+		test_##CLASS##_MT_##NAME##_mt, 0, CPU_ANY},
+#define MT_CASES(CLASS, NAME, SRC, DST, SET) MT_##SET(MT_CASE, CLASS, NAME, SRC, DST)
+#define BATCH_CASE(CLASS, NAME, SRC, DST) \
+	{#NAME, "batch", #CLASS, &LAYOUT_##SRC, &LAYOUT_##DST, test_##CLASS##_##NAME##_std, \
+		test_batch_##NAME##_batch, 0, CPU_ANY},
+
+static const Case CASES_TABLE[] = {
+	CONVERSIONS(CASES)
+	CONVERSIONS(MT_CASES)
+	BATCH_CASE(YUV420_RGB, yuv420_rgb24, YUV420, RGB24)
+	BATCH_CASE(RGB_YUV420, rgb24_yuv420, RGB24, YUV420)
+	BATCH_CASE(RGB_YUV420, rgb32_yuv420, RGB32, YUV420)
+};
+
+#define CASE_NUMBER ARRAY_SIZE(CASES_TABLE)
+
+// custom color spaces of the tests: bt.601, bt.709 full range, a narrow range and unusual coefficients
+static int set_custom_color_spaces(void)
+{
+	return yuv_rgb_set_custom_color_space(YCBCR_CUSTOM_0, 0.299, 0.114, 16.0, 235.0, 224.0) |
+		yuv_rgb_set_custom_color_space(YCBCR_CUSTOM_1, 0.2126, 0.0722, 0.0, 255.0, 255.0) |
+		yuv_rgb_set_custom_color_space(YCBCR_CUSTOM_2, 0.2627, 0.0593, 32.0, 200.0, 160.0) |
+		yuv_rgb_set_custom_color_space(YCBCR_CUSTOM_3, 0.25, 0.25, 8.0, 250.0, 240.0);
+}
+
+// convert a width x height image filled with fill with reference and with the conversion of c, and compare them
+// return 0 if they match, 1 otherwise
+static int check_case(const Case *c, uint32_t width, uint32_t height, YCbCrType yuv_type, int aligned,
+	uint32_t padding, uint32_t offset, Fill fill)
+{
+	Image src, expected, dst;
+	char context[256];
+	int result;
+
+	image_alloc(&src, c->src, width, height, aligned, padding, offset);
+	image_alloc(&expected, c->dst, width, height, aligned, padding, offset+1);
+	image_alloc(&dst, c->dst, width, height, aligned, padding, offset+2);
+	image_fill(&src, fill);
+	c->reference(&src, &expected, yuv_type);
+	c->convert(&src, &dst, yuv_type);
+
+	snprintf(context, sizeof(context), "%s %s (%s, %ux%u, type %d, %s, padding %u, offset %u, %s)", c->name,
+		c->implementation, c->kind, width, height, (int)yuv_type, aligned ? "aligned" : "unaligned", padding, offset,
+		FILL_NAMES[fill]);
+	result = image_compare(&expected, &dst, context);
+
+	image_free(&src);
+	image_free(&expected);
+	image_free(&dst);
+	return result;
+}
+
+#ifdef FUZZER
+
+// the input starts with 8 bytes selecting the conversion and the images, followed by the content of the source image
+// (repeated if it is too short)
+#define HEADER_SIZE 8
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	static int initialized = 0;
+	if(!initialized)
+	{
+		if(set_custom_color_spaces()!=0)
+			abort();
+		test_pool = yuv_rgb_pool_create(2, NULL);
+		initialized = 1;
+	}
+	if(size<HEADER_SIZE)
+		return 0;
+
+	const uint32_t width = 1+(uint32_t)(data[0] | data[1]<<8)%320, height = 1+(uint32_t)data[2]%64;
+	const Case *c = CASES_TABLE+(data[3] | data[4]<<8)%CASE_NUMBER;
+	const YCbCrType yuv_type = (YCbCrType)(data[5]%YCBCR_TYPE_COUNT);
+	const int aligned = c->aligned_only || (data[6]&1);
+	if(!cpu_supports(c->cpu))
+		return 0;
+
+	fill_data = data+HEADER_SIZE;
+	fill_data_size = size-HEADER_SIZE;
+	fill_data_position = 0;
+	if(check_case(c, width, height, yuv_type, aligned, data[6]>>1, data[7], FILL_DATA)!=0)
+		abort();
+	return 0;
+}
+
+#else
+
+static uint32_t test_number = 0;
+
+static int check(int failed)
+{
+	++test_number;
+	failure_number += failed!=0;
+	return failed;
+}
+
+// rotate the packed rgb image src, after mirroring it if flip is set, into dst
+static void rotate_image(const Image *src, const Image *dst, YUVRGBRotation rotation, int flip)
+{
+	const uint32_t bpp = src->layout->size, width = src->width, height = src->height;
+	uint32_t x, y;
+	for(y=0; y<height; ++y)
+		for(x=0; x<width; ++x)
+		{
+			const uint32_t sx = flip ? width-1-x : x;
+			uint32_t dx, dy;
+			switch(rotation)
+			{
+				case YUVRGB_ROTATE_90:
+					dx = height-1-y;
+					dy = sx;
+					break;
+				case YUVRGB_ROTATE_180:
+					dx = width-1-sx;
+					dy = height-1-y;
+					break;
+				case YUVRGB_ROTATE_270:
+					dx = y;
+					dy = width-1-sx;
+					break;
+				default:
+					dx = sx;
+					dy = y;
+					break;
+			}
+			memcpy(dst->planes[0]+dy*(size_t)dst->strides[0]+dx*bpp, src->planes[0]+y*(size_t)src->strides[0]+x*bpp,
+				bpp);
+		}
+}
+
+// copy the pixels of rect (snapped to pairs of lines and columns) from src to dst, of the same layout
+static void copy_rect(const Image *src, const Image *dst, const YUVRGBRect *rect)
+{
+	uint32_t p, line;
+	for(p=0; p<plane_number(src->layout); ++p)
+	{
+		uint32_t line_size, lines, index;
+		plane_geometry(src->layout, p, src->width, src->height, &line_size, &lines, &index);
+		// the chroma planes have half the size of the image
+		const uint32_t shift = index, columns = (src->width+shift)>>shift, bpp = line_size/columns,
+			x = rect->x>>shift, y = rect->y>>shift, end_x = (rect->x+rect->width+shift)>>shift,
+			end_y = (rect->y+rect->height+shift)>>shift, stride = src->strides[index];
+		for(line=y; line<end_y; ++line)
+			memcpy(dst->planes[p]+line*(size_t)stride+x*bpp, src->planes[p]+line*(size_t)stride+x*bpp,
+				(end_x-x)*bpp);
+	}
+}
+
+#define ROTATE_ARGUMENTS , rotation, flip
+#define RECTS_ARGUMENTS , rects, rect_number
+
+typedef void (*RotateFunction)(const Image *src, const Image *dst, YCbCrType yuv_type, YUVRGBRotation rotation,
+	int flip);
+typedef void (*RectsFunction)(const Image *src, const Image *dst, YCbCrType yuv_type, const YUVRGBRect *rects,
+	uint32_t rect_number);
+
+#define ROTATE_WRAPPER(CLASS, NAME, SRC, DST) \
+static void test_##NAME##_rotate(const Image *s, const Image *d, YCbCrType t, YUVRGBRotation rotation, int flip) \
+{ \
+	CLASS##_CALL(NAME##_rotate, ROTATE_ARGUMENTS); \
+}
+#define RECTS_WRAPPER(CLASS, NAME, SRC, DST) \
+static void test_##NAME##_rects(const Image *s, const Image *d, YCbCrType t, const YUVRGBRect *rects, \
+	uint32_t rect_number) \
+{ \
+	CLASS##_CALL(NAME##_rects, RECTS_ARGUMENTS); \
+}
+
+#define ROTATE_CONVERSIONS(X) \
+	X(YUV420_RGB, yuv420_rgb24, YUV420, RGB24) \
+	X(NV12_RGB, nv12_rgb24, NV12, RGB24) \
+	X(NV12_RGB, nv21_rgb24, NV12, RGB24) \
+	X(RGB_YUV420, rgb24_yuv420, RGB24, YUV420) \
+	X(YUV420_RGB, yuv420_rgb32, YUV420, RGB32) \
+	X(NV12_RGB, nv12_rgb32, NV12, RGB32) \
+	X(NV12_RGB, nv21_rgb32, NV12, RGB32) \
+	X(RGB_YUV420, rgb32_yuv420, RGB32, YUV420)
+#define RECTS_CONVERSIONS(X) \
+	X(YUV420_RGB, yuv420_rgb24, YUV420, RGB24) \
+	X(RGB_YUV420, rgb24_yuv420, RGB24, YUV420) \
+	X(YUV420_RGB, yuv420_rgb32, YUV420, RGB32) \
+	X(RGB_YUV420, rgb32_yuv420, RGB32, YUV420)
+
+ROTATE_CONVERSIONS(ROTATE_WRAPPER)
+RECTS_CONVERSIONS(RECTS_WRAPPER)
+
+// a conversion of a part of the api built on the whole image conversions, compared with reference
+typedef struct
+{
+	const char *name;
+	const Layout *src, *dst;
+	ConvertFunction reference;
+	RotateFunction rotate;
+	RectsFunction rects;
+} PathCase;
+
+#define ROTATE_CASE(CLASS, NAME, SRC, DST) \
+	{#NAME "_rotate", &LAYOUT_##SRC, &LAYOUT_##DST, test_##CLASS##_##NAME##_std, test_##NAME##_rotate, NULL},
+#define RECTS_CASE(CLASS, NAME, SRC, DST) \
+	{#NAME "_rects", &LAYOUT_##SRC, &LAYOUT_##DST, test_##CLASS##_##NAME##_std, NULL, test_##NAME##_rects},
+
+static const PathCase ROTATE_CASES[] = {ROTATE_CONVERSIONS(ROTATE_CASE)};
+static const PathCase RECTS_CASES[] = {RECTS_CONVERSIONS(RECTS_CASE)};
+
+static const uint32_t PATH_SIZES[][2] = {
+	{1, 1}, {2, 2}, {3, 5}, {17, 4}, {33, 2}, {64, 7}, {65, 66}, {129, 3}, {130, 131}, {257, 9}
+};
+
+// the image is rotated after its conversion for yuv to rgb, and before for rgb to yuv
+static int check_rotate(const PathCase *c, uint32_t width, uint32_t height, YCbCrType yuv_type, int aligned,
+	uint32_t padding, YUVRGBRotation rotation, int flip)
+{
+	const int swap = rotation==YUVRGB_ROTATE_90 || rotation==YUVRGB_ROTATE_270;
+	const uint32_t dst_width = swap ? height : width, dst_height = swap ? width : height;
+	const int rgb_source = c->src->type==IMAGE_PACKED;
+	Image src, rotated, expected, dst;
+	char context[256];
+	int result;
+
+	image_alloc(&src, c->src, width, height, aligned, padding, 0);
+	image_fill(&src, (Fill)(rotation%FILL_NUMBER));
+	if(rgb_source)
+	{
+		image_alloc(&rotated, c->src, dst_width, dst_height, aligned, padding, 1);
+		rotate_image(&src, &rotated, rotation, flip);
+		image_alloc(&expected, c->dst, dst_width, dst_height, aligned, padding, 2);
+		c->reference(&rotated, &expected, yuv_type);
+	}
+	else
+	{
+		image_alloc(&rotated, c->dst, width, height, aligned, padding, 1);
+		c->reference(&src, &rotated, yuv_type);
+		image_alloc(&expected, c->dst, dst_width, dst_height, aligned, padding, 2);
+		rotate_image(&rotated, &expected, rotation, flip);
+	}
+	image_alloc(&dst, c->dst, dst_width, dst_height, aligned, padding, 3);
+	c->rotate(&src, &dst, yuv_type, rotation, flip);
+
+	snprintf(context, sizeof(context), "%s (%ux%u, type %d, %s, padding %u, rotation %d, flip %d)", c->name, width,
+		height, (int)yuv_type, aligned ? "aligned" : "unaligned", padding, 90*(int)rotation, flip);
+	result = image_compare(&expected, &dst, context);
+
+	image_free(&src);
+	image_free(&rotated);
+	image_free(&expected);
+	image_free(&dst);
+	return result;
+}
+
+// random rectangles, some of them empty or outside of the image, the other pixels of the output being unchanged
+static int check_rects(const PathCase *c, uint32_t width, uint32_t height, YCbCrType yuv_type, int aligned,
+	uint32_t padding)
+{
+	YUVRGBRect rects[4], snapped;
+	const uint32_t rect_number = 1+random_value()%ARRAY_SIZE(rects);
+	Image src, full, expected, dst;
+	char context[256];
+	uint32_t i;
+	int result;
+
+	image_alloc(&src, c->src, width, height, aligned, padding, 0);
+	image_fill(&src, FILL_RANDOM);
+	image_alloc(&full, c->dst, width, height, aligned, padding, 1);
+	c->reference(&src, &full, yuv_type);
+	image_alloc(&expected, c->dst, width, height, aligned, padding, 2);
+	image_alloc(&dst, c->dst, width, height, aligned, padding, 3);
+	for(i=0; i<rect_number; ++i)
+	{
+		rects[i].x = random_value()%(width+8);
+		rects[i].y = random_value()%(height+4);
+		rects[i].width = random_value()%(width+1);
+		rects[i].height = random_value()%(height+1);
+		if(yuv_rgb_rect_snap(rects+i, width, height, &snapped))
+			copy_rect(&full, &expected, &snapped);
+	}
+	c->rects(&src, &dst, yuv_type, rects, rect_number);
+
+	snprintf(context, sizeof(context), "%s (%ux%u, type %d, %s, padding %u, %u rectangles, first %u %u %u %u)",
+		c->name, width, height, (int)yuv_type, aligned ? "aligned" : "unaligned", padding, rect_number, rects[0].x,
+		rects[0].y, rects[0].width, rects[0].height);
+	result = image_compare(&expected, &dst, context);
+
+	image_free(&src);
+	image_free(&full);
+	image_free(&expected);
+	image_free(&dst);
+	return result;
+}
+
+typedef struct
+{
+	const char *name;
+	const Layout *src, *dst;
+	ConvertFunction reference;
+	void (*yuv_rgb_start)(yuv_rgb_stream *stream, uint8_t *rgb, uint32_t rgb_stride, YCbCrType yuv_type);
+	void (*rgb_yuv_start)(yuv_rgb_stream *stream, uint8_t *y, uint8_t *u, uint8_t *v, uint32_t y_stride,
+		uint32_t uv_stride, YCbCrType yuv_type);
+} StreamCase;
+
+static const StreamCase STREAM_CASES[] = {
+	{"yuv420_rgb24_stream", &LAYOUT_YUV420, &LAYOUT_RGB24, test_YUV420_RGB_yuv420_rgb24_std,
+		yuv420_rgb24_stream_start, NULL},
+	{"yuv420_rgb32_stream", &LAYOUT_YUV420, &LAYOUT_RGB32, test_YUV420_RGB_yuv420_rgb32_std,
+		yuv420_rgb32_stream_start, NULL},
+	{"rgb24_yuv420_stream", &LAYOUT_RGB24, &LAYOUT_YUV420, test_RGB_YUV420_rgb24_yuv420_std, NULL,
+		rgb24_yuv420_stream_start},
+	{"rgb32_yuv420_stream", &LAYOUT_RGB32, &LAYOUT_YUV420, test_RGB_YUV420_rgb32_yuv420_std, NULL,
+		rgb32_yuv420_stream_start}
+};
+
+// bands of random sizes, the number of written lines returned by each push being checked too
+static int check_stream(const StreamCase *c, uint32_t width, uint32_t height, YCbCrType yuv_type, int aligned,
+	uint32_t padding, uint32_t max_band)
+{
+	yuv_rgb_stream *stream = yuv_rgb_stream_create(width, height);
+	Image src, expected, dst;
+	char context[256];
+	uint32_t line = 0;
+	int result = 0;
+
+	snprintf(context, sizeof(context), "%s (%ux%u, type %d, %s, padding %u, bands of up to %u lines)", c->name, width,
+		height, (int)yuv_type, aligned ? "aligned" : "unaligned", padding, max_band);
+	if(!stream)
+	{
+		report("%s: yuv_rgb_stream_create failed\n", context);
+		return 1;
+	}
+	image_alloc(&src, c->src, width, height, aligned, padding, 0);
+	image_fill(&src, FILL_RANDOM);
+	image_alloc(&expected, c->dst, width, height, aligned, padding, 1);
+	c->reference(&src, &expected, yuv_type);
+	image_alloc(&dst, c->dst, width, height, aligned, padding, 2);
+
+	if(c->yuv_rgb_start)
+		c->yuv_rgb_start(stream, dst.planes[0], dst.strides[0], yuv_type);
+	else
+		c->rgb_yuv_start(stream, dst.planes[0], dst.planes[1], dst.planes[2], dst.strides[0], dst.strides[1],
+			yuv_type);
+	while(line<height && result==0)
+	{
+		const uint32_t n = 1+random_value()%max_band;
+		uint32_t written, expected_written;
+		if(c->yuv_rgb_start)
+		{
+			// first chroma line that was not in the previous bands, if any
+			const uint32_t uv_line = (line+1)/2<(height+1)/2 ? (line+1)/2 : 0;
+			written = yuv420_stream_push(stream, n, src.planes[0]+line*(size_t)src.strides[0],
+				src.planes[1]+uv_line*(size_t)src.strides[1], src.planes[2]+uv_line*(size_t)src.strides[1],
+				src.strides[0], src.strides[1]);
+		}
+		else
+			written = rgb_stream_push(stream, n, src.planes[0]+line*(size_t)src.strides[0], src.strides[0]);
+		line = height-line<n ? height : line+n;
+		// the first line of a pair is only converted with the second one from rgb
+		expected_written = !c->yuv_rgb_start && line%2 && line<height ? line-1 : line;
+		if(written!=expected_written)
+		{
+			report("%s: %u lines written after %u lines, instead of %u\n", context, written, line, expected_written);
+			result = 1;
+		}
+	}
+	if(result==0)
+		result = image_compare(&expected, &dst, context);
+
+	yuv_rgb_stream_destroy(stream);
+	image_free(&src);
+	image_free(&expected);
+	image_free(&dst);
+	return result;
+}
+
+// the yuv420, nv12 and nv21 scaled conversions of the same image must be identical, and equal to the conversion
+// without scaling for the same size
+static int check_scale(uint32_t width, uint32_t height, uint32_t dst_width, uint32_t dst_height, ScaleFilter filter,
+	YCbCrType yuv_type, int aligned, uint32_t padding)
+{
+	yuv_rgb_scaler *scaler = yuv_rgb_scaler_create(width, height, dst_width, dst_height, filter);
+	Image yuv420, nv12, nv21, expected, dst;
+	char context[256];
+	int result = 0, i;
+
+	snprintf(context, sizeof(context), "%s scale (%ux%u to %ux%u, type %d, %s, padding %u)",
+		filter==SCALE_BOX ? "box" : "bilinear", width, height, dst_width, dst_height, (int)yuv_type,
+		aligned ? "aligned" : "unaligned", padding);
+	if(!scaler)
+	{
+		report("%s: yuv_rgb_scaler_create failed\n", context);
+		return 1;
+	}
+	image_alloc(&yuv420, &LAYOUT_YUV420, width, height, aligned, padding, 0);
+	image_fill(&yuv420, FILL_RANDOM);
+	image_alloc(&nv12, &LAYOUT_NV12, width, height, aligned, padding, 1);
+	test_YUV420_NV12_yuv420_nv12_std(&yuv420, &nv12, yuv_type);
+	image_alloc(&nv21, &LAYOUT_NV12, width, height, aligned, padding, 2);
+	test_YUV420_NV12_yuv420_nv21_std(&yuv420, &nv21, yuv_type);
+
+	image_alloc(&expected, &LAYOUT_RGB24, dst_width, dst_height, aligned, padding, 3);
+	if(width==dst_width && height==dst_height)
+		test_YUV420_RGB_yuv420_rgb24_std(&yuv420, &expected, yuv_type);
+	else
+		yuv420_rgb24_scale(scaler, yuv420.planes[0], yuv420.planes[1], yuv420.planes[2], yuv420.strides[0],
+			yuv420.strides[1], expected.planes[0], expected.strides[0], yuv_type);
+	for(i=0; i<3 && result==0; ++i)
+	{
+		image_alloc(&dst, &LAYOUT_RGB24, dst_width, dst_height, aligned, padding, 4);
+		if(i==0)
+			yuv420_rgb24_scale(scaler, yuv420.planes[0], yuv420.planes[1], yuv420.planes[2], yuv420.strides[0],
+				yuv420.strides[1], dst.planes[0], dst.strides[0], yuv_type);
+		else if(i==1)
+			nv12_rgb24_scale(scaler, nv12.planes[0], nv12.planes[1], nv12.strides[0], nv12.strides[1], dst.planes[0],
+				dst.strides[0], yuv_type);
+		else
+			nv21_rgb24_scale(scaler, nv21.planes[0], nv21.planes[1], nv21.strides[0], nv21.strides[1], dst.planes[0],
+				dst.strides[0], yuv_type);
+		result = image_compare(&expected, &dst, context);
+		image_free(&dst);
+	}
+
+	yuv_rgb_scaler_destroy(scaler);
+	image_free(&yuv420);
+	image_free(&nv12);
+	image_free(&nv21);
+	image_free(&expected);
+	return result;
+}
+
+// the box filter only downscales
+static int check_box_upscaling(void)
+{
+	yuv_rgb_scaler *wider = yuv_rgb_scaler_create(64, 32, 65, 32, SCALE_BOX),
+		*higher = yuv_rgb_scaler_create(64, 32, 64, 33, SCALE_BOX);
+	const int result = wider || higher;
+	if(result)
+		report("yuv_rgb_scaler_create: box upscaling accepted\n");
+	yuv_rgb_scaler_destroy(wider);
+	yuv_rgb_scaler_destroy(higher);
+	return result;
+}
+
+static const struct
+{
+	YUVRGBFormat format;
+	const Layout *layout;
+} FRAME_FORMATS[] = {
+	{YUVRGB_FORMAT_YUV420, &LAYOUT_YUV420}, {YUVRGB_FORMAT_NV12, &LAYOUT_NV12}, {YUVRGB_FORMAT_NV21, &LAYOUT_NV12},
+	{YUVRGB_FORMAT_RGB24, &LAYOUT_RGB24}, {YUVRGB_FORMAT_RGB32, &LAYOUT_RGB32}
+};
+
+// reference of the conversions of yuv_rgb_image_convert, in the order of FRAME_FORMATS, NULL if there is none
+static const ConvertFunction FRAME_CONVERSIONS[5][5] = {
+	{NULL, test_YUV420_NV12_yuv420_nv12_std, test_YUV420_NV12_yuv420_nv21_std, test_YUV420_RGB_yuv420_rgb24_std,
+		test_YUV420_RGB_yuv420_rgb32_std},
+	{test_NV12_YUV420_nv12_yuv420_std, NULL, NULL, test_NV12_RGB_nv12_rgb24_std, test_NV12_RGB_nv12_rgb32_std},
+	{test_NV12_YUV420_nv21_yuv420_std, NULL, NULL, test_NV12_RGB_nv21_rgb24_std, test_NV12_RGB_nv21_rgb32_std},
+	{test_RGB_YUV420_rgb24_yuv420_std, NULL, NULL, NULL, NULL},
+	{test_RGB_YUV420_rgb32_yuv420_std, NULL, NULL, NULL, NULL}
+};
+
+// describe image as a YUVRGBImage owned by the caller
+static YUVRGBImage frame_image(const Image *image, YUVRGBFormat format)
+{
+	YUVRGBImage frame;
+	uint32_t p;
+	memset(&frame, 0, sizeof(frame));
+	frame.format = format;
+	frame.width = image->width;
+	frame.height = image->height;
+	for(p=0; p<plane_number(image->layout); ++p)
+	{
+		frame.planes[p] = image->planes[p];
+		frame.strides[p] = image->strides[p ? 1 : 0];
+	}
+	return frame;
+}
+
+// all pairs of formats, the conversions that are not supported failing without writing anything
+static int check_image_convert(uint32_t src_format, uint32_t dst_format, uint32_t width, uint32_t height,
+	YCbCrType yuv_type, int aligned, uint32_t padding)
+{
+	const ConvertFunction reference = FRAME_CONVERSIONS[src_format][dst_format];
+	Image src, expected, dst;
+	char context[256];
+	int result = 0;
+
+	image_alloc(&src, FRAME_FORMATS[src_format].layout, width, height, aligned, padding, 0);
+	image_fill(&src, FILL_RANDOM);
+	image_alloc(&expected, FRAME_FORMATS[dst_format].layout, width, height, aligned, padding, 1);
+	if(reference)
+		reference(&src, &expected, yuv_type);
+	image_alloc(&dst, FRAME_FORMATS[dst_format].layout, width, height, aligned, padding, 2);
+	const YUVRGBImage src_frame = frame_image(&src, FRAME_FORMATS[src_format].format),
+		dst_frame = frame_image(&dst, FRAME_FORMATS[dst_format].format);
+	const int status = yuv_rgb_image_convert(&src_frame, &dst_frame, yuv_type);
+
+	snprintf(context, sizeof(context), "yuv_rgb_image_convert (formats %u to %u, %ux%u, type %d, %s, padding %u)",
+		src_format, dst_format, width, height, (int)yuv_type, aligned ? "aligned" : "unaligned", padding);
+	if(status!=(reference ? 0 : -1))
+	{
+		report("%s: returned %d\n", context, status);
+		result = 1;
+	}
+	else
+		result = image_compare(&expected, &dst, context);
+
+	image_free(&src);
+	image_free(&expected);
+	image_free(&dst);
+	return result;
+}
+
+// images of different sizes, yuv420 images whose u and v strides differ, and the alignment of the allocated images
+static int check_image_errors(void)
+{
+	YUVRGBImage a, b;
+	yuv_rgb_frame_pool *pool;
+	int result = 0;
+	uint32_t i;
+
+	if(yuv_rgb_image_alloc(&a, YUVRGB_FORMAT_YUV420, 33, 17)!=0 || yuv_rgb_image_alloc(&b, YUVRGB_FORMAT_RGB24, 33, 16)!=0)
+	{
+		report("yuv_rgb_image_alloc failed\n");
+		return 1;
+	}
+	if(yuv_rgb_image_convert(&a, &b, YCBCR_601)!=-1)
+	{
+		report("yuv_rgb_image_convert: images of different sizes converted\n");
+		result = 1;
+	}
+	yuv_rgb_image_free(&b);
+	if(yuv_rgb_image_alloc(&b, YUVRGB_FORMAT_RGB24, 33, 17)!=0)
+	{
+		report("yuv_rgb_image_alloc failed\n");
+		yuv_rgb_image_free(&a);
+		return 1;
+	}
+	a.strides[2] += 64;
+	if(yuv_rgb_image_convert(&a, &b, YCBCR_601)!=-1)
+	{
+		report("yuv_rgb_image_convert: yuv420 image with different u and v strides converted\n");
+		result = 1;
+	}
+	a.strides[2] -= 64;
+	if(yuv_rgb_image_convert(&a, &b, YCBCR_601)!=0)
+	{
+		report("yuv_rgb_image_convert: allocated images not converted\n");
+		result = 1;
+	}
+	for(i=0; i<3; ++i)
+		if((uintptr_t)a.planes[i]%64 || a.strides[i]%64)
+		{
+			report("yuv_rgb_image_alloc: plane %u is not aligned on 64 bytes\n", i);
+			result = 1;
+		}
+	yuv_rgb_image_free(&a);
+	yuv_rgb_image_free(&b);
+
+	pool = yuv_rgb_frame_pool_create(YUVRGB_FORMAT_NV12, 65, 33, 1);
+	if(!pool || yuv_rgb_frame_pool_get(pool, &a)!=0 || yuv_rgb_frame_pool_get(pool, &b)!=0)
+	{
+		report("yuv_rgb_frame_pool failed\n");
+		yuv_rgb_frame_pool_destroy(pool);
+		return 1;
+	}
+	if(a.format!=YUVRGB_FORMAT_NV12 || a.width!=65 || a.height!=33 || b.planes[0]==a.planes[0] ||
+		(uintptr_t)a.planes[1]%64 || a.strides[1]%64 || (uintptr_t)b.planes[1]%64 || b.strides[1]%64)
+	{
+		report("yuv_rgb_frame_pool_get: invalid image\n");
+		result = 1;
+	}
+	if(yuv_rgb_frame_pool_release(pool, &a)!=0 || a.memory)
+	{
+		report("yuv_rgb_frame_pool_release: image not released\n");
+		result = 1;
+	}
+	yuv_rgb_frame_pool_release(pool, &b);
+	if(yuv_rgb_image_alloc(&a, YUVRGB_FORMAT_NV12, 64, 33)!=0 || yuv_rgb_image_alloc(&b, YUVRGB_FORMAT_NV21, 65, 33)!=0)
+	{
+		report("yuv_rgb_image_alloc failed\n");
+		yuv_rgb_image_free(&a);
+		yuv_rgb_frame_pool_destroy(pool);
+		return 1;
+	}
+	if(yuv_rgb_frame_pool_release(pool, &a)!=-1 || yuv_rgb_frame_pool_release(pool, &b)!=-1 || !a.memory || !b.memory)
+	{
+		report("yuv_rgb_frame_pool_release: image of another size or format released\n");
+		result = 1;
+	}
+	yuv_rgb_image_free(&a);
+	yuv_rgb_image_free(&b);
+	yuv_rgb_frame_pool_destroy(pool);
+	return result;
+}
+
+static const uint32_t WIDTHS[] = {
+	1, 2, 3, 4, 5, 7, 15, 16, 17, 31, 32, 33, 47, 63, 64, 65, 95, 127, 128, 129, 130, 191, 255, 256, 257
+};
+static const uint32_t HEIGHTS[] = {1, 2, 3, 4, 5, 6, 7};
+
+int main(void)
+{
+	uint32_t c, i, j, k;
+	int aligned;
+
+	if(set_custom_color_spaces()!=0)
+	{
+		printf("yuv_rgb_set_custom_color_space failed\n");
+		return 1;
+	}
+	test_pool = yuv_rgb_pool_create(3, NULL);
+	if(!test_pool)
+	{
+		printf("yuv_rgb_pool_create failed\n");
+		return 1;
+	}
+
+	// every implementation on every size and fill, aligned and unaligned, with streaming stores for half of the
+	// aligned images
+	for(c=0; c<CASE_NUMBER; ++c)
+	{
+		const Case *test = CASES_TABLE+c;
+		if(!cpu_supports(test->cpu))
+			continue;
+		for(i=0; i<ARRAY_SIZE(WIDTHS); ++i)
+			for(j=0; j<ARRAY_SIZE(HEIGHTS); ++j)
+				for(k=0; k<FILL_NUMBER; ++k)
+					for(aligned=1; aligned>=(test->aligned_only ? 1 : 0); --aligned)
+					{
+						const YCbCrType yuv_type = (YCbCrType)((i*ARRAY_SIZE(HEIGHTS)+j+k)%YCBCR_TYPE_COUNT);
+						yuv_rgb_set_store_policy(aligned && (k%2) ? YUVRGB_STORE_STREAM : YUVRGB_STORE_AUTO);
+						check(check_case(test, WIDTHS[i], HEIGHTS[j], yuv_type, aligned, i+j+k, 7*i+j, (Fill)k));
+					}
+	}
+	yuv_rgb_set_store_policy(YUVRGB_STORE_AUTO);
+
+	for(i=0; i<ARRAY_SIZE(PATH_SIZES); ++i)
+	{
+		const uint32_t width = PATH_SIZES[i][0], height = PATH_SIZES[i][1];
+		for(aligned=1; aligned>=0; --aligned)
+		{
+			const YCbCrType yuv_type = (YCbCrType)((2*i+aligned)%YCBCR_TYPE_COUNT);
+			for(c=0; c<ARRAY_SIZE(ROTATE_CASES); ++c)
+				for(k=0; k<8; ++k)
+					check(check_rotate(ROTATE_CASES+c, width, height, yuv_type, aligned, i, (YUVRGBRotation)(k/2),
+						k%2));
+			for(c=0; c<ARRAY_SIZE(RECTS_CASES); ++c)
+				for(k=0; k<8; ++k)
+					check(check_rects(RECTS_CASES+c, width, height, yuv_type, aligned, i+k));
+			for(c=0; c<ARRAY_SIZE(STREAM_CASES); ++c)
+				for(k=1; k<=5; ++k)
+					check(check_stream(STREAM_CASES+c, width, height, yuv_type, aligned, i, 2*k-1));
+			check(check_scale(width, height, width, height, SCALE_BOX, yuv_type, aligned, i));
+			check(check_scale(width, height, width, height, SCALE_BILINEAR, yuv_type, aligned, i));
+			for(k=0; k<4; ++k)
+			{
+				check(check_scale(width, height, 1+random_value()%width, 1+random_value()%height, SCALE_BOX, yuv_type,
+					aligned, i));
+				check(check_scale(width, height, 1+random_value()%(2*width), 1+random_value()%(2*height),
+					SCALE_BILINEAR, yuv_type, aligned, i));
+			}
+			for(c=0; c<ARRAY_SIZE(FRAME_FORMATS); ++c)
+				for(k=0; k<ARRAY_SIZE(FRAME_FORMATS); ++k)
+					check(check_image_convert(c, k, width, height, yuv_type, aligned, i));
+		}
+	}
+	check(check_box_upscaling());
+	check(check_image_errors());
+
+	yuv_rgb_pool_destroy(test_pool);
+	printf("%u tests, %u failures\n", test_number, failure_number);
+	return failure_number ? 1 : 0;
+}
+
+#endif
@@ -2,14 +2,32 @@
 // Distributed under BSD 3-Clause License
 
 // This program demonstrate how to convert a YUV420p image (raw format) to RGB (ppm format), and the reverse operation
+// (see bench_yuv_rgb.c for a detailed benchmark of the conversions)
+
+// for clock_gettime, mmap and posix_madvise (and MAP_POPULATE on linux)
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#elif !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200112L
+#endif
 
 #include "yuv_rgb.h"
+#include "yuv_rgb_test_util.h"
 
+#include <ctype.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <time.h>
+#include <unistd.h>
+#endif
 
 #if defined(__x86_64__)
 #include <x86intrin.h>
@@ -18,6 +36,9 @@
 #define _mm_free(a) free(a)
 #endif
 
+// the aligned versions require 16 bytes aligned pointers and strides
+#define IS_ALIGNED16(PTR, STRIDE) (((((uintptr_t)(PTR)) | (STRIDE)) % 16) == 0)
+
 #if USE_FFMPEG
 #include <libswscale/swscale.h>
 #endif
@@ -25,43 +46,167 @@
 #include <ippcc.h>
 #endif
 
-// read a raw yuv image file
-// raw yuv files can be generated by ffmpeg, for example, using :
-//  ffmpeg -i test.png -c:v rawvideo -pix_fmt yuv420p test.yuv
-// the returned image channels are contiguous, and Y stride=width, U and V stride=width/2
-// memory must be freed with free
-int readRawYUV(const char *filename, uint32_t width, uint32_t height, uint8_t **YUV)
+// monotonic wall clock time, in seconds (clock() measures the cpu time of all threads)
+double wall_time(void)
 {
+#ifdef _WIN32
+	LARGE_INTEGER counter, frequency;
+	QueryPerformanceCounter(&counter);
+	QueryPerformanceFrequency(&frequency);
+	return (double)counter.QuadPart/(double)frequency.QuadPart;
+#else
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (double)t.tv_sec + 1e-9*(double)t.tv_nsec;
+#endif
+}
+
+// input files are memory mapped, so that the images are converted directly from the page cache
+// (or read in memory where mmap is not available)
+typedef struct
+{
+	const uint8_t *data;
+	size_t size;
+	void *memory;
+	int mapped;
+} InputFile;
+
+// open and map (or read) a whole file
+// with populate, the whole file is read in advance (for a single image converted many times), otherwise the kernel
+// is told that the file will be read sequentially, and the frames are prefetched one by one with prefetchInputFile
+int openInputFile(const char *filename, int populate, InputFile *file)
+{
+	memset(file, 0, sizeof(InputFile));
+#ifndef _WIN32
+	int fd = open(filename, O_RDONLY);
+	if(fd<0)
+	{
+		perror("Error opening file for read");
+		return 1;
+	}
+	
+	struct stat st;
+	if(fstat(fd, &st)!=0 || !S_ISREG(st.st_mode))
+	{
+		fprintf(stderr, "Error reading file size, or not a regular file\n");
+		close(fd);
+		return 1;
+	}
+	file->size = st.st_size;
+	if(file->size==0)
+	{
+		close(fd);
+		return 0;
+	}
+	
+	int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+	if(populate)
+		flags |= MAP_POPULATE;
+#endif
+	void *memory = mmap(NULL, file->size, PROT_READ, flags, fd, 0);
+	close(fd);
+	if(memory!=MAP_FAILED)
+	{
+		posix_madvise(memory, file->size, populate ? POSIX_MADV_WILLNEED : POSIX_MADV_SEQUENTIAL);
+		file->memory = memory;
+		file->data = memory;
+		file->mapped = 1;
+		return 0;
+	}
+	perror("Error mapping file, reading it instead");
+#else
+	(void)populate;
+#endif
+	
 	FILE *fp = fopen(filename, "rb");
 	if(!fp)
 	{
-		perror("Error opening yuv image for read");
+		perror("Error opening file for read");
 		return 1;
 	}
-	
-	// check file size
 	fseek(fp, 0, SEEK_END);
-	uint32_t size = ftell(fp);
-	if(size!=(width*height + 2*((width+1)/2)*((height+1)/2)))
+	file->size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	file->memory = _mm_malloc(file->size>0 ? file->size : 1, 16);
+	if(!file->memory || fread(file->memory, 1, file->size, fp)!=file->size)
 	{
-		fprintf(stderr, "Wrong size of yuv image : %d bytes, expected %d bytes\n", size, (width*height + 2*((width+1)/2)*((height+1)/2)));
+		perror("Error reading file");
+		_mm_free(file->memory);
+		memset(file, 0, sizeof(InputFile));
 		fclose(fp);
-		return 2;
+		return 1;
 	}
-	fseek(fp, 0, SEEK_SET);
+	file->data = file->memory;
+	fclose(fp);
+	return 0;
+}
+
+void closeInputFile(InputFile *file)
+{
+#ifndef _WIN32
+	if(file->mapped)
+		munmap(file->memory, file->size);
+	else
+#endif
+		_mm_free(file->memory);
+	memset(file, 0, sizeof(InputFile));
+}
+
+// tell the kernel that a part of a mapped file will be read soon
+void prefetchInputFile(const InputFile *file, size_t offset, size_t size)
+{
+#ifndef _WIN32
+	if(!file->mapped || offset>=file->size)
+		return;
+	if(size>file->size-offset)
+		size = file->size-offset;
+	// the address must be page aligned
+	const size_t start = offset/sysconf(_SC_PAGESIZE)*sysconf(_SC_PAGESIZE);
+	posix_madvise((uint8_t *)file->memory+start, offset+size-start, POSIX_MADV_WILLNEED);
+#else
+	(void)file; (void)offset; (void)size;
+#endif
+}
+
+// open a raw yuv image or sequence file, and return its number of frames
+// raw yuv files can be generated by ffmpeg, for example, using :
+//  ffmpeg -i test.png -c:v rawvideo -pix_fmt yuv420p test.yuv
+// the image channels of each frame are contiguous, and Y stride=width, U and V stride=(width+1)/2
+int openRawYUV(const char *filename, uint32_t width, uint32_t height, int populate, InputFile *file, 
+	uint32_t *frame_number)
+{
+	if(openInputFile(filename, populate, file)!=0)
+		return 1;
 	
-	*YUV = malloc(size);
-	size_t result = fread(*YUV, 1, size, fp);
-	if (result != size) {
-		perror("Error reading yuv image");
-		fclose(fp);
-		return 3;
+	// check file size
+	const size_t frame_size = (size_t)width*height + 2*(size_t)((width+1)/2)*((height+1)/2);
+	if(frame_size==0 || file->size==0 || file->size%frame_size!=0)
+	{
+		fprintf(stderr, "Wrong size of yuv image : %zu bytes, expected a multiple of %zu bytes\n", file->size, frame_size);
+		closeInputFile(file);
+		return 2;
 	}
-	fclose(fp);
+	*frame_number = file->size/frame_size;
 	return 0;
 }
 
-// write a raw yuv image file
+// write a raw yuv image
+int writeRawYUV(FILE *fp, uint32_t width, uint32_t height, const uint8_t *Y, const uint8_t *U, const uint8_t *V, 
+	size_t y_stride, size_t uv_stride)
+{
+	const uint32_t uv_width = (width+1)/2, uv_height = (height+1)/2;
+	size_t result = 0;
+	for(uint32_t y=0; y<height; ++y)
+		result += fwrite(Y+y*y_stride, 1, width, fp);
+	for(uint32_t y=0; y<uv_height; ++y)
+		result += fwrite(U+y*uv_stride, 1, uv_width, fp);
+	for(uint32_t y=0; y<uv_height; ++y)
+		result += fwrite(V+y*uv_stride, 1, uv_width, fp);
+	return result==(size_t)width*height+2*(size_t)uv_width*uv_height ? 0 : 1;
+}
+
+// write a raw yuv image file, whose channels are contiguous
 int saveRawYUV(const char *filename, uint32_t width, uint32_t height, const uint8_t *YUV, size_t y_stride, size_t uv_stride)
 {
 	FILE *fp = fopen(filename, "wb");
@@ -71,117 +216,107 @@ int saveRawYUV(const char *filename, uint32_t width, uint32_t height, const uint
 		return 1;
 	}
 	
-	if(y_stride==width)
-	{
-		fwrite(YUV, 1, width*height, fp);
-		YUV+=width*height;
-	}
-	else
-	{
-		for(uint32_t y=0; y<height; ++y)
-		{
-			fwrite(YUV, 1, width, fp);
-			YUV+=y_stride;
-		}
-	}
-	
+	const uint8_t *U = YUV+y_stride*height, *V = U+uv_stride*((height+1)/2);
+	writeRawYUV(fp, width, height, YUV, U, V, y_stride, uv_stride);
+	fclose(fp);
+	return 0;
+}
+
+// parse the header of a binary ppm image, and return its size (0 if it is invalid)
+// the header is followed by a single whitespace, and may contain comments
+size_t parsePPMHeader(const uint8_t *data, size_t size, uint32_t *width, uint32_t *height)
+{
+	if(size<2 || data[0]!='P' || data[1]!='6')
+		return 0;
 	
-	if(uv_stride==(width+1/2))
+	size_t pos = 2;
+	uint32_t values[3];
+	for(int i=0; i<3; ++i)
 	{
-		fwrite(YUV, 1, ((width+1)/2)*((height+1)/2)*2, fp);
-	}
-	else
-	{
-		for(uint32_t y=0; y<((height+1)/2); ++y)
-		{
-			fwrite(YUV, 1, ((width+1)/2), fp);
-			YUV+=uv_stride;
-		}
-		
-		for(uint32_t y=0; y<((height+1)/2); ++y)
-		{
-			fwrite(YUV, 1, ((width+1)/2), fp);
-			YUV+=uv_stride;
-		}
+		while(pos<size && (isspace(data[pos]) || data[pos]=='#'))
+			if(data[pos++]=='#')
+				while(pos<size && data[pos]!='\n')
+					++pos;
+		if(pos>=size || !isdigit(data[pos]))
+			return 0;
+		uint64_t value = 0;
+		while(pos<size && isdigit(data[pos]) && value<=UINT32_MAX)
+			value = 10*value + (data[pos++]-'0');
+		if(value>UINT32_MAX)
+			return 0;
+		values[i] = value;
 	}
+	if(pos>=size || !isspace(data[pos]) || values[0]==0 || values[1]==0 || values[2]==0 || values[2]>255)
+		return 0;
 	
-	fclose(fp);
-	return 0;
+	*width = values[0];
+	*height = values[1];
+	return pos+1;
 }
 
-// read a ppm binary image file
-// memory must be freed with free
-int readPPM(const char* filename, uint32_t *width, uint32_t *height, uint8_t **RGB)
+// open a binary ppm image file, possibly containing a sequence of images of the same size, and return the size of
+// its header and the number of images
+int openPPM(const char* filename, int populate, InputFile *file, uint32_t *width, uint32_t *height, 
+	size_t *header_size, uint32_t *frame_number)
 {
-	FILE *fp = fopen(filename, "rb");
-	if(!fp)
-	{
-		perror("Error opening rgb image for read");
+	if(openInputFile(filename, populate, file)!=0)
 		return 1;
-	}
 	
-	char magic[3];
-	size_t result = fread(magic, 1, 2, fp);
-	magic[2]='\0';
-	if(result!=2 || strcmp(magic,"P6")!=0)
+	*header_size = parsePPMHeader(file->data, file->size, width, height);
+	if(*header_size==0)
 	{
-		perror("Error reading rgb image header, or invalid format");
-		fclose(fp);
+		fprintf(stderr, "Error reading rgb image header, or invalid format\n");
+		closeInputFile(file);
 		return 3;
 	}
 	
-	uint32_t max;
-	result = fscanf(fp, " %u %u %u ", width, height, &max);
-	if(result!=3 || max>255)
+	// the images of a sequence must have the same header
+	const size_t frame_size = *header_size + 3*(size_t)(*width)*(*height);
+	for(*frame_number=0; (*frame_number+1)*frame_size<=file->size; ++(*frame_number))
 	{
-		perror("Error reading rgb image header, or invalid values");
-		fclose(fp);
-		return 3;
+		const uint8_t *frame = file->data + (*frame_number)*frame_size;
+		if(*frame_number>0 && memcmp(frame, file->data, *header_size)!=0)
+			break;
 	}
-	
-	size_t size = 3*(*width)*(*height);
-	*RGB = malloc(size);
-	if(!*RGB)
+	if(*frame_number==0)
 	{
-		perror("Error allocating rgb image memory");
-		fclose(fp);
-		return 2;
-	}
-	
-	result = fread(*RGB, 1, size, fp);
-	if(result != size)
-	{
-		perror("Error reading rgb image");
-		fclose(fp);
+		fprintf(stderr, "Error reading rgb image, file is too small\n");
+		closeInputFile(file);
 		return 3;
 	}
-	
-	fclose(fp);
 	return 0;
 }
 
-// save a rgb image to ppm binary format
-int savePPM(const char* filename, uint32_t width, uint32_t height, const uint8_t *RGB, size_t stride)
+// write a rgb image in ppm binary format
+int writePPM(FILE *fp, uint32_t width, uint32_t height, const uint8_t *RGB, size_t stride)
 {
-	FILE *fp = fopen(filename, "wb");
-	if(!fp)
-	{
-		perror("Error opening rgb image for write");
-		return 1;
-	}
-	
+	size_t result = 0;
 	fprintf(fp, "P6 %u %u 255\n", width, height);
 	if(stride==(3*width))
 	{
-		fwrite(RGB, 1, 3*width*height, fp);
+		result = fwrite(RGB, 1, 3*(size_t)width*height, fp);
 	}
 	else
 	{
 		for(uint32_t i=0; i<height; ++i)
 		{
-			fwrite(RGB+i*stride, 1, 3*width, fp);
+			result += fwrite(RGB+i*stride, 1, 3*width, fp);
 		}
 	}
+	return result==3*(size_t)width*height ? 0 : 1;
+}
+
+// save a rgb image to ppm binary format
+int savePPM(const char* filename, uint32_t width, uint32_t height, const uint8_t *RGB, size_t stride)
+{
+	FILE *fp = fopen(filename, "wb");
+	if(!fp)
+	{
+		perror("Error opening rgb image for write");
+		return 1;
+	}
+	
+	writePPM(fp, width, height, RGB, stride);
 	fclose(fp);
 	
 	return 0;
@@ -189,7 +324,7 @@ int savePPM(const char* filename, uint32_t width, uint32_t height, const uint8_t
 
 void convert_rgb_to_rgba(const uint8_t *RGB, uint32_t width, uint32_t height, uint8_t **RGBA)
 {
-	*RGBA = malloc(4*width*height);
+	*RGBA = _mm_malloc(4*width*height, 16);
 	for(uint32_t y=0; y<height; ++y)
 	{
 		for(uint32_t x=0; x<width; ++x)
@@ -236,11 +371,11 @@ void test_yuv2rgb(uint32_t width, uint32_t height,
 	uint8_t *rgb, uint32_t rgb_stride, YCbCrType yuv_type,
 	const char *file, const char *name, uint32_t iteration_number, const yuv2rgb_ptr yuv2rgb_fun)
 {
-	clock_t t = clock();
+	double t = wall_time();
 	for(uint32_t i=0;i<iteration_number; ++i)
 		yuv2rgb_fun(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
-	t = clock()-t;
-	printf("Processing time (%s) : %f sec\n", name, ((float)t)/CLOCKS_PER_SEC);
+	t = wall_time()-t;
+	printf("Processing time (%s) : %f sec\n", name, t);
 	
 	char *out_filename = malloc(strlen(file)+strlen(name)+6);
 	strcpy(out_filename, file);
@@ -257,11 +392,11 @@ void test_yuvsp2rgb(uint32_t width, uint32_t height,
 	uint8_t *rgb, uint32_t rgb_stride, YCbCrType yuv_type,
 	const char *file, const char *name, uint32_t iteration_number, const yuvsp2rgb_ptr yuv2rgb_fun)
 {
-	clock_t t = clock();
+	double t = wall_time();
 	for(uint32_t i=0;i<iteration_number; ++i)
 		yuv2rgb_fun(width, height, y, uv, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
-	t = clock()-t;
-	printf("Processing time (%s) : %f sec\n", name, ((float)t)/CLOCKS_PER_SEC);
+	t = wall_time()-t;
+	printf("Processing time (%s) : %f sec\n", name, t);
 	
 	char *out_filename = malloc(strlen(file)+strlen(name)+6);
 	strcpy(out_filename, file);
@@ -279,11 +414,11 @@ void test_rgb2yuv(uint32_t width, uint32_t height,
 	uint8_t *y, uint8_t *u, uint8_t *v, uint32_t y_stride, uint32_t uv_stride, YCbCrType yuv_type,
 	const char *file, const char *name, uint32_t iteration_number, const rgb2yuv_ptr rgb2yuv_fun)
 {
-	clock_t t = clock();
+	double t = wall_time();
 	for(uint32_t i=0;i<iteration_number; ++i)
 		rgb2yuv_fun(width, height, rgb, rgb_stride, y, u, v, y_stride, uv_stride, yuv_type);
-	t = clock()-t;
-	printf("Processing time (%s) : %f sec\n", name, ((float)t)/CLOCKS_PER_SEC);
+	t = wall_time()-t;
+	printf("Processing time (%s) : %f sec\n", name, t);
 	
 	char *out_filename = malloc(strlen(file)+strlen(name)+6);
 	strcpy(out_filename, file);
@@ -352,20 +487,206 @@ void rgb24_yuv420_ipp(uint32_t width, uint32_t height,
 
 #endif
 
+// multi-threaded versions, with a pool using all cores
+static yuv_rgb_pool *test_pool = NULL;
+
+void yuv420_rgb24_test_mt(uint32_t width, uint32_t height, 
+	const uint8_t *y, const uint8_t *u, const uint8_t *v, uint32_t y_stride, uint32_t uv_stride, 
+	uint8_t *rgb, uint32_t rgb_stride, 
+	YCbCrType yuv_type)
+{
+	yuv420_rgb24_mt(test_pool, width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+}
+
+void nv12_rgb24_test_mt(uint32_t width, uint32_t height, 
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, 
+	uint8_t *rgb, uint32_t rgb_stride, 
+	YCbCrType yuv_type)
+{
+	nv12_rgb24_mt(test_pool, width, height, y, uv, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+}
+
+void nv21_rgb24_test_mt(uint32_t width, uint32_t height, 
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, 
+	uint8_t *rgb, uint32_t rgb_stride, 
+	YCbCrType yuv_type)
+{
+	nv21_rgb24_mt(test_pool, width, height, y, uv, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+}
+
+void rgb24_yuv420_test_mt(uint32_t width, uint32_t height, 
+	const uint8_t *rgb, uint32_t rgb_stride, 
+	uint8_t *y, uint8_t *u, uint8_t *v, uint32_t y_stride, uint32_t uv_stride, 
+	YCbCrType yuv_type)
+{
+	rgb24_yuv420_mt(test_pool, width, height, rgb, rgb_stride, y, u, v, y_stride, uv_stride, yuv_type);
+}
+
+void rgb32_yuv420_test_mt(uint32_t width, uint32_t height, 
+	const uint8_t *rgba, uint32_t rgba_stride, 
+	uint8_t *y, uint8_t *u, uint8_t *v, uint32_t y_stride, uint32_t uv_stride, 
+	YCbCrType yuv_type)
+{
+	rgb32_yuv420_mt(test_pool, width, height, rgba, rgba_stride, y, u, v, y_stride, uv_stride, yuv_type);
+}
+
+// convert the frames of a mapped raw yuv sequence with the fastest versions, through a single rgb image reused for
+// all the frames, and write them to <out>.ppm as a sequence of ppm images
+int convert_yuv_sequence(const InputFile *file, Mode mode, uint32_t width, uint32_t height, uint32_t frame_number, 
+	YCbCrType yuv_type, const char *out)
+{
+	const size_t y_size = (size_t)width*height, uv_size = (size_t)((width+1)/2)*((height+1)/2), 
+		frame_size = y_size+2*uv_size;
+	YUVRGBImage rgb;
+	if(yuv_rgb_image_alloc(&rgb, YUVRGB_FORMAT_RGB24, width, height)!=0)
+	{
+		fprintf(stderr, "Error allocating rgb image memory\n");
+		return 1;
+	}
+	
+	char *out_filename = malloc(strlen(out)+5);
+	if(!out_filename)
+	{
+		fprintf(stderr, "Error allocating output file name memory\n");
+		yuv_rgb_image_free(&rgb);
+		return 1;
+	}
+	strcpy(out_filename, out);
+	strcat(out_filename, ".ppm");
+	FILE *fp = fopen(out_filename, "wb");
+	free(out_filename);
+	if(!fp)
+	{
+		perror("Error opening rgb sequence for write");
+		yuv_rgb_image_free(&rgb);
+		return 1;
+	}
+	
+	// the input frames are only read by the conversion
+	YUVRGBImage yuv = {.format=(mode==YUV2RGB ? YUVRGB_FORMAT_YUV420 : 
+			(mode==YUV2RGB_NV12 ? YUVRGB_FORMAT_NV12 : YUVRGB_FORMAT_NV21)), 
+		.width=width, .height=height, 
+		.strides={width, mode==YUV2RGB ? (width+1)/2 : 2*((width+1)/2), (width+1)/2}};
+	double conversion_time = 0.0, start_time = wall_time();
+	int result = 0;
+	for(uint32_t i=0; i<frame_number && result==0; ++i)
+	{
+		uint8_t *frame = (uint8_t *)file->data + i*frame_size;
+		prefetchInputFile(file, (i+1)*frame_size, frame_size);
+		yuv.planes[0] = frame;
+		yuv.planes[1] = frame+y_size;
+		yuv.planes[2] = frame+y_size+uv_size;
+		
+		double t = wall_time();
+		yuv_rgb_image_convert(&yuv, &rgb, yuv_type);
+		conversion_time += wall_time()-t;
+		
+		result = writePPM(fp, width, height, rgb.planes[0], rgb.strides[0]);
+	}
+	if(fclose(fp)!=0 || result!=0)
+		perror("Error writing rgb sequence");
+	else
+		printf("Converted %u frames : %f ms per frame (conversion), %f ms per frame (total with i/o)\n", frame_number, 
+			1000.0*conversion_time/frame_number, 1000.0*(wall_time()-start_time)/frame_number);
+	
+	yuv_rgb_image_free(&rgb);
+	return result;
+}
+
+// convert the images of a mapped ppm file with the fastest version, through a single yuv image reused for all
+// the frames, and write them to <out>.yuv as a raw yuv sequence
+int convert_rgb_sequence(const InputFile *file, uint32_t width, uint32_t height, size_t header_size, 
+	uint32_t frame_number, YCbCrType yuv_type, const char *out)
+{
+	const size_t frame_size = header_size+3*(size_t)width*height;
+	YUVRGBImage yuv;
+	if(yuv_rgb_image_alloc(&yuv, YUVRGB_FORMAT_YUV420, width, height)!=0)
+	{
+		fprintf(stderr, "Error allocating yuv image memory\n");
+		return 1;
+	}
+	
+	char *out_filename = malloc(strlen(out)+5);
+	if(!out_filename)
+	{
+		fprintf(stderr, "Error allocating output file name memory\n");
+		yuv_rgb_image_free(&yuv);
+		return 1;
+	}
+	strcpy(out_filename, out);
+	strcat(out_filename, ".yuv");
+	FILE *fp = fopen(out_filename, "wb");
+	free(out_filename);
+	if(!fp)
+	{
+		perror("Error opening yuv sequence for write");
+		yuv_rgb_image_free(&yuv);
+		return 1;
+	}
+	
+	// the input images are only read by the conversion
+	YUVRGBImage rgb = {.format=YUVRGB_FORMAT_RGB24, .width=width, .height=height, .strides={3*width, 0, 0}};
+	double conversion_time = 0.0, start_time = wall_time();
+	int result = 0;
+	for(uint32_t i=0; i<frame_number && result==0; ++i)
+	{
+		prefetchInputFile(file, (i+1)*frame_size, frame_size);
+		rgb.planes[0] = (uint8_t *)file->data + i*frame_size + header_size;
+		
+		double t = wall_time();
+		yuv_rgb_image_convert(&rgb, &yuv, yuv_type);
+		conversion_time += wall_time()-t;
+		
+		result = writeRawYUV(fp, width, height, yuv.planes[0], yuv.planes[1], yuv.planes[2], yuv.strides[0], 
+			yuv.strides[1]);
+	}
+	if(fclose(fp)!=0 || result!=0)
+		perror("Error writing yuv sequence");
+	else
+		printf("Converted %u frames : %f ms per frame (conversion), %f ms per frame (total with i/o)\n", frame_number, 
+			1000.0*conversion_time/frame_number, 1000.0*(wall_time()-start_time)/frame_number);
+	
+	yuv_rgb_image_free(&yuv);
+	return result;
+}
+
 int main(int argc, char **argv)
 {
+	// optional sequence mode, the option being removed from the arguments
+	int sequence = 0;
+	uint32_t sequence_frame_number = 0;
+	for(int i=1; i<argc; ++i)
+	{
+		if(strcmp(argv[i], "-n")==0 && i+1<argc)
+		{
+			sequence = 1;
+			sequence_frame_number = strtoul(argv[i+1], NULL, 10);
+			for(int j=i; j+2<argc; ++j)
+				argv[j] = argv[j+2];
+			argc -= 2;
+			break;
+		}
+	}
+	
 	if(argc<4)
 	{
-		printf("Usage : test yuv2rgb <yuv image file> <image width> <image height> <output template filename>\n");
-		printf("Or    : test yuv2rgb_nv12 <yuv image file> <image width> <image height> <output template filename>\n");
-		printf("Or    : test yuv2rgb_nv21 <yuv image file> <image width> <image height> <output template filename>\n");
-		printf("Or    : test rgb2yuv <rgb24 binary ppm image file> <output template filename>\n");
+		printf("Usage : test yuv2rgb <yuv image file> <image width> <image height> <output template filename> [-n <frames>]\n");
+		printf("Or    : test yuv2rgb_nv12 <yuv image file> <image width> <image height> <output template filename> [-n <frames>]\n");
+		printf("Or    : test yuv2rgb_nv21 <yuv image file> <image width> <image height> <output template filename> [-n <frames>]\n");
+		printf("Or    : test rgb2yuv <rgb24 binary ppm image file> <output template filename> [-n <frames>]\n");
 		printf("Or    : test rgba2yuv <rgb24 binary ppm image file> <output template filename>\n");
+		printf("With -n, the first frames (all if 0) of a raw yuv sequence or of a ppm file containing several images\n"
+			"are converted with the fastest version, and written to a single output file\n");
 		return 1;
 	}
 	
 	const int iteration_number = 100;
-	printf("Time will be measured in each configuration for %d iterations...\n", iteration_number);
+	if(!sequence)
+		printf("Time will be measured in each configuration for %d iterations...\n", iteration_number);
+	
+	test_pool = yuv_rgb_pool_create(yuv_rgb_cpu_count()-1, NULL);
+	if(!sequence)
+		printf("Multi-threaded versions use %u threads\n", yuv_rgb_pool_thread_number(test_pool)+1);
 	const YCbCrType yuv_format = YCBCR_601;
 	//const YCbCrType yuv_format = YCBCR_709;
 	//const YCbCrType yuv_format = YCBCR_JPEG;
@@ -374,11 +695,6 @@ int main(int argc, char **argv)
 	if(strcmp(argv[1], "yuv2rgb")==0)
 	{
 		mode=YUV2RGB;
-		if(argc<6)
-		{
-			printf("Invalid argument number for yuv2rgb mode, call without argument to see usage.\n");
-			return 1;
-		}
 	}
 	else if(strcmp(argv[1], "yuv2rgb_nv12")==0)
 	{
@@ -401,11 +717,27 @@ int main(int argc, char **argv)
 		printf("Invalid mode, call without argument to see usage.\n");
 		return 1;
 	}
+	if((mode==YUV2RGB || mode==YUV2RGB_NV12 || mode==YUV2RGB_NV21) && argc<6)
+	{
+		printf("Invalid argument number for %s mode, call without argument to see usage.\n", argv[1]);
+		return 1;
+	}
+	if(mode==RGBA2YUV && sequence)
+	{
+		printf("Sequence mode is not available for rgba2yuv, call without argument to see usage.\n");
+		return 1;
+	}
+	
+	// in sequence mode, the output image is written right after its conversion
+	if(sequence)
+		yuv_rgb_set_store_policy(YUVRGB_STORE_CACHED);
 	
 	const char *filename = argv[2];
 	uint32_t width, height;
 	const char *out;
-	uint8_t *YUV=NULL, *RGB=NULL, *Y=NULL, *U=NULL, *V=NULL, *RGBa=NULL, *YUVa=NULL, *Ya=NULL, *Ua=NULL, *Va=NULL;
+	InputFile input;
+	uint32_t frame_number;
+	int result = 0;
 	
 	if(mode==YUV2RGB || mode==YUV2RGB_NV12 ||  mode==YUV2RGB_NV21)
 	{
@@ -414,229 +746,237 @@ int main(int argc, char **argv)
 		height = atoi(argv[4]);
 		out = argv[5];
 		
-		// read input data and allocate output data
-		if(readRawYUV(filename, width, height, &YUV)!=0)
+		// map input data and allocate output data
+		if(openRawYUV(filename, width, height, !sequence, &input, &frame_number)!=0)
 		{
 			printf("Error reading image file, check that the file exists and has the correct format and resolution.\n");
 			return 1;
 		}
+		if(sequence)
+		{
+			if(sequence_frame_number==0)
+				sequence_frame_number = frame_number;
+			else if(sequence_frame_number>frame_number)
+			{
+				printf("The file only contains %u frames\n", frame_number);
+				closeInputFile(&input);
+				return 1;
+			}
+			result = convert_yuv_sequence(&input, mode, width, height, sequence_frame_number, yuv_format, out);
+			closeInputFile(&input);
+			yuv_rgb_pool_destroy(test_pool);
+			return result;
+		}
+		if(frame_number>1)
+			printf("The file contains %u frames, only the first one is tested (see -n)\n", frame_number);
 		
 #if USE_FFMPEG
 		yuv2rgb_swscale_ctx = sws_getContext(width, height, AV_PIX_FMT_YUV420P, width, height, AV_PIX_FMT_RGB24, 0, 0, 0, 0);
 #endif
 		
-		RGB = malloc(3*width*height);
+		uint8_t *RGB = _mm_malloc(3*width*height, 16);
 		
-		Y = YUV;
-		U = YUV+width*height;
-		V = YUV+width*height+((width+1)/2)*((height+1)/2);
-		
-		// allocate aligned data
-		const size_t y_stride = width + (16-width%16)%16;
-		const size_t uv_stride = (mode==YUV2RGB) ? (width+1)/2 + (16-((width+1)/2)%16)%16 : y_stride;
-		const size_t rgb_stride = width*3 +(16-(3*width)%16)%16;
-	
-		const size_t y_size = y_stride*height, uv_size = uv_stride*((height+1)/2);
-		YUVa = _mm_malloc(y_size+2*uv_size, 16);
-		Ya = YUVa;
-		Ua = YUVa+y_size;
-		Va = YUVa+y_size+uv_size;
-		for(unsigned int i=0; i<height; ++i)
-		{
-			memcpy(Ya+i*y_stride, Y+i*width, width);
-			if((i%2)==0)
-			{
-				if(mode==YUV2RGB)
-				{
-					memcpy(Ua+(i/2)*uv_stride, U+(i/2)*((width+1)/2), (width+1)/2);
-					memcpy(Va+(i/2)*uv_stride, V+(i/2)*((width+1)/2), (width+1)/2);
-				}
-				else
-				{
-					memcpy(Ua+(i/2)*uv_stride, U+(i/2)*width, width);
-				}
-			}
-		}
+		const uint8_t *Y = input.data, 
+			*U = input.data+width*height, 
+			*V = input.data+width*height+((width+1)/2)*((height+1)/2);
 		
-		RGBa = _mm_malloc(rgb_stride*height, 16);
+		// all versions convert the whole image, whatever its size, so the images are used as they are read,
+		// and the aligned versions are only tested if the image data happen to be aligned
+		const uint32_t y_stride = width, 
+			uv_stride = (mode==YUV2RGB) ? (width+1)/2 : 2*((width+1)/2), 
+			rgb_stride = 3*width;
+		const int aligned = IS_ALIGNED16(Y, y_stride) && IS_ALIGNED16(U, uv_stride) && 
+			(mode!=YUV2RGB || IS_ALIGNED16(V, uv_stride)) && IS_ALIGNED16(RGB, rgb_stride);
+		if(!aligned)
+			printf("Image data is not 16 bytes aligned, aligned versions are not tested\n");
 		
 		// test all versions
 		if(mode==YUV2RGB)
 		{
-			test_yuv2rgb(width, height, Y, U, V, width, (width+1)/2, RGB, width*3, yuv_format, 
+			test_yuv2rgb(width, height, Y, U, V, y_stride, uv_stride, RGB, rgb_stride, yuv_format, 
 				out, "std", iteration_number, yuv420_rgb24_std);
 #ifdef _YUVRGB_SSE2_
-			test_yuv2rgb(width, height, Y, U, V, width, (width+1)/2, RGB, width*3, yuv_format, 
+			test_yuv2rgb(width, height, Y, U, V, y_stride, uv_stride, RGB, rgb_stride, yuv_format, 
 				out, "sse2_unaligned", iteration_number, yuv420_rgb24_sseu);
 #endif
 #if USE_FFMPEG
-			test_yuv2rgb(width, height, Y, U, V, width, (width+1)/2, RGB, width*3, yuv_format, 
-				out, "ffmpeg_unaligned", iteration_number, yuv420_rgb24_ffmpeg);
+			test_yuv2rgb(width, height, Y, U, V, y_stride, uv_stride, RGB, rgb_stride, yuv_format, 
+				out, "ffmpeg", iteration_number, yuv420_rgb24_ffmpeg);
 #endif
 #if USE_IPP
-			test_yuv2rgb(width, height, Y, U, V, width, (width+1)/2, RGB, width*3, yuv_format, 
-				out, "ipp_unaligned", iteration_number, yuv420_rgb24_ipp);
+			test_yuv2rgb(width, height, Y, U, V, y_stride, uv_stride, RGB, rgb_stride, yuv_format, 
+				out, "ipp", iteration_number, yuv420_rgb24_ipp);
 #endif
 #ifdef _YUVRGB_SSE2_
-			test_yuv2rgb(width, height, Ya, Ua, Va, y_stride, uv_stride, RGBa, rgb_stride, yuv_format, 
-				out, "sse2_aligned", iteration_number, yuv420_rgb24_sse);
-#endif
-#if USE_FFMPEG
-			test_yuv2rgb(width, height, Ya, Ua, Va, y_stride, uv_stride, RGBa, rgb_stride, yuv_format, 
-				out, "ffmpeg_aligned", iteration_number, yuv420_rgb24_ffmpeg);
-#endif
-#if USE_IPP
-			test_yuv2rgb(width, height, Ya, Ua, Va, y_stride, uv_stride, RGBa, rgb_stride, yuv_format, 
-				out, "ipp_aligned", iteration_number, yuv420_rgb24_ipp);
+			if(aligned)
+				test_yuv2rgb(width, height, Y, U, V, y_stride, uv_stride, RGB, rgb_stride, yuv_format, 
+					out, "sse2_aligned", iteration_number, yuv420_rgb24_sse);
 #endif
+			test_yuv2rgb(width, height, Y, U, V, y_stride, uv_stride, RGB, rgb_stride, yuv_format, 
+				out, "auto", iteration_number, yuv420_rgb24);
+			test_yuv2rgb(width, height, Y, U, V, y_stride, uv_stride, RGB, rgb_stride, yuv_format, 
+				out, "auto_mt", iteration_number, yuv420_rgb24_test_mt);
+			test_yuv2rgb(width, height, Y, U, V, y_stride, uv_stride, RGB, rgb_stride, yuv_format, 
+				out, "bilinear_std", iteration_number, yuv420_rgb24_bilinear_std);
+			test_yuv2rgb(width, height, Y, U, V, y_stride, uv_stride, RGB, rgb_stride, yuv_format, 
+				out, "bilinear", iteration_number, yuv420_rgb24_bilinear);
 		}
 		else if(mode==YUV2RGB_NV12)
 		{
-			test_yuvsp2rgb(width, height, Y, U, width, width, RGB, width*3, yuv_format, 
+			test_yuvsp2rgb(width, height, Y, U, y_stride, uv_stride, RGB, rgb_stride, yuv_format, 
 				out, "std", iteration_number, nv12_rgb24_std);
 #ifdef _YUVRGB_SSE2_
-			test_yuvsp2rgb(width, height, Y, U, width, width, RGB, width*3, yuv_format, 
+			test_yuvsp2rgb(width, height, Y, U, y_stride, uv_stride, RGB, rgb_stride, yuv_format, 
 				out, "sse2_unaligned", iteration_number, nv12_rgb24_sseu);
-			test_yuvsp2rgb(width, height, Ya, Ua, y_stride, uv_stride, RGBa, rgb_stride, yuv_format, 
-				out, "sse2_aligned", iteration_number, nv12_rgb24_sse);
+			if(aligned)
+				test_yuvsp2rgb(width, height, Y, U, y_stride, uv_stride, RGB, rgb_stride, yuv_format, 
+					out, "sse2_aligned", iteration_number, nv12_rgb24_sse);
 #endif
+			test_yuvsp2rgb(width, height, Y, U, y_stride, uv_stride, RGB, rgb_stride, yuv_format, 
+				out, "auto", iteration_number, nv12_rgb24);
+			test_yuvsp2rgb(width, height, Y, U, y_stride, uv_stride, RGB, rgb_stride, yuv_format, 
+				out, "auto_mt", iteration_number, nv12_rgb24_test_mt);
+			test_yuvsp2rgb(width, height, Y, U, y_stride, uv_stride, RGB, rgb_stride, yuv_format, 
+				out, "bilinear_std", iteration_number, nv12_rgb24_bilinear_std);
+			test_yuvsp2rgb(width, height, Y, U, y_stride, uv_stride, RGB, rgb_stride, yuv_format, 
+				out, "bilinear", iteration_number, nv12_rgb24_bilinear);
 		}
 		else if(mode==YUV2RGB_NV21)
 		{
-			test_yuvsp2rgb(width, height, Y, U, width, width, RGB, width*3, yuv_format, 
+			test_yuvsp2rgb(width, height, Y, U, y_stride, uv_stride, RGB, rgb_stride, yuv_format, 
 				out, "std", iteration_number, nv21_rgb24_std);
 #ifdef _YUVRGB_SSE2_
-			test_yuvsp2rgb(width, height, Y, U, width, width, RGB, width*3, yuv_format, 
+			test_yuvsp2rgb(width, height, Y, U, y_stride, uv_stride, RGB, rgb_stride, yuv_format, 
 				out, "sse2_unaligned", iteration_number, nv21_rgb24_sseu);
-			test_yuvsp2rgb(width, height, Ya, Ua, y_stride, uv_stride, RGBa, rgb_stride, yuv_format, 
-				out, "sse2_aligned", iteration_number, nv21_rgb24_sse);
+			if(aligned)
+				test_yuvsp2rgb(width, height, Y, U, y_stride, uv_stride, RGB, rgb_stride, yuv_format, 
+					out, "sse2_aligned", iteration_number, nv21_rgb24_sse);
 #endif
+			test_yuvsp2rgb(width, height, Y, U, y_stride, uv_stride, RGB, rgb_stride, yuv_format, 
+				out, "auto", iteration_number, nv21_rgb24);
+			test_yuvsp2rgb(width, height, Y, U, y_stride, uv_stride, RGB, rgb_stride, yuv_format, 
+				out, "auto_mt", iteration_number, nv21_rgb24_test_mt);
+			test_yuvsp2rgb(width, height, Y, U, y_stride, uv_stride, RGB, rgb_stride, yuv_format, 
+				out, "bilinear_std", iteration_number, nv21_rgb24_bilinear_std);
+			test_yuvsp2rgb(width, height, Y, U, y_stride, uv_stride, RGB, rgb_stride, yuv_format, 
+				out, "bilinear", iteration_number, nv21_rgb24_bilinear);
 		}
+		
+		_mm_free(RGB);
 	}
-	else if(mode==RGB2YUV)
+	else if(mode==RGB2YUV || mode==RGBA2YUV)
 	{
 		//parse argument line
 		out = argv[3];
 		
-		// read input data and allocate output data
-		if(readPPM(filename, &width, &height, &RGB)!=0)
+		// map input data and allocate output data
+		size_t header_size;
+		if(openPPM(filename, !sequence, &input, &width, &height, &header_size, &frame_number)!=0)
 		{
 			printf("Error reading image file, check that the file exists and has the correct format.\n");
 			return 1;
 		}
+		if(sequence)
+		{
+			if(sequence_frame_number==0)
+				sequence_frame_number = frame_number;
+			else if(sequence_frame_number>frame_number)
+			{
+				printf("The file only contains %u images\n", frame_number);
+				closeInputFile(&input);
+				return 1;
+			}
+			result = convert_rgb_sequence(&input, width, height, header_size, sequence_frame_number, yuv_format, out);
+			closeInputFile(&input);
+			yuv_rgb_pool_destroy(test_pool);
+			return result;
+		}
+		if(frame_number>1)
+			printf("The file contains %u images, only the first one is tested (see -n)\n", frame_number);
+		const uint8_t *RGB = input.data+header_size;
 		
 #if USE_FFMPEG
 		rgb2yuv_swscale_ctx = sws_getContext(width, height, AV_PIX_FMT_RGB24, width, height, AV_PIX_FMT_YUV420P, 0, 0, 0, 0);
 #endif
 		
-		YUV = malloc(width*height*3/2);
-		
-		Y = YUV;
-		U = YUV+width*height;
-		V = YUV+width*height+((width+1)/2)*((height+1)/2);
+		// convert rgb to rgba
+		uint8_t *RGBA = NULL;
+		if(mode==RGBA2YUV)
+			convert_rgb_to_rgba(RGB, width, height, &RGBA);
 		
-		// allocate aligned data
-		const size_t y_stride = width + (16-width%16)%16,
-		uv_stride = (width+1)/2 + (16-((width+1)/2)%16)%16,
-		rgb_stride = width*3 +(16-(3*width)%16)%16;
+		const size_t y_size = width*height, uv_size = ((width+1)/2)*((height+1)/2);
+		uint8_t *YUV = _mm_malloc(y_size+2*uv_size, 16);
 		
-		RGBa = _mm_malloc(rgb_stride*height, 16);
-		for(unsigned int i=0; i<height; ++i)
-		{
-			memcpy(RGBa+i*rgb_stride, RGB+i*width*3, width*3);
-		}
+		uint8_t *Y = YUV,
+			*U = YUV+y_size,
+			*V = YUV+y_size+uv_size;
 		
-		const size_t y_size = y_stride*height, uv_size = uv_stride*((height+1)/2);
-		YUVa = _mm_malloc(y_size+2*uv_size, 16);
-		Ya = YUVa;
-		Ua = YUVa+y_size;
-		Va = YUVa+y_size+uv_size;
-
+		// all versions convert the whole image, whatever its size, so the images are used as they are read,
+		// and the aligned versions are only tested if the image data happen to be aligned
+		const uint32_t y_stride = width, uv_stride = (width+1)/2, rgb_stride = 3*width, rgba_stride = 4*width;
+		const int aligned = IS_ALIGNED16(Y, y_stride) && IS_ALIGNED16(U, uv_stride) && IS_ALIGNED16(V, uv_stride) && 
+			(mode==RGB2YUV ? IS_ALIGNED16(RGB, rgb_stride) : IS_ALIGNED16(RGBA, rgba_stride));
+		if(!aligned)
+			printf("Image data is not 16 bytes aligned, aligned versions are not tested\n");
 		
 		// test all versions
-		test_rgb2yuv(width, height, RGB, width*3, Y, U, V, width, (width+1)/2, yuv_format, 
-			out, "std", iteration_number, rgb24_yuv420_std);
+		if(mode==RGB2YUV)
+		{
+			test_rgb2yuv(width, height, RGB, rgb_stride, Y, U, V, y_stride, uv_stride, yuv_format, 
+				out, "std", iteration_number, rgb24_yuv420_std);
 #ifdef _YUVRGB_SSE2_
-		test_rgb2yuv(width, height, RGB, width*3, Y, U, V, width, (width+1)/2, yuv_format, 
-			out, "sse2_unaligned", iteration_number, rgb24_yuv420_sseu);
+			test_rgb2yuv(width, height, RGB, rgb_stride, Y, U, V, y_stride, uv_stride, yuv_format, 
+				out, "sse2_unaligned", iteration_number, rgb24_yuv420_sseu);
 #endif
 #if USE_FFMPEG
-		test_rgb2yuv(width, height, RGB, width*3, Y, U, V, width, (width+1)/2, yuv_format, 
-			out, "ffmpeg_unaligned", iteration_number, rgb24_yuv420_ffmpeg);
+			test_rgb2yuv(width, height, RGB, rgb_stride, Y, U, V, y_stride, uv_stride, yuv_format, 
+				out, "ffmpeg", iteration_number, rgb24_yuv420_ffmpeg);
 #endif
 #if USE_IPP
-		test_rgb2yuv(width, height, RGB, width*3, Y, U, V, width, (width+1)/2, yuv_format, 
-			out, "ipp_unaligned", iteration_number, rgb24_yuv420_ipp);
+			test_rgb2yuv(width, height, RGB, rgb_stride, Y, U, V, y_stride, uv_stride, yuv_format, 
+				out, "ipp", iteration_number, rgb24_yuv420_ipp);
 #endif
 #ifdef _YUVRGB_SSE2_
-		test_rgb2yuv(width, height, RGBa, rgb_stride, Ya, Ua, Va, y_stride, uv_stride, yuv_format, 
-			out, "sse2_aligned", iteration_number, rgb24_yuv420_sse);
+			if(aligned)
+				test_rgb2yuv(width, height, RGB, rgb_stride, Y, U, V, y_stride, uv_stride, yuv_format, 
+					out, "sse2_aligned", iteration_number, rgb24_yuv420_sse);
 #endif
-#if USE_FFMPEG
-		test_rgb2yuv(width, height, RGBa, rgb_stride, Ya, Ua, Va, y_stride, uv_stride, yuv_format, 
-			out, "ffmpeg_aligned", iteration_number, rgb24_yuv420_ffmpeg);
-#endif
-#if USE_IPP
-		test_rgb2yuv(width, height, RGBa, rgb_stride, Ya, Ua, Va, y_stride, uv_stride, yuv_format, 
-			out, "ipp_aligned", iteration_number, rgb24_yuv420_ipp);
-#endif
-	}
-	else if(mode==RGBA2YUV)
-	{
-		//parse argument line
-		out = argv[3];
-		
-		// read input data and allocate output data
-		if(readPPM(filename, &width, &height, &RGB)!=0)
-		{
-			printf("Error reading image file, check that the file exists and has the correct format.\n");
-			return 1;
+			test_rgb2yuv(width, height, RGB, rgb_stride, Y, U, V, y_stride, uv_stride, yuv_format, 
+				out, "auto", iteration_number, rgb24_yuv420);
+			test_rgb2yuv(width, height, RGB, rgb_stride, Y, U, V, y_stride, uv_stride, yuv_format, 
+				out, "auto_mt", iteration_number, rgb24_yuv420_test_mt);
+			test_rgb2yuv(width, height, RGB, rgb_stride, Y, U, V, y_stride, uv_stride, yuv_format, 
+				out, "precise_std", iteration_number, rgb24_yuv420_precise_std);
+			test_rgb2yuv(width, height, RGB, rgb_stride, Y, U, V, y_stride, uv_stride, yuv_format, 
+				out, "precise_auto", iteration_number, rgb24_yuv420_precise);
 		}
-		// convert rgb to rgba
-		uint8_t *RGBA = NULL;
-		convert_rgb_to_rgba(RGB, width, height, &RGBA);
-		
-		YUV = malloc(width*height*3/2);
-		
-		Y = YUV;
-		U = YUV+width*height;
-		V = YUV+width*height+((width+1)/2)*((height+1)/2);
-		
-		// allocate aligned data
-		const size_t y_stride = width + (16-width%16)%16,
-		uv_stride = (width+1)/2 + (16-((width+1)/2)%16)%16,
-		rgba_stride = width*4 +(16-(4*width)%16)%16;
-		
-		RGBa = _mm_malloc(rgba_stride*height, 16);
-		for(unsigned int i=0; i<height; ++i)
+		else
 		{
-			memcpy(RGBa+i*rgba_stride, RGBA+i*width*4, width*4);
-		}
-		
-		const size_t y_size = y_stride*height, uv_size = uv_stride*((height+1)/2);
-		YUVa = _mm_malloc(y_size+2*uv_size, 16);
-		Ya = YUVa;
-		Ua = YUVa+y_size;
-		Va = YUVa+y_size+uv_size;
-		
-		// test all versions
-		test_rgb2yuv(width, height, RGBA, width*4, Y, U, V, width, (width+1)/2, yuv_format, 
-			out, "std", iteration_number, rgb32_yuv420_std);
+			test_rgb2yuv(width, height, RGBA, rgba_stride, Y, U, V, y_stride, uv_stride, yuv_format, 
+				out, "std", iteration_number, rgb32_yuv420_std);
 #ifdef _YUVRGB_SSE2_
-		test_rgb2yuv(width, height, RGBA, width*4, Y, U, V, width, (width+1)/2, yuv_format, 
-			out, "sse2_unaligned", iteration_number, rgb32_yuv420_sseu);
-		test_rgb2yuv(width, height, RGBa, rgba_stride, Ya, Ua, Va, y_stride, uv_stride, yuv_format, 
-			out, "sse2_aligned", iteration_number, rgb32_yuv420_sse);
+			test_rgb2yuv(width, height, RGBA, rgba_stride, Y, U, V, y_stride, uv_stride, yuv_format, 
+				out, "sse2_unaligned", iteration_number, rgb32_yuv420_sseu);
+			if(aligned)
+				test_rgb2yuv(width, height, RGBA, rgba_stride, Y, U, V, y_stride, uv_stride, yuv_format, 
+					out, "sse2_aligned", iteration_number, rgb32_yuv420_sse);
 #endif
+			test_rgb2yuv(width, height, RGBA, rgba_stride, Y, U, V, y_stride, uv_stride, yuv_format, 
+				out, "auto", iteration_number, rgb32_yuv420);
+			test_rgb2yuv(width, height, RGBA, rgba_stride, Y, U, V, y_stride, uv_stride, yuv_format, 
+				out, "auto_mt", iteration_number, rgb32_yuv420_test_mt);
+			test_rgb2yuv(width, height, RGBA, rgba_stride, Y, U, V, y_stride, uv_stride, yuv_format, 
+				out, "precise_std", iteration_number, rgb32_yuv420_precise_std);
+			test_rgb2yuv(width, height, RGBA, rgba_stride, Y, U, V, y_stride, uv_stride, yuv_format, 
+				out, "precise_auto", iteration_number, rgb32_yuv420_precise);
+		}
 		
-		free(RGBA);
+		_mm_free(RGBA);
+		_mm_free(YUV);
 	}
 	
-	_mm_free(RGBa);
-	_mm_free(YUVa);
-	free(RGB);
-	free(YUV);
+	closeInputFile(&input);
+	yuv_rgb_pool_destroy(test_pool);
 	
 	return 0;
 }
-
@@ -0,0 +1,534 @@
+// Copyright 2016 Adrien Descamps
+// Distributed under BSD 3-Clause License
+
+// Command line converter of raw image sequences, from a file or stdin to a file or stdout
+//
+// The frames go through a pipeline of three stages: a reader thread reads the input frames, the main thread converts
+// them with the multi-threaded versions of the conversions (using a yuv_rgb_pool), and a writer thread writes the
+// output frames, so that reading, conversion and writing overlap.
+// The stages are connected by single producer single consumer rings of frames allocated at start: the producer fills
+// the frame at the write index and then publishes it by incrementing the index, and the consumer uses the frame at
+// the read index in place and then gives it back by incrementing the read index. Each index is only written by one
+// thread (with release stores, read with acquire loads), so no lock is needed. A thread finding its ring empty or
+// full yields and then sleeps briefly until it is not anymore.
+
+// for clock_gettime, nanosleep and sched_yield
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "yuv_rgb.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#endif
+
+#ifdef _WIN32
+typedef HANDLE Thread;
+#define THREAD_FUNCTION(NAME, ARG) DWORD WINAPI NAME(LPVOID ARG)
+#define THREAD_RETURN 0
+#define thread_create(T, F, ARG) ((*(T) = CreateThread(NULL, 0, F, ARG, 0, NULL))==NULL)
+#define thread_join(T) (WaitForSingleObject(T, INFINITE), CloseHandle(T))
+#else
+typedef pthread_t Thread;
+#define THREAD_FUNCTION(NAME, ARG) void *NAME(void *ARG)
+#define THREAD_RETURN NULL
+#define thread_create(T, F, ARG) pthread_create(T, NULL, F, ARG)
+#define thread_join(T) pthread_join(T, NULL)
+#endif
+
+#ifdef _MSC_VER
+#define load_acquire(P) ((uint32_t)InterlockedCompareExchange((volatile LONG *)(P), 0, 0))
+#define store_release(P, V) InterlockedExchange((volatile LONG *)(P), (LONG)(V))
+#else
+#define load_acquire(P) __atomic_load_n(P, __ATOMIC_ACQUIRE)
+#define store_release(P, V) __atomic_store_n(P, V, __ATOMIC_RELEASE)
+#endif
+
+// size of a cache line, to keep the indices written by different threads apart
+#define CACHE_LINE 64
+
+// monotonic wall clock time, in seconds
+static double wall_time(void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER counter, frequency;
+	QueryPerformanceCounter(&counter);
+	QueryPerformanceFrequency(&frequency);
+	return (double)counter.QuadPart/(double)frequency.QuadPart;
+#else
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (double)t.tv_sec + 1e-9*(double)t.tv_nsec;
+#endif
+}
+
+// wait a little before checking a ring again, yielding first and then sleeping, count being the number of previous
+// waits for the same frame
+static void backoff(uint32_t count)
+{
+#ifdef _WIN32
+	if(count<64)
+		SwitchToThread();
+	else
+		Sleep(1);
+#else
+	if(count<64)
+		sched_yield();
+	else
+	{
+		const struct timespec t = {0, 50000};
+		nanosleep(&t, NULL);
+	}
+#endif
+}
+
+typedef struct
+{
+	uint8_t *data;
+	// time at which the reading of the frame started, for the latency
+	double read_time;
+} Frame;
+
+typedef struct
+{
+	Frame *frames;
+	uint32_t frame_number;
+	// written by the producer: index of the next frame to fill, and set after its last frame
+	uint32_t write_index, finished;
+	uint8_t producer_padding[CACHE_LINE];
+	// written by the consumer: index of the next frame to use, and set if it stops before the end
+	uint32_t read_index, aborted;
+	uint8_t consumer_padding[CACHE_LINE];
+} Ring;
+
+static int ring_init(Ring *ring, uint32_t frame_number, size_t frame_size)
+{
+	uint32_t i;
+	memset(ring, 0, sizeof(Ring));
+	ring->frames = calloc(frame_number, sizeof(Frame));
+	if(!ring->frames)
+		return -1;
+	ring->frame_number = frame_number;
+	for(i=0; i<frame_number; ++i)
+	{
+		ring->frames[i].data = malloc(frame_size);
+		if(!ring->frames[i].data)
+			return -1;
+	}
+	return 0;
+}
+
+static void ring_destroy(Ring *ring)
+{
+	uint32_t i;
+	for(i=0; ring->frames && i<ring->frame_number; ++i)
+		free(ring->frames[i].data);
+	free(ring->frames);
+}
+
+// producer side: wait for a free frame to fill, NULL if the consumer stopped
+static Frame *ring_write_frame(Ring *ring)
+{
+	uint32_t count;
+	for(count=0; ring->write_index-load_acquire(&ring->read_index)==ring->frame_number; ++count)
+	{
+		if(load_acquire(&ring->aborted))
+			return NULL;
+		backoff(count);
+	}
+	return &ring->frames[ring->write_index%ring->frame_number];
+}
+
+// producer side: publish the frame returned by ring_write_frame
+static void ring_push(Ring *ring)
+{
+	store_release(&ring->write_index, ring->write_index+1);
+}
+
+static void ring_finish(Ring *ring)
+{
+	store_release(&ring->finished, 1);
+}
+
+// consumer side: wait for the next frame, NULL if the producer finished and all frames were used
+static Frame *ring_read_frame(Ring *ring)
+{
+	uint32_t count;
+	for(count=0; load_acquire(&ring->write_index)==ring->read_index; ++count)
+	{
+		// the last frame may have been pushed just before finishing
+		if(load_acquire(&ring->finished) && load_acquire(&ring->write_index)==ring->read_index)
+			return NULL;
+		backoff(count);
+	}
+	return &ring->frames[ring->read_index%ring->frame_number];
+}
+
+// consumer side: give back the frame returned by ring_read_frame
+static void ring_pop(Ring *ring)
+{
+	store_release(&ring->read_index, ring->read_index+1);
+}
+
+static void ring_abort(Ring *ring)
+{
+	store_release(&ring->aborted, 1);
+}
+
+typedef struct
+{
+	FILE *input, *output;
+	size_t input_size, output_size;
+	uint32_t max_frame_number;
+	Ring input_ring, output_ring;
+	int read_error, write_error;
+	// latencies of the written frames, from the start of their reading to the end of their writing
+	double *latencies;
+	uint32_t latency_number, latency_capacity;
+} Pipeline;
+
+static THREAD_FUNCTION(reader_thread, arg)
+{
+	Pipeline *pipeline = arg;
+	uint32_t i;
+	for(i=0; pipeline->max_frame_number==0 || i<pipeline->max_frame_number; ++i)
+	{
+		Frame *frame = ring_write_frame(&pipeline->input_ring);
+		if(!frame)
+			break;
+		frame->read_time = wall_time();
+		const size_t size = fread(frame->data, 1, pipeline->input_size, pipeline->input);
+		if(size!=pipeline->input_size)
+		{
+			if(size!=0 || ferror(pipeline->input))
+			{
+				fprintf(stderr, "Error reading input, or last frame truncated (%zu bytes instead of %zu)\n", size,
+					pipeline->input_size);
+				pipeline->read_error = 1;
+			}
+			break;
+		}
+		ring_push(&pipeline->input_ring);
+	}
+	ring_finish(&pipeline->input_ring);
+	return THREAD_RETURN;
+}
+
+static THREAD_FUNCTION(writer_thread, arg)
+{
+	Pipeline *pipeline = arg;
+	Frame *frame;
+	while((frame = ring_read_frame(&pipeline->output_ring))!=NULL)
+	{
+		if(fwrite(frame->data, 1, pipeline->output_size, pipeline->output)!=pipeline->output_size ||
+			fflush(pipeline->output)!=0)
+		{
+			perror("Error writing output");
+			pipeline->write_error = 1;
+			ring_abort(&pipeline->output_ring);
+			break;
+		}
+
+		if(pipeline->latency_number==pipeline->latency_capacity)
+		{
+			const uint32_t capacity = pipeline->latency_capacity>0 ? 2*pipeline->latency_capacity : 1024;
+			double *latencies = realloc(pipeline->latencies, capacity*sizeof(double));
+			if(latencies)
+			{
+				pipeline->latencies = latencies;
+				pipeline->latency_capacity = capacity;
+			}
+		}
+		if(pipeline->latency_number<pipeline->latency_capacity)
+			pipeline->latencies[pipeline->latency_number++] = wall_time()-frame->read_time;
+		ring_pop(&pipeline->output_ring);
+	}
+	return THREAD_RETURN;
+}
+
+typedef enum
+{
+	INPUT_YUV420,
+	INPUT_NV12,
+	INPUT_NV21,
+	INPUT_RGB24,
+	INPUT_RGB32
+} InputFormat;
+
+static const struct {const char *name; InputFormat format;} FORMATS[] = {
+	{"yuv420", INPUT_YUV420},
+	{"nv12", INPUT_NV12},
+	{"nv21", INPUT_NV21},
+	{"rgb24", INPUT_RGB24},
+	{"rgb32", INPUT_RGB32}
+};
+
+static const struct {const char *name; YCbCrType type;} TYPES[] = {
+	{"jpeg", YCBCR_JPEG},
+	{"601", YCBCR_601},
+	{"709", YCBCR_709},
+	{"709full", YCBCR_709_FULL},
+	{"2020", YCBCR_2020},
+	{"2020full", YCBCR_2020_FULL}
+};
+
+#define ARRAY_SIZE(A) (sizeof(A)/sizeof((A)[0]))
+
+// convert a frame, yuv frames are stored as contiguous planes and rgb frames as contiguous lines
+static void convert_frame(yuv_rgb_pool *pool, InputFormat format, uint32_t width, uint32_t height,
+	const uint8_t *src, uint8_t *dst, YCbCrType yuv_type)
+{
+	const uint32_t uv_width = (width+1)/2;
+	const size_t y_size = (size_t)width*height, uv_size = (size_t)uv_width*((height+1)/2);
+	switch(format)
+	{
+		case INPUT_YUV420:
+			yuv420_rgb24_mt(pool, width, height, src, src+y_size, src+y_size+uv_size, width, uv_width,
+				dst, 3*width, yuv_type);
+			break;
+		case INPUT_NV12:
+			nv12_rgb24_mt(pool, width, height, src, src+y_size, width, 2*uv_width, dst, 3*width, yuv_type);
+			break;
+		case INPUT_NV21:
+			nv21_rgb24_mt(pool, width, height, src, src+y_size, width, 2*uv_width, dst, 3*width, yuv_type);
+			break;
+		case INPUT_RGB24:
+			rgb24_yuv420_mt(pool, width, height, src, 3*width, dst, dst+y_size, dst+y_size+uv_size, width, uv_width,
+				yuv_type);
+			break;
+		case INPUT_RGB32:
+			rgb32_yuv420_mt(pool, width, height, src, 4*width, dst, dst+y_size, dst+y_size+uv_size, width, uv_width,
+				yuv_type);
+			break;
+	}
+}
+
+static int compare_double(const void *a, const void *b)
+{
+	const double x = *(const double *)a, y = *(const double *)b;
+	return (x>y) - (x<y);
+}
+
+static void usage(void)
+{
+	fprintf(stderr, "Usage : yuv2rgb -size <width>x<height> [options]\n"
+		"Convert a sequence of raw frames, yuv frames to rgb24 and rgb frames to yuv420\n"
+		"  -input <file>      input file, - for stdin (default)\n"
+		"  -output <file>     output file, - for stdout (default)\n"
+		"  -size <w>x<h>      frame size\n"
+		"  -format <format>   input format: yuv420 (default), nv12, nv21 (converted to rgb24), rgb24, rgb32 (converted\n"
+		"                     to yuv420)\n"
+		"  -type <type>       color space: jpeg, 601 (default), 709, 709full, 2020, 2020full\n"
+		"  -threads <n>       conversion threads, all cores by default\n"
+		"  -depth <n>         frames in each ring between the stages (default 4)\n"
+		"  -frames <n>        maximum number of frames to convert (default 0, all)\n"
+		"The number of frames, frame rate and frame latencies (from reading to writing) are printed to stderr at the end\n");
+}
+
+int main(int argc, char **argv)
+{
+	const char *input_name = "-", *output_name = "-";
+	uint32_t width = 0, height = 0, thread_number = yuv_rgb_cpu_count(), depth = 4, max_frame_number = 0;
+	InputFormat format = INPUT_YUV420;
+	YCbCrType yuv_type = YCBCR_601;
+	int i;
+	size_t k;
+
+	for(i=1; i<argc; ++i)
+	{
+		if(i+1>=argc)
+		{
+			usage();
+			return 1;
+		}
+		if(strcmp(argv[i], "-input")==0)
+			input_name = argv[++i];
+		else if(strcmp(argv[i], "-output")==0)
+			output_name = argv[++i];
+		else if(strcmp(argv[i], "-size")==0)
+		{
+			unsigned w, h;
+			char end;
+			if(sscanf(argv[++i], "%ux%u%c", &w, &h, &end)!=2 || w==0 || h==0 || w>65536 || h>65536)
+			{
+				fprintf(stderr, "Invalid size %s\n", argv[i]);
+				return 1;
+			}
+			width = w;
+			height = h;
+		}
+		else if(strcmp(argv[i], "-format")==0)
+		{
+			for(k=0, ++i; k<ARRAY_SIZE(FORMATS) && strcmp(argv[i], FORMATS[k].name)!=0; ++k) {}
+			if(k==ARRAY_SIZE(FORMATS))
+			{
+				fprintf(stderr, "Invalid format %s\n", argv[i]);
+				return 1;
+			}
+			format = FORMATS[k].format;
+		}
+		else if(strcmp(argv[i], "-type")==0)
+		{
+			for(k=0, ++i; k<ARRAY_SIZE(TYPES) && strcmp(argv[i], TYPES[k].name)!=0; ++k) {}
+			if(k==ARRAY_SIZE(TYPES))
+			{
+				fprintf(stderr, "Invalid color space %s\n", argv[i]);
+				return 1;
+			}
+			yuv_type = TYPES[k].type;
+		}
+		else if(strcmp(argv[i], "-threads")==0 || strcmp(argv[i], "-depth")==0)
+		{
+			const char *option = argv[i++];
+			const uint32_t value = (uint32_t)strtoul(argv[i], NULL, 10);
+			if(value==0 || value>1024)
+			{
+				fprintf(stderr, "Invalid value %s for %s\n", argv[i], option);
+				return 1;
+			}
+			if(option[1]=='t')
+				thread_number = value;
+			else
+				depth = value;
+		}
+		else if(strcmp(argv[i], "-frames")==0)
+			max_frame_number = (uint32_t)strtoul(argv[++i], NULL, 10);
+		else
+		{
+			usage();
+			return 1;
+		}
+	}
+	if(width==0)
+	{
+		usage();
+		return 1;
+	}
+
+	Pipeline pipeline;
+	memset(&pipeline, 0, sizeof(Pipeline));
+	pipeline.max_frame_number = max_frame_number;
+	const size_t yuv_size = (size_t)width*height + 2*(size_t)((width+1)/2)*((height+1)/2);
+	const int from_yuv = format==INPUT_YUV420 || format==INPUT_NV12 || format==INPUT_NV21;
+	pipeline.input_size = from_yuv ? yuv_size : (format==INPUT_RGB24 ? 3 : 4)*(size_t)width*height;
+	pipeline.output_size = from_yuv ? 3*(size_t)width*height : yuv_size;
+
+	if(strcmp(input_name, "-")==0)
+	{
+		pipeline.input = stdin;
+#ifdef _WIN32
+		_setmode(_fileno(stdin), _O_BINARY);
+#endif
+	}
+	else if((pipeline.input = fopen(input_name, "rb"))==NULL)
+	{
+		perror("Error opening input");
+		return 1;
+	}
+	if(strcmp(output_name, "-")==0)
+	{
+		pipeline.output = stdout;
+#ifdef _WIN32
+		_setmode(_fileno(stdout), _O_BINARY);
+#endif
+	}
+	else if((pipeline.output = fopen(output_name, "wb"))==NULL)
+	{
+		perror("Error opening output");
+		return 1;
+	}
+
+	yuv_rgb_pool *pool = thread_number>1 ? yuv_rgb_pool_create(thread_number-1, NULL) : NULL;
+	if((thread_number>1 && !pool) ||
+		ring_init(&pipeline.input_ring, depth, pipeline.input_size)!=0 ||
+		ring_init(&pipeline.output_ring, depth, pipeline.output_size)!=0)
+	{
+		fprintf(stderr, "Error allocating the frames or the threads\n");
+		return 1;
+	}
+
+	Thread reader, writer;
+	const double start_time = wall_time();
+	if(thread_create(&reader, reader_thread, &pipeline)!=0)
+	{
+		fprintf(stderr, "Error creating the reader thread\n");
+		return 1;
+	}
+	if(thread_create(&writer, writer_thread, &pipeline)!=0)
+	{
+		fprintf(stderr, "Error creating the writer thread\n");
+		return 1;
+	}
+
+	// conversion stage
+	uint32_t frame_number = 0;
+	double conversion_time = 0.0;
+	Frame *in;
+	while((in = ring_read_frame(&pipeline.input_ring))!=NULL)
+	{
+		Frame *out = ring_write_frame(&pipeline.output_ring);
+		if(!out)
+		{
+			// the writer stopped
+			ring_abort(&pipeline.input_ring);
+			break;
+		}
+		const double t = wall_time();
+		convert_frame(pool, format, width, height, in->data, out->data, yuv_type);
+		conversion_time += wall_time()-t;
+		out->read_time = in->read_time;
+		ring_pop(&pipeline.input_ring);
+		ring_push(&pipeline.output_ring);
+		++frame_number;
+	}
+	ring_finish(&pipeline.output_ring);
+
+	thread_join(reader);
+	thread_join(writer);
+	const double total_time = wall_time()-start_time;
+
+	if(pipeline.input!=stdin)
+		fclose(pipeline.input);
+	if(pipeline.output!=stdout && fclose(pipeline.output)!=0)
+	{
+		perror("Error writing output");
+		pipeline.write_error = 1;
+	}
+
+	fprintf(stderr, "%u frames in %f s : %.2f fps, conversion %.3f ms per frame with %u threads\n", frame_number,
+		total_time, total_time>0.0 ? frame_number/total_time : 0.0,
+		frame_number>0 ? 1000.0*conversion_time/frame_number : 0.0, thread_number);
+	if(pipeline.latency_number>0)
+	{
+		const uint32_t n = pipeline.latency_number;
+		qsort(pipeline.latencies, n, sizeof(double), compare_double);
+		fprintf(stderr, "Frame latency : min %.3f ms, median %.3f ms, p99 %.3f ms, max %.3f ms\n",
+			1000.0*pipeline.latencies[0], 1000.0*pipeline.latencies[n/2], 1000.0*pipeline.latencies[(uint32_t)(0.99*(n-1))],
+			1000.0*pipeline.latencies[n-1]);
+	}
+
+	// implementations used by the conversions, when the library is built with instrumentation
+	YUVRGBKernelStats stats[16];
+	const uint32_t stats_number = yuv_rgb_get_kernel_stats(stats, ARRAY_SIZE(stats));
+	for(k=0; k<stats_number && k<ARRAY_SIZE(stats); ++k)
+		fprintf(stderr, "Implementation %s : %.0f calls, %.1f Mpix/s\n", stats[k].implementation,
+			(double)stats[k].calls, stats[k].nanoseconds>0 ? 1000.0*stats[k].pixels/stats[k].nanoseconds : 0.0);
+
+	free(pipeline.latencies);
+	ring_destroy(&pipeline.input_ring);
+	ring_destroy(&pipeline.output_ring);
+	yuv_rgb_pool_destroy(pool);
+	return (pipeline.read_error || pipeline.write_error) ? 1 : 0;
+}
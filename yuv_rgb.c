@@ -2,6 +2,9 @@
 // Distributed under BSD 3-Clause License
 
 #include "yuv_rgb.h"
+#include "yuv_rgb_internal.h"
+
+#include <string.h>
 
 #if defined(__x86_64__)
 #include <emmintrin.h>
@@ -19,7 +22,7 @@
   #endif // __SSE2__
 #endif // _MSC_VER
 
-uint8_t clamp(int16_t value)
+static uint8_t clamp(int16_t value)
 {
 	return value<0 ? 0 : (value>255 ? 255 : value);
 }
@@ -85,360 +88,1389 @@ uint8_t clamp(int16_t value)
 
 #define FIXED_POINT_VALUE(value, precision) ((int)(((value)*(1<<precision))+0.5))
 
-// see above for description
-typedef struct
-{
-	uint8_t r_factor;    // [Rf]
-	uint8_t g_factor;    // [Rg]
-	uint8_t b_factor;    // [Rb]
-	uint8_t cb_factor;   // [CbRange/(255*CbNorm)]
-	uint8_t cr_factor;   // [CrRange/(255*CrNorm)]
-	uint8_t y_factor;    // [(YMax-YMin)/255]
-	uint8_t y_offset;    // YMin
-} RGB2YUVParam;
+// parameters structures are defined in yuv_rgb_internal.h, see above for description
 
-typedef struct
-{
-	uint8_t cb_factor;   // [(255*CbNorm)/CbRange]
-	uint8_t cr_factor;   // [(255*CrNorm)/CrRange]
-	uint8_t g_cb_factor; // [Bf/Gf*(255*CbNorm)/CbRange]
-	uint8_t g_cr_factor; // [Rf/Gf*(255*CrNorm)/CrRange]
-	uint8_t y_factor;    // [255/(YMax-YMin)]
-	uint8_t y_offset;    // YMin
-} YUV2RGBParam;
+// the chroma factors are applied to |B-Y'|<=256-[Bf] and |R-Y'|<=256-[Rf] in int16, and are lowered when needed so
+// that the products do not overflow, and the chroma values do not exceed 255 (full range color spaces)
+#define RGB2YUV_CHROMA_FACTOR(value, Kf) \
+	(FIXED_POINT_VALUE(value, 8) < 32767/(256-FIXED_POINT_VALUE(Kf, 8)) ? \
+		FIXED_POINT_VALUE(value, 8) : 32767/(256-FIXED_POINT_VALUE(Kf, 8)))
 
 #define RGB2YUV_PARAM(Rf, Bf, YMin, YMax, CbCrRange) \
 {.r_factor=FIXED_POINT_VALUE(Rf, 8), \
 .g_factor=256-FIXED_POINT_VALUE(Rf, 8)-FIXED_POINT_VALUE(Bf, 8), \
 .b_factor=FIXED_POINT_VALUE(Bf, 8), \
-.cb_factor=FIXED_POINT_VALUE((CbCrRange/255.0)/(2.0*(1-Bf)), 8), \
-.cr_factor=FIXED_POINT_VALUE((CbCrRange/255.0)/(2.0*(1-Rf)), 8), \
+.cb_factor=RGB2YUV_CHROMA_FACTOR((CbCrRange/255.0)/(2.0*(1-Bf)), Bf), \
+.cr_factor=RGB2YUV_CHROMA_FACTOR((CbCrRange/255.0)/(2.0*(1-Rf)), Rf), \
 .y_factor=FIXED_POINT_VALUE((YMax-YMin)/255.0, 7), \
 .y_offset=YMin}
 
+#define YUV2RGB_CB_FACTOR(Rf, Bf, CbCrRange) FIXED_POINT_VALUE(255.0*(2.0*(1-Bf))/CbCrRange, 6)
+#define YUV2RGB_CR_FACTOR(Rf, Bf, CbCrRange) FIXED_POINT_VALUE(255.0*(2.0*(1-Rf))/CbCrRange, 6)
+#define YUV2RGB_G_CB_FACTOR(Rf, Bf, CbCrRange) FIXED_POINT_VALUE(Bf/(1.0-Bf-Rf)*255.0*(2.0*(1-Bf))/CbCrRange, 7)
+#define YUV2RGB_G_CR_FACTOR(Rf, Bf, CbCrRange) FIXED_POINT_VALUE(Rf/(1.0-Bf-Rf)*255.0*(2.0*(1-Rf))/CbCrRange, 7)
+#define YUV2RGB_Y_FACTOR(YMin, YMax) FIXED_POINT_VALUE(255.0/(YMax-YMin), 7)
+
 #define YUV2RGB_PARAM(Rf, Bf, YMin, YMax, CbCrRange) \
-{.cb_factor=FIXED_POINT_VALUE(255.0*(2.0*(1-Bf))/CbCrRange, 6), \
-.cr_factor=FIXED_POINT_VALUE(255.0*(2.0*(1-Rf))/CbCrRange, 6), \
-.g_cb_factor=FIXED_POINT_VALUE(Bf/(1.0-Bf-Rf)*255.0*(2.0*(1-Bf))/CbCrRange, 7), \
-.g_cr_factor=FIXED_POINT_VALUE(Rf/(1.0-Bf-Rf)*255.0*(2.0*(1-Rf))/CbCrRange, 7), \
-.y_factor=FIXED_POINT_VALUE(255.0/(YMax-YMin), 7), \
+{.cb_factor=YUV2RGB_CB_FACTOR(Rf, Bf, CbCrRange), \
+.cr_factor=YUV2RGB_CR_FACTOR(Rf, Bf, CbCrRange), \
+.g_cb_factor=YUV2RGB_G_CB_FACTOR(Rf, Bf, CbCrRange), \
+.g_cr_factor=YUV2RGB_G_CR_FACTOR(Rf, Bf, CbCrRange), \
+.y_factor=YUV2RGB_Y_FACTOR(YMin, YMax), \
 .y_offset=YMin}
 
-static const RGB2YUVParam RGB2YUV[3] = {
+// High bit depth samples are converted to 16 bits values S (with the significant bits in the most significant bits),
+// whose digital ranges are those of the 8 bits values multiplied by 256, and then to 15 bits values for 16 bits
+// signed multiplications with 32 bits results. For rgb values of BITS bits, with N=28-BITS:
+// * Y' = ((S-[YMin])>>1)*[2*(2^BITS-1)/(256*(YMax-YMin))] (0 for S<[YMin])
+// * Cb' = (S>>1)-16384 for the Cb value S, and the same for Cr
+// * R = (Y' + Cr'*[2*(2^BITS-1)*(CrNorm)/(256*CrRange)])>>N, and the same for G and B
+#define YUV2RGB16_PARAM(Rf, Bf, YMin, YMax, CbCrRange, BITS) \
+{.cb_factor=FIXED_POINT_VALUE(2.0*RGB16_MAX(BITS)*(2.0*(1-Bf))/(256.0*CbCrRange), RGB16_SHIFT(BITS)), \
+.cr_factor=FIXED_POINT_VALUE(2.0*RGB16_MAX(BITS)*(2.0*(1-Rf))/(256.0*CbCrRange), RGB16_SHIFT(BITS)), \
+.g_cb_factor=FIXED_POINT_VALUE(Bf/(1.0-Bf-Rf)*2.0*RGB16_MAX(BITS)*(2.0*(1-Bf))/(256.0*CbCrRange), RGB16_SHIFT(BITS)), \
+.g_cr_factor=FIXED_POINT_VALUE(Rf/(1.0-Bf-Rf)*2.0*RGB16_MAX(BITS)*(2.0*(1-Rf))/(256.0*CbCrRange), RGB16_SHIFT(BITS)), \
+.y_factor=FIXED_POINT_VALUE(2.0*RGB16_MAX(BITS)/(256.0*(YMax-YMin)), RGB16_SHIFT(BITS)), \
+.y_offset=(uint16_t)(256*YMin)}
+
+// the last YCBCR_TYPE_COUNT-YCBCR_CUSTOM_0 entries are set at runtime by yuv_rgb_set_custom_color_space
+RGB2YUVParam RGB2YUV[YCBCR_TYPE_COUNT] = {
 	// ITU-T T.871 (JPEG)
 	RGB2YUV_PARAM(0.299, 0.114, 0.0, 255.0, 255.0),
 	// ITU-R BT.601-7
 	RGB2YUV_PARAM(0.299, 0.114, 16.0, 235.0, 224.0),
 	// ITU-R BT.709-6
-	RGB2YUV_PARAM(0.2126, 0.0722, 16.0, 235.0, 224.0)
+	RGB2YUV_PARAM(0.2126, 0.0722, 16.0, 235.0, 224.0),
+	// ITU-R BT.709-6, full range
+	RGB2YUV_PARAM(0.2126, 0.0722, 0.0, 255.0, 255.0),
+	// ITU-R BT.2020-2, non constant luminance
+	RGB2YUV_PARAM(0.2627, 0.0593, 16.0, 235.0, 224.0),
+	// ITU-R BT.2020-2, non constant luminance, full range
+	RGB2YUV_PARAM(0.2627, 0.0593, 0.0, 255.0, 255.0)
 };
 
-static const YUV2RGBParam YUV2RGB[3] = {
+YUV2RGBParam YUV2RGB[YCBCR_TYPE_COUNT] = {
 	// ITU-T T.871 (JPEG)
 	YUV2RGB_PARAM(0.299, 0.114, 0.0, 255.0, 255.0),
 	// ITU-R BT.601-7
 	YUV2RGB_PARAM(0.299, 0.114, 16.0, 235.0, 224.0),
 	// ITU-R BT.709-6
-	YUV2RGB_PARAM(0.2126, 0.0722, 16.0, 235.0, 224.0)
+	YUV2RGB_PARAM(0.2126, 0.0722, 16.0, 235.0, 224.0),
+	// ITU-R BT.709-6, full range
+	YUV2RGB_PARAM(0.2126, 0.0722, 0.0, 255.0, 255.0),
+	// ITU-R BT.2020-2, non constant luminance
+	YUV2RGB_PARAM(0.2627, 0.0593, 16.0, 235.0, 224.0),
+	// ITU-R BT.2020-2, non constant luminance, full range
+	YUV2RGB_PARAM(0.2627, 0.0593, 0.0, 255.0, 255.0)
 };
 
+#define YUV2RGB16_PARAMS(BITS) { \
+	/* ITU-T T.871 (JPEG) */ \
+	YUV2RGB16_PARAM(0.299, 0.114, 0.0, 255.0, 255.0, BITS), \
+	/* ITU-R BT.601-7 */ \
+	YUV2RGB16_PARAM(0.299, 0.114, 16.0, 235.0, 224.0, BITS), \
+	/* ITU-R BT.709-6 */ \
+	YUV2RGB16_PARAM(0.2126, 0.0722, 16.0, 235.0, 224.0, BITS), \
+	/* ITU-R BT.709-6, full range */ \
+	YUV2RGB16_PARAM(0.2126, 0.0722, 0.0, 255.0, 255.0, BITS), \
+	/* ITU-R BT.2020-2, non constant luminance */ \
+	YUV2RGB16_PARAM(0.2627, 0.0593, 16.0, 235.0, 224.0, BITS), \
+	/* ITU-R BT.2020-2, non constant luminance, full range */ \
+	YUV2RGB16_PARAM(0.2627, 0.0593, 0.0, 255.0, 255.0, BITS) \
+}
+
+YUV2RGB16Param YUV2RGB16_8[YCBCR_TYPE_COUNT] = YUV2RGB16_PARAMS(8);
+YUV2RGB16Param YUV2RGB16_10[YCBCR_TYPE_COUNT] = YUV2RGB16_PARAMS(10);
+YUV2RGB16Param YUV2RGB16_16[YCBCR_TYPE_COUNT] = YUV2RGB16_PARAMS(16);
 
-void rgb24_yuv420_std(
-	uint32_t width, uint32_t height, 
-	const uint8_t *RGB, uint32_t RGB_stride, 
-	uint8_t *Y, uint8_t *U, uint8_t *V, uint32_t Y_stride, uint32_t UV_stride, 
-	YCbCrType yuv_type)
+// The precise rgb to yuv conversions compute Y, Cb and Cr directly from R, G and B, with 15 bits factors and 32 bits
+// intermediates, and round them, instead of truncating Y' and the chroma differences at each step:
+// * Y = ([Rf*(YMax-YMin)/255]*R + [Gf*(YMax-YMin)/255]*G + [Bf*(YMax-YMin)/255]*B + [YMin+0.5])>>15
+// * Cb = ([-Rf*CbRange/(255*CbNorm)]*Rs + [-Gf*...]*Gs + [(1-Bf)*...]*Bs + [128+0.5])>>17
+// * Cr = ([(1-Rf)*CrRange/(255*CrNorm)]*Rs + [-Gf*...]*Gs + [-Bf*...]*Bs + [128+0.5])>>17
+// where Rs, Gs and Bs are the sums of the 4 pixels of a 2x2 block. The g factors are computed from the others, so
+// that white gives exactly YMax and grays give exactly 128, and the results are within 1 of the floating point values.
+#define RGB2YUV_PRECISE_PARAM(Rf, Bf, YMin, YMax, CbCrRange) \
+{.y_r=FIXED_POINT_VALUE(Rf*(YMax-YMin)/255.0, 15), \
+.y_g=FIXED_POINT_VALUE((YMax-YMin)/255.0, 15)-FIXED_POINT_VALUE(Rf*(YMax-YMin)/255.0, 15)-FIXED_POINT_VALUE(Bf*(YMax-YMin)/255.0, 15), \
+.y_b=FIXED_POINT_VALUE(Bf*(YMax-YMin)/255.0, 15), \
+.cb_r=-FIXED_POINT_VALUE(Rf*CbCrRange/(255.0*2.0*(1-Bf)), 15), \
+.cb_g=FIXED_POINT_VALUE(Rf*CbCrRange/(255.0*2.0*(1-Bf)), 15)-FIXED_POINT_VALUE(CbCrRange/(255.0*2.0), 15), \
+.cb_b=FIXED_POINT_VALUE(CbCrRange/(255.0*2.0), 15), \
+.cr_r=FIXED_POINT_VALUE(CbCrRange/(255.0*2.0), 15), \
+.cr_g=FIXED_POINT_VALUE(Bf*CbCrRange/(255.0*2.0*(1-Rf)), 15)-FIXED_POINT_VALUE(CbCrRange/(255.0*2.0), 15), \
+.cr_b=-FIXED_POINT_VALUE(Bf*CbCrRange/(255.0*2.0*(1-Rf)), 15), \
+.y_offset=FIXED_POINT_VALUE(YMin+0.5, 15)}
+
+RGB2YUVPreciseParam RGB2YUV_PRECISE[YCBCR_TYPE_COUNT] = {
+	// ITU-T T.871 (JPEG)
+	RGB2YUV_PRECISE_PARAM(0.299, 0.114, 0.0, 255.0, 255.0),
+	// ITU-R BT.601-7
+	RGB2YUV_PRECISE_PARAM(0.299, 0.114, 16.0, 235.0, 224.0),
+	// ITU-R BT.709-6
+	RGB2YUV_PRECISE_PARAM(0.2126, 0.0722, 16.0, 235.0, 224.0),
+	// ITU-R BT.709-6, full range
+	RGB2YUV_PRECISE_PARAM(0.2126, 0.0722, 0.0, 255.0, 255.0),
+	// ITU-R BT.2020-2, non constant luminance
+	RGB2YUV_PRECISE_PARAM(0.2627, 0.0593, 16.0, 235.0, 224.0),
+	// ITU-R BT.2020-2, non constant luminance, full range
+	RGB2YUV_PRECISE_PARAM(0.2627, 0.0593, 0.0, 255.0, 255.0)
+};
+
+// The standard yuv to rgb implementation reads the products of the YUV2RGB factors by each possible sample value from
+// lookup tables, and clamps the results with a saturation table, so that each pixel only costs a few loads and adds.
+// The entries are exactly the values computed by the fixed point formulas, the g offset being shifted after the sum
+// of its unshifted cb and cr products, so that the results do not depend on the use of the tables.
+typedef struct
+{
+	int16_t y[256];    // ([255/(YMax-YMin)]*(Y-YMin))>>7, 0 for Y<YMin as in the simd implementations
+	int16_t r_cr[256]; // ([(255*CrNorm)/CrRange]*(Cr-128))>>6
+	int16_t b_cb[256]; // ([(255*CbNorm)/CbRange]*(Cb-128))>>6
+	int16_t g_cb[256]; // [Bf/Gf*(255*CbNorm)/CbRange]*(Cb-128)
+	int16_t g_cr[256]; // [Rf/Gf*(255*CrNorm)/CrRange]*(Cr-128)
+} YUV2RGBTable;
+
+// LUT_N(F, I, ...) expands to the N entries F(I, ...), F(I+1, ...), ..., F(I+N-1, ...)
+#define LUT_4(F, I, ...) F((I), __VA_ARGS__), F((I)+1, __VA_ARGS__), F((I)+2, __VA_ARGS__), F((I)+3, __VA_ARGS__)
+#define LUT_16(F, I, ...) LUT_4(F, (I), __VA_ARGS__), LUT_4(F, (I)+4, __VA_ARGS__), \
+	LUT_4(F, (I)+8, __VA_ARGS__), LUT_4(F, (I)+12, __VA_ARGS__)
+#define LUT_64(F, I, ...) LUT_16(F, (I), __VA_ARGS__), LUT_16(F, (I)+16, __VA_ARGS__), \
+	LUT_16(F, (I)+32, __VA_ARGS__), LUT_16(F, (I)+48, __VA_ARGS__)
+#define LUT_256(F, I, ...) LUT_64(F, (I), __VA_ARGS__), LUT_64(F, (I)+64, __VA_ARGS__), \
+	LUT_64(F, (I)+128, __VA_ARGS__), LUT_64(F, (I)+192, __VA_ARGS__)
+#define LUT_1024(F, I, ...) LUT_256(F, (I), __VA_ARGS__), LUT_256(F, (I)+256, __VA_ARGS__), \
+	LUT_256(F, (I)+512, __VA_ARGS__), LUT_256(F, (I)+768, __VA_ARGS__)
+
+// table entries for the sample value I, also used to fill the tables of the custom color spaces
+#define LUT_Y(I, FACTOR, OFFSET) ((I)>(OFFSET) ? ((FACTOR)*((I)-(OFFSET)))>>7 : 0)
+#define LUT_CHROMA(I, FACTOR, SHIFT) (((FACTOR)*((I)-128))>>(SHIFT))
+#define LUT_CLAMP(I, OFFSET) ((I)<(OFFSET) ? 0 : ((I)-(OFFSET)>255 ? 255 : (I)-(OFFSET)))
+
+#define YUV2RGB_TABLE(Rf, Bf, YMin, YMax, CbCrRange) \
+{.y={LUT_256(LUT_Y, 0, YUV2RGB_Y_FACTOR(YMin, YMax), (int)(YMin))}, \
+.r_cr={LUT_256(LUT_CHROMA, 0, YUV2RGB_CR_FACTOR(Rf, Bf, CbCrRange), 6)}, \
+.b_cb={LUT_256(LUT_CHROMA, 0, YUV2RGB_CB_FACTOR(Rf, Bf, CbCrRange), 6)}, \
+.g_cb={LUT_256(LUT_CHROMA, 0, YUV2RGB_G_CB_FACTOR(Rf, Bf, CbCrRange), 0)}, \
+.g_cr={LUT_256(LUT_CHROMA, 0, YUV2RGB_G_CR_FACTOR(Rf, Bf, CbCrRange), 0)}}
+
+// the last YCBCR_TYPE_COUNT-YCBCR_CUSTOM_0 entries are set at runtime by yuv_rgb_set_custom_color_space
+static YUV2RGBTable YUV2RGB_TABLE[YCBCR_TYPE_COUNT] = {
+	// ITU-T T.871 (JPEG)
+	YUV2RGB_TABLE(0.299, 0.114, 0.0, 255.0, 255.0),
+	// ITU-R BT.601-7
+	YUV2RGB_TABLE(0.299, 0.114, 16.0, 235.0, 224.0),
+	// ITU-R BT.709-6
+	YUV2RGB_TABLE(0.2126, 0.0722, 16.0, 235.0, 224.0),
+	// ITU-R BT.709-6, full range
+	YUV2RGB_TABLE(0.2126, 0.0722, 0.0, 255.0, 255.0),
+	// ITU-R BT.2020-2, non constant luminance
+	YUV2RGB_TABLE(0.2627, 0.0593, 16.0, 235.0, 224.0),
+	// ITU-R BT.2020-2, non constant luminance, full range
+	YUV2RGB_TABLE(0.2627, 0.0593, 0.0, 255.0, 255.0)
+};
+
+// The y and color offsets are at most 255*255>>7 and 255*128>>6 in absolute value (the factors fitting in 8 bits), so
+// that their sums are clamped to [0, 255] by indexing CLAMP_TABLE with their value plus CLAMP_OFFSET.
+#define CLAMP_OFFSET 1024
+static const uint8_t CLAMP_TABLE[2*CLAMP_OFFSET] = {
+	LUT_1024(LUT_CLAMP, 0, CLAMP_OFFSET), LUT_1024(LUT_CLAMP, 1024, CLAMP_OFFSET)
+};
+#define CLAMP_STD(VALUE) CLAMP_TABLE[(VALUE)+CLAMP_OFFSET]
+
+static void set_yuv2rgb_table(YUV2RGBTable *table, const YUV2RGBParam *param)
+{
+	int i;
+	for(i=0; i<256; ++i)
+	{
+		table->y[i] = LUT_Y(i, param->y_factor, param->y_offset);
+		table->r_cr[i] = LUT_CHROMA(i, param->cr_factor, 6);
+		table->b_cb[i] = LUT_CHROMA(i, param->cb_factor, 6);
+		table->g_cb[i] = LUT_CHROMA(i, param->g_cb_factor, 0);
+		table->g_cr[i] = LUT_CHROMA(i, param->g_cr_factor, 0);
+	}
+}
+
+// Custom color spaces are checked against the limits of the fixed point formats: the 8 bits factors must fit in
+// their fields, with 128*([Bf/Gf*...]+[Rf/Gf*...]) fitting in int16 for the simd implementations (the rgb to yuv
+// chroma factors being limited by RGB2YUV_CHROMA_FACTOR). The high bit depth
+// factors are proportional to the 8 bits ones, so that only the cb and cr factors (that have less fraction bits in
+// 8 bits) can then exceed the int16 limit for 16 bits rgb values, the int32 sums staying far from overflow.
+int yuv_rgb_set_custom_color_space(YCbCrType yuv_type, double kr, double kb, double y_min, double y_max, double cbcr_range)
 {
-	const RGB2YUVParam *const param = &(RGB2YUV[yuv_type]);
+	// conditions written so that nan values are rejected
+	if(yuv_type<YCBCR_CUSTOM_0 || yuv_type>YCBCR_CUSTOM_3 || !(kr>0.0 && kb>0.0 && kr+kb<1.0) ||
+		!(y_min>=0.0 && y_min<y_max && y_max<=255.0) || !(cbcr_range>0.0 && cbcr_range<=255.0))
+		return -1;
+	
+	// same values as RGB2YUV_PARAM and YUV2RGB_PARAM before their conversion to fixed point, the values that are
+	// too large for it being rejected first
+	const double cb = (cbcr_range/255.0)/(2.0*(1-kb)), cr = (cbcr_range/255.0)/(2.0*(1-kr)),
+		inv_cb = 255.0*(2.0*(1-kb))/cbcr_range, inv_cr = 255.0*(2.0*(1-kr))/cbcr_range,
+		g_cb = kb/(1.0-kb-kr)*inv_cb, g_cr = kr/(1.0-kb-kr)*inv_cr, inv_y = 255.0/(y_max-y_min);
+	if(cb>1.0 || cr>1.0 || inv_cb>4.0 || inv_cr>4.0 || g_cb>2.0 || g_cr>2.0 || inv_y>2.0)
+		return -1;
 	
+	const int r_factor = FIXED_POINT_VALUE(kr, 8), b_factor = FIXED_POINT_VALUE(kb, 8),
+		cb_factor = RGB2YUV_CHROMA_FACTOR(cb, kb), cr_factor = RGB2YUV_CHROMA_FACTOR(cr, kr);
+	if(r_factor>255 || b_factor>255 || r_factor+b_factor<1 || r_factor+b_factor>256 ||
+		cb_factor>255 || cr_factor>255 ||
+		FIXED_POINT_VALUE(inv_cb, 6)>255 || FIXED_POINT_VALUE(inv_cr, 6)>255 ||
+		FIXED_POINT_VALUE(g_cb, 7)+FIXED_POINT_VALUE(g_cr, 7)>255 || FIXED_POINT_VALUE(inv_y, 7)>255 ||
+		FIXED_POINT_VALUE(2.0*RGB16_MAX(16)*inv_cb/(255.0*256.0), RGB16_SHIFT(16))>32767 ||
+		FIXED_POINT_VALUE(2.0*RGB16_MAX(16)*inv_cr/(255.0*256.0), RGB16_SHIFT(16))>32767)
+		return -1;
+	// the precise g factors, which are the largest ones, must fit in int16 (the others are at most 0.5)
+	if((1.0-kr-kb)*(y_max-y_min)/255.0>0.999 || (1.0+kr/(1.0-kb))*cbcr_range/(2.0*255.0)>0.999 ||
+		(1.0+kb/(1.0-kr))*cbcr_range/(2.0*255.0)>0.999)
+		return -1;
+	
+	RGB2YUV[yuv_type] = (RGB2YUVParam)RGB2YUV_PARAM(kr, kb, y_min, y_max, cbcr_range);
+	YUV2RGB[yuv_type] = (YUV2RGBParam)YUV2RGB_PARAM(kr, kb, y_min, y_max, cbcr_range);
+	set_yuv2rgb_table(&YUV2RGB_TABLE[yuv_type], &YUV2RGB[yuv_type]);
+	RGB2YUV_PRECISE[yuv_type] = (RGB2YUVPreciseParam)RGB2YUV_PRECISE_PARAM(kr, kb, y_min, y_max, cbcr_range);
+	YUV2RGB16_8[yuv_type] = (YUV2RGB16Param)YUV2RGB16_PARAM(kr, kb, y_min, y_max, cbcr_range, 8);
+	YUV2RGB16_10[yuv_type] = (YUV2RGB16Param)YUV2RGB16_PARAM(kr, kb, y_min, y_max, cbcr_range, 10);
+	YUV2RGB16_16[yuv_type] = (YUV2RGB16Param)YUV2RGB16_PARAM(kr, kb, y_min, y_max, cbcr_range, 16);
+	return 0;
+}
+
+
+// The standard implementation processes pairs of pixels on pairs of lines, which share the same u and v values.
+// For odd widths, the last column is processed as pairs of identical pixels (DX=0 being the offset of the second
+// pixel), and for odd heights, the last line is processed as a pair of identical lines.
+
+// compute yuv for the four pixels, u and v values are summed, BPP being the number of bytes per rgb pixel
+#define RGB2YUV_STD(BPP, DX) \
+	uint8_t y_tmp; \
+	int16_t u_tmp, v_tmp; \
+	\
+	y_tmp = (param->r_factor*rgb_ptr1[0] + param->g_factor*rgb_ptr1[1] + param->b_factor*rgb_ptr1[2])>>8; \
+	u_tmp = rgb_ptr1[2]-y_tmp; \
+	v_tmp = rgb_ptr1[0]-y_tmp; \
+	y_ptr1[0]=((y_tmp*param->y_factor)>>7) + param->y_offset; \
+	\
+	y_tmp = (param->r_factor*rgb_ptr1[BPP*DX] + param->g_factor*rgb_ptr1[BPP*DX+1] + param->b_factor*rgb_ptr1[BPP*DX+2])>>8; \
+	u_tmp += rgb_ptr1[BPP*DX+2]-y_tmp; \
+	v_tmp += rgb_ptr1[BPP*DX]-y_tmp; \
+	y_ptr1[DX]=((y_tmp*param->y_factor)>>7) + param->y_offset; \
+	\
+	y_tmp = (param->r_factor*rgb_ptr2[0] + param->g_factor*rgb_ptr2[1] + param->b_factor*rgb_ptr2[2])>>8; \
+	u_tmp += rgb_ptr2[2]-y_tmp; \
+	v_tmp += rgb_ptr2[0]-y_tmp; \
+	y_ptr2[0]=((y_tmp*param->y_factor)>>7) + param->y_offset; \
+	\
+	y_tmp = (param->r_factor*rgb_ptr2[BPP*DX] + param->g_factor*rgb_ptr2[BPP*DX+1] + param->b_factor*rgb_ptr2[BPP*DX+2])>>8; \
+	u_tmp += rgb_ptr2[BPP*DX+2]-y_tmp; \
+	v_tmp += rgb_ptr2[BPP*DX]-y_tmp; \
+	y_ptr2[DX]=((y_tmp*param->y_factor)>>7) + param->y_offset; \
+	\
+	u_ptr[0] = (((u_tmp>>2)*param->cb_factor)>>8) + 128; \
+	v_ptr[0] = (((v_tmp>>2)*param->cr_factor)>>8) + 128;
+
+#define RGB2YUV_STD_FUNCTION(NAME, BPP) \
+void NAME##_yuv420_std( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *RGB, uint32_t RGB_stride, \
+	uint8_t *Y, uint8_t *U, uint8_t *V, uint32_t Y_stride, uint32_t UV_stride, \
+	YCbCrType yuv_type) \
+{ \
+	KERNEL_PARAM(RGB2YUVParam, RGB2YUV) \
+	\
+	uint32_t x, y; \
+	for(y=0; y<height; y+=2) \
+	{ \
+		const uint32_t y2 = (y+1)<height ? y+1 : y; \
+		const uint8_t *rgb_ptr1=RGB+y*RGB_stride, \
+			*rgb_ptr2=RGB+y2*RGB_stride; \
+		\
+		uint8_t *y_ptr1=Y+y*Y_stride, \
+			*y_ptr2=Y+y2*Y_stride, \
+			*u_ptr=U+(y/2)*UV_stride, \
+			*v_ptr=V+(y/2)*UV_stride; \
+		\
+		for(x=0; (x+1)<width; x+=2) \
+		{ \
+			RGB2YUV_STD(BPP, 1) \
+			\
+			rgb_ptr1 += 2*BPP; \
+			rgb_ptr2 += 2*BPP; \
+			y_ptr1 += 2; \
+			y_ptr2 += 2; \
+			u_ptr += 1; \
+			v_ptr += 1; \
+		} \
+		if(x<width) \
+		{ \
+			RGB2YUV_STD(BPP, 0) \
+		} \
+	} \
+}
+
+RGB2YUV_STD_FUNCTION(rgb24, 3)
+RGB2YUV_STD_FUNCTION(rgb32, 4)
+
+// rgba to yuva (yuv420 and an alpha plane)
+// Premultiplied colors are divided by their alpha, rounding 255*c/a to the nearest integer: (510*c+a)/(2*a), clamped
+// to 255 for invalid colors greater than alpha, and 0 for a null alpha. The simd versions compute the division in
+// single precision floats, whose truncation always gives the same result here (the fractional part of the exact
+// quotient is at least 1/510 away from the next integer, much more than the rounding error of the division).
+static uint8_t unpremultiply_std(uint8_t c, uint8_t a)
+{
+	uint32_t value;
+	if(a==0)
+		return 0;
+	value = (510u*c+a)/(2u*a);
+	return value>255 ? 255 : (uint8_t)value;
+}
+
+#define UNPREMULTIPLY_PIXEL_STD(DST, SRC) \
+	(DST)[0] = unpremultiply_std((SRC)[0], (SRC)[3]); \
+	(DST)[1] = unpremultiply_std((SRC)[1], (SRC)[3]); \
+	(DST)[2] = unpremultiply_std((SRC)[2], (SRC)[3]);
+
+// compute yuv of the pixels 0 and DX of the pair of lines, from the un-premultiplied colors if needed, and save
+// their alpha
+#define RGBA2YUVA_STD(DX) \
+	{ \
+		uint8_t rgb1[8], rgb2[8]; \
+		const uint8_t *rgb_ptr1=rgba_ptr1, *rgb_ptr2=rgba_ptr2; \
+		if(premultiplied) \
+		{ \
+			UNPREMULTIPLY_PIXEL_STD(rgb1, rgba_ptr1) \
+			UNPREMULTIPLY_PIXEL_STD(rgb1+4*DX, rgba_ptr1+4*DX) \
+			UNPREMULTIPLY_PIXEL_STD(rgb2, rgba_ptr2) \
+			UNPREMULTIPLY_PIXEL_STD(rgb2+4*DX, rgba_ptr2+4*DX) \
+			rgb_ptr1 = rgb1; \
+			rgb_ptr2 = rgb2; \
+		} \
+		if(A) \
+		{ \
+			A[y*Y_stride+x] = rgba_ptr1[3]; \
+			A[y*Y_stride+x+DX] = rgba_ptr1[4*DX+3]; \
+			A[y2*Y_stride+x] = rgba_ptr2[3]; \
+			A[y2*Y_stride+x+DX] = rgba_ptr2[4*DX+3]; \
+		} \
+		{ \
+			RGB2YUV_STD(4, DX) \
+		} \
+	}
+
+void rgb32_yuva420_std(
+	uint32_t width, uint32_t height,
+	const uint8_t *RGBA, uint32_t RGBA_stride,
+	uint8_t *Y, uint8_t *U, uint8_t *V, uint8_t *A, uint32_t Y_stride, uint32_t UV_stride,
+	int premultiplied, YCbCrType yuv_type)
+{
+	KERNEL_PARAM(RGB2YUVParam, RGB2YUV)
+
 	uint32_t x, y;
-	for(y=0; y<(height-1); y+=2)
+	for(y=0; y<height; y+=2)
 	{
-		const uint8_t *rgb_ptr1=RGB+y*RGB_stride,
-			*rgb_ptr2=RGB+(y+1)*RGB_stride;
-		
+		const uint32_t y2 = (y+1)<height ? y+1 : y;
+		const uint8_t *rgba_ptr1=RGBA+y*RGBA_stride,
+			*rgba_ptr2=RGBA+y2*RGBA_stride;
+
 		uint8_t *y_ptr1=Y+y*Y_stride,
-			*y_ptr2=Y+(y+1)*Y_stride,
+			*y_ptr2=Y+y2*Y_stride,
 			*u_ptr=U+(y/2)*UV_stride,
 			*v_ptr=V+(y/2)*UV_stride;
-		
-		for(x=0; x<(width-1); x+=2)
+
+		for(x=0; (x+1)<width; x+=2)
 		{
-			// compute yuv for the four pixels, u and v values are summed
-			uint8_t y_tmp;
-			int16_t u_tmp, v_tmp;
-			
-			y_tmp = (param->r_factor*rgb_ptr1[0] + param->g_factor*rgb_ptr1[1] + param->b_factor*rgb_ptr1[2])>>8;
-			u_tmp = rgb_ptr1[2]-y_tmp;
-			v_tmp = rgb_ptr1[0]-y_tmp;
-			y_ptr1[0]=((y_tmp*param->y_factor)>>7) + param->y_offset;
-			
-			y_tmp = (param->r_factor*rgb_ptr1[3] + param->g_factor*rgb_ptr1[4] + param->b_factor*rgb_ptr1[5])>>8;
-			u_tmp += rgb_ptr1[5]-y_tmp;
-			v_tmp += rgb_ptr1[3]-y_tmp;
-			y_ptr1[1]=((y_tmp*param->y_factor)>>7) + param->y_offset;
-
-			y_tmp = (param->r_factor*rgb_ptr2[0] + param->g_factor*rgb_ptr2[1] + param->b_factor*rgb_ptr2[2])>>8;
-			u_tmp += rgb_ptr2[2]-y_tmp;
-			v_tmp += rgb_ptr2[0]-y_tmp;
-			y_ptr2[0]=((y_tmp*param->y_factor)>>7) + param->y_offset;
-			
-			y_tmp = (param->r_factor*rgb_ptr2[3] + param->g_factor*rgb_ptr2[4] + param->b_factor*rgb_ptr2[5])>>8;
-			u_tmp += rgb_ptr2[5]-y_tmp;
-			v_tmp += rgb_ptr2[3]-y_tmp;
-			y_ptr2[1]=((y_tmp*param->y_factor)>>7) + param->y_offset;
-
-			u_ptr[0] = (((u_tmp>>2)*param->cb_factor)>>8) + 128;
-			v_ptr[0] = (((v_tmp>>2)*param->cr_factor)>>8) + 128;
-			
-			rgb_ptr1 += 6;
-			rgb_ptr2 += 6;
+			RGBA2YUVA_STD(1)
+
+			rgba_ptr1 += 8;
+			rgba_ptr2 += 8;
 			y_ptr1 += 2;
 			y_ptr2 += 2;
 			u_ptr += 1;
 			v_ptr += 1;
 		}
+		if(x<width)
+		{
+			RGBA2YUVA_STD(0)
+		}
 	}
 }
 
-void rgb32_yuv420_std(
-	uint32_t width, uint32_t height, 
-	const uint8_t *RGBA, uint32_t RGBA_stride, 
-	uint8_t *Y, uint8_t *U, uint8_t *V, uint32_t Y_stride, uint32_t UV_stride, 
-	YCbCrType yuv_type)
+// precise y of the pixel at PTR, and chroma value C (cb or cr) from the sums of r, g and b of the 2x2 block
+#define RGB2YUV_PRECISE_Y_STD(PTR) \
+	(uint8_t)((param->y_r*(PTR)[0] + param->y_g*(PTR)[1] + param->y_b*(PTR)[2] + param->y_offset)>>PRECISE_Y_SHIFT)
+#define RGB2YUV_PRECISE_CHROMA_STD(C) \
+	clamp_chroma_precise((param->C##_r*r_sum + param->C##_g*g_sum + param->C##_b*b_sum + PRECISE_CHROMA_OFFSET) \
+		>>PRECISE_CHROMA_SHIFT)
+
+static uint8_t clamp_chroma_precise(int32_t value)
 {
-	const RGB2YUVParam *const param = &(RGB2YUV[yuv_type]);
-	
-	uint32_t x, y;
-	for(y=0; y<(height-1); y+=2)
+	return value<0 ? 0 : (value>255 ? 255 : (uint8_t)value);
+}
+
+#define RGB2YUV_PRECISE_STD(BPP, DX) \
+	y_ptr1[0] = RGB2YUV_PRECISE_Y_STD(rgb_ptr1); \
+	y_ptr1[DX] = RGB2YUV_PRECISE_Y_STD(rgb_ptr1+BPP*DX); \
+	y_ptr2[0] = RGB2YUV_PRECISE_Y_STD(rgb_ptr2); \
+	y_ptr2[DX] = RGB2YUV_PRECISE_Y_STD(rgb_ptr2+BPP*DX); \
+	{ \
+		const int32_t r_sum = rgb_ptr1[0] + rgb_ptr1[BPP*DX] + rgb_ptr2[0] + rgb_ptr2[BPP*DX], \
+			g_sum = rgb_ptr1[1] + rgb_ptr1[BPP*DX+1] + rgb_ptr2[1] + rgb_ptr2[BPP*DX+1], \
+			b_sum = rgb_ptr1[2] + rgb_ptr1[BPP*DX+2] + rgb_ptr2[2] + rgb_ptr2[BPP*DX+2]; \
+		u_ptr[0] = RGB2YUV_PRECISE_CHROMA_STD(cb); \
+		v_ptr[0] = RGB2YUV_PRECISE_CHROMA_STD(cr); \
+	}
+
+#define RGB2YUV_PRECISE_STD_FUNCTION(NAME, BPP) \
+void NAME##_yuv420_precise_std( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *RGB, uint32_t RGB_stride, \
+	uint8_t *Y, uint8_t *U, uint8_t *V, uint32_t Y_stride, uint32_t UV_stride, \
+	YCbCrType yuv_type) \
+{ \
+	KERNEL_PARAM(RGB2YUVPreciseParam, RGB2YUV_PRECISE) \
+	\
+	uint32_t x, y; \
+	for(y=0; y<height; y+=2) \
+	{ \
+		const uint32_t y2 = (y+1)<height ? y+1 : y; \
+		const uint8_t *rgb_ptr1=RGB+y*RGB_stride, \
+			*rgb_ptr2=RGB+y2*RGB_stride; \
+		\
+		uint8_t *y_ptr1=Y+y*Y_stride, \
+			*y_ptr2=Y+y2*Y_stride, \
+			*u_ptr=U+(y/2)*UV_stride, \
+			*v_ptr=V+(y/2)*UV_stride; \
+		\
+		for(x=0; (x+1)<width; x+=2) \
+		{ \
+			RGB2YUV_PRECISE_STD(BPP, 1) \
+			\
+			rgb_ptr1 += 2*BPP; \
+			rgb_ptr2 += 2*BPP; \
+			y_ptr1 += 2; \
+			y_ptr2 += 2; \
+			u_ptr += 1; \
+			v_ptr += 1; \
+		} \
+		if(x<width) \
+		{ \
+			RGB2YUV_PRECISE_STD(BPP, 0) \
+		} \
+	} \
+}
+
+RGB2YUV_PRECISE_STD_FUNCTION(rgb24, 3)
+RGB2YUV_PRECISE_STD_FUNCTION(rgb32, 4)
+
+
+// The rgb formats of the yuv to rgb conversions are defined by a save macro SAVE(LINE, DX, R, G, B), which saves
+// the 8 bits values r, g and b of the pixel DX of the line LINE (1 or 2) of a pair, relative to the line pointers
+// (rgb_ptr1 and rgb_ptr2 for interleaved formats, see yuv_rgb.h for the formats).
+#define SAVE_3CHANNELS_STD(PTR, C1, C2, C3) (PTR)[0] = C1; (PTR)[1] = C2; (PTR)[2] = C3;
+#define SAVE_4CHANNELS_STD(PTR, C1, C2, C3, C4) (PTR)[0] = C1; (PTR)[1] = C2; (PTR)[2] = C3; (PTR)[3] = C4;
+
+#define SAVE_RGB24_STD(LINE, DX, R, G, B) SAVE_3CHANNELS_STD(rgb_ptr##LINE+3*(DX), R, G, B)
+#define SAVE_BGR24_STD(LINE, DX, R, G, B) SAVE_3CHANNELS_STD(rgb_ptr##LINE+3*(DX), B, G, R)
+#define SAVE_RGB32_STD(LINE, DX, R, G, B) SAVE_4CHANNELS_STD(rgb_ptr##LINE+4*(DX), R, G, B, 255)
+#define SAVE_BGRA_STD(LINE, DX, R, G, B) SAVE_4CHANNELS_STD(rgb_ptr##LINE+4*(DX), B, G, R, 255)
+#define SAVE_ARGB_STD(LINE, DX, R, G, B) SAVE_4CHANNELS_STD(rgb_ptr##LINE+4*(DX), 255, R, G, B)
+#define SAVE_RGB565_STD(LINE, DX, R, G, B) \
+	{ \
+		const uint16_t rgb565 = (uint16_t)(((R)>>3)<<11 | ((G)>>2)<<5 | (B)>>3); \
+		rgb_ptr##LINE[2*(DX)] = (uint8_t)rgb565; \
+		rgb_ptr##LINE[2*(DX)+1] = (uint8_t)(rgb565>>8); \
+	}
+
+// compute rgb for the pixel Y_VALUE, and save it with SAVE
+#define YUV2RGB_PIXEL_STD(Y_VALUE, LINE, DX, SAVE) \
+	y_tmp = table->y[Y_VALUE]; \
+	{ \
+		const uint8_t r = CLAMP_STD(y_tmp + r_cr_offset), g = CLAMP_STD(y_tmp - g_cbcr_offset), \
+			b = CLAMP_STD(y_tmp + b_cb_offset); \
+		SAVE(LINE, DX, r, g, b) \
+	}
+
+// compute the Cb Cr color offsets of the u and v values, common to the pixels which share them
+#define UV2RGB_STD(U_VALUE, V_VALUE) \
+	const uint8_t u_tmp = U_VALUE, v_tmp = V_VALUE; \
+	const int16_t b_cb_offset = table->b_cb[u_tmp], r_cr_offset = table->r_cr[v_tmp], \
+		g_cbcr_offset = (table->g_cb[u_tmp] + table->g_cr[v_tmp])>>7;
+
+// compute rgb for the four pixels of the lines LINE1 and LINE2, which share the same u and v values
+#define YUV2RGB_STD(U_VALUE, V_VALUE, DX, SAVE, LINE1, LINE2) \
+	{ \
+		UV2RGB_STD(U_VALUE, V_VALUE) \
+		\
+		int16_t y_tmp; \
+		YUV2RGB_PIXEL_STD(y_ptr##LINE1[0], LINE1, 0, SAVE) \
+		YUV2RGB_PIXEL_STD(y_ptr##LINE1[DX], LINE1, DX, SAVE) \
+		YUV2RGB_PIXEL_STD(y_ptr##LINE2[0], LINE2, 0, SAVE) \
+		YUV2RGB_PIXEL_STD(y_ptr##LINE2[DX], LINE2, DX, SAVE) \
+	}
+
+// The standard yuv 4:2:0 loops convert two pairs of lines per iteration, the lines 1 and 2 sharing the u and v values
+// U1 and V1, and the lines 3 and 4 the values U2 and V2, so that the table lookups of the two pairs are independent.
+// At the bottom of the image, the missing lines are replaced by the previous line of their pair, or the missing pair
+// by the first one (which is then converted twice).
+#define YUV2RGB_PAIRS_STD(U1, V1, U2, V2, DX, SAVE) \
+	YUV2RGB_STD(U1, V1, DX, SAVE, 1, 2) \
+	YUV2RGB_STD(U2, V2, DX, SAVE, 3, 4)
+
+#define LINES_STD \
+	const uint32_t y2 = (y+1)<height ? y+1 : y, \
+		y3 = (y+2)<height ? y+2 : y, \
+		y4 = (y3+1)<height ? y3+1 : y3;
+
+// YUV420_STD_FUNCTION(FORMAT, BPP, SAVE) defines the standard implementation of yuv420 to FORMAT
+#define YUV420_STD_FUNCTION(FORMAT, BPP, SAVE) \
+void yuv420_##FORMAT##_std( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *Y, const uint8_t *U, const uint8_t *V, uint32_t Y_stride, uint32_t UV_stride, \
+	uint8_t *RGB, uint32_t RGB_stride, \
+	YCbCrType yuv_type) \
+{ \
+	const YUV2RGBTable *const table = &(YUV2RGB_TABLE[yuv_type]); \
+	uint32_t x, y; \
+	for(y=0; y<height; y+=4) \
+	{ \
+		LINES_STD \
+		const uint8_t *y_ptr1=Y+y*Y_stride, \
+			*y_ptr2=Y+y2*Y_stride, \
+			*y_ptr3=Y+y3*Y_stride, \
+			*y_ptr4=Y+y4*Y_stride, \
+			*u_ptr1=U+(y/2)*UV_stride, \
+			*u_ptr2=U+(y3/2)*UV_stride, \
+			*v_ptr1=V+(y/2)*UV_stride, \
+			*v_ptr2=V+(y3/2)*UV_stride; \
+		\
+		uint8_t *rgb_ptr1=RGB+y*RGB_stride, \
+			*rgb_ptr2=RGB+y2*RGB_stride, \
+			*rgb_ptr3=RGB+y3*RGB_stride, \
+			*rgb_ptr4=RGB+y4*RGB_stride; \
+		\
+		for(x=0; (x+1)<width; x+=2) \
+		{ \
+			YUV2RGB_PAIRS_STD(u_ptr1[0], v_ptr1[0], u_ptr2[0], v_ptr2[0], 1, SAVE) \
+			\
+			rgb_ptr1 += 2*BPP; \
+			rgb_ptr2 += 2*BPP; \
+			rgb_ptr3 += 2*BPP; \
+			rgb_ptr4 += 2*BPP; \
+			y_ptr1 += 2; \
+			y_ptr2 += 2; \
+			y_ptr3 += 2; \
+			y_ptr4 += 2; \
+			u_ptr1 += 1; \
+			u_ptr2 += 1; \
+			v_ptr1 += 1; \
+			v_ptr2 += 1; \
+		} \
+		if(x<width) \
+		{ \
+			YUV2RGB_PAIRS_STD(u_ptr1[0], v_ptr1[0], u_ptr2[0], v_ptr2[0], 0, SAVE) \
+		} \
+	} \
+}
+
+// NV12_STD_FUNCTION(nv12, 0, 1, ...) and NV12_STD_FUNCTION(nv21, 1, 0, ...) define the standard implementation of the
+// two semi planar formats, U_INDEX and V_INDEX being the positions of u and v in the interleaved uv data
+#define NV12_STD_FUNCTION(NAME, U_INDEX, V_INDEX, FORMAT, BPP, SAVE) \
+void NAME##_##FORMAT##_std( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *Y, const uint8_t *UV, uint32_t Y_stride, uint32_t UV_stride, \
+	uint8_t *RGB, uint32_t RGB_stride, \
+	YCbCrType yuv_type) \
+{ \
+	const YUV2RGBTable *const table = &(YUV2RGB_TABLE[yuv_type]); \
+	uint32_t x, y; \
+	for(y=0; y<height; y+=4) \
+	{ \
+		LINES_STD \
+		const uint8_t *y_ptr1=Y+y*Y_stride, \
+			*y_ptr2=Y+y2*Y_stride, \
+			*y_ptr3=Y+y3*Y_stride, \
+			*y_ptr4=Y+y4*Y_stride, \
+			*uv_ptr1=UV+(y/2)*UV_stride, \
+			*uv_ptr2=UV+(y3/2)*UV_stride; \
+		\
+		uint8_t *rgb_ptr1=RGB+y*RGB_stride, \
+			*rgb_ptr2=RGB+y2*RGB_stride, \
+			*rgb_ptr3=RGB+y3*RGB_stride, \
+			*rgb_ptr4=RGB+y4*RGB_stride; \
+		\
+		for(x=0; (x+1)<width; x+=2) \
+		{ \
+			YUV2RGB_PAIRS_STD(uv_ptr1[U_INDEX], uv_ptr1[V_INDEX], uv_ptr2[U_INDEX], uv_ptr2[V_INDEX], 1, SAVE) \
+			\
+			rgb_ptr1 += 2*BPP; \
+			rgb_ptr2 += 2*BPP; \
+			rgb_ptr3 += 2*BPP; \
+			rgb_ptr4 += 2*BPP; \
+			y_ptr1 += 2; \
+			y_ptr2 += 2; \
+			y_ptr3 += 2; \
+			y_ptr4 += 2; \
+			uv_ptr1 += 2; \
+			uv_ptr2 += 2; \
+		} \
+		if(x<width) \
+		{ \
+			YUV2RGB_PAIRS_STD(uv_ptr1[U_INDEX], uv_ptr1[V_INDEX], uv_ptr2[U_INDEX], uv_ptr2[V_INDEX], 0, SAVE) \
+		} \
+	} \
+}
+
+// define the standard implementations of the three yuv formats to FORMAT
+#define YUV2RGB_STD_FUNCTIONS(FORMAT, BPP, SAVE) \
+	YUV420_STD_FUNCTION(FORMAT, BPP, SAVE) \
+	NV12_STD_FUNCTION(nv12, 0, 1, FORMAT, BPP, SAVE) \
+	NV12_STD_FUNCTION(nv21, 1, 0, FORMAT, BPP, SAVE)
+
+YUV2RGB_STD_FUNCTIONS(rgb24, 3, SAVE_RGB24_STD)
+YUV2RGB_STD_FUNCTIONS(rgb32, 4, SAVE_RGB32_STD)
+YUV2RGB_STD_FUNCTIONS(bgra, 4, SAVE_BGRA_STD)
+YUV2RGB_STD_FUNCTIONS(argb, 4, SAVE_ARGB_STD)
+YUV2RGB_STD_FUNCTIONS(bgr24, 3, SAVE_BGR24_STD)
+YUV2RGB_STD_FUNCTIONS(rgb565, 2, SAVE_RGB565_STD)
+
+// yuva to rgba, with the alpha values of the alpha plane (rgb32) or premultiplied colors (bgra_premultiplied)
+// Colors are premultiplied by rounding c*a/255 to the nearest integer, computed exactly as (t+(t>>8))>>8 with
+// t=c*a+128, which is also (t*257)>>16 (so that the simd versions can use a 16 bits high multiplication).
+#define PREMULTIPLY_STD(C, A) (uint8_t)((((C)*(A)+128)*257)>>16)
+
+#define SAVE_RGBA_YUVA_STD(LINE, DX, R, G, B) SAVE_4CHANNELS_STD(rgb_ptr##LINE+4*(DX), R, G, B, a_ptr##LINE[DX])
+#define SAVE_BGRA_PREMULTIPLIED_YUVA_STD(LINE, DX, R, G, B) \
+	SAVE_4CHANNELS_STD(rgb_ptr##LINE+4*(DX), PREMULTIPLY_STD(B, a_ptr##LINE[DX]), PREMULTIPLY_STD(G, a_ptr##LINE[DX]), \
+		PREMULTIPLY_STD(R, a_ptr##LINE[DX]), a_ptr##LINE[DX])
+
+// YUVA420_STD_FUNCTION(FORMAT, SAVE) defines the standard implementation of yuva420 to FORMAT
+#define YUVA420_STD_FUNCTION(FORMAT, SAVE) \
+void yuva420_##FORMAT##_std( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *Y, const uint8_t *U, const uint8_t *V, const uint8_t *A, uint32_t Y_stride, uint32_t UV_stride, \
+	uint8_t *RGB, uint32_t RGB_stride, \
+	YCbCrType yuv_type) \
+{ \
+	const YUV2RGBTable *const table = &(YUV2RGB_TABLE[yuv_type]); \
+	uint32_t x, y; \
+	for(y=0; y<height; y+=4) \
+	{ \
+		LINES_STD \
+		const uint8_t *y_ptr1=Y+y*Y_stride, \
+			*y_ptr2=Y+y2*Y_stride, \
+			*y_ptr3=Y+y3*Y_stride, \
+			*y_ptr4=Y+y4*Y_stride, \
+			*a_ptr1=A+y*Y_stride, \
+			*a_ptr2=A+y2*Y_stride, \
+			*a_ptr3=A+y3*Y_stride, \
+			*a_ptr4=A+y4*Y_stride, \
+			*u_ptr1=U+(y/2)*UV_stride, \
+			*u_ptr2=U+(y3/2)*UV_stride, \
+			*v_ptr1=V+(y/2)*UV_stride, \
+			*v_ptr2=V+(y3/2)*UV_stride; \
+		\
+		uint8_t *rgb_ptr1=RGB+y*RGB_stride, \
+			*rgb_ptr2=RGB+y2*RGB_stride, \
+			*rgb_ptr3=RGB+y3*RGB_stride, \
+			*rgb_ptr4=RGB+y4*RGB_stride; \
+		\
+		for(x=0; (x+1)<width; x+=2) \
+		{ \
+			YUV2RGB_PAIRS_STD(u_ptr1[0], v_ptr1[0], u_ptr2[0], v_ptr2[0], 1, SAVE) \
+			\
+			rgb_ptr1 += 8; \
+			rgb_ptr2 += 8; \
+			rgb_ptr3 += 8; \
+			rgb_ptr4 += 8; \
+			y_ptr1 += 2; \
+			y_ptr2 += 2; \
+			y_ptr3 += 2; \
+			y_ptr4 += 2; \
+			a_ptr1 += 2; \
+			a_ptr2 += 2; \
+			a_ptr3 += 2; \
+			a_ptr4 += 2; \
+			u_ptr1 += 1; \
+			u_ptr2 += 1; \
+			v_ptr1 += 1; \
+			v_ptr2 += 1; \
+		} \
+		if(x<width) \
+		{ \
+			YUV2RGB_PAIRS_STD(u_ptr1[0], v_ptr1[0], u_ptr2[0], v_ptr2[0], 0, SAVE) \
+		} \
+	} \
+}
+
+YUVA420_STD_FUNCTION(rgb32, SAVE_RGBA_YUVA_STD)
+YUVA420_STD_FUNCTION(bgra_premultiplied, SAVE_BGRA_PREMULTIPLIED_YUVA_STD)
+
+
+// Planar rgb output
+// The r, g and b values are saved in three separate planes, as 8 bits values (rgb_planar), or normalized as
+// (value-mean)*scale in single precision (rgb_planar_f32) or half precision (rgb_planar_f16) floats, so that the
+// result can be used directly as the input tensor of a neural network.
+
+// convert a single precision float to half precision, rounding to nearest even
+static uint16_t float_to_half(float value)
+{
+	uint32_t f, sign;
+	uint16_t h;
+	memcpy(&f, &value, sizeof(f));
+	sign = f & 0x80000000u;
+	f ^= sign;
+	if(f >= 0x47800000u)
+	{
+		// too large for half precision: infinity, or nan
+		h = f > 0x7F800000u ? 0x7E00 : 0x7C00;
+	}
+	else if(f < 0x38800000u)
+	{
+		// subnormal half: the float addition of 0.5 rounds the mantissa, which is then in the low bits
+		float tmp;
+		uint32_t t;
+		const uint32_t magic = 0x3F000000u;
+		memcpy(&tmp, &f, sizeof(tmp));
+		tmp += 0.5f;
+		memcpy(&t, &tmp, sizeof(t));
+		h = (uint16_t)(t - magic);
+	}
+	else
+	{
+		// normal half: rebias the exponent and round the mantissa
+		const uint32_t mantissa_odd = (f >> 13) & 1;
+		f += 0xC8000FFFu + mantissa_odd;
+		h = (uint16_t)(f >> 13);
+	}
+	return (uint16_t)(h | (sign >> 16));
+}
+
+#define NORMALIZE_STD(VALUE, CHANNEL) (((float)(VALUE)-norm->mean[CHANNEL])*norm->scale[CHANNEL])
+
+#define SAVE_RGB_PLANAR_STD(LINE, DX, R, G, B) \
+	r_ptr##LINE[DX] = R; \
+	g_ptr##LINE[DX] = G; \
+	b_ptr##LINE[DX] = B;
+
+#define SAVE_RGB_PLANAR_F32_STD(LINE, DX, R, G, B) \
+	r_ptr##LINE[DX] = NORMALIZE_STD(R, 0); \
+	g_ptr##LINE[DX] = NORMALIZE_STD(G, 1); \
+	b_ptr##LINE[DX] = NORMALIZE_STD(B, 2);
+
+#define SAVE_RGB_PLANAR_F16_STD(LINE, DX, R, G, B) \
+	r_ptr##LINE[DX] = float_to_half(NORMALIZE_STD(R, 0)); \
+	g_ptr##LINE[DX] = float_to_half(NORMALIZE_STD(G, 1)); \
+	b_ptr##LINE[DX] = float_to_half(NORMALIZE_STD(B, 2));
+
+// pointers to the planes of the four lines of LINES_STD
+#define PLANAR_RGB_LINES_STD(TYPE) \
+	PLANAR_RGB_LINES(TYPE, y, y2) \
+	TYPE *r_ptr3=BYTE_OFFSET(R, y3*RGB_stride), *g_ptr3=BYTE_OFFSET(G, y3*RGB_stride), *b_ptr3=BYTE_OFFSET(B, y3*RGB_stride), \
+		*r_ptr4=BYTE_OFFSET(R, y4*RGB_stride), *g_ptr4=BYTE_OFFSET(G, y4*RGB_stride), *b_ptr4=BYTE_OFFSET(B, y4*RGB_stride);
+
+#define PLANAR_RGB_ADVANCE_STD(N) \
+	PLANAR_RGB_ADVANCE(N) \
+	r_ptr3+=N; g_ptr3+=N; b_ptr3+=N; \
+	r_ptr4+=N; g_ptr4+=N; b_ptr4+=N;
+
+// YUV420_PLANAR_STD_FUNCTION(FORMAT, TYPE, SAVE) defines the standard implementation of yuv420 to the planar FORMAT,
+// of which planes have elements of type TYPE
+#define YUV420_PLANAR_STD_FUNCTION(FORMAT, TYPE, SAVE) \
+void yuv420_##FORMAT##_std( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *Y, const uint8_t *U, const uint8_t *V, uint32_t Y_stride, uint32_t UV_stride, \
+	TYPE *R, TYPE *G, TYPE *B, uint32_t RGB_stride, PLANAR_NORM_PARAM_##FORMAT \
+	YCbCrType yuv_type) \
+{ \
+	const YUV2RGBTable *const table = &(YUV2RGB_TABLE[yuv_type]); \
+	uint32_t x, y; \
+	for(y=0; y<height; y+=4) \
+	{ \
+		LINES_STD \
+		const uint8_t *y_ptr1=Y+y*Y_stride, \
+			*y_ptr2=Y+y2*Y_stride, \
+			*y_ptr3=Y+y3*Y_stride, \
+			*y_ptr4=Y+y4*Y_stride, \
+			*u_ptr1=U+(y/2)*UV_stride, \
+			*u_ptr2=U+(y3/2)*UV_stride, \
+			*v_ptr1=V+(y/2)*UV_stride, \
+			*v_ptr2=V+(y3/2)*UV_stride; \
+		\
+		PLANAR_RGB_LINES_STD(TYPE) \
+		\
+		for(x=0; (x+1)<width; x+=2) \
+		{ \
+			YUV2RGB_PAIRS_STD(u_ptr1[0], v_ptr1[0], u_ptr2[0], v_ptr2[0], 1, SAVE) \
+			\
+			PLANAR_RGB_ADVANCE_STD(2) \
+			y_ptr1 += 2; \
+			y_ptr2 += 2; \
+			y_ptr3 += 2; \
+			y_ptr4 += 2; \
+			u_ptr1 += 1; \
+			u_ptr2 += 1; \
+			v_ptr1 += 1; \
+			v_ptr2 += 1; \
+		} \
+		if(x<width) \
+		{ \
+			YUV2RGB_PAIRS_STD(u_ptr1[0], v_ptr1[0], u_ptr2[0], v_ptr2[0], 0, SAVE) \
+		} \
+	} \
+}
+
+#define NV12_PLANAR_STD_FUNCTION(NAME, U_INDEX, V_INDEX, FORMAT, TYPE, SAVE) \
+void NAME##_##FORMAT##_std( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *Y, const uint8_t *UV, uint32_t Y_stride, uint32_t UV_stride, \
+	TYPE *R, TYPE *G, TYPE *B, uint32_t RGB_stride, PLANAR_NORM_PARAM_##FORMAT \
+	YCbCrType yuv_type) \
+{ \
+	const YUV2RGBTable *const table = &(YUV2RGB_TABLE[yuv_type]); \
+	uint32_t x, y; \
+	for(y=0; y<height; y+=4) \
+	{ \
+		LINES_STD \
+		const uint8_t *y_ptr1=Y+y*Y_stride, \
+			*y_ptr2=Y+y2*Y_stride, \
+			*y_ptr3=Y+y3*Y_stride, \
+			*y_ptr4=Y+y4*Y_stride, \
+			*uv_ptr1=UV+(y/2)*UV_stride, \
+			*uv_ptr2=UV+(y3/2)*UV_stride; \
+		\
+		PLANAR_RGB_LINES_STD(TYPE) \
+		\
+		for(x=0; (x+1)<width; x+=2) \
+		{ \
+			YUV2RGB_PAIRS_STD(uv_ptr1[U_INDEX], uv_ptr1[V_INDEX], uv_ptr2[U_INDEX], uv_ptr2[V_INDEX], 1, SAVE) \
+			\
+			PLANAR_RGB_ADVANCE_STD(2) \
+			y_ptr1 += 2; \
+			y_ptr2 += 2; \
+			y_ptr3 += 2; \
+			y_ptr4 += 2; \
+			uv_ptr1 += 2; \
+			uv_ptr2 += 2; \
+		} \
+		if(x<width) \
+		{ \
+			YUV2RGB_PAIRS_STD(uv_ptr1[U_INDEX], uv_ptr1[V_INDEX], uv_ptr2[U_INDEX], uv_ptr2[V_INDEX], 0, SAVE) \
+		} \
+	} \
+}
+
+#define YUV2RGB_PLANAR_STD_FUNCTIONS(FORMAT, TYPE, SAVE) \
+	YUV420_PLANAR_STD_FUNCTION(FORMAT, TYPE, SAVE) \
+	NV12_PLANAR_STD_FUNCTION(nv12, 0, 1, FORMAT, TYPE, SAVE) \
+	NV12_PLANAR_STD_FUNCTION(nv21, 1, 0, FORMAT, TYPE, SAVE)
+
+YUV2RGB_PLANAR_STD_FUNCTIONS(rgb_planar, uint8_t, SAVE_RGB_PLANAR_STD)
+YUV2RGB_PLANAR_STD_FUNCTIONS(rgb_planar_f32, float, SAVE_RGB_PLANAR_F32_STD)
+YUV2RGB_PLANAR_STD_FUNCTIONS(rgb_planar_f16, uint16_t, SAVE_RGB_PLANAR_F16_STD)
+
+// High bit depth input
+// The samples of yuv420p10 (10 bits in the least significant bits) and p010 (significant bits in the most significant
+// bits, so that it also converts p012 and p016) are converted to 16 bits values (see YUV2RGB16_PARAM), and the rgb values
+// are rounded to the BITS bits of the output format, 8 for rgb24, 10 for x2rgb10 and 16 for rgb48. Unlike the other
+// standard implementations, y values below YMin are clamped to YMin, so that the simd implementations give exactly the
+// same results.
+
+// 16 bits value of a sample
+#define SAMPLE16_YUV420P10_STD(S) ((uint16_t)((S)<<6))
+#define SAMPLE16_P010_STD(S) (S)
+
+static uint16_t clamp16(int32_t value, int32_t max)
+{
+	return (uint16_t)(value<0 ? 0 : (value>max ? max : value));
+}
+
+// save 16 bits little endian values
+#define SAVE_LE16_STD(PTR, VALUE) (PTR)[0] = (uint8_t)(VALUE); (PTR)[1] = (uint8_t)((VALUE)>>8);
+
+#define SAVE_RGB48_STD(LINE, DX, R, G, B) \
+	SAVE_LE16_STD(rgb_ptr##LINE+6*(DX), R) \
+	SAVE_LE16_STD(rgb_ptr##LINE+6*(DX)+2, G) \
+	SAVE_LE16_STD(rgb_ptr##LINE+6*(DX)+4, B)
+
+#define SAVE_X2RGB10_STD(LINE, DX, R, G, B) \
+	{ \
+		const uint32_t x2rgb10 = 3u<<30 | (uint32_t)(R)<<20 | (uint32_t)(G)<<10 | (B); \
+		SAVE_LE16_STD(rgb_ptr##LINE+4*(DX), x2rgb10) \
+		SAVE_LE16_STD(rgb_ptr##LINE+4*(DX)+2, x2rgb10>>16) \
+	}
+
+// compute rgb for the pixel of 16 bits value Y_VALUE, and save it with SAVE
+#define YUV2RGB16_PIXEL_STD(Y_VALUE, LINE, DX, BITS, SAVE) \
+	{ \
+		const uint16_t y_value = Y_VALUE; \
+		const int32_t y_tmp = ((y_value>param->y_offset ? y_value-param->y_offset : 0)>>1)*param->y_factor; \
+		const uint16_t r = clamp16((y_tmp + r_cr_offset)>>RGB16_SHIFT(BITS), RGB16_MAX(BITS)), \
+			g = clamp16((y_tmp + g_cbcr_offset)>>RGB16_SHIFT(BITS), RGB16_MAX(BITS)), \
+			b = clamp16((y_tmp + b_cb_offset)>>RGB16_SHIFT(BITS), RGB16_MAX(BITS)); \
+		SAVE(LINE, DX, r, g, b) \
+	}
+
+// compute rgb for the four pixels, which share the same u and v values, INPUT being the input format
+#define YUV2RGB16_STD(U_VALUE, V_VALUE, DX, INPUT, BITS, SAVE) \
+	const int32_t u_tmp = (SAMPLE16_##INPUT##_STD(U_VALUE)>>1)-16384, \
+		v_tmp = (SAMPLE16_##INPUT##_STD(V_VALUE)>>1)-16384; \
+	\
+	/*compute Cb Cr color offsets, common to four pixels, with the rounding of the rgb values*/ \
+	const int32_t r_cr_offset = param->cr_factor*v_tmp + RGB16_ROUND(BITS), \
+		g_cbcr_offset = RGB16_ROUND(BITS) - param->g_cb_factor*u_tmp - param->g_cr_factor*v_tmp, \
+		b_cb_offset = param->cb_factor*u_tmp + RGB16_ROUND(BITS); \
+	\
+	YUV2RGB16_PIXEL_STD(SAMPLE16_##INPUT##_STD(y_ptr1[0]), 1, 0, BITS, SAVE) \
+	YUV2RGB16_PIXEL_STD(SAMPLE16_##INPUT##_STD(y_ptr1[DX]), 1, DX, BITS, SAVE) \
+	YUV2RGB16_PIXEL_STD(SAMPLE16_##INPUT##_STD(y_ptr2[0]), 2, 0, BITS, SAVE) \
+	YUV2RGB16_PIXEL_STD(SAMPLE16_##INPUT##_STD(y_ptr2[DX]), 2, DX, BITS, SAVE)
+
+// YUV420P10_STD_FUNCTION(FORMAT, BPP, BITS, SAVE) defines the standard implementation of yuv420p10 to FORMAT
+#define YUV420P10_STD_FUNCTION(FORMAT, BPP, BITS, SAVE) \
+void yuv420p10_##FORMAT##_std( \
+	uint32_t width, uint32_t height, \
+	const uint16_t *Y, const uint16_t *U, const uint16_t *V, uint32_t Y_stride, uint32_t UV_stride, \
+	uint8_t *RGB, uint32_t RGB_stride, \
+	YCbCrType yuv_type) \
+{ \
+	KERNEL_PARAM(YUV2RGB16Param, YUV2RGB16_##BITS) \
+	uint32_t x, y; \
+	for(y=0; y<height; y+=2) \
+	{ \
+		const uint32_t y2 = (y+1)<height ? y+1 : y; \
+		const uint16_t *y_ptr1=BYTE_OFFSET(Y, y*Y_stride), \
+			*y_ptr2=BYTE_OFFSET(Y, y2*Y_stride), \
+			*u_ptr=BYTE_OFFSET(U, (y/2)*UV_stride), \
+			*v_ptr=BYTE_OFFSET(V, (y/2)*UV_stride); \
+		\
+		uint8_t *rgb_ptr1=RGB+y*RGB_stride, \
+			*rgb_ptr2=RGB+y2*RGB_stride; \
+		\
+		for(x=0; (x+1)<width; x+=2) \
+		{ \
+			YUV2RGB16_STD(u_ptr[0], v_ptr[0], 1, YUV420P10, BITS, SAVE) \
+			\
+			rgb_ptr1 += 2*BPP; \
+			rgb_ptr2 += 2*BPP; \
+			y_ptr1 += 2; \
+			y_ptr2 += 2; \
+			u_ptr += 1; \
+			v_ptr += 1; \
+		} \
+		if(x<width) \
+		{ \
+			YUV2RGB16_STD(u_ptr[0], v_ptr[0], 0, YUV420P10, BITS, SAVE) \
+		} \
+	} \
+}
+
+#define P010_STD_FUNCTION(FORMAT, BPP, BITS, SAVE) \
+void p010_##FORMAT##_std( \
+	uint32_t width, uint32_t height, \
+	const uint16_t *Y, const uint16_t *UV, uint32_t Y_stride, uint32_t UV_stride, \
+	uint8_t *RGB, uint32_t RGB_stride, \
+	YCbCrType yuv_type) \
+{ \
+	KERNEL_PARAM(YUV2RGB16Param, YUV2RGB16_##BITS) \
+	uint32_t x, y; \
+	for(y=0; y<height; y+=2) \
+	{ \
+		const uint32_t y2 = (y+1)<height ? y+1 : y; \
+		const uint16_t *y_ptr1=BYTE_OFFSET(Y, y*Y_stride), \
+			*y_ptr2=BYTE_OFFSET(Y, y2*Y_stride), \
+			*uv_ptr=BYTE_OFFSET(UV, (y/2)*UV_stride); \
+		\
+		uint8_t *rgb_ptr1=RGB+y*RGB_stride, \
+			*rgb_ptr2=RGB+y2*RGB_stride; \
+		\
+		for(x=0; (x+1)<width; x+=2) \
+		{ \
+			YUV2RGB16_STD(uv_ptr[0], uv_ptr[1], 1, P010, BITS, SAVE) \
+			\
+			rgb_ptr1 += 2*BPP; \
+			rgb_ptr2 += 2*BPP; \
+			y_ptr1 += 2; \
+			y_ptr2 += 2; \
+			uv_ptr += 2; \
+		} \
+		if(x<width) \
+		{ \
+			YUV2RGB16_STD(uv_ptr[0], uv_ptr[1], 0, P010, BITS, SAVE) \
+		} \
+	} \
+}
+
+#define YUV2RGB16_STD_FUNCTIONS(FORMAT, BPP, BITS, SAVE) \
+	YUV420P10_STD_FUNCTION(FORMAT, BPP, BITS, SAVE) \
+	P010_STD_FUNCTION(FORMAT, BPP, BITS, SAVE)
+
+YUV2RGB16_STD_FUNCTIONS(rgb24, 3, 8, SAVE_RGB24_STD)
+YUV2RGB16_STD_FUNCTIONS(rgb48, 6, 16, SAVE_RGB48_STD)
+YUV2RGB16_STD_FUNCTIONS(x2rgb10, 4, 10, SAVE_X2RGB10_STD)
+
+// 4:2:2 and 4:4:4 formats
+// These formats have chroma samples on each line, shared by pairs of pixels (4:2:2) or one for each pixel (4:4:4), and
+// are converted line by line, the samples being accessed with the format descriptions of yuv_rgb_internal.h. For odd
+// widths, the last pixel of the 4:2:2 formats is processed as a pair of identical pixels (DX=0), as for yuv420. The
+// rgb pixels of the line are saved at rgb_ptr, by the save macros with an empty LINE.
+
+// compute rgb for the pixels 0 and DX of a line, which share the same u and v values
+#define YUV2RGB_422_STD(NAME, DX, SAVE) \
+	UV2RGB_STD(U_##NAME, V_##NAME) \
+	\
+	int16_t y_tmp; \
+	YUV2RGB_PIXEL_STD(Y_##NAME(0), , 0, SAVE) \
+	YUV2RGB_PIXEL_STD(Y_##NAME(DX), , DX, SAVE)
+
+// YUV422_RGB_STD_FUNCTION(NAME, FORMAT, BPP, SAVE) defines the standard implementation of the 4:2:2 format NAME to FORMAT
+#define YUV422_RGB_STD_FUNCTION(NAME, FORMAT, BPP, SAVE) \
+void NAME##_##FORMAT##_std( \
+	uint32_t width, uint32_t height, \
+	YUV_PARAM_##NAME(const uint8_t), \
+	uint8_t *RGB, uint32_t RGB_stride, \
+	YCbCrType yuv_type) \
+{ \
+	const YUV2RGBTable *const table = &(YUV2RGB_TABLE[yuv_type]); \
+	uint32_t x, y; \
+	for(y=0; y<height; ++y) \
+	{ \
+		YUV_LINE_##NAME(const uint8_t) \
+		uint8_t *rgb_ptr=RGB+y*RGB_stride; \
+		\
+		for(x=0; (x+1)<width; x+=2) \
+		{ \
+			YUV2RGB_422_STD(NAME, 1, SAVE) \
+			\
+			YUV_ADVANCE_##NAME(2) \
+			rgb_ptr += 2*BPP; \
+		} \
+		if(x<width) \
+		{ \
+			YUV2RGB_422_STD(NAME, 0, SAVE) \
+		} \
+	} \
+}
+
+// YUV444_RGB_STD_FUNCTION(NAME, FORMAT, BPP, SAVE) defines the standard implementation of the 4:4:4 format NAME to FORMAT
+#define YUV444_RGB_STD_FUNCTION(NAME, FORMAT, BPP, SAVE) \
+void NAME##_##FORMAT##_std( \
+	uint32_t width, uint32_t height, \
+	YUV_PARAM_##NAME(const uint8_t), \
+	uint8_t *RGB, uint32_t RGB_stride, \
+	YCbCrType yuv_type) \
+{ \
+	const YUV2RGBTable *const table = &(YUV2RGB_TABLE[yuv_type]); \
+	uint32_t x, y; \
+	for(y=0; y<height; ++y) \
+	{ \
+		YUV_LINE_##NAME(const uint8_t) \
+		uint8_t *rgb_ptr=RGB+y*RGB_stride; \
+		\
+		for(x=0; x<width; ++x) \
+		{ \
+			UV2RGB_STD(U_##NAME, V_##NAME) \
+			\
+			int16_t y_tmp; \
+			YUV2RGB_PIXEL_STD(Y_##NAME(0), , 0, SAVE) \
+			\
+			YUV_ADVANCE_##NAME(1) \
+			rgb_ptr += BPP; \
+		} \
+	} \
+}
+
+// compute y for the pixel DX of a line, and add its (B-Y') and (R-Y') to u_tmp and v_tmp
+#define RGB2YUV_PIXEL_STD(NAME, BPP, DX) \
+	y_tmp = (param->r_factor*rgb_ptr[BPP*(DX)] + param->g_factor*rgb_ptr[BPP*(DX)+1] + param->b_factor*rgb_ptr[BPP*(DX)+2])>>8; \
+	u_tmp += rgb_ptr[BPP*(DX)+2]-y_tmp; \
+	v_tmp += rgb_ptr[BPP*(DX)]-y_tmp; \
+	Y_##NAME(DX)=((y_tmp*param->y_factor)>>7) + param->y_offset;
+
+// compute yuv for the pixels 0 and DX of a line, u and v values are summed
+#define RGB2YUV_422_STD(NAME, BPP, DX) \
+	uint8_t y_tmp; \
+	int16_t u_tmp = 0, v_tmp = 0; \
+	RGB2YUV_PIXEL_STD(NAME, BPP, 0) \
+	RGB2YUV_PIXEL_STD(NAME, BPP, DX) \
+	U_##NAME = (((u_tmp>>1)*param->cb_factor)>>8) + 128; \
+	V_##NAME = (((v_tmp>>1)*param->cr_factor)>>8) + 128;
+
+// RGB_YUV422_STD_FUNCTION(FORMAT, BPP, NAME) defines the standard implementation of FORMAT to the 4:2:2 format NAME
+#define RGB_YUV422_STD_FUNCTION(FORMAT, BPP, NAME) \
+void FORMAT##_##NAME##_std( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *RGB, uint32_t RGB_stride, \
+	YUV_PARAM_##NAME(uint8_t), \
+	YCbCrType yuv_type) \
+{ \
+	KERNEL_PARAM(RGB2YUVParam, RGB2YUV) \
+	uint32_t x, y; \
+	for(y=0; y<height; ++y) \
+	{ \
+		const uint8_t *rgb_ptr=RGB+y*RGB_stride; \
+		YUV_LINE_##NAME(uint8_t) \
+		\
+		for(x=0; (x+1)<width; x+=2) \
+		{ \
+			RGB2YUV_422_STD(NAME, BPP, 1) \
+			\
+			rgb_ptr += 2*BPP; \
+			YUV_ADVANCE_##NAME(2) \
+		} \
+		if(x<width) \
+		{ \
+			RGB2YUV_422_STD(NAME, BPP, 0) \
+			YUV_PAD_##NAME \
+		} \
+	} \
+}
+
+// RGB_YUV444_STD_FUNCTION(FORMAT, BPP, NAME) defines the standard implementation of FORMAT to the 4:4:4 format NAME
+#define RGB_YUV444_STD_FUNCTION(FORMAT, BPP, NAME) \
+void FORMAT##_##NAME##_std( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *RGB, uint32_t RGB_stride, \
+	YUV_PARAM_##NAME(uint8_t), \
+	YCbCrType yuv_type) \
+{ \
+	KERNEL_PARAM(RGB2YUVParam, RGB2YUV) \
+	uint32_t x, y; \
+	for(y=0; y<height; ++y) \
+	{ \
+		const uint8_t *rgb_ptr=RGB+y*RGB_stride; \
+		YUV_LINE_##NAME(uint8_t) \
+		\
+		for(x=0; x<width; ++x) \
+		{ \
+			uint8_t y_tmp; \
+			int16_t u_tmp = 0, v_tmp = 0; \
+			RGB2YUV_PIXEL_STD(NAME, BPP, 0) \
+			U_##NAME = ((u_tmp*param->cb_factor)>>8) + 128; \
+			V_##NAME = ((v_tmp*param->cr_factor)>>8) + 128; \
+			\
+			rgb_ptr += BPP; \
+			YUV_ADVANCE_##NAME(1) \
+		} \
+	} \
+}
+
+// define the standard implementations of the 4:2:2 and 4:4:4 formats to and from FORMAT
+#define YUV_LINES_STD_FUNCTIONS(FORMAT, BPP, SAVE) \
+	YUV422_RGB_STD_FUNCTION(yuv422p, FORMAT, BPP, SAVE) \
+	YUV422_RGB_STD_FUNCTION(nv16, FORMAT, BPP, SAVE) \
+	YUV422_RGB_STD_FUNCTION(yuyv, FORMAT, BPP, SAVE) \
+	YUV422_RGB_STD_FUNCTION(uyvy, FORMAT, BPP, SAVE) \
+	YUV444_RGB_STD_FUNCTION(yuv444p, FORMAT, BPP, SAVE) \
+	YUV444_RGB_STD_FUNCTION(nv24, FORMAT, BPP, SAVE) \
+	RGB_YUV422_STD_FUNCTION(FORMAT, BPP, yuv422p) \
+	RGB_YUV422_STD_FUNCTION(FORMAT, BPP, nv16) \
+	RGB_YUV422_STD_FUNCTION(FORMAT, BPP, yuyv) \
+	RGB_YUV422_STD_FUNCTION(FORMAT, BPP, uyvy) \
+	RGB_YUV444_STD_FUNCTION(FORMAT, BPP, yuv444p) \
+	RGB_YUV444_STD_FUNCTION(FORMAT, BPP, nv24)
+
+YUV_LINES_STD_FUNCTIONS(rgb24, 3, SAVE_RGB24_STD)
+YUV_LINES_STD_FUNCTIONS(rgb32, 4, SAVE_RGB32_STD)
+
+// Bilinear chroma interpolation
+// The chroma samples are located at the center of each 2x2 block of pixels (JPEG siting), so that each pixel gets
+// 9/16 of the nearest sample, 3/16 of the next ones horizontally and vertically, and 1/16 of the diagonal one (3:1
+// interpolation in each direction, like the "fancy upsampling" of libjpeg). Samples outside the image are replaced
+// by the nearest ones.
+// The interpolated values are rounded to 8 bits, and the simd implementations give exactly the same results. Unlike the
+// other standard implementations, y values below YMin are clamped to YMin, as in the simd implementations.
+void yuv420_rgb24_bilinear_line_std(uint32_t width, uint32_t x_begin, uint32_t x_end, const uint8_t *y_ptr,
+	const uint8_t *u_c, const uint8_t *u_o, const uint8_t *v_c, const uint8_t *v_o, uint32_t uv_step,
+	uint8_t *rgb_ptr, const YUV2RGBParam *param)
+{
+	const uint32_t last = (width-1)/2;
+	uint32_t x;
+	for(x=x_begin; x<x_end; ++x)
 	{
-		const uint8_t *rgb_ptr1=RGBA+y*RGBA_stride,
-			*rgb_ptr2=RGBA+(y+1)*RGBA_stride;
+		// nearest sample, and next sample horizontally
+		const uint32_t i = (x/2)*uv_step,
+			j = ((x%2) ? ((x/2)<last ? x/2+1 : x/2) : (x>=2 ? x/2-1 : 0))*uv_step;
 		
-		uint8_t *y_ptr1=Y+y*Y_stride,
-			*y_ptr2=Y+(y+1)*Y_stride,
-			*u_ptr=U+(y/2)*UV_stride,
-			*v_ptr=V+(y/2)*UV_stride;
+		const int u_tmp = ((3*(3*u_c[i]+u_o[i]) + 3*u_c[j]+u_o[j] + 8)>>4) - 128,
+			v_tmp = ((3*(3*v_c[i]+v_o[i]) + 3*v_c[j]+v_o[j] + 8)>>4) - 128;
 		
-		for(x=0; x<(width-1); x+=2)
-		{
-			// compute yuv for the four pixels, u and v values are summed
-			uint8_t y_tmp;
-			int16_t u_tmp, v_tmp;
-			
-			y_tmp = (param->r_factor*rgb_ptr1[0] + param->g_factor*rgb_ptr1[1] + param->b_factor*rgb_ptr1[2])>>8;
-			u_tmp = rgb_ptr1[2]-y_tmp;
-			v_tmp = rgb_ptr1[0]-y_tmp;
-			y_ptr1[0]=((y_tmp*param->y_factor)>>7) + param->y_offset;
-			
-			y_tmp = (param->r_factor*rgb_ptr1[4] + param->g_factor*rgb_ptr1[5] + param->b_factor*rgb_ptr1[6])>>8;
-			u_tmp += rgb_ptr1[6]-y_tmp;
-			v_tmp += rgb_ptr1[4]-y_tmp;
-			y_ptr1[1]=((y_tmp*param->y_factor)>>7) + param->y_offset;
-
-			y_tmp = (param->r_factor*rgb_ptr2[0] + param->g_factor*rgb_ptr2[1] + param->b_factor*rgb_ptr2[2])>>8;
-			u_tmp += rgb_ptr2[2]-y_tmp;
-			v_tmp += rgb_ptr2[0]-y_tmp;
-			y_ptr2[0]=((y_tmp*param->y_factor)>>7) + param->y_offset;
-			
-			y_tmp = (param->r_factor*rgb_ptr2[4] + param->g_factor*rgb_ptr2[5] + param->b_factor*rgb_ptr2[6])>>8;
-			u_tmp += rgb_ptr2[6]-y_tmp;
-			v_tmp += rgb_ptr2[4]-y_tmp;
-			y_ptr2[1]=((y_tmp*param->y_factor)>>7) + param->y_offset;
-
-			u_ptr[0] = (((u_tmp>>2)*param->cb_factor)>>8) + 128;
-			v_ptr[0] = (((v_tmp>>2)*param->cb_factor)>>8) + 128;
-			
-			rgb_ptr1 += 8;
-			rgb_ptr2 += 8;
-			y_ptr1 += 2;
-			y_ptr2 += 2;
-			u_ptr += 1;
-			v_ptr += 1;
-		}
+		const int16_t y_tmp = (param->y_factor*(y_ptr[x]>param->y_offset ? y_ptr[x]-param->y_offset : 0))>>7;
+		rgb_ptr[3*x] = clamp(y_tmp + ((param->cr_factor*v_tmp)>>6));
+		rgb_ptr[3*x+1] = clamp(y_tmp - ((param->g_cb_factor*u_tmp + param->g_cr_factor*v_tmp)>>7));
+		rgb_ptr[3*x+2] = clamp(y_tmp + ((param->cb_factor*u_tmp)>>6));
 	}
 }
 
+// convert the whole image line by line, U_SRC, V_SRC and UV_STEP being as in yuv420_rgb24_bilinear_line_std
+#define YUV420_RGB_BILINEAR_STD(U_SRC, V_SRC, UV_STEP) \
+	KERNEL_PARAM(YUV2RGBParam, YUV2RGB) \
+	uint32_t y; \
+	for(y=0; y<height; y+=2) \
+	{ \
+		BILINEAR_CHROMA_LINES(U_SRC, u, UV_stride) \
+		BILINEAR_CHROMA_LINES(V_SRC, v, UV_stride) \
+		yuv420_rgb24_bilinear_line_std(width, 0, width, Y+y*Y_stride, u_c, u_p, v_c, v_p, UV_STEP, RGB+y*RGB_stride, param); \
+		if((y+1)<height) \
+			yuv420_rgb24_bilinear_line_std(width, 0, width, Y+(y+1)*Y_stride, u_c, u_n, v_c, v_n, UV_STEP, \
+				RGB+(y+1)*RGB_stride, param); \
+	}
 
-void yuv420_rgb24_std(
+void yuv420_rgb24_bilinear_std(
 	uint32_t width, uint32_t height, 
 	const uint8_t *Y, const uint8_t *U, const uint8_t *V, uint32_t Y_stride, uint32_t UV_stride, 
 	uint8_t *RGB, uint32_t RGB_stride, 
 	YCbCrType yuv_type)
 {
-	const YUV2RGBParam *const param = &(YUV2RGB[yuv_type]);
-	uint32_t x, y;
-	for(y=0; y<(height-1); y+=2)
-	{
-		const uint8_t *y_ptr1=Y+y*Y_stride,
-			*y_ptr2=Y+(y+1)*Y_stride,
-			*u_ptr=U+(y/2)*UV_stride,
-			*v_ptr=V+(y/2)*UV_stride;
-		
-		uint8_t *rgb_ptr1=RGB+y*RGB_stride,
-			*rgb_ptr2=RGB+(y+1)*RGB_stride;
-		
-		for(x=0; x<(width-1); x+=2)
-		{
-			int8_t u_tmp, v_tmp;
-			u_tmp = u_ptr[0]-128;
-			v_tmp = v_ptr[0]-128;
-			
-			//compute Cb Cr color offsets, common to four pixels
-			int16_t b_cb_offset, r_cr_offset, g_cbcr_offset;
-			b_cb_offset = (param->cb_factor*u_tmp)>>6;
-			r_cr_offset = (param->cr_factor*v_tmp)>>6;
-			g_cbcr_offset = (param->g_cb_factor*u_tmp + param->g_cr_factor*v_tmp)>>7;
-			
-			int16_t y_tmp;
-			y_tmp = (param->y_factor*(y_ptr1[0]-param->y_offset))>>7;
-			rgb_ptr1[0] = clamp(y_tmp + r_cr_offset);
-			rgb_ptr1[1] = clamp(y_tmp - g_cbcr_offset);
-			rgb_ptr1[2] = clamp(y_tmp + b_cb_offset);
-			
-			y_tmp = (param->y_factor*(y_ptr1[1]-param->y_offset))>>7;
-			rgb_ptr1[3] = clamp(y_tmp + r_cr_offset);
-			rgb_ptr1[4] = clamp(y_tmp - g_cbcr_offset);
-			rgb_ptr1[5] = clamp(y_tmp + b_cb_offset);
-			
-			y_tmp = (param->y_factor*(y_ptr2[0]-param->y_offset))>>7;
-			rgb_ptr2[0] = clamp(y_tmp + r_cr_offset);
-			rgb_ptr2[1] = clamp(y_tmp - g_cbcr_offset);
-			rgb_ptr2[2] = clamp(y_tmp + b_cb_offset);
-			
-			y_tmp = (param->y_factor*(y_ptr2[1]-param->y_offset))>>7;
-			rgb_ptr2[3] = clamp(y_tmp + r_cr_offset);
-			rgb_ptr2[4] = clamp(y_tmp - g_cbcr_offset);
-			rgb_ptr2[5] = clamp(y_tmp + b_cb_offset);
-			
-			rgb_ptr1 += 6;
-			rgb_ptr2 += 6;
-			y_ptr1 += 2;
-			y_ptr2 += 2;
-			u_ptr += 1;
-			v_ptr += 1;
-		}
-	}
+	YUV420_RGB_BILINEAR_STD(U, V, 1)
 }
 
-void nv12_rgb24_std(
+void nv12_rgb24_bilinear_std(
 	uint32_t width, uint32_t height, 
 	const uint8_t *Y, const uint8_t *UV, uint32_t Y_stride, uint32_t UV_stride, 
 	uint8_t *RGB, uint32_t RGB_stride, 
 	YCbCrType yuv_type)
 {
-	const YUV2RGBParam *const param = &(YUV2RGB[yuv_type]);
-	uint32_t x, y;
-	for(y=0; y<(height-1); y+=2)
-	{
-		const uint8_t *y_ptr1=Y+y*Y_stride,
-			*y_ptr2=Y+(y+1)*Y_stride,
-			*uv_ptr=UV+(y/2)*UV_stride;
-		
-		uint8_t *rgb_ptr1=RGB+y*RGB_stride,
-			*rgb_ptr2=RGB+(y+1)*RGB_stride;
-		
-		for(x=0; x<(width-1); x+=2)
-		{
-			int8_t u_tmp, v_tmp;
-			u_tmp = uv_ptr[0]-128;
-			v_tmp = uv_ptr[1]-128;
-			
-			//compute Cb Cr color offsets, common to four pixels
-			int16_t b_cb_offset, r_cr_offset, g_cbcr_offset;
-			b_cb_offset = (param->cb_factor*u_tmp)>>6;
-			r_cr_offset = (param->cr_factor*v_tmp)>>6;
-			g_cbcr_offset = (param->g_cb_factor*u_tmp + param->g_cr_factor*v_tmp)>>7;
-			
-			int16_t y_tmp;
-			y_tmp = (param->y_factor*(y_ptr1[0]-param->y_offset))>>7;
-			rgb_ptr1[0] = clamp(y_tmp + r_cr_offset);
-			rgb_ptr1[1] = clamp(y_tmp - g_cbcr_offset);
-			rgb_ptr1[2] = clamp(y_tmp + b_cb_offset);
-			
-			y_tmp = (param->y_factor*(y_ptr1[1]-param->y_offset))>>7;
-			rgb_ptr1[3] = clamp(y_tmp + r_cr_offset);
-			rgb_ptr1[4] = clamp(y_tmp - g_cbcr_offset);
-			rgb_ptr1[5] = clamp(y_tmp + b_cb_offset);
-			
-			y_tmp = (param->y_factor*(y_ptr2[0]-param->y_offset))>>7;
-			rgb_ptr2[0] = clamp(y_tmp + r_cr_offset);
-			rgb_ptr2[1] = clamp(y_tmp - g_cbcr_offset);
-			rgb_ptr2[2] = clamp(y_tmp + b_cb_offset);
-			
-			y_tmp = (param->y_factor*(y_ptr2[1]-param->y_offset))>>7;
-			rgb_ptr2[3] = clamp(y_tmp + r_cr_offset);
-			rgb_ptr2[4] = clamp(y_tmp - g_cbcr_offset);
-			rgb_ptr2[5] = clamp(y_tmp + b_cb_offset);
-			
-			rgb_ptr1 += 6;
-			rgb_ptr2 += 6;
-			y_ptr1 += 2;
-			y_ptr2 += 2;
-			uv_ptr += 2;
-		}
-	}
+	YUV420_RGB_BILINEAR_STD(UV, UV+1, 2)
 }
 
-void nv21_rgb24_std(
+void nv21_rgb24_bilinear_std(
 	uint32_t width, uint32_t height, 
 	const uint8_t *Y, const uint8_t *UV, uint32_t Y_stride, uint32_t UV_stride, 
 	uint8_t *RGB, uint32_t RGB_stride, 
 	YCbCrType yuv_type)
 {
-	const YUV2RGBParam *const param = &(YUV2RGB[yuv_type]);
-	uint32_t x, y;
-	for(y=0; y<(height-1); y+=2)
+	YUV420_RGB_BILINEAR_STD(UV+1, UV, 2)
+}
+
+
+// Direct yuv format conversions
+// The samples are only copied between the yuv420 formats (yuv420, nv12 and nv21), so that changing the chroma layout
+// is lossless. The packed 4:2:2 formats (yuyv and uyvy) are converted to yuv420 formats by averaging (rounded up) the
+// chroma values of the two lines of each pair, and the yuv420 formats to packed formats by using the same chroma
+// values for both lines. The simd implementations give exactly the same results.
+void yuv_copy_plane(uint32_t width, uint32_t height, const uint8_t *src, uint32_t src_stride,
+	uint8_t *dst, uint32_t dst_stride)
+{
+	uint32_t y;
+	if(dst==src)
+		return;
+	
+	if(src_stride==width && dst_stride==width)
+		memcpy(dst, src, (size_t)width*height);
+	else
+		for(y=0; y<height; ++y)
+			memcpy(dst+(size_t)y*dst_stride, src+(size_t)y*src_stride, width);
+}
+
+void yuv_chroma_line_std(uint32_t x_begin, uint32_t x_end, const uint8_t *u_src, const uint8_t *v_src, uint32_t src_step,
+	uint8_t *u_dst, uint8_t *v_dst, uint32_t dst_step)
+{
+	uint32_t x;
+	for(x=x_begin; x<x_end; ++x)
 	{
-		const uint8_t *y_ptr1=Y+y*Y_stride,
-			*y_ptr2=Y+(y+1)*Y_stride,
-			*uv_ptr=UV+(y/2)*UV_stride;
-		
-		uint8_t *rgb_ptr1=RGB+y*RGB_stride,
-			*rgb_ptr2=RGB+(y+1)*RGB_stride;
-		
-		for(x=0; x<(width-1); x+=2)
+		u_dst[x*dst_step] = u_src[x*src_step];
+		v_dst[x*dst_step] = v_src[x*src_step];
+	}
+}
+
+void yuv_unpack_lines_std(uint32_t width, uint32_t x_begin, const uint8_t *src1, const uint8_t *src2, uint32_t y_index,
+	uint8_t *y_dst1, uint8_t *y_dst2, uint8_t *u_dst, uint8_t *v_dst, uint32_t dst_step)
+{
+	const uint32_t c_index = 1-y_index;
+	uint32_t x;
+	for(x=x_begin; x<width; x+=2)
+	{
+		const uint8_t *const p1 = src1+2*x, *const p2 = src2+2*x;
+		y_dst1[x] = p1[y_index];
+		y_dst2[x] = p2[y_index];
+		if((x+1)<width)
 		{
-			int8_t u_tmp, v_tmp;
-			u_tmp = uv_ptr[1]-128;
-			v_tmp = uv_ptr[0]-128;
-			
-			//compute Cb Cr color offsets, common to four pixels
-			int16_t b_cb_offset, r_cr_offset, g_cbcr_offset;
-			b_cb_offset = (param->cb_factor*u_tmp)>>6;
-			r_cr_offset = (param->cr_factor*v_tmp)>>6;
-			g_cbcr_offset = (param->g_cb_factor*u_tmp + param->g_cr_factor*v_tmp)>>7;
-			
-			int16_t y_tmp;
-			y_tmp = (param->y_factor*(y_ptr1[0]-param->y_offset))>>7;
-			rgb_ptr1[0] = clamp(y_tmp + r_cr_offset);
-			rgb_ptr1[1] = clamp(y_tmp - g_cbcr_offset);
-			rgb_ptr1[2] = clamp(y_tmp + b_cb_offset);
-			
-			y_tmp = (param->y_factor*(y_ptr1[1]-param->y_offset))>>7;
-			rgb_ptr1[3] = clamp(y_tmp + r_cr_offset);
-			rgb_ptr1[4] = clamp(y_tmp - g_cbcr_offset);
-			rgb_ptr1[5] = clamp(y_tmp + b_cb_offset);
-			
-			y_tmp = (param->y_factor*(y_ptr2[0]-param->y_offset))>>7;
-			rgb_ptr2[0] = clamp(y_tmp + r_cr_offset);
-			rgb_ptr2[1] = clamp(y_tmp - g_cbcr_offset);
-			rgb_ptr2[2] = clamp(y_tmp + b_cb_offset);
-			
-			y_tmp = (param->y_factor*(y_ptr2[1]-param->y_offset))>>7;
-			rgb_ptr2[3] = clamp(y_tmp + r_cr_offset);
-			rgb_ptr2[4] = clamp(y_tmp - g_cbcr_offset);
-			rgb_ptr2[5] = clamp(y_tmp + b_cb_offset);
-			
-			rgb_ptr1 += 6;
-			rgb_ptr2 += 6;
-			y_ptr1 += 2;
-			y_ptr2 += 2;
-			uv_ptr += 2;
+			y_dst1[x+1] = p1[y_index+2];
+			y_dst2[x+1] = p2[y_index+2];
 		}
+		
+		u_dst[(x/2)*dst_step] = (p1[c_index]+p2[c_index]+1)>>1;
+		v_dst[(x/2)*dst_step] = (p1[c_index+2]+p2[c_index+2]+1)>>1;
+	}
+}
+
+void yuv_pack_line_std(uint32_t width, uint32_t x_begin, const uint8_t *y_src, const uint8_t *u_src,
+	const uint8_t *v_src, uint32_t src_step, uint8_t *dst, uint32_t y_index)
+{
+	const uint32_t c_index = 1-y_index;
+	uint32_t x;
+	for(x=x_begin; x<width; x+=2)
+	{
+		uint8_t *const p = dst+2*x;
+		p[y_index] = y_src[x];
+		p[y_index+2] = (x+1)<width ? y_src[x+1] : y_src[x];
+		p[c_index] = u_src[(x/2)*src_step];
+		p[c_index+2] = v_src[(x/2)*src_step];
 	}
 }
 
+// YUV420_CHROMA_STD_FUNCTION(SRC, DST) defines the standard implementation of the yuv420 format SRC to the yuv420
+// format DST
+#define YUV420_CHROMA_STD_FUNCTION(SRC, DST) \
+void SRC##_##DST##_std( \
+	uint32_t width, uint32_t height, \
+	SRC_PARAM_##SRC, \
+	DST_PARAM_##DST) \
+{ \
+	uint32_t y; \
+	yuv_copy_plane(width, height, Y, Y_stride, Y_dst, Y_dst_stride); \
+	for(y=0; y<(height+1)/2; ++y) \
+	{ \
+		SRC_CHROMA_##SRC(y) \
+		DST_CHROMA_##DST(y) \
+		yuv_chroma_line_std(0, (width+1)/2, u_src, v_src, src_step, u_dst, v_dst, dst_step); \
+	} \
+}
+
+// PACKED_YUV420_STD_FUNCTION(SRC, DST) defines the standard implementation of the packed format SRC to the yuv420
+// format DST
+#define PACKED_YUV420_STD_FUNCTION(SRC, DST) \
+void SRC##_##DST##_std( \
+	uint32_t width, uint32_t height, \
+	SRC_PARAM_##SRC, \
+	DST_PARAM_##DST) \
+{ \
+	uint32_t y; \
+	for(y=0; y<height; y+=2) \
+	{ \
+		const uint32_t y2 = (y+1)<height ? y+1 : y; \
+		DST_CHROMA_##DST(y/2) \
+		yuv_unpack_lines_std(width, 0, YUV+y*YUV_stride, YUV+y2*YUV_stride, Y_INDEX_##SRC, \
+			Y_dst+y*Y_dst_stride, Y_dst+y2*Y_dst_stride, u_dst, v_dst, dst_step); \
+	} \
+}
+
+// YUV420_PACKED_STD_FUNCTION(SRC, DST) defines the standard implementation of the yuv420 format SRC to the packed
+// format DST
+#define YUV420_PACKED_STD_FUNCTION(SRC, DST) \
+void SRC##_##DST##_std( \
+	uint32_t width, uint32_t height, \
+	SRC_PARAM_##SRC, \
+	DST_PARAM_##DST) \
+{ \
+	uint32_t y; \
+	for(y=0; y<height; ++y) \
+	{ \
+		SRC_CHROMA_##SRC(y/2) \
+		yuv_pack_line_std(width, 0, Y+y*Y_stride, u_src, v_src, src_step, YUV_dst+y*YUV_dst_stride, Y_INDEX_##DST); \
+	} \
+}
+
+YUV420_CHROMA_STD_FUNCTION(nv12, yuv420)
+YUV420_CHROMA_STD_FUNCTION(nv21, yuv420)
+YUV420_CHROMA_STD_FUNCTION(yuv420, nv12)
+YUV420_CHROMA_STD_FUNCTION(yuv420, nv21)
+PACKED_YUV420_STD_FUNCTION(yuyv, yuv420)
+PACKED_YUV420_STD_FUNCTION(uyvy, yuv420)
+PACKED_YUV420_STD_FUNCTION(yuyv, nv12)
+PACKED_YUV420_STD_FUNCTION(uyvy, nv12)
+YUV420_PACKED_STD_FUNCTION(yuv420, yuyv)
+YUV420_PACKED_STD_FUNCTION(yuv420, uyvy)
+YUV420_PACKED_STD_FUNCTION(nv12, yuyv)
+YUV420_PACKED_STD_FUNCTION(nv12, uyvy)
 
 #ifdef _YUVRGB_SSE2_
 
@@ -613,77 +1645,53 @@ Y = _mm_add_epi16(_mm_srli_epi16(_mm_mullo_epi16(Y, _mm_set1_epi16(param->y_fact
 	SAVE_SI128((__m128i*)(v_ptr), cr);
 
 
-void rgb24_yuv420_sse(uint32_t width, uint32_t height, 
-	const uint8_t *RGB, uint32_t RGB_stride, 
-	uint8_t *Y, uint8_t *U, uint8_t *V, uint32_t Y_stride, uint32_t UV_stride, 
-	YCbCrType yuv_type)
-{
-	#define LOAD_SI128 _mm_load_si128
-	#define SAVE_SI128 _mm_stream_si128
-	const RGB2YUVParam *const param = &(RGB2YUV[yuv_type]);
-	
-	uint32_t x, y;
-	for(y=0; y<(height-1); y+=2)
-	{
-		const uint8_t *rgb_ptr1=RGB+y*RGB_stride,
-			*rgb_ptr2=RGB+(y+1)*RGB_stride;
-		
-		uint8_t *y_ptr1=Y+y*Y_stride,
-			*y_ptr2=Y+(y+1)*Y_stride,
-			*u_ptr=U+(y/2)*UV_stride,
-			*v_ptr=V+(y/2)*UV_stride;
-		
-		for(x=0; x<(width-31); x+=32)
-		{
-			RGB2YUV_32
-			
-			rgb_ptr1+=96;
-			rgb_ptr2+=96;
-			y_ptr1+=32;
-			y_ptr2+=32;
-			u_ptr+=16; 
-			v_ptr+=16;
-		}
-	}
-	#undef LOAD_SI128
-	#undef SAVE_SI128
+// RGB_YUV420_SSE_FUNCTION(FORMAT, BPP, CONVERT, SUFFIX) defines FORMAT_yuv420_<SUFFIX>, which converts 32 pixels of
+// BPP bytes of two lines with CONVERT, using the LOAD_SI128 and SAVE_SI128 macros defined where it is used
+#define RGB_YUV420_SSE_FUNCTION(FORMAT, BPP, CONVERT, SUFFIX) \
+void FORMAT##_yuv420_##SUFFIX(uint32_t width, uint32_t height, \
+	const uint8_t *RGB, uint32_t RGB_stride, \
+	uint8_t *Y, uint8_t *U, uint8_t *V, uint32_t Y_stride, uint32_t UV_stride, \
+	YCbCrType yuv_type) \
+{ \
+	KERNEL_PARAM(RGB2YUVParam, RGB2YUV) \
+	\
+	uint32_t x, y; \
+	for(y=0; (y+1)<height; y+=2) \
+	{ \
+		const uint8_t *rgb_ptr1=RGB+y*RGB_stride, \
+			*rgb_ptr2=RGB+(y+1)*RGB_stride; \
+		\
+		uint8_t *y_ptr1=Y+y*Y_stride, \
+			*y_ptr2=Y+(y+1)*Y_stride, \
+			*u_ptr=U+(y/2)*UV_stride, \
+			*v_ptr=V+(y/2)*UV_stride; \
+		\
+		for(x=0; (x+31)<width; x+=32) \
+		{ \
+			CONVERT \
+			\
+			rgb_ptr1+=32*BPP; \
+			rgb_ptr2+=32*BPP; \
+			y_ptr1+=32; \
+			y_ptr2+=32; \
+			u_ptr+=16; \
+			v_ptr+=16; \
+		} \
+	} \
+	RGB_YUV420_TAIL(32, BPP, RGB, RGB_stride, FORMAT##_yuv420_sseu, FORMAT##_yuv420_std) \
 }
 
-void rgb24_yuv420_sseu(uint32_t width, uint32_t height, 
-	const uint8_t *RGB, uint32_t RGB_stride, 
-	uint8_t *Y, uint8_t *U, uint8_t *V, uint32_t Y_stride, uint32_t UV_stride, 
-	YCbCrType yuv_type)
-{
-	#define LOAD_SI128 _mm_loadu_si128
-	#define SAVE_SI128 _mm_storeu_si128
-	const RGB2YUVParam *const param = &(RGB2YUV[yuv_type]);
-	
-	uint32_t x, y;
-	for(y=0; y<(height-1); y+=2)
-	{
-		const uint8_t *rgb_ptr1=RGB+y*RGB_stride,
-			*rgb_ptr2=RGB+(y+1)*RGB_stride;
-		
-		uint8_t *y_ptr1=Y+y*Y_stride,
-			*y_ptr2=Y+(y+1)*Y_stride,
-			*u_ptr=U+(y/2)*UV_stride,
-			*v_ptr=V+(y/2)*UV_stride;
-		
-		for(x=0; x<(width-31); x+=32)
-		{
-			RGB2YUV_32
-			
-			rgb_ptr1+=96;
-			rgb_ptr2+=96;
-			y_ptr1+=32;
-			y_ptr2+=32;
-			u_ptr+=16; 
-			v_ptr+=16;
-		}
-	}
-	#undef LOAD_SI128
-	#undef SAVE_SI128
-}
+#define LOAD_SI128 _mm_load_si128
+#define SAVE_SI128 _mm_stream_si128
+RGB_YUV420_SSE_FUNCTION(rgb24, 3, RGB2YUV_32, sse)
+#undef LOAD_SI128
+#undef SAVE_SI128
+
+#define LOAD_SI128 _mm_loadu_si128
+#define SAVE_SI128 _mm_storeu_si128
+RGB_YUV420_SSE_FUNCTION(rgb24, 3, RGB2YUV_32, sseu)
+#undef LOAD_SI128
+#undef SAVE_SI128
 
 
 // see rgba.txt
@@ -698,7 +1706,9 @@ RD7 = _mm_unpacklo_epi8(RS4, RS8); \
 RD8 = _mm_unpackhi_epi8(RS4, RS8);
 
 
-#define RGBA2YUV_32 \
+// RGBA2YUV_32(ALPHA) converts 32 pixels of a pair of lines, ALPHA(OFFSET) being applied to the unpacked channels of
+// the pixels OFFSET to OFFSET+15 (see RGBA2YUVA_ALPHA_32)
+#define RGBA2YUV_32(ALPHA) \
 	__m128i r_16, g_16, b_16; \
 	__m128i y1_16, y2_16, cb1_16, cb2_16, cr1_16, cr2_16, Y, cb, cr; \
 	__m128i tmp1, tmp2, tmp3, tmp4, tmp5, tmp6, tmp7, tmp8; \
@@ -718,6 +1728,7 @@ RD8 = _mm_unpackhi_epi8(RS4, RS8);
 	UNPACK_RGB32_32_STEP(tmp1, tmp2, tmp3, tmp4, tmp5, tmp6, tmp7, tmp8, rgb1, rgb2, rgb3, rgb4, rgb5, rgb6, rgb7, rgb8) \
 	UNPACK_RGB32_32_STEP(rgb1, rgb2, rgb3, rgb4, rgb5, rgb6, rgb7, rgb8, tmp1, tmp2, tmp3, tmp4, tmp5, tmp6, tmp7, tmp8) \
 	UNPACK_RGB32_32_STEP(tmp1, tmp2, tmp3, tmp4, tmp5, tmp6, tmp7, tmp8, rgb1, rgb2, rgb3, rgb4, rgb5, rgb6, rgb7, rgb8) \
+	ALPHA(0) \
 	/* first compute Y', (B-Y') and (R-Y'), in 16bits values, for the first line */ \
 	/* Y is saved for each pixel, while only sums of (B-Y') and (R-Y') for pairs of adjacents pixels are saved*/ \
 	r_16 = _mm_unpacklo_epi8(rgb1, _mm_setzero_si128()); \
@@ -791,6 +1802,7 @@ RD8 = _mm_unpackhi_epi8(RS4, RS8);
 	UNPACK_RGB32_32_STEP(tmp1, tmp2, tmp3, tmp4, tmp5, tmp6, tmp7, tmp8, rgb1, rgb2, rgb3, rgb4, rgb5, rgb6, rgb7, rgb8) \
 	UNPACK_RGB32_32_STEP(rgb1, rgb2, rgb3, rgb4, rgb5, rgb6, rgb7, rgb8, tmp1, tmp2, tmp3, tmp4, tmp5, tmp6, tmp7, tmp8) \
 	UNPACK_RGB32_32_STEP(tmp1, tmp2, tmp3, tmp4, tmp5, tmp6, tmp7, tmp8, rgb1, rgb2, rgb3, rgb4, rgb5, rgb6, rgb7, rgb8) \
+	ALPHA(16) \
 	/* first compute Y', (B-Y') and (R-Y'), in 16bits values, for the first line */ \
 	/* Y is saved for each pixel, while only sums of (B-Y') and (R-Y') for pairs of adjacents pixels are saved*/ \
 	r_16 = _mm_unpacklo_epi8(rgb1, _mm_setzero_si128()); \
@@ -852,88 +1864,267 @@ RD8 = _mm_unpackhi_epi8(RS4, RS8);
 	SAVE_SI128((__m128i*)(u_ptr), cb); \
 	SAVE_SI128((__m128i*)(v_ptr), cr);
 
-void rgb32_yuv420_sse(uint32_t width, uint32_t height, 
-	const uint8_t *RGBA, uint32_t RGBA_stride, 
-	uint8_t *Y, uint8_t *U, uint8_t *V, uint32_t Y_stride, uint32_t UV_stride, 
-	YCbCrType yuv_type)
-{
-	#define LOAD_SI128 _mm_load_si128
-	#define SAVE_SI128 _mm_stream_si128
-	const RGB2YUVParam *const param = &(RGB2YUV[yuv_type]);
-	
-	uint32_t x, y;
-	for(y=0; y<(height-1); y+=2)
-	{
-		const uint8_t *rgb_ptr1=RGBA+y*RGBA_stride,
-			*rgb_ptr2=RGBA+(y+1)*RGBA_stride;
-		
-		uint8_t *y_ptr1=Y+y*Y_stride,
-			*y_ptr2=Y+(y+1)*Y_stride,
-			*u_ptr=U+(y/2)*UV_stride,
-			*v_ptr=V+(y/2)*UV_stride;
-		
-		for(x=0; x<(width-31); x+=32)
-		{
-			RGBA2YUV_32
-			
-			rgb_ptr1+=128;
-			rgb_ptr2+=128;
-			y_ptr1+=32;
-			y_ptr2+=32;
-			u_ptr+=16; 
-			v_ptr+=16;
-		}
+#define IGNORE_ALPHA_32(OFFSET)
+
+#define LOAD_SI128 _mm_load_si128
+#define SAVE_SI128 _mm_stream_si128
+RGB_YUV420_SSE_FUNCTION(rgb32, 4, RGBA2YUV_32(IGNORE_ALPHA_32), sse)
+#undef LOAD_SI128
+#undef SAVE_SI128
+
+#define LOAD_SI128 _mm_loadu_si128
+#define SAVE_SI128 _mm_storeu_si128
+RGB_YUV420_SSE_FUNCTION(rgb32, 4, RGBA2YUV_32(IGNORE_ALPHA_32), sseu)
+#undef LOAD_SI128
+#undef SAVE_SI128
+
+// un-premultiply 16 colors C by their alpha values A (see unpremultiply_std), with a single precision division of
+// 510*c+a by 2*a, the 16 bits N_16 and A_16 being 255*c and a
+#define UNPREMULTIPLY_4(N_16, A_16, UNPACK) \
+	_mm_cvttps_epi32(_mm_div_ps( \
+		_mm_cvtepi32_ps(_mm_add_epi32(_mm_slli_epi32(UNPACK(N_16, _mm_setzero_si128()), 1), UNPACK(A_16, _mm_setzero_si128()))), \
+		_mm_cvtepi32_ps(_mm_slli_epi32(UNPACK(A_16, _mm_setzero_si128()), 1))))
+
+#define UNPREMULTIPLY_8(C_16, A_16) \
+	_mm_andnot_si128(_mm_cmpeq_epi16(A_16, _mm_setzero_si128()), _mm_min_epi16(_mm_packs_epi32( \
+		UNPREMULTIPLY_4(_mm_mullo_epi16(C_16, _mm_set1_epi16(255)), A_16, _mm_unpacklo_epi16), \
+		UNPREMULTIPLY_4(_mm_mullo_epi16(C_16, _mm_set1_epi16(255)), A_16, _mm_unpackhi_epi16)), _mm_set1_epi16(255)))
+
+#define UNPREMULTIPLY_16(C, A) \
+	_mm_packus_epi16(UNPREMULTIPLY_8(_mm_unpacklo_epi8(C, _mm_setzero_si128()), _mm_unpacklo_epi8(A, _mm_setzero_si128())), \
+		UNPREMULTIPLY_8(_mm_unpackhi_epi8(C, _mm_setzero_si128()), _mm_unpackhi_epi8(A, _mm_setzero_si128())))
+
+// after the unpacking of RGBA2YUV_32, rgb4 and rgb8 contain the alpha values of the even and odd pixels, for the
+// first line in their low half and the second line in their high half, and rgb1, rgb2, rgb3 and rgb5, rgb6, rgb7
+// the matching colors
+#define RGBA2YUVA_ALPHA_32(OFFSET) \
+	if(premultiplied) \
+	{ \
+		rgb1 = UNPREMULTIPLY_16(rgb1, rgb4); \
+		rgb2 = UNPREMULTIPLY_16(rgb2, rgb4); \
+		rgb3 = UNPREMULTIPLY_16(rgb3, rgb4); \
+		rgb5 = UNPREMULTIPLY_16(rgb5, rgb8); \
+		rgb6 = UNPREMULTIPLY_16(rgb6, rgb8); \
+		rgb7 = UNPREMULTIPLY_16(rgb7, rgb8); \
+	} \
+	if(a_ptr1) \
+	{ \
+		SAVE_SI128((__m128i*)(a_ptr1+x+OFFSET), _mm_unpacklo_epi8(rgb4, rgb8)); \
+		SAVE_SI128((__m128i*)(a_ptr2+x+OFFSET), _mm_unpackhi_epi8(rgb4, rgb8)); \
 	}
-	#undef LOAD_SI128
-	#undef SAVE_SI128
+
+// RGBA_YUVA420_SSE_FUNCTION(SUFFIX) defines rgb32_yuva420_<SUFFIX>, using the LOAD_SI128 and SAVE_SI128 macros
+// defined where it is used
+// the alpha line pointers are only offset when there is an alpha plane
+#define RGBA_YUVA420_SSE_FUNCTION(SUFFIX) \
+void rgb32_yuva420_##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *RGBA, uint32_t RGBA_stride, \
+	uint8_t *Y, uint8_t *U, uint8_t *V, uint8_t *A, uint32_t Y_stride, uint32_t UV_stride, \
+	int premultiplied, YCbCrType yuv_type) \
+{ \
+	KERNEL_PARAM(RGB2YUVParam, RGB2YUV) \
+	\
+	uint32_t x, y; \
+	for(y=0; (y+1)<height; y+=2) \
+	{ \
+		const uint8_t *rgb_ptr1=RGBA+y*RGBA_stride, \
+			*rgb_ptr2=RGBA+(y+1)*RGBA_stride; \
+		\
+		uint8_t *y_ptr1=Y+y*Y_stride, \
+			*y_ptr2=Y+(y+1)*Y_stride, \
+			*a_ptr1=ALPHA_OFFSET(y*Y_stride), \
+			*a_ptr2=ALPHA_OFFSET((y+1)*Y_stride), \
+			*u_ptr=U+(y/2)*UV_stride, \
+			*v_ptr=V+(y/2)*UV_stride; \
+		\
+		for(x=0; (x+31)<width; x+=32) \
+		{ \
+			RGBA2YUV_32(RGBA2YUVA_ALPHA_32) \
+			\
+			rgb_ptr1+=128; \
+			rgb_ptr2+=128; \
+			y_ptr1+=32; \
+			y_ptr2+=32; \
+			u_ptr+=16; \
+			v_ptr+=16; \
+		} \
+	} \
+	RGBA_YUVA420_TAIL(32, rgb32_yuva420_sseu, rgb32_yuva420_std) \
 }
 
-void rgb32_yuv420_sseu(uint32_t width, uint32_t height, 
-	const uint8_t *RGBA, uint32_t RGBA_stride, 
-	uint8_t *Y, uint8_t *U, uint8_t *V, uint32_t Y_stride, uint32_t UV_stride, 
-	YCbCrType yuv_type)
-{
-	#define LOAD_SI128 _mm_loadu_si128
-	#define SAVE_SI128 _mm_storeu_si128
-	const RGB2YUVParam *const param = &(RGB2YUV[yuv_type]);
-	
-	uint32_t x, y;
-	for(y=0; y<(height-1); y+=2)
-	{
-		const uint8_t *rgb_ptr1=RGBA+y*RGBA_stride,
-			*rgb_ptr2=RGBA+(y+1)*RGBA_stride;
-		
-		uint8_t *y_ptr1=Y+y*Y_stride,
-			*y_ptr2=Y+(y+1)*Y_stride,
-			*u_ptr=U+(y/2)*UV_stride,
-			*v_ptr=V+(y/2)*UV_stride;
-		
-		for(x=0; x<(width-31); x+=32)
-		{
-			RGBA2YUV_32
-			
-			rgb_ptr1+=128;
-			rgb_ptr2+=128;
-			y_ptr1+=32;
-			y_ptr2+=32;
-			u_ptr+=16; 
-			v_ptr+=16;
-		}
+#define LOAD_SI128 _mm_load_si128
+#define SAVE_SI128 _mm_stream_si128
+RGBA_YUVA420_SSE_FUNCTION(sse)
+#undef LOAD_SI128
+#undef SAVE_SI128
+
+#define LOAD_SI128 _mm_loadu_si128
+#define SAVE_SI128 _mm_storeu_si128
+RGBA_YUVA420_SSE_FUNCTION(sseu)
+#undef LOAD_SI128
+#undef SAVE_SI128
+
+// Precise rgb to yuv (see RGB2YUV_PRECISE_PARAM), with the same unpacking of the rgb data as RGB2YUV_32 and
+// RGBA2YUV_32, and 32 bits dot products computed with _mm_madd_epi16 on interleaved pairs (r, g) and (b, 0)
+
+// pair of 16 bits factors for _mm_madd_epi16
+#define PRECISE_FACTORS(F1, F2) _mm_set1_epi32((int32_t)(((uint32_t)(uint16_t)(F2)<<16) | (uint16_t)(F1)))
+
+#define RGB2YUV_PRECISE_CONSTANTS \
+	const __m128i y_rg = PRECISE_FACTORS(param->y_r, param->y_g), y_b = PRECISE_FACTORS(param->y_b, 0), \
+		cb_rg = PRECISE_FACTORS(param->cb_r, param->cb_g), cb_b = PRECISE_FACTORS(param->cb_b, 0), \
+		cr_rg = PRECISE_FACTORS(param->cr_r, param->cr_g), cr_b = PRECISE_FACTORS(param->cr_b, 0), \
+		y_offset = _mm_set1_epi32(param->y_offset), chroma_offset = _mm_set1_epi32(PRECISE_CHROMA_OFFSET);
+
+// value C (y, cb or cr) of 4 pixels, from the interleaved (r, g) and (b, 0) 16 bits values
+#define RGB2YUV_PRECISE_4(RG, B0, C, OFFSET, SHIFT) \
+	_mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(RG, C##_rg), _mm_madd_epi16(B0, C##_b)), OFFSET), SHIFT)
+
+// value C of 8 pixels, from their 16 bits r, g and b values, as 16 bits values
+#define RGB2YUV_PRECISE_8(R, G, B, C, OFFSET, SHIFT) \
+	_mm_packs_epi32( \
+		RGB2YUV_PRECISE_4(_mm_unpacklo_epi16(R, G), _mm_unpacklo_epi16(B, _mm_setzero_si128()), C, OFFSET, SHIFT), \
+		RGB2YUV_PRECISE_4(_mm_unpackhi_epi16(R, G), _mm_unpackhi_epi16(B, _mm_setzero_si128()), C, OFFSET, SHIFT))
+
+// save y of the 16 pixels of one line, from the 8 bits r, g and b values of its even (R1, G1, B1) and odd (R2, G2,
+// B2) pixels in the low (UNPACK=lo) or high (UNPACK=hi) halves, and add their r, g and b values to the sums of the
+// pairs of pixels
+#define RGB2YUV_PRECISE_LINE_16(R1, G1, B1, R2, G2, B2, UNPACK, Y_PTR) \
+	r1_16 = _mm_unpack##UNPACK##_epi8(R1, _mm_setzero_si128()); \
+	g1_16 = _mm_unpack##UNPACK##_epi8(G1, _mm_setzero_si128()); \
+	b1_16 = _mm_unpack##UNPACK##_epi8(B1, _mm_setzero_si128()); \
+	r2_16 = _mm_unpack##UNPACK##_epi8(R2, _mm_setzero_si128()); \
+	g2_16 = _mm_unpack##UNPACK##_epi8(G2, _mm_setzero_si128()); \
+	b2_16 = _mm_unpack##UNPACK##_epi8(B2, _mm_setzero_si128()); \
+	Y = _mm_packus_epi16(RGB2YUV_PRECISE_8(r1_16, g1_16, b1_16, y, y_offset, PRECISE_Y_SHIFT), \
+		RGB2YUV_PRECISE_8(r2_16, g2_16, b2_16, y, y_offset, PRECISE_Y_SHIFT)); \
+	Y = _mm_unpackhi_epi8(_mm_slli_si128(Y, 8), Y); \
+	SAVE_SI128((__m128i*)(Y_PTR), Y); \
+	r_sum = _mm_add_epi16(r_sum, _mm_add_epi16(r1_16, r2_16)); \
+	g_sum = _mm_add_epi16(g_sum, _mm_add_epi16(g1_16, g2_16)); \
+	b_sum = _mm_add_epi16(b_sum, _mm_add_epi16(b1_16, b2_16));
+
+// save y of 16 pixels of two lines, from the unpacked rgb data (first line in the low halves, second line in the
+// high halves), and set CB and CR to their 8 16 bits chroma values
+#define RGB2YUV_PRECISE_16(R1, G1, B1, R2, G2, B2, X, CB, CR) \
+	{ \
+		__m128i r1_16, g1_16, b1_16, r2_16, g2_16, b2_16, Y, \
+			r_sum = _mm_setzero_si128(), g_sum = _mm_setzero_si128(), b_sum = _mm_setzero_si128(); \
+		RGB2YUV_PRECISE_LINE_16(R1, G1, B1, R2, G2, B2, lo, y_ptr1+X) \
+		RGB2YUV_PRECISE_LINE_16(R1, G1, B1, R2, G2, B2, hi, y_ptr2+X) \
+		CB = RGB2YUV_PRECISE_8(r_sum, g_sum, b_sum, cb, chroma_offset, PRECISE_CHROMA_SHIFT); \
+		CR = RGB2YUV_PRECISE_8(r_sum, g_sum, b_sum, cr, chroma_offset, PRECISE_CHROMA_SHIFT); \
+	}
+
+// load and unpack 16 rgb24 pixels of both lines, starting at the pixel X, and convert them
+#define RGB2YUV_PRECISE_RGB24_16(X, CB, CR) \
+	{ \
+		__m128i tmp1, tmp2, tmp3, tmp4, tmp5, tmp6; \
+		__m128i rgb1 = LOAD_SI128((const __m128i*)(rgb_ptr1+3*X)), \
+			rgb2 = LOAD_SI128((const __m128i*)(rgb_ptr1+3*X+16)), \
+			rgb3 = LOAD_SI128((const __m128i*)(rgb_ptr1+3*X+32)), \
+			rgb4 = LOAD_SI128((const __m128i*)(rgb_ptr2+3*X)), \
+			rgb5 = LOAD_SI128((const __m128i*)(rgb_ptr2+3*X+16)), \
+			rgb6 = LOAD_SI128((const __m128i*)(rgb_ptr2+3*X+32)); \
+		UNPACK_RGB24_32_STEP(rgb1, rgb2, rgb3, rgb4, rgb5, rgb6, tmp1, tmp2, tmp3, tmp4, tmp5, tmp6) \
+		UNPACK_RGB24_32_STEP(tmp1, tmp2, tmp3, tmp4, tmp5, tmp6, rgb1, rgb2, rgb3, rgb4, rgb5, rgb6) \
+		UNPACK_RGB24_32_STEP(rgb1, rgb2, rgb3, rgb4, rgb5, rgb6, tmp1, tmp2, tmp3, tmp4, tmp5, tmp6) \
+		UNPACK_RGB24_32_STEP(tmp1, tmp2, tmp3, tmp4, tmp5, tmp6, rgb1, rgb2, rgb3, rgb4, rgb5, rgb6) \
+		RGB2YUV_PRECISE_16(rgb1, rgb2, rgb3, rgb4, rgb5, rgb6, X, CB, CR) \
 	}
-	#undef LOAD_SI128
-	#undef SAVE_SI128
+
+// same for rgba pixels
+#define RGB2YUV_PRECISE_RGB32_16(X, CB, CR) \
+	{ \
+		__m128i tmp1, tmp2, tmp3, tmp4, tmp5, tmp6, tmp7, tmp8; \
+		__m128i rgb1 = LOAD_SI128((const __m128i*)(rgb_ptr1+4*X)), \
+			rgb2 = LOAD_SI128((const __m128i*)(rgb_ptr1+4*X+16)), \
+			rgb3 = LOAD_SI128((const __m128i*)(rgb_ptr1+4*X+32)), \
+			rgb4 = LOAD_SI128((const __m128i*)(rgb_ptr1+4*X+48)), \
+			rgb5 = LOAD_SI128((const __m128i*)(rgb_ptr2+4*X)), \
+			rgb6 = LOAD_SI128((const __m128i*)(rgb_ptr2+4*X+16)), \
+			rgb7 = LOAD_SI128((const __m128i*)(rgb_ptr2+4*X+32)), \
+			rgb8 = LOAD_SI128((const __m128i*)(rgb_ptr2+4*X+48)); \
+		UNPACK_RGB32_32_STEP(rgb1, rgb2, rgb3, rgb4, rgb5, rgb6, rgb7, rgb8, tmp1, tmp2, tmp3, tmp4, tmp5, tmp6, tmp7, tmp8) \
+		UNPACK_RGB32_32_STEP(tmp1, tmp2, tmp3, tmp4, tmp5, tmp6, tmp7, tmp8, rgb1, rgb2, rgb3, rgb4, rgb5, rgb6, rgb7, rgb8) \
+		UNPACK_RGB32_32_STEP(rgb1, rgb2, rgb3, rgb4, rgb5, rgb6, rgb7, rgb8, tmp1, tmp2, tmp3, tmp4, tmp5, tmp6, tmp7, tmp8) \
+		UNPACK_RGB32_32_STEP(tmp1, tmp2, tmp3, tmp4, tmp5, tmp6, tmp7, tmp8, rgb1, rgb2, rgb3, rgb4, rgb5, rgb6, rgb7, rgb8) \
+		RGB2YUV_PRECISE_16(rgb1, rgb2, rgb3, rgb5, rgb6, rgb7, X, CB, CR) \
+	}
+
+// convert 32 pixels of two lines, FORMAT being RGB24 or RGB32
+#define RGB2YUV_PRECISE_32(FORMAT) \
+	__m128i cb1_16, cr1_16, cb2_16, cr2_16; \
+	RGB2YUV_PRECISE_##FORMAT##_16(0, cb1_16, cr1_16) \
+	RGB2YUV_PRECISE_##FORMAT##_16(16, cb2_16, cr2_16) \
+	SAVE_SI128((__m128i*)(u_ptr), _mm_packus_epi16(cb1_16, cb2_16)); \
+	SAVE_SI128((__m128i*)(v_ptr), _mm_packus_epi16(cr1_16, cr2_16));
+
+#define RGB2YUV_PRECISE_SSE_FUNCTION(NAME, BPP, FORMAT, SUFFIX) \
+void NAME##_yuv420_precise_##SUFFIX(uint32_t width, uint32_t height, \
+	const uint8_t *RGB, uint32_t RGB_stride, \
+	uint8_t *Y, uint8_t *U, uint8_t *V, uint32_t Y_stride, uint32_t UV_stride, \
+	YCbCrType yuv_type) \
+{ \
+	KERNEL_PARAM(RGB2YUVPreciseParam, RGB2YUV_PRECISE) \
+	RGB2YUV_PRECISE_CONSTANTS \
+	\
+	uint32_t x, y; \
+	for(y=0; (y+1)<height; y+=2) \
+	{ \
+		const uint8_t *rgb_ptr1=RGB+y*RGB_stride, \
+			*rgb_ptr2=RGB+(y+1)*RGB_stride; \
+		\
+		uint8_t *y_ptr1=Y+y*Y_stride, \
+			*y_ptr2=Y+(y+1)*Y_stride, \
+			*u_ptr=U+(y/2)*UV_stride, \
+			*v_ptr=V+(y/2)*UV_stride; \
+		\
+		for(x=0; (x+31)<width; x+=32) \
+		{ \
+			RGB2YUV_PRECISE_32(FORMAT) \
+			\
+			rgb_ptr1+=32*BPP; \
+			rgb_ptr2+=32*BPP; \
+			y_ptr1+=32; \
+			y_ptr2+=32; \
+			u_ptr+=16; \
+			v_ptr+=16; \
+		} \
+	} \
+	RGB_YUV420_TAIL(32, BPP, RGB, RGB_stride, NAME##_yuv420_precise_sseu, NAME##_yuv420_precise_std) \
 }
 
+#define LOAD_SI128 _mm_load_si128
+#define SAVE_SI128 _mm_stream_si128
+RGB2YUV_PRECISE_SSE_FUNCTION(rgb24, 3, RGB24, sse)
+RGB2YUV_PRECISE_SSE_FUNCTION(rgb32, 4, RGB32, sse)
+#undef LOAD_SI128
+#undef SAVE_SI128
+
+#define LOAD_SI128 _mm_loadu_si128
+#define SAVE_SI128 _mm_storeu_si128
+RGB2YUV_PRECISE_SSE_FUNCTION(rgb24, 3, RGB24, sseu)
+RGB2YUV_PRECISE_SSE_FUNCTION(rgb32, 4, RGB32, sseu)
+#undef LOAD_SI128
+#undef SAVE_SI128
+
 #endif
 
 #ifdef _YUVRGB_SSE2_
 
-#define UV2RGB_16(U,V,R1,G1,B1,R2,G2,B2) \
-	r_tmp = _mm_srai_epi16(_mm_mullo_epi16(V, _mm_set1_epi16(param->cr_factor)), 6); \
-	g_tmp = _mm_srai_epi16(_mm_add_epi16( \
+// compute the r, g and b offsets of the 8 16 bits u and v values U and V
+#define UV2RGB_8(U,V,R,G,B) \
+	R = _mm_srai_epi16(_mm_mullo_epi16(V, _mm_set1_epi16(param->cr_factor)), 6); \
+	G = _mm_srai_epi16(_mm_add_epi16( \
 		_mm_mullo_epi16(U, _mm_set1_epi16(param->g_cb_factor)), \
 		_mm_mullo_epi16(V, _mm_set1_epi16(param->g_cr_factor))), 7); \
-	b_tmp = _mm_srai_epi16(_mm_mullo_epi16(U, _mm_set1_epi16(param->cb_factor)), 6); \
+	B = _mm_srai_epi16(_mm_mullo_epi16(U, _mm_set1_epi16(param->cb_factor)), 6);
+
+// same as UV2RGB_8, the offsets being duplicated for the 16 pixels sharing the u and v values
+#define UV2RGB_16(U,V,R1,G1,B1,R2,G2,B2) \
+	UV2RGB_8(U, V, r_tmp, g_tmp, b_tmp) \
 	R1 = _mm_unpacklo_epi16(r_tmp, r_tmp); \
 	G1 = _mm_unpacklo_epi16(g_tmp, g_tmp); \
 	B1 = _mm_unpacklo_epi16(b_tmp, b_tmp); \
@@ -987,7 +2178,7 @@ PACK_RGB24_32_STEP(R1, R2, G1, G2, B1, B2, RGB1, RGB2, RGB3, RGB4, RGB5, RGB6) \
 	uv2 = _mm_srli_epi16(uv2, 8); \
 	__m128i u = _mm_packus_epi16(_mm_and_si128(uv1, _mm_set1_epi16(255)), _mm_and_si128(uv2, _mm_set1_epi16(255))); \
 
-#define YUV2RGB_32 \
+#define YUV2RGB_32(PACK_SAVE) \
 	__m128i r_tmp, g_tmp, b_tmp; \
 	__m128i r_16_1, g_16_1, b_16_1, r_16_2, g_16_2, b_16_2; \
 	__m128i r_uv_16_1, g_uv_16_1, b_uv_16_1, r_uv_16_2, g_uv_16_2, b_uv_16_2; \
@@ -1064,251 +2255,2015 @@ PACK_RGB24_32_STEP(R1, R2, G1, G2, B1, B2, RGB1, RGB2, RGB3, RGB4, RGB5, RGB6) \
 	__m128i g_8_22 = _mm_packus_epi16(g_16_1, g_16_2); \
 	__m128i b_8_22 = _mm_packus_epi16(b_16_1, b_16_2); \
 	\
-	__m128i rgb_1, rgb_2, rgb_3, rgb_4, rgb_5, rgb_6; \
-	\
-	PACK_RGB24_32(r_8_11, r_8_12, g_8_11, g_8_12, b_8_11, b_8_12, rgb_1, rgb_2, rgb_3, rgb_4, rgb_5, rgb_6) \
-	SAVE_SI128((__m128i*)(rgb_ptr1), rgb_1); \
-	SAVE_SI128((__m128i*)(rgb_ptr1+16), rgb_2); \
-	SAVE_SI128((__m128i*)(rgb_ptr1+32), rgb_3); \
-	SAVE_SI128((__m128i*)(rgb_ptr1+48), rgb_4); \
-	SAVE_SI128((__m128i*)(rgb_ptr1+64), rgb_5); \
-	SAVE_SI128((__m128i*)(rgb_ptr1+80), rgb_6); \
-	\
-	PACK_RGB24_32(r_8_21, r_8_22, g_8_21, g_8_22, b_8_21, b_8_22, rgb_1, rgb_2, rgb_3, rgb_4, rgb_5, rgb_6) \
-	SAVE_SI128((__m128i*)(rgb_ptr2), rgb_1); \
-	SAVE_SI128((__m128i*)(rgb_ptr2+16), rgb_2); \
-	SAVE_SI128((__m128i*)(rgb_ptr2+32), rgb_3); \
-	SAVE_SI128((__m128i*)(rgb_ptr2+48), rgb_4); \
-	SAVE_SI128((__m128i*)(rgb_ptr2+64), rgb_5); \
-	SAVE_SI128((__m128i*)(rgb_ptr2+80), rgb_6); \
-
-#define YUV2RGB_32_PLANAR \
+	PACK_SAVE(r_8_11, r_8_12, g_8_11, g_8_12, b_8_11, b_8_12, 1) \
+	PACK_SAVE(r_8_21, r_8_22, g_8_21, g_8_22, b_8_21, b_8_22, 2) \
+
+#define YUV2RGB_32_PLANAR(PACK_SAVE) \
 	LOAD_UV_PLANAR \
-	YUV2RGB_32
+	YUV2RGB_32(PACK_SAVE)
 
-#define YUV2RGB_32_NV12 \
+#define YUV2RGB_32_NV12(PACK_SAVE) \
 	LOAD_UV_NV12 \
-	YUV2RGB_32
+	YUV2RGB_32(PACK_SAVE)
 	
-#define YUV2RGB_32_NV21 \
+#define YUV2RGB_32_NV21(PACK_SAVE) \
 	LOAD_UV_NV21 \
-	YUV2RGB_32
+	YUV2RGB_32(PACK_SAVE)
+
+// The PACK_SAVE_<FORMAT>_32 macros save the 32 pixels of the line LINE (1 or 2) of a pair, given as 8 bits r, g and b
+// values in two registers each (R1 for the first 16 pixels, R2 for the last 16), in the rgb format FORMAT, at the line
+// pointers (rgb_ptr1 and rgb_ptr2 for interleaved formats)
+#define PACK_SAVE_RGB24_32(R1, R2, G1, G2, B1, B2, LINE) \
+	PACK_SAVE_RGB24_PTR_32(R1, R2, G1, G2, B1, B2, rgb_ptr##LINE)
+
+#define PACK_SAVE_BGR24_32(R1, R2, G1, G2, B1, B2, LINE) \
+	PACK_SAVE_RGB24_PTR_32(B1, B2, G1, G2, R1, R2, rgb_ptr##LINE)
+
+#define PACK_SAVE_RGB24_PTR_32(R1, R2, G1, G2, B1, B2, PTR) \
+	{ \
+		__m128i rgb_1, rgb_2, rgb_3, rgb_4, rgb_5, rgb_6; \
+		PACK_RGB24_32(R1, R2, G1, G2, B1, B2, rgb_1, rgb_2, rgb_3, rgb_4, rgb_5, rgb_6) \
+		SAVE_SI128((__m128i*)(PTR), rgb_1); \
+		SAVE_SI128((__m128i*)(PTR+16), rgb_2); \
+		SAVE_SI128((__m128i*)(PTR+32), rgb_3); \
+		SAVE_SI128((__m128i*)(PTR+48), rgb_4); \
+		SAVE_SI128((__m128i*)(PTR+64), rgb_5); \
+		SAVE_SI128((__m128i*)(PTR+80), rgb_6); \
+	}
+
+// interleave the four 8 bits channels of 16 pixels in memory order C1, C2, C3, C4, and save them at PTR
+#define PACK_SAVE_4CHANNELS_16(C1, C2, C3, C4, PTR) \
+	{ \
+		const __m128i c12_lo = _mm_unpacklo_epi8(C1, C2), c12_hi = _mm_unpackhi_epi8(C1, C2), \
+			c34_lo = _mm_unpacklo_epi8(C3, C4), c34_hi = _mm_unpackhi_epi8(C3, C4); \
+		SAVE_SI128((__m128i*)(PTR), _mm_unpacklo_epi16(c12_lo, c34_lo)); \
+		SAVE_SI128((__m128i*)(PTR+16), _mm_unpackhi_epi16(c12_lo, c34_lo)); \
+		SAVE_SI128((__m128i*)(PTR+32), _mm_unpacklo_epi16(c12_hi, c34_hi)); \
+		SAVE_SI128((__m128i*)(PTR+48), _mm_unpackhi_epi16(c12_hi, c34_hi)); \
+	}
+
+#define PACK_SAVE_RGB32_32(R1, R2, G1, G2, B1, B2, LINE) \
+	PACK_SAVE_4CHANNELS_16(R1, G1, B1, _mm_set1_epi8(-1), rgb_ptr##LINE) \
+	PACK_SAVE_4CHANNELS_16(R2, G2, B2, _mm_set1_epi8(-1), rgb_ptr##LINE+64)
+
+#define PACK_SAVE_BGRA_32(R1, R2, G1, G2, B1, B2, LINE) \
+	PACK_SAVE_4CHANNELS_16(B1, G1, R1, _mm_set1_epi8(-1), rgb_ptr##LINE) \
+	PACK_SAVE_4CHANNELS_16(B2, G2, R2, _mm_set1_epi8(-1), rgb_ptr##LINE+64)
+
+#define PACK_SAVE_ARGB_32(R1, R2, G1, G2, B1, B2, LINE) \
+	PACK_SAVE_4CHANNELS_16(_mm_set1_epi8(-1), R1, G1, B1, rgb_ptr##LINE) \
+	PACK_SAVE_4CHANNELS_16(_mm_set1_epi8(-1), R2, G2, B2, rgb_ptr##LINE+64)
+
+// pack 8 pixels to 16 bits rgb565, from r in the high bytes and g and b in the low bytes of 16 bits values
+#define RGB565_8(R, G, B) \
+	_mm_or_si128(_mm_or_si128(_mm_and_si128(R, _mm_set1_epi16((short)0xF800)), \
+		_mm_slli_epi16(_mm_and_si128(G, _mm_set1_epi16(0xFC)), 3)), _mm_srli_epi16(B, 3))
+
+#define PACK_SAVE_RGB565_16(R, G, B, PTR) \
+	SAVE_SI128((__m128i*)(PTR), RGB565_8(_mm_unpacklo_epi8(_mm_setzero_si128(), R), \
+		_mm_unpacklo_epi8(G, _mm_setzero_si128()), _mm_unpacklo_epi8(B, _mm_setzero_si128()))); \
+	SAVE_SI128((__m128i*)(PTR+16), RGB565_8(_mm_unpackhi_epi8(_mm_setzero_si128(), R), \
+		_mm_unpackhi_epi8(G, _mm_setzero_si128()), _mm_unpackhi_epi8(B, _mm_setzero_si128())));
+
+#define PACK_SAVE_RGB565_32(R1, R2, G1, G2, B1, B2, LINE) \
+	PACK_SAVE_RGB565_16(R1, G1, B1, rgb_ptr##LINE) \
+	PACK_SAVE_RGB565_16(R2, G2, B2, rgb_ptr##LINE+32)
+
+// YUV420_RGB_SSE_FUNCTION(FORMAT, BPP, PACK_SAVE, SUFFIX) defines yuv420_<FORMAT>_<SUFFIX>, using the LOAD_SI128 and
+// SAVE_SI128 macros defined where it is used
+#define YUV420_RGB_SSE_FUNCTION(FORMAT, BPP, PACK_SAVE, SUFFIX) \
+void yuv420_##FORMAT##_##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *Y, const uint8_t *U, const uint8_t *V, uint32_t Y_stride, uint32_t UV_stride, \
+	uint8_t *RGB, uint32_t RGB_stride, \
+	YCbCrType yuv_type) \
+{ \
+	KERNEL_PARAM(YUV2RGBParam, YUV2RGB) \
+	\
+	uint32_t x, y; \
+	for(y=0; (y+1)<height; y+=2) \
+	{ \
+		const uint8_t *y_ptr1=Y+y*Y_stride, \
+			*y_ptr2=Y+(y+1)*Y_stride, \
+			*u_ptr=U+(y/2)*UV_stride, \
+			*v_ptr=V+(y/2)*UV_stride; \
+		\
+		uint8_t *rgb_ptr1=RGB+y*RGB_stride, \
+			*rgb_ptr2=RGB+(y+1)*RGB_stride; \
+		\
+		for(x=0; (x+31)<width; x+=32) \
+		{ \
+			YUV2RGB_32_PLANAR(PACK_SAVE) \
+			\
+			y_ptr1+=32; \
+			y_ptr2+=32; \
+			u_ptr+=16; \
+			v_ptr+=16; \
+			rgb_ptr1+=32*BPP; \
+			rgb_ptr2+=32*BPP; \
+		} \
+	} \
+	YUV420_RGB_TAIL(32, BPP, yuv420_##FORMAT##_sseu, yuv420_##FORMAT##_std) \
+}
+
+// NV12_RGB_SSE_FUNCTION(NAME, NV_FORMAT, FORMAT, BPP, PACK_SAVE, SUFFIX) defines <NAME>_<FORMAT>_<SUFFIX>, for NAME nv12
+// or nv21 and NV_FORMAT the matching uv load (NV12 or NV21)
+#define NV12_RGB_SSE_FUNCTION(NAME, NV_FORMAT, FORMAT, BPP, PACK_SAVE, SUFFIX) \
+void NAME##_##FORMAT##_##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *Y, const uint8_t *UV, uint32_t Y_stride, uint32_t UV_stride, \
+	uint8_t *RGB, uint32_t RGB_stride, \
+	YCbCrType yuv_type) \
+{ \
+	KERNEL_PARAM(YUV2RGBParam, YUV2RGB) \
+	\
+	uint32_t x, y; \
+	for(y=0; (y+1)<height; y+=2) \
+	{ \
+		const uint8_t *y_ptr1=Y+y*Y_stride, \
+			*y_ptr2=Y+(y+1)*Y_stride, \
+			*uv_ptr=UV+(y/2)*UV_stride; \
+		\
+		uint8_t *rgb_ptr1=RGB+y*RGB_stride, \
+			*rgb_ptr2=RGB+(y+1)*RGB_stride; \
+		\
+		for(x=0; (x+31)<width; x+=32) \
+		{ \
+			YUV2RGB_32_##NV_FORMAT(PACK_SAVE) \
+			\
+			y_ptr1+=32; \
+			y_ptr2+=32; \
+			uv_ptr+=32; \
+			rgb_ptr1+=32*BPP; \
+			rgb_ptr2+=32*BPP; \
+		} \
+	} \
+	NV12_RGB_TAIL(32, BPP, NAME##_##FORMAT##_sseu, NAME##_##FORMAT##_std) \
+}
+
+#define YUV2RGB_SSE_FUNCTIONS(FORMAT, BPP, PACK_SAVE, SUFFIX) \
+	YUV420_RGB_SSE_FUNCTION(FORMAT, BPP, PACK_SAVE, SUFFIX) \
+	NV12_RGB_SSE_FUNCTION(nv12, NV12, FORMAT, BPP, PACK_SAVE, SUFFIX) \
+	NV12_RGB_SSE_FUNCTION(nv21, NV21, FORMAT, BPP, PACK_SAVE, SUFFIX)
+
+#define YUV2RGB_SSE_ALL_FORMATS(SUFFIX) \
+	YUV2RGB_SSE_FUNCTIONS(rgb24, 3, PACK_SAVE_RGB24_32, SUFFIX) \
+	YUV2RGB_SSE_FUNCTIONS(rgb32, 4, PACK_SAVE_RGB32_32, SUFFIX) \
+	YUV2RGB_SSE_FUNCTIONS(bgra, 4, PACK_SAVE_BGRA_32, SUFFIX) \
+	YUV2RGB_SSE_FUNCTIONS(argb, 4, PACK_SAVE_ARGB_32, SUFFIX) \
+	YUV2RGB_SSE_FUNCTIONS(bgr24, 3, PACK_SAVE_BGR24_32, SUFFIX) \
+	YUV2RGB_SSE_FUNCTIONS(rgb565, 2, PACK_SAVE_RGB565_32, SUFFIX)
+
+#define LOAD_SI128 _mm_load_si128
+#define SAVE_SI128 _mm_stream_si128
+YUV2RGB_SSE_ALL_FORMATS(sse)
+#undef LOAD_SI128
+#undef SAVE_SI128
+
+#define LOAD_SI128 _mm_loadu_si128
+#define SAVE_SI128 _mm_storeu_si128
+YUV2RGB_SSE_ALL_FORMATS(sseu)
+#undef LOAD_SI128
+#undef SAVE_SI128
+
+// yuva to rgba, see yuva420_rgb32_std
+// premultiply 16 colors C by their alpha values A (see PREMULTIPLY_STD)
+#define PREMULTIPLY_8(C_16, A_16) \
+	_mm_mulhi_epu16(_mm_add_epi16(_mm_mullo_epi16(C_16, A_16), _mm_set1_epi16(128)), _mm_set1_epi16(257))
+
+#define PREMULTIPLY_16(C, A) \
+	_mm_packus_epi16(PREMULTIPLY_8(_mm_unpacklo_epi8(C, _mm_setzero_si128()), _mm_unpacklo_epi8(A, _mm_setzero_si128())), \
+		PREMULTIPLY_8(_mm_unpackhi_epi8(C, _mm_setzero_si128()), _mm_unpackhi_epi8(A, _mm_setzero_si128())))
+
+// same as the PACK_SAVE_<FORMAT>_32 macros, with the alpha values of the line pointers a_ptr1 and a_ptr2
+#define PACK_SAVE_RGBA_YUVA_32(R1, R2, G1, G2, B1, B2, LINE) \
+	{ \
+		const __m128i a1 = LOAD_SI128((const __m128i*)(a_ptr##LINE)), a2 = LOAD_SI128((const __m128i*)(a_ptr##LINE+16)); \
+		PACK_SAVE_4CHANNELS_16(R1, G1, B1, a1, rgb_ptr##LINE) \
+		PACK_SAVE_4CHANNELS_16(R2, G2, B2, a2, rgb_ptr##LINE+64) \
+	}
+
+#define PACK_SAVE_BGRA_PREMULTIPLIED_YUVA_32(R1, R2, G1, G2, B1, B2, LINE) \
+	{ \
+		const __m128i a1 = LOAD_SI128((const __m128i*)(a_ptr##LINE)), a2 = LOAD_SI128((const __m128i*)(a_ptr##LINE+16)); \
+		PACK_SAVE_4CHANNELS_16(PREMULTIPLY_16(B1, a1), PREMULTIPLY_16(G1, a1), PREMULTIPLY_16(R1, a1), a1, \
+			rgb_ptr##LINE) \
+		PACK_SAVE_4CHANNELS_16(PREMULTIPLY_16(B2, a2), PREMULTIPLY_16(G2, a2), PREMULTIPLY_16(R2, a2), a2, \
+			rgb_ptr##LINE+64) \
+	}
+
+// YUVA420_RGB_SSE_FUNCTION(FORMAT, PACK_SAVE, SUFFIX) defines yuva420_<FORMAT>_<SUFFIX>, using the LOAD_SI128 and
+// SAVE_SI128 macros defined where it is used
+#define YUVA420_RGB_SSE_FUNCTION(FORMAT, PACK_SAVE, SUFFIX) \
+void yuva420_##FORMAT##_##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *Y, const uint8_t *U, const uint8_t *V, const uint8_t *A, uint32_t Y_stride, uint32_t UV_stride, \
+	uint8_t *RGB, uint32_t RGB_stride, \
+	YCbCrType yuv_type) \
+{ \
+	KERNEL_PARAM(YUV2RGBParam, YUV2RGB) \
+	\
+	uint32_t x, y; \
+	for(y=0; (y+1)<height; y+=2) \
+	{ \
+		const uint8_t *y_ptr1=Y+y*Y_stride, \
+			*y_ptr2=Y+(y+1)*Y_stride, \
+			*a_ptr1=A+y*Y_stride, \
+			*a_ptr2=A+(y+1)*Y_stride, \
+			*u_ptr=U+(y/2)*UV_stride, \
+			*v_ptr=V+(y/2)*UV_stride; \
+		\
+		uint8_t *rgb_ptr1=RGB+y*RGB_stride, \
+			*rgb_ptr2=RGB+(y+1)*RGB_stride; \
+		\
+		for(x=0; (x+31)<width; x+=32) \
+		{ \
+			YUV2RGB_32_PLANAR(PACK_SAVE) \
+			\
+			y_ptr1+=32; \
+			y_ptr2+=32; \
+			a_ptr1+=32; \
+			a_ptr2+=32; \
+			u_ptr+=16; \
+			v_ptr+=16; \
+			rgb_ptr1+=128; \
+			rgb_ptr2+=128; \
+		} \
+	} \
+	YUVA420_RGB_TAIL(32, yuva420_##FORMAT##_sseu, yuva420_##FORMAT##_std) \
+}
+
+#define YUVA420_RGB_SSE_FUNCTIONS(SUFFIX) \
+	YUVA420_RGB_SSE_FUNCTION(rgb32, PACK_SAVE_RGBA_YUVA_32, SUFFIX) \
+	YUVA420_RGB_SSE_FUNCTION(bgra_premultiplied, PACK_SAVE_BGRA_PREMULTIPLIED_YUVA_32, SUFFIX)
+
+#define LOAD_SI128 _mm_load_si128
+#define SAVE_SI128 _mm_stream_si128
+YUVA420_RGB_SSE_FUNCTIONS(sse)
+#undef LOAD_SI128
+#undef SAVE_SI128
+
+#define LOAD_SI128 _mm_loadu_si128
+#define SAVE_SI128 _mm_storeu_si128
+YUVA420_RGB_SSE_FUNCTIONS(sseu)
+#undef LOAD_SI128
+#undef SAVE_SI128
+
+
+// Planar rgb output, see yuv420_rgb_planar_std
+
+// normalize 4 values, given as 32 bits integers
+#define NORMALIZE_4(VALUE, MEAN, SCALE) _mm_mul_ps(_mm_sub_ps(_mm_cvtepi32_ps(VALUE), MEAN), SCALE)
+
+// save the normalized values of a channel for 16 pixels, as single (F32) or half (F16) precision floats
+#define SAVE_F32_16(C, PTR, MEAN, SCALE) \
+	{ \
+		const __m128i c_lo = _mm_unpacklo_epi8(C, _mm_setzero_si128()), c_hi = _mm_unpackhi_epi8(C, _mm_setzero_si128()); \
+		SAVE_SI128((__m128i*)(PTR), _mm_castps_si128(NORMALIZE_4(_mm_unpacklo_epi16(c_lo, _mm_setzero_si128()), MEAN, SCALE))); \
+		SAVE_SI128((__m128i*)(PTR+4), _mm_castps_si128(NORMALIZE_4(_mm_unpackhi_epi16(c_lo, _mm_setzero_si128()), MEAN, SCALE))); \
+		SAVE_SI128((__m128i*)(PTR+8), _mm_castps_si128(NORMALIZE_4(_mm_unpacklo_epi16(c_hi, _mm_setzero_si128()), MEAN, SCALE))); \
+		SAVE_SI128((__m128i*)(PTR+12), _mm_castps_si128(NORMALIZE_4(_mm_unpackhi_epi16(c_hi, _mm_setzero_si128()), MEAN, SCALE))); \
+	}
+
+// sse2 has no conversion to half precision, but each channel only has 256 possible values, so the half precision values
+// are read from a table computed once per call (half_table, see PLANAR_NORM_SSE_rgb_planar_f16)
+#define SAVE_F16_16(C, PTR, TABLE) \
+	{ \
+		uint8_t c_values[16]; \
+		uint16_t h_values[16]; \
+		int i; \
+		_mm_storeu_si128((__m128i*)c_values, C); \
+		for(i=0; i<16; ++i) \
+			h_values[i] = TABLE[c_values[i]]; \
+		SAVE_SI128((__m128i*)(PTR), _mm_loadu_si128((const __m128i*)h_values)); \
+		SAVE_SI128((__m128i*)(PTR+8), _mm_loadu_si128((const __m128i*)(h_values+8))); \
+	}
+
+#define PACK_SAVE_RGB_PLANAR_32(R1, R2, G1, G2, B1, B2, LINE) \
+	SAVE_SI128((__m128i*)(r_ptr##LINE), R1); \
+	SAVE_SI128((__m128i*)(r_ptr##LINE+16), R2); \
+	SAVE_SI128((__m128i*)(g_ptr##LINE), G1); \
+	SAVE_SI128((__m128i*)(g_ptr##LINE+16), G2); \
+	SAVE_SI128((__m128i*)(b_ptr##LINE), B1); \
+	SAVE_SI128((__m128i*)(b_ptr##LINE+16), B2);
+
+#define PACK_SAVE_RGB_PLANAR_F32_32(R1, R2, G1, G2, B1, B2, LINE) \
+	SAVE_F32_16(R1, r_ptr##LINE, r_mean, r_scale) \
+	SAVE_F32_16(R2, r_ptr##LINE+16, r_mean, r_scale) \
+	SAVE_F32_16(G1, g_ptr##LINE, g_mean, g_scale) \
+	SAVE_F32_16(G2, g_ptr##LINE+16, g_mean, g_scale) \
+	SAVE_F32_16(B1, b_ptr##LINE, b_mean, b_scale) \
+	SAVE_F32_16(B2, b_ptr##LINE+16, b_mean, b_scale)
+
+#define PACK_SAVE_RGB_PLANAR_F16_32(R1, R2, G1, G2, B1, B2, LINE) \
+	SAVE_F16_16(R1, r_ptr##LINE, half_table[0]) \
+	SAVE_F16_16(R2, r_ptr##LINE+16, half_table[0]) \
+	SAVE_F16_16(G1, g_ptr##LINE, half_table[1]) \
+	SAVE_F16_16(G2, g_ptr##LINE+16, half_table[1]) \
+	SAVE_F16_16(B1, b_ptr##LINE, half_table[2]) \
+	SAVE_F16_16(B2, b_ptr##LINE+16, half_table[2])
+
+// normalization parameters used by the save macros of the float formats
+#define PLANAR_NORM_SSE_rgb_planar
+#define PLANAR_NORM_SSE_rgb_planar_f32 \
+	const __m128 r_mean = _mm_set1_ps(norm->mean[0]), g_mean = _mm_set1_ps(norm->mean[1]), b_mean = _mm_set1_ps(norm->mean[2]), \
+		r_scale = _mm_set1_ps(norm->scale[0]), g_scale = _mm_set1_ps(norm->scale[1]), b_scale = _mm_set1_ps(norm->scale[2]);
+#define PLANAR_NORM_SSE_rgb_planar_f16 \
+	uint16_t half_table[3][256]; \
+	{ \
+		int c, v; \
+		for(c=0; c<3; ++c) \
+			for(v=0; v<256; ++v) \
+				half_table[c][v] = float_to_half(((float)v-norm->mean[c])*norm->scale[c]); \
+	}
+
+// YUV420_RGB_PLANAR_SSE_FUNCTION(FORMAT, TYPE, PACK_SAVE, SUFFIX) defines yuv420_<FORMAT>_<SUFFIX> for a planar FORMAT,
+// of which planes have elements of type TYPE
+#define YUV420_RGB_PLANAR_SSE_FUNCTION(FORMAT, TYPE, PACK_SAVE, SUFFIX) \
+void yuv420_##FORMAT##_##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *Y, const uint8_t *U, const uint8_t *V, uint32_t Y_stride, uint32_t UV_stride, \
+	TYPE *R, TYPE *G, TYPE *B, uint32_t RGB_stride, PLANAR_NORM_PARAM_##FORMAT \
+	YCbCrType yuv_type) \
+{ \
+	KERNEL_PARAM(YUV2RGBParam, YUV2RGB) \
+	PLANAR_NORM_SSE_##FORMAT \
+	\
+	uint32_t x, y; \
+	for(y=0; (y+1)<height; y+=2) \
+	{ \
+		const uint8_t *y_ptr1=Y+y*Y_stride, \
+			*y_ptr2=Y+(y+1)*Y_stride, \
+			*u_ptr=U+(y/2)*UV_stride, \
+			*v_ptr=V+(y/2)*UV_stride; \
+		\
+		PLANAR_RGB_LINES(TYPE, y, y+1) \
+		\
+		for(x=0; (x+31)<width; x+=32) \
+		{ \
+			YUV2RGB_32_PLANAR(PACK_SAVE) \
+			\
+			y_ptr1+=32; \
+			y_ptr2+=32; \
+			u_ptr+=16; \
+			v_ptr+=16; \
+			PLANAR_RGB_ADVANCE(32) \
+		} \
+	} \
+	YUV420_RGB_PLANAR_TAIL(32, PLANAR_NORM_ARG_##FORMAT, yuv420_##FORMAT##_sseu, yuv420_##FORMAT##_std) \
+}
+
+#define NV12_RGB_PLANAR_SSE_FUNCTION(NAME, NV_FORMAT, FORMAT, TYPE, PACK_SAVE, SUFFIX) \
+void NAME##_##FORMAT##_##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *Y, const uint8_t *UV, uint32_t Y_stride, uint32_t UV_stride, \
+	TYPE *R, TYPE *G, TYPE *B, uint32_t RGB_stride, PLANAR_NORM_PARAM_##FORMAT \
+	YCbCrType yuv_type) \
+{ \
+	KERNEL_PARAM(YUV2RGBParam, YUV2RGB) \
+	PLANAR_NORM_SSE_##FORMAT \
+	\
+	uint32_t x, y; \
+	for(y=0; (y+1)<height; y+=2) \
+	{ \
+		const uint8_t *y_ptr1=Y+y*Y_stride, \
+			*y_ptr2=Y+(y+1)*Y_stride, \
+			*uv_ptr=UV+(y/2)*UV_stride; \
+		\
+		PLANAR_RGB_LINES(TYPE, y, y+1) \
+		\
+		for(x=0; (x+31)<width; x+=32) \
+		{ \
+			YUV2RGB_32_##NV_FORMAT(PACK_SAVE) \
+			\
+			y_ptr1+=32; \
+			y_ptr2+=32; \
+			uv_ptr+=32; \
+			PLANAR_RGB_ADVANCE(32) \
+		} \
+	} \
+	NV12_RGB_PLANAR_TAIL(32, PLANAR_NORM_ARG_##FORMAT, NAME##_##FORMAT##_sseu, NAME##_##FORMAT##_std) \
+}
+
+#define YUV2RGB_PLANAR_SSE_FUNCTIONS(FORMAT, TYPE, PACK_SAVE, SUFFIX) \
+	YUV420_RGB_PLANAR_SSE_FUNCTION(FORMAT, TYPE, PACK_SAVE, SUFFIX) \
+	NV12_RGB_PLANAR_SSE_FUNCTION(nv12, NV12, FORMAT, TYPE, PACK_SAVE, SUFFIX) \
+	NV12_RGB_PLANAR_SSE_FUNCTION(nv21, NV21, FORMAT, TYPE, PACK_SAVE, SUFFIX)
+
+#define YUV2RGB_PLANAR_SSE_ALL_FORMATS(SUFFIX) \
+	YUV2RGB_PLANAR_SSE_FUNCTIONS(rgb_planar, uint8_t, PACK_SAVE_RGB_PLANAR_32, SUFFIX) \
+	YUV2RGB_PLANAR_SSE_FUNCTIONS(rgb_planar_f32, float, PACK_SAVE_RGB_PLANAR_F32_32, SUFFIX) \
+	YUV2RGB_PLANAR_SSE_FUNCTIONS(rgb_planar_f16, uint16_t, PACK_SAVE_RGB_PLANAR_F16_32, SUFFIX)
+
+#define LOAD_SI128 _mm_load_si128
+#define SAVE_SI128 _mm_stream_si128
+YUV2RGB_PLANAR_SSE_ALL_FORMATS(sse)
+#undef LOAD_SI128
+#undef SAVE_SI128
+
+#define LOAD_SI128 _mm_loadu_si128
+#define SAVE_SI128 _mm_storeu_si128
+YUV2RGB_PLANAR_SSE_ALL_FORMATS(sseu)
+#undef LOAD_SI128
+#undef SAVE_SI128
+
+
+// High bit depth input, see yuv420p10_rgb24_std
+// Each block converts 32 pixels of the two lines of a pair, by groups of 8 pixels: the 32 bits chroma terms of 4 chroma
+// samples are computed with _mm_madd_epi16 on interleaved 15 bits u and v values, and added to the 32 bits y terms of
+// the 8 pixels above them, on each line. The rgb values are then packed to 16 bits values at the output precision.
+
+// 16 bits value of 8 samples
+#define SAMPLE16_YUV420P10(S) _mm_slli_epi16(S, 6)
+#define SAMPLE16_P010(S) (S)
+
+// 15 bits centered chroma values of 8 samples
+#define CHROMA15(S) _mm_sub_epi16(_mm_srli_epi16(S, 1), _mm_set1_epi16(16384))
 
+// load the 16 u and v samples of a block, interleaved in uv_1 to uv_4 (4 samples each)
+#define LOAD_UV16_YUV420P10 \
+	const __m128i u_1 = CHROMA15(SAMPLE16_YUV420P10(LOAD_SI128((const __m128i*)(u_ptr)))), \
+		u_2 = CHROMA15(SAMPLE16_YUV420P10(LOAD_SI128((const __m128i*)(u_ptr+8)))), \
+		v_1 = CHROMA15(SAMPLE16_YUV420P10(LOAD_SI128((const __m128i*)(v_ptr)))), \
+		v_2 = CHROMA15(SAMPLE16_YUV420P10(LOAD_SI128((const __m128i*)(v_ptr+8)))); \
+	const __m128i uv_1 = _mm_unpacklo_epi16(u_1, v_1), uv_2 = _mm_unpackhi_epi16(u_1, v_1), \
+		uv_3 = _mm_unpacklo_epi16(u_2, v_2), uv_4 = _mm_unpackhi_epi16(u_2, v_2);
 
-void yuv420_rgb24_sse(
+#define LOAD_UV16_P010 \
+	const __m128i uv_1 = CHROMA15(LOAD_SI128((const __m128i*)(uv_ptr))), \
+		uv_2 = CHROMA15(LOAD_SI128((const __m128i*)(uv_ptr+8))), \
+		uv_3 = CHROMA15(LOAD_SI128((const __m128i*)(uv_ptr+16))), \
+		uv_4 = CHROMA15(LOAD_SI128((const __m128i*)(uv_ptr+24)));
+
+// pairs of 16 bits factors for _mm_madd_epi16, LOW multiplying the even elements (y or u) and HIGH the odd ones (v)
+#define MADD_FACTORS(LOW, HIGH) _mm_set1_epi32((int)(((uint32_t)(uint16_t)(HIGH)<<16) | (uint16_t)(LOW)))
+
+#define YUV2RGB16_SSE_FACTORS(BITS) \
+	const __m128i y16_offset = _mm_set1_epi16((short)param->y_offset), \
+		y16_factor = MADD_FACTORS(param->y_factor, 0), \
+		r_uv_factors = MADD_FACTORS(0, param->cr_factor), \
+		g_uv_factors = MADD_FACTORS(-param->g_cb_factor, -param->g_cr_factor), \
+		b_uv_factors = MADD_FACTORS(param->cb_factor, 0), \
+		rgb16_round = _mm_set1_epi32(RGB16_ROUND(BITS));
+
+// pack two registers of 4 32 bits values to 16 bits values, clamped to the output precision (8 bits values are only
+// saturated to 16 bits, and clamped by _mm_packus_epi16 when saved)
+#define PACK_RGB16_8(LO, HI) _mm_packs_epi32(LO, HI)
+#define PACK_RGB16_10(LO, HI) \
+	_mm_min_epi16(_mm_max_epi16(_mm_packs_epi32(LO, HI), _mm_setzero_si128()), _mm_set1_epi16(RGB16_MAX(10)))
+// there is no unsigned saturation of 32 bits values in sse2, so the values are moved to the signed range
+#define PACK_RGB16_16(LO, HI) \
+	_mm_xor_si128(_mm_packs_epi32(_mm_sub_epi32(LO, _mm_set1_epi32(32768)), _mm_sub_epi32(HI, _mm_set1_epi32(32768))), \
+		_mm_set1_epi16((short)0x8000))
+
+// compute the chroma terms of 4 interleaved chroma samples, with the rounding of the rgb values
+#define UV2RGB16_8(UV) \
+	r_uv = _mm_add_epi32(_mm_madd_epi16(UV, r_uv_factors), rgb16_round); \
+	g_uv = _mm_add_epi32(_mm_madd_epi16(UV, g_uv_factors), rgb16_round); \
+	b_uv = _mm_add_epi32(_mm_madd_epi16(UV, b_uv_factors), rgb16_round);
+
+// add the y terms of 8 pixels to the chroma terms, each of them duplicated for two adjacent pixels, and round them to
+// BITS bits
+#define RGB16_8(UV, BITS) \
+	PACK_RGB16_##BITS(_mm_srai_epi32(_mm_add_epi32(y_lo, _mm_unpacklo_epi32(UV, UV)), RGB16_SHIFT(BITS)), \
+		_mm_srai_epi32(_mm_add_epi32(y_hi, _mm_unpackhi_epi32(UV, UV)), RGB16_SHIFT(BITS)))
+
+// convert 8 pixels of 16 bits y values Y
+#define Y2RGB16_8(Y, BITS, R, G, B) \
+	y = _mm_srli_epi16(_mm_subs_epu16(Y, y16_offset), 1); \
+	y_lo = _mm_madd_epi16(_mm_unpacklo_epi16(y, _mm_setzero_si128()), y16_factor); \
+	y_hi = _mm_madd_epi16(_mm_unpackhi_epi16(y, _mm_setzero_si128()), y16_factor); \
+	R = RGB16_8(r_uv, BITS); \
+	G = RGB16_8(g_uv, BITS); \
+	B = RGB16_8(b_uv, BITS);
+
+#define YUV2RGB16_8(UV, I, INPUT, BITS) \
+	UV2RGB16_8(UV) \
+	Y2RGB16_8(SAMPLE16_##INPUT(LOAD_SI128((const __m128i*)(y_ptr1+8*(I-1)))), BITS, r_1_##I, g_1_##I, b_1_##I) \
+	Y2RGB16_8(SAMPLE16_##INPUT(LOAD_SI128((const __m128i*)(y_ptr2+8*(I-1)))), BITS, r_2_##I, g_2_##I, b_2_##I)
+
+#define YUV2RGB16_32(INPUT, BITS, PACK_SAVE) \
+	LOAD_UV16_##INPUT \
+	__m128i r_uv, g_uv, b_uv, y, y_lo, y_hi; \
+	__m128i r_1_1, r_1_2, r_1_3, r_1_4, g_1_1, g_1_2, g_1_3, g_1_4, b_1_1, b_1_2, b_1_3, b_1_4; \
+	__m128i r_2_1, r_2_2, r_2_3, r_2_4, g_2_1, g_2_2, g_2_3, g_2_4, b_2_1, b_2_2, b_2_3, b_2_4; \
+	YUV2RGB16_8(uv_1, 1, INPUT, BITS) \
+	YUV2RGB16_8(uv_2, 2, INPUT, BITS) \
+	YUV2RGB16_8(uv_3, 3, INPUT, BITS) \
+	YUV2RGB16_8(uv_4, 4, INPUT, BITS) \
+	PACK_SAVE(r_1_1, r_1_2, r_1_3, r_1_4, g_1_1, g_1_2, g_1_3, g_1_4, b_1_1, b_1_2, b_1_3, b_1_4, 1) \
+	PACK_SAVE(r_2_1, r_2_2, r_2_3, r_2_4, g_2_1, g_2_2, g_2_3, g_2_4, b_2_1, b_2_2, b_2_3, b_2_4, 2)
+
+// The PACK_SAVE16_<FORMAT>_32 macros save the 32 pixels of the line LINE (1 or 2) of a pair, given as 16 bits r, g and
+// b values at the precision of FORMAT in four registers each (R1 for the first 8 pixels, ...)
+#define PACK_SAVE16_RGB24_32(R1, R2, R3, R4, G1, G2, G3, G4, B1, B2, B3, B4, LINE) \
+	{ \
+		__m128i r_1 = _mm_packus_epi16(R1, R2), r_2 = _mm_packus_epi16(R3, R4), \
+			g_1 = _mm_packus_epi16(G1, G2), g_2 = _mm_packus_epi16(G3, G4), \
+			b_1 = _mm_packus_epi16(B1, B2), b_2 = _mm_packus_epi16(B3, B4); \
+		PACK_SAVE_RGB24_PTR_32(r_1, r_2, g_1, g_2, b_1, b_2, rgb_ptr##LINE) \
+	}
+
+// move the second of the two 6 bytes pixels of 64 bits lanes next to the first one
+#define RGB48_COMPACT_2(RGBX) _mm_or_si128(_mm_move_epi64(RGBX), _mm_slli_si128(_mm_srli_si128(RGBX, 8), 6))
+
+// interleave 8 pixels to rgb48, by pairs of pixels in 64 bits lanes (with a zero fourth channel which is then
+// removed), and save them at PTR
+#define PACK_SAVE_RGB48_8(R, G, B, PTR) \
+	{ \
+		const __m128i rg_lo = _mm_unpacklo_epi16(R, G), rg_hi = _mm_unpackhi_epi16(R, G), \
+			b_lo = _mm_unpacklo_epi16(B, _mm_setzero_si128()), b_hi = _mm_unpackhi_epi16(B, _mm_setzero_si128()); \
+		const __m128i rgb_1 = RGB48_COMPACT_2(_mm_unpacklo_epi32(rg_lo, b_lo)), \
+			rgb_2 = RGB48_COMPACT_2(_mm_unpackhi_epi32(rg_lo, b_lo)), \
+			rgb_3 = RGB48_COMPACT_2(_mm_unpacklo_epi32(rg_hi, b_hi)), \
+			rgb_4 = RGB48_COMPACT_2(_mm_unpackhi_epi32(rg_hi, b_hi)); \
+		SAVE_SI128((__m128i*)(PTR), _mm_or_si128(rgb_1, _mm_slli_si128(rgb_2, 12))); \
+		SAVE_SI128((__m128i*)(PTR+16), _mm_or_si128(_mm_srli_si128(rgb_2, 4), _mm_slli_si128(rgb_3, 8))); \
+		SAVE_SI128((__m128i*)(PTR+32), _mm_or_si128(_mm_srli_si128(rgb_3, 8), _mm_slli_si128(rgb_4, 4))); \
+	}
+
+#define PACK_SAVE16_RGB48_32(R1, R2, R3, R4, G1, G2, G3, G4, B1, B2, B3, B4, LINE) \
+	PACK_SAVE_RGB48_8(R1, G1, B1, rgb_ptr##LINE) \
+	PACK_SAVE_RGB48_8(R2, G2, B2, rgb_ptr##LINE+48) \
+	PACK_SAVE_RGB48_8(R3, G3, B3, rgb_ptr##LINE+96) \
+	PACK_SAVE_RGB48_8(R4, G4, B4, rgb_ptr##LINE+144)
+
+// save 8 pixels as 32 bits values, from their low (b and the low bits of g) and high 16 bits
+#define PACK_SAVE_X2RGB10_8(R, G, B, PTR) \
+	{ \
+		const __m128i lo = _mm_or_si128(B, _mm_slli_epi16(G, 10)), \
+			hi = _mm_or_si128(_mm_or_si128(_mm_srli_epi16(G, 6), _mm_slli_epi16(R, 4)), _mm_set1_epi16((short)0xC000)); \
+		SAVE_SI128((__m128i*)(PTR), _mm_unpacklo_epi16(lo, hi)); \
+		SAVE_SI128((__m128i*)(PTR+16), _mm_unpackhi_epi16(lo, hi)); \
+	}
+
+#define PACK_SAVE16_X2RGB10_32(R1, R2, R3, R4, G1, G2, G3, G4, B1, B2, B3, B4, LINE) \
+	PACK_SAVE_X2RGB10_8(R1, G1, B1, rgb_ptr##LINE) \
+	PACK_SAVE_X2RGB10_8(R2, G2, B2, rgb_ptr##LINE+32) \
+	PACK_SAVE_X2RGB10_8(R3, G3, B3, rgb_ptr##LINE+64) \
+	PACK_SAVE_X2RGB10_8(R4, G4, B4, rgb_ptr##LINE+96)
+
+// YUV420P10_RGB_SSE_FUNCTION(FORMAT, BPP, BITS, PACK_SAVE, SUFFIX) defines yuv420p10_<FORMAT>_<SUFFIX>, BITS being the
+// precision of the rgb values of FORMAT
+#define YUV420P10_RGB_SSE_FUNCTION(FORMAT, BPP, BITS, PACK_SAVE, SUFFIX) \
+void yuv420p10_##FORMAT##_##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint16_t *Y, const uint16_t *U, const uint16_t *V, uint32_t Y_stride, uint32_t UV_stride, \
+	uint8_t *RGB, uint32_t RGB_stride, \
+	YCbCrType yuv_type) \
+{ \
+	KERNEL_PARAM(YUV2RGB16Param, YUV2RGB16_##BITS) \
+	YUV2RGB16_SSE_FACTORS(BITS) \
+	\
+	uint32_t x, y; \
+	for(y=0; (y+1)<height; y+=2) \
+	{ \
+		const uint16_t *y_ptr1=BYTE_OFFSET(Y, y*Y_stride), \
+			*y_ptr2=BYTE_OFFSET(Y, (y+1)*Y_stride), \
+			*u_ptr=BYTE_OFFSET(U, (y/2)*UV_stride), \
+			*v_ptr=BYTE_OFFSET(V, (y/2)*UV_stride); \
+		\
+		uint8_t *rgb_ptr1=RGB+y*RGB_stride, \
+			*rgb_ptr2=RGB+(y+1)*RGB_stride; \
+		\
+		for(x=0; (x+31)<width; x+=32) \
+		{ \
+			YUV2RGB16_32(YUV420P10, BITS, PACK_SAVE) \
+			\
+			y_ptr1+=32; \
+			y_ptr2+=32; \
+			u_ptr+=16; \
+			v_ptr+=16; \
+			rgb_ptr1+=32*BPP; \
+			rgb_ptr2+=32*BPP; \
+		} \
+	} \
+	YUV420_RGB_TAIL(32, BPP, yuv420p10_##FORMAT##_sseu, yuv420p10_##FORMAT##_std) \
+}
+
+#define P010_RGB_SSE_FUNCTION(FORMAT, BPP, BITS, PACK_SAVE, SUFFIX) \
+void p010_##FORMAT##_##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint16_t *Y, const uint16_t *UV, uint32_t Y_stride, uint32_t UV_stride, \
+	uint8_t *RGB, uint32_t RGB_stride, \
+	YCbCrType yuv_type) \
+{ \
+	KERNEL_PARAM(YUV2RGB16Param, YUV2RGB16_##BITS) \
+	YUV2RGB16_SSE_FACTORS(BITS) \
+	\
+	uint32_t x, y; \
+	for(y=0; (y+1)<height; y+=2) \
+	{ \
+		const uint16_t *y_ptr1=BYTE_OFFSET(Y, y*Y_stride), \
+			*y_ptr2=BYTE_OFFSET(Y, (y+1)*Y_stride), \
+			*uv_ptr=BYTE_OFFSET(UV, (y/2)*UV_stride); \
+		\
+		uint8_t *rgb_ptr1=RGB+y*RGB_stride, \
+			*rgb_ptr2=RGB+(y+1)*RGB_stride; \
+		\
+		for(x=0; (x+31)<width; x+=32) \
+		{ \
+			YUV2RGB16_32(P010, BITS, PACK_SAVE) \
+			\
+			y_ptr1+=32; \
+			y_ptr2+=32; \
+			uv_ptr+=32; \
+			rgb_ptr1+=32*BPP; \
+			rgb_ptr2+=32*BPP; \
+		} \
+	} \
+	NV12_RGB_TAIL(32, BPP, p010_##FORMAT##_sseu, p010_##FORMAT##_std) \
+}
+
+#define YUV2RGB16_SSE_FUNCTIONS(FORMAT, BPP, BITS, PACK_SAVE, SUFFIX) \
+	YUV420P10_RGB_SSE_FUNCTION(FORMAT, BPP, BITS, PACK_SAVE, SUFFIX) \
+	P010_RGB_SSE_FUNCTION(FORMAT, BPP, BITS, PACK_SAVE, SUFFIX)
+
+#define YUV2RGB16_SSE_ALL_FORMATS(SUFFIX) \
+	YUV2RGB16_SSE_FUNCTIONS(rgb24, 3, 8, PACK_SAVE16_RGB24_32, SUFFIX) \
+	YUV2RGB16_SSE_FUNCTIONS(rgb48, 6, 16, PACK_SAVE16_RGB48_32, SUFFIX) \
+	YUV2RGB16_SSE_FUNCTIONS(x2rgb10, 4, 10, PACK_SAVE16_X2RGB10_32, SUFFIX)
+
+#define LOAD_SI128 _mm_load_si128
+#define SAVE_SI128 _mm_stream_si128
+YUV2RGB16_SSE_ALL_FORMATS(sse)
+#undef LOAD_SI128
+#undef SAVE_SI128
+
+#define LOAD_SI128 _mm_loadu_si128
+#define SAVE_SI128 _mm_storeu_si128
+YUV2RGB16_SSE_ALL_FORMATS(sseu)
+#undef LOAD_SI128
+#undef SAVE_SI128
+
+
+
+// 4:2:2 and 4:4:4 formats, see yuv422p_rgb24_std
+// Each block converts 32 pixels of a line. For yuv to rgb, the LOAD_YUV_<NAME>_32 macros load the y values in y1 and
+// y2, and the chroma values in u and v (16 values for 4:2:2) or u1, u2, v1 and v2 (32 values for 4:4:4). For rgb to
+// yuv, the SAVE_YUV_<NAME>_32 macros save the same registers.
+
+// pack the low or high bytes of the 16 bits values of A and B
+#define PACK_LOW_BYTES(A, B) _mm_packus_epi16(_mm_and_si128(A, _mm_set1_epi16(255)), _mm_and_si128(B, _mm_set1_epi16(255)))
+#define PACK_HIGH_BYTES(A, B) _mm_packus_epi16(_mm_srli_epi16(A, 8), _mm_srli_epi16(B, 8))
+
+#define LOAD_Y_LINE_32 \
+	const __m128i y1 = LOAD_SI128((const __m128i*)(y_ptr)), \
+		y2 = LOAD_SI128((const __m128i*)(y_ptr+16));
+
+#define LOAD_YUV_yuv422p_32 \
+	LOAD_Y_LINE_32 \
+	LOAD_UV_PLANAR
+
+#define LOAD_YUV_nv16_32 \
+	LOAD_Y_LINE_32 \
+	LOAD_UV_NV12
+
+// split 32 pixels of packed 4:2:2 data, Y_BYTES and C_BYTES selecting the bytes of the y and chroma values
+#define LOAD_YUV_PACKED_32(Y_BYTES, C_BYTES) \
+	const __m128i p1 = LOAD_SI128((const __m128i*)(yuv_ptr)), \
+		p2 = LOAD_SI128((const __m128i*)(yuv_ptr+16)), \
+		p3 = LOAD_SI128((const __m128i*)(yuv_ptr+32)), \
+		p4 = LOAD_SI128((const __m128i*)(yuv_ptr+48)); \
+	const __m128i y1 = Y_BYTES(p1, p2), y2 = Y_BYTES(p3, p4), \
+		c1 = C_BYTES(p1, p2), c2 = C_BYTES(p3, p4); \
+	__m128i u = PACK_LOW_BYTES(c1, c2), v = PACK_HIGH_BYTES(c1, c2);
+
+#define LOAD_YUV_yuyv_32 LOAD_YUV_PACKED_32(PACK_LOW_BYTES, PACK_HIGH_BYTES)
+#define LOAD_YUV_uyvy_32 LOAD_YUV_PACKED_32(PACK_HIGH_BYTES, PACK_LOW_BYTES)
+
+#define LOAD_YUV_yuv444p_32 \
+	LOAD_Y_LINE_32 \
+	__m128i u1 = LOAD_SI128((const __m128i*)(u_ptr)), \
+		u2 = LOAD_SI128((const __m128i*)(u_ptr+16)), \
+		v1 = LOAD_SI128((const __m128i*)(v_ptr)), \
+		v2 = LOAD_SI128((const __m128i*)(v_ptr+16));
+
+#define LOAD_YUV_nv24_32 \
+	LOAD_Y_LINE_32 \
+	const __m128i uv1 = LOAD_SI128((const __m128i*)(uv_ptr)), \
+		uv2 = LOAD_SI128((const __m128i*)(uv_ptr+16)), \
+		uv3 = LOAD_SI128((const __m128i*)(uv_ptr+32)), \
+		uv4 = LOAD_SI128((const __m128i*)(uv_ptr+48)); \
+	__m128i u1 = PACK_LOW_BYTES(uv1, uv2), u2 = PACK_LOW_BYTES(uv3, uv4), \
+		v1 = PACK_HIGH_BYTES(uv1, uv2), v2 = PACK_HIGH_BYTES(uv3, uv4);
+
+// offsets of 16 pixels sharing pairs of the first (UNPACK=_mm_unpacklo_epi8) or last 8 chroma values of U and V
+#define UV2RGB_422_16(U, V, UNPACK) \
+	u_16 = _mm_srai_epi16(UNPACK(U, U), 8); \
+	v_16 = _mm_srai_epi16(UNPACK(V, V), 8); \
+	UV2RGB_16(u_16, v_16, r_16_1, g_16_1, b_16_1, r_16_2, g_16_2, b_16_2)
+
+// offsets of the 16 pixels of the chroma values U and V
+#define UV2RGB_444_16(U, V) \
+	u_16 = _mm_srai_epi16(_mm_unpacklo_epi8(U, U), 8); \
+	v_16 = _mm_srai_epi16(_mm_unpacklo_epi8(V, V), 8); \
+	UV2RGB_8(u_16, v_16, r_16_1, g_16_1, b_16_1) \
+	u_16 = _mm_srai_epi16(_mm_unpackhi_epi8(U, U), 8); \
+	v_16 = _mm_srai_epi16(_mm_unpackhi_epi8(V, V), 8); \
+	UV2RGB_8(u_16, v_16, r_16_2, g_16_2, b_16_2)
+
+// add the 16 y values Y to the offsets, and pack the result to 8 bits in R, G and B
+#define Y2RGB_16(Y, R, G, B) \
+	{ \
+		const __m128i y = _mm_subs_epu8(Y, _mm_set1_epi8(param->y_offset)); \
+		__m128i y_16_1 = _mm_unpacklo_epi8(y, _mm_setzero_si128()), \
+			y_16_2 = _mm_unpackhi_epi8(y, _mm_setzero_si128()); \
+		ADD_Y2RGB_16(y_16_1, y_16_2, r_16_1, g_16_1, b_16_1, r_16_2, g_16_2, b_16_2) \
+		R = _mm_packus_epi16(r_16_1, r_16_2); \
+		G = _mm_packus_epi16(g_16_1, g_16_2); \
+		B = _mm_packus_epi16(b_16_1, b_16_2); \
+	}
+
+// convert the 32 pixels of the line, UV2RGB_1 and UV2RGB_2 computing the offsets of the first and last 16 pixels
+#define YUV2RGB_LINE_32(UV2RGB_1, UV2RGB_2, PACK_SAVE) \
+	__m128i u_16, v_16; \
+	__m128i r_16_1, g_16_1, b_16_1, r_16_2, g_16_2, b_16_2; \
+	__m128i r_8_1, g_8_1, b_8_1, r_8_2, g_8_2, b_8_2; \
+	UV2RGB_1 \
+	Y2RGB_16(y1, r_8_1, g_8_1, b_8_1) \
+	UV2RGB_2 \
+	Y2RGB_16(y2, r_8_2, g_8_2, b_8_2) \
+	PACK_SAVE(r_8_1, r_8_2, g_8_1, g_8_2, b_8_1, b_8_2, )
+
+#define YUV2RGB_422_32(PACK_SAVE) \
+	__m128i r_tmp, g_tmp, b_tmp; \
+	u = _mm_add_epi8(u, _mm_set1_epi8(-128)); \
+	v = _mm_add_epi8(v, _mm_set1_epi8(-128)); \
+	YUV2RGB_LINE_32(UV2RGB_422_16(u, v, _mm_unpacklo_epi8), UV2RGB_422_16(u, v, _mm_unpackhi_epi8), PACK_SAVE)
+
+#define YUV2RGB_444_32(PACK_SAVE) \
+	u1 = _mm_add_epi8(u1, _mm_set1_epi8(-128)); \
+	u2 = _mm_add_epi8(u2, _mm_set1_epi8(-128)); \
+	v1 = _mm_add_epi8(v1, _mm_set1_epi8(-128)); \
+	v2 = _mm_add_epi8(v2, _mm_set1_epi8(-128)); \
+	YUV2RGB_LINE_32(UV2RGB_444_16(u1, v1), UV2RGB_444_16(u2, v2), PACK_SAVE)
+
+// YUV_RGB_LINES_SSE_FUNCTION(NAME, SUBSAMPLING, FORMAT, BPP, PACK_SAVE, SUFFIX) defines <NAME>_<FORMAT>_<SUFFIX>, for
+// the 4:2:2 (SUBSAMPLING 422) or 4:4:4 (444) format NAME
+#define YUV_RGB_LINES_SSE_FUNCTION(NAME, SUBSAMPLING, FORMAT, BPP, PACK_SAVE, SUFFIX) \
+void NAME##_##FORMAT##_##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	YUV_PARAM_##NAME(const uint8_t), \
+	uint8_t *RGB, uint32_t RGB_stride, \
+	YCbCrType yuv_type) \
+{ \
+	KERNEL_PARAM(YUV2RGBParam, YUV2RGB) \
+	\
+	uint32_t x, y; \
+	for(y=0; y<height; ++y) \
+	{ \
+		YUV_LINE_##NAME(const uint8_t) \
+		uint8_t *rgb_ptr=RGB+y*RGB_stride; \
+		\
+		for(x=0; (x+31)<width; x+=32) \
+		{ \
+			LOAD_YUV_##NAME##_32 \
+			YUV2RGB_##SUBSAMPLING##_32(PACK_SAVE) \
+			\
+			YUV_ADVANCE_##NAME(32) \
+			rgb_ptr+=32*BPP; \
+		} \
+	} \
+	YUV_RGB_LINES_TAIL(32, BPP, SUBSAMPLING, NAME, NAME##_##FORMAT##_sseu, NAME##_##FORMAT##_std) \
+}
+
+// load 32 pixels of a line of rgb24 data at PTR, and split them in the 8 bits r, g and b values of the even (r_e, g_e and
+// b_e) and odd (r_o, g_o and b_o) pixels, by all steps of rgb.txt but the last one
+#define UNPACK_RGB24_LINE_32(PTR) \
+	__m128i rgb1 = LOAD_SI128((const __m128i*)(PTR)), \
+		rgb2 = LOAD_SI128((const __m128i*)(PTR+16)), \
+		rgb3 = LOAD_SI128((const __m128i*)(PTR+32)), \
+		rgb4 = LOAD_SI128((const __m128i*)(PTR+48)), \
+		rgb5 = LOAD_SI128((const __m128i*)(PTR+64)), \
+		rgb6 = LOAD_SI128((const __m128i*)(PTR+80)); \
+	__m128i tmp1, tmp2, tmp3, tmp4, tmp5, tmp6; \
+	UNPACK_RGB24_32_STEP(rgb1, rgb2, rgb3, rgb4, rgb5, rgb6, tmp1, tmp2, tmp3, tmp4, tmp5, tmp6) \
+	UNPACK_RGB24_32_STEP(tmp1, tmp2, tmp3, tmp4, tmp5, tmp6, rgb1, rgb2, rgb3, rgb4, rgb5, rgb6) \
+	UNPACK_RGB24_32_STEP(rgb1, rgb2, rgb3, rgb4, rgb5, rgb6, tmp1, tmp2, tmp3, tmp4, tmp5, tmp6) \
+	UNPACK_RGB24_32_STEP(tmp1, tmp2, tmp3, tmp4, tmp5, tmp6, rgb1, rgb2, rgb3, rgb4, rgb5, rgb6) \
+	const __m128i r_e = rgb1, g_e = rgb2, b_e = rgb3, r_o = rgb4, g_o = rgb5, b_o = rgb6;
+
+// same as UNPACK_RGB24_LINE_32 for rgb32 data, see rgba.txt
+#define UNPACK_RGB32_LINE_32(PTR) \
+	__m128i rgb1 = LOAD_SI128((const __m128i*)(PTR)), \
+		rgb2 = LOAD_SI128((const __m128i*)(PTR+16)), \
+		rgb3 = LOAD_SI128((const __m128i*)(PTR+32)), \
+		rgb4 = LOAD_SI128((const __m128i*)(PTR+48)), \
+		rgb5 = LOAD_SI128((const __m128i*)(PTR+64)), \
+		rgb6 = LOAD_SI128((const __m128i*)(PTR+80)), \
+		rgb7 = LOAD_SI128((const __m128i*)(PTR+96)), \
+		rgb8 = LOAD_SI128((const __m128i*)(PTR+112)); \
+	__m128i tmp1, tmp2, tmp3, tmp4, tmp5, tmp6, tmp7, tmp8; \
+	UNPACK_RGB32_32_STEP(rgb1, rgb2, rgb3, rgb4, rgb5, rgb6, rgb7, rgb8, tmp1, tmp2, tmp3, tmp4, tmp5, tmp6, tmp7, tmp8) \
+	UNPACK_RGB32_32_STEP(tmp1, tmp2, tmp3, tmp4, tmp5, tmp6, tmp7, tmp8, rgb1, rgb2, rgb3, rgb4, rgb5, rgb6, rgb7, rgb8) \
+	UNPACK_RGB32_32_STEP(rgb1, rgb2, rgb3, rgb4, rgb5, rgb6, rgb7, rgb8, tmp1, tmp2, tmp3, tmp4, tmp5, tmp6, tmp7, tmp8) \
+	UNPACK_RGB32_32_STEP(tmp1, tmp2, tmp3, tmp4, tmp5, tmp6, tmp7, tmp8, rgb1, rgb2, rgb3, rgb4, rgb5, rgb6, rgb7, rgb8) \
+	const __m128i r_e = rgb1, g_e = rgb2, b_e = rgb3, r_o = rgb5, g_o = rgb6, b_o = rgb7;
+
+// compute Y' of the 8 16 bits r, g and b values R, G and B
+#define RGB2Y_8(R, G, B) \
+	_mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(R, _mm_set1_epi16(param->r_factor)), \
+		_mm_mullo_epi16(G, _mm_set1_epi16(param->g_factor))), _mm_mullo_epi16(B, _mm_set1_epi16(param->b_factor))), 8)
+
+// compute the y values of 8 even and 8 odd pixels, from the first (UNPACK=_mm_unpacklo_epi8) or last 8 values of the
+// even and odd channels, and their (B-Y') and (R-Y') in CB_E, CR_E, CB_O and CR_O
+#define RGB2YUV_PAIRS_8(UNPACK, Y_E, Y_O, CB_E, CR_E, CB_O, CR_O) \
+	{ \
+		const __m128i r_e16 = UNPACK(r_e, _mm_setzero_si128()), g_e16 = UNPACK(g_e, _mm_setzero_si128()), \
+			b_e16 = UNPACK(b_e, _mm_setzero_si128()), r_o16 = UNPACK(r_o, _mm_setzero_si128()), \
+			g_o16 = UNPACK(g_o, _mm_setzero_si128()), b_o16 = UNPACK(b_o, _mm_setzero_si128()); \
+		Y_E = RGB2Y_8(r_e16, g_e16, b_e16); \
+		Y_O = RGB2Y_8(r_o16, g_o16, b_o16); \
+		CB_E = _mm_sub_epi16(b_e16, Y_E); \
+		CR_E = _mm_sub_epi16(r_e16, Y_E); \
+		CB_O = _mm_sub_epi16(b_o16, Y_O); \
+		CR_O = _mm_sub_epi16(r_o16, Y_O); \
+		Y_E = _mm_add_epi16(_mm_srli_epi16(_mm_mullo_epi16(Y_E, _mm_set1_epi16(param->y_factor)), 7), _mm_set1_epi16(param->y_offset)); \
+		Y_O = _mm_add_epi16(_mm_srli_epi16(_mm_mullo_epi16(Y_O, _mm_set1_epi16(param->y_factor)), 7), _mm_set1_epi16(param->y_offset)); \
+	}
+
+// chroma value of the (B-Y') or (R-Y') value C, or of the average of C1 and C2, FACTOR being cb_factor or cr_factor
+#define CHROMA_444_8(C, FACTOR) \
+	_mm_add_epi16(_mm_srai_epi16(_mm_mullo_epi16(C, _mm_set1_epi16(param->FACTOR)), 8), _mm_set1_epi16(128))
+#define CHROMA_422_8(C1, C2, FACTOR) CHROMA_444_8(_mm_srai_epi16(_mm_add_epi16(C1, C2), 1), FACTOR)
+
+// compute the y values of the 32 pixels of the line in y1 and y2, and their (B-Y') and (R-Y')
+#define RGB2YUV_LINE_32 \
+	__m128i y_e1, y_o1, cb_e1, cr_e1, cb_o1, cr_o1, y_e2, y_o2, cb_e2, cr_e2, cb_o2, cr_o2; \
+	RGB2YUV_PAIRS_8(_mm_unpacklo_epi8, y_e1, y_o1, cb_e1, cr_e1, cb_o1, cr_o1) \
+	RGB2YUV_PAIRS_8(_mm_unpackhi_epi8, y_e2, y_o2, cb_e2, cr_e2, cb_o2, cr_o2) \
+	const __m128i y_e = _mm_packus_epi16(y_e1, y_e2), y_o = _mm_packus_epi16(y_o1, y_o2); \
+	const __m128i y1 = _mm_unpacklo_epi8(y_e, y_o), y2 = _mm_unpackhi_epi8(y_e, y_o);
+
+#define RGB2YUV_422_32(SAVE) \
+	RGB2YUV_LINE_32 \
+	{ \
+		const __m128i u = _mm_packus_epi16(CHROMA_422_8(cb_e1, cb_o1, cb_factor), CHROMA_422_8(cb_e2, cb_o2, cb_factor)), \
+			v = _mm_packus_epi16(CHROMA_422_8(cr_e1, cr_o1, cr_factor), CHROMA_422_8(cr_e2, cr_o2, cr_factor)); \
+		SAVE \
+	}
+
+#define RGB2YUV_444_32(SAVE) \
+	RGB2YUV_LINE_32 \
+	{ \
+		const __m128i u_e = _mm_packus_epi16(CHROMA_444_8(cb_e1, cb_factor), CHROMA_444_8(cb_e2, cb_factor)), \
+			u_o = _mm_packus_epi16(CHROMA_444_8(cb_o1, cb_factor), CHROMA_444_8(cb_o2, cb_factor)), \
+			v_e = _mm_packus_epi16(CHROMA_444_8(cr_e1, cr_factor), CHROMA_444_8(cr_e2, cr_factor)), \
+			v_o = _mm_packus_epi16(CHROMA_444_8(cr_o1, cr_factor), CHROMA_444_8(cr_o2, cr_factor)); \
+		const __m128i u1 = _mm_unpacklo_epi8(u_e, u_o), u2 = _mm_unpackhi_epi8(u_e, u_o), \
+			v1 = _mm_unpacklo_epi8(v_e, v_o), v2 = _mm_unpackhi_epi8(v_e, v_o); \
+		SAVE \
+	}
+
+#define SAVE_Y_LINE_32 \
+	SAVE_SI128((__m128i*)(y_ptr), y1); \
+	SAVE_SI128((__m128i*)(y_ptr+16), y2);
+
+#define SAVE_YUV_yuv422p_32 \
+	SAVE_Y_LINE_32 \
+	SAVE_SI128((__m128i*)(u_ptr), u); \
+	SAVE_SI128((__m128i*)(v_ptr), v);
+
+#define SAVE_YUV_nv16_32 \
+	SAVE_Y_LINE_32 \
+	SAVE_SI128((__m128i*)(uv_ptr), _mm_unpacklo_epi8(u, v)); \
+	SAVE_SI128((__m128i*)(uv_ptr+16), _mm_unpackhi_epi8(u, v));
+
+// interleave the y values with the pairs of chroma values of packed 4:2:2 data, with UNPACK_YC(Y, C, UNPACK) giving
+// the order of the bytes
+#define SAVE_YUV_PACKED_32(UNPACK_YC) \
+	{ \
+		const __m128i c1 = _mm_unpacklo_epi8(u, v), c2 = _mm_unpackhi_epi8(u, v); \
+		SAVE_SI128((__m128i*)(yuv_ptr), UNPACK_YC(y1, c1, _mm_unpacklo_epi8)); \
+		SAVE_SI128((__m128i*)(yuv_ptr+16), UNPACK_YC(y1, c1, _mm_unpackhi_epi8)); \
+		SAVE_SI128((__m128i*)(yuv_ptr+32), UNPACK_YC(y2, c2, _mm_unpacklo_epi8)); \
+		SAVE_SI128((__m128i*)(yuv_ptr+48), UNPACK_YC(y2, c2, _mm_unpackhi_epi8)); \
+	}
+
+#define UNPACK_Y_FIRST(Y, C, UNPACK) UNPACK(Y, C)
+#define UNPACK_C_FIRST(Y, C, UNPACK) UNPACK(C, Y)
+#define SAVE_YUV_yuyv_32 SAVE_YUV_PACKED_32(UNPACK_Y_FIRST)
+#define SAVE_YUV_uyvy_32 SAVE_YUV_PACKED_32(UNPACK_C_FIRST)
+
+#define SAVE_YUV_yuv444p_32 \
+	SAVE_Y_LINE_32 \
+	SAVE_SI128((__m128i*)(u_ptr), u1); \
+	SAVE_SI128((__m128i*)(u_ptr+16), u2); \
+	SAVE_SI128((__m128i*)(v_ptr), v1); \
+	SAVE_SI128((__m128i*)(v_ptr+16), v2);
+
+#define SAVE_YUV_nv24_32 \
+	SAVE_Y_LINE_32 \
+	SAVE_SI128((__m128i*)(uv_ptr), _mm_unpacklo_epi8(u1, v1)); \
+	SAVE_SI128((__m128i*)(uv_ptr+16), _mm_unpackhi_epi8(u1, v1)); \
+	SAVE_SI128((__m128i*)(uv_ptr+32), _mm_unpacklo_epi8(u2, v2)); \
+	SAVE_SI128((__m128i*)(uv_ptr+48), _mm_unpackhi_epi8(u2, v2));
+
+// RGB_YUV_LINES_SSE_FUNCTION(FORMAT, BPP, UNPACK, NAME, SUBSAMPLING, SUFFIX) defines <FORMAT>_<NAME>_<SUFFIX>, for
+// UNPACK the matching rgb load (UNPACK_RGB24_LINE_32 or UNPACK_RGB32_LINE_32) and the 4:2:2 (SUBSAMPLING 422) or
+// 4:4:4 (444) format NAME
+#define RGB_YUV_LINES_SSE_FUNCTION(FORMAT, BPP, UNPACK, NAME, SUBSAMPLING, SUFFIX) \
+void FORMAT##_##NAME##_##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *RGB, uint32_t RGB_stride, \
+	YUV_PARAM_##NAME(uint8_t), \
+	YCbCrType yuv_type) \
+{ \
+	KERNEL_PARAM(RGB2YUVParam, RGB2YUV) \
+	\
+	uint32_t x, y; \
+	for(y=0; y<height; ++y) \
+	{ \
+		const uint8_t *rgb_ptr=RGB+y*RGB_stride; \
+		YUV_LINE_##NAME(uint8_t) \
+		\
+		for(x=0; (x+31)<width; x+=32) \
+		{ \
+			UNPACK(rgb_ptr) \
+			RGB2YUV_##SUBSAMPLING##_32(SAVE_YUV_##NAME##_32) \
+			\
+			rgb_ptr+=32*BPP; \
+			YUV_ADVANCE_##NAME(32) \
+		} \
+	} \
+	RGB_YUV_LINES_TAIL(32, BPP, SUBSAMPLING, NAME, FORMAT##_##NAME##_sseu, FORMAT##_##NAME##_std) \
+}
+
+#define YUV_LINES_SSE_FUNCTIONS(FORMAT, BPP, PACK_SAVE, UNPACK, SUFFIX) \
+	YUV_RGB_LINES_SSE_FUNCTION(yuv422p, 422, FORMAT, BPP, PACK_SAVE, SUFFIX) \
+	YUV_RGB_LINES_SSE_FUNCTION(nv16, 422, FORMAT, BPP, PACK_SAVE, SUFFIX) \
+	YUV_RGB_LINES_SSE_FUNCTION(yuyv, 422, FORMAT, BPP, PACK_SAVE, SUFFIX) \
+	YUV_RGB_LINES_SSE_FUNCTION(uyvy, 422, FORMAT, BPP, PACK_SAVE, SUFFIX) \
+	YUV_RGB_LINES_SSE_FUNCTION(yuv444p, 444, FORMAT, BPP, PACK_SAVE, SUFFIX) \
+	YUV_RGB_LINES_SSE_FUNCTION(nv24, 444, FORMAT, BPP, PACK_SAVE, SUFFIX) \
+	RGB_YUV_LINES_SSE_FUNCTION(FORMAT, BPP, UNPACK, yuv422p, 422, SUFFIX) \
+	RGB_YUV_LINES_SSE_FUNCTION(FORMAT, BPP, UNPACK, nv16, 422, SUFFIX) \
+	RGB_YUV_LINES_SSE_FUNCTION(FORMAT, BPP, UNPACK, yuyv, 422, SUFFIX) \
+	RGB_YUV_LINES_SSE_FUNCTION(FORMAT, BPP, UNPACK, uyvy, 422, SUFFIX) \
+	RGB_YUV_LINES_SSE_FUNCTION(FORMAT, BPP, UNPACK, yuv444p, 444, SUFFIX) \
+	RGB_YUV_LINES_SSE_FUNCTION(FORMAT, BPP, UNPACK, nv24, 444, SUFFIX)
+
+#define YUV_LINES_SSE_ALL_FORMATS(SUFFIX) \
+	YUV_LINES_SSE_FUNCTIONS(rgb24, 3, PACK_SAVE_RGB24_32, UNPACK_RGB24_LINE_32, SUFFIX) \
+	YUV_LINES_SSE_FUNCTIONS(rgb32, 4, PACK_SAVE_RGB32_32, UNPACK_RGB32_LINE_32, SUFFIX)
+
+#define LOAD_SI128 _mm_load_si128
+#define SAVE_SI128 _mm_stream_si128
+YUV_LINES_SSE_ALL_FORMATS(sse)
+#undef LOAD_SI128
+#undef SAVE_SI128
+
+#define LOAD_SI128 _mm_loadu_si128
+#define SAVE_SI128 _mm_storeu_si128
+YUV_LINES_SSE_ALL_FORMATS(sseu)
+#undef LOAD_SI128
+#undef SAVE_SI128
+
+
+// Bilinear chroma interpolation, see yuv420_rgb24_bilinear_std
+// Each block converts 32 pixels of the two lines of a pair. For each line, the chroma samples are first interpolated
+// vertically (3*nearest+other) in 16 bits, from three loads at chroma columns -1, 0 and +1 relative to the block, and
+// then horizontally, the even pixels using the previous column and the odd pixels the next one.
+// The loads and stores are unaligned, since the blocks start at odd chroma columns.
+
+// load 16 u and v samples at chroma column X of the chroma lines C (nearest) and O (other)
+#define LOAD_UV_BILINEAR_PLANAR(C, O, X, U_C, U_O, V_C, V_O) \
+	U_C = _mm_loadu_si128((const __m128i*)(u_##C+(X))); \
+	U_O = _mm_loadu_si128((const __m128i*)(u_##O+(X))); \
+	V_C = _mm_loadu_si128((const __m128i*)(v_##C+(X))); \
+	V_O = _mm_loadu_si128((const __m128i*)(v_##O+(X))); \
+
+// deinterleave 16 pairs of samples at PTR, the even samples in EVEN and the odd ones in ODD
+#define DEINTERLEAVE_UV_BILINEAR(PTR, EVEN, ODD) \
+	{ \
+		const __m128i uv1 = _mm_loadu_si128((const __m128i*)(PTR)), uv2 = _mm_loadu_si128((const __m128i*)((PTR)+16)); \
+		EVEN = _mm_packus_epi16(_mm_and_si128(uv1, _mm_set1_epi16(255)), _mm_and_si128(uv2, _mm_set1_epi16(255))); \
+		ODD = _mm_packus_epi16(_mm_srli_epi16(uv1, 8), _mm_srli_epi16(uv2, 8)); \
+	}
+
+#define LOAD_UV_BILINEAR_NV12(C, O, X, U_C, U_O, V_C, V_O) \
+	DEINTERLEAVE_UV_BILINEAR(u_##C+2*(X), U_C, V_C) \
+	DEINTERLEAVE_UV_BILINEAR(u_##O+2*(X), U_O, V_O) \
+
+#define LOAD_UV_BILINEAR_NV21(C, O, X, U_C, U_O, V_C, V_O) \
+	DEINTERLEAVE_UV_BILINEAR(v_##C+2*(X), V_C, U_C) \
+	DEINTERLEAVE_UV_BILINEAR(v_##O+2*(X), V_O, U_O) \
+
+// 16 bits vertical interpolation 3*C+O of 16 samples, in S1 (low half) and S2 (high half)
+#define BILINEAR_V_16(C, O, S1, S2) \
+	S1 = _mm_unpacklo_epi8(C, _mm_setzero_si128()); \
+	S2 = _mm_unpackhi_epi8(C, _mm_setzero_si128()); \
+	S1 = _mm_add_epi16(_mm_add_epi16(S1, _mm_add_epi16(S1, S1)), _mm_unpacklo_epi8(O, _mm_setzero_si128())); \
+	S2 = _mm_add_epi16(_mm_add_epi16(S2, _mm_add_epi16(S2, S2)), _mm_unpackhi_epi8(O, _mm_setzero_si128())); \
+
+// horizontal interpolation of 8 vertically interpolated samples Z, M and P being the previous and next samples,
+// giving the values of the 16 corresponding pixels in PIX1 and PIX2
+#define BILINEAR_H_16(M, Z, P, PIX1, PIX2) \
+	{ \
+		const __m128i z_3 = _mm_add_epi16(_mm_add_epi16(Z, _mm_add_epi16(Z, Z)), _mm_set1_epi16(8)); \
+		const __m128i left = _mm_srli_epi16(_mm_add_epi16(z_3, M), 4), right = _mm_srli_epi16(_mm_add_epi16(z_3, P), 4); \
+		PIX1 = _mm_unpacklo_epi16(left, right); \
+		PIX2 = _mm_unpackhi_epi16(left, right); \
+	}
+
+// compute the r, g and b offsets of 8 pixels from their 16 bits u and v values
+#define UV2RGB_8_BILINEAR(U, V, R, G, B) \
+	U = _mm_sub_epi16(U, _mm_set1_epi16(128)); \
+	V = _mm_sub_epi16(V, _mm_set1_epi16(128)); \
+	R = _mm_srai_epi16(_mm_mullo_epi16(V, _mm_set1_epi16(param->cr_factor)), 6); \
+	G = _mm_srai_epi16(_mm_add_epi16( \
+		_mm_mullo_epi16(U, _mm_set1_epi16(param->g_cb_factor)), \
+		_mm_mullo_epi16(V, _mm_set1_epi16(param->g_cr_factor))), 7); \
+	B = _mm_srai_epi16(_mm_mullo_epi16(U, _mm_set1_epi16(param->cb_factor)), 6); \
+
+// compute the 8 bits r, g and b values of 16 pixels from 8 interpolated u and v samples and their neighbours
+#define BILINEAR_RGB_16(UM, UZ, UP, VM, VZ, VP, Y_PTR, R, G, B) \
+	{ \
+		__m128i u_1, u_2, v_1, v_2, r_1, g_1, b_1, r_2, g_2, b_2; \
+		BILINEAR_H_16(UM, UZ, UP, u_1, u_2) \
+		BILINEAR_H_16(VM, VZ, VP, v_1, v_2) \
+		UV2RGB_8_BILINEAR(u_1, v_1, r_1, g_1, b_1) \
+		UV2RGB_8_BILINEAR(u_2, v_2, r_2, g_2, b_2) \
+		\
+		__m128i y = _mm_loadu_si128((const __m128i*)(Y_PTR)); \
+		y = _mm_subs_epu8(y, _mm_set1_epi8(param->y_offset)); \
+		__m128i y_1 = _mm_unpacklo_epi8(y, _mm_setzero_si128()); \
+		__m128i y_2 = _mm_unpackhi_epi8(y, _mm_setzero_si128()); \
+		ADD_Y2RGB_16(y_1, y_2, r_1, g_1, b_1, r_2, g_2, b_2) \
+		\
+		R = _mm_packus_epi16(r_1, r_2); \
+		G = _mm_packus_epi16(g_1, g_2); \
+		B = _mm_packus_epi16(b_1, b_2); \
+	}
+
+// convert the 32 pixels starting at column X of a line, from its nearest (C) and other (O) chroma lines
+#define BILINEAR_LINE_32(LOAD_UV, C, O, X, Y_PTR, RGB_PTR) \
+	{ \
+		__m128i uc_8, uo_8, vc_8, vo_8; \
+		__m128i um_1, um_2, uz_1, uz_2, up_1, up_2, vm_1, vm_2, vz_1, vz_2, vp_1, vp_2; \
+		LOAD_UV(C, O, (X)/2-1, uc_8, uo_8, vc_8, vo_8) \
+		BILINEAR_V_16(uc_8, uo_8, um_1, um_2) \
+		BILINEAR_V_16(vc_8, vo_8, vm_1, vm_2) \
+		LOAD_UV(C, O, (X)/2, uc_8, uo_8, vc_8, vo_8) \
+		BILINEAR_V_16(uc_8, uo_8, uz_1, uz_2) \
+		BILINEAR_V_16(vc_8, vo_8, vz_1, vz_2) \
+		LOAD_UV(C, O, (X)/2+1, uc_8, uo_8, vc_8, vo_8) \
+		BILINEAR_V_16(uc_8, uo_8, up_1, up_2) \
+		BILINEAR_V_16(vc_8, vo_8, vp_1, vp_2) \
+		\
+		__m128i r_8_1, g_8_1, b_8_1, r_8_2, g_8_2, b_8_2; \
+		BILINEAR_RGB_16(um_1, uz_1, up_1, vm_1, vz_1, vp_1, (Y_PTR)+(X), r_8_1, g_8_1, b_8_1) \
+		BILINEAR_RGB_16(um_2, uz_2, up_2, vm_2, vz_2, vp_2, (Y_PTR)+(X)+16, r_8_2, g_8_2, b_8_2) \
+		\
+		__m128i rgb_1, rgb_2, rgb_3, rgb_4, rgb_5, rgb_6; \
+		PACK_RGB24_32(r_8_1, r_8_2, g_8_1, g_8_2, b_8_1, b_8_2, rgb_1, rgb_2, rgb_3, rgb_4, rgb_5, rgb_6) \
+		_mm_storeu_si128((__m128i*)((RGB_PTR)+3*(X)), rgb_1); \
+		_mm_storeu_si128((__m128i*)((RGB_PTR)+3*(X)+16), rgb_2); \
+		_mm_storeu_si128((__m128i*)((RGB_PTR)+3*(X)+32), rgb_3); \
+		_mm_storeu_si128((__m128i*)((RGB_PTR)+3*(X)+48), rgb_4); \
+		_mm_storeu_si128((__m128i*)((RGB_PTR)+3*(X)+64), rgb_5); \
+		_mm_storeu_si128((__m128i*)((RGB_PTR)+3*(X)+80), rgb_6); \
+	}
+
+#define BILINEAR_32_PLANAR(X) \
+	BILINEAR_LINE_32(LOAD_UV_BILINEAR_PLANAR, c, p, X, y_ptr1, rgb_ptr1) \
+	BILINEAR_LINE_32(LOAD_UV_BILINEAR_PLANAR, c, n, X, y_ptr2, rgb_ptr2)
+
+#define BILINEAR_32_NV12(X) \
+	BILINEAR_LINE_32(LOAD_UV_BILINEAR_NV12, c, p, X, y_ptr1, rgb_ptr1) \
+	BILINEAR_LINE_32(LOAD_UV_BILINEAR_NV12, c, n, X, y_ptr2, rgb_ptr2)
+
+#define BILINEAR_32_NV21(X) \
+	BILINEAR_LINE_32(LOAD_UV_BILINEAR_NV21, c, p, X, y_ptr1, rgb_ptr1) \
+	BILINEAR_LINE_32(LOAD_UV_BILINEAR_NV21, c, n, X, y_ptr2, rgb_ptr2)
+
+void yuv420_rgb24_bilinear_sseu(
 	uint32_t width, uint32_t height, 
 	const uint8_t *Y, const uint8_t *U, const uint8_t *V, uint32_t Y_stride, uint32_t UV_stride, 
 	uint8_t *RGB, uint32_t RGB_stride, 
 	YCbCrType yuv_type)
 {
-	#define LOAD_SI128 _mm_load_si128
-	#define SAVE_SI128 _mm_stream_si128
-	const YUV2RGBParam *const param = &(YUV2RGB[yuv_type]);
-	
-	uint32_t x, y;
-	for(y=0; y<(height-1); y+=2)
-	{
-		const uint8_t *y_ptr1=Y+y*Y_stride,
-			*y_ptr2=Y+(y+1)*Y_stride,
-			*u_ptr=U+(y/2)*UV_stride,
-			*v_ptr=V+(y/2)*UV_stride;
-		
-		uint8_t *rgb_ptr1=RGB+y*RGB_stride,
-			*rgb_ptr2=RGB+(y+1)*RGB_stride;
-		
-		for(x=0; x<(width-31); x+=32)
-		{
-			YUV2RGB_32_PLANAR
-			
-			y_ptr1+=32;
-			y_ptr2+=32;
-			u_ptr+=16; 
-			v_ptr+=16;
-			rgb_ptr1+=96;
-			rgb_ptr2+=96;
-		}
-	}
-	#undef LOAD_SI128
-	#undef SAVE_SI128
+	YUV420_RGB_BILINEAR(32, U, V, 1, BILINEAR_32_PLANAR)
 }
 
-void yuv420_rgb24_sseu(
+void nv12_rgb24_bilinear_sseu(
 	uint32_t width, uint32_t height, 
-	const uint8_t *Y, const uint8_t *U, const uint8_t *V, uint32_t Y_stride, uint32_t UV_stride, 
+	const uint8_t *Y, const uint8_t *UV, uint32_t Y_stride, uint32_t UV_stride, 
 	uint8_t *RGB, uint32_t RGB_stride, 
 	YCbCrType yuv_type)
 {
-	#define LOAD_SI128 _mm_loadu_si128
-	#define SAVE_SI128 _mm_storeu_si128
-	const YUV2RGBParam *const param = &(YUV2RGB[yuv_type]);
-	
-	uint32_t x, y;
-	for(y=0; y<(height-1); y+=2)
-	{
-		const uint8_t *y_ptr1=Y+y*Y_stride,
-			*y_ptr2=Y+(y+1)*Y_stride,
-			*u_ptr=U+(y/2)*UV_stride,
-			*v_ptr=V+(y/2)*UV_stride;
-		
-		uint8_t *rgb_ptr1=RGB+y*RGB_stride,
-			*rgb_ptr2=RGB+(y+1)*RGB_stride;
-		
-		for(x=0; x<(width-31); x+=32)
-		{
-			YUV2RGB_32_PLANAR
-			
-			y_ptr1+=32;
-			y_ptr2+=32;
-			u_ptr+=16; 
-			v_ptr+=16;
-			rgb_ptr1+=96;
-			rgb_ptr2+=96;
-		}
-	}
-	#undef LOAD_SI128
-	#undef SAVE_SI128
+	YUV420_RGB_BILINEAR(32, UV, UV+1, 2, BILINEAR_32_NV12)
 }
 
-void nv12_rgb24_sse(
+void nv21_rgb24_bilinear_sseu(
 	uint32_t width, uint32_t height, 
 	const uint8_t *Y, const uint8_t *UV, uint32_t Y_stride, uint32_t UV_stride, 
 	uint8_t *RGB, uint32_t RGB_stride, 
 	YCbCrType yuv_type)
 {
-	#define LOAD_SI128 _mm_load_si128
-	#define SAVE_SI128 _mm_stream_si128
-	const YUV2RGBParam *const param = &(YUV2RGB[yuv_type]);
-	
-	uint32_t x, y;
-	for(y=0; y<(height-1); y+=2)
+	YUV420_RGB_BILINEAR(32, UV+1, UV, 2, BILINEAR_32_NV21)
+}
+
+// Direct yuv format conversions, see nv12_yuv420_std
+// The conversions between yuv420 formats process 16 chroma samples of a line (the y plane being copied with memcpy),
+// and the packed ones 32 pixels of a line or of a pair of lines.
+
+// split 16 pairs of interleaved samples at SRC, the first sample of each pair in DST1 and the second one in DST2
+#define SPLIT_PAIRS_16(SRC, DST1, DST2) \
+	{ \
+		const __m128i uv1 = LOAD_SI128((const __m128i*)(SRC)), \
+			uv2 = LOAD_SI128((const __m128i*)((SRC)+16)); \
+		SAVE_SI128((__m128i*)(DST1), PACK_LOW_BYTES(uv1, uv2)); \
+		SAVE_SI128((__m128i*)(DST2), PACK_HIGH_BYTES(uv1, uv2)); \
+	}
+
+// interleave 16 samples at SRC1 and SRC2 in 16 pairs at DST
+#define MERGE_PAIRS_16(SRC1, SRC2, DST) \
+	{ \
+		const __m128i s1 = LOAD_SI128((const __m128i*)(SRC1)), \
+			s2 = LOAD_SI128((const __m128i*)(SRC2)); \
+		SAVE_SI128((__m128i*)(DST), _mm_unpacklo_epi8(s1, s2)); \
+		SAVE_SI128((__m128i*)((DST)+16), _mm_unpackhi_epi8(s1, s2)); \
+	}
+
+// the semi planar lines are accessed from their first sample, v_src or v_dst for nv21
+#define CHROMA_SSE_nv12_yuv420(X) SPLIT_PAIRS_16(u_src+2*(X), u_dst+(X), v_dst+(X))
+#define CHROMA_SSE_nv21_yuv420(X) SPLIT_PAIRS_16(v_src+2*(X), v_dst+(X), u_dst+(X))
+#define CHROMA_SSE_yuv420_nv12(X) MERGE_PAIRS_16(u_src+(X), v_src+(X), u_dst+2*(X))
+#define CHROMA_SSE_yuv420_nv21(X) MERGE_PAIRS_16(v_src+(X), u_src+(X), v_dst+2*(X))
+
+// bytes of the y and chroma values of the packed formats, see LOAD_YUV_yuyv_32 and SAVE_YUV_yuyv_32
+#define Y_BYTES_yuyv PACK_LOW_BYTES
+#define C_BYTES_yuyv PACK_HIGH_BYTES
+#define UNPACK_YC_yuyv UNPACK_Y_FIRST
+#define Y_BYTES_uyvy PACK_HIGH_BYTES
+#define C_BYTES_uyvy PACK_LOW_BYTES
+#define UNPACK_YC_uyvy UNPACK_C_FIRST
+
+// save the 16 averaged pairs of chroma values c1 and c2 of the pixels starting at X
+#define SAVE_C_PAIRS_yuv420(X) \
+	SAVE_SI128((__m128i*)(u_dst+(X)/2), PACK_LOW_BYTES(c1, c2)); \
+	SAVE_SI128((__m128i*)(v_dst+(X)/2), PACK_HIGH_BYTES(c1, c2));
+
+#define SAVE_C_PAIRS_nv12(X) \
+	SAVE_SI128((__m128i*)(u_dst+(X)), c1); \
+	SAVE_SI128((__m128i*)(u_dst+(X)+16), c2);
+
+// split the 32 pixels starting at X of the lines src1 and src2 of the packed format SRC, the chroma values of the two
+// lines being averaged before being split
+#define UNPACK_LINES_32(SRC, DST, X) \
+	{ \
+		const __m128i p11 = LOAD_SI128((const __m128i*)(src1+2*(X))), \
+			p12 = LOAD_SI128((const __m128i*)(src1+2*(X)+16)), \
+			p13 = LOAD_SI128((const __m128i*)(src1+2*(X)+32)), \
+			p14 = LOAD_SI128((const __m128i*)(src1+2*(X)+48)), \
+			p21 = LOAD_SI128((const __m128i*)(src2+2*(X))), \
+			p22 = LOAD_SI128((const __m128i*)(src2+2*(X)+16)), \
+			p23 = LOAD_SI128((const __m128i*)(src2+2*(X)+32)), \
+			p24 = LOAD_SI128((const __m128i*)(src2+2*(X)+48)); \
+		SAVE_SI128((__m128i*)(y_dst1+(X)), Y_BYTES_##SRC(p11, p12)); \
+		SAVE_SI128((__m128i*)(y_dst1+(X)+16), Y_BYTES_##SRC(p13, p14)); \
+		SAVE_SI128((__m128i*)(y_dst2+(X)), Y_BYTES_##SRC(p21, p22)); \
+		SAVE_SI128((__m128i*)(y_dst2+(X)+16), Y_BYTES_##SRC(p23, p24)); \
+		const __m128i c1 = C_BYTES_##SRC(_mm_avg_epu8(p11, p21), _mm_avg_epu8(p12, p22)), \
+			c2 = C_BYTES_##SRC(_mm_avg_epu8(p13, p23), _mm_avg_epu8(p14, p24)); \
+		SAVE_C_PAIRS_##DST(X) \
+	}
+
+#define PACKED_SSE_yuyv_yuv420(X) UNPACK_LINES_32(yuyv, yuv420, X)
+#define PACKED_SSE_uyvy_yuv420(X) UNPACK_LINES_32(uyvy, yuv420, X)
+#define PACKED_SSE_yuyv_nv12(X) UNPACK_LINES_32(yuyv, nv12, X)
+#define PACKED_SSE_uyvy_nv12(X) UNPACK_LINES_32(uyvy, nv12, X)
+
+// load the 16 pairs of chroma values of the pixels starting at X in c1 and c2
+#define LOAD_C_PAIRS_yuv420(X) \
+	const __m128i u = LOAD_SI128((const __m128i*)(u_src+(X)/2)), \
+		v = LOAD_SI128((const __m128i*)(v_src+(X)/2)), \
+		c1 = _mm_unpacklo_epi8(u, v), c2 = _mm_unpackhi_epi8(u, v);
+
+#define LOAD_C_PAIRS_nv12(X) \
+	const __m128i c1 = LOAD_SI128((const __m128i*)(u_src+(X))), \
+		c2 = LOAD_SI128((const __m128i*)(u_src+(X)+16));
+
+// interleave the 32 y values starting at X of the line y_src with their chroma pairs, in the line dst of the packed
+// format DST
+#define PACK_LINE_32(SRC, DST, X) \
+	{ \
+		const __m128i y1 = LOAD_SI128((const __m128i*)(y_src+(X))), \
+			y2 = LOAD_SI128((const __m128i*)(y_src+(X)+16)); \
+		LOAD_C_PAIRS_##SRC(X) \
+		SAVE_SI128((__m128i*)(dst+2*(X)), UNPACK_YC_##DST(y1, c1, _mm_unpacklo_epi8)); \
+		SAVE_SI128((__m128i*)(dst+2*(X)+16), UNPACK_YC_##DST(y1, c1, _mm_unpackhi_epi8)); \
+		SAVE_SI128((__m128i*)(dst+2*(X)+32), UNPACK_YC_##DST(y2, c2, _mm_unpacklo_epi8)); \
+		SAVE_SI128((__m128i*)(dst+2*(X)+48), UNPACK_YC_##DST(y2, c2, _mm_unpackhi_epi8)); \
+	}
+
+#define PACKED_SSE_yuv420_yuyv(X) PACK_LINE_32(yuv420, yuyv, X)
+#define PACKED_SSE_yuv420_uyvy(X) PACK_LINE_32(yuv420, uyvy, X)
+#define PACKED_SSE_nv12_yuyv(X) PACK_LINE_32(nv12, yuyv, X)
+#define PACKED_SSE_nv12_uyvy(X) PACK_LINE_32(nv12, uyvy, X)
+
+// YUV_DIRECT_SSE_FUNCTION(SRC, DST, N, CONVERT, BLOCK, SUFFIX) defines <SRC>_<DST>_<SUFFIX>, CONVERT being one of
+// the *_CONVERT macros of yuv_rgb_internal.h
+#define YUV_DIRECT_SSE_FUNCTION(SRC, DST, N, CONVERT, BLOCK, SUFFIX) \
+void SRC##_##DST##_##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	SRC_PARAM_##SRC, \
+	DST_PARAM_##DST) \
+{ \
+	CONVERT(N, SRC, DST, BLOCK##_##SRC##_##DST) \
+}
+
+#define YUV_DIRECT_SSE_FUNCTIONS(SUFFIX) \
+	YUV_DIRECT_SSE_FUNCTION(nv12, yuv420, 16, YUV420_CHROMA_CONVERT, CHROMA_SSE, SUFFIX) \
+	YUV_DIRECT_SSE_FUNCTION(nv21, yuv420, 16, YUV420_CHROMA_CONVERT, CHROMA_SSE, SUFFIX) \
+	YUV_DIRECT_SSE_FUNCTION(yuv420, nv12, 16, YUV420_CHROMA_CONVERT, CHROMA_SSE, SUFFIX) \
+	YUV_DIRECT_SSE_FUNCTION(yuv420, nv21, 16, YUV420_CHROMA_CONVERT, CHROMA_SSE, SUFFIX) \
+	YUV_DIRECT_SSE_FUNCTION(yuyv, yuv420, 32, PACKED_YUV420_CONVERT, PACKED_SSE, SUFFIX) \
+	YUV_DIRECT_SSE_FUNCTION(uyvy, yuv420, 32, PACKED_YUV420_CONVERT, PACKED_SSE, SUFFIX) \
+	YUV_DIRECT_SSE_FUNCTION(yuyv, nv12, 32, PACKED_YUV420_CONVERT, PACKED_SSE, SUFFIX) \
+	YUV_DIRECT_SSE_FUNCTION(uyvy, nv12, 32, PACKED_YUV420_CONVERT, PACKED_SSE, SUFFIX) \
+	YUV_DIRECT_SSE_FUNCTION(yuv420, yuyv, 32, YUV420_PACKED_CONVERT, PACKED_SSE, SUFFIX) \
+	YUV_DIRECT_SSE_FUNCTION(yuv420, uyvy, 32, YUV420_PACKED_CONVERT, PACKED_SSE, SUFFIX) \
+	YUV_DIRECT_SSE_FUNCTION(nv12, yuyv, 32, YUV420_PACKED_CONVERT, PACKED_SSE, SUFFIX) \
+	YUV_DIRECT_SSE_FUNCTION(nv12, uyvy, 32, YUV420_PACKED_CONVERT, PACKED_SSE, SUFFIX)
+
+#define LOAD_SI128 _mm_load_si128
+#define SAVE_SI128 _mm_stream_si128
+YUV_DIRECT_SSE_FUNCTIONS(sse)
+#undef LOAD_SI128
+#undef SAVE_SI128
+
+#define LOAD_SI128 _mm_loadu_si128
+#define SAVE_SI128 _mm_storeu_si128
+YUV_DIRECT_SSE_FUNCTIONS(sseu)
+#undef LOAD_SI128
+#undef SAVE_SI128
+
+#endif //_YUVRGB_SSE2_
+
+// Runtime dispatch
+//
+// The avx2 and avx512 implementations are compiled in their own files, with the corresponding compiler flags
+// (see yuv_rgb_avx2.c and yuv_rgb_avx512.c), and are only called if the cpu supports them.
+// The cpu features are detected once, with cpuid, and xgetbv to check that the os saves the ymm/zmm registers.
+// The aligned implementations, with streaming stores, are only called if the store policy selects them (see
+// yuv_rgb_set_store_policy), and are followed by an sfence. The last level cache size used by the automatic policy is
+// also detected once, with cpuid.
+// Since every implementation converts the whole image, the widest implementation supported by the cpu is called
+// for the whole image, if the image is at least as wide as its blocks.
+// On aarch64, the neon implementation (see yuv_rgb_neon.c) is selected at compile time.
+
+#if defined(_YUVRGB_SSE2_) && (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86))
+#define _YUVRGB_CPUID_
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+#define CPU_FEATURE_AVX2 1
+#define CPU_FEATURE_AVX512 2
+
+#ifdef _YUVRGB_CPUID_
+static void cpuid(uint32_t leaf, uint32_t subleaf, uint32_t regs[4])
+{
+#ifdef _MSC_VER
+	int r[4];
+	__cpuidex(r, leaf, subleaf);
+	regs[0]=r[0]; regs[1]=r[1]; regs[2]=r[2]; regs[3]=r[3];
+#else
+	__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+static uint64_t xgetbv0(void)
+{
+#ifdef _MSC_VER
+	return _xgetbv(0);
+#else
+	uint32_t eax, edx;
+	__asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+	return ((uint64_t)edx<<32) | eax;
+#endif
+}
+#endif
+
+static int cpu_features(void)
+{
+	// computed on first call, concurrent first calls compute the same value
+	static volatile int features = -1;
+	if(features<0)
 	{
-		const uint8_t *y_ptr1=Y+y*Y_stride,
-			*y_ptr2=Y+(y+1)*Y_stride,
-			*uv_ptr=UV+(y/2)*UV_stride;
-		
-		uint8_t *rgb_ptr1=RGB+y*RGB_stride,
-			*rgb_ptr2=RGB+(y+1)*RGB_stride;
-		
-		for(x=0; x<(width-31); x+=32)
+		int detected = 0;
+#ifdef _YUVRGB_CPUID_
+		uint32_t regs[4];
+		cpuid(0, 0, regs);
+		const uint32_t max_leaf = regs[0];
+		cpuid(1, 0, regs);
+		// osxsave and avx bits
+		if(max_leaf>=7 && (regs[2] & (1u<<27)) && (regs[2] & (1u<<28)))
 		{
-			YUV2RGB_32_NV12
-			
-			y_ptr1+=32;
-			y_ptr2+=32;
-			uv_ptr+=32; 
-			rgb_ptr1+=96;
-			rgb_ptr2+=96;
+			const uint64_t xcr0 = xgetbv0();
+			cpuid(7, 0, regs);
+			// xmm and ymm state
+			if((xcr0 & 0x6)==0x6 && (regs[1] & (1u<<5)))
+				detected |= CPU_FEATURE_AVX2;
+			// opmask, zmm and hi16 zmm state, avx512f and avx512bw bits
+			if((xcr0 & 0xE6)==0xE6 && (regs[1] & (1u<<16)) && (regs[1] & (1u<<30)))
+				detected |= CPU_FEATURE_AVX512;
 		}
+#endif
+		features = detected;
 	}
-	#undef LOAD_SI128
-	#undef SAVE_SI128
+	return features;
 }
 
-void nv12_rgb24_sseu(
-	uint32_t width, uint32_t height, 
-	const uint8_t *Y, const uint8_t *UV, uint32_t Y_stride, uint32_t UV_stride, 
-	uint8_t *RGB, uint32_t RGB_stride, 
-	YCbCrType yuv_type)
+static volatile int store_policy = YUVRGB_STORE_AUTO;
+
+void yuv_rgb_set_store_policy(YUVRGBStorePolicy policy)
 {
-	#define LOAD_SI128 _mm_loadu_si128
-	#define SAVE_SI128 _mm_storeu_si128
-	const YUV2RGBParam *const param = &(YUV2RGB[yuv_type]);
-	
-	uint32_t x, y;
-	for(y=0; y<(height-1); y+=2)
+	store_policy = policy;
+}
+
+YUVRGBStorePolicy yuv_rgb_get_store_policy(void)
+{
+	return (YUVRGBStorePolicy)store_policy;
+}
+
+#ifdef _YUVRGB_SSE2_
+#ifdef _YUVRGB_CPUID_
+// largest data or unified cache described by the deterministic cache parameters of leaf (4 for intel, 0x8000001D
+// for amd)
+static uint64_t cpuid_cache_size(uint32_t leaf)
+{
+	uint64_t size = 0;
+	uint32_t regs[4], i;
+	for(i=0; i<16; ++i)
 	{
-		const uint8_t *y_ptr1=Y+y*Y_stride,
-			*y_ptr2=Y+(y+1)*Y_stride,
-			*uv_ptr=UV+(y/2)*UV_stride;
-		
-		uint8_t *rgb_ptr1=RGB+y*RGB_stride,
-			*rgb_ptr2=RGB+(y+1)*RGB_stride;
-		
-		for(x=0; x<(width-31); x+=32)
+		cpuid(leaf, i, regs);
+		const uint32_t type = regs[0] & 0x1F;
+		if(type==0)
+			break;
+		if(type!=2)
 		{
-			YUV2RGB_32_NV12
-			
-			y_ptr1+=32;
-			y_ptr2+=32;
-			uv_ptr+=32; 
-			rgb_ptr1+=96;
-			rgb_ptr2+=96;
+			// ways * partitions * line size * sets
+			const uint64_t cache_size = (uint64_t)((regs[1]>>22)+1) * (((regs[1]>>12)&0x3FF)+1) *
+				((regs[1]&0xFFF)+1) * ((uint64_t)regs[2]+1);
+			if(cache_size>size)
+				size = cache_size;
 		}
 	}
-	#undef LOAD_SI128
-	#undef SAVE_SI128
+	return size;
 }
+#endif
 
-void nv21_rgb24_sse(
-	uint32_t width, uint32_t height, 
-	const uint8_t *Y, const uint8_t *UV, uint32_t Y_stride, uint32_t UV_stride, 
-	uint8_t *RGB, uint32_t RGB_stride, 
-	YCbCrType yuv_type)
+// size of the last level cache in bytes, 8MB if it is unknown
+static uint64_t llc_size(void)
 {
-	#define LOAD_SI128 _mm_load_si128
-	#define SAVE_SI128 _mm_stream_si128
-	const YUV2RGBParam *const param = &(YUV2RGB[yuv_type]);
-	
-	uint32_t x, y;
-	for(y=0; y<(height-1); y+=2)
+	// computed on first call, concurrent first calls compute the same value
+	static volatile uint64_t size = 0;
+	if(size==0)
 	{
-		const uint8_t *y_ptr1=Y+y*Y_stride,
-			*y_ptr2=Y+(y+1)*Y_stride,
-			*uv_ptr=UV+(y/2)*UV_stride;
-		
-		uint8_t *rgb_ptr1=RGB+y*RGB_stride,
-			*rgb_ptr2=RGB+(y+1)*RGB_stride;
-		
-		for(x=0; x<(width-31); x+=32)
+		uint64_t detected = 0;
+#ifdef _YUVRGB_CPUID_
+		uint32_t regs[4];
+		cpuid(0, 0, regs);
+		if(regs[0]>=4)
+			detected = cpuid_cache_size(4);
+		cpuid(0x80000000, 0, regs);
+		const uint32_t max_extended_leaf = regs[0];
+		if(detected==0 && max_extended_leaf>=0x8000001D)
+			detected = cpuid_cache_size(0x8000001D);
+		if(detected==0 && max_extended_leaf>=0x80000006)
 		{
-			YUV2RGB_32_NV21
-			
-			y_ptr1+=32;
-			y_ptr2+=32;
-			uv_ptr+=32; 
-			rgb_ptr1+=96;
-			rgb_ptr2+=96;
+			// l3 size in 512KB units, or l2 size in KB
+			cpuid(0x80000006, 0, regs);
+			detected = (regs[3]>>18) ? (uint64_t)(regs[3]>>18)*512*1024 : (uint64_t)(regs[2]>>16)*1024;
 		}
+#endif
+		size = detected ? detected : 8*1024*1024;
+	}
+	return size;
+}
+
+// whether an output of OUTPUT bytes should be written with streaming stores under policy
+static int stream_stores(YUVRGBStorePolicy policy, uint64_t output)
+{
+	switch(policy)
+	{
+		case YUVRGB_STORE_STREAM:
+			return 1;
+		case YUVRGB_STORE_CACHED:
+			return 0;
+		default:
+			// the input also needs to stay in cache
+			return output > llc_size()/2;
+	}
+}
+#endif
+
+YUVRGBStorePolicy yuv_rgb_output_store_policy(uint64_t output)
+{
+#ifdef _YUVRGB_SSE2_
+	return stream_stores((YUVRGBStorePolicy)store_policy, output) ? YUVRGB_STORE_STREAM : YUVRGB_STORE_CACHED;
+#else
+	(void)output;
+	return YUVRGB_STORE_CACHED;
+#endif
+}
+
+uint32_t yuv_rgb_block_width(void)
+{
+	const int features = cpu_features();
+	(void)features;
+#if USE_AVX512
+	if(features & CPU_FEATURE_AVX512)
+		return 128;
+#endif
+#if USE_AVX2
+	if(features & CPU_FEATURE_AVX2)
+		return 64;
+#endif
+#if defined(_YUVRGB_SSE2_)
+	return 32;
+#elif defined(_YUVRGB_NEON_)
+	return 16;
+#else
+	return 2;
+#endif
+}
+
+#define IS_ALIGNED(PTR, STRIDE, N) (((((uintptr_t)(PTR)) | (STRIDE)) % (N)) == 0)
+
+// INSTRUMENTED_CALL(KERNEL, ARGS) calls the implementation KERNEL selected by a dispatch function, counting the call
+// and the width x height pixels in a counter of this call site when the library is built with instrumentation (see
+// yuv_rgb_instrument.c)
+#if USE_INSTRUMENTATION
+#define INSTRUMENTED_CALL(KERNEL, ARGS) \
+	{ \
+		static YUVRGBCounter counter = {#KERNEL, 0, 0, 0, 0, NULL}; \
+		const uint64_t start = yuv_rgb_instrument_begin(&counter, width, height); \
+		KERNEL ARGS; \
+		yuv_rgb_instrument_end(&counter, width, height, start); \
+	}
+#else
+#define INSTRUMENTED_CALL(KERNEL, ARGS) KERNEL ARGS;
+#endif
+
+// YUV2RGB_DISPATCH_* and RGB2YUV_DISPATCH_* call the implementation of the corresponding isa and return, if it is
+// supported by the cpu and the image is wide enough for it, ARGS being the arguments of the function, OUTPUT the
+// size of its output in bytes and POLICY the store policy deciding from it whether streaming stores are used.
+// The image is otherwise converted by the next (narrower) implementation.
+
+#if USE_AVX512
+#define DISPATCH_AVX512(NAME, ALIGNED, OUTPUT, POLICY, ARGS) \
+	if((features & CPU_FEATURE_AVX512) && width>=128) \
+	{ \
+		if(ALIGNED(64) && stream_stores(POLICY, OUTPUT)) \
+		{ \
+			INSTRUMENTED_CALL(NAME##_avx512, ARGS) \
+			_mm_sfence(); \
+		} \
+		else \
+			INSTRUMENTED_CALL(NAME##_avx512u, ARGS) \
+		return; \
+	}
+#else
+#define DISPATCH_AVX512(NAME, ALIGNED, OUTPUT, POLICY, ARGS)
+#endif
+
+#if USE_AVX2
+#define DISPATCH_AVX2(NAME, ALIGNED, OUTPUT, POLICY, ARGS) \
+	if((features & CPU_FEATURE_AVX2) && width>=64) \
+	{ \
+		if(ALIGNED(32) && stream_stores(POLICY, OUTPUT)) \
+		{ \
+			INSTRUMENTED_CALL(NAME##_avx2, ARGS) \
+			_mm_sfence(); \
+		} \
+		else \
+			INSTRUMENTED_CALL(NAME##_avx2u, ARGS) \
+		return; \
 	}
-	#undef LOAD_SI128
-	#undef SAVE_SI128
+#else
+#define DISPATCH_AVX2(NAME, ALIGNED, OUTPUT, POLICY, ARGS)
+#endif
+
+// last implementation, always available
+#if defined(_YUVRGB_SSE2_)
+#define DISPATCH_DEFAULT(NAME, ALIGNED, OUTPUT, POLICY, ARGS) \
+	if(ALIGNED(16) && stream_stores(POLICY, OUTPUT)) \
+	{ \
+		INSTRUMENTED_CALL(NAME##_sse, ARGS) \
+		_mm_sfence(); \
+	} \
+	else \
+		INSTRUMENTED_CALL(NAME##_sseu, ARGS)
+#elif defined(_YUVRGB_NEON_)
+#define DISPATCH_DEFAULT(NAME, ALIGNED, OUTPUT, POLICY, ARGS) \
+	INSTRUMENTED_CALL(NAME##_neon, ARGS)
+#else
+#define DISPATCH_DEFAULT(NAME, ALIGNED, OUTPUT, POLICY, ARGS) \
+	INSTRUMENTED_CALL(NAME##_std, ARGS)
+#endif
+
+// output sizes of the rgb, planar rgb and yuv420 images
+#define RGB_OUTPUT ((uint64_t)RGB_stride*height)
+#define RGB_PLANAR_OUTPUT (3*(uint64_t)RGB_stride*height)
+#define YUV420_OUTPUT ((uint64_t)Y_stride*height + (uint64_t)UV_stride*(height+1))
+
+#define YUV420_ALIGNED(N) (IS_ALIGNED(Y, Y_stride, N) && IS_ALIGNED(U, UV_stride, N) && IS_ALIGNED(V, UV_stride, N) && IS_ALIGNED(RGB, RGB_stride, N))
+#define YUV420_ARGS (width, height, Y, U, V, Y_stride, UV_stride, RGB, RGB_stride, yuv_type)
+
+void yuv420_rgb24_policy(
+	uint32_t width, uint32_t height, 
+	const uint8_t *Y, const uint8_t *U, const uint8_t *V, uint32_t Y_stride, uint32_t UV_stride, 
+	uint8_t *RGB, uint32_t RGB_stride, 
+	YCbCrType yuv_type, YUVRGBStorePolicy policy)
+{
+	const int features = cpu_features();
+	(void)features;
+	(void)policy;
+	DISPATCH_AVX512(yuv420_rgb24, YUV420_ALIGNED, RGB_OUTPUT, policy, YUV420_ARGS)
+	DISPATCH_AVX2(yuv420_rgb24, YUV420_ALIGNED, RGB_OUTPUT, policy, YUV420_ARGS)
+	DISPATCH_DEFAULT(yuv420_rgb24, YUV420_ALIGNED, RGB_OUTPUT, policy, YUV420_ARGS)
+}
+
+void yuv420_rgb24(
+	uint32_t width, uint32_t height, 
+	const uint8_t *Y, const uint8_t *U, const uint8_t *V, uint32_t Y_stride, uint32_t UV_stride, 
+	uint8_t *RGB, uint32_t RGB_stride, 
+	YCbCrType yuv_type)
+{
+	yuv420_rgb24_policy(width, height, Y, U, V, Y_stride, UV_stride, RGB, RGB_stride, yuv_type,
+		(YUVRGBStorePolicy)store_policy);
+}
+
+#define NV12_ALIGNED(N) (IS_ALIGNED(Y, Y_stride, N) && IS_ALIGNED(UV, UV_stride, N) && IS_ALIGNED(RGB, RGB_stride, N))
+#define NV12_ARGS (width, height, Y, UV, Y_stride, UV_stride, RGB, RGB_stride, yuv_type)
+
+// NV12_DISPATCH(nv12) and NV12_DISPATCH(nv21) define the dispatch functions of the two semi planar formats
+#define NV12_DISPATCH(NAME) \
+void NAME##_rgb24_policy( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *Y, const uint8_t *UV, uint32_t Y_stride, uint32_t UV_stride, \
+	uint8_t *RGB, uint32_t RGB_stride, \
+	YCbCrType yuv_type, YUVRGBStorePolicy policy) \
+{ \
+	const int features = cpu_features(); \
+	(void)features; \
+	(void)policy; \
+	DISPATCH_AVX512(NAME##_rgb24, NV12_ALIGNED, RGB_OUTPUT, policy, NV12_ARGS) \
+	DISPATCH_AVX2(NAME##_rgb24, NV12_ALIGNED, RGB_OUTPUT, policy, NV12_ARGS) \
+	DISPATCH_DEFAULT(NAME##_rgb24, NV12_ALIGNED, RGB_OUTPUT, policy, NV12_ARGS) \
+} \
+\
+void NAME##_rgb24( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *Y, const uint8_t *UV, uint32_t Y_stride, uint32_t UV_stride, \
+	uint8_t *RGB, uint32_t RGB_stride, \
+	YCbCrType yuv_type) \
+{ \
+	NAME##_rgb24_policy(width, height, Y, UV, Y_stride, UV_stride, RGB, RGB_stride, yuv_type, \
+		(YUVRGBStorePolicy)store_policy); \
+}
+
+NV12_DISPATCH(nv12)
+NV12_DISPATCH(nv21)
+
+// FORMAT_NV12_DISPATCH(NAME, FORMAT) defines the dispatch functions of the semi planar format NAME to FORMAT
+#define FORMAT_NV12_DISPATCH(NAME, FORMAT) \
+void NAME##_##FORMAT##_policy( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *Y, const uint8_t *UV, uint32_t Y_stride, uint32_t UV_stride, \
+	uint8_t *RGB, uint32_t RGB_stride, \
+	YCbCrType yuv_type, YUVRGBStorePolicy policy) \
+{ \
+	(void)policy; \
+	DISPATCH_DEFAULT(NAME##_##FORMAT, NV12_ALIGNED, RGB_OUTPUT, policy, NV12_ARGS) \
+} \
+\
+void NAME##_##FORMAT( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *Y, const uint8_t *UV, uint32_t Y_stride, uint32_t UV_stride, \
+	uint8_t *RGB, uint32_t RGB_stride, \
+	YCbCrType yuv_type) \
+{ \
+	NAME##_##FORMAT##_policy(width, height, Y, UV, Y_stride, UV_stride, RGB, RGB_stride, yuv_type, \
+		(YUVRGBStorePolicy)store_policy); \
+}
+
+// FORMAT_DISPATCH(FORMAT) defines the dispatch functions of the other rgb formats of yuv to rgb conversions
+// there is no avx2 or avx512 implementation of these formats
+#define FORMAT_DISPATCH(FORMAT) \
+void yuv420_##FORMAT##_policy( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *Y, const uint8_t *U, const uint8_t *V, uint32_t Y_stride, uint32_t UV_stride, \
+	uint8_t *RGB, uint32_t RGB_stride, \
+	YCbCrType yuv_type, YUVRGBStorePolicy policy) \
+{ \
+	(void)policy; \
+	DISPATCH_DEFAULT(yuv420_##FORMAT, YUV420_ALIGNED, RGB_OUTPUT, policy, YUV420_ARGS) \
+} \
+\
+void yuv420_##FORMAT( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *Y, const uint8_t *U, const uint8_t *V, uint32_t Y_stride, uint32_t UV_stride, \
+	uint8_t *RGB, uint32_t RGB_stride, \
+	YCbCrType yuv_type) \
+{ \
+	yuv420_##FORMAT##_policy(width, height, Y, U, V, Y_stride, UV_stride, RGB, RGB_stride, yuv_type, \
+		(YUVRGBStorePolicy)store_policy); \
+} \
+\
+FORMAT_NV12_DISPATCH(nv12, FORMAT) \
+FORMAT_NV12_DISPATCH(nv21, FORMAT)
+
+FORMAT_DISPATCH(rgb32)
+FORMAT_DISPATCH(bgra)
+FORMAT_DISPATCH(argb)
+FORMAT_DISPATCH(bgr24)
+FORMAT_DISPATCH(rgb565)
+
+#define YUV420_PLANAR_ALIGNED(N) (IS_ALIGNED(Y, Y_stride, N) && IS_ALIGNED(U, UV_stride, N) && IS_ALIGNED(V, UV_stride, N) && \
+	IS_ALIGNED(R, RGB_stride, N) && IS_ALIGNED(G, RGB_stride, N) && IS_ALIGNED(B, RGB_stride, N))
+#define NV12_PLANAR_ALIGNED(N) (IS_ALIGNED(Y, Y_stride, N) && IS_ALIGNED(UV, UV_stride, N) && \
+	IS_ALIGNED(R, RGB_stride, N) && IS_ALIGNED(G, RGB_stride, N) && IS_ALIGNED(B, RGB_stride, N))
+
+// NV12_PLANAR_DISPATCH(NAME, FORMAT, TYPE) defines the dispatch functions of the semi planar format NAME to the
+// planar rgb format FORMAT
+#define NV12_PLANAR_DISPATCH(NAME, FORMAT, TYPE) \
+void NAME##_##FORMAT##_policy( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *Y, const uint8_t *UV, uint32_t Y_stride, uint32_t UV_stride, \
+	TYPE *R, TYPE *G, TYPE *B, uint32_t RGB_stride, PLANAR_NORM_PARAM_##FORMAT \
+	YCbCrType yuv_type, YUVRGBStorePolicy policy) \
+{ \
+	(void)policy; \
+	DISPATCH_DEFAULT(NAME##_##FORMAT, NV12_PLANAR_ALIGNED, RGB_PLANAR_OUTPUT, policy, \
+		(width, height, Y, UV, Y_stride, UV_stride, R, G, B, RGB_stride, PLANAR_NORM_ARG_##FORMAT yuv_type)) \
+} \
+\
+void NAME##_##FORMAT( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *Y, const uint8_t *UV, uint32_t Y_stride, uint32_t UV_stride, \
+	TYPE *R, TYPE *G, TYPE *B, uint32_t RGB_stride, PLANAR_NORM_PARAM_##FORMAT \
+	YCbCrType yuv_type) \
+{ \
+	NAME##_##FORMAT##_policy(width, height, Y, UV, Y_stride, UV_stride, R, G, B, RGB_stride, \
+		PLANAR_NORM_ARG_##FORMAT yuv_type, (YUVRGBStorePolicy)store_policy); \
+}
+
+// PLANAR_DISPATCH(FORMAT, TYPE) defines the dispatch functions of the planar rgb formats
+#define PLANAR_DISPATCH(FORMAT, TYPE) \
+void yuv420_##FORMAT##_policy( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *Y, const uint8_t *U, const uint8_t *V, uint32_t Y_stride, uint32_t UV_stride, \
+	TYPE *R, TYPE *G, TYPE *B, uint32_t RGB_stride, PLANAR_NORM_PARAM_##FORMAT \
+	YCbCrType yuv_type, YUVRGBStorePolicy policy) \
+{ \
+	(void)policy; \
+	DISPATCH_DEFAULT(yuv420_##FORMAT, YUV420_PLANAR_ALIGNED, RGB_PLANAR_OUTPUT, policy, \
+		(width, height, Y, U, V, Y_stride, UV_stride, R, G, B, RGB_stride, PLANAR_NORM_ARG_##FORMAT yuv_type)) \
+} \
+\
+void yuv420_##FORMAT( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *Y, const uint8_t *U, const uint8_t *V, uint32_t Y_stride, uint32_t UV_stride, \
+	TYPE *R, TYPE *G, TYPE *B, uint32_t RGB_stride, PLANAR_NORM_PARAM_##FORMAT \
+	YCbCrType yuv_type) \
+{ \
+	yuv420_##FORMAT##_policy(width, height, Y, U, V, Y_stride, UV_stride, R, G, B, RGB_stride, \
+		PLANAR_NORM_ARG_##FORMAT yuv_type, (YUVRGBStorePolicy)store_policy); \
+} \
+\
+NV12_PLANAR_DISPATCH(nv12, FORMAT, TYPE) \
+NV12_PLANAR_DISPATCH(nv21, FORMAT, TYPE)
+
+PLANAR_DISPATCH(rgb_planar, uint8_t)
+PLANAR_DISPATCH(rgb_planar_f32, float)
+PLANAR_DISPATCH(rgb_planar_f16, uint16_t)
+
+// YUV2RGB16_DISPATCH(FORMAT) defines the dispatch functions of the high bit depth conversions to FORMAT
+#define YUV2RGB16_DISPATCH(FORMAT) \
+void yuv420p10_##FORMAT##_policy( \
+	uint32_t width, uint32_t height, \
+	const uint16_t *Y, const uint16_t *U, const uint16_t *V, uint32_t Y_stride, uint32_t UV_stride, \
+	uint8_t *RGB, uint32_t RGB_stride, \
+	YCbCrType yuv_type, YUVRGBStorePolicy policy) \
+{ \
+	(void)policy; \
+	DISPATCH_DEFAULT(yuv420p10_##FORMAT, YUV420_ALIGNED, RGB_OUTPUT, policy, YUV420_ARGS) \
+} \
+\
+void yuv420p10_##FORMAT( \
+	uint32_t width, uint32_t height, \
+	const uint16_t *Y, const uint16_t *U, const uint16_t *V, uint32_t Y_stride, uint32_t UV_stride, \
+	uint8_t *RGB, uint32_t RGB_stride, \
+	YCbCrType yuv_type) \
+{ \
+	yuv420p10_##FORMAT##_policy(width, height, Y, U, V, Y_stride, UV_stride, RGB, RGB_stride, yuv_type, \
+		(YUVRGBStorePolicy)store_policy); \
+} \
+\
+void p010_##FORMAT##_policy( \
+	uint32_t width, uint32_t height, \
+	const uint16_t *Y, const uint16_t *UV, uint32_t Y_stride, uint32_t UV_stride, \
+	uint8_t *RGB, uint32_t RGB_stride, \
+	YCbCrType yuv_type, YUVRGBStorePolicy policy) \
+{ \
+	(void)policy; \
+	DISPATCH_DEFAULT(p010_##FORMAT, NV12_ALIGNED, RGB_OUTPUT, policy, NV12_ARGS) \
+} \
+\
+void p010_##FORMAT( \
+	uint32_t width, uint32_t height, \
+	const uint16_t *Y, const uint16_t *UV, uint32_t Y_stride, uint32_t UV_stride, \
+	uint8_t *RGB, uint32_t RGB_stride, \
+	YCbCrType yuv_type) \
+{ \
+	p010_##FORMAT##_policy(width, height, Y, UV, Y_stride, UV_stride, RGB, RGB_stride, yuv_type, \
+		(YUVRGBStorePolicy)store_policy); \
+}
+
+YUV2RGB16_DISPATCH(rgb24)
+YUV2RGB16_DISPATCH(rgb48)
+YUV2RGB16_DISPATCH(x2rgb10)
+
+#define RGB2YUV_ALIGNED(N) (IS_ALIGNED(RGB, RGB_stride, N) && IS_ALIGNED(Y, Y_stride, N) && IS_ALIGNED(U, UV_stride, N) && IS_ALIGNED(V, UV_stride, N))
+#define RGB2YUV_ARGS (width, height, RGB, RGB_stride, Y, U, V, Y_stride, UV_stride, yuv_type)
+
+// RGB2YUV_DISPATCH(rgb24) and RGB2YUV_DISPATCH(rgb32) define the dispatch functions of rgb to yuv conversions
+// there is no avx512 implementation of rgb to yuv
+#define RGB2YUV_DISPATCH(NAME) \
+void NAME##_yuv420_policy( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *RGB, uint32_t RGB_stride, \
+	uint8_t *Y, uint8_t *U, uint8_t *V, uint32_t Y_stride, uint32_t UV_stride, \
+	YCbCrType yuv_type, YUVRGBStorePolicy policy) \
+{ \
+	const int features = cpu_features(); \
+	(void)features; \
+	(void)policy; \
+	DISPATCH_AVX2(NAME##_yuv420, RGB2YUV_ALIGNED, YUV420_OUTPUT, policy, RGB2YUV_ARGS) \
+	DISPATCH_DEFAULT(NAME##_yuv420, RGB2YUV_ALIGNED, YUV420_OUTPUT, policy, RGB2YUV_ARGS) \
+} \
+\
+void NAME##_yuv420( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *RGB, uint32_t RGB_stride, \
+	uint8_t *Y, uint8_t *U, uint8_t *V, uint32_t Y_stride, uint32_t UV_stride, \
+	YCbCrType yuv_type) \
+{ \
+	NAME##_yuv420_policy(width, height, RGB, RGB_stride, Y, U, V, Y_stride, UV_stride, yuv_type, \
+		(YUVRGBStorePolicy)store_policy); \
+}
+
+RGB2YUV_DISPATCH(rgb24)
+RGB2YUV_DISPATCH(rgb32)
+
+// RGB2YUV_PRECISE_DISPATCH(rgb24) and RGB2YUV_PRECISE_DISPATCH(rgb32) define the dispatch functions of the precise rgb
+// to yuv conversions, which have no avx2 or avx512 implementation
+#define RGB2YUV_PRECISE_DISPATCH(NAME) \
+void NAME##_yuv420_precise_policy( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *RGB, uint32_t RGB_stride, \
+	uint8_t *Y, uint8_t *U, uint8_t *V, uint32_t Y_stride, uint32_t UV_stride, \
+	YCbCrType yuv_type, YUVRGBStorePolicy policy) \
+{ \
+	(void)policy; \
+	DISPATCH_DEFAULT(NAME##_yuv420_precise, RGB2YUV_ALIGNED, YUV420_OUTPUT, policy, RGB2YUV_ARGS) \
+} \
+\
+void NAME##_yuv420_precise( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *RGB, uint32_t RGB_stride, \
+	uint8_t *Y, uint8_t *U, uint8_t *V, uint32_t Y_stride, uint32_t UV_stride, \
+	YCbCrType yuv_type) \
+{ \
+	NAME##_yuv420_precise_policy(width, height, RGB, RGB_stride, Y, U, V, Y_stride, UV_stride, yuv_type, \
+		(YUVRGBStorePolicy)store_policy); \
+}
+
+RGB2YUV_PRECISE_DISPATCH(rgb24)
+RGB2YUV_PRECISE_DISPATCH(rgb32)
+
+// yuva conversions, which have no avx2 or avx512 implementation
+#define YUVA420_ALIGNED(N) (YUV420_ALIGNED(N) && IS_ALIGNED(A, Y_stride, N))
+#define YUVA420_ARGS (width, height, Y, U, V, A, Y_stride, UV_stride, RGB, RGB_stride, yuv_type)
+
+#define YUVA2RGB_DISPATCH(FORMAT) \
+void yuva420_##FORMAT##_policy( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *Y, const uint8_t *U, const uint8_t *V, const uint8_t *A, uint32_t Y_stride, uint32_t UV_stride, \
+	uint8_t *RGB, uint32_t RGB_stride, \
+	YCbCrType yuv_type, YUVRGBStorePolicy policy) \
+{ \
+	(void)policy; \
+	DISPATCH_DEFAULT(yuva420_##FORMAT, YUVA420_ALIGNED, RGB_OUTPUT, policy, YUVA420_ARGS) \
+} \
+\
+void yuva420_##FORMAT( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *Y, const uint8_t *U, const uint8_t *V, const uint8_t *A, uint32_t Y_stride, uint32_t UV_stride, \
+	uint8_t *RGB, uint32_t RGB_stride, \
+	YCbCrType yuv_type) \
+{ \
+	yuva420_##FORMAT##_policy(width, height, Y, U, V, A, Y_stride, UV_stride, RGB, RGB_stride, yuv_type, \
+		(YUVRGBStorePolicy)store_policy); \
+}
+
+YUVA2RGB_DISPATCH(rgb32)
+YUVA2RGB_DISPATCH(bgra_premultiplied)
+
+#define RGBA2YUVA_ALIGNED(N) (IS_ALIGNED(RGBA, RGBA_stride, N) && IS_ALIGNED(Y, Y_stride, N) && \
+	IS_ALIGNED(U, UV_stride, N) && IS_ALIGNED(V, UV_stride, N) && (!A || IS_ALIGNED(A, Y_stride, N)))
+#define RGBA2YUVA_OUTPUT (YUV420_OUTPUT + (A ? (uint64_t)Y_stride*height : 0))
+#define RGBA2YUVA_ARGS (width, height, RGBA, RGBA_stride, Y, U, V, A, Y_stride, UV_stride, premultiplied, yuv_type)
+
+void rgb32_yuva420_policy(
+	uint32_t width, uint32_t height,
+	const uint8_t *RGBA, uint32_t RGBA_stride,
+	uint8_t *Y, uint8_t *U, uint8_t *V, uint8_t *A, uint32_t Y_stride, uint32_t UV_stride,
+	int premultiplied, YCbCrType yuv_type, YUVRGBStorePolicy policy)
+{
+	(void)policy;
+	DISPATCH_DEFAULT(rgb32_yuva420, RGBA2YUVA_ALIGNED, RGBA2YUVA_OUTPUT, policy, RGBA2YUVA_ARGS)
+}
+
+void rgb32_yuva420(
+	uint32_t width, uint32_t height,
+	const uint8_t *RGBA, uint32_t RGBA_stride,
+	uint8_t *Y, uint8_t *U, uint8_t *V, uint8_t *A, uint32_t Y_stride, uint32_t UV_stride,
+	int premultiplied, YCbCrType yuv_type)
+{
+	rgb32_yuva420_policy(width, height, RGBA, RGBA_stride, Y, U, V, A, Y_stride, UV_stride, premultiplied, yuv_type,
+		(YUVRGBStorePolicy)store_policy);
+}
+
+// the 4:2:2 and 4:4:4 formats use the alignment conditions of the yuv420 and nv12 formats with the same planes
+#define PACKED_ALIGNED(N) (IS_ALIGNED(YUV, YUV_stride, N) && IS_ALIGNED(RGB, RGB_stride, N))
+#define YUV_ALIGNED_yuv422p YUV420_ALIGNED
+#define YUV_ALIGNED_yuv444p YUV420_ALIGNED
+#define YUV_ALIGNED_nv16 NV12_ALIGNED
+#define YUV_ALIGNED_nv24 NV12_ALIGNED
+#define YUV_ALIGNED_yuyv PACKED_ALIGNED
+#define YUV_ALIGNED_uyvy PACKED_ALIGNED
+#define YUV_OUTPUT_yuv422p ((uint64_t)(Y_stride+2*UV_stride)*height)
+#define YUV_OUTPUT_yuv444p YUV_OUTPUT_yuv422p
+#define YUV_OUTPUT_nv16 ((uint64_t)(Y_stride+UV_stride)*height)
+#define YUV_OUTPUT_nv24 YUV_OUTPUT_nv16
+#define YUV_OUTPUT_yuyv ((uint64_t)YUV_stride*height)
+#define YUV_OUTPUT_uyvy YUV_OUTPUT_yuyv
+
+// YUV_LINES_DISPATCH(NAME, FORMAT) defines the dispatch functions of the 4:2:2 or 4:4:4 format NAME to and from FORMAT
+#define YUV_LINES_DISPATCH(NAME, FORMAT) \
+void NAME##_##FORMAT##_policy( \
+	uint32_t width, uint32_t height, \
+	YUV_PARAM_##NAME(const uint8_t), \
+	uint8_t *RGB, uint32_t RGB_stride, \
+	YCbCrType yuv_type, YUVRGBStorePolicy policy) \
+{ \
+	(void)policy; \
+	DISPATCH_DEFAULT(NAME##_##FORMAT, YUV_ALIGNED_##NAME, RGB_OUTPUT, policy, (width, height, YUV_ARGS_##NAME(0), RGB, RGB_stride, yuv_type)) \
+} \
+\
+void NAME##_##FORMAT( \
+	uint32_t width, uint32_t height, \
+	YUV_PARAM_##NAME(const uint8_t), \
+	uint8_t *RGB, uint32_t RGB_stride, \
+	YCbCrType yuv_type) \
+{ \
+	NAME##_##FORMAT##_policy(width, height, YUV_ARGS_##NAME(0), RGB, RGB_stride, yuv_type, (YUVRGBStorePolicy)store_policy); \
+} \
+\
+void FORMAT##_##NAME##_policy( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *RGB, uint32_t RGB_stride, \
+	YUV_PARAM_##NAME(uint8_t), \
+	YCbCrType yuv_type, YUVRGBStorePolicy policy) \
+{ \
+	(void)policy; \
+	DISPATCH_DEFAULT(FORMAT##_##NAME, YUV_ALIGNED_##NAME, YUV_OUTPUT_##NAME, policy, (width, height, RGB, RGB_stride, YUV_ARGS_##NAME(0), yuv_type)) \
+} \
+\
+void FORMAT##_##NAME( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *RGB, uint32_t RGB_stride, \
+	YUV_PARAM_##NAME(uint8_t), \
+	YCbCrType yuv_type) \
+{ \
+	FORMAT##_##NAME##_policy(width, height, RGB, RGB_stride, YUV_ARGS_##NAME(0), yuv_type, (YUVRGBStorePolicy)store_policy); \
 }
 
-void nv21_rgb24_sseu(
+#define YUV_LINES_ALL_DISPATCH(FORMAT) \
+	YUV_LINES_DISPATCH(yuv422p, FORMAT) \
+	YUV_LINES_DISPATCH(yuv444p, FORMAT) \
+	YUV_LINES_DISPATCH(nv16, FORMAT) \
+	YUV_LINES_DISPATCH(nv24, FORMAT) \
+	YUV_LINES_DISPATCH(yuyv, FORMAT) \
+	YUV_LINES_DISPATCH(uyvy, FORMAT)
+
+YUV_LINES_ALL_DISPATCH(rgb24)
+YUV_LINES_ALL_DISPATCH(rgb32)
+
+
+// the bilinear conversions only have unaligned simd implementations, so they have no store policy
+#if defined(_YUVRGB_SSE2_)
+#define DISPATCH_BILINEAR(NAME, ARGS) INSTRUMENTED_CALL(NAME##_sseu, ARGS)
+#elif defined(_YUVRGB_NEON_)
+#define DISPATCH_BILINEAR(NAME, ARGS) INSTRUMENTED_CALL(NAME##_neon, ARGS)
+#else
+#define DISPATCH_BILINEAR(NAME, ARGS) INSTRUMENTED_CALL(NAME##_std, ARGS)
+#endif
+
+void yuv420_rgb24_bilinear(
+	uint32_t width, uint32_t height, 
+	const uint8_t *Y, const uint8_t *U, const uint8_t *V, uint32_t Y_stride, uint32_t UV_stride, 
+	uint8_t *RGB, uint32_t RGB_stride, 
+	YCbCrType yuv_type)
+{
+	DISPATCH_BILINEAR(yuv420_rgb24_bilinear, YUV420_ARGS)
+}
+
+void nv12_rgb24_bilinear(
 	uint32_t width, uint32_t height, 
 	const uint8_t *Y, const uint8_t *UV, uint32_t Y_stride, uint32_t UV_stride, 
 	uint8_t *RGB, uint32_t RGB_stride, 
 	YCbCrType yuv_type)
 {
-	#define LOAD_SI128 _mm_loadu_si128
-	#define SAVE_SI128 _mm_storeu_si128
-	const YUV2RGBParam *const param = &(YUV2RGB[yuv_type]);
-	
-	uint32_t x, y;
-	for(y=0; y<(height-1); y+=2)
-	{
-		const uint8_t *y_ptr1=Y+y*Y_stride,
-			*y_ptr2=Y+(y+1)*Y_stride,
-			*uv_ptr=UV+(y/2)*UV_stride;
-		
-		uint8_t *rgb_ptr1=RGB+y*RGB_stride,
-			*rgb_ptr2=RGB+(y+1)*RGB_stride;
-		
-		for(x=0; x<(width-31); x+=32)
-		{
-			YUV2RGB_32_NV21
-			
-			y_ptr1+=32;
-			y_ptr2+=32;
-			uv_ptr+=32; 
-			rgb_ptr1+=96;
-			rgb_ptr2+=96;
-		}
-	}
-	#undef LOAD_SI128
-	#undef SAVE_SI128
+	DISPATCH_BILINEAR(nv12_rgb24_bilinear, NV12_ARGS)
 }
 
+void nv21_rgb24_bilinear(
+	uint32_t width, uint32_t height, 
+	const uint8_t *Y, const uint8_t *UV, uint32_t Y_stride, uint32_t UV_stride, 
+	uint8_t *RGB, uint32_t RGB_stride, 
+	YCbCrType yuv_type)
+{
+	DISPATCH_BILINEAR(nv21_rgb24_bilinear, NV12_ARGS)
+}
 
+// the direct yuv conversions use the aligned implementation if all the source and destination planes are aligned
+#define SRC_ALIGNED_yuv420(N) (IS_ALIGNED(Y, Y_stride, N) && IS_ALIGNED(U, UV_stride, N) && IS_ALIGNED(V, UV_stride, N))
+#define SRC_ALIGNED_nv12(N) (IS_ALIGNED(Y, Y_stride, N) && IS_ALIGNED(UV, UV_stride, N))
+#define SRC_ALIGNED_yuyv(N) IS_ALIGNED(YUV, YUV_stride, N)
+#define DST_ALIGNED_yuv420(N) (IS_ALIGNED(Y_dst, Y_dst_stride, N) && IS_ALIGNED(U_dst, UV_dst_stride, N) && \
+	IS_ALIGNED(V_dst, UV_dst_stride, N))
+#define DST_ALIGNED_nv12(N) (IS_ALIGNED(Y_dst, Y_dst_stride, N) && IS_ALIGNED(UV_dst, UV_dst_stride, N))
+#define DST_ALIGNED_yuyv(N) IS_ALIGNED(YUV_dst, YUV_dst_stride, N)
 
-#endif //_YUVRGB_SSE2_
+#define DST_OUTPUT_yuv420 ((uint64_t)Y_dst_stride*height + (uint64_t)UV_dst_stride*(height+1))
+#define DST_OUTPUT_nv12 ((uint64_t)Y_dst_stride*height + (uint64_t)UV_dst_stride*((height+1)/2))
+#define DST_OUTPUT_nv21 DST_OUTPUT_nv12
+#define DST_OUTPUT_yuyv ((uint64_t)YUV_dst_stride*height)
+#define DST_OUTPUT_uyvy DST_OUTPUT_yuyv
+
+#define YUV_DIRECT_ALIGNED_nv12_yuv420(N) (SRC_ALIGNED_nv12(N) && DST_ALIGNED_yuv420(N))
+#define YUV_DIRECT_ALIGNED_nv21_yuv420(N) (SRC_ALIGNED_nv12(N) && DST_ALIGNED_yuv420(N))
+#define YUV_DIRECT_ALIGNED_yuv420_nv12(N) (SRC_ALIGNED_yuv420(N) && DST_ALIGNED_nv12(N))
+#define YUV_DIRECT_ALIGNED_yuv420_nv21(N) (SRC_ALIGNED_yuv420(N) && DST_ALIGNED_nv12(N))
+#define YUV_DIRECT_ALIGNED_yuyv_yuv420(N) (SRC_ALIGNED_yuyv(N) && DST_ALIGNED_yuv420(N))
+#define YUV_DIRECT_ALIGNED_uyvy_yuv420(N) (SRC_ALIGNED_yuyv(N) && DST_ALIGNED_yuv420(N))
+#define YUV_DIRECT_ALIGNED_yuyv_nv12(N) (SRC_ALIGNED_yuyv(N) && DST_ALIGNED_nv12(N))
+#define YUV_DIRECT_ALIGNED_uyvy_nv12(N) (SRC_ALIGNED_yuyv(N) && DST_ALIGNED_nv12(N))
+#define YUV_DIRECT_ALIGNED_yuv420_yuyv(N) (SRC_ALIGNED_yuv420(N) && DST_ALIGNED_yuyv(N))
+#define YUV_DIRECT_ALIGNED_yuv420_uyvy(N) (SRC_ALIGNED_yuv420(N) && DST_ALIGNED_yuyv(N))
+#define YUV_DIRECT_ALIGNED_nv12_yuyv(N) (SRC_ALIGNED_nv12(N) && DST_ALIGNED_yuyv(N))
+#define YUV_DIRECT_ALIGNED_nv12_uyvy(N) (SRC_ALIGNED_nv12(N) && DST_ALIGNED_yuyv(N))
+
+// YUV_DIRECT_DISPATCH(SRC, DST) defines the dispatch function of the direct conversion of SRC to DST
+#define YUV_DIRECT_DISPATCH(SRC, DST) \
+void SRC##_##DST##_policy( \
+	uint32_t width, uint32_t height, \
+	SRC_PARAM_##SRC, \
+	DST_PARAM_##DST, \
+	YUVRGBStorePolicy policy) \
+{ \
+	(void)policy; \
+	DISPATCH_DEFAULT(SRC##_##DST, YUV_DIRECT_ALIGNED_##SRC##_##DST, DST_OUTPUT_##DST, policy, (width, height, SRC_ARGS_##SRC, DST_ARGS_##DST)) \
+} \
+\
+void SRC##_##DST( \
+	uint32_t width, uint32_t height, \
+	SRC_PARAM_##SRC, \
+	DST_PARAM_##DST) \
+{ \
+	SRC##_##DST##_policy(width, height, SRC_ARGS_##SRC, DST_ARGS_##DST, (YUVRGBStorePolicy)store_policy); \
+}
+
+YUV_DIRECT_DISPATCH(nv12, yuv420)
+YUV_DIRECT_DISPATCH(nv21, yuv420)
+YUV_DIRECT_DISPATCH(yuv420, nv12)
+YUV_DIRECT_DISPATCH(yuv420, nv21)
+YUV_DIRECT_DISPATCH(yuyv, yuv420)
+YUV_DIRECT_DISPATCH(uyvy, yuv420)
+YUV_DIRECT_DISPATCH(yuyv, nv12)
+YUV_DIRECT_DISPATCH(uyvy, nv12)
+YUV_DIRECT_DISPATCH(yuv420, yuyv)
+YUV_DIRECT_DISPATCH(yuv420, uyvy)
+YUV_DIRECT_DISPATCH(nv12, yuyv)
+YUV_DIRECT_DISPATCH(nv12, uyvy)
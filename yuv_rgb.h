@@ -5,16 +5,29 @@
 
 // There are a few slightly different variations of the YCbCr color space with different parameters that 
 // change the conversion matrix.
-// The three most common YCbCr color space, defined by BT.601, BT.709 and JPEG standard are implemented here.
+// The three most common YCbCr color space, defined by BT.601, BT.709 and JPEG standard are implemented here,
+// as well as BT.2020 (non constant luminance) and the full range variants of BT.709 and BT.2020 (the full range
+// variant of BT.601 being JPEG). Other color spaces can be defined at runtime (see yuv_rgb_set_custom_color_space).
 // See the respective standards for details
 // The matrix values used are derived from http://www.equasys.de/colorconversion.html
 
 // YUV420 is stored as three separate channels, with U and V (Cb and Cr) subsampled by a 2 factor
 // For conversion from yuv to rgb, no interpolation is done, and the same UV value are used for 4 rgb pixels. This 
 // is suboptimal for image quality, but by far the fastest method.
+// The *_bilinear versions interpolate the chroma planes inside the conversion, for a better quality.
 
-// For all methods, width and height should be even, if not, the last row/column of the result image won't be affected.
-// For sse methods, if the width if not divisable by 32, the last (width%32) pixels of each line won't be affected.
+// All methods convert the whole image, for any width and height. The simd methods process most of the image
+// by blocks of 32 (sse), 64 (avx2), 128 (avx512) or 16 (neon) pixels, and finish the end of the lines with an
+// overlapping last block, and odd sizes with the standard implementation.
+// For odd widths or heights, the chroma planes have (width+1)/2 columns and (height+1)/2 lines, the last chroma
+// column (or line) corresponding to the last pixel column (or line) alone.
+
+// The functions without suffix (yuv420_rgb24, nv12_rgb24, rgb24_yuv420, ...) select at runtime the fastest implementation available
+// on the cpu (avx512, avx2, sse, neon or standard c), and the aligned or unaligned version depending on the pointers and
+// strides.
+
+#ifndef YUV_RGB_H
+#define YUV_RGB_H
 
 #include <stdint.h>
 
@@ -22,13 +35,93 @@ typedef enum
 {
 	YCBCR_JPEG,
 	YCBCR_601,
-	YCBCR_709
+	YCBCR_709,
+	YCBCR_709_FULL,
+	YCBCR_2020,
+	YCBCR_2020_FULL,
+	// color spaces defined at runtime with yuv_rgb_set_custom_color_space
+	YCBCR_CUSTOM_0,
+	YCBCR_CUSTOM_1,
+	YCBCR_CUSTOM_2,
+	YCBCR_CUSTOM_3,
+	YCBCR_TYPE_COUNT,
+	YCBCR_601_FULL = YCBCR_JPEG
 } YCbCrType;
 
+// stores used by the versions without suffix of the conversions, see yuv_rgb_set_store_policy
+typedef enum
+{
+	YUVRGB_STORE_AUTO,
+	YUVRGB_STORE_STREAM,
+	YUVRGB_STORE_CACHED
+} YUVRGBStorePolicy;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// define the custom color space yuv_type (YCBCR_CUSTOM_0 to YCBCR_CUSTOM_3), from the luma coefficients kr and kb
+// of the red and blue components (kg=1-kr-kb), the [y_min:y_max] digital range of the 8 bits luma values and the
+// cbcr_range of the 8 bits chroma values (for example 0.2627, 0.0593, 16, 235 and 224 for BT.2020), used by all
+// conversions (high bit depth values are scaled from the 8 bits ranges, as for the predefined color spaces)
+// the matrix is computed once here, so that the conversions do not have any additional cost, but this must not be
+// called while a conversion with the same yuv_type is running
+// return 0 on success, or -1 if yuv_type is not a custom color space or if the values are invalid or out of the
+// range supported by the fixed point implementations (which is the case when y_max-y_min or cbcr_range are too small)
+int yuv_rgb_set_custom_color_space(YCbCrType yuv_type, double kr, double kb, double y_min, double y_max, double cbcr_range);
+
+// The aligned simd implementations (*_sse, *_avx2 and *_avx512) write the output with non temporal (streaming) stores,
+// which bypass the caches: this is faster for large images that are not read again soon (for example sent to a
+// device), but the output must be fetched back from memory when it is read right away by the next processing step.
+// The versions without suffix (and the multi-threaded and batch versions, which use them) select the stores with the
+// store policy:
+// - YUVRGB_STORE_AUTO (default): streaming stores if the output of a call is larger than half the last level cache
+//   (the whole output of all the bands or frames for the multi-threaded and batch versions)
+// - YUVRGB_STORE_STREAM: streaming stores whenever the pointers and strides are aligned
+// - YUVRGB_STORE_CACHED: regular stores, the aligned images being converted by the unaligned implementations (which
+//   are as fast on aligned data)
+// Streaming stores are weakly ordered: the versions without suffix end them with an sfence, so that the output can
+// be read by another thread (or a device) once it is notified that the conversion is done. When calling the aligned
+// implementations directly, _mm_sfence() must be called before publishing their output (a single fence is enough
+// for several conversions).
+// The policy is global, and should be set before starting conversions. It applies to all the conversions with
+// aligned implementations (rgb, planar rgb, high bit depth, yuva, 4:2:2, 4:4:4 and direct yuv formats); the bilinear
+// conversions only have unaligned implementations and always use regular stores. It has no effect without sse (the
+// neon and standard implementations only use regular stores).
+void yuv_rgb_set_store_policy(YUVRGBStorePolicy policy);
+YUVRGBStorePolicy yuv_rgb_get_store_policy(void);
+
+// Instrumentation: when the library is built with USE_INSTRUMENTATION, the versions without suffix (and so the
+// multi-threaded, batch, scaled... versions, which use them) count the calls of the implementation they select, with
+// the number of pixels converted and the time spent, and call an optional trace callback before and after it. This
+// shows which implementation actually runs on given images, for example the unaligned ones when the strides are not
+// multiples of 16, or the standard c one on targets without simd. Without USE_INSTRUMENTATION, the conversions do not
+// have any additional code, yuv_rgb_get_kernel_stats returns 0 and yuv_rgb_set_trace_callback returns -1.
+typedef struct
+{
+	const char *implementation; // name of the function, for example "yuv420_rgb24_avx2u"
+	uint64_t calls;
+	uint64_t pixels;
+	uint64_t nanoseconds;
+} YUVRGBKernelStats;
+
+// copy the counters of up to max_number implementations called since the last reset into stats, and return the
+// number of implementations called (which can be larger than max_number)
+// the counters are updated atomically, so this can be called while conversions are running
+uint32_t yuv_rgb_get_kernel_stats(YUVRGBKernelStats *stats, uint32_t max_number);
+
+// set the counters to 0, the calls running at the same time may be counted or not
+void yuv_rgb_reset_kernel_stats(void);
+
+// callback called by the thread running the conversion, with end=0 before the implementation is called and end=1 after
+// it returns, for example to mark the conversions in a tracing tool
+typedef void (*yuv_rgb_trace_callback)(void *user_data, const char *implementation, uint32_t width, uint32_t height,
+	int end);
+
+// set the trace callback, or remove it with NULL, which should be done while no conversion is running
+// return 0 on success, or -1 if the library was built without instrumentation
+int yuv_rgb_set_trace_callback(yuv_rgb_trace_callback callback, void *user_data);
+
 // yuv to rgb, standard c implementation
 void yuv420_rgb24_std(
 	uint32_t width, uint32_t height, 
@@ -98,6 +191,134 @@ void nv21_rgb24_sseu(
 	uint8_t *rgb, uint32_t rgb_stride, 
 	YCbCrType yuv_type);
 
+// yuv to rgb, avx2 implementation
+// pointers must be 32 byte aligned, and strides must be divisable by 32
+// must only be called if the cpu supports avx2
+void yuv420_rgb24_avx2(
+	uint32_t width, uint32_t height, 
+	const uint8_t *y, const uint8_t *u, const uint8_t *v, uint32_t y_stride, uint32_t uv_stride, 
+	uint8_t *rgb, uint32_t rgb_stride, 
+	YCbCrType yuv_type);
+
+// yuv to rgb, avx2 implementation
+// pointers do not need to be 32 byte aligned
+// must only be called if the cpu supports avx2
+void yuv420_rgb24_avx2u(
+	uint32_t width, uint32_t height, 
+	const uint8_t *y, const uint8_t *u, const uint8_t *v, uint32_t y_stride, uint32_t uv_stride, 
+	uint8_t *rgb, uint32_t rgb_stride, 
+	YCbCrType yuv_type);
+
+// yuv nv12 to rgb, avx2 implementation
+// pointers must be 32 byte aligned, and strides must be divisable by 32
+// must only be called if the cpu supports avx2
+void nv12_rgb24_avx2(
+	uint32_t width, uint32_t height, 
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, 
+	uint8_t *rgb, uint32_t rgb_stride, 
+	YCbCrType yuv_type);
+
+// yuv nv12 to rgb, avx2 implementation
+// pointers do not need to be 32 byte aligned
+// must only be called if the cpu supports avx2
+void nv12_rgb24_avx2u(
+	uint32_t width, uint32_t height, 
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, 
+	uint8_t *rgb, uint32_t rgb_stride, 
+	YCbCrType yuv_type);
+
+// yuv nv21 to rgb, avx2 implementation
+// pointers must be 32 byte aligned, and strides must be divisable by 32
+// must only be called if the cpu supports avx2
+void nv21_rgb24_avx2(
+	uint32_t width, uint32_t height, 
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, 
+	uint8_t *rgb, uint32_t rgb_stride, 
+	YCbCrType yuv_type);
+
+// yuv nv21 to rgb, avx2 implementation
+// pointers do not need to be 32 byte aligned
+// must only be called if the cpu supports avx2
+void nv21_rgb24_avx2u(
+	uint32_t width, uint32_t height, 
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, 
+	uint8_t *rgb, uint32_t rgb_stride, 
+	YCbCrType yuv_type);
+
+// yuv to rgb, avx512 implementation
+// pointers must be 64 byte aligned, and strides must be divisable by 64
+// must only be called if the cpu supports avx512f and avx512bw
+void yuv420_rgb24_avx512(
+	uint32_t width, uint32_t height, 
+	const uint8_t *y, const uint8_t *u, const uint8_t *v, uint32_t y_stride, uint32_t uv_stride, 
+	uint8_t *rgb, uint32_t rgb_stride, 
+	YCbCrType yuv_type);
+
+// yuv to rgb, avx512 implementation
+// pointers do not need to be 64 byte aligned
+// must only be called if the cpu supports avx512f and avx512bw
+void yuv420_rgb24_avx512u(
+	uint32_t width, uint32_t height, 
+	const uint8_t *y, const uint8_t *u, const uint8_t *v, uint32_t y_stride, uint32_t uv_stride, 
+	uint8_t *rgb, uint32_t rgb_stride, 
+	YCbCrType yuv_type);
+
+// yuv nv12 to rgb, avx512 implementation
+// pointers must be 64 byte aligned, and strides must be divisable by 64
+// must only be called if the cpu supports avx512f and avx512bw
+void nv12_rgb24_avx512(
+	uint32_t width, uint32_t height, 
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, 
+	uint8_t *rgb, uint32_t rgb_stride, 
+	YCbCrType yuv_type);
+
+// yuv nv12 to rgb, avx512 implementation
+// pointers do not need to be 64 byte aligned
+// must only be called if the cpu supports avx512f and avx512bw
+void nv12_rgb24_avx512u(
+	uint32_t width, uint32_t height, 
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, 
+	uint8_t *rgb, uint32_t rgb_stride, 
+	YCbCrType yuv_type);
+
+// yuv nv21 to rgb, avx512 implementation
+// pointers must be 64 byte aligned, and strides must be divisable by 64
+// must only be called if the cpu supports avx512f and avx512bw
+void nv21_rgb24_avx512(
+	uint32_t width, uint32_t height, 
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, 
+	uint8_t *rgb, uint32_t rgb_stride, 
+	YCbCrType yuv_type);
+
+// yuv nv21 to rgb, avx512 implementation
+// pointers do not need to be 64 byte aligned
+// must only be called if the cpu supports avx512f and avx512bw
+void nv21_rgb24_avx512u(
+	uint32_t width, uint32_t height, 
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, 
+	uint8_t *rgb, uint32_t rgb_stride, 
+	YCbCrType yuv_type);
+
+// yuv to rgb, fastest implementation supported by the cpu
+void yuv420_rgb24(
+	uint32_t width, uint32_t height, 
+	const uint8_t *y, const uint8_t *u, const uint8_t *v, uint32_t y_stride, uint32_t uv_stride, 
+	uint8_t *rgb, uint32_t rgb_stride, 
+	YCbCrType yuv_type);
+
+// yuv nv12 to rgb, fastest implementation supported by the cpu
+void nv12_rgb24(
+	uint32_t width, uint32_t height, 
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, 
+	uint8_t *rgb, uint32_t rgb_stride, 
+	YCbCrType yuv_type);
+
+// yuv nv21 to rgb, fastest implementation supported by the cpu
+void nv21_rgb24(
+	uint32_t width, uint32_t height, 
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, 
+	uint8_t *rgb, uint32_t rgb_stride, 
+	YCbCrType yuv_type);
 
 
 
@@ -150,6 +371,1078 @@ void rgb32_yuv420_sseu(
 	uint8_t *y, uint8_t *u, uint8_t *v, uint32_t y_stride, uint32_t uv_stride, 
 	YCbCrType yuv_type);
 
+// rgb to yuv, avx2 implementation
+// pointers must be 32 byte aligned, and strides must be divisible by 32
+// must only be called if the cpu supports avx2
+void rgb24_yuv420_avx2(
+	uint32_t width, uint32_t height, 
+	const uint8_t *rgb, uint32_t rgb_stride, 
+	uint8_t *y, uint8_t *u, uint8_t *v, uint32_t y_stride, uint32_t uv_stride, 
+	YCbCrType yuv_type);
+
+// rgb to yuv, avx2 implementation
+// pointers do not need to be 32 byte aligned
+// must only be called if the cpu supports avx2
+void rgb24_yuv420_avx2u(
+	uint32_t width, uint32_t height, 
+	const uint8_t *rgb, uint32_t rgb_stride, 
+	uint8_t *y, uint8_t *u, uint8_t *v, uint32_t y_stride, uint32_t uv_stride, 
+	YCbCrType yuv_type);
+
+// rgba to yuv, avx2 implementation
+// pointers must be 32 byte aligned, and strides must be divisible by 32
+// alpha channel is ignored
+// must only be called if the cpu supports avx2
+void rgb32_yuv420_avx2(
+	uint32_t width, uint32_t height, 
+	const uint8_t *rgba, uint32_t rgba_stride, 
+	uint8_t *y, uint8_t *u, uint8_t *v, uint32_t y_stride, uint32_t uv_stride, 
+	YCbCrType yuv_type);
+
+// rgba to yuv, avx2 implementation
+// pointers do not need to be 32 byte aligned
+// alpha channel is ignored
+// must only be called if the cpu supports avx2
+void rgb32_yuv420_avx2u(
+	uint32_t width, uint32_t height, 
+	const uint8_t *rgba, uint32_t rgba_stride, 
+	uint8_t *y, uint8_t *u, uint8_t *v, uint32_t y_stride, uint32_t uv_stride, 
+	YCbCrType yuv_type);
+
+// yuv to rgb, neon implementation
+// only available on aarch64, no alignment requirement
+void yuv420_rgb24_neon(
+	uint32_t width, uint32_t height, 
+	const uint8_t *y, const uint8_t *u, const uint8_t *v, uint32_t y_stride, uint32_t uv_stride, 
+	uint8_t *rgb, uint32_t rgb_stride, 
+	YCbCrType yuv_type);
+
+// yuv nv12 to rgb, neon implementation
+// only available on aarch64, no alignment requirement
+void nv12_rgb24_neon(
+	uint32_t width, uint32_t height, 
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, 
+	uint8_t *rgb, uint32_t rgb_stride, 
+	YCbCrType yuv_type);
+
+// yuv nv21 to rgb, neon implementation
+// only available on aarch64, no alignment requirement
+void nv21_rgb24_neon(
+	uint32_t width, uint32_t height, 
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, 
+	uint8_t *rgb, uint32_t rgb_stride, 
+	YCbCrType yuv_type);
+
+// rgb to yuv, neon implementation
+// only available on aarch64, no alignment requirement
+void rgb24_yuv420_neon(
+	uint32_t width, uint32_t height, 
+	const uint8_t *rgb, uint32_t rgb_stride, 
+	uint8_t *y, uint8_t *u, uint8_t *v, uint32_t y_stride, uint32_t uv_stride, 
+	YCbCrType yuv_type);
+
+// rgba to yuv, neon implementation
+// only available on aarch64, no alignment requirement
+// alpha channel is ignored
+void rgb32_yuv420_neon(
+	uint32_t width, uint32_t height, 
+	const uint8_t *rgba, uint32_t rgba_stride, 
+	uint8_t *y, uint8_t *u, uint8_t *v, uint32_t y_stride, uint32_t uv_stride, 
+	YCbCrType yuv_type);
+
+// rgb to yuv, fastest implementation supported by the cpu
+void rgb24_yuv420(
+	uint32_t width, uint32_t height, 
+	const uint8_t *rgb, uint32_t rgb_stride, 
+	uint8_t *y, uint8_t *u, uint8_t *v, uint32_t y_stride, uint32_t uv_stride, 
+	YCbCrType yuv_type);
+
+// rgba to yuv, fastest implementation supported by the cpu
+// alpha channel is ignored
+void rgb32_yuv420(
+	uint32_t width, uint32_t height, 
+	const uint8_t *rgba, uint32_t rgba_stride, 
+	uint8_t *y, uint8_t *u, uint8_t *v, uint32_t y_stride, uint32_t uv_stride, 
+	YCbCrType yuv_type);
+
+// Bilinear chroma interpolation
+// Same conversions as above, but the chroma planes are upsampled with a bilinear interpolation inside the
+// conversion, instead of using the same u and v values for 4 rgb pixels. The chroma samples are located at the
+// center of each 2x2 block of pixels (JPEG siting), and each pixel gets 9/16 of the nearest sample, 3/16 of the
+// next ones horizontally and vertically, and 1/16 of the diagonal one. This is slower than the other conversions,
+// but much faster than upsampling the chroma planes in a separate pass.
+// All implementations give the same results, and have no alignment requirement.
+
+// yuv to rgb with bilinear chroma interpolation, standard c implementation
+void yuv420_rgb24_bilinear_std(
+	uint32_t width, uint32_t height, 
+	const uint8_t *y, const uint8_t *u, const uint8_t *v, uint32_t y_stride, uint32_t uv_stride, 
+	uint8_t *rgb, uint32_t rgb_stride, 
+	YCbCrType yuv_type);
+
+// yuv nv12 to rgb with bilinear chroma interpolation, standard c implementation
+void nv12_rgb24_bilinear_std(
+	uint32_t width, uint32_t height, 
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, 
+	uint8_t *rgb, uint32_t rgb_stride, 
+	YCbCrType yuv_type);
+
+// yuv nv21 to rgb with bilinear chroma interpolation, standard c implementation
+void nv21_rgb24_bilinear_std(
+	uint32_t width, uint32_t height, 
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, 
+	uint8_t *rgb, uint32_t rgb_stride, 
+	YCbCrType yuv_type);
+
+// yuv to rgb with bilinear chroma interpolation, sse implementation
+void yuv420_rgb24_bilinear_sseu(
+	uint32_t width, uint32_t height, 
+	const uint8_t *y, const uint8_t *u, const uint8_t *v, uint32_t y_stride, uint32_t uv_stride, 
+	uint8_t *rgb, uint32_t rgb_stride, 
+	YCbCrType yuv_type);
+
+// yuv nv12 to rgb with bilinear chroma interpolation, sse implementation
+void nv12_rgb24_bilinear_sseu(
+	uint32_t width, uint32_t height, 
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, 
+	uint8_t *rgb, uint32_t rgb_stride, 
+	YCbCrType yuv_type);
+
+// yuv nv21 to rgb with bilinear chroma interpolation, sse implementation
+void nv21_rgb24_bilinear_sseu(
+	uint32_t width, uint32_t height, 
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, 
+	uint8_t *rgb, uint32_t rgb_stride, 
+	YCbCrType yuv_type);
+
+// yuv to rgb with bilinear chroma interpolation, neon implementation
+// only available on aarch64
+void yuv420_rgb24_bilinear_neon(
+	uint32_t width, uint32_t height, 
+	const uint8_t *y, const uint8_t *u, const uint8_t *v, uint32_t y_stride, uint32_t uv_stride, 
+	uint8_t *rgb, uint32_t rgb_stride, 
+	YCbCrType yuv_type);
+
+// yuv nv12 to rgb with bilinear chroma interpolation, neon implementation
+// only available on aarch64
+void nv12_rgb24_bilinear_neon(
+	uint32_t width, uint32_t height, 
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, 
+	uint8_t *rgb, uint32_t rgb_stride, 
+	YCbCrType yuv_type);
+
+// yuv nv21 to rgb with bilinear chroma interpolation, neon implementation
+// only available on aarch64
+void nv21_rgb24_bilinear_neon(
+	uint32_t width, uint32_t height, 
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, 
+	uint8_t *rgb, uint32_t rgb_stride, 
+	YCbCrType yuv_type);
+
+// yuv to rgb with bilinear chroma interpolation, fastest implementation supported by the cpu
+void yuv420_rgb24_bilinear(
+	uint32_t width, uint32_t height, 
+	const uint8_t *y, const uint8_t *u, const uint8_t *v, uint32_t y_stride, uint32_t uv_stride, 
+	uint8_t *rgb, uint32_t rgb_stride, 
+	YCbCrType yuv_type);
+
+// yuv nv12 to rgb with bilinear chroma interpolation, fastest implementation supported by the cpu
+void nv12_rgb24_bilinear(
+	uint32_t width, uint32_t height, 
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, 
+	uint8_t *rgb, uint32_t rgb_stride, 
+	YCbCrType yuv_type);
+
+// yuv nv21 to rgb with bilinear chroma interpolation, fastest implementation supported by the cpu
+void nv21_rgb24_bilinear(
+	uint32_t width, uint32_t height, 
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, 
+	uint8_t *rgb, uint32_t rgb_stride, 
+	YCbCrType yuv_type);
+
+// Other rgb formats
+// The yuv to rgb conversions are also available for the following rgb formats, which replace rgb24 in the names
+// (yuv420_rgb32_std, nv12_bgra_sse, nv21_rgb565, ...):
+// - rgb32: 4 bytes per pixel in the order r, g, b, a, with a constant alpha of 255
+// - bgra: 4 bytes per pixel in the order b, g, r, a, with a constant alpha of 255
+// - argb: 4 bytes per pixel in the order a, r, g, b, with a constant alpha of 255
+// - bgr24: 3 bytes per pixel in the order b, g, r
+// - rgb565: 2 bytes per pixel, a little endian 16 bits value with r in the 5 high bits, g in the 6 middle bits and b
+//   in the 5 low bits
+// Each format has a standard c, sse, sse unaligned and neon implementation, with the same requirements as the rgb24
+// ones, and a version without suffix selecting the fastest one (there are no avx2 or avx512 implementations).
+
+#define YUV_RGB_FORMAT_DECLARATIONS(FORMAT, SUFFIX) \
+void yuv420_##FORMAT##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *y, const uint8_t *u, const uint8_t *v, uint32_t y_stride, uint32_t uv_stride, \
+	uint8_t *rgb, uint32_t rgb_stride, \
+	YCbCrType yuv_type); \
+void nv12_##FORMAT##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, \
+	uint8_t *rgb, uint32_t rgb_stride, \
+	YCbCrType yuv_type); \
+void nv21_##FORMAT##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, \
+	uint8_t *rgb, uint32_t rgb_stride, \
+	YCbCrType yuv_type);
+
+#define YUV_RGB_FORMAT_ALL_DECLARATIONS(FORMAT) \
+	YUV_RGB_FORMAT_DECLARATIONS(FORMAT, _std) \
+	YUV_RGB_FORMAT_DECLARATIONS(FORMAT, _sse) \
+	YUV_RGB_FORMAT_DECLARATIONS(FORMAT, _sseu) \
+	YUV_RGB_FORMAT_DECLARATIONS(FORMAT, _neon) \
+	YUV_RGB_FORMAT_DECLARATIONS(FORMAT, )
+
+YUV_RGB_FORMAT_ALL_DECLARATIONS(rgb32)
+YUV_RGB_FORMAT_ALL_DECLARATIONS(bgra)
+YUV_RGB_FORMAT_ALL_DECLARATIONS(argb)
+YUV_RGB_FORMAT_ALL_DECLARATIONS(bgr24)
+YUV_RGB_FORMAT_ALL_DECLARATIONS(rgb565)
+
+#undef YUV_RGB_FORMAT_ALL_DECLARATIONS
+#undef YUV_RGB_FORMAT_DECLARATIONS
+
+// Planar rgb output
+// The yuv to rgb conversions can also save the r, g and b values in three separate planes r, g and b, sharing the
+// stride rgb_stride (in bytes), for example in a NCHW tensor for the inference of a neural network:
+// - rgb_planar: 8 bits values
+// - rgb_planar_f32: normalized single precision float values, (value-mean)*scale for value in [0, 255]
+// - rgb_planar_f16: normalized half precision float values (IEEE 754 binary16, stored as uint16_t), rounded to nearest
+// Each format has a standard c, sse, sse unaligned and neon implementation, and a version without suffix selecting the
+// fastest one. All implementations give the same results. The sse implementation requires 16 byte aligned pointers and
+// strides, including the three planes.
+
+// normalization of the float planar rgb formats, with index 0 for r, 1 for g and 2 for b
+typedef struct
+{
+	float mean[3];
+	float scale[3];
+} RGBNormalization;
+
+#define YUV_RGB_PLANAR_DECLARATIONS(FORMAT, SUFFIX) \
+void yuv420_##FORMAT##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *y, const uint8_t *u, const uint8_t *v, uint32_t y_stride, uint32_t uv_stride, \
+	uint8_t *r, uint8_t *g, uint8_t *b, uint32_t rgb_stride, \
+	YCbCrType yuv_type); \
+void nv12_##FORMAT##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, \
+	uint8_t *r, uint8_t *g, uint8_t *b, uint32_t rgb_stride, \
+	YCbCrType yuv_type); \
+void nv21_##FORMAT##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, \
+	uint8_t *r, uint8_t *g, uint8_t *b, uint32_t rgb_stride, \
+	YCbCrType yuv_type);
+
+#define YUV_RGB_PLANAR_FLOAT_DECLARATIONS(FORMAT, TYPE, SUFFIX) \
+void yuv420_##FORMAT##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *y, const uint8_t *u, const uint8_t *v, uint32_t y_stride, uint32_t uv_stride, \
+	TYPE *r, TYPE *g, TYPE *b, uint32_t rgb_stride, const RGBNormalization *norm, \
+	YCbCrType yuv_type); \
+void nv12_##FORMAT##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, \
+	TYPE *r, TYPE *g, TYPE *b, uint32_t rgb_stride, const RGBNormalization *norm, \
+	YCbCrType yuv_type); \
+void nv21_##FORMAT##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, \
+	TYPE *r, TYPE *g, TYPE *b, uint32_t rgb_stride, const RGBNormalization *norm, \
+	YCbCrType yuv_type);
+
+#define YUV_RGB_PLANAR_ALL_DECLARATIONS(SUFFIX) \
+	YUV_RGB_PLANAR_DECLARATIONS(rgb_planar, SUFFIX) \
+	YUV_RGB_PLANAR_FLOAT_DECLARATIONS(rgb_planar_f32, float, SUFFIX) \
+	YUV_RGB_PLANAR_FLOAT_DECLARATIONS(rgb_planar_f16, uint16_t, SUFFIX)
+
+YUV_RGB_PLANAR_ALL_DECLARATIONS(_std)
+YUV_RGB_PLANAR_ALL_DECLARATIONS(_sse)
+YUV_RGB_PLANAR_ALL_DECLARATIONS(_sseu)
+YUV_RGB_PLANAR_ALL_DECLARATIONS(_neon)
+YUV_RGB_PLANAR_ALL_DECLARATIONS()
+
+#undef YUV_RGB_PLANAR_ALL_DECLARATIONS
+#undef YUV_RGB_PLANAR_FLOAT_DECLARATIONS
+#undef YUV_RGB_PLANAR_DECLARATIONS
+
+// High bit depth input
+// The yuv samples are 16 bits values, and the strides are in bytes:
+// - yuv420p10: planar yuv420 with 10 bits samples in the least significant bits (yuv420p10le)
+// - p010: semi planar yuv420 (interleaved u and v, like nv12) with the significant bits in the most significant bits,
+// so that p012 and p016 are also converted by the p010 functions
+// The output formats are:
+// - rgb24: 8 bits r, g and b values
+// - rgb48: 16 bits r, g and b values, in little endian
+// - x2rgb10: 32 bits little endian values, with b in bits 0-9, g in bits 10-19, r in bits 20-29, and the two high bits
+// set to 1
+// The digital ranges of the yuv color spaces are those of the 8 bits values multiplied by 256 (for example [4096:60160]
+// for y in bt.601 and bt.709, matching [64:940] in 10 bits), and the computations use 32 bits intermediates, so that
+// the 16 bits rgb values are accurate to a few units.
+// Each format has a standard c, sse, sse unaligned and neon implementation, and a version without suffix selecting the
+// fastest one. All implementations give the same results.
+#define YUV16_RGB_DECLARATIONS(FORMAT, SUFFIX) \
+void yuv420p10_##FORMAT##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint16_t *y, const uint16_t *u, const uint16_t *v, uint32_t y_stride, uint32_t uv_stride, \
+	uint8_t *rgb, uint32_t rgb_stride, \
+	YCbCrType yuv_type); \
+void p010_##FORMAT##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint16_t *y, const uint16_t *uv, uint32_t y_stride, uint32_t uv_stride, \
+	uint8_t *rgb, uint32_t rgb_stride, \
+	YCbCrType yuv_type);
+
+#define YUV16_RGB_ALL_DECLARATIONS(SUFFIX) \
+	YUV16_RGB_DECLARATIONS(rgb24, SUFFIX) \
+	YUV16_RGB_DECLARATIONS(rgb48, SUFFIX) \
+	YUV16_RGB_DECLARATIONS(x2rgb10, SUFFIX)
+
+YUV16_RGB_ALL_DECLARATIONS(_std)
+YUV16_RGB_ALL_DECLARATIONS(_sse)
+YUV16_RGB_ALL_DECLARATIONS(_sseu)
+YUV16_RGB_ALL_DECLARATIONS(_neon)
+YUV16_RGB_ALL_DECLARATIONS()
+
+#undef YUV16_RGB_ALL_DECLARATIONS
+#undef YUV16_RGB_DECLARATIONS
+
+// 4:2:2 and 4:4:4 formats
+// The yuv formats with full vertical chroma resolution are converted to and from rgb24 and rgb32 (the alpha values
+// being ignored by the rgb32 to yuv conversions), for example yuyv_rgb24 or rgb32_yuv444p:
+// - yuv422p: planar, with u and v planes of (width+1)/2 columns and height lines
+// - nv16: semi planar yuv422p (interleaved u and v, like nv12)
+// - yuyv: packed pairs of pixels y0, u, y1, v (also known as yuy2), (width+1)/2 pairs for each line of yuv_stride bytes
+// - uyvy: packed pairs of pixels u, y0, v, y1
+// - yuv444p: planar, with full resolution u and v planes
+// - nv24: semi planar yuv444p, with a pair of interleaved u and v for each pixel
+// For odd widths, the last pixel of the 4:2:2 formats has its own chroma values, and both y values of the last pair
+// of the packed formats are set by the rgb to yuv conversions. The rgb to 4:2:2 conversions average the chroma of the
+// two pixels of each pair.
+// Each conversion has a standard c, sse, sse unaligned and neon implementation, with the same requirements as the
+// yuv420 ones, and a version without suffix selecting the fastest one.
+#define YUV_LINES_DECLARATIONS(FORMAT, SUFFIX) \
+void yuv422p_##FORMAT##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *y, const uint8_t *u, const uint8_t *v, uint32_t y_stride, uint32_t uv_stride, \
+	uint8_t *rgb, uint32_t rgb_stride, \
+	YCbCrType yuv_type); \
+void yuv444p_##FORMAT##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *y, const uint8_t *u, const uint8_t *v, uint32_t y_stride, uint32_t uv_stride, \
+	uint8_t *rgb, uint32_t rgb_stride, \
+	YCbCrType yuv_type); \
+void nv16_##FORMAT##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, \
+	uint8_t *rgb, uint32_t rgb_stride, \
+	YCbCrType yuv_type); \
+void nv24_##FORMAT##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, \
+	uint8_t *rgb, uint32_t rgb_stride, \
+	YCbCrType yuv_type); \
+void yuyv_##FORMAT##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *yuv, uint32_t yuv_stride, \
+	uint8_t *rgb, uint32_t rgb_stride, \
+	YCbCrType yuv_type); \
+void uyvy_##FORMAT##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *yuv, uint32_t yuv_stride, \
+	uint8_t *rgb, uint32_t rgb_stride, \
+	YCbCrType yuv_type); \
+void FORMAT##_yuv422p##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *rgb, uint32_t rgb_stride, \
+	uint8_t *y, uint8_t *u, uint8_t *v, uint32_t y_stride, uint32_t uv_stride, \
+	YCbCrType yuv_type); \
+void FORMAT##_yuv444p##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *rgb, uint32_t rgb_stride, \
+	uint8_t *y, uint8_t *u, uint8_t *v, uint32_t y_stride, uint32_t uv_stride, \
+	YCbCrType yuv_type); \
+void FORMAT##_nv16##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *rgb, uint32_t rgb_stride, \
+	uint8_t *y, uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, \
+	YCbCrType yuv_type); \
+void FORMAT##_nv24##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *rgb, uint32_t rgb_stride, \
+	uint8_t *y, uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, \
+	YCbCrType yuv_type); \
+void FORMAT##_yuyv##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *rgb, uint32_t rgb_stride, \
+	uint8_t *yuv, uint32_t yuv_stride, \
+	YCbCrType yuv_type); \
+void FORMAT##_uyvy##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *rgb, uint32_t rgb_stride, \
+	uint8_t *yuv, uint32_t yuv_stride, \
+	YCbCrType yuv_type);
+
+#define YUV_LINES_ALL_DECLARATIONS(SUFFIX) \
+	YUV_LINES_DECLARATIONS(rgb24, SUFFIX) \
+	YUV_LINES_DECLARATIONS(rgb32, SUFFIX)
+
+YUV_LINES_ALL_DECLARATIONS(_std)
+YUV_LINES_ALL_DECLARATIONS(_sse)
+YUV_LINES_ALL_DECLARATIONS(_sseu)
+YUV_LINES_ALL_DECLARATIONS(_neon)
+YUV_LINES_ALL_DECLARATIONS()
+
+#undef YUV_LINES_ALL_DECLARATIONS
+#undef YUV_LINES_DECLARATIONS
+
+// Direct yuv format conversions
+// Convert between yuv formats without going through rgb:
+// - nv12_yuv420, nv21_yuv420, yuv420_nv12 and yuv420_nv21 split or interleave the chroma planes, the samples being
+//   copied exactly (for example from a hardware decoder to an encoder)
+// - yuyv_yuv420, uyvy_yuv420, yuyv_nv12 and uyvy_nv12 convert the packed 4:2:2 formats to yuv420, the chroma values of
+//   each pair of lines being averaged (rounded up)
+// - yuv420_yuyv, yuv420_uyvy, nv12_yuyv and nv12_uyvy use the same chroma values for both lines of each pair
+// The destination parameters have a _dst suffix, and the y plane is copied unless y_dst is y.
+// Each conversion has a standard c, sse, sse unaligned and neon implementation, the aligned sse one requiring all the
+// source and destination pointers to be 16 byte aligned and strides divisable by 16, and a version without suffix
+// selecting the fastest one.
+#define YUV_DIRECT_DECLARATIONS(SUFFIX) \
+void nv12_yuv420##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, \
+	uint8_t *y_dst, uint8_t *u_dst, uint8_t *v_dst, uint32_t y_dst_stride, uint32_t uv_dst_stride); \
+void nv21_yuv420##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, \
+	uint8_t *y_dst, uint8_t *u_dst, uint8_t *v_dst, uint32_t y_dst_stride, uint32_t uv_dst_stride); \
+void yuv420_nv12##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *y, const uint8_t *u, const uint8_t *v, uint32_t y_stride, uint32_t uv_stride, \
+	uint8_t *y_dst, uint8_t *uv_dst, uint32_t y_dst_stride, uint32_t uv_dst_stride); \
+void yuv420_nv21##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *y, const uint8_t *u, const uint8_t *v, uint32_t y_stride, uint32_t uv_stride, \
+	uint8_t *y_dst, uint8_t *uv_dst, uint32_t y_dst_stride, uint32_t uv_dst_stride); \
+void yuyv_yuv420##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *yuv, uint32_t yuv_stride, \
+	uint8_t *y_dst, uint8_t *u_dst, uint8_t *v_dst, uint32_t y_dst_stride, uint32_t uv_dst_stride); \
+void uyvy_yuv420##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *yuv, uint32_t yuv_stride, \
+	uint8_t *y_dst, uint8_t *u_dst, uint8_t *v_dst, uint32_t y_dst_stride, uint32_t uv_dst_stride); \
+void yuyv_nv12##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *yuv, uint32_t yuv_stride, \
+	uint8_t *y_dst, uint8_t *uv_dst, uint32_t y_dst_stride, uint32_t uv_dst_stride); \
+void uyvy_nv12##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *yuv, uint32_t yuv_stride, \
+	uint8_t *y_dst, uint8_t *uv_dst, uint32_t y_dst_stride, uint32_t uv_dst_stride); \
+void yuv420_yuyv##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *y, const uint8_t *u, const uint8_t *v, uint32_t y_stride, uint32_t uv_stride, \
+	uint8_t *yuv_dst, uint32_t yuv_dst_stride); \
+void yuv420_uyvy##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *y, const uint8_t *u, const uint8_t *v, uint32_t y_stride, uint32_t uv_stride, \
+	uint8_t *yuv_dst, uint32_t yuv_dst_stride); \
+void nv12_yuyv##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, \
+	uint8_t *yuv_dst, uint32_t yuv_dst_stride); \
+void nv12_uyvy##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, \
+	uint8_t *yuv_dst, uint32_t yuv_dst_stride);
+
+YUV_DIRECT_DECLARATIONS(_std)
+YUV_DIRECT_DECLARATIONS(_sse)
+YUV_DIRECT_DECLARATIONS(_sseu)
+YUV_DIRECT_DECLARATIONS(_neon)
+YUV_DIRECT_DECLARATIONS()
+
+#undef YUV_DIRECT_DECLARATIONS
+
+// Precise rgb to yuv conversions
+// The default rgb to yuv conversions use 8 bits factors with 16 bits intermediates, and truncate their results, so
+// that y and the chroma values can be up to a few units lower than the exact values. The *_precise versions compute
+// them with 15 bits factors and 32 bits intermediates, with rounding, so that they are within 1 of the floating point
+// conversion (and exact for black, white and grays), which gives a better psnr for encoders. On a 4K image, the sse
+// version is about 20% slower than the default sse version, and half as fast as the default avx2 version (there is
+// no avx2 precise version), while the standard c version has the same speed (see the test program).
+// Each conversion has a standard c, sse, sse unaligned and neon implementation, with the same requirements as the
+// other rgb to yuv conversions, and a version without suffix selecting the fastest one. All implementations give
+// the same results.
+#define RGB_YUV_PRECISE_DECLARATIONS(SUFFIX) \
+void rgb24_yuv420_precise##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *rgb, uint32_t rgb_stride, \
+	uint8_t *y, uint8_t *u, uint8_t *v, uint32_t y_stride, uint32_t uv_stride, \
+	YCbCrType yuv_type); \
+void rgb32_yuv420_precise##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *rgba, uint32_t rgba_stride, \
+	uint8_t *y, uint8_t *u, uint8_t *v, uint32_t y_stride, uint32_t uv_stride, \
+	YCbCrType yuv_type);
+
+RGB_YUV_PRECISE_DECLARATIONS(_std)
+RGB_YUV_PRECISE_DECLARATIONS(_sse)
+RGB_YUV_PRECISE_DECLARATIONS(_sseu)
+RGB_YUV_PRECISE_DECLARATIONS(_neon)
+RGB_YUV_PRECISE_DECLARATIONS()
+
+#undef RGB_YUV_PRECISE_DECLARATIONS
+
+// YUVA420 conversions
+// yuva420 is yuv420 with a full resolution alpha plane a, which uses the stride of the y plane (as used for VP9
+// alpha in WebM). rgb32_yuva420 converts rgba to yuva420, a being optional (NULL to only convert the colors), and
+// if premultiplied is not 0, the colors are premultiplied by alpha and are divided by it before the conversion
+// (rounded to the nearest integer, transparent pixels being black). yuva420_rgb32 converts yuva420 to rgba with the
+// alpha values of the alpha plane, and yuva420_bgra_premultiplied to bgra with colors premultiplied by alpha (c*a/255
+// rounded to the nearest integer).
+// Each conversion has a standard c, sse, sse unaligned and neon implementation, with the same requirements as the
+// other conversions (including the alpha plane), and a version without suffix selecting the fastest one. All
+// implementations give the same results.
+#define YUVA_RGB_DECLARATIONS(SUFFIX) \
+void rgb32_yuva420##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *rgba, uint32_t rgba_stride, \
+	uint8_t *y, uint8_t *u, uint8_t *v, uint8_t *a, uint32_t y_stride, uint32_t uv_stride, \
+	int premultiplied, YCbCrType yuv_type); \
+void yuva420_rgb32##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *y, const uint8_t *u, const uint8_t *v, const uint8_t *a, uint32_t y_stride, uint32_t uv_stride, \
+	uint8_t *rgba, uint32_t rgba_stride, \
+	YCbCrType yuv_type); \
+void yuva420_bgra_premultiplied##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *y, const uint8_t *u, const uint8_t *v, const uint8_t *a, uint32_t y_stride, uint32_t uv_stride, \
+	uint8_t *bgra, uint32_t bgra_stride, \
+	YCbCrType yuv_type);
+
+YUVA_RGB_DECLARATIONS(_std)
+YUVA_RGB_DECLARATIONS(_sse)
+YUVA_RGB_DECLARATIONS(_sseu)
+YUVA_RGB_DECLARATIONS(_neon)
+YUVA_RGB_DECLARATIONS()
+
+#undef YUVA_RGB_DECLARATIONS
+
+// Multi-threaded conversions
+// A pool of worker threads is created once, and used by the *_mt versions of the conversions, which split the
+// image in horizontal bands (of pairs of lines) converted in parallel by the worker threads and the calling thread,
+// each band with the fastest implementation supported by the cpu (see yuv420_rgb24, ...).
+// No allocation is done during conversions. A pool must only be used by one conversion at a time.
+typedef struct yuv_rgb_pool yuv_rgb_pool;
+
+// number of cores available
+uint32_t yuv_rgb_cpu_count(void);
+
+// create a pool of thread_number worker threads, conversions then use thread_number+1 threads including the calling
+// thread, so thread_number=yuv_rgb_cpu_count()-1 uses all cores
+// if cpus is not NULL, it contains thread_number core indices, worker thread i being pinned to core cpus[i]
+// (on linux and windows only, ignored elsewhere)
+// return NULL on error
+yuv_rgb_pool *yuv_rgb_pool_create(uint32_t thread_number, const int *cpus);
+
+// stop the worker threads and free the pool, pool can be NULL
+void yuv_rgb_pool_destroy(yuv_rgb_pool *pool);
+
+// number of worker threads of the pool, 0 if pool is NULL
+uint32_t yuv_rgb_pool_thread_number(const yuv_rgb_pool *pool);
+
+// multi-threaded versions of the conversions, pool can be NULL to convert in the calling thread only
+void yuv420_rgb24_mt(yuv_rgb_pool *pool,
+	uint32_t width, uint32_t height, 
+	const uint8_t *y, const uint8_t *u, const uint8_t *v, uint32_t y_stride, uint32_t uv_stride, 
+	uint8_t *rgb, uint32_t rgb_stride, 
+	YCbCrType yuv_type);
+
+void nv12_rgb24_mt(yuv_rgb_pool *pool,
+	uint32_t width, uint32_t height, 
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, 
+	uint8_t *rgb, uint32_t rgb_stride, 
+	YCbCrType yuv_type);
+
+void nv21_rgb24_mt(yuv_rgb_pool *pool,
+	uint32_t width, uint32_t height, 
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, 
+	uint8_t *rgb, uint32_t rgb_stride, 
+	YCbCrType yuv_type);
+
+void rgb24_yuv420_mt(yuv_rgb_pool *pool,
+	uint32_t width, uint32_t height, 
+	const uint8_t *rgb, uint32_t rgb_stride, 
+	uint8_t *y, uint8_t *u, uint8_t *v, uint32_t y_stride, uint32_t uv_stride, 
+	YCbCrType yuv_type);
+
+// alpha channel is ignored
+void rgb32_yuv420_mt(yuv_rgb_pool *pool,
+	uint32_t width, uint32_t height, 
+	const uint8_t *rgba, uint32_t rgba_stride, 
+	uint8_t *y, uint8_t *u, uint8_t *v, uint32_t y_stride, uint32_t uv_stride, 
+	YCbCrType yuv_type);
+
+// multi-threaded versions of the other conversions, taking the pool followed by the arguments of the versions without
+// suffix: the other rgb formats (yuv420_rgb32_mt, nv12_bgra_mt, ...), planar rgb, high bit depth, 4:2:2 and 4:4:4
+// formats, direct yuv, precise and yuva conversions
+// the bilinear conversions have no multi-threaded versions, since the chroma of each pair of lines is interpolated with
+// the chroma lines of the neighbouring pairs, which are not in the same band
+#define YUV_RGB_FORMAT_MT_DECLARATIONS(FORMAT) \
+void yuv420_##FORMAT##_mt(yuv_rgb_pool *pool, \
+	uint32_t width, uint32_t height, \
+	const uint8_t *y, const uint8_t *u, const uint8_t *v, uint32_t y_stride, uint32_t uv_stride, \
+	uint8_t *rgb, uint32_t rgb_stride, \
+	YCbCrType yuv_type); \
+void nv12_##FORMAT##_mt(yuv_rgb_pool *pool, \
+	uint32_t width, uint32_t height, \
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, \
+	uint8_t *rgb, uint32_t rgb_stride, \
+	YCbCrType yuv_type); \
+void nv21_##FORMAT##_mt(yuv_rgb_pool *pool, \
+	uint32_t width, uint32_t height, \
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, \
+	uint8_t *rgb, uint32_t rgb_stride, \
+	YCbCrType yuv_type);
+
+YUV_RGB_FORMAT_MT_DECLARATIONS(rgb32)
+YUV_RGB_FORMAT_MT_DECLARATIONS(bgra)
+YUV_RGB_FORMAT_MT_DECLARATIONS(argb)
+YUV_RGB_FORMAT_MT_DECLARATIONS(bgr24)
+YUV_RGB_FORMAT_MT_DECLARATIONS(rgb565)
+
+#define YUV_RGB_PLANAR_MT_DECLARATIONS(FORMAT, TYPE, NORM) \
+void yuv420_##FORMAT##_mt(yuv_rgb_pool *pool, \
+	uint32_t width, uint32_t height, \
+	const uint8_t *y, const uint8_t *u, const uint8_t *v, uint32_t y_stride, uint32_t uv_stride, \
+	TYPE *r, TYPE *g, TYPE *b, uint32_t rgb_stride, NORM \
+	YCbCrType yuv_type); \
+void nv12_##FORMAT##_mt(yuv_rgb_pool *pool, \
+	uint32_t width, uint32_t height, \
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, \
+	TYPE *r, TYPE *g, TYPE *b, uint32_t rgb_stride, NORM \
+	YCbCrType yuv_type); \
+void nv21_##FORMAT##_mt(yuv_rgb_pool *pool, \
+	uint32_t width, uint32_t height, \
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, \
+	TYPE *r, TYPE *g, TYPE *b, uint32_t rgb_stride, NORM \
+	YCbCrType yuv_type);
+
+// normalization parameter of the float formats
+#define PLANAR_MT_NORM const RGBNormalization *norm,
+
+YUV_RGB_PLANAR_MT_DECLARATIONS(rgb_planar, uint8_t, )
+YUV_RGB_PLANAR_MT_DECLARATIONS(rgb_planar_f32, float, PLANAR_MT_NORM)
+YUV_RGB_PLANAR_MT_DECLARATIONS(rgb_planar_f16, uint16_t, PLANAR_MT_NORM)
+
+#define YUV16_RGB_MT_DECLARATIONS(FORMAT) \
+void yuv420p10_##FORMAT##_mt(yuv_rgb_pool *pool, \
+	uint32_t width, uint32_t height, \
+	const uint16_t *y, const uint16_t *u, const uint16_t *v, uint32_t y_stride, uint32_t uv_stride, \
+	uint8_t *rgb, uint32_t rgb_stride, \
+	YCbCrType yuv_type); \
+void p010_##FORMAT##_mt(yuv_rgb_pool *pool, \
+	uint32_t width, uint32_t height, \
+	const uint16_t *y, const uint16_t *uv, uint32_t y_stride, uint32_t uv_stride, \
+	uint8_t *rgb, uint32_t rgb_stride, \
+	YCbCrType yuv_type);
+
+YUV16_RGB_MT_DECLARATIONS(rgb24)
+YUV16_RGB_MT_DECLARATIONS(rgb48)
+YUV16_RGB_MT_DECLARATIONS(x2rgb10)
+
+#define YUV_LINES_MT_DECLARATIONS(NAME, FORMAT) \
+void NAME##_##FORMAT##_mt(yuv_rgb_pool *pool, \
+	uint32_t width, uint32_t height, \
+	const uint8_t *y, const uint8_t *u, const uint8_t *v, uint32_t y_stride, uint32_t uv_stride, \
+	uint8_t *rgb, uint32_t rgb_stride, \
+	YCbCrType yuv_type); \
+void FORMAT##_##NAME##_mt(yuv_rgb_pool *pool, \
+	uint32_t width, uint32_t height, \
+	const uint8_t *rgb, uint32_t rgb_stride, \
+	uint8_t *y, uint8_t *u, uint8_t *v, uint32_t y_stride, uint32_t uv_stride, \
+	YCbCrType yuv_type);
+
+#define YUV_LINES_SP_MT_DECLARATIONS(NAME, FORMAT) \
+void NAME##_##FORMAT##_mt(yuv_rgb_pool *pool, \
+	uint32_t width, uint32_t height, \
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, \
+	uint8_t *rgb, uint32_t rgb_stride, \
+	YCbCrType yuv_type); \
+void FORMAT##_##NAME##_mt(yuv_rgb_pool *pool, \
+	uint32_t width, uint32_t height, \
+	const uint8_t *rgb, uint32_t rgb_stride, \
+	uint8_t *y, uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, \
+	YCbCrType yuv_type);
+
+#define YUV_LINES_PACKED_MT_DECLARATIONS(NAME, FORMAT) \
+void NAME##_##FORMAT##_mt(yuv_rgb_pool *pool, \
+	uint32_t width, uint32_t height, \
+	const uint8_t *yuv, uint32_t yuv_stride, \
+	uint8_t *rgb, uint32_t rgb_stride, \
+	YCbCrType yuv_type); \
+void FORMAT##_##NAME##_mt(yuv_rgb_pool *pool, \
+	uint32_t width, uint32_t height, \
+	const uint8_t *rgb, uint32_t rgb_stride, \
+	uint8_t *yuv, uint32_t yuv_stride, \
+	YCbCrType yuv_type);
+
+#define YUV_LINES_ALL_MT_DECLARATIONS(FORMAT) \
+	YUV_LINES_MT_DECLARATIONS(yuv422p, FORMAT) \
+	YUV_LINES_MT_DECLARATIONS(yuv444p, FORMAT) \
+	YUV_LINES_SP_MT_DECLARATIONS(nv16, FORMAT) \
+	YUV_LINES_SP_MT_DECLARATIONS(nv24, FORMAT) \
+	YUV_LINES_PACKED_MT_DECLARATIONS(yuyv, FORMAT) \
+	YUV_LINES_PACKED_MT_DECLARATIONS(uyvy, FORMAT)
+
+YUV_LINES_ALL_MT_DECLARATIONS(rgb24)
+YUV_LINES_ALL_MT_DECLARATIONS(rgb32)
+
+#define YUV_DIRECT_MT_DECLARATIONS(SRC, SRC_PARAM, DST, DST_PARAM) \
+void SRC##_##DST##_mt(yuv_rgb_pool *pool, \
+	uint32_t width, uint32_t height, \
+	SRC_PARAM, \
+	DST_PARAM);
+
+#define YUV420_MT_SRC const uint8_t *y, const uint8_t *u, const uint8_t *v, uint32_t y_stride, uint32_t uv_stride
+#define NV12_MT_SRC const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride
+#define PACKED_MT_SRC const uint8_t *yuv, uint32_t yuv_stride
+#define YUV420_MT_DST uint8_t *y_dst, uint8_t *u_dst, uint8_t *v_dst, uint32_t y_dst_stride, uint32_t uv_dst_stride
+#define NV12_MT_DST uint8_t *y_dst, uint8_t *uv_dst, uint32_t y_dst_stride, uint32_t uv_dst_stride
+#define PACKED_MT_DST uint8_t *yuv_dst, uint32_t yuv_dst_stride
+
+YUV_DIRECT_MT_DECLARATIONS(nv12, NV12_MT_SRC, yuv420, YUV420_MT_DST)
+YUV_DIRECT_MT_DECLARATIONS(nv21, NV12_MT_SRC, yuv420, YUV420_MT_DST)
+YUV_DIRECT_MT_DECLARATIONS(yuv420, YUV420_MT_SRC, nv12, NV12_MT_DST)
+YUV_DIRECT_MT_DECLARATIONS(yuv420, YUV420_MT_SRC, nv21, NV12_MT_DST)
+YUV_DIRECT_MT_DECLARATIONS(yuyv, PACKED_MT_SRC, yuv420, YUV420_MT_DST)
+YUV_DIRECT_MT_DECLARATIONS(uyvy, PACKED_MT_SRC, yuv420, YUV420_MT_DST)
+YUV_DIRECT_MT_DECLARATIONS(yuyv, PACKED_MT_SRC, nv12, NV12_MT_DST)
+YUV_DIRECT_MT_DECLARATIONS(uyvy, PACKED_MT_SRC, nv12, NV12_MT_DST)
+YUV_DIRECT_MT_DECLARATIONS(yuv420, YUV420_MT_SRC, yuyv, PACKED_MT_DST)
+YUV_DIRECT_MT_DECLARATIONS(yuv420, YUV420_MT_SRC, uyvy, PACKED_MT_DST)
+YUV_DIRECT_MT_DECLARATIONS(nv12, NV12_MT_SRC, yuyv, PACKED_MT_DST)
+YUV_DIRECT_MT_DECLARATIONS(nv12, NV12_MT_SRC, uyvy, PACKED_MT_DST)
+
+void rgb24_yuv420_precise_mt(yuv_rgb_pool *pool,
+	uint32_t width, uint32_t height,
+	const uint8_t *rgb, uint32_t rgb_stride,
+	uint8_t *y, uint8_t *u, uint8_t *v, uint32_t y_stride, uint32_t uv_stride,
+	YCbCrType yuv_type);
+
+void rgb32_yuv420_precise_mt(yuv_rgb_pool *pool,
+	uint32_t width, uint32_t height,
+	const uint8_t *rgba, uint32_t rgba_stride,
+	uint8_t *y, uint8_t *u, uint8_t *v, uint32_t y_stride, uint32_t uv_stride,
+	YCbCrType yuv_type);
+
+void rgb32_yuva420_mt(yuv_rgb_pool *pool,
+	uint32_t width, uint32_t height,
+	const uint8_t *rgba, uint32_t rgba_stride,
+	uint8_t *y, uint8_t *u, uint8_t *v, uint8_t *a, uint32_t y_stride, uint32_t uv_stride,
+	int premultiplied, YCbCrType yuv_type);
+
+void yuva420_rgb32_mt(yuv_rgb_pool *pool,
+	uint32_t width, uint32_t height,
+	const uint8_t *y, const uint8_t *u, const uint8_t *v, const uint8_t *a, uint32_t y_stride, uint32_t uv_stride,
+	uint8_t *rgba, uint32_t rgba_stride,
+	YCbCrType yuv_type);
+
+void yuva420_bgra_premultiplied_mt(yuv_rgb_pool *pool,
+	uint32_t width, uint32_t height,
+	const uint8_t *y, const uint8_t *u, const uint8_t *v, const uint8_t *a, uint32_t y_stride, uint32_t uv_stride,
+	uint8_t *bgra, uint32_t bgra_stride,
+	YCbCrType yuv_type);
+
+#undef YUV_RGB_FORMAT_MT_DECLARATIONS
+#undef YUV_RGB_PLANAR_MT_DECLARATIONS
+#undef PLANAR_MT_NORM
+#undef YUV16_RGB_MT_DECLARATIONS
+#undef YUV_LINES_MT_DECLARATIONS
+#undef YUV_LINES_SP_MT_DECLARATIONS
+#undef YUV_LINES_PACKED_MT_DECLARATIONS
+#undef YUV_LINES_ALL_MT_DECLARATIONS
+#undef YUV_DIRECT_MT_DECLARATIONS
+#undef YUV420_MT_SRC
+#undef NV12_MT_SRC
+#undef PACKED_MT_SRC
+#undef YUV420_MT_DST
+#undef NV12_MT_DST
+#undef PACKED_MT_DST
+
+// Scaled conversions
+// Convert and resize an image in a single pass: the source is converted by pairs of lines into a small buffer, from
+// which the destination lines are computed, so that the full size rgb image is never stored. A scaler is created once
+// for given source and destination sizes, and can then be used for any number of images of these sizes.
+// A scaler must only be used by one conversion at a time.
+
+typedef enum
+{
+	// average of the source pixels covered by each destination pixel, for downscaling only (2x, 4x, or any ratio)
+	SCALE_BOX,
+	// bilinear interpolation of the 4 nearest source pixels, for any ratio
+	SCALE_BILINEAR
+} ScaleFilter;
+
+typedef struct yuv_rgb_scaler yuv_rgb_scaler;
+
+// create a scaler from width x height images to dst_width x dst_height images
+// return NULL on error, or if the sizes are not valid for the filter
+yuv_rgb_scaler *yuv_rgb_scaler_create(uint32_t width, uint32_t height, uint32_t dst_width, uint32_t dst_height,
+	ScaleFilter filter);
+
+// free the scaler, scaler can be NULL
+void yuv_rgb_scaler_destroy(yuv_rgb_scaler *scaler);
+
+// yuv to rgb with scaling, rgb being a dst_width x dst_height image
+void yuv420_rgb24_scale(
+	yuv_rgb_scaler *scaler,
+	const uint8_t *y, const uint8_t *u, const uint8_t *v, uint32_t y_stride, uint32_t uv_stride, 
+	uint8_t *rgb, uint32_t rgb_stride, 
+	YCbCrType yuv_type);
+
+// yuv nv12 to rgb with scaling, rgb being a dst_width x dst_height image
+void nv12_rgb24_scale(
+	yuv_rgb_scaler *scaler,
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, 
+	uint8_t *rgb, uint32_t rgb_stride, 
+	YCbCrType yuv_type);
+
+// yuv nv21 to rgb with scaling, rgb being a dst_width x dst_height image
+void nv21_rgb24_scale(
+	yuv_rgb_scaler *scaler,
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, 
+	uint8_t *rgb, uint32_t rgb_stride, 
+	YCbCrType yuv_type);
+
+// Rotated conversions
+// Convert and rotate (and optionally mirror) an image in a single pass, by tiles of 64x64 pixels that stay in cache,
+// instead of converting the image and rotating it in a second pass, whose column-wise accesses miss the cache on
+// every line. The result is the same as the conversion followed by the rotation.
+// width and height are the size of the source image, the destination image being height x width for 90 and 270
+// degrees rotations. If flip is not 0, the image is mirrored horizontally before being rotated (a vertical flip is a
+// 180 degrees rotation with flip).
+
+// clockwise rotations
+typedef enum
+{
+	YUVRGB_ROTATE_0,
+	YUVRGB_ROTATE_90,
+	YUVRGB_ROTATE_180,
+	YUVRGB_ROTATE_270
+} YUVRGBRotation;
+
+#define ROTATE_DECLARATIONS(FORMAT) \
+void yuv420_##FORMAT##_rotate( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *y, const uint8_t *u, const uint8_t *v, uint32_t y_stride, uint32_t uv_stride, \
+	uint8_t *rgb, uint32_t rgb_stride, \
+	YCbCrType yuv_type, YUVRGBRotation rotation, int flip); \
+void nv12_##FORMAT##_rotate( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, \
+	uint8_t *rgb, uint32_t rgb_stride, \
+	YCbCrType yuv_type, YUVRGBRotation rotation, int flip); \
+void nv21_##FORMAT##_rotate( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride, \
+	uint8_t *rgb, uint32_t rgb_stride, \
+	YCbCrType yuv_type, YUVRGBRotation rotation, int flip); \
+void FORMAT##_yuv420_rotate( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *rgb, uint32_t rgb_stride, \
+	uint8_t *y, uint8_t *u, uint8_t *v, uint32_t y_stride, uint32_t uv_stride, \
+	YCbCrType yuv_type, YUVRGBRotation rotation, int flip);
+
+ROTATE_DECLARATIONS(rgb24)
+// the alpha channel is set to 255 by the yuv to rgb32 conversions, and ignored by rgb32 to yuv
+ROTATE_DECLARATIONS(rgb32)
+
+#undef ROTATE_DECLARATIONS
+
+// Conversions of rectangles
+// Convert only some rectangles of an image (for example the regions that changed since the previous frame) into an
+// existing output image, whose other pixels are left unchanged. The result is the same as the conversion of the whole
+// image, for the pixels of the snapped rectangles.
+// Each rectangle is first snapped with yuv_rgb_rect_snap, and rectangles that overlap are converted once each (it is
+// faster to merge them before when they overlap a lot).
+
+typedef struct
+{
+	uint32_t x, y, width, height;
+} YUVRGBRect;
+
+// enlarge rect so that it starts at an even line and a multiple of the simd block width, and ends at an even line
+// and a multiple of the block width or at the border of the width x height image, and clip it to the image
+// the block width is the one of the widest implementation selected on this cpu: 128 pixels with avx512, 64 with
+// avx2, 32 with sse, 16 with neon, and 2 without simd
+// the snapped rectangle covers whole 2x2 chroma blocks and simd blocks, and is the area actually written by the
+// conversions of rect
+// return 0 (and an empty rectangle) if rect is empty or outside of the image, 1 otherwise
+int yuv_rgb_rect_snap(const YUVRGBRect *rect, uint32_t width, uint32_t height, YUVRGBRect *snapped);
+
+#define RECTS_DECLARATIONS(FORMAT) \
+void yuv420_##FORMAT##_rects( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *y, const uint8_t *u, const uint8_t *v, uint32_t y_stride, uint32_t uv_stride, \
+	uint8_t *rgb, uint32_t rgb_stride, \
+	YCbCrType yuv_type, const YUVRGBRect *rects, uint32_t rect_number); \
+void FORMAT##_yuv420_rects( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *rgb, uint32_t rgb_stride, \
+	uint8_t *y, uint8_t *u, uint8_t *v, uint32_t y_stride, uint32_t uv_stride, \
+	YCbCrType yuv_type, const YUVRGBRect *rects, uint32_t rect_number);
+
+RECTS_DECLARATIONS(rgb24)
+// the alpha channel is set to 255 by the yuv to rgb32 conversion, and ignored by rgb32 to yuv
+RECTS_DECLARATIONS(rgb32)
+
+#undef RECTS_DECLARATIONS
+
+// Streaming conversions
+// Convert an image by bands of lines, as they are produced (for example by the slices of a decoder), instead of
+// waiting for the whole image. A stream is created once for a given image size, and each image is converted by a
+// start function, which sets the destination image, followed by pushes of the bands of source lines, from top to
+// bottom. The bands can have any number of lines, and only need to be valid during the push: when a band ends in the
+// middle of a pair of lines, the line needed for the chroma of the pair is kept by the stream. The result is the same
+// as the conversion of the whole image.
+// A stream must only be used by one conversion at a time.
+
+typedef struct yuv_rgb_stream yuv_rgb_stream;
+
+// create a stream for width x height images
+// return NULL on error
+yuv_rgb_stream *yuv_rgb_stream_create(uint32_t width, uint32_t height);
+
+// free the stream, stream can be NULL
+void yuv_rgb_stream_destroy(yuv_rgb_stream *stream);
+
+// start the conversion of a yuv420 image to the rgb24 or rgb32 (alpha set to 255) image rgb
+void yuv420_rgb24_stream_start(yuv_rgb_stream *stream, uint8_t *rgb, uint32_t rgb_stride, YCbCrType yuv_type);
+void yuv420_rgb32_stream_start(yuv_rgb_stream *stream, uint8_t *rgb, uint32_t rgb_stride, YCbCrType yuv_type);
+
+// convert the next line_number lines of the yuv420 image, y pointing to the first of them, and u and v to the first
+// chroma line that was not in the previous bands (the chroma line of the first even line of the band, u and v are not
+// used if there is none)
+// return the number of rgb lines written since the start of the image, which can be used by the next processing step
+uint32_t yuv420_stream_push(yuv_rgb_stream *stream, uint32_t line_number,
+	const uint8_t *y, const uint8_t *u, const uint8_t *v, uint32_t y_stride, uint32_t uv_stride);
+
+// start the conversion of a rgb24 or rgb32 (alpha ignored) image to the yuv420 image y, u, v
+void rgb24_yuv420_stream_start(yuv_rgb_stream *stream, uint8_t *y, uint8_t *u, uint8_t *v, uint32_t y_stride,
+	uint32_t uv_stride, YCbCrType yuv_type);
+void rgb32_yuv420_stream_start(yuv_rgb_stream *stream, uint8_t *y, uint8_t *u, uint8_t *v, uint32_t y_stride,
+	uint32_t uv_stride, YCbCrType yuv_type);
+
+// convert the next line_number lines of the rgb image, rgb pointing to the first of them
+// return the number of luma lines written since the start of the image (the chroma lines of the written pairs of
+// lines are written too), which is one less than the number of pushed lines when the last band ends in the middle
+// of a pair of lines
+uint32_t rgb_stream_push(yuv_rgb_stream *stream, uint32_t line_number, const uint8_t *rgb, uint32_t rgb_stride);
+
+// Batch conversions
+// Convert frame_number frames of any size and color space in one call, with the fastest implementation supported by
+// the cpu. If pool is not NULL, frames are spread across its threads, with a single wake up of the pool for the batch,
+// which is faster than multi-threaded conversions of each frame for small frames.
+
+// description of a frame to convert from yuv420 to rgb24
+typedef struct
+{
+	uint32_t width, height;
+	const uint8_t *y, *u, *v;
+	uint32_t y_stride, uv_stride;
+	uint8_t *rgb;
+	uint32_t rgb_stride;
+	YCbCrType yuv_type;
+} YUV2RGBFrame;
+
+// description of a frame to convert from rgb24 or rgba to yuv420
+typedef struct
+{
+	uint32_t width, height;
+	const uint8_t *rgb;
+	uint32_t rgb_stride;
+	uint8_t *y, *u, *v;
+	uint32_t y_stride, uv_stride;
+	YCbCrType yuv_type;
+} RGB2YUVFrame;
+
+void yuv420_rgb24_batch(yuv_rgb_pool *pool, const YUV2RGBFrame *frames, uint32_t frame_number);
+
+void rgb24_yuv420_batch(yuv_rgb_pool *pool, const RGB2YUVFrame *frames, uint32_t frame_number);
+
+// rgb is rgba data, alpha channel is ignored
+void rgb32_yuv420_batch(yuv_rgb_pool *pool, const RGB2YUVFrame *frames, uint32_t frame_number);
+
+// Frames
+// A YUVRGBImage describes an image of one of the formats below (its size, planes and strides), and the conversion
+// between two images is selected from their formats. The images allocated by yuv_rgb_image_alloc, or taken from a
+// yuv_rgb_frame_pool, have 64 bytes aligned planes and strides multiple of 64, so that their conversions always use
+// the aligned implementations of the widest simd kernels, without any copy.
+typedef enum
+{
+	YUVRGB_FORMAT_YUV420, // y, u and v planes
+	YUVRGB_FORMAT_NV12,   // y plane and interleaved uv plane
+	YUVRGB_FORMAT_NV21,   // y plane and interleaved vu plane
+	YUVRGB_FORMAT_RGB24,
+	YUVRGB_FORMAT_RGB32   // rgba
+} YUVRGBFormat;
+
+// planes[0] is the y or rgb plane, planes[1] the u, uv or vu plane and planes[2] the v plane, unused planes being
+// NULL (with a 0 stride), and the chroma planes having (width+1)/2 columns and (height+1)/2 lines
+// images described by the caller must set memory to NULL
+typedef struct
+{
+	YUVRGBFormat format;
+	uint32_t width, height;
+	uint8_t *planes[3];
+	uint32_t strides[3];
+	// allocated memory of the planes, NULL if they are owned by the caller
+	void *memory;
+} YUVRGBImage;
+
+// allocate a width x height image of the given format, in a single block
+// return 0 on success, or -1 on error (image is then cleared)
+int yuv_rgb_image_alloc(YUVRGBImage *image, YUVRGBFormat format, uint32_t width, uint32_t height);
+
+// free the memory of an image allocated by yuv_rgb_image_alloc (or taken from a frame pool), and clear it
+void yuv_rgb_image_free(YUVRGBImage *image);
+
+// convert src to dst, which must have the same size, with the fastest implementation supported by the cpu
+// (yuv420_rgb24, nv12_rgb32, rgb24_yuv420, nv12_yuv420, ...), yuv_type being ignored between yuv formats
+// return 0 on success, or -1 if the sizes differ or if there is no conversion between the formats
+int yuv_rgb_image_convert(const YUVRGBImage *src, const YUVRGBImage *dst, YCbCrType yuv_type);
+
+// A frame pool recycles the images of a given format and size: released images are kept and handed out again,
+// so that no allocation is done in steady state. A frame pool must only be used by one thread at a time.
+typedef struct yuv_rgb_frame_pool yuv_rgb_frame_pool;
+
+// create a pool of width x height images of the given format, with frame_number images allocated upfront
+// return NULL on error
+yuv_rgb_frame_pool *yuv_rgb_frame_pool_create(YUVRGBFormat format, uint32_t width, uint32_t height,
+	uint32_t frame_number);
+
+// free the pool and the images it holds, pool can be NULL
+// images that were not released can still be freed with yuv_rgb_image_free
+void yuv_rgb_frame_pool_destroy(yuv_rgb_frame_pool *pool);
+
+// take an image from the pool, allocating a new one if all of them are in use
+// return 0 on success, or -1 on error
+int yuv_rgb_frame_pool_get(yuv_rgb_frame_pool *pool, YUVRGBImage *image);
+
+// give an image taken from the pool back to it, and clear it, an image with a NULL memory being ignored
+// return 0 on success, or -1 if the image does not have the format and size of the pool (it is then left untouched)
+int yuv_rgb_frame_pool_release(yuv_rgb_frame_pool *pool, YUVRGBImage *image);
+
 #ifdef __cplusplus
 }
 #endif
+
+#endif
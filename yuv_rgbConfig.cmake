@@ -0,0 +1,7 @@
+# cmake package of the yuv_rgb library, see the install rules of CMakeLists.txt
+include(CMakeFindDependencyMacro)
+find_dependency(Threads)
+if(@USE_OPENCL@)
+	find_dependency(OpenCL)
+endif()
+include("${CMAKE_CURRENT_LIST_DIR}/yuv_rgbTargets.cmake")
@@ -0,0 +1,431 @@
+// Copyright 2016 Adrien Descamps
+// Distributed under BSD 3-Clause License
+
+// AVX2 implementation of the yuv to rgb and rgb to yuv conversions, processing 64 pixels per iteration.
+// This file must be compiled with avx2 support (-mavx2), the functions must only be called on a cpu that
+// supports it (see the dispatch functions in yuv_rgb.c).
+
+// The algorithm is the same as the sse version (see yuv_rgb.c), each 128 bits lane of the 256 bits registers
+// processes its own block of 32 pixels: lane 0 handles pixels [0,32) and lane 1 pixels [32,64).
+// Since the unpack and pack instructions work inside each lane, the sse rgb24 packing is reused as is, and
+// the y input and rgb output only need to be redistributed between lanes.
+
+#include "yuv_rgb.h"
+#include "yuv_rgb_internal.h"
+
+#ifdef __AVX2__
+
+#include <immintrin.h>
+
+#define UV2RGB_16_AVX2(U,V,R1,G1,B1,R2,G2,B2) \
+	r_tmp = _mm256_srai_epi16(_mm256_mullo_epi16(V, _mm256_set1_epi16(param->cr_factor)), 6); \
+	g_tmp = _mm256_srai_epi16(_mm256_add_epi16( \
+		_mm256_mullo_epi16(U, _mm256_set1_epi16(param->g_cb_factor)), \
+		_mm256_mullo_epi16(V, _mm256_set1_epi16(param->g_cr_factor))), 7); \
+	b_tmp = _mm256_srai_epi16(_mm256_mullo_epi16(U, _mm256_set1_epi16(param->cb_factor)), 6); \
+	R1 = _mm256_unpacklo_epi16(r_tmp, r_tmp); \
+	G1 = _mm256_unpacklo_epi16(g_tmp, g_tmp); \
+	B1 = _mm256_unpacklo_epi16(b_tmp, b_tmp); \
+	R2 = _mm256_unpackhi_epi16(r_tmp, r_tmp); \
+	G2 = _mm256_unpackhi_epi16(g_tmp, g_tmp); \
+	B2 = _mm256_unpackhi_epi16(b_tmp, b_tmp); \
+
+#define ADD_Y2RGB_16_AVX2(Y1,Y2,R1,G1,B1,R2,G2,B2) \
+	Y1 = _mm256_srli_epi16(_mm256_mullo_epi16(Y1, _mm256_set1_epi16(param->y_factor)), 7); \
+	Y2 = _mm256_srli_epi16(_mm256_mullo_epi16(Y2, _mm256_set1_epi16(param->y_factor)), 7); \
+	\
+	R1 = _mm256_add_epi16(Y1, R1); \
+	G1 = _mm256_sub_epi16(Y1, G1); \
+	B1 = _mm256_add_epi16(Y1, B1); \
+	R2 = _mm256_add_epi16(Y2, R2); \
+	G2 = _mm256_sub_epi16(Y2, G2); \
+	B2 = _mm256_add_epi16(Y2, B2); \
+
+#define PACK_RGB24_32_STEP_AVX2(RS1, RS2, RS3, RS4, RS5, RS6, RD1, RD2, RD3, RD4, RD5, RD6) \
+RD1 = _mm256_packus_epi16(_mm256_and_si256(RS1,_mm256_set1_epi16(0xFF)), _mm256_and_si256(RS2,_mm256_set1_epi16(0xFF))); \
+RD2 = _mm256_packus_epi16(_mm256_and_si256(RS3,_mm256_set1_epi16(0xFF)), _mm256_and_si256(RS4,_mm256_set1_epi16(0xFF))); \
+RD3 = _mm256_packus_epi16(_mm256_and_si256(RS5,_mm256_set1_epi16(0xFF)), _mm256_and_si256(RS6,_mm256_set1_epi16(0xFF))); \
+RD4 = _mm256_packus_epi16(_mm256_srli_epi16(RS1,8), _mm256_srli_epi16(RS2,8)); \
+RD5 = _mm256_packus_epi16(_mm256_srli_epi16(RS3,8), _mm256_srli_epi16(RS4,8)); \
+RD6 = _mm256_packus_epi16(_mm256_srli_epi16(RS5,8), _mm256_srli_epi16(RS6,8)); \
+
+#define PACK_RGB24_32_AVX2(R1, R2, G1, G2, B1, B2, RGB1, RGB2, RGB3, RGB4, RGB5, RGB6) \
+PACK_RGB24_32_STEP_AVX2(R1, R2, G1, G2, B1, B2, RGB1, RGB2, RGB3, RGB4, RGB5, RGB6) \
+PACK_RGB24_32_STEP_AVX2(RGB1, RGB2, RGB3, RGB4, RGB5, RGB6, R1, R2, G1, G2, B1, B2) \
+PACK_RGB24_32_STEP_AVX2(R1, R2, G1, G2, B1, B2, RGB1, RGB2, RGB3, RGB4, RGB5, RGB6) \
+PACK_RGB24_32_STEP_AVX2(RGB1, RGB2, RGB3, RGB4, RGB5, RGB6, R1, R2, G1, G2, B1, B2) \
+PACK_RGB24_32_STEP_AVX2(R1, R2, G1, G2, B1, B2, RGB1, RGB2, RGB3, RGB4, RGB5, RGB6) \
+
+// each lane of rgb_1 to rgb_6 contains 16 bytes of the rgb24 output of its 32 pixels block,
+// so that the 96 bytes of the first block are in the low lanes and the ones of the second block in the high lanes
+#define SAVE_RGB24_64_AVX2(PTR) \
+	SAVE_SI256((__m256i*)(PTR), _mm256_permute2x128_si256(rgb_1, rgb_2, 0x20)); \
+	SAVE_SI256((__m256i*)(PTR+32), _mm256_permute2x128_si256(rgb_3, rgb_4, 0x20)); \
+	SAVE_SI256((__m256i*)(PTR+64), _mm256_permute2x128_si256(rgb_5, rgb_6, 0x20)); \
+	SAVE_SI256((__m256i*)(PTR+96), _mm256_permute2x128_si256(rgb_1, rgb_2, 0x31)); \
+	SAVE_SI256((__m256i*)(PTR+128), _mm256_permute2x128_si256(rgb_3, rgb_4, 0x31)); \
+	SAVE_SI256((__m256i*)(PTR+160), _mm256_permute2x128_si256(rgb_5, rgb_6, 0x31)); \
+
+#define LOAD_UV_PLANAR_AVX2 \
+	__m256i u = LOAD_SI256((const __m256i*)(u_ptr)); \
+	__m256i v = LOAD_SI256((const __m256i*)(v_ptr)); \
+
+// the in lane packing mixes the 64 bits words of u and v, they are put back in order with a permute
+#define LOAD_UV_NV12_AVX2 \
+	__m256i uv1 = LOAD_SI256((const __m256i*)(uv_ptr)); \
+	__m256i uv2 = LOAD_SI256((const __m256i*)(uv_ptr+32)); \
+	__m256i u = _mm256_packus_epi16(_mm256_and_si256(uv1, _mm256_set1_epi16(255)), _mm256_and_si256(uv2, _mm256_set1_epi16(255))); \
+	uv1 = _mm256_srli_epi16(uv1, 8); \
+	uv2 = _mm256_srli_epi16(uv2, 8); \
+	__m256i v = _mm256_packus_epi16(uv1, uv2); \
+	u = _mm256_permute4x64_epi64(u, 0xD8); \
+	v = _mm256_permute4x64_epi64(v, 0xD8); \
+
+#define LOAD_UV_NV21_AVX2 \
+	__m256i uv1 = LOAD_SI256((const __m256i*)(uv_ptr)); \
+	__m256i uv2 = LOAD_SI256((const __m256i*)(uv_ptr+32)); \
+	__m256i v = _mm256_packus_epi16(_mm256_and_si256(uv1, _mm256_set1_epi16(255)), _mm256_and_si256(uv2, _mm256_set1_epi16(255))); \
+	uv1 = _mm256_srli_epi16(uv1, 8); \
+	uv2 = _mm256_srli_epi16(uv2, 8); \
+	__m256i u = _mm256_packus_epi16(uv1, uv2); \
+	u = _mm256_permute4x64_epi64(u, 0xD8); \
+	v = _mm256_permute4x64_epi64(v, 0xD8); \
+
+// load 64 y values, and split them so that each lane gets the values of its own block:
+// Y_LO gets pixels [0,16) and [32,48), Y_HI gets pixels [16,32) and [48,64)
+#define LOAD_Y_64_AVX2(PTR, Y_LO, Y_HI) \
+	y_a = LOAD_SI256((const __m256i*)(PTR)); \
+	y_b = LOAD_SI256((const __m256i*)(PTR+32)); \
+	Y_LO = _mm256_permute2x128_si256(y_a, y_b, 0x20); \
+	Y_HI = _mm256_permute2x128_si256(y_a, y_b, 0x31); \
+
+#define YUV2RGB_16_AVX2(Y, R_8, G_8, B_8) \
+	r_16_1=r_uv_16_1; g_16_1=g_uv_16_1; b_16_1=b_uv_16_1; \
+	r_16_2=r_uv_16_2; g_16_2=g_uv_16_2; b_16_2=b_uv_16_2; \
+	\
+	Y = _mm256_subs_epu8(Y, _mm256_set1_epi8(param->y_offset)); \
+	y_16_1 = _mm256_unpacklo_epi8(Y, _mm256_setzero_si256()); \
+	y_16_2 = _mm256_unpackhi_epi8(Y, _mm256_setzero_si256()); \
+	\
+	ADD_Y2RGB_16_AVX2(y_16_1, y_16_2, r_16_1, g_16_1, b_16_1, r_16_2, g_16_2, b_16_2) \
+	\
+	R_8 = _mm256_packus_epi16(r_16_1, r_16_2); \
+	G_8 = _mm256_packus_epi16(g_16_1, g_16_2); \
+	B_8 = _mm256_packus_epi16(b_16_1, b_16_2); \
+
+#define YUV2RGB_64_AVX2 \
+	__m256i r_tmp, g_tmp, b_tmp; \
+	__m256i r_16_1, g_16_1, b_16_1, r_16_2, g_16_2, b_16_2; \
+	__m256i r_uv_16_1, g_uv_16_1, b_uv_16_1, r_uv_16_2, g_uv_16_2, b_uv_16_2; \
+	__m256i y_16_1, y_16_2; \
+	__m256i y_a, y_b, y_11, y_12, y_21, y_22; \
+	__m256i r_8_11, g_8_11, b_8_11, r_8_12, g_8_12, b_8_12; \
+	__m256i r_8_21, g_8_21, b_8_21, r_8_22, g_8_22, b_8_22; \
+	\
+	u = _mm256_add_epi8(u, _mm256_set1_epi8(-128)); \
+	v = _mm256_add_epi8(v, _mm256_set1_epi8(-128)); \
+	\
+	LOAD_Y_64_AVX2(y_ptr1, y_11, y_12) \
+	LOAD_Y_64_AVX2(y_ptr2, y_21, y_22) \
+	\
+	/* process first 16 pixels of each block, for both lines */\
+	__m256i u_16 = _mm256_srai_epi16(_mm256_unpacklo_epi8(u, u), 8); \
+	__m256i v_16 = _mm256_srai_epi16(_mm256_unpacklo_epi8(v, v), 8); \
+	\
+	UV2RGB_16_AVX2(u_16, v_16, r_uv_16_1, g_uv_16_1, b_uv_16_1, r_uv_16_2, g_uv_16_2, b_uv_16_2) \
+	YUV2RGB_16_AVX2(y_11, r_8_11, g_8_11, b_8_11) \
+	YUV2RGB_16_AVX2(y_21, r_8_21, g_8_21, b_8_21) \
+	\
+	/* process last 16 pixels of each block, for both lines */\
+	u_16 = _mm256_srai_epi16(_mm256_unpackhi_epi8(u, u), 8); \
+	v_16 = _mm256_srai_epi16(_mm256_unpackhi_epi8(v, v), 8); \
+	\
+	UV2RGB_16_AVX2(u_16, v_16, r_uv_16_1, g_uv_16_1, b_uv_16_1, r_uv_16_2, g_uv_16_2, b_uv_16_2) \
+	YUV2RGB_16_AVX2(y_12, r_8_12, g_8_12, b_8_12) \
+	YUV2RGB_16_AVX2(y_22, r_8_22, g_8_22, b_8_22) \
+	\
+	__m256i rgb_1, rgb_2, rgb_3, rgb_4, rgb_5, rgb_6; \
+	\
+	PACK_RGB24_32_AVX2(r_8_11, r_8_12, g_8_11, g_8_12, b_8_11, b_8_12, rgb_1, rgb_2, rgb_3, rgb_4, rgb_5, rgb_6) \
+	SAVE_RGB24_64_AVX2(rgb_ptr1) \
+	\
+	PACK_RGB24_32_AVX2(r_8_21, r_8_22, g_8_21, g_8_22, b_8_21, b_8_22, rgb_1, rgb_2, rgb_3, rgb_4, rgb_5, rgb_6) \
+	SAVE_RGB24_64_AVX2(rgb_ptr2) \
+
+#define YUV2RGB_64_AVX2_PLANAR \
+	LOAD_UV_PLANAR_AVX2 \
+	YUV2RGB_64_AVX2
+
+#define YUV2RGB_64_AVX2_NV12 \
+	LOAD_UV_NV12_AVX2 \
+	YUV2RGB_64_AVX2
+
+#define YUV2RGB_64_AVX2_NV21 \
+	LOAD_UV_NV21_AVX2 \
+	YUV2RGB_64_AVX2
+
+
+// YUV420_RGB_AVX2_FUNCTION(FORMAT, BPP, CONVERT, SUFFIX) defines yuv420_FORMAT_<SUFFIX>, which converts 64 pixels
+// of two lines to BPP bytes with CONVERT, using the LOAD_SI256 and SAVE_SI256 macros defined where it is used
+#define YUV420_RGB_AVX2_FUNCTION(FORMAT, BPP, CONVERT, SUFFIX) \
+void yuv420_##FORMAT##_##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *Y, const uint8_t *U, const uint8_t *V, uint32_t Y_stride, uint32_t UV_stride, \
+	uint8_t *RGB, uint32_t RGB_stride, \
+	YCbCrType yuv_type) \
+{ \
+	KERNEL_PARAM(YUV2RGBParam, YUV2RGB) \
+	\
+	uint32_t x, y; \
+	for(y=0; (y+1)<height; y+=2) \
+	{ \
+		const uint8_t *y_ptr1=Y+y*Y_stride, \
+			*y_ptr2=Y+(y+1)*Y_stride, \
+			*u_ptr=U+(y/2)*UV_stride, \
+			*v_ptr=V+(y/2)*UV_stride; \
+		\
+		uint8_t *rgb_ptr1=RGB+y*RGB_stride, \
+			*rgb_ptr2=RGB+(y+1)*RGB_stride; \
+		\
+		for(x=0; (x+63)<width; x+=64) \
+		{ \
+			CONVERT \
+			\
+			y_ptr1+=64; \
+			y_ptr2+=64; \
+			u_ptr+=32; \
+			v_ptr+=32; \
+			rgb_ptr1+=64*BPP; \
+			rgb_ptr2+=64*BPP; \
+		} \
+	} \
+	YUV420_RGB_TAIL(64, BPP, yuv420_##FORMAT##_avx2u, yuv420_##FORMAT##_std) \
+}
+
+// NV12_RGB_AVX2_FUNCTION(NAME, FORMAT, BPP, CONVERT, SUFFIX) defines NAME_FORMAT_<SUFFIX> for the semi planar format
+// NAME (nv12 or nv21), as YUV420_RGB_AVX2_FUNCTION
+#define NV12_RGB_AVX2_FUNCTION(NAME, FORMAT, BPP, CONVERT, SUFFIX) \
+void NAME##_##FORMAT##_##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *Y, const uint8_t *UV, uint32_t Y_stride, uint32_t UV_stride, \
+	uint8_t *RGB, uint32_t RGB_stride, \
+	YCbCrType yuv_type) \
+{ \
+	KERNEL_PARAM(YUV2RGBParam, YUV2RGB) \
+	\
+	uint32_t x, y; \
+	for(y=0; (y+1)<height; y+=2) \
+	{ \
+		const uint8_t *y_ptr1=Y+y*Y_stride, \
+			*y_ptr2=Y+(y+1)*Y_stride, \
+			*uv_ptr=UV+(y/2)*UV_stride; \
+		\
+		uint8_t *rgb_ptr1=RGB+y*RGB_stride, \
+			*rgb_ptr2=RGB+(y+1)*RGB_stride; \
+		\
+		for(x=0; (x+63)<width; x+=64) \
+		{ \
+			CONVERT \
+			\
+			y_ptr1+=64; \
+			y_ptr2+=64; \
+			uv_ptr+=64; \
+			rgb_ptr1+=64*BPP; \
+			rgb_ptr2+=64*BPP; \
+		} \
+	} \
+	NV12_RGB_TAIL(64, BPP, NAME##_##FORMAT##_avx2u, NAME##_##FORMAT##_std) \
+}
+
+#define LOAD_SI256 _mm256_load_si256
+#define SAVE_SI256 _mm256_stream_si256
+YUV420_RGB_AVX2_FUNCTION(rgb24, 3, YUV2RGB_64_AVX2_PLANAR, avx2)
+NV12_RGB_AVX2_FUNCTION(nv12, rgb24, 3, YUV2RGB_64_AVX2_NV12, avx2)
+NV12_RGB_AVX2_FUNCTION(nv21, rgb24, 3, YUV2RGB_64_AVX2_NV21, avx2)
+#undef LOAD_SI256
+#undef SAVE_SI256
+
+#define LOAD_SI256 _mm256_loadu_si256
+#define SAVE_SI256 _mm256_storeu_si256
+YUV420_RGB_AVX2_FUNCTION(rgb24, 3, YUV2RGB_64_AVX2_PLANAR, avx2u)
+NV12_RGB_AVX2_FUNCTION(nv12, rgb24, 3, YUV2RGB_64_AVX2_NV12, avx2u)
+NV12_RGB_AVX2_FUNCTION(nv21, rgb24, 3, YUV2RGB_64_AVX2_NV21, avx2u)
+#undef LOAD_SI256
+#undef SAVE_SI256
+
+// rgb to yuv
+//
+// As for yuv to rgb, each 128 bits lane processes its own block of pixels, 16 per line: lane 0 handles pixels
+// [0,16) and lane 1 pixels [16,32). The rgb data of each block is loaded in its own lane, and split in r, g and b
+// channels with in lane shuffles (pshufb), instead of the unpack network of the sse version (see rgb.txt).
+// As in the sse version, each channel register contains the values of the even pixels of the block followed by
+// the values of the odd pixels, so that the horizontal averaging of the chroma values is a simple addition.
+
+// load two 128 bits values in the two lanes of a 256 bits register
+#define LOAD2_SI128(PTR1, PTR2) \
+	_mm256_inserti128_si256(_mm256_castsi128_si256(LOAD_SI128((const __m128i*)(PTR1))), LOAD_SI128((const __m128i*)(PTR2)), 1)
+
+// a shuffle mask, repeated in both lanes
+#define SHUFFLE_MASK_AVX2(...) _mm256_setr_epi8(__VA_ARGS__, __VA_ARGS__)
+
+// split 32 pixels of rgb24 data in r, g and b channels, lane k gets pixels [16k,16k+16)
+// each lane of rgb_a, rgb_b and rgb_c contains 16 bytes of the 48 bytes of its block, each output byte comes from
+// one of them, the others are zeroed by the mask
+#define UNPACK_RGB24_32_AVX2(PTR, R, G, B) \
+	rgb_a = LOAD2_SI128(PTR, PTR+48); \
+	rgb_b = LOAD2_SI128(PTR+16, PTR+64); \
+	rgb_c = LOAD2_SI128(PTR+32, PTR+80); \
+	R = _mm256_or_si256(_mm256_or_si256( \
+		_mm256_shuffle_epi8(rgb_a, SHUFFLE_MASK_AVX2(0, 6, 12, -1, -1, -1, -1, -1, 3, 9, 15, -1, -1, -1, -1, -1)), \
+		_mm256_shuffle_epi8(rgb_b, SHUFFLE_MASK_AVX2(-1, -1, -1, 2, 8, 14, -1, -1, -1, -1, -1, 5, 11, -1, -1, -1))), \
+		_mm256_shuffle_epi8(rgb_c, SHUFFLE_MASK_AVX2(-1, -1, -1, -1, -1, -1, 4, 10, -1, -1, -1, -1, -1, 1, 7, 13))); \
+	G = _mm256_or_si256(_mm256_or_si256( \
+		_mm256_shuffle_epi8(rgb_a, SHUFFLE_MASK_AVX2(1, 7, 13, -1, -1, -1, -1, -1, 4, 10, -1, -1, -1, -1, -1, -1)), \
+		_mm256_shuffle_epi8(rgb_b, SHUFFLE_MASK_AVX2(-1, -1, -1, 3, 9, 15, -1, -1, -1, -1, 0, 6, 12, -1, -1, -1))), \
+		_mm256_shuffle_epi8(rgb_c, SHUFFLE_MASK_AVX2(-1, -1, -1, -1, -1, -1, 5, 11, -1, -1, -1, -1, -1, 2, 8, 14))); \
+	B = _mm256_or_si256(_mm256_or_si256( \
+		_mm256_shuffle_epi8(rgb_a, SHUFFLE_MASK_AVX2(2, 8, 14, -1, -1, -1, -1, -1, 5, 11, -1, -1, -1, -1, -1, -1)), \
+		_mm256_shuffle_epi8(rgb_b, SHUFFLE_MASK_AVX2(-1, -1, -1, 4, 10, -1, -1, -1, -1, -1, 1, 7, 13, -1, -1, -1))), \
+		_mm256_shuffle_epi8(rgb_c, SHUFFLE_MASK_AVX2(-1, -1, -1, -1, -1, 0, 6, 12, -1, -1, -1, -1, -1, 3, 9, 15))); \
+
+// split 32 pixels of rgba data in r, g and b channels, lane k gets pixels [16k,16k+16)
+// each 4 pixels are first shuffled to 16 bits words of pixels pairs (0,2), (1,3) for each channel:
+// R0 R2 R1 R3 G0 G2 G1 G3 B0 B2 B1 B3 A0 A2 A1 A3
+// then the words and double words of the four registers are interleaved to get the even and odd pixels of each channel
+#define UNPACK_RGB32_32_AVX2(PTR, R, G, B) \
+	rgb_a = _mm256_shuffle_epi8(LOAD2_SI128(PTR, PTR+64), \
+		SHUFFLE_MASK_AVX2(0, 8, 4, 12, 1, 9, 5, 13, 2, 10, 6, 14, 3, 11, 7, 15)); \
+	rgb_b = _mm256_shuffle_epi8(LOAD2_SI128(PTR+16, PTR+80), \
+		SHUFFLE_MASK_AVX2(0, 8, 4, 12, 1, 9, 5, 13, 2, 10, 6, 14, 3, 11, 7, 15)); \
+	rgb_c = _mm256_shuffle_epi8(LOAD2_SI128(PTR+32, PTR+96), \
+		SHUFFLE_MASK_AVX2(0, 8, 4, 12, 1, 9, 5, 13, 2, 10, 6, 14, 3, 11, 7, 15)); \
+	rgb_d = _mm256_shuffle_epi8(LOAD2_SI128(PTR+48, PTR+112), \
+		SHUFFLE_MASK_AVX2(0, 8, 4, 12, 1, 9, 5, 13, 2, 10, 6, 14, 3, 11, 7, 15)); \
+	tmp1 = _mm256_unpacklo_epi16(rgb_a, rgb_b); \
+	tmp2 = _mm256_unpackhi_epi16(rgb_a, rgb_b); \
+	tmp3 = _mm256_unpacklo_epi16(rgb_c, rgb_d); \
+	tmp4 = _mm256_unpackhi_epi16(rgb_c, rgb_d); \
+	R = _mm256_unpacklo_epi32(tmp1, tmp3); \
+	G = _mm256_unpackhi_epi32(tmp1, tmp3); \
+	B = _mm256_unpacklo_epi32(tmp2, tmp4); \
+
+// compute Y' of 16 bits even (or odd) pixels values
+#define RGB2Y_16_AVX2(R_16, G_16, B_16, Y_16) \
+	Y_16 = _mm256_add_epi16(_mm256_mullo_epi16(R_16, _mm256_set1_epi16(param->r_factor)), \
+		_mm256_mullo_epi16(G_16, _mm256_set1_epi16(param->g_factor))); \
+	Y_16 = _mm256_add_epi16(Y_16, _mm256_mullo_epi16(B_16, _mm256_set1_epi16(param->b_factor))); \
+	Y_16 = _mm256_srli_epi16(Y_16, 8); \
+
+// compute and save Y of one line of 32 pixels, and add (B-Y') and (R-Y') of all pixels to the CB_16 and CR_16 sums
+#define RGB2YUV_LINE_32_AVX2(R, G, B, Y_PTR, CB_16, CR_16) \
+	r_16 = _mm256_unpacklo_epi8(R, _mm256_setzero_si256()); \
+	g_16 = _mm256_unpacklo_epi8(G, _mm256_setzero_si256()); \
+	b_16 = _mm256_unpacklo_epi8(B, _mm256_setzero_si256()); \
+	RGB2Y_16_AVX2(r_16, g_16, b_16, y1_16) \
+	CB_16 = _mm256_add_epi16(CB_16, _mm256_sub_epi16(b_16, y1_16)); \
+	CR_16 = _mm256_add_epi16(CR_16, _mm256_sub_epi16(r_16, y1_16)); \
+	r_16 = _mm256_unpackhi_epi8(R, _mm256_setzero_si256()); \
+	g_16 = _mm256_unpackhi_epi8(G, _mm256_setzero_si256()); \
+	b_16 = _mm256_unpackhi_epi8(B, _mm256_setzero_si256()); \
+	RGB2Y_16_AVX2(r_16, g_16, b_16, y2_16) \
+	CB_16 = _mm256_add_epi16(CB_16, _mm256_sub_epi16(b_16, y2_16)); \
+	CR_16 = _mm256_add_epi16(CR_16, _mm256_sub_epi16(r_16, y2_16)); \
+	/* Rescale Y' to Y, pack it to 8bit values, interleave even and odd pixels and save it */ \
+	y1_16 = _mm256_add_epi16(_mm256_srli_epi16(_mm256_mullo_epi16(y1_16, _mm256_set1_epi16(param->y_factor)), 7), _mm256_set1_epi16(param->y_offset)); \
+	y2_16 = _mm256_add_epi16(_mm256_srli_epi16(_mm256_mullo_epi16(y2_16, _mm256_set1_epi16(param->y_factor)), 7), _mm256_set1_epi16(param->y_offset)); \
+	y_8 = _mm256_packus_epi16(y1_16, y2_16); \
+	y_8 = _mm256_unpackhi_epi8(_mm256_slli_si256(y_8, 8), y_8); \
+	SAVE_SI256((__m256i*)(Y_PTR), y_8); \
+
+// from the r, g and b channels of two lines of 32 pixels, save Y and compute the 16 Cb and Cr values
+#define RGB2YUV_32_AVX2(R1, G1, B1, R2, G2, B2, Y_PTR1, Y_PTR2, CB_16, CR_16) \
+	CB_16 = _mm256_setzero_si256(); \
+	CR_16 = _mm256_setzero_si256(); \
+	RGB2YUV_LINE_32_AVX2(R1, G1, B1, Y_PTR1, CB_16, CR_16) \
+	RGB2YUV_LINE_32_AVX2(R2, G2, B2, Y_PTR2, CB_16, CR_16) \
+	/* Rescale Cb and Cr to their final range */ \
+	CB_16 = _mm256_add_epi16(_mm256_srai_epi16(_mm256_mullo_epi16(_mm256_srai_epi16(CB_16, 2), _mm256_set1_epi16(param->cb_factor)), 8), _mm256_set1_epi16(128)); \
+	CR_16 = _mm256_add_epi16(_mm256_srai_epi16(_mm256_mullo_epi16(_mm256_srai_epi16(CR_16, 2), _mm256_set1_epi16(param->cr_factor)), 8), _mm256_set1_epi16(128)); \
+
+// pack and save 32 Cb and Cr values, the in lane packing mixes the 64 bits words of the two blocks
+#define SAVE_UV_64_AVX2 \
+	SAVE_SI256((__m256i*)(u_ptr), _mm256_permute4x64_epi64(_mm256_packus_epi16(cb1_16, cb2_16), 0xD8)); \
+	SAVE_SI256((__m256i*)(v_ptr), _mm256_permute4x64_epi64(_mm256_packus_epi16(cr1_16, cr2_16), 0xD8)); \
+
+#define RGB2YUV_VARIABLES_AVX2 \
+	__m256i rgb_a, rgb_b, rgb_c, r1, g1, b1, r2, g2, b2; \
+	__m256i r_16, g_16, b_16, y1_16, y2_16, y_8, cb1_16, cr1_16, cb2_16, cr2_16; \
+
+#define RGB2YUV_64_AVX2 \
+	RGB2YUV_VARIABLES_AVX2 \
+	UNPACK_RGB24_32_AVX2(rgb_ptr1, r1, g1, b1) \
+	UNPACK_RGB24_32_AVX2(rgb_ptr2, r2, g2, b2) \
+	RGB2YUV_32_AVX2(r1, g1, b1, r2, g2, b2, y_ptr1, y_ptr2, cb1_16, cr1_16) \
+	UNPACK_RGB24_32_AVX2(rgb_ptr1+96, r1, g1, b1) \
+	UNPACK_RGB24_32_AVX2(rgb_ptr2+96, r2, g2, b2) \
+	RGB2YUV_32_AVX2(r1, g1, b1, r2, g2, b2, y_ptr1+32, y_ptr2+32, cb2_16, cr2_16) \
+	SAVE_UV_64_AVX2
+
+#define RGBA2YUV_64_AVX2 \
+	RGB2YUV_VARIABLES_AVX2 \
+	__m256i rgb_d, tmp1, tmp2, tmp3, tmp4; \
+	UNPACK_RGB32_32_AVX2(rgb_ptr1, r1, g1, b1) \
+	UNPACK_RGB32_32_AVX2(rgb_ptr2, r2, g2, b2) \
+	RGB2YUV_32_AVX2(r1, g1, b1, r2, g2, b2, y_ptr1, y_ptr2, cb1_16, cr1_16) \
+	UNPACK_RGB32_32_AVX2(rgb_ptr1+128, r1, g1, b1) \
+	UNPACK_RGB32_32_AVX2(rgb_ptr2+128, r2, g2, b2) \
+	RGB2YUV_32_AVX2(r1, g1, b1, r2, g2, b2, y_ptr1+32, y_ptr2+32, cb2_16, cr2_16) \
+	SAVE_UV_64_AVX2
+
+
+// RGB_YUV420_AVX2_FUNCTION(FORMAT, BPP, CONVERT, SUFFIX) defines FORMAT_yuv420_<SUFFIX>, which converts 64 pixels of
+// BPP bytes of two lines with CONVERT, using the LOAD_SI128 and SAVE_SI256 macros defined where it is used
+#define RGB_YUV420_AVX2_FUNCTION(FORMAT, BPP, CONVERT, SUFFIX) \
+void FORMAT##_yuv420_##SUFFIX(uint32_t width, uint32_t height, \
+	const uint8_t *RGB, uint32_t RGB_stride, \
+	uint8_t *Y, uint8_t *U, uint8_t *V, uint32_t Y_stride, uint32_t UV_stride, \
+	YCbCrType yuv_type) \
+{ \
+	KERNEL_PARAM(RGB2YUVParam, RGB2YUV) \
+	\
+	uint32_t x, y; \
+	for(y=0; (y+1)<height; y+=2) \
+	{ \
+		const uint8_t *rgb_ptr1=RGB+y*RGB_stride, \
+			*rgb_ptr2=RGB+(y+1)*RGB_stride; \
+		\
+		uint8_t *y_ptr1=Y+y*Y_stride, \
+			*y_ptr2=Y+(y+1)*Y_stride, \
+			*u_ptr=U+(y/2)*UV_stride, \
+			*v_ptr=V+(y/2)*UV_stride; \
+		\
+		for(x=0; (x+63)<width; x+=64) \
+		{ \
+			CONVERT \
+			\
+			rgb_ptr1+=64*BPP; \
+			rgb_ptr2+=64*BPP; \
+			y_ptr1+=64; \
+			y_ptr2+=64; \
+			u_ptr+=32; \
+			v_ptr+=32; \
+		} \
+	} \
+	RGB_YUV420_TAIL(64, BPP, RGB, RGB_stride, FORMAT##_yuv420_avx2u, FORMAT##_yuv420_std) \
+}
+
+#define LOAD_SI128 _mm_load_si128
+#define SAVE_SI256 _mm256_stream_si256
+RGB_YUV420_AVX2_FUNCTION(rgb24, 3, RGB2YUV_64_AVX2, avx2)
+RGB_YUV420_AVX2_FUNCTION(rgb32, 4, RGBA2YUV_64_AVX2, avx2)
+#undef LOAD_SI128
+#undef SAVE_SI256
+
+#define LOAD_SI128 _mm_loadu_si128
+#define SAVE_SI256 _mm256_storeu_si256
+RGB_YUV420_AVX2_FUNCTION(rgb24, 3, RGB2YUV_64_AVX2, avx2u)
+RGB_YUV420_AVX2_FUNCTION(rgb32, 4, RGBA2YUV_64_AVX2, avx2u)
+#undef LOAD_SI128
+#undef SAVE_SI256
+
+#endif //__AVX2__
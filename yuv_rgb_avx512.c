@@ -0,0 +1,261 @@
+// Copyright 2016 Adrien Descamps
+// Distributed under BSD 3-Clause License
+
+// AVX-512 implementation of the yuv to rgb conversions, processing 128 pixels per iteration.
+// This file must be compiled with avx512f and avx512bw support (-mavx512f -mavx512bw), the functions must only
+// be called on a cpu that supports it (see the dispatch functions in yuv_rgb.c).
+
+// The algorithm is the same as the avx2 version (see yuv_rgb_avx2.c), with four 128 bits lanes per register:
+// lane k processes its own block of 32 pixels [32k,32k+32).
+
+#include "yuv_rgb.h"
+#include "yuv_rgb_internal.h"
+
+#if defined(__AVX512F__) && defined(__AVX512BW__)
+
+#include <immintrin.h>
+
+#define UV2RGB_16_AVX512(U,V,R1,G1,B1,R2,G2,B2) \
+	r_tmp = _mm512_srai_epi16(_mm512_mullo_epi16(V, _mm512_set1_epi16(param->cr_factor)), 6); \
+	g_tmp = _mm512_srai_epi16(_mm512_add_epi16( \
+		_mm512_mullo_epi16(U, _mm512_set1_epi16(param->g_cb_factor)), \
+		_mm512_mullo_epi16(V, _mm512_set1_epi16(param->g_cr_factor))), 7); \
+	b_tmp = _mm512_srai_epi16(_mm512_mullo_epi16(U, _mm512_set1_epi16(param->cb_factor)), 6); \
+	R1 = _mm512_unpacklo_epi16(r_tmp, r_tmp); \
+	G1 = _mm512_unpacklo_epi16(g_tmp, g_tmp); \
+	B1 = _mm512_unpacklo_epi16(b_tmp, b_tmp); \
+	R2 = _mm512_unpackhi_epi16(r_tmp, r_tmp); \
+	G2 = _mm512_unpackhi_epi16(g_tmp, g_tmp); \
+	B2 = _mm512_unpackhi_epi16(b_tmp, b_tmp); \
+
+#define ADD_Y2RGB_16_AVX512(Y1,Y2,R1,G1,B1,R2,G2,B2) \
+	Y1 = _mm512_srli_epi16(_mm512_mullo_epi16(Y1, _mm512_set1_epi16(param->y_factor)), 7); \
+	Y2 = _mm512_srli_epi16(_mm512_mullo_epi16(Y2, _mm512_set1_epi16(param->y_factor)), 7); \
+	\
+	R1 = _mm512_add_epi16(Y1, R1); \
+	G1 = _mm512_sub_epi16(Y1, G1); \
+	B1 = _mm512_add_epi16(Y1, B1); \
+	R2 = _mm512_add_epi16(Y2, R2); \
+	G2 = _mm512_sub_epi16(Y2, G2); \
+	B2 = _mm512_add_epi16(Y2, B2); \
+
+#define PACK_RGB24_32_STEP_AVX512(RS1, RS2, RS3, RS4, RS5, RS6, RD1, RD2, RD3, RD4, RD5, RD6) \
+RD1 = _mm512_packus_epi16(_mm512_and_si512(RS1,_mm512_set1_epi16(0xFF)), _mm512_and_si512(RS2,_mm512_set1_epi16(0xFF))); \
+RD2 = _mm512_packus_epi16(_mm512_and_si512(RS3,_mm512_set1_epi16(0xFF)), _mm512_and_si512(RS4,_mm512_set1_epi16(0xFF))); \
+RD3 = _mm512_packus_epi16(_mm512_and_si512(RS5,_mm512_set1_epi16(0xFF)), _mm512_and_si512(RS6,_mm512_set1_epi16(0xFF))); \
+RD4 = _mm512_packus_epi16(_mm512_srli_epi16(RS1,8), _mm512_srli_epi16(RS2,8)); \
+RD5 = _mm512_packus_epi16(_mm512_srli_epi16(RS3,8), _mm512_srli_epi16(RS4,8)); \
+RD6 = _mm512_packus_epi16(_mm512_srli_epi16(RS5,8), _mm512_srli_epi16(RS6,8)); \
+
+#define PACK_RGB24_32_AVX512(R1, R2, G1, G2, B1, B2, RGB1, RGB2, RGB3, RGB4, RGB5, RGB6) \
+PACK_RGB24_32_STEP_AVX512(R1, R2, G1, G2, B1, B2, RGB1, RGB2, RGB3, RGB4, RGB5, RGB6) \
+PACK_RGB24_32_STEP_AVX512(RGB1, RGB2, RGB3, RGB4, RGB5, RGB6, R1, R2, G1, G2, B1, B2) \
+PACK_RGB24_32_STEP_AVX512(R1, R2, G1, G2, B1, B2, RGB1, RGB2, RGB3, RGB4, RGB5, RGB6) \
+PACK_RGB24_32_STEP_AVX512(RGB1, RGB2, RGB3, RGB4, RGB5, RGB6, R1, R2, G1, G2, B1, B2) \
+PACK_RGB24_32_STEP_AVX512(R1, R2, G1, G2, B1, B2, RGB1, RGB2, RGB3, RGB4, RGB5, RGB6) \
+
+// lane k of rgb_1 to rgb_6 contains 16 bytes of the rgb24 output of the k-th 32 pixels block.
+// Lanes are first gathered by pairs of registers, [rgb_1.k, rgb_2.k, rgb_1.k+1, rgb_2.k+1] for k=0 and k=2,
+// so that each 64 bytes output is then a simple combination of two of these.
+#define SAVE_RGB24_128_AVX512(PTR) \
+	rgb_12 = _mm512_permutex2var_epi64(rgb_1, _mm512_set_epi64(11, 10, 3, 2, 9, 8, 1, 0), rgb_2); \
+	rgb_34 = _mm512_permutex2var_epi64(rgb_3, _mm512_set_epi64(11, 10, 3, 2, 9, 8, 1, 0), rgb_4); \
+	rgb_56 = _mm512_permutex2var_epi64(rgb_5, _mm512_set_epi64(11, 10, 3, 2, 9, 8, 1, 0), rgb_6); \
+	SAVE_SI512((__m512i*)(PTR), _mm512_shuffle_i64x2(rgb_12, rgb_34, 0x44)); \
+	SAVE_SI512((__m512i*)(PTR+64), _mm512_shuffle_i64x2(rgb_56, rgb_12, 0xE4)); \
+	SAVE_SI512((__m512i*)(PTR+128), _mm512_shuffle_i64x2(rgb_34, rgb_56, 0xEE)); \
+	rgb_12 = _mm512_permutex2var_epi64(rgb_1, _mm512_set_epi64(15, 14, 7, 6, 13, 12, 5, 4), rgb_2); \
+	rgb_34 = _mm512_permutex2var_epi64(rgb_3, _mm512_set_epi64(15, 14, 7, 6, 13, 12, 5, 4), rgb_4); \
+	rgb_56 = _mm512_permutex2var_epi64(rgb_5, _mm512_set_epi64(15, 14, 7, 6, 13, 12, 5, 4), rgb_6); \
+	SAVE_SI512((__m512i*)(PTR+192), _mm512_shuffle_i64x2(rgb_12, rgb_34, 0x44)); \
+	SAVE_SI512((__m512i*)(PTR+256), _mm512_shuffle_i64x2(rgb_56, rgb_12, 0xE4)); \
+	SAVE_SI512((__m512i*)(PTR+320), _mm512_shuffle_i64x2(rgb_34, rgb_56, 0xEE)); \
+
+#define LOAD_UV_PLANAR_AVX512 \
+	__m512i u = LOAD_SI512((const __m512i*)(u_ptr)); \
+	__m512i v = LOAD_SI512((const __m512i*)(v_ptr)); \
+
+// the in lane packing mixes the 64 bits words of u and v, they are put back in order with a permute
+#define LOAD_UV_NV12_AVX512 \
+	__m512i uv1 = LOAD_SI512((const __m512i*)(uv_ptr)); \
+	__m512i uv2 = LOAD_SI512((const __m512i*)(uv_ptr+64)); \
+	__m512i u = _mm512_packus_epi16(_mm512_and_si512(uv1, _mm512_set1_epi16(255)), _mm512_and_si512(uv2, _mm512_set1_epi16(255))); \
+	uv1 = _mm512_srli_epi16(uv1, 8); \
+	uv2 = _mm512_srli_epi16(uv2, 8); \
+	__m512i v = _mm512_packus_epi16(uv1, uv2); \
+	u = _mm512_permutexvar_epi64(_mm512_set_epi64(7, 5, 3, 1, 6, 4, 2, 0), u); \
+	v = _mm512_permutexvar_epi64(_mm512_set_epi64(7, 5, 3, 1, 6, 4, 2, 0), v); \
+
+#define LOAD_UV_NV21_AVX512 \
+	__m512i uv1 = LOAD_SI512((const __m512i*)(uv_ptr)); \
+	__m512i uv2 = LOAD_SI512((const __m512i*)(uv_ptr+64)); \
+	__m512i v = _mm512_packus_epi16(_mm512_and_si512(uv1, _mm512_set1_epi16(255)), _mm512_and_si512(uv2, _mm512_set1_epi16(255))); \
+	uv1 = _mm512_srli_epi16(uv1, 8); \
+	uv2 = _mm512_srli_epi16(uv2, 8); \
+	__m512i u = _mm512_packus_epi16(uv1, uv2); \
+	u = _mm512_permutexvar_epi64(_mm512_set_epi64(7, 5, 3, 1, 6, 4, 2, 0), u); \
+	v = _mm512_permutexvar_epi64(_mm512_set_epi64(7, 5, 3, 1, 6, 4, 2, 0), v); \
+
+// load 128 y values, and split them so that each lane gets the values of its own block:
+// Y_LO gets pixels [32k,32k+16) and Y_HI gets pixels [32k+16,32k+32), for k in [0,4)
+#define LOAD_Y_128_AVX512(PTR, Y_LO, Y_HI) \
+	y_a = LOAD_SI512((const __m512i*)(PTR)); \
+	y_b = LOAD_SI512((const __m512i*)(PTR+64)); \
+	Y_LO = _mm512_shuffle_i64x2(y_a, y_b, 0x88); \
+	Y_HI = _mm512_shuffle_i64x2(y_a, y_b, 0xDD); \
+
+#define YUV2RGB_16_AVX512(Y, R_8, G_8, B_8) \
+	r_16_1=r_uv_16_1; g_16_1=g_uv_16_1; b_16_1=b_uv_16_1; \
+	r_16_2=r_uv_16_2; g_16_2=g_uv_16_2; b_16_2=b_uv_16_2; \
+	\
+	Y = _mm512_subs_epu8(Y, _mm512_set1_epi8(param->y_offset)); \
+	y_16_1 = _mm512_unpacklo_epi8(Y, _mm512_setzero_si512()); \
+	y_16_2 = _mm512_unpackhi_epi8(Y, _mm512_setzero_si512()); \
+	\
+	ADD_Y2RGB_16_AVX512(y_16_1, y_16_2, r_16_1, g_16_1, b_16_1, r_16_2, g_16_2, b_16_2) \
+	\
+	R_8 = _mm512_packus_epi16(r_16_1, r_16_2); \
+	G_8 = _mm512_packus_epi16(g_16_1, g_16_2); \
+	B_8 = _mm512_packus_epi16(b_16_1, b_16_2); \
+
+#define YUV2RGB_128_AVX512 \
+	__m512i r_tmp, g_tmp, b_tmp; \
+	__m512i r_16_1, g_16_1, b_16_1, r_16_2, g_16_2, b_16_2; \
+	__m512i r_uv_16_1, g_uv_16_1, b_uv_16_1, r_uv_16_2, g_uv_16_2, b_uv_16_2; \
+	__m512i y_16_1, y_16_2; \
+	__m512i y_a, y_b, y_11, y_12, y_21, y_22; \
+	__m512i r_8_11, g_8_11, b_8_11, r_8_12, g_8_12, b_8_12; \
+	__m512i r_8_21, g_8_21, b_8_21, r_8_22, g_8_22, b_8_22; \
+	\
+	u = _mm512_add_epi8(u, _mm512_set1_epi8(-128)); \
+	v = _mm512_add_epi8(v, _mm512_set1_epi8(-128)); \
+	\
+	LOAD_Y_128_AVX512(y_ptr1, y_11, y_12) \
+	LOAD_Y_128_AVX512(y_ptr2, y_21, y_22) \
+	\
+	/* process first 16 pixels of each block, for both lines */\
+	__m512i u_16 = _mm512_srai_epi16(_mm512_unpacklo_epi8(u, u), 8); \
+	__m512i v_16 = _mm512_srai_epi16(_mm512_unpacklo_epi8(v, v), 8); \
+	\
+	UV2RGB_16_AVX512(u_16, v_16, r_uv_16_1, g_uv_16_1, b_uv_16_1, r_uv_16_2, g_uv_16_2, b_uv_16_2) \
+	YUV2RGB_16_AVX512(y_11, r_8_11, g_8_11, b_8_11) \
+	YUV2RGB_16_AVX512(y_21, r_8_21, g_8_21, b_8_21) \
+	\
+	/* process last 16 pixels of each block, for both lines */\
+	u_16 = _mm512_srai_epi16(_mm512_unpackhi_epi8(u, u), 8); \
+	v_16 = _mm512_srai_epi16(_mm512_unpackhi_epi8(v, v), 8); \
+	\
+	UV2RGB_16_AVX512(u_16, v_16, r_uv_16_1, g_uv_16_1, b_uv_16_1, r_uv_16_2, g_uv_16_2, b_uv_16_2) \
+	YUV2RGB_16_AVX512(y_12, r_8_12, g_8_12, b_8_12) \
+	YUV2RGB_16_AVX512(y_22, r_8_22, g_8_22, b_8_22) \
+	\
+	__m512i rgb_1, rgb_2, rgb_3, rgb_4, rgb_5, rgb_6, rgb_12, rgb_34, rgb_56; \
+	\
+	PACK_RGB24_32_AVX512(r_8_11, r_8_12, g_8_11, g_8_12, b_8_11, b_8_12, rgb_1, rgb_2, rgb_3, rgb_4, rgb_5, rgb_6) \
+	SAVE_RGB24_128_AVX512(rgb_ptr1) \
+	\
+	PACK_RGB24_32_AVX512(r_8_21, r_8_22, g_8_21, g_8_22, b_8_21, b_8_22, rgb_1, rgb_2, rgb_3, rgb_4, rgb_5, rgb_6) \
+	SAVE_RGB24_128_AVX512(rgb_ptr2) \
+
+#define YUV2RGB_128_AVX512_PLANAR \
+	LOAD_UV_PLANAR_AVX512 \
+	YUV2RGB_128_AVX512
+
+#define YUV2RGB_128_AVX512_NV12 \
+	LOAD_UV_NV12_AVX512 \
+	YUV2RGB_128_AVX512
+
+#define YUV2RGB_128_AVX512_NV21 \
+	LOAD_UV_NV21_AVX512 \
+	YUV2RGB_128_AVX512
+
+
+// YUV420_RGB_AVX512_FUNCTION(FORMAT, BPP, CONVERT, SUFFIX) defines yuv420_FORMAT_<SUFFIX>, which converts 128 pixels
+// of two lines to BPP bytes with CONVERT, using the LOAD_SI512 and SAVE_SI512 macros defined where it is used
+#define YUV420_RGB_AVX512_FUNCTION(FORMAT, BPP, CONVERT, SUFFIX) \
+void yuv420_##FORMAT##_##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *Y, const uint8_t *U, const uint8_t *V, uint32_t Y_stride, uint32_t UV_stride, \
+	uint8_t *RGB, uint32_t RGB_stride, \
+	YCbCrType yuv_type) \
+{ \
+	KERNEL_PARAM(YUV2RGBParam, YUV2RGB) \
+	\
+	uint32_t x, y; \
+	for(y=0; (y+1)<height; y+=2) \
+	{ \
+		const uint8_t *y_ptr1=Y+y*Y_stride, \
+			*y_ptr2=Y+(y+1)*Y_stride, \
+			*u_ptr=U+(y/2)*UV_stride, \
+			*v_ptr=V+(y/2)*UV_stride; \
+		\
+		uint8_t *rgb_ptr1=RGB+y*RGB_stride, \
+			*rgb_ptr2=RGB+(y+1)*RGB_stride; \
+		\
+		for(x=0; (x+127)<width; x+=128) \
+		{ \
+			CONVERT \
+			\
+			y_ptr1+=128; \
+			y_ptr2+=128; \
+			u_ptr+=64; \
+			v_ptr+=64; \
+			rgb_ptr1+=128*BPP; \
+			rgb_ptr2+=128*BPP; \
+		} \
+	} \
+	YUV420_RGB_TAIL(128, BPP, yuv420_##FORMAT##_avx512u, yuv420_##FORMAT##_std) \
+}
+
+// NV12_RGB_AVX512_FUNCTION(NAME, FORMAT, BPP, CONVERT, SUFFIX) defines NAME_FORMAT_<SUFFIX> for the semi planar format
+// NAME (nv12 or nv21), as YUV420_RGB_AVX512_FUNCTION
+#define NV12_RGB_AVX512_FUNCTION(NAME, FORMAT, BPP, CONVERT, SUFFIX) \
+void NAME##_##FORMAT##_##SUFFIX( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *Y, const uint8_t *UV, uint32_t Y_stride, uint32_t UV_stride, \
+	uint8_t *RGB, uint32_t RGB_stride, \
+	YCbCrType yuv_type) \
+{ \
+	KERNEL_PARAM(YUV2RGBParam, YUV2RGB) \
+	\
+	uint32_t x, y; \
+	for(y=0; (y+1)<height; y+=2) \
+	{ \
+		const uint8_t *y_ptr1=Y+y*Y_stride, \
+			*y_ptr2=Y+(y+1)*Y_stride, \
+			*uv_ptr=UV+(y/2)*UV_stride; \
+		\
+		uint8_t *rgb_ptr1=RGB+y*RGB_stride, \
+			*rgb_ptr2=RGB+(y+1)*RGB_stride; \
+		\
+		for(x=0; (x+127)<width; x+=128) \
+		{ \
+			CONVERT \
+			\
+			y_ptr1+=128; \
+			y_ptr2+=128; \
+			uv_ptr+=128; \
+			rgb_ptr1+=128*BPP; \
+			rgb_ptr2+=128*BPP; \
+		} \
+	} \
+	NV12_RGB_TAIL(128, BPP, NAME##_##FORMAT##_avx512u, NAME##_##FORMAT##_std) \
+}
+
+#define LOAD_SI512 _mm512_load_si512
+#define SAVE_SI512 _mm512_stream_si512
+YUV420_RGB_AVX512_FUNCTION(rgb24, 3, YUV2RGB_128_AVX512_PLANAR, avx512)
+NV12_RGB_AVX512_FUNCTION(nv12, rgb24, 3, YUV2RGB_128_AVX512_NV12, avx512)
+NV12_RGB_AVX512_FUNCTION(nv21, rgb24, 3, YUV2RGB_128_AVX512_NV21, avx512)
+#undef LOAD_SI512
+#undef SAVE_SI512
+
+#define LOAD_SI512 _mm512_loadu_si512
+#define SAVE_SI512 _mm512_storeu_si512
+YUV420_RGB_AVX512_FUNCTION(rgb24, 3, YUV2RGB_128_AVX512_PLANAR, avx512u)
+NV12_RGB_AVX512_FUNCTION(nv12, rgb24, 3, YUV2RGB_128_AVX512_NV12, avx512u)
+NV12_RGB_AVX512_FUNCTION(nv21, rgb24, 3, YUV2RGB_128_AVX512_NV21, avx512u)
+#undef LOAD_SI512
+#undef SAVE_SI512
+
+#endif //__AVX512F__ && __AVX512BW__
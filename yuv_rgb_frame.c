@@ -0,0 +1,283 @@
+// Copyright 2016 Adrien Descamps
+// Distributed under BSD 3-Clause License
+
+// Frame descriptors and frame pools (see yuv_rgb.h)
+//
+// The planes of an allocated image are stored in a single block, each plane starting on a 64 bytes boundary with
+// a stride rounded up to a multiple of 64 bytes, which are the alignment requirements of the avx512 implementations
+// (and so of the avx2, sse and neon ones). A frame pool keeps the blocks of the released images in a free list, which
+// only grows when more images are in use than ever before.
+
+#include "yuv_rgb.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// alignment of the planes and strides of the allocated images
+#define FRAME_ALIGN 64
+#define ALIGN_UP(VALUE) (((VALUE)+FRAME_ALIGN-1)/FRAME_ALIGN*FRAME_ALIGN)
+
+// number of planes of the format, and bytes per line and number of lines of each of them
+static int plane_sizes(YUVRGBFormat format, uint32_t width, uint32_t height, uint32_t line_sizes[3],
+	uint32_t line_numbers[3])
+{
+	const uint32_t uv_width = (width+1)/2, uv_height = (height+1)/2;
+	line_numbers[0] = height;
+	line_numbers[1] = line_numbers[2] = uv_height;
+	switch(format)
+	{
+		case YUVRGB_FORMAT_YUV420:
+			line_sizes[0] = width;
+			line_sizes[1] = line_sizes[2] = uv_width;
+			return 3;
+		case YUVRGB_FORMAT_NV12:
+		case YUVRGB_FORMAT_NV21:
+			line_sizes[0] = width;
+			line_sizes[1] = 2*uv_width;
+			return 2;
+		case YUVRGB_FORMAT_RGB24:
+			line_sizes[0] = 3*width;
+			return 1;
+		case YUVRGB_FORMAT_RGB32:
+			line_sizes[0] = 4*width;
+			return 1;
+	}
+	return 0;
+}
+
+// size of the block of a width x height image, including the alignment of its start
+static size_t image_size(YUVRGBFormat format, uint32_t width, uint32_t height)
+{
+	uint32_t line_sizes[3], line_numbers[3];
+	const int plane_number = plane_sizes(format, width, height, line_sizes, line_numbers);
+	size_t size = FRAME_ALIGN-1;
+	int i;
+	for(i=0; i<plane_number; ++i)
+		size += ALIGN_UP((size_t)line_sizes[i])*line_numbers[i];
+	return size;
+}
+
+// describe the image stored in memory, which has image_size bytes
+static void set_image(YUVRGBImage *image, YUVRGBFormat format, uint32_t width, uint32_t height, void *memory)
+{
+	uint32_t line_sizes[3], line_numbers[3];
+	const int plane_number = plane_sizes(format, width, height, line_sizes, line_numbers);
+	uint8_t *plane = (uint8_t *)memory + (FRAME_ALIGN - (uintptr_t)memory%FRAME_ALIGN)%FRAME_ALIGN;
+	int i;
+
+	memset(image, 0, sizeof(YUVRGBImage));
+	image->format = format;
+	image->width = width;
+	image->height = height;
+	image->memory = memory;
+	for(i=0; i<plane_number; ++i)
+	{
+		image->planes[i] = plane;
+		image->strides[i] = ALIGN_UP(line_sizes[i]);
+		plane += image->strides[i]*(size_t)line_numbers[i];
+	}
+}
+
+int yuv_rgb_image_alloc(YUVRGBImage *image, YUVRGBFormat format, uint32_t width, uint32_t height)
+{
+	uint32_t line_sizes[3], line_numbers[3];
+	void *memory;
+	memset(image, 0, sizeof(YUVRGBImage));
+	// the strides of rgb32 lines must fit in 32 bits
+	if(width==0 || height==0 || width>UINT32_MAX/4-FRAME_ALIGN ||
+		plane_sizes(format, width, height, line_sizes, line_numbers)==0)
+		return -1;
+	memory = malloc(image_size(format, width, height));
+	if(!memory)
+		return -1;
+	set_image(image, format, width, height, memory);
+	return 0;
+}
+
+void yuv_rgb_image_free(YUVRGBImage *image)
+{
+	free(image->memory);
+	memset(image, 0, sizeof(YUVRGBImage));
+}
+
+// conversion functions of the yuv to rgb, rgb to yuv and direct yuv conversions
+typedef void (*YUV2RGBFunction)(uint32_t width, uint32_t height,
+	const uint8_t *y, const uint8_t *u, const uint8_t *v, uint32_t y_stride, uint32_t uv_stride,
+	uint8_t *rgb, uint32_t rgb_stride, YCbCrType yuv_type);
+typedef void (*YUVSP2RGBFunction)(uint32_t width, uint32_t height,
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride,
+	uint8_t *rgb, uint32_t rgb_stride, YCbCrType yuv_type);
+typedef void (*RGB2YUVFunction)(uint32_t width, uint32_t height, const uint8_t *rgb, uint32_t rgb_stride,
+	uint8_t *y, uint8_t *u, uint8_t *v, uint32_t y_stride, uint32_t uv_stride, YCbCrType yuv_type);
+typedef void (*YUVSP2YUVFunction)(uint32_t width, uint32_t height,
+	const uint8_t *y, const uint8_t *uv, uint32_t y_stride, uint32_t uv_stride,
+	uint8_t *y_dst, uint8_t *u_dst, uint8_t *v_dst, uint32_t y_dst_stride, uint32_t uv_dst_stride);
+typedef void (*YUV2YUVSPFunction)(uint32_t width, uint32_t height,
+	const uint8_t *y, const uint8_t *u, const uint8_t *v, uint32_t y_stride, uint32_t uv_stride,
+	uint8_t *y_dst, uint8_t *uv_dst, uint32_t y_dst_stride, uint32_t uv_dst_stride);
+
+int yuv_rgb_image_convert(const YUVRGBImage *src, const YUVRGBImage *dst, YCbCrType yuv_type)
+{
+	const uint8_t *const *s = (const uint8_t *const *)src->planes;
+	uint8_t *const *d = dst->planes;
+	const uint32_t *ss = src->strides, *ds = dst->strides;
+	YUV2RGBFunction yuv2rgb = NULL;
+	YUVSP2RGBFunction yuvsp2rgb = NULL;
+	RGB2YUVFunction rgb2yuv = NULL;
+	YUVSP2YUVFunction yuvsp2yuv = NULL;
+	YUV2YUVSPFunction yuv2yuvsp = NULL;
+
+	if(src->width!=dst->width || src->height!=dst->height)
+		return -1;
+	// the u and v planes share their stride
+	if((src->format==YUVRGB_FORMAT_YUV420 && ss[1]!=ss[2]) || (dst->format==YUVRGB_FORMAT_YUV420 && ds[1]!=ds[2]))
+		return -1;
+
+	switch(src->format)
+	{
+		case YUVRGB_FORMAT_YUV420:
+			if(dst->format==YUVRGB_FORMAT_RGB24)
+				yuv2rgb = yuv420_rgb24;
+			else if(dst->format==YUVRGB_FORMAT_RGB32)
+				yuv2rgb = yuv420_rgb32;
+			else if(dst->format==YUVRGB_FORMAT_NV12)
+				yuv2yuvsp = yuv420_nv12;
+			else if(dst->format==YUVRGB_FORMAT_NV21)
+				yuv2yuvsp = yuv420_nv21;
+			break;
+		case YUVRGB_FORMAT_NV12:
+			if(dst->format==YUVRGB_FORMAT_RGB24)
+				yuvsp2rgb = nv12_rgb24;
+			else if(dst->format==YUVRGB_FORMAT_RGB32)
+				yuvsp2rgb = nv12_rgb32;
+			else if(dst->format==YUVRGB_FORMAT_YUV420)
+				yuvsp2yuv = nv12_yuv420;
+			break;
+		case YUVRGB_FORMAT_NV21:
+			if(dst->format==YUVRGB_FORMAT_RGB24)
+				yuvsp2rgb = nv21_rgb24;
+			else if(dst->format==YUVRGB_FORMAT_RGB32)
+				yuvsp2rgb = nv21_rgb32;
+			else if(dst->format==YUVRGB_FORMAT_YUV420)
+				yuvsp2yuv = nv21_yuv420;
+			break;
+		case YUVRGB_FORMAT_RGB24:
+			if(dst->format==YUVRGB_FORMAT_YUV420)
+				rgb2yuv = rgb24_yuv420;
+			break;
+		case YUVRGB_FORMAT_RGB32:
+			if(dst->format==YUVRGB_FORMAT_YUV420)
+				rgb2yuv = rgb32_yuv420;
+			break;
+	}
+
+	if(yuv2rgb)
+		yuv2rgb(src->width, src->height, s[0], s[1], s[2], ss[0], ss[1], d[0], ds[0], yuv_type);
+	else if(yuvsp2rgb)
+		yuvsp2rgb(src->width, src->height, s[0], s[1], ss[0], ss[1], d[0], ds[0], yuv_type);
+	else if(rgb2yuv)
+		rgb2yuv(src->width, src->height, s[0], ss[0], d[0], d[1], d[2], ds[0], ds[1], yuv_type);
+	else if(yuvsp2yuv)
+		yuvsp2yuv(src->width, src->height, s[0], s[1], ss[0], ss[1], d[0], d[1], d[2], ds[0], ds[1]);
+	else if(yuv2yuvsp)
+		yuv2yuvsp(src->width, src->height, s[0], s[1], s[2], ss[0], ss[1], d[0], d[1], ds[0], ds[1]);
+	else
+		return -1;
+	return 0;
+}
+
+struct yuv_rgb_frame_pool
+{
+	YUVRGBFormat format;
+	uint32_t width, height;
+	size_t size;
+	// blocks of the released images
+	void **free_memory;
+	uint32_t free_number, capacity;
+};
+
+yuv_rgb_frame_pool *yuv_rgb_frame_pool_create(YUVRGBFormat format, uint32_t width, uint32_t height,
+	uint32_t frame_number)
+{
+	YUVRGBImage image;
+	yuv_rgb_frame_pool *pool;
+	uint32_t i;
+
+	// check the format and size
+	if(yuv_rgb_image_alloc(&image, format, width, height)!=0)
+		return NULL;
+	yuv_rgb_image_free(&image);
+
+	pool = calloc(1, sizeof(yuv_rgb_frame_pool));
+	if(!pool)
+		return NULL;
+	pool->format = format;
+	pool->width = width;
+	pool->height = height;
+	pool->size = image_size(format, width, height);
+	pool->capacity = frame_number>0 ? frame_number : 4;
+	pool->free_memory = malloc(pool->capacity*sizeof(void *));
+	if(!pool->free_memory)
+	{
+		free(pool);
+		return NULL;
+	}
+	for(i=0; i<frame_number; ++i)
+	{
+		void *memory = malloc(pool->size);
+		if(!memory)
+		{
+			yuv_rgb_frame_pool_destroy(pool);
+			return NULL;
+		}
+		pool->free_memory[pool->free_number++] = memory;
+	}
+	return pool;
+}
+
+void yuv_rgb_frame_pool_destroy(yuv_rgb_frame_pool *pool)
+{
+	uint32_t i;
+	if(!pool)
+		return;
+	for(i=0; i<pool->free_number; ++i)
+		free(pool->free_memory[i]);
+	free(pool->free_memory);
+	free(pool);
+}
+
+int yuv_rgb_frame_pool_get(yuv_rgb_frame_pool *pool, YUVRGBImage *image)
+{
+	void *memory = pool->free_number>0 ? pool->free_memory[--pool->free_number] : malloc(pool->size);
+	if(!memory)
+	{
+		memset(image, 0, sizeof(YUVRGBImage));
+		return -1;
+	}
+	set_image(image, pool->format, pool->width, pool->height, memory);
+	return 0;
+}
+
+int yuv_rgb_frame_pool_release(yuv_rgb_frame_pool *pool, YUVRGBImage *image)
+{
+	if(!image->memory)
+		return 0;
+	// the memory of an image of another format or size does not have the size of the pool images
+	if(image->format!=pool->format || image->width!=pool->width || image->height!=pool->height)
+		return -1;
+	if(pool->free_number==pool->capacity)
+	{
+		void **free_memory = realloc(pool->free_memory, 2*pool->capacity*sizeof(void *));
+		if(!free_memory)
+		{
+			// the image can not be kept, free it
+			yuv_rgb_image_free(image);
+			return 0;
+		}
+		pool->free_memory = free_memory;
+		pool->capacity *= 2;
+	}
+	pool->free_memory[pool->free_number++] = image->memory;
+	memset(image, 0, sizeof(YUVRGBImage));
+	return 0;
+}
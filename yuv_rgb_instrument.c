@@ -0,0 +1,159 @@
+// Copyright 2016 Adrien Descamps
+// Distributed under BSD 3-Clause License
+
+// Instrumentation of the dispatch functions (see yuv_rgb.h)
+//
+// Each call site of an implementation in a dispatch function has a static counter (see INSTRUMENTED_CALL in
+// yuv_rgb.c), added on its first call to a lock free list, which is read by yuv_rgb_get_kernel_stats. The counters are
+// incremented with relaxed atomic additions. Without USE_INSTRUMENTATION, the dispatch functions call the
+// implementations directly, and the functions of this file do nothing.
+
+// for clock_gettime
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include "yuv_rgb.h"
+#include "yuv_rgb_internal.h"
+
+#include <stddef.h>
+
+#if USE_INSTRUMENTATION
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#ifdef _MSC_VER
+#define atomic_add(P, V) InterlockedExchangeAdd64((volatile LONG64 *)(P), (LONG64)(V))
+#define atomic_load(P) ((uint64_t)InterlockedCompareExchange64((volatile LONG64 *)(P), 0, 0))
+#define atomic_store(P, V) InterlockedExchange64((volatile LONG64 *)(P), (LONG64)(V))
+#define atomic_load_flag(P) InterlockedCompareExchange((volatile LONG *)(P), 0, 0)
+#define atomic_set_flag(P) (InterlockedCompareExchange((volatile LONG *)(P), 1, 0)==0)
+#define atomic_load_pointer(P) InterlockedCompareExchangePointer((PVOID volatile *)(P), NULL, NULL)
+#define atomic_swap_pointer(P, OLD, NEW) (InterlockedCompareExchangePointer((PVOID volatile *)(P), NEW, OLD)==(OLD))
+#else
+#define atomic_add(P, V) __atomic_fetch_add(P, V, __ATOMIC_RELAXED)
+#define atomic_load(P) __atomic_load_n(P, __ATOMIC_RELAXED)
+#define atomic_store(P, V) __atomic_store_n(P, V, __ATOMIC_RELAXED)
+#define atomic_load_flag(P) __atomic_load_n(P, __ATOMIC_ACQUIRE)
+#define atomic_set_flag(P) (__atomic_exchange_n(P, 1, __ATOMIC_ACQ_REL)==0)
+#define atomic_load_pointer(P) __atomic_load_n(P, __ATOMIC_ACQUIRE)
+#define atomic_swap_pointer(P, OLD, NEW) \
+	__atomic_compare_exchange_n(P, &(OLD), NEW, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED)
+#endif
+
+// list of the counters called at least once
+static YUVRGBCounter *counters = NULL;
+
+static volatile yuv_rgb_trace_callback trace_callback = NULL;
+static void *volatile trace_user_data = NULL;
+
+// monotonic time in nanoseconds
+static uint64_t now(void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER counter, frequency;
+	QueryPerformanceCounter(&counter);
+	QueryPerformanceFrequency(&frequency);
+	return (uint64_t)((double)counter.QuadPart*1e9/(double)frequency.QuadPart);
+#else
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (uint64_t)t.tv_sec*1000000000u + (uint64_t)t.tv_nsec;
+#endif
+}
+
+uint64_t yuv_rgb_instrument_begin(YUVRGBCounter *counter, uint32_t width, uint32_t height)
+{
+	if(!atomic_load_flag(&counter->registered) && atomic_set_flag(&counter->registered))
+	{
+		// first call, the counter is published once its next pointer is set
+		YUVRGBCounter *head;
+		do
+		{
+			head = atomic_load_pointer(&counters);
+			counter->next = head;
+		}
+		while(!atomic_swap_pointer(&counters, head, counter));
+	}
+
+	const yuv_rgb_trace_callback callback = trace_callback;
+	if(callback)
+		callback(trace_user_data, counter->implementation, width, height, 0);
+	return now();
+}
+
+void yuv_rgb_instrument_end(YUVRGBCounter *counter, uint32_t width, uint32_t height, uint64_t start)
+{
+	const uint64_t time = now()-start;
+	atomic_add(&counter->calls, 1);
+	atomic_add(&counter->pixels, (uint64_t)width*height);
+	atomic_add(&counter->nanoseconds, time);
+
+	const yuv_rgb_trace_callback callback = trace_callback;
+	if(callback)
+		callback(trace_user_data, counter->implementation, width, height, 1);
+}
+
+uint32_t yuv_rgb_get_kernel_stats(YUVRGBKernelStats *stats, uint32_t max_number)
+{
+	uint32_t number = 0;
+	const YUVRGBCounter *counter;
+	for(counter = atomic_load_pointer(&counters); counter; counter = counter->next)
+	{
+		const uint64_t calls = atomic_load(&counter->calls);
+		// counters registered before the last reset may not have been called since
+		if(calls==0)
+			continue;
+		if(number<max_number)
+		{
+			stats[number].implementation = counter->implementation;
+			stats[number].calls = calls;
+			stats[number].pixels = atomic_load(&counter->pixels);
+			stats[number].nanoseconds = atomic_load(&counter->nanoseconds);
+		}
+		++number;
+	}
+	return number;
+}
+
+void yuv_rgb_reset_kernel_stats(void)
+{
+	YUVRGBCounter *counter;
+	for(counter = atomic_load_pointer(&counters); counter; counter = counter->next)
+	{
+		atomic_store(&counter->calls, 0);
+		atomic_store(&counter->pixels, 0);
+		atomic_store(&counter->nanoseconds, 0);
+	}
+}
+
+int yuv_rgb_set_trace_callback(yuv_rgb_trace_callback callback, void *user_data)
+{
+	trace_user_data = user_data;
+	trace_callback = callback;
+	return 0;
+}
+
+#else
+
+uint32_t yuv_rgb_get_kernel_stats(YUVRGBKernelStats *stats, uint32_t max_number)
+{
+	(void)stats; (void)max_number;
+	return 0;
+}
+
+void yuv_rgb_reset_kernel_stats(void)
+{
+}
+
+int yuv_rgb_set_trace_callback(yuv_rgb_trace_callback callback, void *user_data)
+{
+	(void)callback; (void)user_data;
+	return -1;
+}
+
+#endif
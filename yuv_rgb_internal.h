@@ -0,0 +1,680 @@
+// Copyright 2016 Adrien Descamps
+// Distributed under BSD 3-Clause License
+
+// Definitions shared by the different implementations of the library (see yuv_rgb.c), not part of the public api
+
+#ifndef YUV_RGB_INTERNAL_H
+#define YUV_RGB_INTERNAL_H
+
+#include <stdint.h>
+
+// the definitions shared by the implementations are not exported by the shared library
+#if defined(__GNUC__) && !defined(_WIN32)
+#pragma GCC visibility push(hidden)
+#endif
+
+// see yuv_rgb.c for description
+typedef struct
+{
+	uint8_t r_factor;    // [Rf]
+	uint8_t g_factor;    // [Rg]
+	uint8_t b_factor;    // [Rb]
+	uint8_t cb_factor;   // [CbRange/(255*CbNorm)]
+	uint8_t cr_factor;   // [CrRange/(255*CrNorm)]
+	uint8_t y_factor;    // [(YMax-YMin)/255]
+	uint8_t y_offset;    // YMin
+} RGB2YUVParam;
+
+typedef struct
+{
+	uint8_t cb_factor;   // [(255*CbNorm)/CbRange]
+	uint8_t cr_factor;   // [(255*CrNorm)/CrRange]
+	uint8_t g_cb_factor; // [Bf/Gf*(255*CbNorm)/CbRange]
+	uint8_t g_cr_factor; // [Rf/Gf*(255*CrNorm)/CrRange]
+	uint8_t y_factor;    // [255/(YMax-YMin)]
+	uint8_t y_offset;    // YMin
+} YUV2RGBParam;
+
+// high bit depth yuv to rgb, for rgb values of BITS bits (see YUV2RGB16_PARAM in yuv_rgb.c)
+typedef struct
+{
+	int16_t cb_factor;   // [2*(2^BITS-1)*(CbNorm)/(256*CbRange)]
+	int16_t cr_factor;   // [2*(2^BITS-1)*(CrNorm)/(256*CrRange)]
+	int16_t g_cb_factor; // [Bf/Gf*2*(2^BITS-1)*(CbNorm)/(256*CbRange)]
+	int16_t g_cr_factor; // [Rf/Gf*2*(2^BITS-1)*(CrNorm)/(256*CrRange)]
+	int16_t y_factor;    // [2*(2^BITS-1)/(256*(YMax-YMin))]
+	uint16_t y_offset;   // 256*YMin
+} YUV2RGB16Param;
+
+// precise rgb to yuv, with 15 bits factors (see RGB2YUV_PRECISE_PARAM in yuv_rgb.c)
+typedef struct
+{
+	int16_t y_r, y_g, y_b;    // [Rf*(YMax-YMin)/255], [Gf*...], [Bf*...]
+	int16_t cb_r, cb_g, cb_b; // [-Rf*CbRange/(255*CbNorm)], [-Gf*...], [(1-Bf)*...]
+	int16_t cr_r, cr_g, cr_b; // [(1-Rf)*CrRange/(255*CrNorm)], [-Gf*...], [-Bf*...]
+	int32_t y_offset;         // [YMin]+0.5
+} RGB2YUVPreciseParam;
+
+// neon is part of the base aarch64 isa, so the neon implementation is always compiled and used there
+#if defined(__aarch64__) || defined(_M_ARM64)
+#define _YUVRGB_NEON_
+#endif
+
+// parameters of each YCbCrType, the custom color spaces being set by yuv_rgb_set_custom_color_space
+extern RGB2YUVParam RGB2YUV[YCBCR_TYPE_COUNT];
+extern YUV2RGBParam YUV2RGB[YCBCR_TYPE_COUNT];
+extern RGB2YUVPreciseParam RGB2YUV_PRECISE[YCBCR_TYPE_COUNT];
+// high bit depth yuv to rgb parameters for 8, 10 and 16 bits rgb values, with N=RGB16_SHIFT(BITS) bits of fraction (so
+// that the precision is the same for all outputs), the rgb values being rounded by RGB16_ROUND(BITS) and clamped to
+// [0, RGB16_MAX(BITS)]
+extern YUV2RGB16Param YUV2RGB16_8[YCBCR_TYPE_COUNT];
+extern YUV2RGB16Param YUV2RGB16_10[YCBCR_TYPE_COUNT];
+extern YUV2RGB16Param YUV2RGB16_16[YCBCR_TYPE_COUNT];
+
+// KERNEL_PARAM(TYPE, TABLE) declares param, pointing to a local copy of the parameters of yuv_type in TABLE, which the
+// implementations use instead of the table itself: for the compiler, the stores to the uint8_t outputs may modify the
+// table, so that each parameter would be loaded and broadcast again in every iteration, while the local copy is loop
+// invariant, and its broadcasts are kept in registers
+#define KERNEL_PARAM(TYPE, TABLE) \
+	const TYPE param_copy = TABLE[yuv_type]; \
+	const TYPE *const param = &param_copy;
+
+// counter of the calls of an implementation by a dispatch function, see INSTRUMENTED_CALL in yuv_rgb.c and
+// yuv_rgb_instrument.c
+typedef struct YUVRGBCounter
+{
+	const char *implementation;
+	uint64_t calls, pixels, nanoseconds;
+	// set when the counter is added to the list of counters, on its first call
+	uint32_t registered;
+	struct YUVRGBCounter *next;
+} YUVRGBCounter;
+
+// called before and after the implementation, begin returns the start time given to end
+uint64_t yuv_rgb_instrument_begin(YUVRGBCounter *counter, uint32_t width, uint32_t height);
+void yuv_rgb_instrument_end(YUVRGBCounter *counter, uint32_t width, uint32_t height, uint64_t start);
+
+// dispatch functions with the store policy of the call instead of the one of yuv_rgb_set_store_policy, used by the
+// conversions made of several calls (bands of threads, frames of batches, small internal buffers), for which the
+// automatic policy must be decided from their whole output, or regular stores be used
+// yuv_rgb_output_store_policy resolves the current policy for an output of OUTPUT bytes, to YUVRGB_STORE_STREAM or
+// YUVRGB_STORE_CACHED
+YUVRGBStorePolicy yuv_rgb_output_store_policy(uint64_t output);
+
+// width in pixels of the blocks of the widest implementation selected by the dispatch functions on this cpu: 128 for
+// avx512, 64 for avx2, 32 for sse, 16 for neon and 2 (a pair of pixels) for the standard implementations
+// each width is a multiple of the narrower ones, and the conversions without avx512 (or avx2) implementation use
+// the widest one they have
+uint32_t yuv_rgb_block_width(void);
+
+#define YUV420_RGB_POLICY_DECLARATION(FORMAT) \
+void yuv420_##FORMAT##_policy(uint32_t width, uint32_t height, \
+	const uint8_t *Y, const uint8_t *U, const uint8_t *V, uint32_t Y_stride, uint32_t UV_stride, \
+	uint8_t *RGB, uint32_t RGB_stride, YCbCrType yuv_type, YUVRGBStorePolicy policy);
+
+#define NV12_RGB_POLICY_DECLARATION(NAME, FORMAT) \
+void NAME##_##FORMAT##_policy(uint32_t width, uint32_t height, \
+	const uint8_t *Y, const uint8_t *UV, uint32_t Y_stride, uint32_t UV_stride, \
+	uint8_t *RGB, uint32_t RGB_stride, YCbCrType yuv_type, YUVRGBStorePolicy policy);
+
+#define RGB_YUV420_POLICY_DECLARATION(FORMAT) \
+void FORMAT##_yuv420_policy(uint32_t width, uint32_t height, const uint8_t *RGB, uint32_t RGB_stride, \
+	uint8_t *Y, uint8_t *U, uint8_t *V, uint32_t Y_stride, uint32_t UV_stride, YCbCrType yuv_type, \
+	YUVRGBStorePolicy policy);
+
+#define YUV_RGB_POLICY_DECLARATIONS(FORMAT) \
+YUV420_RGB_POLICY_DECLARATION(FORMAT) \
+NV12_RGB_POLICY_DECLARATION(nv12, FORMAT) \
+NV12_RGB_POLICY_DECLARATION(nv21, FORMAT)
+
+YUV_RGB_POLICY_DECLARATIONS(rgb24)
+YUV_RGB_POLICY_DECLARATIONS(rgb32)
+YUV_RGB_POLICY_DECLARATIONS(bgra)
+YUV_RGB_POLICY_DECLARATIONS(argb)
+YUV_RGB_POLICY_DECLARATIONS(bgr24)
+YUV_RGB_POLICY_DECLARATIONS(rgb565)
+RGB_YUV420_POLICY_DECLARATION(rgb24)
+RGB_YUV420_POLICY_DECLARATION(rgb32)
+
+#undef YUV420_RGB_POLICY_DECLARATION
+#undef NV12_RGB_POLICY_DECLARATION
+#undef RGB_YUV420_POLICY_DECLARATION
+#undef YUV_RGB_POLICY_DECLARATIONS
+
+#define RGB16_SHIFT(BITS) (28-(BITS))
+#define RGB16_ROUND(BITS) (1<<(27-(BITS)))
+#define RGB16_MAX(BITS) ((1<<(BITS))-1)
+
+// precise rgb to yuv: 15 bits of fraction for y, and 17 for the chroma values, computed from sums of 4 pixels (with
+// 128+0.5 as offset)
+#define PRECISE_Y_SHIFT 15
+#define PRECISE_CHROMA_SHIFT 17
+#define PRECISE_CHROMA_OFFSET ((128<<PRECISE_CHROMA_SHIFT) + (1<<(PRECISE_CHROMA_SHIFT-1)))
+
+// pointer PTR moved by OFFSET bytes
+#define BYTE_OFFSET(PTR, OFFSET) ((void*)(((uint8_t*)(PTR))+(OFFSET)))
+
+// The simd implementations process blocks of N pixels on pairs of lines. At the end of each function, the
+// *_TAIL macros process the rest of the image, so that a single call always converts the whole image:
+// - the end of the lines, with an overlapping last block computed by the unaligned implementation UNALIGNED
+// - the last column of odd widths, with the standard implementation STD
+// - the last line of odd heights, computed by UNALIGNED as a pair of identical lines (strides set to 0)
+// Images narrower than N pixels are entirely converted by STD.
+// Recomputed pixels of the overlapping block get the same values, so the result does not depend on N.
+// BPP is the number of bytes per rgb pixel, and strides are in bytes (the yuv samples can be 8 or 16 bits values)
+#define YUV420_RGB_TAIL(N, BPP, UNALIGNED, STD) \
+	if(width<N) \
+		STD(width, height, Y, U, V, Y_stride, UV_stride, RGB, RGB_stride, yuv_type); \
+	else \
+	{ \
+		const uint32_t x_tail = (width&~1u)-N; \
+		if(((width&~1u)%N)!=0) \
+			UNALIGNED(N, height&~1u, Y+x_tail, U+x_tail/2, V+x_tail/2, Y_stride, UV_stride, RGB+BPP*x_tail, RGB_stride, yuv_type); \
+		if(width%2) \
+			STD(1, height&~1u, Y+width-1, U+width/2, V+width/2, Y_stride, UV_stride, RGB+BPP*(width-1), RGB_stride, yuv_type); \
+		if(height%2) \
+			UNALIGNED(width, 2, BYTE_OFFSET(Y, (height-1)*Y_stride), BYTE_OFFSET(U, (height/2)*UV_stride), \
+				BYTE_OFFSET(V, (height/2)*UV_stride), 0, 0, RGB+(height-1)*RGB_stride, 0, yuv_type); \
+	}
+
+#define NV12_RGB_TAIL(N, BPP, UNALIGNED, STD) \
+	if(width<N) \
+		STD(width, height, Y, UV, Y_stride, UV_stride, RGB, RGB_stride, yuv_type); \
+	else \
+	{ \
+		const uint32_t x_tail = (width&~1u)-N; \
+		if(((width&~1u)%N)!=0) \
+			UNALIGNED(N, height&~1u, Y+x_tail, UV+x_tail, Y_stride, UV_stride, RGB+BPP*x_tail, RGB_stride, yuv_type); \
+		if(width%2) \
+			STD(1, height&~1u, Y+width-1, UV+width-1, Y_stride, UV_stride, RGB+BPP*(width-1), RGB_stride, yuv_type); \
+		if(height%2) \
+			UNALIGNED(width, 2, BYTE_OFFSET(Y, (height-1)*Y_stride), BYTE_OFFSET(UV, (height/2)*UV_stride), 0, 0, \
+				RGB+(height-1)*RGB_stride, 0, yuv_type); \
+	}
+
+// Planar rgb output (see yuv420_rgb_planar_std in yuv_rgb.c)
+// The three planes R, G and B share the stride RGB_stride, in bytes. The float formats also take the normalization
+// parameters norm, PLANAR_NORM_PARAM_<FORMAT> and PLANAR_NORM_ARG_<FORMAT> being the matching parameter declaration
+// and argument (with their trailing comma, empty for uint8 planes).
+#define PLANAR_NORM_PARAM_rgb_planar
+#define PLANAR_NORM_PARAM_rgb_planar_f32 const RGBNormalization *norm,
+#define PLANAR_NORM_PARAM_rgb_planar_f16 const RGBNormalization *norm,
+#define PLANAR_NORM_ARG_rgb_planar
+#define PLANAR_NORM_ARG_rgb_planar_f32 norm,
+#define PLANAR_NORM_ARG_rgb_planar_f16 norm,
+
+// pointers to the planes of the pair of lines Y1 and Y2, moved by PLANAR_RGB_ADVANCE(N) pixels
+#define PLANAR_RGB_LINES(TYPE, Y1, Y2) \
+	TYPE *r_ptr1=BYTE_OFFSET(R, (Y1)*RGB_stride), *g_ptr1=BYTE_OFFSET(G, (Y1)*RGB_stride), *b_ptr1=BYTE_OFFSET(B, (Y1)*RGB_stride), \
+		*r_ptr2=BYTE_OFFSET(R, (Y2)*RGB_stride), *g_ptr2=BYTE_OFFSET(G, (Y2)*RGB_stride), *b_ptr2=BYTE_OFFSET(B, (Y2)*RGB_stride);
+
+#define PLANAR_RGB_ADVANCE(N) \
+	r_ptr1+=N; g_ptr1+=N; b_ptr1+=N; \
+	r_ptr2+=N; g_ptr2+=N; b_ptr2+=N;
+
+// same as YUV420_RGB_TAIL and NV12_RGB_TAIL, for the planar rgb formats
+#define YUV420_RGB_PLANAR_TAIL(N, NORM_ARG, UNALIGNED, STD) \
+	if(width<N) \
+		STD(width, height, Y, U, V, Y_stride, UV_stride, R, G, B, RGB_stride, NORM_ARG yuv_type); \
+	else \
+	{ \
+		const uint32_t x_tail = (width&~1u)-N; \
+		if(((width&~1u)%N)!=0) \
+			UNALIGNED(N, height&~1u, Y+x_tail, U+x_tail/2, V+x_tail/2, Y_stride, UV_stride, \
+				R+x_tail, G+x_tail, B+x_tail, RGB_stride, NORM_ARG yuv_type); \
+		if(width%2) \
+			STD(1, height&~1u, Y+width-1, U+width/2, V+width/2, Y_stride, UV_stride, \
+				R+width-1, G+width-1, B+width-1, RGB_stride, NORM_ARG yuv_type); \
+		if(height%2) \
+			UNALIGNED(width, 2, Y+(height-1)*Y_stride, U+(height/2)*UV_stride, V+(height/2)*UV_stride, 0, 0, \
+				BYTE_OFFSET(R, (height-1)*RGB_stride), BYTE_OFFSET(G, (height-1)*RGB_stride), \
+				BYTE_OFFSET(B, (height-1)*RGB_stride), 0, NORM_ARG yuv_type); \
+	}
+
+#define NV12_RGB_PLANAR_TAIL(N, NORM_ARG, UNALIGNED, STD) \
+	if(width<N) \
+		STD(width, height, Y, UV, Y_stride, UV_stride, R, G, B, RGB_stride, NORM_ARG yuv_type); \
+	else \
+	{ \
+		const uint32_t x_tail = (width&~1u)-N; \
+		if(((width&~1u)%N)!=0) \
+			UNALIGNED(N, height&~1u, Y+x_tail, UV+x_tail, Y_stride, UV_stride, \
+				R+x_tail, G+x_tail, B+x_tail, RGB_stride, NORM_ARG yuv_type); \
+		if(width%2) \
+			STD(1, height&~1u, Y+width-1, UV+width-1, Y_stride, UV_stride, \
+				R+width-1, G+width-1, B+width-1, RGB_stride, NORM_ARG yuv_type); \
+		if(height%2) \
+			UNALIGNED(width, 2, Y+(height-1)*Y_stride, UV+(height/2)*UV_stride, 0, 0, \
+				BYTE_OFFSET(R, (height-1)*RGB_stride), BYTE_OFFSET(G, (height-1)*RGB_stride), \
+				BYTE_OFFSET(B, (height-1)*RGB_stride), 0, NORM_ARG yuv_type); \
+	}
+
+// BPP is the number of bytes per rgb pixel
+#define RGB_YUV420_TAIL(N, BPP, RGB_PTR, RGB_STRIDE, UNALIGNED, STD) \
+	if(width<N) \
+		STD(width, height, RGB_PTR, RGB_STRIDE, Y, U, V, Y_stride, UV_stride, yuv_type); \
+	else \
+	{ \
+		const uint32_t x_tail = (width&~1u)-N; \
+		if(((width&~1u)%N)!=0) \
+			UNALIGNED(N, height&~1u, RGB_PTR+BPP*x_tail, RGB_STRIDE, Y+x_tail, U+x_tail/2, V+x_tail/2, Y_stride, UV_stride, yuv_type); \
+		if(width%2) \
+			STD(1, height&~1u, RGB_PTR+BPP*(width-1), RGB_STRIDE, Y+width-1, U+width/2, V+width/2, Y_stride, UV_stride, yuv_type); \
+		if(height%2) \
+			UNALIGNED(width, 2, RGB_PTR+(height-1)*RGB_STRIDE, 0, Y+(height-1)*Y_stride, U+(height/2)*UV_stride, V+(height/2)*UV_stride, \
+				0, 0, yuv_type); \
+	}
+
+// YUVA420 formats (see rgb32_yuva420_std in yuv_rgb.c)
+// The alpha plane A uses the stride of the y plane, it is optional for rgba to yuva (NULL to only convert the
+// colors), and PREMULTIPLIED is the premultiplied alpha argument of the rgba to yuva conversions.
+#define YUVA420_RGB_TAIL(N, UNALIGNED, STD) \
+	if(width<N) \
+		STD(width, height, Y, U, V, A, Y_stride, UV_stride, RGB, RGB_stride, yuv_type); \
+	else \
+	{ \
+		const uint32_t x_tail = (width&~1u)-N; \
+		if(((width&~1u)%N)!=0) \
+			UNALIGNED(N, height&~1u, Y+x_tail, U+x_tail/2, V+x_tail/2, A+x_tail, Y_stride, UV_stride, RGB+4*x_tail, \
+				RGB_stride, yuv_type); \
+		if(width%2) \
+			STD(1, height&~1u, Y+width-1, U+width/2, V+width/2, A+width-1, Y_stride, UV_stride, RGB+4*(width-1), \
+				RGB_stride, yuv_type); \
+		if(height%2) \
+			UNALIGNED(width, 2, Y+(height-1)*Y_stride, U+(height/2)*UV_stride, V+(height/2)*UV_stride, \
+				A+(height-1)*Y_stride, 0, 0, RGB+(height-1)*RGB_stride, 0, yuv_type); \
+	}
+
+// offset alpha plane pointer of rgba to yuva, NULL without alpha plane
+#define ALPHA_OFFSET(OFFSET) (A ? A+(OFFSET) : NULL)
+
+#define RGBA_YUVA420_TAIL(N, UNALIGNED, STD) \
+	if(width<N) \
+		STD(width, height, RGBA, RGBA_stride, Y, U, V, A, Y_stride, UV_stride, premultiplied, yuv_type); \
+	else \
+	{ \
+		const uint32_t x_tail = (width&~1u)-N; \
+		if(((width&~1u)%N)!=0) \
+			UNALIGNED(N, height&~1u, RGBA+4*x_tail, RGBA_stride, Y+x_tail, U+x_tail/2, V+x_tail/2, \
+				ALPHA_OFFSET(x_tail), Y_stride, UV_stride, premultiplied, yuv_type); \
+		if(width%2) \
+			STD(1, height&~1u, RGBA+4*(width-1), RGBA_stride, Y+width-1, U+width/2, V+width/2, \
+				ALPHA_OFFSET(width-1), Y_stride, UV_stride, premultiplied, yuv_type); \
+		if(height%2) \
+			UNALIGNED(width, 2, RGBA+(height-1)*RGBA_stride, 0, Y+(height-1)*Y_stride, U+(height/2)*UV_stride, \
+				V+(height/2)*UV_stride, ALPHA_OFFSET((height-1)*Y_stride), 0, 0, premultiplied, yuv_type); \
+	}
+
+// 4:2:2 and 4:4:4 formats (see yuv422p_rgb24_std in yuv_rgb.c)
+// These formats are converted line by line, each format NAME being described by:
+// * YUV_PARAM_<NAME>(TYPE) and YUV_ARGS_<NAME>(X): the yuv parameters of the functions (TYPE being const uint8_t or
+//   uint8_t), and the matching arguments for the image starting at column X (even for 4:2:2)
+// * YUV_LINE_<NAME>(TYPE): the pointers to the samples of line y, moved by YUV_ADVANCE_<NAME>(N) pixels
+// * Y_<NAME>(DX), U_<NAME> and V_<NAME>: the y value of the pixel DX and the shared u and v values, relative to the
+//   line pointers
+// * YUV_PAD_<NAME>: completes the last pair of pixels of odd widths of 4:2:2 formats (second y value of packed formats)
+#define YUV_PARAM_yuv422p(TYPE) TYPE *Y, TYPE *U, TYPE *V, uint32_t Y_stride, uint32_t UV_stride
+#define YUV_ARGS_yuv422p(X) Y+(X), U+(X)/2, V+(X)/2, Y_stride, UV_stride
+#define YUV_LINE_yuv422p(TYPE) TYPE *y_ptr=Y+y*Y_stride, *u_ptr=U+y*UV_stride, *v_ptr=V+y*UV_stride;
+#define YUV_ADVANCE_yuv422p(N) y_ptr+=N; u_ptr+=(N)/2; v_ptr+=(N)/2;
+#define Y_yuv422p(DX) y_ptr[DX]
+#define U_yuv422p u_ptr[0]
+#define V_yuv422p v_ptr[0]
+#define YUV_PAD_yuv422p
+
+#define YUV_PARAM_yuv444p(TYPE) YUV_PARAM_yuv422p(TYPE)
+#define YUV_ARGS_yuv444p(X) Y+(X), U+(X), V+(X), Y_stride, UV_stride
+#define YUV_LINE_yuv444p(TYPE) YUV_LINE_yuv422p(TYPE)
+#define YUV_ADVANCE_yuv444p(N) y_ptr+=N; u_ptr+=N; v_ptr+=N;
+#define Y_yuv444p(DX) y_ptr[DX]
+#define U_yuv444p u_ptr[0]
+#define V_yuv444p v_ptr[0]
+
+#define YUV_PARAM_nv16(TYPE) TYPE *Y, TYPE *UV, uint32_t Y_stride, uint32_t UV_stride
+#define YUV_ARGS_nv16(X) Y+(X), UV+(X), Y_stride, UV_stride
+#define YUV_LINE_nv16(TYPE) TYPE *y_ptr=Y+y*Y_stride, *uv_ptr=UV+y*UV_stride;
+#define YUV_ADVANCE_nv16(N) y_ptr+=N; uv_ptr+=N;
+#define Y_nv16(DX) y_ptr[DX]
+#define U_nv16 uv_ptr[0]
+#define V_nv16 uv_ptr[1]
+#define YUV_PAD_nv16
+
+#define YUV_PARAM_nv24(TYPE) YUV_PARAM_nv16(TYPE)
+#define YUV_ARGS_nv24(X) Y+(X), UV+2*(X), Y_stride, UV_stride
+#define YUV_LINE_nv24(TYPE) YUV_LINE_nv16(TYPE)
+#define YUV_ADVANCE_nv24(N) y_ptr+=N; uv_ptr+=2*(N);
+#define Y_nv24(DX) y_ptr[DX]
+#define U_nv24 uv_ptr[0]
+#define V_nv24 uv_ptr[1]
+
+#define YUV_PARAM_yuyv(TYPE) TYPE *YUV, uint32_t YUV_stride
+#define YUV_ARGS_yuyv(X) YUV+2*(X), YUV_stride
+#define YUV_LINE_yuyv(TYPE) TYPE *yuv_ptr=YUV+y*YUV_stride;
+#define YUV_ADVANCE_yuyv(N) yuv_ptr+=2*(N);
+#define Y_yuyv(DX) yuv_ptr[2*(DX)]
+#define U_yuyv yuv_ptr[1]
+#define V_yuyv yuv_ptr[3]
+#define YUV_PAD_yuyv yuv_ptr[2] = yuv_ptr[0];
+
+#define YUV_PARAM_uyvy(TYPE) YUV_PARAM_yuyv(TYPE)
+#define YUV_ARGS_uyvy(X) YUV_ARGS_yuyv(X)
+#define YUV_LINE_uyvy(TYPE) YUV_LINE_yuyv(TYPE)
+#define YUV_ADVANCE_uyvy(N) YUV_ADVANCE_yuyv(N)
+#define Y_uyvy(DX) yuv_ptr[2*(DX)+1]
+#define U_uyvy yuv_ptr[0]
+#define V_uyvy yuv_ptr[2]
+#define YUV_PAD_uyvy yuv_ptr[3] = yuv_ptr[1];
+
+// number of pixels sharing the same chroma values
+#define YUV_PAIR_422 2
+#define YUV_PAIR_444 1
+
+// same as YUV420_RGB_TAIL for the 4:2:2 (SUBSAMPLING 422) and 4:4:4 (444) formats, which have no odd height case
+#define YUV_RGB_LINES_TAIL(N, BPP, SUBSAMPLING, NAME, UNALIGNED, STD) \
+	if(width<N) \
+		STD(width, height, YUV_ARGS_##NAME(0), RGB, RGB_stride, yuv_type); \
+	else \
+	{ \
+		const uint32_t x_end = width-width%YUV_PAIR_##SUBSAMPLING, x_tail = x_end-N; \
+		if((x_end%N)!=0) \
+			UNALIGNED(N, height, YUV_ARGS_##NAME(x_tail), RGB+BPP*x_tail, RGB_stride, yuv_type); \
+		if(x_end<width) \
+			STD(1, height, YUV_ARGS_##NAME(x_end), RGB+BPP*x_end, RGB_stride, yuv_type); \
+	}
+
+#define RGB_YUV_LINES_TAIL(N, BPP, SUBSAMPLING, NAME, UNALIGNED, STD) \
+	if(width<N) \
+		STD(width, height, RGB, RGB_stride, YUV_ARGS_##NAME(0), yuv_type); \
+	else \
+	{ \
+		const uint32_t x_end = width-width%YUV_PAIR_##SUBSAMPLING, x_tail = x_end-N; \
+		if((x_end%N)!=0) \
+			UNALIGNED(N, height, RGB+BPP*x_tail, RGB_stride, YUV_ARGS_##NAME(x_tail), yuv_type); \
+		if(x_end<width) \
+			STD(1, height, RGB+BPP*x_end, RGB_stride, YUV_ARGS_##NAME(x_end), yuv_type); \
+	}
+
+// Direct yuv format conversions (see nv12_yuv420_std in yuv_rgb.c)
+// The yuv420 formats (yuv420, nv12 and nv21) and the packed 4:2:2 formats (yuyv and uyvy) are described by:
+// * SRC_PARAM_<NAME> and DST_PARAM_<NAME>: the parameters of the source and destination planes of the functions, the
+//   destination ones having a _dst suffix, and the matching SRC_ARGS_<NAME> and DST_ARGS_<NAME>
+// * SRC_CHROMA_<NAME>(L) and DST_CHROMA_<NAME>(L) for yuv420 formats: the pointers u_src and v_src (or u_dst and v_dst)
+//   to the chroma line L, and the distance src_step (or dst_step) between two samples of a line, as for the bilinear
+//   conversions (1 for planar formats, 2 for semi planar formats)
+// * Y_INDEX_<NAME> for packed formats: the position of the first y value of each pair of pixels
+#define SRC_PARAM_yuv420 const uint8_t *Y, const uint8_t *U, const uint8_t *V, uint32_t Y_stride, uint32_t UV_stride
+#define SRC_ARGS_yuv420 Y, U, V, Y_stride, UV_stride
+#define SRC_CHROMA_yuv420(L) \
+	const uint8_t *const u_src=U+(L)*UV_stride, *const v_src=V+(L)*UV_stride; \
+	const uint32_t src_step = 1;
+
+#define SRC_PARAM_nv12 const uint8_t *Y, const uint8_t *UV, uint32_t Y_stride, uint32_t UV_stride
+#define SRC_ARGS_nv12 Y, UV, Y_stride, UV_stride
+#define SRC_CHROMA_nv12(L) \
+	const uint8_t *const u_src=UV+(L)*UV_stride, *const v_src=u_src+1; \
+	const uint32_t src_step = 2;
+
+#define SRC_PARAM_nv21 SRC_PARAM_nv12
+#define SRC_ARGS_nv21 SRC_ARGS_nv12
+#define SRC_CHROMA_nv21(L) \
+	const uint8_t *const v_src=UV+(L)*UV_stride, *const u_src=v_src+1; \
+	const uint32_t src_step = 2;
+
+#define SRC_PARAM_yuyv const uint8_t *YUV, uint32_t YUV_stride
+#define SRC_ARGS_yuyv YUV, YUV_stride
+#define SRC_PARAM_uyvy SRC_PARAM_yuyv
+#define SRC_ARGS_uyvy SRC_ARGS_yuyv
+
+#define DST_PARAM_yuv420 uint8_t *Y_dst, uint8_t *U_dst, uint8_t *V_dst, uint32_t Y_dst_stride, uint32_t UV_dst_stride
+#define DST_ARGS_yuv420 Y_dst, U_dst, V_dst, Y_dst_stride, UV_dst_stride
+#define DST_CHROMA_yuv420(L) \
+	uint8_t *const u_dst=U_dst+(L)*UV_dst_stride, *const v_dst=V_dst+(L)*UV_dst_stride; \
+	const uint32_t dst_step = 1;
+
+#define DST_PARAM_nv12 uint8_t *Y_dst, uint8_t *UV_dst, uint32_t Y_dst_stride, uint32_t UV_dst_stride
+#define DST_ARGS_nv12 Y_dst, UV_dst, Y_dst_stride, UV_dst_stride
+#define DST_CHROMA_nv12(L) \
+	uint8_t *const u_dst=UV_dst+(L)*UV_dst_stride, *const v_dst=u_dst+1; \
+	const uint32_t dst_step = 2;
+
+#define DST_PARAM_nv21 DST_PARAM_nv12
+#define DST_ARGS_nv21 DST_ARGS_nv12
+#define DST_CHROMA_nv21(L) \
+	uint8_t *const v_dst=UV_dst+(L)*UV_dst_stride, *const u_dst=v_dst+1; \
+	const uint32_t dst_step = 2;
+
+#define DST_PARAM_yuyv uint8_t *YUV_dst, uint32_t YUV_dst_stride
+#define DST_ARGS_yuyv YUV_dst, YUV_dst_stride
+#define DST_PARAM_uyvy DST_PARAM_yuyv
+#define DST_ARGS_uyvy DST_ARGS_yuyv
+
+#define Y_INDEX_yuyv 0
+#define Y_INDEX_uyvy 1
+
+// copy a plane of width bytes per line, nothing is done if dst is src
+void yuv_copy_plane(uint32_t width, uint32_t height, const uint8_t *src, uint32_t src_stride,
+	uint8_t *dst, uint32_t dst_stride);
+
+// copy the chroma samples [x_begin, x_end) of a line
+void yuv_chroma_line_std(uint32_t x_begin, uint32_t x_end, const uint8_t *u_src, const uint8_t *v_src, uint32_t src_step,
+	uint8_t *u_dst, uint8_t *v_dst, uint32_t dst_step);
+
+// split the pixels [x_begin, width) of a pair of lines src1 and src2 of packed 4:2:2 data, x_begin being even, the
+// chroma values of the two lines being averaged
+void yuv_unpack_lines_std(uint32_t width, uint32_t x_begin, const uint8_t *src1, const uint8_t *src2, uint32_t y_index,
+	uint8_t *y_dst1, uint8_t *y_dst2, uint8_t *u_dst, uint8_t *v_dst, uint32_t dst_step);
+
+// pack the pixels [x_begin, width) of a line, x_begin being even, the last y value of odd widths being repeated
+void yuv_pack_line_std(uint32_t width, uint32_t x_begin, const uint8_t *y_src, const uint8_t *u_src,
+	const uint8_t *v_src, uint32_t src_step, uint8_t *dst, uint32_t y_index);
+
+// The simd implementations call BLOCK(X) to convert N samples starting at X, the end of the lines being converted by
+// the standard line functions.
+// YUV420_CHROMA_CONVERT converts between yuv420 formats, X being the chroma column of the lines u_src, v_src, u_dst
+// and v_dst.
+#define YUV420_CHROMA_CONVERT(N, SRC, DST, BLOCK) \
+	const uint32_t chroma_width = (width+1)/2; \
+	uint32_t x, y; \
+	yuv_copy_plane(width, height, Y, Y_stride, Y_dst, Y_dst_stride); \
+	for(y=0; y<(height+1)/2; ++y) \
+	{ \
+		SRC_CHROMA_##SRC(y) \
+		DST_CHROMA_##DST(y) \
+		for(x=0; (x+N)<=chroma_width; x+=N) \
+		{ \
+			BLOCK(x) \
+		} \
+		yuv_chroma_line_std(x, chroma_width, u_src, v_src, src_step, u_dst, v_dst, dst_step); \
+	}
+
+// PACKED_YUV420_CONVERT converts the packed format SRC to the yuv420 format DST, X being the column of the pixels of the
+// lines src1, src2 (the same line for the last line of odd heights), y_dst1 and y_dst2, and of the chroma pairs of
+// u_dst and v_dst.
+#define PACKED_YUV420_CONVERT(N, SRC, DST, BLOCK) \
+	uint32_t x, y; \
+	for(y=0; y<height; y+=2) \
+	{ \
+		const uint32_t y2 = (y+1)<height ? y+1 : y; \
+		const uint8_t *const src1=YUV+y*YUV_stride, *const src2=YUV+y2*YUV_stride; \
+		uint8_t *const y_dst1=Y_dst+y*Y_dst_stride, *const y_dst2=Y_dst+y2*Y_dst_stride; \
+		DST_CHROMA_##DST(y/2) \
+		for(x=0; (x+N)<=width; x+=N) \
+		{ \
+			BLOCK(x) \
+		} \
+		yuv_unpack_lines_std(width, x, src1, src2, Y_INDEX_##SRC, y_dst1, y_dst2, u_dst, v_dst, dst_step); \
+	}
+
+// YUV420_PACKED_CONVERT converts the yuv420 format SRC to the packed format DST, X being the column of the pixels of
+// the lines y_src and dst, and of the chroma pairs of u_src and v_src.
+#define YUV420_PACKED_CONVERT(N, SRC, DST, BLOCK) \
+	uint32_t x, y; \
+	for(y=0; y<height; ++y) \
+	{ \
+		const uint8_t *const y_src=Y+y*Y_stride; \
+		uint8_t *const dst=YUV_dst+y*YUV_dst_stride; \
+		SRC_CHROMA_##SRC(y/2) \
+		for(x=0; (x+N)<=width; x+=N) \
+		{ \
+			BLOCK(x) \
+		} \
+		yuv_pack_line_std(width, x, y_src, u_src, v_src, src_step, dst, Y_INDEX_##DST); \
+	}
+
+// _policy dispatch functions of the other conversions (see yuv_rgb_output_store_policy above), declared here as they
+// use the parameter macros of their formats; the bilinear conversions have no streaming stores, and so no policy
+#define YUV420_PLANAR_POLICY_DECLARATION(FORMAT, TYPE) \
+void yuv420_##FORMAT##_policy(uint32_t width, uint32_t height, \
+	const uint8_t *Y, const uint8_t *U, const uint8_t *V, uint32_t Y_stride, uint32_t UV_stride, \
+	TYPE *R, TYPE *G, TYPE *B, uint32_t RGB_stride, PLANAR_NORM_PARAM_##FORMAT \
+	YCbCrType yuv_type, YUVRGBStorePolicy policy);
+
+#define NV12_PLANAR_POLICY_DECLARATION(NAME, FORMAT, TYPE) \
+void NAME##_##FORMAT##_policy(uint32_t width, uint32_t height, \
+	const uint8_t *Y, const uint8_t *UV, uint32_t Y_stride, uint32_t UV_stride, \
+	TYPE *R, TYPE *G, TYPE *B, uint32_t RGB_stride, PLANAR_NORM_PARAM_##FORMAT \
+	YCbCrType yuv_type, YUVRGBStorePolicy policy);
+
+#define PLANAR_POLICY_DECLARATIONS(FORMAT, TYPE) \
+YUV420_PLANAR_POLICY_DECLARATION(FORMAT, TYPE) \
+NV12_PLANAR_POLICY_DECLARATION(nv12, FORMAT, TYPE) \
+NV12_PLANAR_POLICY_DECLARATION(nv21, FORMAT, TYPE)
+
+PLANAR_POLICY_DECLARATIONS(rgb_planar, uint8_t)
+PLANAR_POLICY_DECLARATIONS(rgb_planar_f32, float)
+PLANAR_POLICY_DECLARATIONS(rgb_planar_f16, uint16_t)
+
+#define YUV16_RGB_POLICY_DECLARATIONS(FORMAT) \
+void yuv420p10_##FORMAT##_policy(uint32_t width, uint32_t height, \
+	const uint16_t *Y, const uint16_t *U, const uint16_t *V, uint32_t Y_stride, uint32_t UV_stride, \
+	uint8_t *RGB, uint32_t RGB_stride, YCbCrType yuv_type, YUVRGBStorePolicy policy); \
+void p010_##FORMAT##_policy(uint32_t width, uint32_t height, \
+	const uint16_t *Y, const uint16_t *UV, uint32_t Y_stride, uint32_t UV_stride, \
+	uint8_t *RGB, uint32_t RGB_stride, YCbCrType yuv_type, YUVRGBStorePolicy policy);
+
+YUV16_RGB_POLICY_DECLARATIONS(rgb24)
+YUV16_RGB_POLICY_DECLARATIONS(rgb48)
+YUV16_RGB_POLICY_DECLARATIONS(x2rgb10)
+
+#define RGB_YUV420_PRECISE_POLICY_DECLARATION(FORMAT) \
+void FORMAT##_yuv420_precise_policy(uint32_t width, uint32_t height, const uint8_t *RGB, uint32_t RGB_stride, \
+	uint8_t *Y, uint8_t *U, uint8_t *V, uint32_t Y_stride, uint32_t UV_stride, YCbCrType yuv_type, \
+	YUVRGBStorePolicy policy);
+
+RGB_YUV420_PRECISE_POLICY_DECLARATION(rgb24)
+RGB_YUV420_PRECISE_POLICY_DECLARATION(rgb32)
+
+#define YUVA420_RGB_POLICY_DECLARATION(FORMAT) \
+void yuva420_##FORMAT##_policy(uint32_t width, uint32_t height, \
+	const uint8_t *Y, const uint8_t *U, const uint8_t *V, const uint8_t *A, uint32_t Y_stride, uint32_t UV_stride, \
+	uint8_t *RGB, uint32_t RGB_stride, YCbCrType yuv_type, YUVRGBStorePolicy policy);
+
+YUVA420_RGB_POLICY_DECLARATION(rgb32)
+YUVA420_RGB_POLICY_DECLARATION(bgra_premultiplied)
+
+void rgb32_yuva420_policy(uint32_t width, uint32_t height, const uint8_t *RGBA, uint32_t RGBA_stride,
+	uint8_t *Y, uint8_t *U, uint8_t *V, uint8_t *A, uint32_t Y_stride, uint32_t UV_stride,
+	int premultiplied, YCbCrType yuv_type, YUVRGBStorePolicy policy);
+
+#define YUV_LINES_POLICY_DECLARATIONS(NAME, FORMAT) \
+void NAME##_##FORMAT##_policy(uint32_t width, uint32_t height, YUV_PARAM_##NAME(const uint8_t), \
+	uint8_t *RGB, uint32_t RGB_stride, YCbCrType yuv_type, YUVRGBStorePolicy policy); \
+void FORMAT##_##NAME##_policy(uint32_t width, uint32_t height, const uint8_t *RGB, uint32_t RGB_stride, \
+	YUV_PARAM_##NAME(uint8_t), YCbCrType yuv_type, YUVRGBStorePolicy policy);
+
+#define YUV_LINES_ALL_POLICY_DECLARATIONS(FORMAT) \
+YUV_LINES_POLICY_DECLARATIONS(yuv422p, FORMAT) \
+YUV_LINES_POLICY_DECLARATIONS(yuv444p, FORMAT) \
+YUV_LINES_POLICY_DECLARATIONS(nv16, FORMAT) \
+YUV_LINES_POLICY_DECLARATIONS(nv24, FORMAT) \
+YUV_LINES_POLICY_DECLARATIONS(yuyv, FORMAT) \
+YUV_LINES_POLICY_DECLARATIONS(uyvy, FORMAT)
+
+YUV_LINES_ALL_POLICY_DECLARATIONS(rgb24)
+YUV_LINES_ALL_POLICY_DECLARATIONS(rgb32)
+
+#define YUV_DIRECT_POLICY_DECLARATION(SRC, DST) \
+void SRC##_##DST##_policy(uint32_t width, uint32_t height, SRC_PARAM_##SRC, DST_PARAM_##DST, \
+	YUVRGBStorePolicy policy);
+
+YUV_DIRECT_POLICY_DECLARATION(nv12, yuv420)
+YUV_DIRECT_POLICY_DECLARATION(nv21, yuv420)
+YUV_DIRECT_POLICY_DECLARATION(yuv420, nv12)
+YUV_DIRECT_POLICY_DECLARATION(yuv420, nv21)
+YUV_DIRECT_POLICY_DECLARATION(yuyv, yuv420)
+YUV_DIRECT_POLICY_DECLARATION(uyvy, yuv420)
+YUV_DIRECT_POLICY_DECLARATION(yuyv, nv12)
+YUV_DIRECT_POLICY_DECLARATION(uyvy, nv12)
+YUV_DIRECT_POLICY_DECLARATION(yuv420, yuyv)
+YUV_DIRECT_POLICY_DECLARATION(yuv420, uyvy)
+YUV_DIRECT_POLICY_DECLARATION(nv12, yuyv)
+YUV_DIRECT_POLICY_DECLARATION(nv12, uyvy)
+
+#undef YUV420_PLANAR_POLICY_DECLARATION
+#undef NV12_PLANAR_POLICY_DECLARATION
+#undef PLANAR_POLICY_DECLARATIONS
+#undef YUV16_RGB_POLICY_DECLARATIONS
+#undef RGB_YUV420_PRECISE_POLICY_DECLARATION
+#undef YUVA420_RGB_POLICY_DECLARATION
+#undef YUV_LINES_POLICY_DECLARATIONS
+#undef YUV_LINES_ALL_POLICY_DECLARATIONS
+#undef YUV_DIRECT_POLICY_DECLARATION
+
+// Bilinear chroma interpolation (see yuv420_rgb24_bilinear_std in yuv_rgb.c)
+
+// convert the pixels [x_begin, x_end) of a line of a width pixels wide image, u_c and v_c being the nearest chroma
+// line, u_o and v_o the other one (previous line for the first line of a pair, next line for the second one), and
+// uv_step the distance between two chroma samples of a line (1 for planar formats, 2 for semi planar formats)
+void yuv420_rgb24_bilinear_line_std(uint32_t width, uint32_t x_begin, uint32_t x_end, const uint8_t *y_ptr,
+	const uint8_t *u_c, const uint8_t *u_o, const uint8_t *v_c, const uint8_t *v_o, uint32_t uv_step,
+	uint8_t *rgb_ptr, const YUV2RGBParam *param);
+
+// chroma lines of the pair of lines y: current (PTR_c), previous (PTR_p) and next (PTR_n), replaced by the nearest line
+// at the top and bottom of the image. The last line of odd heights uses the previous line for both, so that both lines
+// of the pair get the same value.
+#define BILINEAR_CHROMA_LINES(SRC, PTR, STRIDE) \
+	const uint8_t *const PTR##_c = SRC+(y/2)*STRIDE, \
+		*const PTR##_p = y>=2 ? SRC+(y/2-1)*STRIDE : PTR##_c, \
+		*const PTR##_n = (y+2)<height ? SRC+(y/2+1)*STRIDE : ((y+1)<height ? PTR##_c : PTR##_p);
+
+// The simd implementations of the bilinear conversions call BLOCK(X) to convert the N pixels starting at column X of
+// the two lines of a pair, X being even and at least 2 so that the chroma samples on both sides of the block are inside
+// the image. The first two columns and the end of the lines are converted by yuv420_rgb24_bilinear_line_std, and the
+// last block overlaps the previous one if needed. U_SRC, V_SRC and UV_STEP describe the chroma samples as in
+// yuv420_rgb24_bilinear_line_std.
+#define YUV420_RGB_BILINEAR(N, U_SRC, V_SRC, UV_STEP, BLOCK) \
+	KERNEL_PARAM(YUV2RGBParam, YUV2RGB) \
+	/* end of the columns which have chroma samples on both sides */ \
+	const uint32_t x_end = width>0 ? ((width-1)/2)*2 : 0; \
+	uint32_t x, y; \
+	for(y=0; y<height; y+=2) \
+	{ \
+		const uint32_t y2 = (y+1)<height ? y+1 : y; \
+		BILINEAR_CHROMA_LINES(U_SRC, u, UV_stride) \
+		BILINEAR_CHROMA_LINES(V_SRC, v, UV_stride) \
+		const uint8_t *const y_ptr1=Y+y*Y_stride, *const y_ptr2=Y+y2*Y_stride; \
+		uint8_t *const rgb_ptr1=RGB+y*RGB_stride, *const rgb_ptr2=RGB+y2*RGB_stride; \
+		uint32_t x_std = 0; \
+		if(x_end>=N+2) \
+		{ \
+			for(x=2; (x+N)<=x_end; x+=N) \
+			{ \
+				BLOCK(x) \
+			} \
+			if(((x_end-2)%N)!=0) \
+			{ \
+				BLOCK(x_end-N) \
+			} \
+			yuv420_rgb24_bilinear_line_std(width, 0, 2, y_ptr1, u_c, u_p, v_c, v_p, UV_STEP, rgb_ptr1, param); \
+			yuv420_rgb24_bilinear_line_std(width, 0, 2, y_ptr2, u_c, u_n, v_c, v_n, UV_STEP, rgb_ptr2, param); \
+			x_std = x_end; \
+		} \
+		yuv420_rgb24_bilinear_line_std(width, x_std, width, y_ptr1, u_c, u_p, v_c, v_p, UV_STEP, rgb_ptr1, param); \
+		yuv420_rgb24_bilinear_line_std(width, x_std, width, y_ptr2, u_c, u_n, v_c, v_n, UV_STEP, rgb_ptr2, param); \
+	}
+
+#if defined(__GNUC__) && !defined(_WIN32)
+#pragma GCC visibility pop
+#endif
+
+#endif
@@ -0,0 +1,1220 @@
+// Copyright 2016 Adrien Descamps
+// Distributed under BSD 3-Clause License
+
+// NEON implementation of the yuv to rgb and rgb to yuv conversions, processing 16 pixels per iteration.
+// It is selected at compile time on aarch64, where neon is always available (see yuv_rgb_internal.h).
+
+// The fixed point computations are the same as the sse version (see yuv_rgb.c), with the same precision and
+// rounding, so that both give the same results.
+// The interleaved rgb24 and rgba data is loaded and saved with vld3q_u8/vst3q_u8 and vld4q_u8/vst4q_u8, which directly
+// split (or merge) the r, g and b channels, so no shuffle network is needed. For rgb to yuv, the sums of the
+// chroma values of pairs of adjacent pixels are computed with pairwise additions.
+
+#include "yuv_rgb.h"
+#include "yuv_rgb_internal.h"
+
+#ifdef _YUVRGB_NEON_
+
+#include <arm_neon.h>
+
+// compute the r, g and b offsets of 8 u and v values, each of them duplicated for two adjacent pixels
+#define UV2RGB_16_NEON(U, V, R, G, B) \
+	u_16 = vmovl_s8(vreinterpret_s8_u8(veor_u8(U, vdup_n_u8(128)))); \
+	v_16 = vmovl_s8(vreinterpret_s8_u8(veor_u8(V, vdup_n_u8(128)))); \
+	r_tmp = vshrq_n_s16(vmulq_n_s16(v_16, param->cr_factor), 6); \
+	g_tmp = vshrq_n_s16(vaddq_s16( \
+		vmulq_n_s16(u_16, param->g_cb_factor), \
+		vmulq_n_s16(v_16, param->g_cr_factor)), 7); \
+	b_tmp = vshrq_n_s16(vmulq_n_s16(u_16, param->cb_factor), 6); \
+	R = vzipq_s16(r_tmp, r_tmp); \
+	G = vzipq_s16(g_tmp, g_tmp); \
+	B = vzipq_s16(b_tmp, b_tmp); \
+
+// scale 8 y values of pixels and add the rgb offsets
+#define ADD_Y2RGB_8_NEON(Y_8, I, R_16, G_16, B_16) \
+	y_16 = vreinterpretq_s16_u16(vshrq_n_u16(vmulq_n_u16(vmovl_u8(Y_8), param->y_factor), 7)); \
+	R_16 = vaddq_s16(y_16, r_uv.val[I]); \
+	G_16 = vsubq_s16(y_16, g_uv.val[I]); \
+	B_16 = vaddq_s16(y_16, b_uv.val[I]); \
+
+// The SAVE_<FORMAT>_16_NEON macros save the 16 pixels of the line LINE (1 or 2) of a pair, given as 8 bits r, g and b
+// values, in the rgb format FORMAT at the line pointers (rgb_ptr1 and rgb_ptr2 for interleaved formats)
+#define SAVE_3CHANNELS_16_NEON(C1, C2, C3, PTR) \
+	{ \
+		uint8x16x3_t rgb; \
+		rgb.val[0] = C1; \
+		rgb.val[1] = C2; \
+		rgb.val[2] = C3; \
+		vst3q_u8(PTR, rgb); \
+	}
+
+#define SAVE_4CHANNELS_16_NEON(C1, C2, C3, C4, PTR) \
+	{ \
+		uint8x16x4_t rgba; \
+		rgba.val[0] = C1; \
+		rgba.val[1] = C2; \
+		rgba.val[2] = C3; \
+		rgba.val[3] = C4; \
+		vst4q_u8(PTR, rgba); \
+	}
+
+#define SAVE_RGB24_16_NEON(R, G, B, LINE) SAVE_3CHANNELS_16_NEON(R, G, B, rgb_ptr##LINE)
+#define SAVE_BGR24_16_NEON(R, G, B, LINE) SAVE_3CHANNELS_16_NEON(B, G, R, rgb_ptr##LINE)
+#define SAVE_RGB32_16_NEON(R, G, B, LINE) SAVE_4CHANNELS_16_NEON(R, G, B, vdupq_n_u8(255), rgb_ptr##LINE)
+#define SAVE_BGRA_16_NEON(R, G, B, LINE) SAVE_4CHANNELS_16_NEON(B, G, R, vdupq_n_u8(255), rgb_ptr##LINE)
+#define SAVE_ARGB_16_NEON(R, G, B, LINE) SAVE_4CHANNELS_16_NEON(vdupq_n_u8(255), R, G, B, rgb_ptr##LINE)
+
+// pack 8 pixels to rgb565, the high bits of g and b being shifted and inserted below the high bits of r
+#define RGB565_8_NEON(R, G, B) \
+	vsriq_n_u16(vsriq_n_u16(vshll_n_u8(R, 8), vshll_n_u8(G, 8), 5), vshll_n_u8(B, 8), 11)
+
+#define SAVE_RGB565_16_NEON(R, G, B, LINE) \
+	vst1q_u8(rgb_ptr##LINE, vreinterpretq_u8_u16(RGB565_8_NEON(vget_low_u8(R), vget_low_u8(G), vget_low_u8(B)))); \
+	vst1q_u8(rgb_ptr##LINE+16, vreinterpretq_u8_u16(RGB565_8_NEON(vget_high_u8(R), vget_high_u8(G), vget_high_u8(B))));
+
+// planar rgb output, see yuv420_rgb_planar_std in yuv_rgb.c
+#define SAVE_RGB_PLANAR_16_NEON(R, G, B, LINE) \
+	vst1q_u8(r_ptr##LINE, R); \
+	vst1q_u8(g_ptr##LINE, G); \
+	vst1q_u8(b_ptr##LINE, B);
+
+// normalize 4 values of the channel CHANNEL (r, g or b), given as 32 bits integers
+#define NORMALIZE_4_NEON(VALUE, CHANNEL) vmulq_f32(vsubq_f32(vcvtq_f32_u32(VALUE), CHANNEL##_mean), CHANNEL##_scale)
+
+// save the normalized values of a channel for 16 pixels, as single (F32) or half (F16) precision floats
+#define SAVE_F32_16_NEON(C, PTR, CHANNEL) \
+	{ \
+		const uint16x8_t c_lo = vmovl_u8(vget_low_u8(C)), c_hi = vmovl_u8(vget_high_u8(C)); \
+		vst1q_f32(PTR, NORMALIZE_4_NEON(vmovl_u16(vget_low_u16(c_lo)), CHANNEL)); \
+		vst1q_f32(PTR+4, NORMALIZE_4_NEON(vmovl_u16(vget_high_u16(c_lo)), CHANNEL)); \
+		vst1q_f32(PTR+8, NORMALIZE_4_NEON(vmovl_u16(vget_low_u16(c_hi)), CHANNEL)); \
+		vst1q_f32(PTR+12, NORMALIZE_4_NEON(vmovl_u16(vget_high_u16(c_hi)), CHANNEL)); \
+	}
+
+#define HALF_4_NEON(VALUE, CHANNEL) vreinterpret_u16_f16(vcvt_f16_f32(NORMALIZE_4_NEON(VALUE, CHANNEL)))
+
+#define SAVE_F16_16_NEON(C, PTR, CHANNEL) \
+	{ \
+		const uint16x8_t c_lo = vmovl_u8(vget_low_u8(C)), c_hi = vmovl_u8(vget_high_u8(C)); \
+		vst1q_u16(PTR, vcombine_u16(HALF_4_NEON(vmovl_u16(vget_low_u16(c_lo)), CHANNEL), \
+			HALF_4_NEON(vmovl_u16(vget_high_u16(c_lo)), CHANNEL))); \
+		vst1q_u16(PTR+8, vcombine_u16(HALF_4_NEON(vmovl_u16(vget_low_u16(c_hi)), CHANNEL), \
+			HALF_4_NEON(vmovl_u16(vget_high_u16(c_hi)), CHANNEL))); \
+	}
+
+#define SAVE_RGB_PLANAR_F32_16_NEON(R, G, B, LINE) \
+	SAVE_F32_16_NEON(R, r_ptr##LINE, r) \
+	SAVE_F32_16_NEON(G, g_ptr##LINE, g) \
+	SAVE_F32_16_NEON(B, b_ptr##LINE, b)
+
+#define SAVE_RGB_PLANAR_F16_16_NEON(R, G, B, LINE) \
+	SAVE_F16_16_NEON(R, r_ptr##LINE, r) \
+	SAVE_F16_16_NEON(G, g_ptr##LINE, g) \
+	SAVE_F16_16_NEON(B, b_ptr##LINE, b)
+
+// convert one line of 16 pixels of y values Y_8, and save it with SAVE(R, G, B, DST)
+#define YUV2RGB_Y_16_NEON(Y_8, DST, SAVE) \
+	y = vqsubq_u8(Y_8, vdupq_n_u8(param->y_offset)); \
+	ADD_Y2RGB_8_NEON(vget_low_u8(y), 0, r_16_1, g_16_1, b_16_1) \
+	ADD_Y2RGB_8_NEON(vget_high_u8(y), 1, r_16_2, g_16_2, b_16_2) \
+	SAVE(vcombine_u8(vqmovun_s16(r_16_1), vqmovun_s16(r_16_2)), \
+		vcombine_u8(vqmovun_s16(g_16_1), vqmovun_s16(g_16_2)), \
+		vcombine_u8(vqmovun_s16(b_16_1), vqmovun_s16(b_16_2)), DST) \
+
+#define YUV2RGB_LINE_16_NEON(Y_PTR, DST, SAVE) YUV2RGB_Y_16_NEON(vld1q_u8(Y_PTR), DST, SAVE)
+
+#define YUV2RGB_16_NEON(U, V, SAVE) \
+	int16x8_t u_16, v_16, r_tmp, g_tmp, b_tmp, y_16; \
+	int16x8_t r_16_1, g_16_1, b_16_1, r_16_2, g_16_2, b_16_2; \
+	int16x8x2_t r_uv, g_uv, b_uv; \
+	uint8x16_t y; \
+	UV2RGB_16_NEON(U, V, r_uv, g_uv, b_uv) \
+	YUV2RGB_LINE_16_NEON(y_ptr1, 1, SAVE) \
+	YUV2RGB_LINE_16_NEON(y_ptr2, 2, SAVE) \
+
+#define YUV2RGB_16_NEON_PLANAR(SAVE) \
+	YUV2RGB_16_NEON(vld1_u8(u_ptr), vld1_u8(v_ptr), SAVE)
+
+#define YUV2RGB_16_NEON_NV12(SAVE) \
+	const uint8x8x2_t uv = vld2_u8(uv_ptr); \
+	YUV2RGB_16_NEON(uv.val[0], uv.val[1], SAVE)
+
+#define YUV2RGB_16_NEON_NV21(SAVE) \
+	const uint8x8x2_t uv = vld2_u8(uv_ptr); \
+	YUV2RGB_16_NEON(uv.val[1], uv.val[0], SAVE)
+
+// YUV420_RGB_NEON_FUNCTION(FORMAT, BPP, SAVE) defines yuv420_<FORMAT>_neon
+#define YUV420_RGB_NEON_FUNCTION(FORMAT, BPP, SAVE) \
+void yuv420_##FORMAT##_neon( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *Y, const uint8_t *U, const uint8_t *V, uint32_t Y_stride, uint32_t UV_stride, \
+	uint8_t *RGB, uint32_t RGB_stride, \
+	YCbCrType yuv_type) \
+{ \
+	KERNEL_PARAM(YUV2RGBParam, YUV2RGB) \
+	\
+	uint32_t x, y; \
+	for(y=0; (y+1)<height; y+=2) \
+	{ \
+		const uint8_t *y_ptr1=Y+y*Y_stride, \
+			*y_ptr2=Y+(y+1)*Y_stride, \
+			*u_ptr=U+(y/2)*UV_stride, \
+			*v_ptr=V+(y/2)*UV_stride; \
+		\
+		uint8_t *rgb_ptr1=RGB+y*RGB_stride, \
+			*rgb_ptr2=RGB+(y+1)*RGB_stride; \
+		\
+		for(x=0; (x+15)<width; x+=16) \
+		{ \
+			YUV2RGB_16_NEON_PLANAR(SAVE) \
+			\
+			y_ptr1+=16; \
+			y_ptr2+=16; \
+			u_ptr+=8; \
+			v_ptr+=8; \
+			rgb_ptr1+=16*BPP; \
+			rgb_ptr2+=16*BPP; \
+		} \
+	} \
+	YUV420_RGB_TAIL(16, BPP, yuv420_##FORMAT##_neon, yuv420_##FORMAT##_std) \
+}
+
+// NV12_RGB_NEON_FUNCTION(NAME, NV_FORMAT, FORMAT, BPP, SAVE) defines <NAME>_<FORMAT>_neon, for NAME nv12 or nv21 and
+// NV_FORMAT the matching uv load (NV12 or NV21)
+#define NV12_RGB_NEON_FUNCTION(NAME, NV_FORMAT, FORMAT, BPP, SAVE) \
+void NAME##_##FORMAT##_neon( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *Y, const uint8_t *UV, uint32_t Y_stride, uint32_t UV_stride, \
+	uint8_t *RGB, uint32_t RGB_stride, \
+	YCbCrType yuv_type) \
+{ \
+	KERNEL_PARAM(YUV2RGBParam, YUV2RGB) \
+	\
+	uint32_t x, y; \
+	for(y=0; (y+1)<height; y+=2) \
+	{ \
+		const uint8_t *y_ptr1=Y+y*Y_stride, \
+			*y_ptr2=Y+(y+1)*Y_stride, \
+			*uv_ptr=UV+(y/2)*UV_stride; \
+		\
+		uint8_t *rgb_ptr1=RGB+y*RGB_stride, \
+			*rgb_ptr2=RGB+(y+1)*RGB_stride; \
+		\
+		for(x=0; (x+15)<width; x+=16) \
+		{ \
+			YUV2RGB_16_NEON_##NV_FORMAT(SAVE) \
+			\
+			y_ptr1+=16; \
+			y_ptr2+=16; \
+			uv_ptr+=16; \
+			rgb_ptr1+=16*BPP; \
+			rgb_ptr2+=16*BPP; \
+		} \
+	} \
+	NV12_RGB_TAIL(16, BPP, NAME##_##FORMAT##_neon, NAME##_##FORMAT##_std) \
+}
+
+#define YUV2RGB_NEON_FUNCTIONS(FORMAT, BPP, SAVE) \
+	YUV420_RGB_NEON_FUNCTION(FORMAT, BPP, SAVE) \
+	NV12_RGB_NEON_FUNCTION(nv12, NV12, FORMAT, BPP, SAVE) \
+	NV12_RGB_NEON_FUNCTION(nv21, NV21, FORMAT, BPP, SAVE)
+
+YUV2RGB_NEON_FUNCTIONS(rgb24, 3, SAVE_RGB24_16_NEON)
+YUV2RGB_NEON_FUNCTIONS(rgb32, 4, SAVE_RGB32_16_NEON)
+YUV2RGB_NEON_FUNCTIONS(bgra, 4, SAVE_BGRA_16_NEON)
+YUV2RGB_NEON_FUNCTIONS(argb, 4, SAVE_ARGB_16_NEON)
+YUV2RGB_NEON_FUNCTIONS(bgr24, 3, SAVE_BGR24_16_NEON)
+YUV2RGB_NEON_FUNCTIONS(rgb565, 2, SAVE_RGB565_16_NEON)
+
+// normalization parameters used by the save macros of the float formats
+#define PLANAR_NORM_NEON_rgb_planar
+#define PLANAR_NORM_NEON_rgb_planar_f32 \
+	const float32x4_t r_mean = vdupq_n_f32(norm->mean[0]), g_mean = vdupq_n_f32(norm->mean[1]), b_mean = vdupq_n_f32(norm->mean[2]), \
+		r_scale = vdupq_n_f32(norm->scale[0]), g_scale = vdupq_n_f32(norm->scale[1]), b_scale = vdupq_n_f32(norm->scale[2]);
+#define PLANAR_NORM_NEON_rgb_planar_f16 PLANAR_NORM_NEON_rgb_planar_f32
+
+// YUV420_RGB_PLANAR_NEON_FUNCTION(FORMAT, TYPE, SAVE) defines yuv420_<FORMAT>_neon for a planar FORMAT, of which
+// planes have elements of type TYPE
+#define YUV420_RGB_PLANAR_NEON_FUNCTION(FORMAT, TYPE, SAVE) \
+void yuv420_##FORMAT##_neon( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *Y, const uint8_t *U, const uint8_t *V, uint32_t Y_stride, uint32_t UV_stride, \
+	TYPE *R, TYPE *G, TYPE *B, uint32_t RGB_stride, PLANAR_NORM_PARAM_##FORMAT \
+	YCbCrType yuv_type) \
+{ \
+	KERNEL_PARAM(YUV2RGBParam, YUV2RGB) \
+	PLANAR_NORM_NEON_##FORMAT \
+	\
+	uint32_t x, y; \
+	for(y=0; (y+1)<height; y+=2) \
+	{ \
+		const uint8_t *y_ptr1=Y+y*Y_stride, \
+			*y_ptr2=Y+(y+1)*Y_stride, \
+			*u_ptr=U+(y/2)*UV_stride, \
+			*v_ptr=V+(y/2)*UV_stride; \
+		\
+		PLANAR_RGB_LINES(TYPE, y, y+1) \
+		\
+		for(x=0; (x+15)<width; x+=16) \
+		{ \
+			YUV2RGB_16_NEON_PLANAR(SAVE) \
+			\
+			y_ptr1+=16; \
+			y_ptr2+=16; \
+			u_ptr+=8; \
+			v_ptr+=8; \
+			PLANAR_RGB_ADVANCE(16) \
+		} \
+	} \
+	YUV420_RGB_PLANAR_TAIL(16, PLANAR_NORM_ARG_##FORMAT, yuv420_##FORMAT##_neon, yuv420_##FORMAT##_std) \
+}
+
+#define NV12_RGB_PLANAR_NEON_FUNCTION(NAME, NV_FORMAT, FORMAT, TYPE, SAVE) \
+void NAME##_##FORMAT##_neon( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *Y, const uint8_t *UV, uint32_t Y_stride, uint32_t UV_stride, \
+	TYPE *R, TYPE *G, TYPE *B, uint32_t RGB_stride, PLANAR_NORM_PARAM_##FORMAT \
+	YCbCrType yuv_type) \
+{ \
+	KERNEL_PARAM(YUV2RGBParam, YUV2RGB) \
+	PLANAR_NORM_NEON_##FORMAT \
+	\
+	uint32_t x, y; \
+	for(y=0; (y+1)<height; y+=2) \
+	{ \
+		const uint8_t *y_ptr1=Y+y*Y_stride, \
+			*y_ptr2=Y+(y+1)*Y_stride, \
+			*uv_ptr=UV+(y/2)*UV_stride; \
+		\
+		PLANAR_RGB_LINES(TYPE, y, y+1) \
+		\
+		for(x=0; (x+15)<width; x+=16) \
+		{ \
+			YUV2RGB_16_NEON_##NV_FORMAT(SAVE) \
+			\
+			y_ptr1+=16; \
+			y_ptr2+=16; \
+			uv_ptr+=16; \
+			PLANAR_RGB_ADVANCE(16) \
+		} \
+	} \
+	NV12_RGB_PLANAR_TAIL(16, PLANAR_NORM_ARG_##FORMAT, NAME##_##FORMAT##_neon, NAME##_##FORMAT##_std) \
+}
+
+#define YUV2RGB_PLANAR_NEON_FUNCTIONS(FORMAT, TYPE, SAVE) \
+	YUV420_RGB_PLANAR_NEON_FUNCTION(FORMAT, TYPE, SAVE) \
+	NV12_RGB_PLANAR_NEON_FUNCTION(nv12, NV12, FORMAT, TYPE, SAVE) \
+	NV12_RGB_PLANAR_NEON_FUNCTION(nv21, NV21, FORMAT, TYPE, SAVE)
+
+YUV2RGB_PLANAR_NEON_FUNCTIONS(rgb_planar, uint8_t, SAVE_RGB_PLANAR_16_NEON)
+YUV2RGB_PLANAR_NEON_FUNCTIONS(rgb_planar_f32, float, SAVE_RGB_PLANAR_F32_16_NEON)
+YUV2RGB_PLANAR_NEON_FUNCTIONS(rgb_planar_f16, uint16_t, SAVE_RGB_PLANAR_F16_16_NEON)
+
+// High bit depth input, see yuv420p10_rgb24_std in yuv_rgb.c
+// The 32 bits y and chroma terms are computed with widening multiplications of 15 bits values, as in the sse version.
+
+// 16 bits value of 8 samples
+#define SAMPLE16_YUV420P10_NEON(S) vshlq_n_u16(S, 6)
+#define SAMPLE16_P010_NEON(S) (S)
+
+// 15 bits centered chroma values of 8 samples
+#define CHROMA15_NEON(S) vsubq_s16(vreinterpretq_s16_u16(vshrq_n_u16(S, 1)), vdupq_n_s16(16384))
+
+// compute the chroma terms of 4 chroma samples, with the rounding of the rgb values, each of them duplicated for two
+// adjacent pixels
+#define UV2RGB16_8_NEON(U_4, V_4, BITS, R, G, B) \
+	r_tmp = vmlal_n_s16(vdupq_n_s32(RGB16_ROUND(BITS)), V_4, param->cr_factor); \
+	g_tmp = vmlsl_n_s16(vmlsl_n_s16(vdupq_n_s32(RGB16_ROUND(BITS)), U_4, param->g_cb_factor), V_4, param->g_cr_factor); \
+	b_tmp = vmlal_n_s16(vdupq_n_s32(RGB16_ROUND(BITS)), U_4, param->cb_factor); \
+	R = vzipq_s32(r_tmp, r_tmp); \
+	G = vzipq_s32(g_tmp, g_tmp); \
+	B = vzipq_s32(b_tmp, b_tmp);
+
+// clamp 8 16 bits values to the output precision (8 bits values are clamped by vqmovn_u16 when saved)
+#define CLAMP_RGB16_8_NEON(C) (C)
+#define CLAMP_RGB16_10_NEON(C) vminq_u16(C, vdupq_n_u16(RGB16_MAX(10)))
+#define CLAMP_RGB16_16_NEON(C) (C)
+
+// add the y terms of 4 pixels to their chroma terms, and round them to BITS bits
+#define RGB16_4_NEON(Y_32, UV_32, BITS) vqmovun_s32(vshrq_n_s32(vaddq_s32(Y_32, UV_32), RGB16_SHIFT(BITS)))
+
+// convert 8 pixels of 16 bits y values Y, with the chroma terms of index I
+#define Y2RGB16_8_NEON(Y, I, BITS, R, G, B) \
+	y_15 = vreinterpretq_s16_u16(vshrq_n_u16(vqsubq_u16(Y, vdupq_n_u16(param->y_offset)), 1)); \
+	y_lo = vmull_n_s16(vget_low_s16(y_15), param->y_factor); \
+	y_hi = vmull_n_s16(vget_high_s16(y_15), param->y_factor); \
+	R = CLAMP_RGB16_##BITS##_NEON(vcombine_u16(RGB16_4_NEON(y_lo, r_uv_##I.val[0], BITS), \
+		RGB16_4_NEON(y_hi, r_uv_##I.val[1], BITS))); \
+	G = CLAMP_RGB16_##BITS##_NEON(vcombine_u16(RGB16_4_NEON(y_lo, g_uv_##I.val[0], BITS), \
+		RGB16_4_NEON(y_hi, g_uv_##I.val[1], BITS))); \
+	B = CLAMP_RGB16_##BITS##_NEON(vcombine_u16(RGB16_4_NEON(y_lo, b_uv_##I.val[0], BITS), \
+		RGB16_4_NEON(y_hi, b_uv_##I.val[1], BITS)));
+
+#define YUV2RGB16_LINE_16_NEON(Y_PTR, INPUT, BITS, LINE, SAVE) \
+	Y2RGB16_8_NEON(SAMPLE16_##INPUT##_NEON(vld1q_u16(Y_PTR)), 1, BITS, r_16_1, g_16_1, b_16_1) \
+	Y2RGB16_8_NEON(SAMPLE16_##INPUT##_NEON(vld1q_u16((Y_PTR)+8)), 2, BITS, r_16_2, g_16_2, b_16_2) \
+	SAVE(r_16_1, r_16_2, g_16_1, g_16_2, b_16_1, b_16_2, LINE)
+
+// convert 16 pixels of the two lines of a pair, from 8 16 bits u and v values
+#define YUV2RGB16_16_NEON(U, V, INPUT, BITS, SAVE) \
+	int32x4_t r_tmp, g_tmp, b_tmp, y_lo, y_hi; \
+	int32x4x2_t r_uv_1, g_uv_1, b_uv_1, r_uv_2, g_uv_2, b_uv_2; \
+	int16x8_t y_15; \
+	uint16x8_t r_16_1, g_16_1, b_16_1, r_16_2, g_16_2, b_16_2; \
+	const int16x8_t u_15 = CHROMA15_NEON(U), v_15 = CHROMA15_NEON(V); \
+	UV2RGB16_8_NEON(vget_low_s16(u_15), vget_low_s16(v_15), BITS, r_uv_1, g_uv_1, b_uv_1) \
+	UV2RGB16_8_NEON(vget_high_s16(u_15), vget_high_s16(v_15), BITS, r_uv_2, g_uv_2, b_uv_2) \
+	YUV2RGB16_LINE_16_NEON(y_ptr1, INPUT, BITS, 1, SAVE) \
+	YUV2RGB16_LINE_16_NEON(y_ptr2, INPUT, BITS, 2, SAVE)
+
+#define YUV2RGB16_16_NEON_YUV420P10(BITS, SAVE) \
+	YUV2RGB16_16_NEON(SAMPLE16_YUV420P10_NEON(vld1q_u16(u_ptr)), SAMPLE16_YUV420P10_NEON(vld1q_u16(v_ptr)), \
+		YUV420P10, BITS, SAVE)
+
+#define YUV2RGB16_16_NEON_P010(BITS, SAVE) \
+	const uint16x8x2_t uv = vld2q_u16(uv_ptr); \
+	YUV2RGB16_16_NEON(uv.val[0], uv.val[1], P010, BITS, SAVE)
+
+// The SAVE16_<FORMAT>_16_NEON macros save the 16 pixels of the line LINE (1 or 2) of a pair, given as 16 bits r, g and
+// b values at the precision of FORMAT, in two registers each
+#define SAVE16_RGB24_16_NEON(R1, R2, G1, G2, B1, B2, LINE) \
+	SAVE_3CHANNELS_16_NEON(vcombine_u8(vqmovn_u16(R1), vqmovn_u16(R2)), vcombine_u8(vqmovn_u16(G1), vqmovn_u16(G2)), \
+		vcombine_u8(vqmovn_u16(B1), vqmovn_u16(B2)), rgb_ptr##LINE)
+
+#define SAVE_RGB48_8_NEON(R, G, B, PTR) \
+	{ \
+		uint16x8x3_t rgb; \
+		rgb.val[0] = R; \
+		rgb.val[1] = G; \
+		rgb.val[2] = B; \
+		vst3q_u16((uint16_t*)(void*)(PTR), rgb); \
+	}
+
+#define SAVE16_RGB48_16_NEON(R1, R2, G1, G2, B1, B2, LINE) \
+	SAVE_RGB48_8_NEON(R1, G1, B1, rgb_ptr##LINE) \
+	SAVE_RGB48_8_NEON(R2, G2, B2, rgb_ptr##LINE+48)
+
+// save 8 pixels as 32 bits values, from their low (b and the low bits of g) and high 16 bits
+#define SAVE_X2RGB10_8_NEON(R, G, B, PTR) \
+	{ \
+		uint16x8x2_t rgb; \
+		rgb.val[0] = vorrq_u16(B, vshlq_n_u16(G, 10)); \
+		rgb.val[1] = vorrq_u16(vorrq_u16(vshrq_n_u16(G, 6), vshlq_n_u16(R, 4)), vdupq_n_u16(0xC000)); \
+		vst2q_u16((uint16_t*)(void*)(PTR), rgb); \
+	}
+
+#define SAVE16_X2RGB10_16_NEON(R1, R2, G1, G2, B1, B2, LINE) \
+	SAVE_X2RGB10_8_NEON(R1, G1, B1, rgb_ptr##LINE) \
+	SAVE_X2RGB10_8_NEON(R2, G2, B2, rgb_ptr##LINE+32)
+
+// YUV420P10_RGB_NEON_FUNCTION(FORMAT, BPP, BITS, SAVE) defines yuv420p10_<FORMAT>_neon, BITS being the precision of the
+// rgb values of FORMAT
+#define YUV420P10_RGB_NEON_FUNCTION(FORMAT, BPP, BITS, SAVE) \
+void yuv420p10_##FORMAT##_neon( \
+	uint32_t width, uint32_t height, \
+	const uint16_t *Y, const uint16_t *U, const uint16_t *V, uint32_t Y_stride, uint32_t UV_stride, \
+	uint8_t *RGB, uint32_t RGB_stride, \
+	YCbCrType yuv_type) \
+{ \
+	KERNEL_PARAM(YUV2RGB16Param, YUV2RGB16_##BITS) \
+	\
+	uint32_t x, y; \
+	for(y=0; (y+1)<height; y+=2) \
+	{ \
+		const uint16_t *y_ptr1=BYTE_OFFSET(Y, y*Y_stride), \
+			*y_ptr2=BYTE_OFFSET(Y, (y+1)*Y_stride), \
+			*u_ptr=BYTE_OFFSET(U, (y/2)*UV_stride), \
+			*v_ptr=BYTE_OFFSET(V, (y/2)*UV_stride); \
+		\
+		uint8_t *rgb_ptr1=RGB+y*RGB_stride, \
+			*rgb_ptr2=RGB+(y+1)*RGB_stride; \
+		\
+		for(x=0; (x+15)<width; x+=16) \
+		{ \
+			YUV2RGB16_16_NEON_YUV420P10(BITS, SAVE) \
+			\
+			y_ptr1+=16; \
+			y_ptr2+=16; \
+			u_ptr+=8; \
+			v_ptr+=8; \
+			rgb_ptr1+=16*BPP; \
+			rgb_ptr2+=16*BPP; \
+		} \
+	} \
+	YUV420_RGB_TAIL(16, BPP, yuv420p10_##FORMAT##_neon, yuv420p10_##FORMAT##_std) \
+}
+
+#define P010_RGB_NEON_FUNCTION(FORMAT, BPP, BITS, SAVE) \
+void p010_##FORMAT##_neon( \
+	uint32_t width, uint32_t height, \
+	const uint16_t *Y, const uint16_t *UV, uint32_t Y_stride, uint32_t UV_stride, \
+	uint8_t *RGB, uint32_t RGB_stride, \
+	YCbCrType yuv_type) \
+{ \
+	KERNEL_PARAM(YUV2RGB16Param, YUV2RGB16_##BITS) \
+	\
+	uint32_t x, y; \
+	for(y=0; (y+1)<height; y+=2) \
+	{ \
+		const uint16_t *y_ptr1=BYTE_OFFSET(Y, y*Y_stride), \
+			*y_ptr2=BYTE_OFFSET(Y, (y+1)*Y_stride), \
+			*uv_ptr=BYTE_OFFSET(UV, (y/2)*UV_stride); \
+		\
+		uint8_t *rgb_ptr1=RGB+y*RGB_stride, \
+			*rgb_ptr2=RGB+(y+1)*RGB_stride; \
+		\
+		for(x=0; (x+15)<width; x+=16) \
+		{ \
+			YUV2RGB16_16_NEON_P010(BITS, SAVE) \
+			\
+			y_ptr1+=16; \
+			y_ptr2+=16; \
+			uv_ptr+=16; \
+			rgb_ptr1+=16*BPP; \
+			rgb_ptr2+=16*BPP; \
+		} \
+	} \
+	NV12_RGB_TAIL(16, BPP, p010_##FORMAT##_neon, p010_##FORMAT##_std) \
+}
+
+#define YUV2RGB16_NEON_FUNCTIONS(FORMAT, BPP, BITS, SAVE) \
+	YUV420P10_RGB_NEON_FUNCTION(FORMAT, BPP, BITS, SAVE) \
+	P010_RGB_NEON_FUNCTION(FORMAT, BPP, BITS, SAVE)
+
+YUV2RGB16_NEON_FUNCTIONS(rgb24, 3, 8, SAVE16_RGB24_16_NEON)
+YUV2RGB16_NEON_FUNCTIONS(rgb48, 6, 16, SAVE16_RGB48_16_NEON)
+YUV2RGB16_NEON_FUNCTIONS(x2rgb10, 4, 10, SAVE16_X2RGB10_16_NEON)
+
+// yuva to rgba (see yuva420_rgb32_std in yuv_rgb.c), the alpha values being loaded from the line pointers a_ptr1
+// and a_ptr2
+// premultiply 8 colors by their alpha values, (t+(t>>8))>>8 with t=c*a+128 (see PREMULTIPLY_STD)
+#define PREMULTIPLY_8_NEON(C_8, A_8) \
+	vshrn_n_u16(vsraq_n_u16(vaddq_u16(vmull_u8(C_8, A_8), vdupq_n_u16(128)), \
+		vaddq_u16(vmull_u8(C_8, A_8), vdupq_n_u16(128)), 8), 8)
+#define PREMULTIPLY_16_NEON(C, A) \
+	vcombine_u8(PREMULTIPLY_8_NEON(vget_low_u8(C), vget_low_u8(A)), PREMULTIPLY_8_NEON(vget_high_u8(C), vget_high_u8(A)))
+
+#define SAVE_RGBA_YUVA_16_NEON(R, G, B, LINE) SAVE_4CHANNELS_16_NEON(R, G, B, vld1q_u8(a_ptr##LINE), rgb_ptr##LINE)
+#define SAVE_BGRA_PREMULTIPLIED_YUVA_16_NEON(R, G, B, LINE) \
+	{ \
+		const uint8x16_t a = vld1q_u8(a_ptr##LINE); \
+		SAVE_4CHANNELS_16_NEON(PREMULTIPLY_16_NEON(B, a), PREMULTIPLY_16_NEON(G, a), PREMULTIPLY_16_NEON(R, a), a, \
+			rgb_ptr##LINE) \
+	}
+
+// YUVA420_RGB_NEON_FUNCTION(FORMAT, SAVE) defines yuva420_<FORMAT>_neon
+#define YUVA420_RGB_NEON_FUNCTION(FORMAT, SAVE) \
+void yuva420_##FORMAT##_neon( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *Y, const uint8_t *U, const uint8_t *V, const uint8_t *A, uint32_t Y_stride, uint32_t UV_stride, \
+	uint8_t *RGB, uint32_t RGB_stride, \
+	YCbCrType yuv_type) \
+{ \
+	KERNEL_PARAM(YUV2RGBParam, YUV2RGB) \
+	\
+	uint32_t x, y; \
+	for(y=0; (y+1)<height; y+=2) \
+	{ \
+		const uint8_t *y_ptr1=Y+y*Y_stride, \
+			*y_ptr2=Y+(y+1)*Y_stride, \
+			*a_ptr1=A+y*Y_stride, \
+			*a_ptr2=A+(y+1)*Y_stride, \
+			*u_ptr=U+(y/2)*UV_stride, \
+			*v_ptr=V+(y/2)*UV_stride; \
+		\
+		uint8_t *rgb_ptr1=RGB+y*RGB_stride, \
+			*rgb_ptr2=RGB+(y+1)*RGB_stride; \
+		\
+		for(x=0; (x+15)<width; x+=16) \
+		{ \
+			YUV2RGB_16_NEON_PLANAR(SAVE) \
+			\
+			y_ptr1+=16; \
+			y_ptr2+=16; \
+			a_ptr1+=16; \
+			a_ptr2+=16; \
+			u_ptr+=8; \
+			v_ptr+=8; \
+			rgb_ptr1+=64; \
+			rgb_ptr2+=64; \
+		} \
+	} \
+	YUVA420_RGB_TAIL(16, yuva420_##FORMAT##_neon, yuva420_##FORMAT##_std) \
+}
+
+YUVA420_RGB_NEON_FUNCTION(rgb32, SAVE_RGBA_YUVA_16_NEON)
+YUVA420_RGB_NEON_FUNCTION(bgra_premultiplied, SAVE_BGRA_PREMULTIPLIED_YUVA_16_NEON)
+
+
+// compute Y' of 8 pixels
+#define RGB2Y_8_NEON(R_8, G_8, B_8, Y_16) \
+	Y_16 = vmull_u8(R_8, vdup_n_u8(param->r_factor)); \
+	Y_16 = vmlal_u8(Y_16, G_8, vdup_n_u8(param->g_factor)); \
+	Y_16 = vmlal_u8(Y_16, B_8, vdup_n_u8(param->b_factor)); \
+	Y_16 = vshrq_n_u16(Y_16, 8); \
+
+// compute and save Y of one line of 16 pixels, and add the sums of (B-Y') and (R-Y') of pairs of adjacent
+// pixels to the CB_16 and CR_16 sums
+#define RGB2YUV_LINE_16_NEON(R_8, G_8, B_8, Y_PTR, CB_16, CR_16) \
+	RGB2Y_8_NEON(vget_low_u8(R_8), vget_low_u8(G_8), vget_low_u8(B_8), y1_16) \
+	RGB2Y_8_NEON(vget_high_u8(R_8), vget_high_u8(G_8), vget_high_u8(B_8), y2_16) \
+	CB_16 = vaddq_s16(CB_16, vpaddq_s16( \
+		vreinterpretq_s16_u16(vsubq_u16(vmovl_u8(vget_low_u8(B_8)), y1_16)), \
+		vreinterpretq_s16_u16(vsubq_u16(vmovl_u8(vget_high_u8(B_8)), y2_16)))); \
+	CR_16 = vaddq_s16(CR_16, vpaddq_s16( \
+		vreinterpretq_s16_u16(vsubq_u16(vmovl_u8(vget_low_u8(R_8)), y1_16)), \
+		vreinterpretq_s16_u16(vsubq_u16(vmovl_u8(vget_high_u8(R_8)), y2_16)))); \
+	/* Rescale Y' to Y, pack it to 8bit values and save it */ \
+	y1_16 = vaddq_u16(vshrq_n_u16(vmulq_n_u16(y1_16, param->y_factor), 7), vdupq_n_u16(param->y_offset)); \
+	y2_16 = vaddq_u16(vshrq_n_u16(vmulq_n_u16(y2_16, param->y_factor), 7), vdupq_n_u16(param->y_offset)); \
+	vst1q_u8(Y_PTR, vcombine_u8(vqmovn_u16(y1_16), vqmovn_u16(y2_16))); \
+
+// from the r, g and b channels of two lines of 16 pixels, save Y, and the 8 Cb and Cr values
+#define RGB2YUV_16_NEON(R1, G1, B1, R2, G2, B2) \
+	uint16x8_t y1_16, y2_16; \
+	int16x8_t cb_16 = vdupq_n_s16(0), cr_16 = vdupq_n_s16(0); \
+	RGB2YUV_LINE_16_NEON(R1, G1, B1, y_ptr1, cb_16, cr_16) \
+	RGB2YUV_LINE_16_NEON(R2, G2, B2, y_ptr2, cb_16, cr_16) \
+	/* Rescale Cb and Cr to their final range */ \
+	cb_16 = vaddq_s16(vshrq_n_s16(vmulq_n_s16(vshrq_n_s16(cb_16, 2), param->cb_factor), 8), vdupq_n_s16(128)); \
+	cr_16 = vaddq_s16(vshrq_n_s16(vmulq_n_s16(vshrq_n_s16(cr_16, 2), param->cr_factor), 8), vdupq_n_s16(128)); \
+	vst1_u8(u_ptr, vqmovun_s16(cb_16)); \
+	vst1_u8(v_ptr, vqmovun_s16(cr_16)); \
+
+#define RGB2YUV_16_NEON_RGB24 \
+	const uint8x16x3_t rgb1 = vld3q_u8(rgb_ptr1), rgb2 = vld3q_u8(rgb_ptr2); \
+	RGB2YUV_16_NEON(rgb1.val[0], rgb1.val[1], rgb1.val[2], rgb2.val[0], rgb2.val[1], rgb2.val[2])
+
+#define RGB2YUV_16_NEON_RGBA \
+	const uint8x16x4_t rgb1 = vld4q_u8(rgb_ptr1), rgb2 = vld4q_u8(rgb_ptr2); \
+	RGB2YUV_16_NEON(rgb1.val[0], rgb1.val[1], rgb1.val[2], rgb2.val[0], rgb2.val[1], rgb2.val[2])
+
+
+void rgb24_yuv420_neon(uint32_t width, uint32_t height,
+	const uint8_t *RGB, uint32_t RGB_stride,
+	uint8_t *Y, uint8_t *U, uint8_t *V, uint32_t Y_stride, uint32_t UV_stride,
+	YCbCrType yuv_type)
+{
+	KERNEL_PARAM(RGB2YUVParam, RGB2YUV)
+
+	uint32_t x, y;
+	for(y=0; (y+1)<height; y+=2)
+	{
+		const uint8_t *rgb_ptr1=RGB+y*RGB_stride,
+			*rgb_ptr2=RGB+(y+1)*RGB_stride;
+
+		uint8_t *y_ptr1=Y+y*Y_stride,
+			*y_ptr2=Y+(y+1)*Y_stride,
+			*u_ptr=U+(y/2)*UV_stride,
+			*v_ptr=V+(y/2)*UV_stride;
+
+		for(x=0; (x+15)<width; x+=16)
+		{
+			RGB2YUV_16_NEON_RGB24
+
+			rgb_ptr1+=48;
+			rgb_ptr2+=48;
+			y_ptr1+=16;
+			y_ptr2+=16;
+			u_ptr+=8;
+			v_ptr+=8;
+		}
+	}
+	RGB_YUV420_TAIL(16, 3, RGB, RGB_stride, rgb24_yuv420_neon, rgb24_yuv420_std)
+}
+
+void rgb32_yuv420_neon(uint32_t width, uint32_t height,
+	const uint8_t *RGBA, uint32_t RGBA_stride,
+	uint8_t *Y, uint8_t *U, uint8_t *V, uint32_t Y_stride, uint32_t UV_stride,
+	YCbCrType yuv_type)
+{
+	KERNEL_PARAM(RGB2YUVParam, RGB2YUV)
+
+	uint32_t x, y;
+	for(y=0; (y+1)<height; y+=2)
+	{
+		const uint8_t *rgb_ptr1=RGBA+y*RGBA_stride,
+			*rgb_ptr2=RGBA+(y+1)*RGBA_stride;
+
+		uint8_t *y_ptr1=Y+y*Y_stride,
+			*y_ptr2=Y+(y+1)*Y_stride,
+			*u_ptr=U+(y/2)*UV_stride,
+			*v_ptr=V+(y/2)*UV_stride;
+
+		for(x=0; (x+15)<width; x+=16)
+		{
+			RGB2YUV_16_NEON_RGBA
+
+			rgb_ptr1+=64;
+			rgb_ptr2+=64;
+			y_ptr1+=16;
+			y_ptr2+=16;
+			u_ptr+=8;
+			v_ptr+=8;
+		}
+	}
+	RGB_YUV420_TAIL(16, 4, RGBA, RGBA_stride, rgb32_yuv420_neon, rgb32_yuv420_std)
+}
+
+// rgba to yuva (see rgb32_yuva420_std in yuv_rgb.c)
+// un-premultiply 16 colors C by their alpha values A, with a single precision division of 510*c+a by 2*a
+#define UNPREMULTIPLY_4_NEON(N_32, A_32) \
+	vcvtq_u32_f32(vdivq_f32(vcvtq_f32_u32(vaddq_u32(vshlq_n_u32(N_32, 1), A_32)), vcvtq_f32_u32(vshlq_n_u32(A_32, 1))))
+
+#define UNPREMULTIPLY_8_NEON(C_8, A_8) \
+	vmovn_u16(vbicq_u16(vminq_u16(vcombine_u16( \
+		vqmovn_u32(UNPREMULTIPLY_4_NEON(vmovl_u16(vget_low_u16(vmull_u8(C_8, vdup_n_u8(255)))), \
+			vmovl_u16(vget_low_u16(vmovl_u8(A_8))))), \
+		vqmovn_u32(UNPREMULTIPLY_4_NEON(vmovl_u16(vget_high_u16(vmull_u8(C_8, vdup_n_u8(255)))), \
+			vmovl_u16(vget_high_u16(vmovl_u8(A_8)))))), vdupq_n_u16(255)), vceqq_u16(vmovl_u8(A_8), vdupq_n_u16(0))))
+
+#define UNPREMULTIPLY_16_NEON(C, A) \
+	vcombine_u8(UNPREMULTIPLY_8_NEON(vget_low_u8(C), vget_low_u8(A)), UNPREMULTIPLY_8_NEON(vget_high_u8(C), vget_high_u8(A)))
+
+// the alpha line pointers are only offset when there is an alpha plane
+void rgb32_yuva420_neon(uint32_t width, uint32_t height,
+	const uint8_t *RGBA, uint32_t RGBA_stride,
+	uint8_t *Y, uint8_t *U, uint8_t *V, uint8_t *A, uint32_t Y_stride, uint32_t UV_stride,
+	int premultiplied, YCbCrType yuv_type)
+{
+	KERNEL_PARAM(RGB2YUVParam, RGB2YUV)
+
+	uint32_t x, y;
+	for(y=0; (y+1)<height; y+=2)
+	{
+		const uint8_t *rgb_ptr1=RGBA+y*RGBA_stride,
+			*rgb_ptr2=RGBA+(y+1)*RGBA_stride;
+
+		uint8_t *y_ptr1=Y+y*Y_stride,
+			*y_ptr2=Y+(y+1)*Y_stride,
+			*a_ptr1=ALPHA_OFFSET(y*Y_stride),
+			*a_ptr2=ALPHA_OFFSET((y+1)*Y_stride),
+			*u_ptr=U+(y/2)*UV_stride,
+			*v_ptr=V+(y/2)*UV_stride;
+
+		for(x=0; (x+15)<width; x+=16)
+		{
+			uint8x16x4_t rgb1 = vld4q_u8(rgb_ptr1), rgb2 = vld4q_u8(rgb_ptr2);
+			if(a_ptr1)
+			{
+				vst1q_u8(a_ptr1+x, rgb1.val[3]);
+				vst1q_u8(a_ptr2+x, rgb2.val[3]);
+			}
+			if(premultiplied)
+			{
+				rgb1.val[0] = UNPREMULTIPLY_16_NEON(rgb1.val[0], rgb1.val[3]);
+				rgb1.val[1] = UNPREMULTIPLY_16_NEON(rgb1.val[1], rgb1.val[3]);
+				rgb1.val[2] = UNPREMULTIPLY_16_NEON(rgb1.val[2], rgb1.val[3]);
+				rgb2.val[0] = UNPREMULTIPLY_16_NEON(rgb2.val[0], rgb2.val[3]);
+				rgb2.val[1] = UNPREMULTIPLY_16_NEON(rgb2.val[1], rgb2.val[3]);
+				rgb2.val[2] = UNPREMULTIPLY_16_NEON(rgb2.val[2], rgb2.val[3]);
+			}
+			{
+				RGB2YUV_16_NEON(rgb1.val[0], rgb1.val[1], rgb1.val[2], rgb2.val[0], rgb2.val[1], rgb2.val[2])
+			}
+
+			rgb_ptr1+=64;
+			rgb_ptr2+=64;
+			y_ptr1+=16;
+			y_ptr2+=16;
+			u_ptr+=8;
+			v_ptr+=8;
+		}
+	}
+	RGBA_YUVA420_TAIL(16, rgb32_yuva420_neon, rgb32_yuva420_std)
+}
+
+// Precise rgb to yuv (see RGB2YUV_PRECISE_PARAM in yuv_rgb.c), with 32 bits multiply accumulates
+
+// value C (y, cb or cr) of 4 pixels, from their 16 bits r, g and b values
+#define RGB2YUV_PRECISE_4_NEON(R, G, B, C, OFFSET, SHIFT) \
+	vqmovn_s32(vshrq_n_s32(vmlal_n_s16(vmlal_n_s16(vmlal_n_s16(OFFSET, R, param->C##_r), G, param->C##_g), \
+		B, param->C##_b), SHIFT))
+
+// value C of 8 pixels, as 16 bits values
+#define RGB2YUV_PRECISE_8_NEON(R, G, B, C, OFFSET, SHIFT) \
+	vcombine_s16( \
+		RGB2YUV_PRECISE_4_NEON(vget_low_s16(R), vget_low_s16(G), vget_low_s16(B), C, OFFSET, SHIFT), \
+		RGB2YUV_PRECISE_4_NEON(vget_high_s16(R), vget_high_s16(G), vget_high_s16(B), C, OFFSET, SHIFT))
+
+#define S16_U8_NEON(C_8) vreinterpretq_s16_u16(vmovl_u8(C_8))
+
+// y of 8 pixels, from their 8 bits r, g and b values
+#define RGB2YUV_PRECISE_Y_8_NEON(R_8, G_8, B_8) \
+	vqmovun_s16(RGB2YUV_PRECISE_8_NEON(S16_U8_NEON(R_8), S16_U8_NEON(G_8), S16_U8_NEON(B_8), y, y_offset, \
+		PRECISE_Y_SHIFT))
+
+// save y of one line of 16 pixels, and add the sums of the r, g and b values of pairs of adjacent pixels to the
+// r_sum, g_sum and b_sum sums
+#define RGB2YUV_PRECISE_LINE_16_NEON(R_8, G_8, B_8, Y_PTR) \
+	vst1q_u8(Y_PTR, vcombine_u8( \
+		RGB2YUV_PRECISE_Y_8_NEON(vget_low_u8(R_8), vget_low_u8(G_8), vget_low_u8(B_8)), \
+		RGB2YUV_PRECISE_Y_8_NEON(vget_high_u8(R_8), vget_high_u8(G_8), vget_high_u8(B_8)))); \
+	r_sum = vpadalq_u8(r_sum, R_8); \
+	g_sum = vpadalq_u8(g_sum, G_8); \
+	b_sum = vpadalq_u8(b_sum, B_8);
+
+// from the r, g and b channels of two lines of 16 pixels, save Y, and the 8 Cb and Cr values
+#define RGB2YUV_PRECISE_16_NEON(R1, G1, B1, R2, G2, B2) \
+	uint16x8_t r_sum = vdupq_n_u16(0), g_sum = vdupq_n_u16(0), b_sum = vdupq_n_u16(0); \
+	RGB2YUV_PRECISE_LINE_16_NEON(R1, G1, B1, y_ptr1) \
+	RGB2YUV_PRECISE_LINE_16_NEON(R2, G2, B2, y_ptr2) \
+	vst1_u8(u_ptr, vqmovun_s16(RGB2YUV_PRECISE_8_NEON(vreinterpretq_s16_u16(r_sum), vreinterpretq_s16_u16(g_sum), \
+		vreinterpretq_s16_u16(b_sum), cb, chroma_offset, PRECISE_CHROMA_SHIFT))); \
+	vst1_u8(v_ptr, vqmovun_s16(RGB2YUV_PRECISE_8_NEON(vreinterpretq_s16_u16(r_sum), vreinterpretq_s16_u16(g_sum), \
+		vreinterpretq_s16_u16(b_sum), cr, chroma_offset, PRECISE_CHROMA_SHIFT)));
+
+#define RGB2YUV_PRECISE_16_NEON_RGB24 \
+	const uint8x16x3_t rgb1 = vld3q_u8(rgb_ptr1), rgb2 = vld3q_u8(rgb_ptr2); \
+	RGB2YUV_PRECISE_16_NEON(rgb1.val[0], rgb1.val[1], rgb1.val[2], rgb2.val[0], rgb2.val[1], rgb2.val[2])
+
+#define RGB2YUV_PRECISE_16_NEON_RGBA \
+	const uint8x16x4_t rgb1 = vld4q_u8(rgb_ptr1), rgb2 = vld4q_u8(rgb_ptr2); \
+	RGB2YUV_PRECISE_16_NEON(rgb1.val[0], rgb1.val[1], rgb1.val[2], rgb2.val[0], rgb2.val[1], rgb2.val[2])
+
+#define RGB2YUV_PRECISE_NEON_FUNCTION(NAME, BPP, FORMAT) \
+void NAME##_yuv420_precise_neon(uint32_t width, uint32_t height, \
+	const uint8_t *RGB, uint32_t RGB_stride, \
+	uint8_t *Y, uint8_t *U, uint8_t *V, uint32_t Y_stride, uint32_t UV_stride, \
+	YCbCrType yuv_type) \
+{ \
+	KERNEL_PARAM(RGB2YUVPreciseParam, RGB2YUV_PRECISE) \
+	const int32x4_t y_offset = vdupq_n_s32(param->y_offset), chroma_offset = vdupq_n_s32(PRECISE_CHROMA_OFFSET); \
+	\
+	uint32_t x, y; \
+	for(y=0; (y+1)<height; y+=2) \
+	{ \
+		const uint8_t *rgb_ptr1=RGB+y*RGB_stride, \
+			*rgb_ptr2=RGB+(y+1)*RGB_stride; \
+		\
+		uint8_t *y_ptr1=Y+y*Y_stride, \
+			*y_ptr2=Y+(y+1)*Y_stride, \
+			*u_ptr=U+(y/2)*UV_stride, \
+			*v_ptr=V+(y/2)*UV_stride; \
+		\
+		for(x=0; (x+15)<width; x+=16) \
+		{ \
+			RGB2YUV_PRECISE_16_NEON_##FORMAT \
+			\
+			rgb_ptr1+=16*BPP; \
+			rgb_ptr2+=16*BPP; \
+			y_ptr1+=16; \
+			y_ptr2+=16; \
+			u_ptr+=8; \
+			v_ptr+=8; \
+		} \
+	} \
+	RGB_YUV420_TAIL(16, BPP, RGB, RGB_stride, NAME##_yuv420_precise_neon, NAME##_yuv420_precise_std) \
+}
+
+RGB2YUV_PRECISE_NEON_FUNCTION(rgb24, 3, RGB24)
+RGB2YUV_PRECISE_NEON_FUNCTION(rgb32, 4, RGBA)
+
+// Bilinear chroma interpolation, see yuv420_rgb24_bilinear_std in yuv_rgb.c
+// Each block converts 16 pixels of the two lines of a pair, with the same computations as the sse version: vertical
+// interpolation (3*nearest+other) of the chroma samples at columns -1, 0 and +1 relative to the block, and then
+// horizontal interpolation, the even pixels using the previous column and the odd pixels the next one.
+
+// load 8 u and v samples at chroma column X of the chroma lines C (nearest) and O (other), and interpolate them
+// vertically in U_16 and V_16
+#define LOAD_UV_BILINEAR_NEON_PLANAR(C, O, X, U_16, V_16) \
+	U_16 = vaddw_u8(vmull_u8(vld1_u8(u_##C+(X)), vdup_n_u8(3)), vld1_u8(u_##O+(X))); \
+	V_16 = vaddw_u8(vmull_u8(vld1_u8(v_##C+(X)), vdup_n_u8(3)), vld1_u8(v_##O+(X))); \
+
+#define LOAD_UV_BILINEAR_NEON_NV12(C, O, X, U_16, V_16) \
+	uv_c = vld2_u8(u_##C+2*(X)); \
+	uv_o = vld2_u8(u_##O+2*(X)); \
+	U_16 = vaddw_u8(vmull_u8(uv_c.val[0], vdup_n_u8(3)), uv_o.val[0]); \
+	V_16 = vaddw_u8(vmull_u8(uv_c.val[1], vdup_n_u8(3)), uv_o.val[1]); \
+
+#define LOAD_UV_BILINEAR_NEON_NV21(C, O, X, U_16, V_16) \
+	uv_c = vld2_u8(v_##C+2*(X)); \
+	uv_o = vld2_u8(v_##O+2*(X)); \
+	U_16 = vaddw_u8(vmull_u8(uv_c.val[1], vdup_n_u8(3)), uv_o.val[1]); \
+	V_16 = vaddw_u8(vmull_u8(uv_c.val[0], vdup_n_u8(3)), uv_o.val[0]); \
+
+// horizontal interpolation of 8 vertically interpolated samples Z, M and P being the previous and next samples,
+// giving the centered values of the 16 corresponding pixels in PIX
+#define BILINEAR_H_16_NEON(M, Z, P, PIX) \
+	PIX = vzipq_s16( \
+		vsubq_s16(vreinterpretq_s16_u16(vrshrq_n_u16(vmlaq_n_u16(M, Z, 3), 4)), vdupq_n_s16(128)), \
+		vsubq_s16(vreinterpretq_s16_u16(vrshrq_n_u16(vmlaq_n_u16(P, Z, 3), 4)), vdupq_n_s16(128))); \
+
+// compute the r, g and b offsets of 8 pixels from their centered u and v values
+#define UV2RGB_8_BILINEAR_NEON(U, V, I) \
+	r_uv.val[I] = vshrq_n_s16(vmulq_n_s16(V.val[I], param->cr_factor), 6); \
+	g_uv.val[I] = vshrq_n_s16(vaddq_s16( \
+		vmulq_n_s16(U.val[I], param->g_cb_factor), \
+		vmulq_n_s16(V.val[I], param->g_cr_factor)), 7); \
+	b_uv.val[I] = vshrq_n_s16(vmulq_n_s16(U.val[I], param->cb_factor), 6); \
+
+// convert the 16 pixels starting at column X of a line, from its nearest (C) and other (O) chroma lines
+#define BILINEAR_LINE_16_NEON(LOAD_UV, C, O, X, Y_PTR, RGB_PTR) \
+	LOAD_UV(C, O, (X)/2-1, um, vm) \
+	LOAD_UV(C, O, (X)/2, uz, vz) \
+	LOAD_UV(C, O, (X)/2+1, up, vp) \
+	BILINEAR_H_16_NEON(um, uz, up, u_pix) \
+	BILINEAR_H_16_NEON(vm, vz, vp, v_pix) \
+	UV2RGB_8_BILINEAR_NEON(u_pix, v_pix, 0) \
+	UV2RGB_8_BILINEAR_NEON(u_pix, v_pix, 1) \
+	YUV2RGB_LINE_16_NEON((Y_PTR)+(X), (RGB_PTR)+3*(X), SAVE_3CHANNELS_16_NEON) \
+
+#define BILINEAR_16_NEON(LOAD_UV, X) \
+	{ \
+		uint16x8_t um, uz, up, vm, vz, vp; \
+		int16x8x2_t u_pix, v_pix, r_uv, g_uv, b_uv; \
+		int16x8_t y_16, r_16_1, g_16_1, b_16_1, r_16_2, g_16_2, b_16_2; \
+		uint8x8x2_t uv_c, uv_o; \
+		uint8x16_t y; \
+		(void)uv_c; (void)uv_o; \
+		BILINEAR_LINE_16_NEON(LOAD_UV, c, p, X, y_ptr1, rgb_ptr1) \
+		BILINEAR_LINE_16_NEON(LOAD_UV, c, n, X, y_ptr2, rgb_ptr2) \
+	}
+
+#define BILINEAR_16_NEON_PLANAR(X) BILINEAR_16_NEON(LOAD_UV_BILINEAR_NEON_PLANAR, X)
+#define BILINEAR_16_NEON_NV12(X) BILINEAR_16_NEON(LOAD_UV_BILINEAR_NEON_NV12, X)
+#define BILINEAR_16_NEON_NV21(X) BILINEAR_16_NEON(LOAD_UV_BILINEAR_NEON_NV21, X)
+
+void yuv420_rgb24_bilinear_neon(
+	uint32_t width, uint32_t height,
+	const uint8_t *Y, const uint8_t *U, const uint8_t *V, uint32_t Y_stride, uint32_t UV_stride,
+	uint8_t *RGB, uint32_t RGB_stride,
+	YCbCrType yuv_type)
+{
+	YUV420_RGB_BILINEAR(16, U, V, 1, BILINEAR_16_NEON_PLANAR)
+}
+
+void nv12_rgb24_bilinear_neon(
+	uint32_t width, uint32_t height,
+	const uint8_t *Y, const uint8_t *UV, uint32_t Y_stride, uint32_t UV_stride,
+	uint8_t *RGB, uint32_t RGB_stride,
+	YCbCrType yuv_type)
+{
+	YUV420_RGB_BILINEAR(16, UV, UV+1, 2, BILINEAR_16_NEON_NV12)
+}
+
+void nv21_rgb24_bilinear_neon(
+	uint32_t width, uint32_t height,
+	const uint8_t *Y, const uint8_t *UV, uint32_t Y_stride, uint32_t UV_stride,
+	uint8_t *RGB, uint32_t RGB_stride,
+	YCbCrType yuv_type)
+{
+	YUV420_RGB_BILINEAR(16, UV+1, UV, 2, BILINEAR_16_NEON_NV21)
+}
+
+// 4:2:2 and 4:4:4 formats, see yuv422p_rgb24_std in yuv_rgb.c
+// Each block converts 16 pixels of a line. The packed formats are split in y and chroma values (or merged) with
+// vld2q_u8/vst2q_u8, and their pairs of u and v values with vuzp_u8/vzip_u8. The LOAD_YUV_<NAME>_16_NEON macros load
+// the y values in y_8 and the chroma values in u_8 and v_8 (8 values for 4:2:2, 16 for 4:4:4), and the
+// SAVE_YUV_<NAME>_16_NEON macros save the same variables.
+#define LOAD_YUV_yuv422p_16_NEON \
+	const uint8x16_t y_8 = vld1q_u8(y_ptr); \
+	const uint8x8_t u_8 = vld1_u8(u_ptr), v_8 = vld1_u8(v_ptr);
+
+#define LOAD_YUV_nv16_16_NEON \
+	const uint8x16_t y_8 = vld1q_u8(y_ptr); \
+	const uint8x8x2_t uv = vld2_u8(uv_ptr); \
+	const uint8x8_t u_8 = uv.val[0], v_8 = uv.val[1];
+
+// Y_INDEX and C_INDEX are the positions of the y and chroma values in the pairs of bytes of packed 4:2:2 data
+#define LOAD_YUV_PACKED_16_NEON(Y_INDEX, C_INDEX) \
+	const uint8x16x2_t yuv = vld2q_u8(yuv_ptr); \
+	const uint8x16_t y_8 = yuv.val[Y_INDEX]; \
+	const uint8x8x2_t uv = vuzp_u8(vget_low_u8(yuv.val[C_INDEX]), vget_high_u8(yuv.val[C_INDEX])); \
+	const uint8x8_t u_8 = uv.val[0], v_8 = uv.val[1];
+
+#define LOAD_YUV_yuyv_16_NEON LOAD_YUV_PACKED_16_NEON(0, 1)
+#define LOAD_YUV_uyvy_16_NEON LOAD_YUV_PACKED_16_NEON(1, 0)
+
+#define LOAD_YUV_yuv444p_16_NEON \
+	const uint8x16_t y_8 = vld1q_u8(y_ptr), u_8 = vld1q_u8(u_ptr), v_8 = vld1q_u8(v_ptr);
+
+#define LOAD_YUV_nv24_16_NEON \
+	const uint8x16_t y_8 = vld1q_u8(y_ptr); \
+	const uint8x16x2_t uv = vld2q_u8(uv_ptr); \
+	const uint8x16_t u_8 = uv.val[0], v_8 = uv.val[1];
+
+#define YUV2RGB_422_16_NEON(SAVE) \
+	int16x8_t u_16, v_16, r_tmp, g_tmp, b_tmp, y_16; \
+	int16x8_t r_16_1, g_16_1, b_16_1, r_16_2, g_16_2, b_16_2; \
+	int16x8x2_t r_uv, g_uv, b_uv; \
+	uint8x16_t y; \
+	UV2RGB_16_NEON(u_8, v_8, r_uv, g_uv, b_uv) \
+	YUV2RGB_Y_16_NEON(y_8, , SAVE)
+
+// centered values of 8 chroma values
+#define CHROMA_CENTER_8_NEON(C_8) vmovl_s8(vreinterpret_s8_u8(veor_u8(C_8, vdup_n_u8(128))))
+
+#define YUV2RGB_444_16_NEON(SAVE) \
+	int16x8_t y_16, r_16_1, g_16_1, b_16_1, r_16_2, g_16_2, b_16_2; \
+	int16x8x2_t u_pix, v_pix, r_uv, g_uv, b_uv; \
+	uint8x16_t y; \
+	u_pix.val[0] = CHROMA_CENTER_8_NEON(vget_low_u8(u_8)); \
+	u_pix.val[1] = CHROMA_CENTER_8_NEON(vget_high_u8(u_8)); \
+	v_pix.val[0] = CHROMA_CENTER_8_NEON(vget_low_u8(v_8)); \
+	v_pix.val[1] = CHROMA_CENTER_8_NEON(vget_high_u8(v_8)); \
+	UV2RGB_8_BILINEAR_NEON(u_pix, v_pix, 0) \
+	UV2RGB_8_BILINEAR_NEON(u_pix, v_pix, 1) \
+	YUV2RGB_Y_16_NEON(y_8, , SAVE)
+
+// YUV_RGB_LINES_NEON_FUNCTION(NAME, SUBSAMPLING, FORMAT, BPP, SAVE) defines <NAME>_<FORMAT>_neon, for the 4:2:2
+// (SUBSAMPLING 422) or 4:4:4 (444) format NAME
+#define YUV_RGB_LINES_NEON_FUNCTION(NAME, SUBSAMPLING, FORMAT, BPP, SAVE) \
+void NAME##_##FORMAT##_neon( \
+	uint32_t width, uint32_t height, \
+	YUV_PARAM_##NAME(const uint8_t), \
+	uint8_t *RGB, uint32_t RGB_stride, \
+	YCbCrType yuv_type) \
+{ \
+	KERNEL_PARAM(YUV2RGBParam, YUV2RGB) \
+	\
+	uint32_t x, y; \
+	for(y=0; y<height; ++y) \
+	{ \
+		YUV_LINE_##NAME(const uint8_t) \
+		uint8_t *rgb_ptr=RGB+y*RGB_stride; \
+		\
+		for(x=0; (x+15)<width; x+=16) \
+		{ \
+			LOAD_YUV_##NAME##_16_NEON \
+			YUV2RGB_##SUBSAMPLING##_16_NEON(SAVE) \
+			\
+			YUV_ADVANCE_##NAME(16) \
+			rgb_ptr+=16*BPP; \
+		} \
+	} \
+	YUV_RGB_LINES_TAIL(16, BPP, SUBSAMPLING, NAME, NAME##_##FORMAT##_neon, NAME##_##FORMAT##_std) \
+}
+
+// compute Y of a line of 16 pixels in y_8, and the (B-Y') and (R-Y') of its first (cb_1 and cr_1) and last 8 pixels
+#define RGB2YUV_LINE_CHROMA_16_NEON(R_8, G_8, B_8) \
+	uint16x8_t y1_16, y2_16; \
+	RGB2Y_8_NEON(vget_low_u8(R_8), vget_low_u8(G_8), vget_low_u8(B_8), y1_16) \
+	RGB2Y_8_NEON(vget_high_u8(R_8), vget_high_u8(G_8), vget_high_u8(B_8), y2_16) \
+	const int16x8_t cb_1 = vreinterpretq_s16_u16(vsubq_u16(vmovl_u8(vget_low_u8(B_8)), y1_16)), \
+		cb_2 = vreinterpretq_s16_u16(vsubq_u16(vmovl_u8(vget_high_u8(B_8)), y2_16)), \
+		cr_1 = vreinterpretq_s16_u16(vsubq_u16(vmovl_u8(vget_low_u8(R_8)), y1_16)), \
+		cr_2 = vreinterpretq_s16_u16(vsubq_u16(vmovl_u8(vget_high_u8(R_8)), y2_16)); \
+	y1_16 = vaddq_u16(vshrq_n_u16(vmulq_n_u16(y1_16, param->y_factor), 7), vdupq_n_u16(param->y_offset)); \
+	y2_16 = vaddq_u16(vshrq_n_u16(vmulq_n_u16(y2_16, param->y_factor), 7), vdupq_n_u16(param->y_offset)); \
+	const uint8x16_t y_8 = vcombine_u8(vqmovn_u16(y1_16), vqmovn_u16(y2_16));
+
+// chroma values of 8 (B-Y') or (R-Y') values C, FACTOR being cb_factor or cr_factor
+#define CHROMA_8_NEON(C, FACTOR) vqmovun_s16(vaddq_s16(vshrq_n_s16(vmulq_n_s16(C, param->FACTOR), 8), vdupq_n_s16(128)))
+
+// the 4:2:2 chroma values are computed from the pairwise sums of (B-Y') and (R-Y')
+#define RGB2YUV_422_16_NEON(R_8, G_8, B_8, SAVE) \
+	RGB2YUV_LINE_CHROMA_16_NEON(R_8, G_8, B_8) \
+	const uint8x8_t u_8 = CHROMA_8_NEON(vshrq_n_s16(vpaddq_s16(cb_1, cb_2), 1), cb_factor), \
+		v_8 = CHROMA_8_NEON(vshrq_n_s16(vpaddq_s16(cr_1, cr_2), 1), cr_factor); \
+	SAVE
+
+#define RGB2YUV_444_16_NEON(R_8, G_8, B_8, SAVE) \
+	RGB2YUV_LINE_CHROMA_16_NEON(R_8, G_8, B_8) \
+	const uint8x16_t u_8 = vcombine_u8(CHROMA_8_NEON(cb_1, cb_factor), CHROMA_8_NEON(cb_2, cb_factor)), \
+		v_8 = vcombine_u8(CHROMA_8_NEON(cr_1, cr_factor), CHROMA_8_NEON(cr_2, cr_factor)); \
+	SAVE
+
+#define SAVE_YUV_yuv422p_16_NEON \
+	vst1q_u8(y_ptr, y_8); \
+	vst1_u8(u_ptr, u_8); \
+	vst1_u8(v_ptr, v_8);
+
+#define SAVE_YUV_nv16_16_NEON \
+	vst1q_u8(y_ptr, y_8); \
+	{ \
+		uint8x8x2_t uv; \
+		uv.val[0] = u_8; \
+		uv.val[1] = v_8; \
+		vst2_u8(uv_ptr, uv); \
+	}
+
+#define SAVE_YUV_PACKED_16_NEON(Y_INDEX, C_INDEX) \
+	{ \
+		const uint8x8x2_t uv = vzip_u8(u_8, v_8); \
+		uint8x16x2_t yuv; \
+		yuv.val[Y_INDEX] = y_8; \
+		yuv.val[C_INDEX] = vcombine_u8(uv.val[0], uv.val[1]); \
+		vst2q_u8(yuv_ptr, yuv); \
+	}
+
+#define SAVE_YUV_yuyv_16_NEON SAVE_YUV_PACKED_16_NEON(0, 1)
+#define SAVE_YUV_uyvy_16_NEON SAVE_YUV_PACKED_16_NEON(1, 0)
+
+#define SAVE_YUV_yuv444p_16_NEON \
+	vst1q_u8(y_ptr, y_8); \
+	vst1q_u8(u_ptr, u_8); \
+	vst1q_u8(v_ptr, v_8);
+
+#define SAVE_YUV_nv24_16_NEON \
+	vst1q_u8(y_ptr, y_8); \
+	{ \
+		uint8x16x2_t uv; \
+		uv.val[0] = u_8; \
+		uv.val[1] = v_8; \
+		vst2q_u8(uv_ptr, uv); \
+	}
+
+#define LOAD_RGB24_16_NEON(PTR) const uint8x16x3_t rgb = vld3q_u8(PTR);
+#define LOAD_RGB32_16_NEON(PTR) const uint8x16x4_t rgb = vld4q_u8(PTR);
+
+// RGB_YUV_LINES_NEON_FUNCTION(FORMAT, BPP, LOAD, NAME, SUBSAMPLING) defines <FORMAT>_<NAME>_neon, for LOAD the
+// matching rgb load and the 4:2:2 (SUBSAMPLING 422) or 4:4:4 (444) format NAME
+#define RGB_YUV_LINES_NEON_FUNCTION(FORMAT, BPP, LOAD, NAME, SUBSAMPLING) \
+void FORMAT##_##NAME##_neon( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *RGB, uint32_t RGB_stride, \
+	YUV_PARAM_##NAME(uint8_t), \
+	YCbCrType yuv_type) \
+{ \
+	KERNEL_PARAM(RGB2YUVParam, RGB2YUV) \
+	\
+	uint32_t x, y; \
+	for(y=0; y<height; ++y) \
+	{ \
+		const uint8_t *rgb_ptr=RGB+y*RGB_stride; \
+		YUV_LINE_##NAME(uint8_t) \
+		\
+		for(x=0; (x+15)<width; x+=16) \
+		{ \
+			LOAD(rgb_ptr) \
+			RGB2YUV_##SUBSAMPLING##_16_NEON(rgb.val[0], rgb.val[1], rgb.val[2], SAVE_YUV_##NAME##_16_NEON) \
+			\
+			rgb_ptr+=16*BPP; \
+			YUV_ADVANCE_##NAME(16) \
+		} \
+	} \
+	RGB_YUV_LINES_TAIL(16, BPP, SUBSAMPLING, NAME, FORMAT##_##NAME##_neon, FORMAT##_##NAME##_std) \
+}
+
+#define YUV_LINES_NEON_FUNCTIONS(FORMAT, BPP, SAVE, LOAD) \
+	YUV_RGB_LINES_NEON_FUNCTION(yuv422p, 422, FORMAT, BPP, SAVE) \
+	YUV_RGB_LINES_NEON_FUNCTION(nv16, 422, FORMAT, BPP, SAVE) \
+	YUV_RGB_LINES_NEON_FUNCTION(yuyv, 422, FORMAT, BPP, SAVE) \
+	YUV_RGB_LINES_NEON_FUNCTION(uyvy, 422, FORMAT, BPP, SAVE) \
+	YUV_RGB_LINES_NEON_FUNCTION(yuv444p, 444, FORMAT, BPP, SAVE) \
+	YUV_RGB_LINES_NEON_FUNCTION(nv24, 444, FORMAT, BPP, SAVE) \
+	RGB_YUV_LINES_NEON_FUNCTION(FORMAT, BPP, LOAD, yuv422p, 422) \
+	RGB_YUV_LINES_NEON_FUNCTION(FORMAT, BPP, LOAD, nv16, 422) \
+	RGB_YUV_LINES_NEON_FUNCTION(FORMAT, BPP, LOAD, yuyv, 422) \
+	RGB_YUV_LINES_NEON_FUNCTION(FORMAT, BPP, LOAD, uyvy, 422) \
+	RGB_YUV_LINES_NEON_FUNCTION(FORMAT, BPP, LOAD, yuv444p, 444) \
+	RGB_YUV_LINES_NEON_FUNCTION(FORMAT, BPP, LOAD, nv24, 444)
+
+YUV_LINES_NEON_FUNCTIONS(rgb24, 3, SAVE_RGB24_16_NEON, LOAD_RGB24_16_NEON)
+YUV_LINES_NEON_FUNCTIONS(rgb32, 4, SAVE_RGB32_16_NEON, LOAD_RGB32_16_NEON)
+
+// Direct yuv format conversions, see nv12_yuv420_std
+// The conversions between yuv420 formats process 16 chroma samples of a line, and the packed ones 32 pixels of a
+// line or of a pair of lines, split by vld4q_u8 in the lanes Y_INDEX (first y values), 1-Y_INDEX (u), Y_INDEX+2
+// (second y values) and 3-Y_INDEX (v).
+
+// split 16 pairs of interleaved samples at SRC, the first sample of each pair in DST1 and the second one in DST2
+#define SPLIT_PAIRS_16_NEON(SRC, DST1, DST2) \
+	{ \
+		const uint8x16x2_t uv = vld2q_u8(SRC); \
+		vst1q_u8(DST1, uv.val[0]); \
+		vst1q_u8(DST2, uv.val[1]); \
+	}
+
+// interleave 16 samples at SRC1 and SRC2 in 16 pairs at DST
+#define MERGE_PAIRS_16_NEON(SRC1, SRC2, DST) \
+	{ \
+		uint8x16x2_t uv; \
+		uv.val[0] = vld1q_u8(SRC1); \
+		uv.val[1] = vld1q_u8(SRC2); \
+		vst2q_u8(DST, uv); \
+	}
+
+#define CHROMA_NEON_nv12_yuv420(X) SPLIT_PAIRS_16_NEON(u_src+2*(X), u_dst+(X), v_dst+(X))
+#define CHROMA_NEON_nv21_yuv420(X) SPLIT_PAIRS_16_NEON(v_src+2*(X), v_dst+(X), u_dst+(X))
+#define CHROMA_NEON_yuv420_nv12(X) MERGE_PAIRS_16_NEON(u_src+(X), v_src+(X), u_dst+2*(X))
+#define CHROMA_NEON_yuv420_nv21(X) MERGE_PAIRS_16_NEON(v_src+(X), u_src+(X), v_dst+2*(X))
+
+// save the 16 averaged u and v values of the pixels starting at X
+#define SAVE_C_PAIRS_yuv420_NEON(X) \
+	vst1q_u8(u_dst+(X)/2, u); \
+	vst1q_u8(v_dst+(X)/2, v);
+
+#define SAVE_C_PAIRS_nv12_NEON(X) \
+	{ \
+		uint8x16x2_t uv; \
+		uv.val[0] = u; \
+		uv.val[1] = v; \
+		vst2q_u8(u_dst+(X), uv); \
+	}
+
+// split the 32 pixels starting at X of the lines src1 and src2 of the packed format SRC, the chroma values of the two
+// lines being averaged
+#define UNPACK_LINES_32_NEON(SRC, DST, X) \
+	{ \
+		const uint8x16x4_t p1 = vld4q_u8(src1+2*(X)), p2 = vld4q_u8(src2+2*(X)); \
+		uint8x16x2_t y_8; \
+		y_8.val[0] = p1.val[Y_INDEX_##SRC]; \
+		y_8.val[1] = p1.val[Y_INDEX_##SRC+2]; \
+		vst2q_u8(y_dst1+(X), y_8); \
+		y_8.val[0] = p2.val[Y_INDEX_##SRC]; \
+		y_8.val[1] = p2.val[Y_INDEX_##SRC+2]; \
+		vst2q_u8(y_dst2+(X), y_8); \
+		const uint8x16_t u = vrhaddq_u8(p1.val[1-Y_INDEX_##SRC], p2.val[1-Y_INDEX_##SRC]), \
+			v = vrhaddq_u8(p1.val[3-Y_INDEX_##SRC], p2.val[3-Y_INDEX_##SRC]); \
+		SAVE_C_PAIRS_##DST##_NEON(X) \
+	}
+
+#define PACKED_NEON_yuyv_yuv420(X) UNPACK_LINES_32_NEON(yuyv, yuv420, X)
+#define PACKED_NEON_uyvy_yuv420(X) UNPACK_LINES_32_NEON(uyvy, yuv420, X)
+#define PACKED_NEON_yuyv_nv12(X) UNPACK_LINES_32_NEON(yuyv, nv12, X)
+#define PACKED_NEON_uyvy_nv12(X) UNPACK_LINES_32_NEON(uyvy, nv12, X)
+
+// load the 16 u and v values of the pixels starting at X
+#define LOAD_C_PAIRS_yuv420_NEON(X) \
+	const uint8x16_t u = vld1q_u8(u_src+(X)/2), v = vld1q_u8(v_src+(X)/2);
+
+#define LOAD_C_PAIRS_nv12_NEON(X) \
+	const uint8x16x2_t uv = vld2q_u8(u_src+(X)); \
+	const uint8x16_t u = uv.val[0], v = uv.val[1];
+
+// interleave the 32 y values starting at X of the line y_src with their chroma values, in the line dst of the packed
+// format DST
+#define PACK_LINE_32_NEON(SRC, DST, X) \
+	{ \
+		const uint8x16x2_t y_8 = vld2q_u8(y_src+(X)); \
+		LOAD_C_PAIRS_##SRC##_NEON(X) \
+		uint8x16x4_t p; \
+		p.val[Y_INDEX_##DST] = y_8.val[0]; \
+		p.val[Y_INDEX_##DST+2] = y_8.val[1]; \
+		p.val[1-Y_INDEX_##DST] = u; \
+		p.val[3-Y_INDEX_##DST] = v; \
+		vst4q_u8(dst+2*(X), p); \
+	}
+
+#define PACKED_NEON_yuv420_yuyv(X) PACK_LINE_32_NEON(yuv420, yuyv, X)
+#define PACKED_NEON_yuv420_uyvy(X) PACK_LINE_32_NEON(yuv420, uyvy, X)
+#define PACKED_NEON_nv12_yuyv(X) PACK_LINE_32_NEON(nv12, yuyv, X)
+#define PACKED_NEON_nv12_uyvy(X) PACK_LINE_32_NEON(nv12, uyvy, X)
+
+// YUV_DIRECT_NEON_FUNCTION(SRC, DST, N, CONVERT, BLOCK) defines <SRC>_<DST>_neon, CONVERT being one of the *_CONVERT
+// macros of yuv_rgb_internal.h
+#define YUV_DIRECT_NEON_FUNCTION(SRC, DST, N, CONVERT, BLOCK) \
+void SRC##_##DST##_neon( \
+	uint32_t width, uint32_t height, \
+	SRC_PARAM_##SRC, \
+	DST_PARAM_##DST) \
+{ \
+	CONVERT(N, SRC, DST, BLOCK##_##SRC##_##DST) \
+}
+
+YUV_DIRECT_NEON_FUNCTION(nv12, yuv420, 16, YUV420_CHROMA_CONVERT, CHROMA_NEON)
+YUV_DIRECT_NEON_FUNCTION(nv21, yuv420, 16, YUV420_CHROMA_CONVERT, CHROMA_NEON)
+YUV_DIRECT_NEON_FUNCTION(yuv420, nv12, 16, YUV420_CHROMA_CONVERT, CHROMA_NEON)
+YUV_DIRECT_NEON_FUNCTION(yuv420, nv21, 16, YUV420_CHROMA_CONVERT, CHROMA_NEON)
+YUV_DIRECT_NEON_FUNCTION(yuyv, yuv420, 32, PACKED_YUV420_CONVERT, PACKED_NEON)
+YUV_DIRECT_NEON_FUNCTION(uyvy, yuv420, 32, PACKED_YUV420_CONVERT, PACKED_NEON)
+YUV_DIRECT_NEON_FUNCTION(yuyv, nv12, 32, PACKED_YUV420_CONVERT, PACKED_NEON)
+YUV_DIRECT_NEON_FUNCTION(uyvy, nv12, 32, PACKED_YUV420_CONVERT, PACKED_NEON)
+YUV_DIRECT_NEON_FUNCTION(yuv420, yuyv, 32, YUV420_PACKED_CONVERT, PACKED_NEON)
+YUV_DIRECT_NEON_FUNCTION(yuv420, uyvy, 32, YUV420_PACKED_CONVERT, PACKED_NEON)
+YUV_DIRECT_NEON_FUNCTION(nv12, yuyv, 32, YUV420_PACKED_CONVERT, PACKED_NEON)
+YUV_DIRECT_NEON_FUNCTION(nv12, uyvy, 32, YUV420_PACKED_CONVERT, PACKED_NEON)
+
+#endif //_YUVRGB_NEON_
@@ -0,0 +1,371 @@
+// Copyright 2016 Adrien Descamps
+// Distributed under BSD 3-Clause License
+
+// OpenCL conversions (see yuv_rgb_opencl.h)
+//
+// Each work item converts the 2x2 pixels that share a chroma sample, with the formulas of the standard c
+// implementation: the yuv to rgb kernels compute the entries of its lookup tables (see YUV2RGBTable in yuv_rgb.c) from
+// the YUV2RGBParam factors, and the rgb to yuv kernels are RGB2YUV_STD. As there, the last column of odd widths is
+// processed as a pair of identical pixels (dx=0), and the last line of odd heights as a pair of identical lines
+// (y2=y). The factors of the color space are passed as an uchar8 argument at each call, so that the custom color spaces
+// can be changed between conversions.
+// clSetKernelArg is not thread safe on a given kernel, so the arguments are set and the kernel enqueued with the mutex
+// of the context locked: the kernel can then be used by the next conversion, since its arguments are those at the
+// time it was enqueued.
+
+#include "yuv_rgb_opencl.h"
+#include "yuv_rgb_internal.h"
+
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+typedef CRITICAL_SECTION Mutex;
+#define mutex_init(M) (InitializeCriticalSection(M), 0)
+#define mutex_destroy(M) DeleteCriticalSection(M)
+#define mutex_lock(M) EnterCriticalSection(M)
+#define mutex_unlock(M) LeaveCriticalSection(M)
+#else
+#include <pthread.h>
+typedef pthread_mutex_t Mutex;
+#define mutex_init(M) pthread_mutex_init(M, NULL)
+#define mutex_destroy(M) pthread_mutex_destroy(M)
+#define mutex_lock(M) pthread_mutex_lock(M)
+#define mutex_unlock(M) pthread_mutex_unlock(M)
+#endif
+
+// source of the program, split in strings shorter than the 4095 characters that C99 compilers must support
+static const char *const PROGRAM_SOURCE[] = {
+	// position of the pair of pixels of the work item on the pair of lines y and y2
+	"#define PAIR_POSITION \\\n"
+	"	const uint x = 2*get_global_id(0), y = 2*get_global_id(1), \\\n"
+	"		dx = x+1<width ? 1 : 0, y2 = y+1<height ? y+1 : y;\n"
+	"\n"
+	"#define SAVE_RGB24(PTR, R, G, B) (PTR)[0] = R; (PTR)[1] = G; (PTR)[2] = B;\n"
+	"#define SAVE_RGB32(PTR, R, G, B) (PTR)[0] = R; (PTR)[1] = G; (PTR)[2] = B; (PTR)[3] = 255;\n"
+	"#define CLAMP(VALUE) (uchar)clamp(VALUE, 0, 255)\n"
+	"\n"
+	// param is cb_factor, cr_factor, g_cb_factor, g_cr_factor, y_factor, y_offset (YUV2RGBParam)
+	"#define YUV2RGB_PIXEL(Y_VALUE, PTR, SAVE) \\\n"
+	"	{ \\\n"
+	"		const int y_value = Y_VALUE, y_tmp = y_value>param.s5 ? (param.s4*(y_value-param.s5))>>7 : 0; \\\n"
+	"		SAVE(PTR, CLAMP(y_tmp+r_cr_offset), CLAMP(y_tmp-g_cbcr_offset), CLAMP(y_tmp+b_cb_offset)) \\\n"
+	"	}\n"
+	"\n"
+	"#define YUV2RGB(U_VALUE, V_VALUE, BPP, SAVE) \\\n"
+	"	const int u_tmp = (int)(U_VALUE)-128, v_tmp = (int)(V_VALUE)-128, \\\n"
+	"		b_cb_offset = (param.s0*u_tmp)>>6, r_cr_offset = (param.s1*v_tmp)>>6, \\\n"
+	"		g_cbcr_offset = (param.s2*u_tmp + param.s3*v_tmp)>>7; \\\n"
+	"	__global uchar *rgb_ptr1 = RGB+RGB_offset+(ulong)y*RGB_stride+x*BPP, \\\n"
+	"		*rgb_ptr2 = RGB+RGB_offset+(ulong)y2*RGB_stride+x*BPP; \\\n"
+	"	YUV2RGB_PIXEL(y_ptr1[0], rgb_ptr1, SAVE) \\\n"
+	"	YUV2RGB_PIXEL(y_ptr1[dx], rgb_ptr1+dx*BPP, SAVE) \\\n"
+	"	YUV2RGB_PIXEL(y_ptr2[0], rgb_ptr2, SAVE) \\\n"
+	"	YUV2RGB_PIXEL(y_ptr2[dx], rgb_ptr2+dx*BPP, SAVE)\n"
+	"\n",
+
+	"#define YUV420_KERNEL(FORMAT, BPP, SAVE) \\\n"
+	"__kernel void yuv420_##FORMAT(uint width, uint height, \\\n"
+	"	__global const uchar *Y, ulong Y_offset, __global const uchar *U, ulong U_offset, \\\n"
+	"	__global const uchar *V, ulong V_offset, uint Y_stride, uint UV_stride, \\\n"
+	"	__global uchar *RGB, ulong RGB_offset, uint RGB_stride, uchar8 param) \\\n"
+	"{ \\\n"
+	"	PAIR_POSITION \\\n"
+	"	__global const uchar *y_ptr1 = Y+Y_offset+(ulong)y*Y_stride+x, \\\n"
+	"		*y_ptr2 = Y+Y_offset+(ulong)y2*Y_stride+x; \\\n"
+	"	const ulong uv_index = (ulong)(y/2)*UV_stride+x/2; \\\n"
+	"	YUV2RGB(U[U_offset+uv_index], V[V_offset+uv_index], BPP, SAVE) \\\n"
+	"}\n"
+	"\n"
+	// U_INDEX and V_INDEX are the positions of u and v in the interleaved uv data
+	"#define NV12_KERNEL(NAME, U_INDEX, V_INDEX, FORMAT, BPP, SAVE) \\\n"
+	"__kernel void NAME##_##FORMAT(uint width, uint height, \\\n"
+	"	__global const uchar *Y, ulong Y_offset, __global const uchar *UV, ulong UV_offset, \\\n"
+	"	uint Y_stride, uint UV_stride, \\\n"
+	"	__global uchar *RGB, ulong RGB_offset, uint RGB_stride, uchar8 param) \\\n"
+	"{ \\\n"
+	"	PAIR_POSITION \\\n"
+	"	__global const uchar *y_ptr1 = Y+Y_offset+(ulong)y*Y_stride+x, \\\n"
+	"		*y_ptr2 = Y+Y_offset+(ulong)y2*Y_stride+x, \\\n"
+	"		*uv_ptr = UV+UV_offset+(ulong)(y/2)*UV_stride+x; \\\n"
+	"	YUV2RGB(uv_ptr[U_INDEX], uv_ptr[V_INDEX], BPP, SAVE) \\\n"
+	"}\n"
+	"\n"
+	"YUV420_KERNEL(rgb24, 3, SAVE_RGB24)\n"
+	"YUV420_KERNEL(rgb32, 4, SAVE_RGB32)\n"
+	"NV12_KERNEL(nv12, 0, 1, rgb24, 3, SAVE_RGB24)\n"
+	"NV12_KERNEL(nv12, 0, 1, rgb32, 4, SAVE_RGB32)\n"
+	"NV12_KERNEL(nv21, 1, 0, rgb24, 3, SAVE_RGB24)\n"
+	"NV12_KERNEL(nv21, 1, 0, rgb32, 4, SAVE_RGB32)\n"
+	"\n",
+
+	// param is r_factor, g_factor, b_factor, cb_factor, cr_factor, y_factor, y_offset (RGB2YUVParam), the u and v
+	// values being summed in u_tmp and v_tmp
+	"#define RGB2YUV_PIXEL(RGB_PTR, Y_PTR) \\\n"
+	"	y_tmp = (param.s0*(RGB_PTR)[0] + param.s1*(RGB_PTR)[1] + param.s2*(RGB_PTR)[2])>>8; \\\n"
+	"	u_tmp += (RGB_PTR)[2]-y_tmp; \\\n"
+	"	v_tmp += (RGB_PTR)[0]-y_tmp; \\\n"
+	"	*(Y_PTR) = (uchar)(((y_tmp*param.s5)>>7) + param.s6);\n"
+	"\n"
+	"#define RGB2YUV_KERNEL(FORMAT, BPP) \\\n"
+	"__kernel void FORMAT##_yuv420(uint width, uint height, \\\n"
+	"	__global const uchar *RGB, ulong RGB_offset, uint RGB_stride, \\\n"
+	"	__global uchar *Y, ulong Y_offset, __global uchar *U, ulong U_offset, \\\n"
+	"	__global uchar *V, ulong V_offset, uint Y_stride, uint UV_stride, uchar8 param) \\\n"
+	"{ \\\n"
+	"	PAIR_POSITION \\\n"
+	"	__global const uchar *rgb_ptr1 = RGB+RGB_offset+(ulong)y*RGB_stride+x*BPP, \\\n"
+	"		*rgb_ptr2 = RGB+RGB_offset+(ulong)y2*RGB_stride+x*BPP; \\\n"
+	"	__global uchar *y_ptr1 = Y+Y_offset+(ulong)y*Y_stride+x, \\\n"
+	"		*y_ptr2 = Y+Y_offset+(ulong)y2*Y_stride+x; \\\n"
+	"	const ulong uv_index = (ulong)(y/2)*UV_stride+x/2; \\\n"
+	"	int y_tmp, u_tmp = 0, v_tmp = 0; \\\n"
+	"	RGB2YUV_PIXEL(rgb_ptr1, y_ptr1) \\\n"
+	"	RGB2YUV_PIXEL(rgb_ptr1+dx*BPP, y_ptr1+dx) \\\n"
+	"	RGB2YUV_PIXEL(rgb_ptr2, y_ptr2) \\\n"
+	"	RGB2YUV_PIXEL(rgb_ptr2+dx*BPP, y_ptr2+dx) \\\n"
+	"	U[U_offset+uv_index] = (uchar)((((u_tmp>>2)*param.s3)>>8) + 128); \\\n"
+	"	V[V_offset+uv_index] = (uchar)((((v_tmp>>2)*param.s4)>>8) + 128); \\\n"
+	"}\n"
+	"\n"
+	"RGB2YUV_KERNEL(rgb24, 3)\n"
+	"RGB2YUV_KERNEL(rgb32, 4)\n"
+};
+
+// kernels of the program
+typedef enum
+{
+	KERNEL_YUV420_RGB24,
+	KERNEL_YUV420_RGB32,
+	KERNEL_NV12_RGB24,
+	KERNEL_NV12_RGB32,
+	KERNEL_NV21_RGB24,
+	KERNEL_NV21_RGB32,
+	KERNEL_RGB24_YUV420,
+	KERNEL_RGB32_YUV420,
+	KERNEL_COUNT
+} Kernel;
+
+static const char *const KERNEL_NAMES[KERNEL_COUNT] = {
+	"yuv420_rgb24", "yuv420_rgb32", "nv12_rgb24", "nv12_rgb32", "nv21_rgb24", "nv21_rgb32",
+	"rgb24_yuv420", "rgb32_yuv420"
+};
+
+struct yuv_rgb_opencl
+{
+	cl_command_queue queue;
+	cl_program program;
+	cl_kernel kernels[KERNEL_COUNT];
+	// protects the arguments of the kernels, from their setting to the enqueuing of the kernel
+	Mutex mutex;
+};
+
+yuv_rgb_opencl *yuv_rgb_opencl_create(cl_command_queue queue)
+{
+	cl_context context;
+	cl_device_id device;
+	cl_int error;
+	yuv_rgb_opencl *opencl;
+	int i;
+
+	if(clGetCommandQueueInfo(queue, CL_QUEUE_CONTEXT, sizeof(cl_context), &context, NULL)!=CL_SUCCESS ||
+		clGetCommandQueueInfo(queue, CL_QUEUE_DEVICE, sizeof(cl_device_id), &device, NULL)!=CL_SUCCESS)
+		return NULL;
+
+	opencl = calloc(1, sizeof(yuv_rgb_opencl));
+	if(!opencl)
+		return NULL;
+	if(mutex_init(&opencl->mutex)!=0)
+	{
+		free(opencl);
+		return NULL;
+	}
+	clRetainCommandQueue(queue);
+	opencl->queue = queue;
+
+	opencl->program = clCreateProgramWithSource(context, sizeof(PROGRAM_SOURCE)/sizeof(PROGRAM_SOURCE[0]),
+		(const char **)PROGRAM_SOURCE, NULL, &error);
+	if(error!=CL_SUCCESS)
+	{
+		yuv_rgb_opencl_destroy(opencl);
+		return NULL;
+	}
+	if(clBuildProgram(opencl->program, 1, &device, "-cl-std=CL1.2", NULL, NULL)!=CL_SUCCESS)
+	{
+		yuv_rgb_opencl_destroy(opencl);
+		return NULL;
+	}
+	for(i=0; i<KERNEL_COUNT; ++i)
+	{
+		opencl->kernels[i] = clCreateKernel(opencl->program, KERNEL_NAMES[i], &error);
+		if(error!=CL_SUCCESS)
+		{
+			yuv_rgb_opencl_destroy(opencl);
+			return NULL;
+		}
+	}
+	return opencl;
+}
+
+void yuv_rgb_opencl_destroy(yuv_rgb_opencl *opencl)
+{
+	int i;
+	if(!opencl)
+		return;
+	for(i=0; i<KERNEL_COUNT; ++i)
+		if(opencl->kernels[i])
+			clReleaseKernel(opencl->kernels[i]);
+	if(opencl->program)
+		clReleaseProgram(opencl->program);
+	clReleaseCommandQueue(opencl->queue);
+	mutex_destroy(&opencl->mutex);
+	free(opencl);
+}
+
+// kernel arguments, in the order of the kernel parameters
+#define SET_ARG(VALUE) \
+	if(error==CL_SUCCESS) \
+		error = clSetKernelArg(kernel, arg++, sizeof(VALUE), &(VALUE));
+
+// enqueue kernel, whose arguments are set, on the pairs of pixels of the image, or a marker for an empty image
+static cl_int enqueue(yuv_rgb_opencl *opencl, cl_kernel kernel, uint32_t width, uint32_t height,
+	cl_uint wait_number, const cl_event *wait_list, cl_event *event)
+{
+	const size_t global_size[2] = {(width+1)/2, (height+1)/2};
+	if(width==0 || height==0)
+		return clEnqueueMarkerWithWaitList(opencl->queue, wait_number, wait_list, event);
+	return clEnqueueNDRangeKernel(opencl->queue, kernel, 2, NULL, global_size, NULL, wait_number, wait_list, event);
+}
+
+// factors of the color space, in the order of the YUV2RGBParam and RGB2YUVParam fields
+static cl_uchar8 yuv2rgb_param(YCbCrType yuv_type)
+{
+	const YUV2RGBParam *const param = &(YUV2RGB[yuv_type]);
+	cl_uchar8 value = {{0}};
+	value.s[0] = param->cb_factor;
+	value.s[1] = param->cr_factor;
+	value.s[2] = param->g_cb_factor;
+	value.s[3] = param->g_cr_factor;
+	value.s[4] = param->y_factor;
+	value.s[5] = param->y_offset;
+	return value;
+}
+
+static cl_uchar8 rgb2yuv_param(YCbCrType yuv_type)
+{
+	const RGB2YUVParam *const param = &(RGB2YUV[yuv_type]);
+	cl_uchar8 value = {{0}};
+	value.s[0] = param->r_factor;
+	value.s[1] = param->g_factor;
+	value.s[2] = param->b_factor;
+	value.s[3] = param->cb_factor;
+	value.s[4] = param->cr_factor;
+	value.s[5] = param->y_factor;
+	value.s[6] = param->y_offset;
+	return value;
+}
+
+// common arguments of the conversions, the offsets being converted to the ulong of the kernels
+// OPENCL_FUNCTION_START locks the mutex, and OPENCL_FUNCTION_END enqueues the kernel and unlocks it
+#define OPENCL_FUNCTION_START(KERNEL) \
+	const cl_kernel kernel = opencl->kernels[KERNEL]; \
+	const cl_uint width_arg = width, height_arg = height; \
+	cl_uint arg = 0; \
+	cl_int error = CL_SUCCESS; \
+	if((unsigned int)yuv_type>=YCBCR_TYPE_COUNT) \
+		return CL_INVALID_VALUE; \
+	mutex_lock(&opencl->mutex); \
+	SET_ARG(width_arg) \
+	SET_ARG(height_arg)
+
+#define OPENCL_FUNCTION_END \
+	if(error==CL_SUCCESS) \
+		error = enqueue(opencl, kernel, width, height, wait_number, wait_list, event); \
+	mutex_unlock(&opencl->mutex); \
+	return error;
+
+#define YUV420_RGB_OPENCL_FUNCTION(FORMAT, KERNEL) \
+cl_int yuv420_##FORMAT##_opencl(yuv_rgb_opencl *opencl, uint32_t width, uint32_t height, \
+	cl_mem y, size_t y_offset, cl_mem u, size_t u_offset, cl_mem v, size_t v_offset, \
+	uint32_t y_stride, uint32_t uv_stride, \
+	cl_mem rgb, size_t rgb_offset, uint32_t rgb_stride, \
+	YCbCrType yuv_type, cl_uint wait_number, const cl_event *wait_list, cl_event *event) \
+{ \
+	OPENCL_FUNCTION_START(KERNEL) \
+	const cl_ulong y_offset_arg = y_offset, u_offset_arg = u_offset, v_offset_arg = v_offset, \
+		rgb_offset_arg = rgb_offset; \
+	const cl_uint y_stride_arg = y_stride, uv_stride_arg = uv_stride, rgb_stride_arg = rgb_stride; \
+	const cl_uchar8 param = yuv2rgb_param(yuv_type); \
+	SET_ARG(y) \
+	SET_ARG(y_offset_arg) \
+	SET_ARG(u) \
+	SET_ARG(u_offset_arg) \
+	SET_ARG(v) \
+	SET_ARG(v_offset_arg) \
+	SET_ARG(y_stride_arg) \
+	SET_ARG(uv_stride_arg) \
+	SET_ARG(rgb) \
+	SET_ARG(rgb_offset_arg) \
+	SET_ARG(rgb_stride_arg) \
+	SET_ARG(param) \
+	OPENCL_FUNCTION_END \
+}
+
+#define NV12_RGB_OPENCL_FUNCTION(NAME, FORMAT, KERNEL) \
+cl_int NAME##_##FORMAT##_opencl(yuv_rgb_opencl *opencl, uint32_t width, uint32_t height, \
+	cl_mem y, size_t y_offset, cl_mem uv, size_t uv_offset, uint32_t y_stride, uint32_t uv_stride, \
+	cl_mem rgb, size_t rgb_offset, uint32_t rgb_stride, \
+	YCbCrType yuv_type, cl_uint wait_number, const cl_event *wait_list, cl_event *event) \
+{ \
+	OPENCL_FUNCTION_START(KERNEL) \
+	const cl_ulong y_offset_arg = y_offset, uv_offset_arg = uv_offset, rgb_offset_arg = rgb_offset; \
+	const cl_uint y_stride_arg = y_stride, uv_stride_arg = uv_stride, rgb_stride_arg = rgb_stride; \
+	const cl_uchar8 param = yuv2rgb_param(yuv_type); \
+	SET_ARG(y) \
+	SET_ARG(y_offset_arg) \
+	SET_ARG(uv) \
+	SET_ARG(uv_offset_arg) \
+	SET_ARG(y_stride_arg) \
+	SET_ARG(uv_stride_arg) \
+	SET_ARG(rgb) \
+	SET_ARG(rgb_offset_arg) \
+	SET_ARG(rgb_stride_arg) \
+	SET_ARG(param) \
+	OPENCL_FUNCTION_END \
+}
+
+#define RGB_YUV420_OPENCL_FUNCTION(FORMAT, KERNEL) \
+cl_int FORMAT##_yuv420_opencl(yuv_rgb_opencl *opencl, uint32_t width, uint32_t height, \
+	cl_mem rgb, size_t rgb_offset, uint32_t rgb_stride, \
+	cl_mem y, size_t y_offset, cl_mem u, size_t u_offset, cl_mem v, size_t v_offset, \
+	uint32_t y_stride, uint32_t uv_stride, \
+	YCbCrType yuv_type, cl_uint wait_number, const cl_event *wait_list, cl_event *event) \
+{ \
+	OPENCL_FUNCTION_START(KERNEL) \
+	const cl_ulong rgb_offset_arg = rgb_offset, y_offset_arg = y_offset, u_offset_arg = u_offset, \
+		v_offset_arg = v_offset; \
+	const cl_uint rgb_stride_arg = rgb_stride, y_stride_arg = y_stride, uv_stride_arg = uv_stride; \
+	const cl_uchar8 param = rgb2yuv_param(yuv_type); \
+	SET_ARG(rgb) \
+	SET_ARG(rgb_offset_arg) \
+	SET_ARG(rgb_stride_arg) \
+	SET_ARG(y) \
+	SET_ARG(y_offset_arg) \
+	SET_ARG(u) \
+	SET_ARG(u_offset_arg) \
+	SET_ARG(v) \
+	SET_ARG(v_offset_arg) \
+	SET_ARG(y_stride_arg) \
+	SET_ARG(uv_stride_arg) \
+	SET_ARG(param) \
+	OPENCL_FUNCTION_END \
+}
+
+YUV420_RGB_OPENCL_FUNCTION(rgb24, KERNEL_YUV420_RGB24)
+YUV420_RGB_OPENCL_FUNCTION(rgb32, KERNEL_YUV420_RGB32)
+NV12_RGB_OPENCL_FUNCTION(nv12, rgb24, KERNEL_NV12_RGB24)
+NV12_RGB_OPENCL_FUNCTION(nv12, rgb32, KERNEL_NV12_RGB32)
+NV12_RGB_OPENCL_FUNCTION(nv21, rgb24, KERNEL_NV21_RGB24)
+NV12_RGB_OPENCL_FUNCTION(nv21, rgb32, KERNEL_NV21_RGB32)
+RGB_YUV420_OPENCL_FUNCTION(rgb24, KERNEL_RGB24_YUV420)
+RGB_YUV420_OPENCL_FUNCTION(rgb32, KERNEL_RGB32_YUV420)
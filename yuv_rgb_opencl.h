@@ -0,0 +1,92 @@
+// Copyright 2016 Adrien Descamps
+// Distributed under BSD 3-Clause License
+
+// OpenCL implementation of the yuv420, nv12 and nv21 to rgb24 and rgb32 conversions, and of the rgb24 and rgb32 to
+// yuv420 conversions, available when the library is built with USE_OPENCL.
+//
+// The images are in device memory (OpenCL buffers, with the byte offset of each plane in its buffer, so that the
+// planes of a frame can share a buffer, as the output of most hardware decoders), and are converted on the device of a
+// command queue, without any copy to the host. The results are exactly those of the standard c implementation (and so
+// of the simd ones), with the same fixed point formulas, for all color spaces including the custom ones.
+// The conversions are asynchronous: their functions only enqueue a kernel on the queue, after the events of
+// wait_list, and return immediately. The conversion is complete when its event (if event is not NULL, which must then
+// be released with clReleaseEvent) is complete, for example after clWaitForEvents, or when the next commands of an
+// in-order queue start. The buffers must not be modified or released before.
+// A yuv_rgb_opencl context can be used by several threads: the kernel arguments are set and the kernels enqueued with
+// a lock held, so that the conversions submitted by concurrent threads are serialized for the short time of their
+// submission (their execution on the device is not serialized, unless the queue is in order).
+
+#ifndef YUV_RGB_OPENCL_H
+#define YUV_RGB_OPENCL_H
+
+#include "yuv_rgb.h"
+
+#ifndef CL_TARGET_OPENCL_VERSION
+#define CL_TARGET_OPENCL_VERSION 120
+#endif
+#ifdef __APPLE__
+#include <OpenCL/opencl.h>
+#else
+#include <CL/cl.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct yuv_rgb_opencl yuv_rgb_opencl;
+
+// create a context for the conversions on queue, whose opencl context and device are used to build the kernels
+// (the queue is retained until yuv_rgb_opencl_destroy)
+// return NULL on error, for example if the device does not support OpenCL 1.2
+yuv_rgb_opencl *yuv_rgb_opencl_create(cl_command_queue queue);
+
+// release the kernels and the queue, opencl can be NULL
+// the conversions already enqueued are not affected
+void yuv_rgb_opencl_destroy(yuv_rgb_opencl *opencl);
+
+// All functions return CL_SUCCESS (0) when the conversion is enqueued, or an OpenCL error code (CL_INVALID_VALUE
+// for an invalid yuv_type, or the error of clSetKernelArg or clEnqueueNDRangeKernel, for example for an invalid buffer).
+// Empty images enqueue a marker, so that event is still set.
+
+// yuv420 to rgb24 or rgb32 (alpha set to 255)
+#define YUV420_RGB_OPENCL_DECLARATION(FORMAT) \
+cl_int yuv420_##FORMAT##_opencl(yuv_rgb_opencl *opencl, uint32_t width, uint32_t height, \
+	cl_mem y, size_t y_offset, cl_mem u, size_t u_offset, cl_mem v, size_t v_offset, \
+	uint32_t y_stride, uint32_t uv_stride, \
+	cl_mem rgb, size_t rgb_offset, uint32_t rgb_stride, \
+	YCbCrType yuv_type, cl_uint wait_number, const cl_event *wait_list, cl_event *event);
+
+// nv12 or nv21 to rgb24 or rgb32
+#define NV12_RGB_OPENCL_DECLARATION(NAME, FORMAT) \
+cl_int NAME##_##FORMAT##_opencl(yuv_rgb_opencl *opencl, uint32_t width, uint32_t height, \
+	cl_mem y, size_t y_offset, cl_mem uv, size_t uv_offset, uint32_t y_stride, uint32_t uv_stride, \
+	cl_mem rgb, size_t rgb_offset, uint32_t rgb_stride, \
+	YCbCrType yuv_type, cl_uint wait_number, const cl_event *wait_list, cl_event *event);
+
+// rgb24 or rgb32 (alpha ignored) to yuv420
+#define RGB_YUV420_OPENCL_DECLARATION(FORMAT) \
+cl_int FORMAT##_yuv420_opencl(yuv_rgb_opencl *opencl, uint32_t width, uint32_t height, \
+	cl_mem rgb, size_t rgb_offset, uint32_t rgb_stride, \
+	cl_mem y, size_t y_offset, cl_mem u, size_t u_offset, cl_mem v, size_t v_offset, \
+	uint32_t y_stride, uint32_t uv_stride, \
+	YCbCrType yuv_type, cl_uint wait_number, const cl_event *wait_list, cl_event *event);
+
+YUV420_RGB_OPENCL_DECLARATION(rgb24)
+YUV420_RGB_OPENCL_DECLARATION(rgb32)
+NV12_RGB_OPENCL_DECLARATION(nv12, rgb24)
+NV12_RGB_OPENCL_DECLARATION(nv12, rgb32)
+NV12_RGB_OPENCL_DECLARATION(nv21, rgb24)
+NV12_RGB_OPENCL_DECLARATION(nv21, rgb32)
+RGB_YUV420_OPENCL_DECLARATION(rgb24)
+RGB_YUV420_OPENCL_DECLARATION(rgb32)
+
+#undef YUV420_RGB_OPENCL_DECLARATION
+#undef NV12_RGB_OPENCL_DECLARATION
+#undef RGB_YUV420_OPENCL_DECLARATION
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
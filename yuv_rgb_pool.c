@@ -0,0 +1,522 @@
+// Copyright 2016 Adrien Descamps
+// Distributed under BSD 3-Clause License
+
+// Thread pool and multi-threaded versions of the conversions (see yuv_rgb.h)
+//
+// The image is split in horizontal bands with an even number of lines (except the last one for odd heights), which
+// are independent since the conversions process pairs of lines. Each band is converted by the dispatch function
+// (yuv420_rgb24, ...), by the worker threads and the calling thread.
+// The bilinear conversions have no multi-threaded version: the chroma of the first and last lines of each pair is
+// interpolated with the chroma lines of the neighbouring pairs, which a band does not have.
+// Batches of frames are split in the same way, each frame being a band.
+// The pool holds the description of the current conversion, so that no allocation is done per call. Worker threads
+// wait on a condition variable for a new conversion, then take bands until there is none left. The last thread
+// finishing a band wakes the calling thread.
+
+// for pthread_setaffinity_np
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include "yuv_rgb.h"
+#include "yuv_rgb_internal.h"
+
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sched.h>
+#endif
+#endif
+
+#ifdef _WIN32
+typedef HANDLE Thread;
+typedef CRITICAL_SECTION Mutex;
+typedef CONDITION_VARIABLE Cond;
+#define THREAD_FUNCTION(NAME, ARG) DWORD WINAPI NAME(LPVOID ARG)
+#define THREAD_RETURN 0
+#define mutex_init(M) (InitializeCriticalSection(M), 0)
+#define mutex_destroy(M) DeleteCriticalSection(M)
+#define mutex_lock(M) EnterCriticalSection(M)
+#define mutex_unlock(M) LeaveCriticalSection(M)
+#define cond_init(C) (InitializeConditionVariable(C), 0)
+#define cond_destroy(C) ((void)(C))
+#define cond_wait(C, M) SleepConditionVariableCS(C, M, INFINITE)
+#define cond_broadcast(C) WakeAllConditionVariable(C)
+#else
+typedef pthread_t Thread;
+typedef pthread_mutex_t Mutex;
+typedef pthread_cond_t Cond;
+#define THREAD_FUNCTION(NAME, ARG) void *NAME(void *ARG)
+#define THREAD_RETURN NULL
+#define mutex_init(M) pthread_mutex_init(M, NULL)
+#define mutex_destroy(M) pthread_mutex_destroy(M)
+#define mutex_lock(M) pthread_mutex_lock(M)
+#define mutex_unlock(M) pthread_mutex_unlock(M)
+#define cond_init(C) pthread_cond_init(C, NULL)
+#define cond_destroy(C) pthread_cond_destroy(C)
+#define cond_wait(C, M) pthread_cond_wait(C, M)
+#define cond_broadcast(C) pthread_cond_broadcast(C)
+#endif
+
+// description of a conversion, split in bands of items: lines of an image, or frames of a batch
+// for images, the source and destination planes are in the order of the arguments of the conversion functions
+typedef struct Job
+{
+	// convert the items [begin, end)
+	void (*convert)(const struct Job *job, uint32_t begin, uint32_t end);
+	// bands contain multiples of item_step items (except the last one), 2 for lines, which are converted by pairs
+	uint32_t item_number, item_step;
+	uint32_t width, height;
+	const uint8_t *src[4];
+	uint32_t src_stride[2];
+	uint8_t *dst[4];
+	uint32_t dst_stride[2];
+	// other arguments of the planar rgb and yuva conversions
+	const RGBNormalization *norm;
+	int premultiplied;
+	YCbCrType yuv_type;
+	// store policy of all the bands, decided from the output of the whole job
+	YUVRGBStorePolicy store_policy;
+	// frame descriptors of batches
+	const void *frames;
+} Job;
+
+struct yuv_rgb_pool
+{
+	uint32_t thread_number;
+	Thread *threads;
+
+	// everything below is protected by mutex
+	Mutex mutex;
+	Cond start_cond, done_cond;
+	Job job;
+	uint32_t job_id, band_number, next_band, pending_bands;
+	int quit;
+};
+
+// convert the bands of the current job until there is none left, must be called with the mutex locked
+static void run_bands(yuv_rgb_pool *pool)
+{
+	while(pool->next_band<pool->band_number)
+	{
+		const uint32_t band = pool->next_band++;
+		const Job *const job = &(pool->job);
+		// the last band also gets the remaining items, such as the last line of odd heights
+		const uint32_t steps = job->item_number/job->item_step,
+			begin = (uint32_t)(((uint64_t)steps*band)/pool->band_number)*job->item_step,
+			end = (band+1)==pool->band_number ? job->item_number : (uint32_t)(((uint64_t)steps*(band+1))/pool->band_number)*job->item_step;
+
+		mutex_unlock(&pool->mutex);
+		if(begin<end)
+			job->convert(job, begin, end);
+		mutex_lock(&pool->mutex);
+
+		if(--pool->pending_bands==0)
+			cond_broadcast(&pool->done_cond);
+	}
+}
+
+static THREAD_FUNCTION(worker, arg)
+{
+	yuv_rgb_pool *const pool = (yuv_rgb_pool *)arg;
+	mutex_lock(&pool->mutex);
+	uint32_t job_id = pool->job_id;
+	while(1)
+	{
+		while(!pool->quit && pool->job_id==job_id)
+			cond_wait(&pool->start_cond, &pool->mutex);
+		if(pool->quit)
+			break;
+		job_id = pool->job_id;
+		run_bands(pool);
+	}
+	mutex_unlock(&pool->mutex);
+	return THREAD_RETURN;
+}
+
+// pin a thread to a core, return 0 on success
+static int set_thread_cpu(Thread thread, int cpu)
+{
+#if defined(_WIN32)
+	return (cpu>=0 && cpu<(int)(8*sizeof(DWORD_PTR)) && SetThreadAffinityMask(thread, ((DWORD_PTR)1)<<cpu)!=0) ? 0 : 1;
+#elif defined(__linux__)
+	cpu_set_t set;
+	if(cpu<0 || cpu>=CPU_SETSIZE)
+		return 1;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	return pthread_setaffinity_np(thread, sizeof(set), &set);
+#else
+	// thread affinity is not supported on this platform, the cores are ignored
+	(void)thread;
+	(void)cpu;
+	return 0;
+#endif
+}
+
+uint32_t yuv_rgb_cpu_count(void)
+{
+#if defined(_WIN32)
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwNumberOfProcessors;
+#elif defined(_SC_NPROCESSORS_ONLN)
+	const long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return count>0 ? (uint32_t)count : 1;
+#else
+	return 1;
+#endif
+}
+
+yuv_rgb_pool *yuv_rgb_pool_create(uint32_t thread_number, const int *cpus)
+{
+	yuv_rgb_pool *pool = calloc(1, sizeof(yuv_rgb_pool));
+	if(!pool)
+		return NULL;
+
+	pool->threads = calloc(thread_number ? thread_number : 1, sizeof(Thread));
+	if(!pool->threads)
+	{
+		free(pool);
+		return NULL;
+	}
+	if(mutex_init(&pool->mutex)!=0)
+	{
+		free(pool->threads);
+		free(pool);
+		return NULL;
+	}
+	if(cond_init(&pool->start_cond)!=0)
+	{
+		mutex_destroy(&pool->mutex);
+		free(pool->threads);
+		free(pool);
+		return NULL;
+	}
+	if(cond_init(&pool->done_cond)!=0)
+	{
+		cond_destroy(&pool->start_cond);
+		mutex_destroy(&pool->mutex);
+		free(pool->threads);
+		free(pool);
+		return NULL;
+	}
+
+	// start threads one by one, destroy the pool (which stops the started threads) on error
+	for(uint32_t i=0; i<thread_number; ++i)
+	{
+#ifdef _WIN32
+		pool->threads[i] = CreateThread(NULL, 0, worker, pool, 0, NULL);
+		const int error = pool->threads[i]==NULL;
+#else
+		const int error = pthread_create(&pool->threads[i], NULL, worker, pool);
+#endif
+		if(error)
+		{
+			yuv_rgb_pool_destroy(pool);
+			return NULL;
+		}
+		pool->thread_number = i+1;
+
+		if(cpus && set_thread_cpu(pool->threads[i], cpus[i])!=0)
+		{
+			yuv_rgb_pool_destroy(pool);
+			return NULL;
+		}
+	}
+
+	return pool;
+}
+
+void yuv_rgb_pool_destroy(yuv_rgb_pool *pool)
+{
+	if(!pool)
+		return;
+
+	mutex_lock(&pool->mutex);
+	pool->quit = 1;
+	cond_broadcast(&pool->start_cond);
+	mutex_unlock(&pool->mutex);
+
+	for(uint32_t i=0; i<pool->thread_number; ++i)
+	{
+#ifdef _WIN32
+		WaitForSingleObject(pool->threads[i], INFINITE);
+		CloseHandle(pool->threads[i]);
+#else
+		pthread_join(pool->threads[i], NULL);
+#endif
+	}
+
+	cond_destroy(&pool->done_cond);
+	cond_destroy(&pool->start_cond);
+	mutex_destroy(&pool->mutex);
+	free(pool->threads);
+	free(pool);
+}
+
+uint32_t yuv_rgb_pool_thread_number(const yuv_rgb_pool *pool)
+{
+	return pool ? pool->thread_number : 0;
+}
+
+// convert all the items of job, split in band_number bands, with all the threads of the pool
+static void run_job(yuv_rgb_pool *pool, const Job *job, uint32_t band_number)
+{
+	if(!pool || pool->thread_number==0 || band_number<2)
+	{
+		job->convert(job, 0, job->item_number);
+		return;
+	}
+
+	mutex_lock(&pool->mutex);
+	pool->job = *job;
+	pool->band_number = band_number;
+	pool->next_band = 0;
+	pool->pending_bands = pool->band_number;
+	pool->job_id++;
+	cond_broadcast(&pool->start_cond);
+
+	// the calling thread converts bands too, then waits for the bands converted by the workers
+	run_bands(pool);
+	while(pool->pending_bands>0)
+		cond_wait(&pool->done_cond, &pool->mutex);
+	mutex_unlock(&pool->mutex);
+}
+
+
+// Each multi-threaded conversion is described by the planes of its source and destination, and by its other
+// arguments. The planes of a format F are described by:
+// * F_PARAM(CONST, P): the parameters of the functions, CONST being const for the source and P the prefix of their
+//   names (src_ or dst_, so that both sides of the direct yuv conversions can have the same format)
+// * F_JOB(SIDE, P): the initialization of the planes and strides of the job, SIDE being src or dst
+// * F_BAND(SIDE): the arguments of the conversion of the lines [y_begin, y_end) of the job
+// * F_OUTPUT(P): the size of the image in bytes, for the store policy of destinations
+// 8 bits yuv420 planes, the chroma planes having half the lines
+#define YUV420_PARAM(CONST, P) CONST uint8_t *P##y, CONST uint8_t *P##u, CONST uint8_t *P##v, \
+	uint32_t P##y_stride, uint32_t P##uv_stride
+#define YUV420_JOB(SIDE, P) .SIDE={P##y, P##u, P##v, NULL}, .SIDE##_stride={P##y_stride, P##uv_stride}
+#define YUV420_BAND(SIDE) job->SIDE[0]+y_begin*job->SIDE##_stride[0], \
+	job->SIDE[1]+(y_begin/2)*job->SIDE##_stride[1], job->SIDE[2]+(y_begin/2)*job->SIDE##_stride[1], \
+	job->SIDE##_stride[0], job->SIDE##_stride[1]
+#define YUV420_OUTPUT(P) ((uint64_t)P##y_stride*height + (uint64_t)P##uv_stride*(height+1))
+
+// 8 bits semi planar yuv420 (nv12 and nv21)
+#define NV12_PARAM(CONST, P) CONST uint8_t *P##y, CONST uint8_t *P##uv, uint32_t P##y_stride, uint32_t P##uv_stride
+#define NV12_JOB(SIDE, P) .SIDE={P##y, P##uv, NULL, NULL}, .SIDE##_stride={P##y_stride, P##uv_stride}
+#define NV12_BAND(SIDE) job->SIDE[0]+y_begin*job->SIDE##_stride[0], job->SIDE[1]+(y_begin/2)*job->SIDE##_stride[1], \
+	job->SIDE##_stride[0], job->SIDE##_stride[1]
+#define NV12_OUTPUT(P) ((uint64_t)P##y_stride*height + (uint64_t)P##uv_stride*((height+1)/2))
+
+// 16 bits yuv420 sources, the strides being in bytes
+#define YUV420P16_PARAM(CONST, P) CONST uint16_t *P##y, CONST uint16_t *P##u, CONST uint16_t *P##v, \
+	uint32_t P##y_stride, uint32_t P##uv_stride
+#define YUV420P16_JOB(SIDE, P) .SIDE={(const uint8_t *)P##y, (const uint8_t *)P##u, (const uint8_t *)P##v, NULL}, \
+	.SIDE##_stride={P##y_stride, P##uv_stride}
+#define YUV420P16_BAND(SIDE) (const uint16_t *)(job->SIDE[0]+y_begin*job->SIDE##_stride[0]), \
+	(const uint16_t *)(job->SIDE[1]+(y_begin/2)*job->SIDE##_stride[1]), \
+	(const uint16_t *)(job->SIDE[2]+(y_begin/2)*job->SIDE##_stride[1]), job->SIDE##_stride[0], job->SIDE##_stride[1]
+
+#define P016_PARAM(CONST, P) CONST uint16_t *P##y, CONST uint16_t *P##uv, uint32_t P##y_stride, uint32_t P##uv_stride
+#define P016_JOB(SIDE, P) .SIDE={(const uint8_t *)P##y, (const uint8_t *)P##uv, NULL, NULL}, \
+	.SIDE##_stride={P##y_stride, P##uv_stride}
+#define P016_BAND(SIDE) (const uint16_t *)(job->SIDE[0]+y_begin*job->SIDE##_stride[0]), \
+	(const uint16_t *)(job->SIDE[1]+(y_begin/2)*job->SIDE##_stride[1]), job->SIDE##_stride[0], job->SIDE##_stride[1]
+
+// planar 4:2:2 and 4:4:4 formats (yuv422p and yuv444p), and semi planar ones (nv16 and nv24), which have a chroma
+// line for each line
+#define YUV_FULL_PARAM(CONST, P) YUV420_PARAM(CONST, P)
+#define YUV_FULL_JOB(SIDE, P) YUV420_JOB(SIDE, P)
+#define YUV_FULL_BAND(SIDE) job->SIDE[0]+y_begin*job->SIDE##_stride[0], job->SIDE[1]+y_begin*job->SIDE##_stride[1], \
+	job->SIDE[2]+y_begin*job->SIDE##_stride[1], job->SIDE##_stride[0], job->SIDE##_stride[1]
+#define YUV_FULL_OUTPUT(P) ((uint64_t)(P##y_stride+2*P##uv_stride)*height)
+
+#define NV_FULL_PARAM(CONST, P) NV12_PARAM(CONST, P)
+#define NV_FULL_JOB(SIDE, P) NV12_JOB(SIDE, P)
+#define NV_FULL_BAND(SIDE) job->SIDE[0]+y_begin*job->SIDE##_stride[0], job->SIDE[1]+y_begin*job->SIDE##_stride[1], \
+	job->SIDE##_stride[0], job->SIDE##_stride[1]
+#define NV_FULL_OUTPUT(P) ((uint64_t)(P##y_stride+P##uv_stride)*height)
+
+// single plane formats: packed rgb, yuyv and uyvy
+#define PACKED_PARAM(CONST, P) CONST uint8_t *P##data, uint32_t P##stride
+#define PACKED_JOB(SIDE, P) .SIDE={P##data, NULL, NULL, NULL}, .SIDE##_stride={P##stride, 0}
+#define PACKED_BAND(SIDE) job->SIDE[0]+y_begin*job->SIDE##_stride[0], job->SIDE##_stride[0]
+#define PACKED_OUTPUT(P) ((uint64_t)P##stride*height)
+
+// planar rgb destinations of TYPE samples
+#define PLANAR_PARAM(TYPE, P) TYPE *P##r, TYPE *P##g, TYPE *P##b, uint32_t P##rgb_stride
+#define PLANAR_JOB(SIDE, P) .SIDE={(uint8_t *)P##r, (uint8_t *)P##g, (uint8_t *)P##b, NULL}, \
+	.SIDE##_stride={P##rgb_stride, 0}
+#define PLANAR_BAND(SIDE, TYPE) (TYPE *)(job->SIDE[0]+y_begin*job->SIDE##_stride[0]), \
+	(TYPE *)(job->SIDE[1]+y_begin*job->SIDE##_stride[0]), (TYPE *)(job->SIDE[2]+y_begin*job->SIDE##_stride[0]), \
+	job->SIDE##_stride[0]
+#define PLANAR_OUTPUT(P) (3*(uint64_t)P##rgb_stride*height)
+#define PLANAR_U8_PARAM(CONST, P) PLANAR_PARAM(uint8_t, P)
+#define PLANAR_U8_JOB PLANAR_JOB
+#define PLANAR_U8_BAND(SIDE) PLANAR_BAND(SIDE, uint8_t)
+#define PLANAR_U8_OUTPUT PLANAR_OUTPUT
+#define PLANAR_F32_PARAM(CONST, P) PLANAR_PARAM(float, P)
+#define PLANAR_F32_JOB PLANAR_JOB
+#define PLANAR_F32_BAND(SIDE) PLANAR_BAND(SIDE, float)
+#define PLANAR_F32_OUTPUT PLANAR_OUTPUT
+#define PLANAR_F16_PARAM(CONST, P) PLANAR_PARAM(uint16_t, P)
+#define PLANAR_F16_JOB PLANAR_JOB
+#define PLANAR_F16_BAND(SIDE) PLANAR_BAND(SIDE, uint16_t)
+#define PLANAR_F16_OUTPUT PLANAR_OUTPUT
+
+// yuva420, the alpha plane using the y stride, and being optional for destinations
+#define YUVA420_PARAM(CONST, P) CONST uint8_t *P##y, CONST uint8_t *P##u, CONST uint8_t *P##v, CONST uint8_t *P##a, \
+	uint32_t P##y_stride, uint32_t P##uv_stride
+#define YUVA420_JOB(SIDE, P) .SIDE={P##y, P##u, P##v, P##a}, .SIDE##_stride={P##y_stride, P##uv_stride}
+#define YUVA420_BAND(SIDE) job->SIDE[0]+y_begin*job->SIDE##_stride[0], \
+	job->SIDE[1]+(y_begin/2)*job->SIDE##_stride[1], job->SIDE[2]+(y_begin/2)*job->SIDE##_stride[1], \
+	job->SIDE[3] ? job->SIDE[3]+y_begin*job->SIDE##_stride[0] : NULL, job->SIDE##_stride[0], job->SIDE##_stride[1]
+#define YUVA420_OUTPUT(P) (YUV420_OUTPUT(P) + (P##a ? (uint64_t)P##y_stride*height : 0))
+
+// the other arguments, following the planes: TAIL_PARAM (with a leading comma), TAIL_JOB and TAIL_BAND (with a
+// trailing comma)
+#define TYPE_PARAM , YCbCrType yuv_type
+#define TYPE_JOB .yuv_type=yuv_type,
+#define TYPE_BAND job->yuv_type,
+#define NORM_PARAM , const RGBNormalization *norm, YCbCrType yuv_type
+#define NORM_JOB .norm=norm, .yuv_type=yuv_type,
+#define NORM_BAND job->norm, job->yuv_type,
+#define PREMULTIPLIED_PARAM , int premultiplied, YCbCrType yuv_type
+#define PREMULTIPLIED_JOB .premultiplied=premultiplied, .yuv_type=yuv_type,
+#define PREMULTIPLIED_BAND job->premultiplied, job->yuv_type,
+// direct yuv conversions, which have no color space
+#define NONE_PARAM
+#define NONE_JOB
+#define NONE_BAND
+
+// MT_FUNCTION(NAME, SRC, DST, TAIL) defines NAME_mt, converting the bands of the image with NAME_policy and the
+// store policy decided from the whole output
+#define MT_FUNCTION(NAME, SRC, DST, TAIL) \
+static void NAME##_band(const Job *job, uint32_t y_begin, uint32_t y_end) \
+{ \
+	NAME##_policy(job->width, y_end-y_begin, SRC##_BAND(src), DST##_BAND(dst), TAIL##_BAND job->store_policy); \
+} \
+\
+void NAME##_mt(yuv_rgb_pool *pool, \
+	uint32_t width, uint32_t height, \
+	SRC##_PARAM(const, src_), \
+	DST##_PARAM(, dst_) TAIL##_PARAM) \
+{ \
+	const Job job = {.convert=NAME##_band, .item_number=height, .item_step=2, .width=width, .height=height, \
+		SRC##_JOB(src, src_), DST##_JOB(dst, dst_), TAIL##_JOB \
+		.store_policy=yuv_rgb_output_store_policy(DST##_OUTPUT(dst_))}; \
+	run_job(pool, &job, yuv_rgb_pool_thread_number(pool)+1); \
+}
+
+#define FORMAT_MT(FORMAT) \
+	MT_FUNCTION(yuv420_##FORMAT, YUV420, PACKED, TYPE) \
+	MT_FUNCTION(nv12_##FORMAT, NV12, PACKED, TYPE) \
+	MT_FUNCTION(nv21_##FORMAT, NV12, PACKED, TYPE)
+
+FORMAT_MT(rgb24)
+FORMAT_MT(rgb32)
+FORMAT_MT(bgra)
+FORMAT_MT(argb)
+FORMAT_MT(bgr24)
+FORMAT_MT(rgb565)
+MT_FUNCTION(rgb24_yuv420, PACKED, YUV420, TYPE)
+MT_FUNCTION(rgb32_yuv420, PACKED, YUV420, TYPE)
+
+#define PLANAR_MT(FORMAT, LAYOUT, TAIL) \
+	MT_FUNCTION(yuv420_##FORMAT, YUV420, LAYOUT, TAIL) \
+	MT_FUNCTION(nv12_##FORMAT, NV12, LAYOUT, TAIL) \
+	MT_FUNCTION(nv21_##FORMAT, NV12, LAYOUT, TAIL)
+
+PLANAR_MT(rgb_planar, PLANAR_U8, TYPE)
+PLANAR_MT(rgb_planar_f32, PLANAR_F32, NORM)
+PLANAR_MT(rgb_planar_f16, PLANAR_F16, NORM)
+
+#define YUV16_MT(FORMAT) \
+	MT_FUNCTION(yuv420p10_##FORMAT, YUV420P16, PACKED, TYPE) \
+	MT_FUNCTION(p010_##FORMAT, P016, PACKED, TYPE)
+
+YUV16_MT(rgb24)
+YUV16_MT(rgb48)
+YUV16_MT(x2rgb10)
+
+#define YUV_LINES_MT(FORMAT) \
+	MT_FUNCTION(yuv422p_##FORMAT, YUV_FULL, PACKED, TYPE) \
+	MT_FUNCTION(yuv444p_##FORMAT, YUV_FULL, PACKED, TYPE) \
+	MT_FUNCTION(nv16_##FORMAT, NV_FULL, PACKED, TYPE) \
+	MT_FUNCTION(nv24_##FORMAT, NV_FULL, PACKED, TYPE) \
+	MT_FUNCTION(yuyv_##FORMAT, PACKED, PACKED, TYPE) \
+	MT_FUNCTION(uyvy_##FORMAT, PACKED, PACKED, TYPE) \
+	MT_FUNCTION(FORMAT##_yuv422p, PACKED, YUV_FULL, TYPE) \
+	MT_FUNCTION(FORMAT##_yuv444p, PACKED, YUV_FULL, TYPE) \
+	MT_FUNCTION(FORMAT##_nv16, PACKED, NV_FULL, TYPE) \
+	MT_FUNCTION(FORMAT##_nv24, PACKED, NV_FULL, TYPE) \
+	MT_FUNCTION(FORMAT##_yuyv, PACKED, PACKED, TYPE) \
+	MT_FUNCTION(FORMAT##_uyvy, PACKED, PACKED, TYPE)
+
+YUV_LINES_MT(rgb24)
+YUV_LINES_MT(rgb32)
+
+MT_FUNCTION(nv12_yuv420, NV12, YUV420, NONE)
+MT_FUNCTION(nv21_yuv420, NV12, YUV420, NONE)
+MT_FUNCTION(yuv420_nv12, YUV420, NV12, NONE)
+MT_FUNCTION(yuv420_nv21, YUV420, NV12, NONE)
+MT_FUNCTION(yuyv_yuv420, PACKED, YUV420, NONE)
+MT_FUNCTION(uyvy_yuv420, PACKED, YUV420, NONE)
+MT_FUNCTION(yuyv_nv12, PACKED, NV12, NONE)
+MT_FUNCTION(uyvy_nv12, PACKED, NV12, NONE)
+MT_FUNCTION(yuv420_yuyv, YUV420, PACKED, NONE)
+MT_FUNCTION(yuv420_uyvy, YUV420, PACKED, NONE)
+MT_FUNCTION(nv12_yuyv, NV12, PACKED, NONE)
+MT_FUNCTION(nv12_uyvy, NV12, PACKED, NONE)
+
+MT_FUNCTION(rgb24_yuv420_precise, PACKED, YUV420, TYPE)
+MT_FUNCTION(rgb32_yuv420_precise, PACKED, YUV420, TYPE)
+
+MT_FUNCTION(rgb32_yuva420, PACKED, YUVA420, PREMULTIPLIED)
+MT_FUNCTION(yuva420_rgb32, YUVA420, PACKED, TYPE)
+MT_FUNCTION(yuva420_bgra_premultiplied, YUVA420, PACKED, TYPE)
+
+
+// batch conversions, each band being a frame, OUTPUT being the output size of a frame for the store policy
+#define BATCH_FUNCTION(NAME, FRAME_TYPE, ARGS, OUTPUT) \
+static void NAME##_batch_band(const Job *job, uint32_t begin, uint32_t end) \
+{ \
+	for(uint32_t i=begin; i<end; ++i) \
+	{ \
+		const FRAME_TYPE *const frame = ((const FRAME_TYPE *)job->frames)+i; \
+		NAME##_policy ARGS; \
+	} \
+} \
+\
+void NAME##_batch(yuv_rgb_pool *pool, const FRAME_TYPE *frames, uint32_t frame_number) \
+{ \
+	uint64_t output = 0; \
+	for(uint32_t i=0; i<frame_number; ++i) \
+	{ \
+		const FRAME_TYPE *const frame = frames+i; \
+		output += OUTPUT; \
+	} \
+	const Job job = {.convert=NAME##_batch_band, .item_number=frame_number, .item_step=1, \
+		.store_policy=yuv_rgb_output_store_policy(output), .frames=frames}; \
+	run_job(pool, &job, frame_number); \
+}
+
+#define YUV2RGB_FRAME_ARGS \
+	(frame->width, frame->height, frame->y, frame->u, frame->v, frame->y_stride, frame->uv_stride, \
+	frame->rgb, frame->rgb_stride, frame->yuv_type, job->store_policy)
+
+#define RGB2YUV_FRAME_ARGS \
+	(frame->width, frame->height, frame->rgb, frame->rgb_stride, frame->y, frame->u, frame->v, \
+	frame->y_stride, frame->uv_stride, frame->yuv_type, job->store_policy)
+
+#define YUV2RGB_FRAME_OUTPUT ((uint64_t)frame->rgb_stride*frame->height)
+#define RGB2YUV_FRAME_OUTPUT ((uint64_t)frame->y_stride*frame->height + (uint64_t)frame->uv_stride*(frame->height+1))
+
+BATCH_FUNCTION(yuv420_rgb24, YUV2RGBFrame, YUV2RGB_FRAME_ARGS, YUV2RGB_FRAME_OUTPUT)
+BATCH_FUNCTION(rgb24_yuv420, RGB2YUVFrame, RGB2YUV_FRAME_ARGS, RGB2YUV_FRAME_OUTPUT)
+BATCH_FUNCTION(rgb32_yuv420, RGB2YUVFrame, RGB2YUV_FRAME_ARGS, RGB2YUV_FRAME_OUTPUT)
@@ -0,0 +1,85 @@
+// Copyright 2016 Adrien Descamps
+// Distributed under BSD 3-Clause License
+
+// Conversions of rectangles of an image (see yuv_rgb.h)
+//
+// Each rectangle is snapped with yuv_rgb_rect_snap, and converted by calling the fastest implementation
+// (rgb24_yuv420, ...) on the sub image it covers, with pointers offset to its first pixel and the strides of the whole
+// image. As the conversion of each pixel (or 2x2 block of pixels for the chroma) does not depend on its neighbours,
+// the result is the same as the conversion of the whole image.
+
+#include "yuv_rgb.h"
+#include "yuv_rgb_internal.h"
+
+#include <stddef.h>
+
+int yuv_rgb_rect_snap(const YUVRGBRect *rect, uint32_t width, uint32_t height, YUVRGBRect *snapped)
+{
+	uint64_t x1 = (uint64_t)rect->x+rect->width, y1 = (uint64_t)rect->y+rect->height;
+	// horizontal alignment of the rectangles, in pixels: the block size of the widest implementation selected on this
+	// cpu, so that the rectangles are converted by whole blocks, and keep the alignment of the image lines required by
+	// its aligned version
+	const uint32_t align = yuv_rgb_block_width();
+	uint32_t x0, y0;
+	if(rect->width==0 || rect->height==0 || rect->x>=width || rect->y>=height)
+	{
+		snapped->x = snapped->y = snapped->width = snapped->height = 0;
+		return 0;
+	}
+
+	x0 = rect->x - rect->x%align;
+	y0 = rect->y - rect->y%2;
+	x1 = (x1+align-1)/align*align;
+	y1 = (y1+1)/2*2;
+	if(x1>width)
+		x1 = width;
+	if(y1>height)
+		y1 = height;
+
+	snapped->x = x0;
+	snapped->y = y0;
+	snapped->width = (uint32_t)x1-x0;
+	snapped->height = (uint32_t)y1-y0;
+	return 1;
+}
+
+// RECTS_FUNCTIONS(FORMAT, BPP) defines the conversions of rectangles to and from FORMAT
+#define RECTS_FUNCTIONS(FORMAT, BPP) \
+void yuv420_##FORMAT##_rects( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *Y, const uint8_t *U, const uint8_t *V, uint32_t Y_stride, uint32_t UV_stride, \
+	uint8_t *RGB, uint32_t RGB_stride, \
+	YCbCrType yuv_type, const YUVRGBRect *rects, uint32_t rect_number) \
+{ \
+	uint32_t i; \
+	for(i=0; i<rect_number; ++i) \
+	{ \
+		YUVRGBRect r; \
+		if(!yuv_rgb_rect_snap(&rects[i], width, height, &r)) \
+			continue; \
+		yuv420_##FORMAT(r.width, r.height, Y+r.y*(size_t)Y_stride+r.x, U+(r.y/2)*(size_t)UV_stride+r.x/2, \
+			V+(r.y/2)*(size_t)UV_stride+r.x/2, Y_stride, UV_stride, RGB+r.y*(size_t)RGB_stride+r.x*BPP, RGB_stride, \
+			yuv_type); \
+	} \
+} \
+\
+void FORMAT##_yuv420_rects( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *RGB, uint32_t RGB_stride, \
+	uint8_t *Y, uint8_t *U, uint8_t *V, uint32_t Y_stride, uint32_t UV_stride, \
+	YCbCrType yuv_type, const YUVRGBRect *rects, uint32_t rect_number) \
+{ \
+	uint32_t i; \
+	for(i=0; i<rect_number; ++i) \
+	{ \
+		YUVRGBRect r; \
+		if(!yuv_rgb_rect_snap(&rects[i], width, height, &r)) \
+			continue; \
+		FORMAT##_yuv420(r.width, r.height, RGB+r.y*(size_t)RGB_stride+r.x*BPP, RGB_stride, \
+			Y+r.y*(size_t)Y_stride+r.x, U+(r.y/2)*(size_t)UV_stride+r.x/2, V+(r.y/2)*(size_t)UV_stride+r.x/2, \
+			Y_stride, UV_stride, yuv_type); \
+	} \
+}
+
+RECTS_FUNCTIONS(rgb24, 3)
+RECTS_FUNCTIONS(rgb32, 4)
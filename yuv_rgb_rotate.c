@@ -0,0 +1,266 @@
+// Copyright 2016 Adrien Descamps
+// Distributed under BSD 3-Clause License
+
+// Conversions with rotation and flip (see yuv_rgb.h)
+//
+// The image is converted by tiles of TILE_SIZE x TILE_SIZE pixels, through a small rgb buffer that stays in cache:
+// for yuv to rgb, each source tile is converted into the buffer with the fastest implementation (yuv420_rgb24, ...),
+// and then copied to its rotated position in the destination, while for rgb to yuv, the source pixels of each
+// destination tile are copied rotated into the buffer, which is then converted. The column-wise accesses of the
+// rotation are thus limited to the TILE_SIZE lines of a tile, instead of all the lines of the image as in a separate
+// rotation pass.
+// The tiles start at even positions of the yuv image, so that the chroma samples of each 2x2 block of pixels are in a
+// single tile, and the result is the same as the conversion of the whole image followed by its rotation.
+
+#include "yuv_rgb.h"
+#include "yuv_rgb_internal.h"
+
+#include <stddef.h>
+
+// large enough for the 64 pixels blocks of the avx2 implementations, small enough for the buffer and the rotated
+// lines of a tile to stay in the l1 cache
+#define TILE_SIZE 64
+
+// position in the destination of the pixel (x, y) of the source: (x0 + xx*x + xy*y, y0 + yx*x + yy*y)
+typedef struct
+{
+	int64_t x0, xx, xy, y0, yx, yy;
+} Orientation;
+
+// orientation of a width x height source, mirrored horizontally if flip, and then rotated clockwise
+static Orientation orientation(uint32_t width, uint32_t height, YUVRGBRotation rotation, int flip)
+{
+	const int64_t w = (int64_t)width-1, h = (int64_t)height-1;
+	Orientation o;
+	switch(rotation)
+	{
+		case YUVRGB_ROTATE_90:
+			// (h-y, x)
+			o.x0=h; o.xx=0; o.xy=-1; o.y0=0; o.yx=1; o.yy=0;
+			break;
+		case YUVRGB_ROTATE_180:
+			// (w-x, h-y)
+			o.x0=w; o.xx=-1; o.xy=0; o.y0=h; o.yx=0; o.yy=-1;
+			break;
+		case YUVRGB_ROTATE_270:
+			// (y, w-x)
+			o.x0=0; o.xx=0; o.xy=1; o.y0=w; o.yx=-1; o.yy=0;
+			break;
+		default:
+			o.x0=0; o.xx=1; o.xy=0; o.y0=0; o.yx=0; o.yy=1;
+			break;
+	}
+	if(flip)
+	{
+		// x replaced by w-x
+		o.x0 += o.xx*w;
+		o.xx = -o.xx;
+		o.y0 += o.yx*w;
+		o.yx = -o.yx;
+	}
+	return o;
+}
+
+// copy the width x height pixels of bpp bytes starting at the pixel (x, y) of the source, which is at src, to their
+// rotated positions in dst, which is the pixel (dst_x, dst_y) of the destination
+static void copy_tile(const Orientation *o, uint32_t bpp, uint32_t x, uint32_t y, uint32_t width, uint32_t height,
+	const uint8_t *src, uint32_t src_stride, uint32_t dst_x, uint32_t dst_y, uint8_t *dst, uint32_t dst_stride)
+{
+	// offset in dst of the first pixel, and offset steps for the next pixel of a line and the next line of the source
+	const ptrdiff_t pixel = bpp, line = dst_stride,
+		first = (ptrdiff_t)(o->x0 + o->xx*x + o->xy*y - dst_x)*pixel + (ptrdiff_t)(o->y0 + o->yx*x + o->yy*y - dst_y)*line,
+		step_x = (ptrdiff_t)o->xx*pixel + (ptrdiff_t)o->yx*line,
+		step_y = (ptrdiff_t)o->xy*pixel + (ptrdiff_t)o->yy*line;
+	uint32_t i, j;
+	for(j=0; j<height; ++j)
+	{
+		const uint8_t *src_ptr = src+j*(size_t)src_stride;
+		ptrdiff_t offset = first+(ptrdiff_t)j*step_y;
+		if(bpp==3)
+			for(i=0; i<width; ++i, src_ptr+=3, offset+=step_x)
+			{
+				dst[offset] = src_ptr[0];
+				dst[offset+1] = src_ptr[1];
+				dst[offset+2] = src_ptr[2];
+			}
+		else
+			for(i=0; i<width; ++i, src_ptr+=4, offset+=step_x)
+			{
+				dst[offset] = src_ptr[0];
+				dst[offset+1] = src_ptr[1];
+				dst[offset+2] = src_ptr[2];
+				dst[offset+3] = src_ptr[3];
+			}
+	}
+}
+
+// yuv source image, and function converting its width x height pixels starting at the pixel (x, y) (x and y even)
+typedef struct Source
+{
+	void (*convert)(const struct Source *source, uint32_t x, uint32_t y, uint32_t width, uint32_t height,
+		uint8_t *rgb, uint32_t rgb_stride);
+	const uint8_t *y, *u, *v;
+	uint32_t y_stride, uv_stride;
+	YCbCrType yuv_type;
+} Source;
+
+static void rotate_yuv_rgb(const Source *source, uint32_t width, uint32_t height, uint32_t bpp,
+	uint8_t *RGB, uint32_t RGB_stride, YUVRGBRotation rotation, int flip)
+{
+	uint8_t tile[TILE_SIZE*4*TILE_SIZE];
+	const uint32_t tile_stride = bpp*TILE_SIZE;
+	const Orientation o = orientation(width, height, rotation, flip);
+	uint32_t x, y;
+	for(y=0; y<height; y+=TILE_SIZE)
+	{
+		const uint32_t tile_height = (height-y)<TILE_SIZE ? height-y : TILE_SIZE;
+		for(x=0; x<width; x+=TILE_SIZE)
+		{
+			const uint32_t tile_width = (width-x)<TILE_SIZE ? width-x : TILE_SIZE;
+			source->convert(source, x, y, tile_width, tile_height, tile, tile_stride);
+			copy_tile(&o, bpp, x, y, tile_width, tile_height, tile, tile_stride, 0, 0, RGB, RGB_stride);
+		}
+	}
+}
+
+// yuv destination image, and function converting the width x height pixels of rgb to its pixels starting at (x, y)
+// (x and y even)
+typedef struct Destination
+{
+	void (*convert)(const struct Destination *destination, uint32_t x, uint32_t y, uint32_t width, uint32_t height,
+		const uint8_t *rgb, uint32_t rgb_stride);
+	uint8_t *y, *u, *v;
+	uint32_t y_stride, uv_stride;
+	YCbCrType yuv_type;
+} Destination;
+
+static void rotate_rgb_yuv(const Destination *destination, uint32_t width, uint32_t height, uint32_t bpp,
+	const uint8_t *RGB, uint32_t RGB_stride, YUVRGBRotation rotation, int flip)
+{
+	uint8_t tile[TILE_SIZE*4*TILE_SIZE];
+	const uint32_t tile_stride = bpp*TILE_SIZE;
+	const Orientation o = orientation(width, height, rotation, flip);
+	const int transposed = rotation==YUVRGB_ROTATE_90 || rotation==YUVRGB_ROTATE_270;
+	const uint32_t dst_width = transposed ? height : width, dst_height = transposed ? width : height;
+	uint32_t x, y;
+	for(y=0; y<dst_height; y+=TILE_SIZE)
+	{
+		const uint32_t tile_height = (dst_height-y)<TILE_SIZE ? dst_height-y : TILE_SIZE;
+		for(x=0; x<dst_width; x+=TILE_SIZE)
+		{
+			const uint32_t tile_width = (dst_width-x)<TILE_SIZE ? dst_width-x : TILE_SIZE;
+			// source rectangle of the tile, from the source positions of two opposite corners (the inverse of the
+			// orientation being its transpose)
+			const int64_t dx1 = x-o.x0, dy1 = y-o.y0, dx2 = dx1+tile_width-1, dy2 = dy1+tile_height-1,
+				sx1 = o.xx*dx1 + o.yx*dy1, sy1 = o.xy*dx1 + o.yy*dy1,
+				sx2 = o.xx*dx2 + o.yx*dy2, sy2 = o.xy*dx2 + o.yy*dy2;
+			const uint32_t sx = (uint32_t)(sx1<sx2 ? sx1 : sx2), sy = (uint32_t)(sy1<sy2 ? sy1 : sy2),
+				s_width = transposed ? tile_height : tile_width, s_height = transposed ? tile_width : tile_height;
+			copy_tile(&o, bpp, sx, sy, s_width, s_height, RGB+sy*(size_t)RGB_stride+sx*bpp, RGB_stride,
+				x, y, tile, tile_stride);
+			destination->convert(destination, x, y, tile_width, tile_height, tile, tile_stride);
+		}
+	}
+}
+
+// conversion of the tiles to and from the rgb format FORMAT, with regular stores: the tile buffer is read right after
+// its conversion, and the lines of the destination tiles are too short for streaming stores
+#define CONVERT_TILE_FUNCTIONS(FORMAT) \
+static void convert_yuv420_##FORMAT(const Source *source, uint32_t x, uint32_t y, uint32_t width, uint32_t height, \
+	uint8_t *rgb, uint32_t rgb_stride) \
+{ \
+	yuv420_##FORMAT##_policy(width, height, source->y+y*source->y_stride+x, source->u+(y/2)*source->uv_stride+x/2, \
+		source->v+(y/2)*source->uv_stride+x/2, source->y_stride, source->uv_stride, rgb, rgb_stride, \
+		source->yuv_type, YUVRGB_STORE_CACHED); \
+} \
+\
+static void convert_nv12_##FORMAT(const Source *source, uint32_t x, uint32_t y, uint32_t width, uint32_t height, \
+	uint8_t *rgb, uint32_t rgb_stride) \
+{ \
+	nv12_##FORMAT##_policy(width, height, source->y+y*source->y_stride+x, source->u+(y/2)*source->uv_stride+x, \
+		source->y_stride, source->uv_stride, rgb, rgb_stride, source->yuv_type, YUVRGB_STORE_CACHED); \
+} \
+\
+static void convert_nv21_##FORMAT(const Source *source, uint32_t x, uint32_t y, uint32_t width, uint32_t height, \
+	uint8_t *rgb, uint32_t rgb_stride) \
+{ \
+	nv21_##FORMAT##_policy(width, height, source->y+y*source->y_stride+x, source->u+(y/2)*source->uv_stride+x, \
+		source->y_stride, source->uv_stride, rgb, rgb_stride, source->yuv_type, YUVRGB_STORE_CACHED); \
+} \
+\
+static void convert_##FORMAT##_yuv420(const Destination *destination, uint32_t x, uint32_t y, uint32_t width, \
+	uint32_t height, const uint8_t *rgb, uint32_t rgb_stride) \
+{ \
+	FORMAT##_yuv420_policy(width, height, rgb, rgb_stride, destination->y+y*destination->y_stride+x, \
+		destination->u+(y/2)*destination->uv_stride+x/2, destination->v+(y/2)*destination->uv_stride+x/2, \
+		destination->y_stride, destination->uv_stride, destination->yuv_type, YUVRGB_STORE_CACHED); \
+}
+
+CONVERT_TILE_FUNCTIONS(rgb24)
+CONVERT_TILE_FUNCTIONS(rgb32)
+
+// ROTATE_FUNCTIONS(FORMAT, BPP) defines the rotated conversions to and from FORMAT, the images without rotation
+// being converted directly
+#define ROTATE_FUNCTIONS(FORMAT, BPP) \
+void yuv420_##FORMAT##_rotate( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *Y, const uint8_t *U, const uint8_t *V, uint32_t Y_stride, uint32_t UV_stride, \
+	uint8_t *RGB, uint32_t RGB_stride, \
+	YCbCrType yuv_type, YUVRGBRotation rotation, int flip) \
+{ \
+	if(rotation==YUVRGB_ROTATE_0 && !flip) \
+	{ \
+		yuv420_##FORMAT(width, height, Y, U, V, Y_stride, UV_stride, RGB, RGB_stride, yuv_type); \
+		return; \
+	} \
+	const Source source = {convert_yuv420_##FORMAT, Y, U, V, Y_stride, UV_stride, yuv_type}; \
+	rotate_yuv_rgb(&source, width, height, BPP, RGB, RGB_stride, rotation, flip); \
+} \
+\
+void nv12_##FORMAT##_rotate( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *Y, const uint8_t *UV, uint32_t Y_stride, uint32_t UV_stride, \
+	uint8_t *RGB, uint32_t RGB_stride, \
+	YCbCrType yuv_type, YUVRGBRotation rotation, int flip) \
+{ \
+	if(rotation==YUVRGB_ROTATE_0 && !flip) \
+	{ \
+		nv12_##FORMAT(width, height, Y, UV, Y_stride, UV_stride, RGB, RGB_stride, yuv_type); \
+		return; \
+	} \
+	const Source source = {convert_nv12_##FORMAT, Y, UV, NULL, Y_stride, UV_stride, yuv_type}; \
+	rotate_yuv_rgb(&source, width, height, BPP, RGB, RGB_stride, rotation, flip); \
+} \
+\
+void nv21_##FORMAT##_rotate( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *Y, const uint8_t *UV, uint32_t Y_stride, uint32_t UV_stride, \
+	uint8_t *RGB, uint32_t RGB_stride, \
+	YCbCrType yuv_type, YUVRGBRotation rotation, int flip) \
+{ \
+	if(rotation==YUVRGB_ROTATE_0 && !flip) \
+	{ \
+		nv21_##FORMAT(width, height, Y, UV, Y_stride, UV_stride, RGB, RGB_stride, yuv_type); \
+		return; \
+	} \
+	const Source source = {convert_nv21_##FORMAT, Y, UV, NULL, Y_stride, UV_stride, yuv_type}; \
+	rotate_yuv_rgb(&source, width, height, BPP, RGB, RGB_stride, rotation, flip); \
+} \
+\
+void FORMAT##_yuv420_rotate( \
+	uint32_t width, uint32_t height, \
+	const uint8_t *RGB, uint32_t RGB_stride, \
+	uint8_t *Y, uint8_t *U, uint8_t *V, uint32_t Y_stride, uint32_t UV_stride, \
+	YCbCrType yuv_type, YUVRGBRotation rotation, int flip) \
+{ \
+	if(rotation==YUVRGB_ROTATE_0 && !flip) \
+	{ \
+		FORMAT##_yuv420(width, height, RGB, RGB_stride, Y, U, V, Y_stride, UV_stride, yuv_type); \
+		return; \
+	} \
+	const Destination destination = {convert_##FORMAT##_yuv420, Y, U, V, Y_stride, UV_stride, yuv_type}; \
+	rotate_rgb_yuv(&destination, width, height, BPP, RGB, RGB_stride, rotation, flip); \
+}
+
+ROTATE_FUNCTIONS(rgb24, 3)
+ROTATE_FUNCTIONS(rgb32, 4)
@@ -0,0 +1,290 @@
+// Copyright 2016 Adrien Descamps
+// Distributed under BSD 3-Clause License
+
+// Conversions with downscaling (see yuv_rgb.h)
+//
+// The source image is converted by pairs of lines with the fastest implementation (yuv420_rgb24, ...) into a small
+// ring of two converted pairs, and each destination line is computed from the converted lines it needs, so that the
+// full size rgb image is never stored. Source lines that are not used by any destination line (bilinear filter with
+// large ratios) are not converted at all.
+// The filter tables (first source column and weights of each destination column) are computed once when the scaler
+// is created, so that no allocation is done per conversion.
+
+#include "yuv_rgb.h"
+#include "yuv_rgb_internal.h"
+
+#include <stdlib.h>
+
+struct yuv_rgb_scaler
+{
+	uint32_t width, height, dst_width, dst_height;
+	ScaleFilter filter;
+	// ring of two converted pairs of source lines, pair[i] being the index of the pair stored in slot i
+	uint8_t *lines;
+	uint32_t line_stride;
+	uint32_t pair[2];
+	// for each destination column, offset of the first source pixel (in bytes), and either the number of source
+	// pixels (box filter) or the offset of the second source pixel and its 8 bits weight (bilinear filter)
+	uint32_t *x_offset, *x_size, *x_offset2, *x_weight;
+	// minimum number of source pixels of the destination columns (box filter)
+	uint32_t x_min;
+	// vertical sums of the source lines of the current destination line (box filter)
+	uint32_t *sums;
+};
+
+#define NO_PAIR UINT32_MAX
+
+// 8 bits fixed point position of the center of destination pixel i in the source, for a size to dst_size scaling
+// return the first source pixel and the weight of the second one, which is last if it is outside the source
+static void bilinear_position(uint32_t i, uint32_t size, uint32_t dst_size, uint32_t *first, uint32_t *second,
+	uint32_t *weight)
+{
+	const int64_t position = (((2*(int64_t)i+1)*size)<<8)/(2*(int64_t)dst_size) - 128;
+	if(position<=0)
+	{
+		*first = *second = 0;
+		*weight = 0;
+	}
+	else
+	{
+		*first = (uint32_t)(position>>8);
+		*weight = (uint32_t)(position&255);
+		if(*first>=size-1)
+		{
+			*first = size-1;
+			*weight = 0;
+		}
+		*second = *first+(*weight!=0);
+	}
+}
+
+yuv_rgb_scaler *yuv_rgb_scaler_create(uint32_t width, uint32_t height, uint32_t dst_width, uint32_t dst_height,
+	ScaleFilter filter)
+{
+	if(width==0 || height==0 || dst_width==0 || dst_height==0 ||
+		(filter==SCALE_BOX && (dst_width>width || dst_height>height)) ||
+		(filter!=SCALE_BOX && filter!=SCALE_BILINEAR))
+		return NULL;
+
+	yuv_rgb_scaler *scaler = calloc(1, sizeof(yuv_rgb_scaler));
+	if(!scaler)
+		return NULL;
+
+	scaler->width = width;
+	scaler->height = height;
+	scaler->dst_width = dst_width;
+	scaler->dst_height = dst_height;
+	scaler->filter = filter;
+	scaler->x_min = width/dst_width;
+
+	scaler->line_stride = 3*width;
+	scaler->lines = malloc(4*(size_t)scaler->line_stride);
+	scaler->x_offset = malloc(dst_width*sizeof(uint32_t));
+	scaler->x_size = malloc(dst_width*sizeof(uint32_t));
+	scaler->x_offset2 = malloc(dst_width*sizeof(uint32_t));
+	scaler->x_weight = malloc(dst_width*sizeof(uint32_t));
+	scaler->sums = malloc(3*(size_t)width*sizeof(uint32_t));
+	if(!scaler->lines || !scaler->x_offset || !scaler->x_size || !scaler->x_offset2 || !scaler->x_weight ||
+		!scaler->sums)
+	{
+		yuv_rgb_scaler_destroy(scaler);
+		return NULL;
+	}
+
+	uint32_t x;
+	for(x=0; x<dst_width; ++x)
+	{
+		if(filter==SCALE_BOX)
+		{
+			const uint32_t begin = (uint32_t)(((uint64_t)x*width)/dst_width),
+				end = (uint32_t)(((uint64_t)(x+1)*width)/dst_width);
+			scaler->x_offset[x] = 3*begin;
+			scaler->x_size[x] = end-begin;
+		}
+		else
+		{
+			uint32_t first, second, weight;
+			bilinear_position(x, width, dst_width, &first, &second, &weight);
+			scaler->x_offset[x] = 3*first;
+			scaler->x_offset2[x] = 3*second;
+			scaler->x_weight[x] = weight;
+		}
+	}
+	return scaler;
+}
+
+void yuv_rgb_scaler_destroy(yuv_rgb_scaler *scaler)
+{
+	if(!scaler)
+		return;
+	free(scaler->lines);
+	free(scaler->x_offset);
+	free(scaler->x_size);
+	free(scaler->x_offset2);
+	free(scaler->x_weight);
+	free(scaler->sums);
+	free(scaler);
+}
+
+// source image, and function converting its line_number (1 or 2) lines starting at line y (even)
+typedef struct Source
+{
+	void (*convert)(const struct Source *source, uint32_t y, uint32_t line_number, uint8_t *rgb, uint32_t rgb_stride);
+	uint32_t width;
+	const uint8_t *y, *u, *v;
+	uint32_t y_stride, uv_stride;
+	YCbCrType yuv_type;
+} Source;
+
+// return converted line y of the source, converting its pair of lines if it is not in the ring
+static const uint8_t *source_line(yuv_rgb_scaler *scaler, const Source *source, uint32_t y)
+{
+	const uint32_t pair = y/2, slot = pair%2;
+	uint8_t *lines = scaler->lines+2*slot*(size_t)scaler->line_stride;
+	if(scaler->pair[slot]!=pair)
+	{
+		const uint32_t line_number = (2*pair+1)<scaler->height ? 2 : 1;
+		source->convert(source, 2*pair, line_number, lines, scaler->line_stride);
+		scaler->pair[slot] = pair;
+	}
+	return lines+(y%2)*(size_t)scaler->line_stride;
+}
+
+#define INVERSE_PRECISION 40
+
+// the source lines of each destination line are first summed vertically, and then horizontally
+static void scale_box(yuv_rgb_scaler *scaler, const Source *source, uint8_t *RGB, uint32_t RGB_stride)
+{
+	const uint32_t size = 3*scaler->width;
+	uint32_t *const sums = scaler->sums;
+	uint32_t x, y, line;
+	for(y=0; y<scaler->dst_height; ++y)
+	{
+		const uint32_t begin = (uint32_t)(((uint64_t)y*scaler->height)/scaler->dst_height),
+			end = (uint32_t)(((uint64_t)(y+1)*scaler->height)/scaler->dst_height);
+
+		const uint8_t *src = source_line(scaler, source, begin);
+		for(x=0; x<size; ++x)
+			sums[x] = src[x];
+		for(line=begin+1; line<end; ++line)
+		{
+			src = source_line(scaler, source, line);
+			for(x=0; x<size; ++x)
+				sums[x] += src[x];
+		}
+
+		// the destination pixels have x_min or x_min+1 source columns, and their rounded averages are computed with
+		// a multiplication by the inverse of their number of source pixels n, which is exact when n<2^16, since the
+		// sums are lower than 256*n
+		const uint32_t n_min = scaler->x_min*(end-begin), n_max = n_min+(end-begin);
+		const uint64_t inverse_min = ((1ull<<INVERSE_PRECISION)+n_min-1)/n_min,
+			inverse_max = ((1ull<<INVERSE_PRECISION)+n_max-1)/n_max;
+		uint8_t *rgb_ptr = RGB+y*RGB_stride;
+		for(x=0; x<scaler->dst_width; ++x, rgb_ptr+=3)
+		{
+			const uint32_t *sum_ptr = sums+scaler->x_offset[x];
+			const uint32_t n = scaler->x_size[x]*(end-begin);
+			uint32_t r = n/2, g = n/2, b = n/2, i;
+			for(i=0; i<scaler->x_size[x]; ++i, sum_ptr+=3)
+			{
+				r += sum_ptr[0];
+				g += sum_ptr[1];
+				b += sum_ptr[2];
+			}
+			if(n_max<(1u<<16))
+			{
+				const uint64_t inverse = scaler->x_size[x]==scaler->x_min ? inverse_min : inverse_max;
+				rgb_ptr[0] = (uint8_t)((r*inverse)>>INVERSE_PRECISION);
+				rgb_ptr[1] = (uint8_t)((g*inverse)>>INVERSE_PRECISION);
+				rgb_ptr[2] = (uint8_t)((b*inverse)>>INVERSE_PRECISION);
+			}
+			else
+			{
+				rgb_ptr[0] = (uint8_t)(r/n);
+				rgb_ptr[1] = (uint8_t)(g/n);
+				rgb_ptr[2] = (uint8_t)(b/n);
+			}
+		}
+	}
+}
+
+static void scale_bilinear(yuv_rgb_scaler *scaler, const Source *source, uint8_t *RGB, uint32_t RGB_stride)
+{
+	uint32_t x, y, c;
+	for(y=0; y<scaler->dst_height; ++y)
+	{
+		uint32_t first, second, weight;
+		bilinear_position(y, scaler->height, scaler->dst_height, &first, &second, &weight);
+		// the two lines are in the same pair or in consecutive pairs, which are in different slots of the ring
+		const uint8_t *src1 = source_line(scaler, source, first),
+			*src2 = source_line(scaler, source, second);
+
+		uint8_t *rgb_ptr = RGB+y*RGB_stride;
+		for(x=0; x<scaler->dst_width; ++x, rgb_ptr+=3)
+		{
+			const uint8_t *p11 = src1+scaler->x_offset[x], *p12 = src1+scaler->x_offset2[x],
+				*p21 = src2+scaler->x_offset[x], *p22 = src2+scaler->x_offset2[x];
+			const uint32_t x_weight = scaler->x_weight[x];
+			for(c=0; c<3; ++c)
+			{
+				const uint32_t v1 = p11[c]*(256-x_weight) + p12[c]*x_weight,
+					v2 = p21[c]*(256-x_weight) + p22[c]*x_weight;
+				rgb_ptr[c] = (uint8_t)((v1*(256-weight) + v2*weight + 32768)>>16);
+			}
+		}
+	}
+}
+
+static void scale(yuv_rgb_scaler *scaler, const Source *source, uint8_t *RGB, uint32_t RGB_stride)
+{
+	scaler->pair[0] = scaler->pair[1] = NO_PAIR;
+	if(scaler->filter==SCALE_BOX)
+		scale_box(scaler, source, RGB, RGB_stride);
+	else
+		scale_bilinear(scaler, source, RGB, RGB_stride);
+}
+
+// the converted lines are read right away, so they are written with regular stores
+static void convert_yuv420(const Source *source, uint32_t y, uint32_t line_number, uint8_t *rgb, uint32_t rgb_stride)
+{
+	yuv420_rgb24_policy(source->width, line_number, source->y+y*source->y_stride, source->u+(y/2)*source->uv_stride,
+		source->v+(y/2)*source->uv_stride, source->y_stride, source->uv_stride, rgb, rgb_stride, source->yuv_type,
+		YUVRGB_STORE_CACHED);
+}
+
+static void convert_nv12(const Source *source, uint32_t y, uint32_t line_number, uint8_t *rgb, uint32_t rgb_stride)
+{
+	nv12_rgb24_policy(source->width, line_number, source->y+y*source->y_stride, source->u+(y/2)*source->uv_stride,
+		source->y_stride, source->uv_stride, rgb, rgb_stride, source->yuv_type, YUVRGB_STORE_CACHED);
+}
+
+static void convert_nv21(const Source *source, uint32_t y, uint32_t line_number, uint8_t *rgb, uint32_t rgb_stride)
+{
+	nv21_rgb24_policy(source->width, line_number, source->y+y*source->y_stride, source->u+(y/2)*source->uv_stride,
+		source->y_stride, source->uv_stride, rgb, rgb_stride, source->yuv_type, YUVRGB_STORE_CACHED);
+}
+
+void yuv420_rgb24_scale(
+	yuv_rgb_scaler *scaler,
+	const uint8_t *Y, const uint8_t *U, const uint8_t *V, uint32_t Y_stride, uint32_t UV_stride, 
+	uint8_t *RGB, uint32_t RGB_stride, 
+	YCbCrType yuv_type)
+{
+	const Source source = {convert_yuv420, scaler->width, Y, U, V, Y_stride, UV_stride, yuv_type};
+	scale(scaler, &source, RGB, RGB_stride);
+}
+
+// NV12_SCALE(nv12) and NV12_SCALE(nv21) define the scaled conversions of the two semi planar formats
+#define NV12_SCALE(NAME) \
+void NAME##_rgb24_scale( \
+	yuv_rgb_scaler *scaler, \
+	const uint8_t *Y, const uint8_t *UV, uint32_t Y_stride, uint32_t UV_stride, \
+	uint8_t *RGB, uint32_t RGB_stride, \
+	YCbCrType yuv_type) \
+{ \
+	const Source source = {convert_##NAME, scaler->width, Y, UV, NULL, Y_stride, UV_stride, yuv_type}; \
+	scale(scaler, &source, RGB, RGB_stride); \
+}
+
+NV12_SCALE(nv12)
+NV12_SCALE(nv21)
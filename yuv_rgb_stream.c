@@ -0,0 +1,213 @@
+// Copyright 2016 Adrien Descamps
+// Distributed under BSD 3-Clause License
+
+// Streaming conversions by bands of lines (see yuv_rgb.h)
+//
+// Each band is converted as soon as it is pushed, with the fastest implementation (yuv420_rgb24, ...) called on the
+// lines of the band, directly into the destination image. Bands may have any number of lines: when a band ends in
+// the middle of a pair of lines, the line needed by the first line of the next band is copied to a carry buffer (the
+// chroma line for yuv to rgb, or the rgb line for rgb to yuv, whose chroma is computed from both lines of the pair),
+// so that the bands do not need to stay valid after the push, and the result is the same as the conversion of the
+// whole image.
+
+#include "yuv_rgb.h"
+#include "yuv_rgb_internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+struct yuv_rgb_stream
+{
+	uint32_t width, height;
+	// next line of the image
+	uint32_t line;
+	YCbCrType yuv_type;
+	// store policy of the bands, decided from the output of the whole image (the carried pairs, a single line each,
+	// are converted with regular stores)
+	YUVRGBStorePolicy store_policy;
+	// yuv to rgb conversion and its destination
+	void (*yuv_rgb)(uint32_t width, uint32_t height,
+		const uint8_t *y, const uint8_t *u, const uint8_t *v, uint32_t y_stride, uint32_t uv_stride,
+		uint8_t *rgb, uint32_t rgb_stride, YCbCrType yuv_type, YUVRGBStorePolicy policy);
+	uint8_t *rgb;
+	uint32_t rgb_stride;
+	// rgb to yuv conversion and its destination
+	void (*rgb_yuv)(uint32_t width, uint32_t height, const uint8_t *rgb, uint32_t rgb_stride,
+		uint8_t *y, uint8_t *u, uint8_t *v, uint32_t y_stride, uint32_t uv_stride, YCbCrType yuv_type,
+		YUVRGBStorePolicy policy);
+	uint8_t *y, *u, *v;
+	uint32_t y_stride, uv_stride;
+	uint32_t bpp;
+	// carried u and v lines (yuv to rgb), or pair of rgb lines whose first line is carried (rgb to yuv)
+	uint8_t *carry;
+	uint32_t carry_stride;
+};
+
+yuv_rgb_stream *yuv_rgb_stream_create(uint32_t width, uint32_t height)
+{
+	if(width==0 || height==0)
+		return NULL;
+
+	yuv_rgb_stream *stream = calloc(1, sizeof(yuv_rgb_stream));
+	if(!stream)
+		return NULL;
+
+	stream->width = width;
+	stream->height = height;
+	stream->carry_stride = 4*width;
+	stream->carry = malloc(2*(size_t)stream->carry_stride);
+	if(!stream->carry)
+	{
+		yuv_rgb_stream_destroy(stream);
+		return NULL;
+	}
+	return stream;
+}
+
+void yuv_rgb_stream_destroy(yuv_rgb_stream *stream)
+{
+	if(!stream)
+		return;
+	free(stream->carry);
+	free(stream);
+}
+
+// number of destination lines written: all the pushed lines, except a carried rgb line
+static uint32_t written_lines(const yuv_rgb_stream *stream)
+{
+	if(stream->rgb_yuv && (stream->line%2) && stream->line<stream->height)
+		return stream->line-1;
+	return stream->line;
+}
+
+static void start_yuv_rgb(yuv_rgb_stream *stream, uint8_t *RGB, uint32_t RGB_stride, YCbCrType yuv_type,
+	void (*yuv_rgb)(uint32_t, uint32_t, const uint8_t *, const uint8_t *, const uint8_t *, uint32_t, uint32_t,
+		uint8_t *, uint32_t, YCbCrType, YUVRGBStorePolicy))
+{
+	stream->line = 0;
+	stream->yuv_type = yuv_type;
+	stream->store_policy = yuv_rgb_output_store_policy((uint64_t)RGB_stride*stream->height);
+	stream->yuv_rgb = yuv_rgb;
+	stream->rgb = RGB;
+	stream->rgb_stride = RGB_stride;
+	stream->rgb_yuv = NULL;
+}
+
+void yuv420_rgb24_stream_start(yuv_rgb_stream *stream, uint8_t *RGB, uint32_t RGB_stride, YCbCrType yuv_type)
+{
+	start_yuv_rgb(stream, RGB, RGB_stride, yuv_type, yuv420_rgb24_policy);
+}
+
+void yuv420_rgb32_stream_start(yuv_rgb_stream *stream, uint8_t *RGB, uint32_t RGB_stride, YCbCrType yuv_type)
+{
+	start_yuv_rgb(stream, RGB, RGB_stride, yuv_type, yuv420_rgb32_policy);
+}
+
+uint32_t yuv420_stream_push(yuv_rgb_stream *stream, uint32_t line_number,
+	const uint8_t *Y, const uint8_t *U, const uint8_t *V, uint32_t Y_stride, uint32_t UV_stride)
+{
+	const uint32_t width = stream->width, uv_width = (width+1)/2;
+	if(!stream->yuv_rgb)
+		return 0;
+	if(line_number > stream->height-stream->line)
+		line_number = stream->height-stream->line;
+
+	// second line of a pair, with the carried chroma line
+	if(line_number>0 && (stream->line%2))
+	{
+		stream->yuv_rgb(width, 1, Y, stream->carry, stream->carry+stream->carry_stride, Y_stride, 0,
+			stream->rgb+stream->line*(size_t)stream->rgb_stride, stream->rgb_stride, stream->yuv_type,
+			YUVRGB_STORE_CACHED);
+		Y += Y_stride;
+		stream->line++;
+		line_number--;
+	}
+
+	if(line_number>0)
+	{
+		stream->yuv_rgb(width, line_number, Y, U, V, Y_stride, UV_stride,
+			stream->rgb+stream->line*(size_t)stream->rgb_stride, stream->rgb_stride, stream->yuv_type,
+			stream->store_policy);
+		stream->line += line_number;
+		// the band ends with the first line of a pair, carry its chroma line for the second one
+		if((line_number%2) && stream->line<stream->height)
+		{
+			memcpy(stream->carry, U+(line_number/2)*(size_t)UV_stride, uv_width);
+			memcpy(stream->carry+stream->carry_stride, V+(line_number/2)*(size_t)UV_stride, uv_width);
+		}
+	}
+	return written_lines(stream);
+}
+
+static void start_rgb_yuv(yuv_rgb_stream *stream, uint8_t *Y, uint8_t *U, uint8_t *V, uint32_t Y_stride,
+	uint32_t UV_stride, YCbCrType yuv_type, uint32_t bpp,
+	void (*rgb_yuv)(uint32_t, uint32_t, const uint8_t *, uint32_t, uint8_t *, uint8_t *, uint8_t *, uint32_t,
+		uint32_t, YCbCrType, YUVRGBStorePolicy))
+{
+	stream->line = 0;
+	stream->yuv_type = yuv_type;
+	stream->store_policy = yuv_rgb_output_store_policy((uint64_t)Y_stride*stream->height +
+		(uint64_t)UV_stride*(stream->height+1));
+	stream->rgb_yuv = rgb_yuv;
+	stream->y = Y;
+	stream->u = U;
+	stream->v = V;
+	stream->y_stride = Y_stride;
+	stream->uv_stride = UV_stride;
+	stream->bpp = bpp;
+	stream->yuv_rgb = NULL;
+}
+
+void rgb24_yuv420_stream_start(yuv_rgb_stream *stream, uint8_t *Y, uint8_t *U, uint8_t *V, uint32_t Y_stride,
+	uint32_t UV_stride, YCbCrType yuv_type)
+{
+	start_rgb_yuv(stream, Y, U, V, Y_stride, UV_stride, yuv_type, 3, rgb24_yuv420_policy);
+}
+
+void rgb32_yuv420_stream_start(yuv_rgb_stream *stream, uint8_t *Y, uint8_t *U, uint8_t *V, uint32_t Y_stride,
+	uint32_t UV_stride, YCbCrType yuv_type)
+{
+	start_rgb_yuv(stream, Y, U, V, Y_stride, UV_stride, yuv_type, 4, rgb32_yuv420_policy);
+}
+
+uint32_t rgb_stream_push(yuv_rgb_stream *stream, uint32_t line_number, const uint8_t *RGB, uint32_t RGB_stride)
+{
+	const uint32_t width = stream->width, line_size = stream->bpp*width;
+	if(!stream->rgb_yuv)
+		return 0;
+	if(line_number > stream->height-stream->line)
+		line_number = stream->height-stream->line;
+
+	// second line of a pair, converted with the carried first line
+	if(line_number>0 && (stream->line%2))
+	{
+		const uint32_t first = stream->line-1;
+		memcpy(stream->carry+stream->carry_stride, RGB, line_size);
+		stream->rgb_yuv(width, 2, stream->carry, stream->carry_stride,
+			stream->y+first*(size_t)stream->y_stride, stream->u+(first/2)*(size_t)stream->uv_stride,
+			stream->v+(first/2)*(size_t)stream->uv_stride, stream->y_stride, stream->uv_stride, stream->yuv_type,
+			YUVRGB_STORE_CACHED);
+		RGB += RGB_stride;
+		stream->line++;
+		line_number--;
+	}
+
+	if(line_number>0)
+	{
+		const uint32_t line = stream->line;
+		uint32_t converted = line_number;
+		stream->line += line_number;
+		// the band ends with the first line of a pair, carry it until the second one is pushed
+		if((line_number%2) && stream->line<stream->height)
+		{
+			converted--;
+			memcpy(stream->carry, RGB+converted*(size_t)RGB_stride, line_size);
+		}
+		if(converted>0)
+			stream->rgb_yuv(width, converted, RGB, RGB_stride,
+				stream->y+line*(size_t)stream->y_stride, stream->u+(line/2)*(size_t)stream->uv_stride,
+				stream->v+(line/2)*(size_t)stream->uv_stride, stream->y_stride, stream->uv_stride,
+				stream->yuv_type, stream->store_policy);
+	}
+	return written_lines(stream);
+}
@@ -0,0 +1,41 @@
+// Copyright 2016 Adrien Descamps
+// Distributed under BSD 3-Clause License
+
+// Definitions shared by the test and benchmark programs (test_yuv_rgb.c, bench_yuv_rgb.c and test_conversions.c),
+// not part of the library
+
+#ifndef YUV_RGB_TEST_UTIL_H
+#define YUV_RGB_TEST_UTIL_H
+
+// same detection as in yuv_rgb.c, the sse versions are only available if it is enabled there
+#ifdef _MSC_VER
+  #if (defined(_M_AMD64) || defined(_M_X64) || (_M_IX86_FP == 2))
+    #define _YUVRGB_SSE2_
+  #endif
+#else
+  #ifdef __SSE2__
+    #define _YUVRGB_SSE2_
+  #endif // __SSE2__
+#endif // _MSC_VER
+
+// instruction set required by an implementation, checked at run time
+typedef enum
+{
+	CPU_ANY,
+	CPU_AVX2,
+	CPU_AVX512
+} CaseCpu;
+
+// return 1 if the implementations requiring cpu can run on this cpu
+static inline int cpu_supports(CaseCpu cpu)
+{
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	if(cpu==CPU_AVX2)
+		return __builtin_cpu_supports("avx2");
+	if(cpu==CPU_AVX512)
+		return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+#endif
+	return cpu==CPU_ANY;
+}
+
+#endif